@@ -392,6 +392,9 @@
     
     [userDefaultsValuesDict setObject:@"default" forKey:@"midi.flavor"];
     
+    [userDefaultsValuesDict setObject:[NSNumber numberWithInt:1] forKey:@"midi.opl3.chips"];
+    [userDefaultsValuesDict setObject:[NSNumber numberWithBool:YES] forKey:@"midi.opl3.threaded"];
+    
     [userDefaultsValuesDict setObject:[NSNumber numberWithBool:NO] forKey:@"resumePlaybackOnStartup"];
     
 	//Register and sync defaults
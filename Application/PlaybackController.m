@@ -54,6 +54,12 @@ NSString *CogPlaybackDidStopNotficiation = @"CogPlaybackDidStopNotficiation";
 {
 	NSDictionary *defaultsDictionary = [NSDictionary dictionaryWithObjectsAndKeys:
 		[NSNumber numberWithDouble:100.0], @"volume",
+		[NSNumber numberWithInteger:2], @"decodeAheadThreads",
+		[NSNumber numberWithInteger:2], @"decodeAheadTracks",
+		[NSNumber numberWithDouble:10.0], @"decodeAheadSeconds",
+		[NSNumber numberWithInteger:64], @"decodeAheadCacheSize",
+		[NSNumber numberWithBool:NO], @"shorten.saveSeekTables",
+		[NSNumber numberWithBool:NO], @"flac.parallelDecode",
 		nil];
 		
 	[[NSUserDefaults standardUserDefaults] registerDefaults:defaultsDictionary];
@@ -537,6 +543,19 @@ NSDictionary * makeRGInfo(PlaylistEntry *pe)
         [player setNextStream:nil];
 }
 
+- (void)audioPlayer:(AudioPlayer *)player peekStreams:(NSMutableArray *)urls after:(id)userInfo count:(NSNumber *)count
+{
+	PlaylistEntry *curEntry = (PlaylistEntry *)userInfo;
+	
+	if (curEntry.stopAfter)
+		return;
+	
+	for (PlaylistEntry *pe in [playlistController peekEntriesAfter:curEntry count:[count integerValue]])
+	{
+		[urls addObject:[pe URL]];
+	}
+}
+
 - (void)audioPlayer:(AudioPlayer *)player didBeginStream:(id)userInfo
 {
 	PlaylistEntry *pe = (PlaylistEntry *)userInfo;
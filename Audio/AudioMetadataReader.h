@@ -14,5 +14,6 @@
 }
 
 + (NSDictionary *)metadataForURL:(NSURL *)url;
++ (void)prefetchMetadataForURLs:(NSArray *)urls;
 
 @end
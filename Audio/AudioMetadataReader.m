@@ -18,4 +18,11 @@
     }
 }
 
++ (void)prefetchMetadataForURLs:(NSArray *)urls
+{
+    @autoreleasepool {
+        [[PluginController sharedPluginController] prefetchMetadataForURLs:urls];
+    }
+}
+
 @end
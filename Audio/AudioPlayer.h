@@ -10,6 +10,7 @@
 
 @class BufferChain;
 @class OutputNode;
+@class DecodeAheadCache;
 
 @interface AudioPlayer : NSObject
 {	
@@ -20,6 +21,8 @@
 
 	NSMutableArray *chainQueue;
 	
+	DecodeAheadCache *decodeAheadCache;
+	
 	NSURL *nextStream;
 	id nextStreamUserInfo;
     NSDictionary *nextStreamRGInfo;
@@ -67,6 +70,7 @@
 
 - (OutputNode *) output;
 - (BufferChain *) bufferChain;
+- (DecodeAheadCache *) decodeAheadCache;
 - (id)initWithDelegate:(id)d;
 
 - (void)setPlaybackStatus:(int)status waitUntilDone:(BOOL)wait;
@@ -75,6 +79,9 @@
 - (void)requestNextStream:(id)userInfo;
 - (void)requestNextStreamMainThread:(id)userInfo;
 
+- (NSArray *)peekNextStreams:(id)userInfo count:(NSInteger)count;
+- (void)decodeAheadFrom:(id)userInfo;
+
 - (void)notifyStreamChanged:(id)userInfo;
 - (void)notifyStreamChangedMainThread:(id)userInfo;
 
@@ -91,5 +98,6 @@
 - (void)audioPlayer:(AudioPlayer *)player willEndStream:(id)userInfo; //You must use setNextStream in this method
 - (void)audioPlayer:(AudioPlayer *)player didBeginStream:(id)userInfo;
 - (void)audioPlayer:(AudioPlayer *)player didChangeStatus:(id)status;
+- (void)audioPlayer:(AudioPlayer *)player peekStreams:(NSMutableArray *)urls after:(id)userInfo count:(NSNumber *)count; //Add up to count URLs, without advancing the playlist
 @end
 
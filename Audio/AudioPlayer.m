@@ -8,6 +8,7 @@
 
 #import "AudioPlayer.h"
 #import "BufferChain.h"
+#import "DecodeAheadCache.h"
 #import "OutputNode.h"
 #import "Status.h"
 #import "Helper.h"
@@ -29,6 +30,8 @@
 		endOfInputReached = NO;
 		
 		chainQueue = [[NSMutableArray alloc] init];
+		
+		decodeAheadCache = [[DecodeAheadCache alloc] init];
 	}
 	
 	return self;
@@ -105,6 +108,8 @@
     initialBufferFilled = NO;
 
 	[bufferChain launchThreads];
+	
+	[self performSelectorInBackground:@selector(decodeAheadFrom:) withObject:userInfo];
     
     if (paused)
         [self setPlaybackStatus:kCogStatusPaused waitUntilDone:YES];
@@ -115,6 +120,8 @@
 	//Set shouldoContinue to NO on allll things
 	[self setShouldContinue:NO];
 	[self setPlaybackStatus:kCogStatusStopped waitUntilDone:YES];
+	
+	[decodeAheadCache flush];
 }
 
 - (void)pause
@@ -188,6 +195,8 @@
 			[self endOfInputReached:bufferChain];
 		} 
 	}
+	
+	[self performSelectorInBackground:@selector(decodeAheadFrom:) withObject:[bufferChain userInfo]];
 }
 
 - (void)setShouldContinue:(BOOL)s
@@ -219,6 +228,64 @@
 	[self sendDelegateMethod:@selector(audioPlayer:willEndStream:) withObject:userInfo waitUntilDone:YES];
 }
 
+// Asks the delegate which streams follow userInfo, without taking them off the playlist or queue
+- (NSArray *)peekNextStreams:(id)userInfo count:(NSInteger)count
+{
+	NSMutableArray *urls = [NSMutableArray array];
+	NSNumber *n = [NSNumber numberWithInteger:count];
+	SEL selector = @selector(audioPlayer:peekStreams:after:count:);
+	
+	if (![delegate respondsToSelector:selector])
+		return urls;
+	
+	NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[delegate methodSignatureForSelector:selector]];
+	[invocation setTarget:delegate];
+	[invocation setSelector:selector];
+	[invocation setArgument:&self	atIndex:2];
+	[invocation setArgument:&urls	atIndex:3];
+	[invocation setArgument:&userInfo	atIndex:4];
+	[invocation setArgument:&n	atIndex:5];
+	[invocation retainArguments];
+	
+	[invocation performSelectorOnMainThread:@selector(invoke) withObject:nil waitUntilDone:YES];
+	
+	return urls;
+}
+
+// Runs in the background, as peeking at the next streams waits on the main thread
+- (void)decodeAheadFrom:(id)userInfo
+{
+	NSInteger tracks = [decodeAheadCache tracksToDecodeAhead];
+	NSMutableArray *urls = [NSMutableArray array];
+	
+	if (tracks > 0 && userInfo)
+	{
+		// No lock is held here: the main thread takes chainQueue in play, stop and seek
+		NSArray *upcoming = [self peekNextStreams:userInfo count:tracks];
+		NSURL *lastURL;
+		
+		@synchronized(chainQueue) {
+			lastURL = [bufferChain streamURL];
+		}
+		
+		for (NSURL *url in upcoming)
+		{
+			// Tracks in the same file reuse the decoder, and streams are not opened early
+			if (![[url path] isEqualToString:[lastURL path]]
+				&& ![[url scheme] isEqualToString:@"http"]
+				&& ![[url scheme] isEqualToString:@"https"]
+				&& ![urls containsObject:url])
+			{
+				[urls addObject:url];
+			}
+			
+			lastURL = url;
+		}
+	}
+	
+	[decodeAheadCache decodeAhead:urls];
+}
+
 - (void)notifyStreamChanged:(id)userInfo
 {
 	[self sendDelegateMethod:@selector(audioPlayer:didBeginStream:) withObject:userInfo waitUntilDone:YES];
@@ -355,6 +422,8 @@
 	
 	[self notifyStreamChanged:[bufferChain userInfo]];
 	[output setEndOfStream:NO];
+	
+	[self performSelectorInBackground:@selector(decodeAheadFrom:) withObject:[bufferChain userInfo]];
 }
 
 - (void)sendDelegateMethod:(SEL)selector withObject:(id)obj waitUntilDone:(BOOL)wait
@@ -398,6 +467,11 @@
 	return bufferChain;
 }
 
+- (DecodeAheadCache *)decodeAheadCache
+{
+	return decodeAheadCache;
+}
+
 - (OutputNode *) output
 {
 	return output;
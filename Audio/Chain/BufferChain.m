@@ -10,6 +10,7 @@
 #import "OutputNode.h"
 #import "AudioSource.h"
 #import "CoreAudioUtils.h"
+#import "DecodeAheadCache.h"
 
 #import "Logging.h"
 
@@ -49,19 +50,29 @@
 
 	[self buildChain];
 	
-	id<CogSource> source = [AudioSource audioSourceForURL:url];
-	DLog(@"Opening: %@", url);
-	if (![source open:url])
+	DecodeAheadEntry *entry = [[controller decodeAheadCache] takeEntryForURL:url];
+	if (entry)
 	{
-		DLog(@"Couldn't open source...");
-        url = [NSURL URLWithString:@"silence://1"];
-        source = [AudioSource audioSourceForURL:url];
-        if (![source open:url])
-            return NO;
+		DLog(@"Opening decoded ahead: %@", url);
+		if (![inputNode openWithDecoder:[entry decoder] prerendered:[entry data]])
+			return NO;
+	}
+	else
+	{
+		id<CogSource> source = [AudioSource audioSourceForURL:url];
+		DLog(@"Opening: %@", url);
+		if (![source open:url])
+		{
+			DLog(@"Couldn't open source...");
+			url = [NSURL URLWithString:@"silence://1"];
+			source = [AudioSource audioSourceForURL:url];
+			if (![source open:url])
+				return NO;
+		}
+
+		if (![inputNode openWithSource:source])
+			return NO;
 	}
-
-	if (![inputNode openWithSource:source])
-		return NO;
 
 	if (![converterNode setupWithInputFormat:propertiesToASBD([inputNode properties]) outputFormat:outputFormat])
 		return NO;
@@ -13,13 +13,16 @@
 #import <AudioUnit/AudioUnit.h>
 
 #import "Node.h"
+#import "PCMConverter.h"
 
 @interface ConverterNode : Node {
     NSDictionary * rgInfo;
 
 	AudioConverterRef converter;
     AudioConverterRef converterFloat;
+    PCMConverter *pcmConverter;
 	void *callbackBuffer;
+    int callbackSize;
     
     float volumeScale;
     
@@ -27,6 +30,7 @@
     int floatSize, floatOffset;
 	
 	AudioStreamBasicDescription inputFormat;
+    AudioStreamBasicDescription inputFloatFormat;
     AudioStreamBasicDescription floatFormat;
 	AudioStreamBasicDescription outputFormat;
 }
@@ -7,6 +7,7 @@
 //
 
 #import "ConverterNode.h"
+#import "CoreAudioUtils.h"
 
 #import "Logging.h"
 
@@ -28,6 +29,33 @@ void PrintStreamDesc (AudioStreamBasicDescription *inDesc)
 	DLog (@"- - - - - - - - - - - - - - - - - - - -\n");
 }
 
+static BOOL ASBDToPCMFormat(const AudioStreamBasicDescription *asbd, PCMFormat *format)
+{
+	if (asbd->mFormatID != kAudioFormatLinearPCM ||
+		(asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved) ||
+		asbd->mFramesPerPacket != 1 || (asbd->mBitsPerChannel % 8) != 0 ||
+		asbd->mBytesPerFrame != (asbd->mBitsPerChannel / 8) * asbd->mChannelsPerFrame)
+		return NO;
+
+	format->channels = asbd->mChannelsPerFrame;
+	format->bitsPerSample = asbd->mBitsPerChannel;
+	format->isFloat = (asbd->mFormatFlags & kAudioFormatFlagIsFloat) != 0;
+	format->isSigned = (asbd->mFormatFlags & kAudioFormatFlagIsSignedInteger) != 0;
+	format->isBigEndian = (asbd->mFormatFlags & kAudioFormatFlagIsBigEndian) != 0;
+
+	return YES;
+}
+
+static AudioStreamBasicDescription floatFormatWithChannels(AudioStreamBasicDescription format, UInt32 channels)
+{
+	format.mFormatFlags = kAudioFormatFlagsNativeFloatPacked;
+	format.mBitsPerChannel = 32;
+	format.mChannelsPerFrame = channels;
+	format.mBytesPerFrame = (32/8)*channels;
+	format.mBytesPerPacket = format.mBytesPerFrame * format.mFramesPerPacket;
+	return format;
+}
+
 @implementation ConverterNode
 
 - (id)initWithController:(id)c previous:(id)p
@@ -39,6 +67,7 @@ void PrintStreamDesc (AudioStreamBasicDescription *inDesc)
         
         converterFloat = NULL;
         converter = NULL;
+        pcmConverter = NULL;
         floatBuffer = NULL;
         callbackBuffer = NULL;
 
@@ -48,60 +77,6 @@ void PrintStreamDesc (AudioStreamBasicDescription *inDesc)
     return self;
 }
 
-static const float STEREO_DOWNMIX[8-2][8][2]={
-    /*3.0*/
-    {
-        {0.5858F,0.0F},{0.0F,0.5858F},{0.4142F,0.4142F}
-    },
-    /*quadrophonic*/
-    {
-        {0.4226F,0.0F},{0.0F,0.4226F},{0.366F,0.2114F},{0.2114F,0.336F}
-    },
-    /*5.0*/
-    {
-        {0.651F,0.0F},{0.0F,0.651F},{0.46F,0.46F},{0.5636F,0.3254F},
-        {0.3254F,0.5636F}
-    },
-    /*5.1*/
-    {
-        {0.529F,0.0F},{0.0F,0.529F},{0.3741F,0.3741F},{0.3741F,0.3741F},{0.4582F,0.2645F},
-        {0.2645F,0.4582F}
-    },
-    /*6.1*/
-    {
-        {0.4553F,0.0F},{0.0F,0.4553F},{0.322F,0.322F},{0.322F,0.322F},{0.3943F,0.2277F},
-        {0.2277F,0.3943F},{0.2788F,0.2788F}
-    },
-    /*7.1*/
-    {
-        {0.3886F,0.0F},{0.0F,0.3886F},{0.2748F,0.2748F},{0.2748F,0.2748F},{0.3366F,0.1943F},
-        {0.1943F,0.3366F},{0.3366F,0.1943F},{0.1943F,0.3366F}
-    }
-};
-
-static void downmix_to_stereo(float * buffer, int channels, int count)
-{
-    if (channels >= 3 && channels < 8)
-    for (int i = 0; i < count; ++i)
-    {
-        float left = 0, right = 0;
-        for (int j = 0; j < channels; ++j)
-        {
-            left += buffer[i * channels + j] * STEREO_DOWNMIX[channels - 3][j][0];
-            right += buffer[i * channels + j] * STEREO_DOWNMIX[channels - 3][j][1];
-        }
-        buffer[i * channels + 0] = left;
-        buffer[i * channels + 1] = right;
-    }
-}
-
-static void scale_by_volume(float * buffer, int count, float volume)
-{
-    if ( volume != 1.0 )
-        for (int i = 0; i < count; ++i )
-            buffer[i] *= volume;
-}
-
 //called from the complexfill when the audio is converted...good clean fun
 static OSStatus ACInputProc(AudioConverterRef inAudioConverter,
                             UInt32* ioNumberDataPackets,
@@ -182,11 +157,66 @@ static OSStatus ACFloatProc(AudioConverterRef inAudioConverter,
 	
 	while ([self shouldContinue] == YES && [self endOfStream] == NO) //Need to watch EOS somehow....
 	{
-		int amountConverted = [self convert:writeBuf amount:CHUNK_SIZE];
-		[self writeData:writeBuf amount:amountConverted];
+		void *writePtr;
+		int amountAvailable = [self reserveWrite:&writePtr amount:CHUNK_SIZE];
+		if (amountAvailable == 0)
+			continue;
+		
+		// Convert straight into the buffer, unless it wraps within a frame
+		if (amountAvailable >= outputFormat.mBytesPerFrame)
+		{
+			int amountConverted = [self convert:writePtr amount:amountAvailable];
+			[self commitWrite:amountConverted];
+		}
+		else
+		{
+			int amountConverted = [self convert:writeBuf amount:CHUNK_SIZE];
+			[self writeData:writeBuf amount:amountConverted];
+		}
 	}
 }
 
+// Reads whole frames from the previous node, and runs them through the PCM
+// converter. Returns the number of frames converted, or 0 when stopping.
+- (int)readFrames:(void *)dest frames:(int)frames
+{
+	int frameSize = inputFormat.mBytesPerPacket;
+	int amountToRead = frames * frameSize;
+	int framesRead = 0;
+
+	if (frames <= 0)
+		return 0;
+
+	callbackBuffer = realloc(callbackBuffer, amountToRead);
+
+	while (framesRead == 0)
+	{
+		if ([self shouldContinue] == NO || [self endOfStream] == YES)
+			return 0;
+
+		BOOL wasReset = shouldReset;
+		int amountRead = [self readData:callbackBuffer + callbackSize amount:amountToRead - callbackSize];
+		if (shouldReset == YES && wasReset == NO)
+		{
+			// Drop any partial frame from before the seek
+			memmove(callbackBuffer, callbackBuffer + callbackSize, amountRead);
+			callbackSize = 0;
+		}
+		callbackSize += amountRead;
+
+		framesRead = callbackSize / frameSize;
+		if (amountRead == 0 && [self endOfStream] == NO)
+			usleep(10000);
+	}
+
+	PCMConverterProcess(pcmConverter, callbackBuffer, dest, framesRead);
+
+	callbackSize -= framesRead * frameSize;
+	memmove(callbackBuffer, callbackBuffer + framesRead * frameSize, callbackSize);
+
+	return framesRead;
+}
+
 - (int)convert:(void *)dest amount:(int)amount
 {	
 	AudioBufferList ioData;
@@ -194,40 +224,53 @@ static OSStatus ACFloatProc(AudioConverterRef inAudioConverter,
 	OSStatus err;
     int amountRead = 0;
 	
+    if (!converter)
+    {
+        // No rate change, so the PCM converter does it all in one pass
+        return [self readFrames:dest frames:amount / outputFormat.mBytesPerFrame] * outputFormat.mBytesPerFrame;
+    }
+
     if (floatOffset == floatSize) {
         ioNumberFrames = amount / outputFormat.mBytesPerFrame;
-            
-        floatBuffer = realloc( floatBuffer, ioNumberFrames * floatFormat.mBytesPerFrame );
-        ioData.mBuffers[0].mData = floatBuffer;
-        ioData.mBuffers[0].mDataByteSize = ioNumberFrames * floatFormat.mBytesPerFrame;
-        ioData.mBuffers[0].mNumberChannels = floatFormat.mChannelsPerFrame;
-        ioData.mNumberBuffers = 1;
-            
-    tryagain:
-        err = AudioConverterFillComplexBuffer(converterFloat, ACInputProc, (__bridge void * _Nullable)(self), &ioNumberFrames, &ioData, NULL);
-        amountRead += ioData.mBuffers[0].mDataByteSize;
-        if (err == 100)
+
+        if (!converterFloat)
         {
-            DLog(@"INSIZE: %i", amountRead);
-            ioData.mBuffers[0].mData = floatBuffer + amountRead;
-            ioNumberFrames = ( amount / outputFormat.mBytesPerFrame ) - ( amountRead / floatFormat.mBytesPerFrame );
-            ioData.mBuffers[0].mDataByteSize = ioNumberFrames * floatFormat.mBytesPerFrame;
-            usleep(10000);
-            goto tryagain;
+            floatBuffer = realloc( floatBuffer, ioNumberFrames * floatFormat.mBytesPerFrame );
+            floatSize = [self readFrames:floatBuffer frames:ioNumberFrames] * floatFormat.mBytesPerFrame;
+            floatOffset = 0;
         }
-        else if (err != noErr && err != kAudioConverterErr_InvalidInputSize)
+        else
         {
-            DLog(@"Error: %i", err);
-            return amountRead;
-        }
-        
-        if ( inputFormat.mChannelsPerFrame > 2 && outputFormat.mChannelsPerFrame == 2 )
-            downmix_to_stereo( (float*) floatBuffer, inputFormat.mChannelsPerFrame, amountRead / floatFormat.mBytesPerFrame );
+            floatBuffer = realloc( floatBuffer, ioNumberFrames * inputFloatFormat.mBytesPerFrame );
+            ioData.mBuffers[0].mData = floatBuffer;
+            ioData.mBuffers[0].mDataByteSize = ioNumberFrames * inputFloatFormat.mBytesPerFrame;
+            ioData.mBuffers[0].mNumberChannels = inputFloatFormat.mChannelsPerFrame;
+            ioData.mNumberBuffers = 1;
+            
+        tryagain:
+            err = AudioConverterFillComplexBuffer(converterFloat, ACInputProc, (__bridge void * _Nullable)(self), &ioNumberFrames, &ioData, NULL);
+            amountRead += ioData.mBuffers[0].mDataByteSize;
+            if (err == 100)
+            {
+                DLog(@"INSIZE: %i", amountRead);
+                ioData.mBuffers[0].mData = floatBuffer + amountRead;
+                ioNumberFrames = ( amount / outputFormat.mBytesPerFrame ) - ( amountRead / inputFloatFormat.mBytesPerFrame );
+                ioData.mBuffers[0].mDataByteSize = ioNumberFrames * inputFloatFormat.mBytesPerFrame;
+                usleep(10000);
+                goto tryagain;
+            }
+            else if (err != noErr && err != kAudioConverterErr_InvalidInputSize)
+            {
+                DLog(@"Error: %i", err);
+                return amountRead;
+            }
         
-        scale_by_volume( (float*) floatBuffer, amountRead / sizeof(float), volumeScale);
+            // Mixes and scales in place, the frames only get smaller
+            PCMConverterProcess(pcmConverter, floatBuffer, floatBuffer, amountRead / inputFloatFormat.mBytesPerFrame);
         
-        floatSize = amountRead;
-        floatOffset = 0;
+            floatSize = (amountRead / inputFloatFormat.mBytesPerFrame) * floatFormat.mBytesPerFrame;
+            floatOffset = 0;
+        }
     }
 
     ioNumberFrames = amount / outputFormat.mBytesPerFrame;
@@ -279,6 +322,8 @@ static float db_to_scale(float db)
     if (rgInfo == nil)
     {
         volumeScale = 1.0;
+        if (pcmConverter)
+            PCMConverterSetVolume(pcmConverter, volumeScale);
         return;
     }
     
@@ -315,6 +360,9 @@ static float db_to_scale(float db)
             scale = 1.0 / peak;
     }
     volumeScale = scale;
+
+    if (pcmConverter)
+        PCMConverterSetVolume(pcmConverter, volumeScale);
 }
 
 
@@ -326,51 +374,92 @@ static float db_to_scale(float db)
 	inputFormat = inf;
 	outputFormat = outf;
     
-    floatFormat = inputFormat;
-    floatFormat.mFormatFlags = kAudioFormatFlagsNativeFloatPacked;
-    floatFormat.mBitsPerChannel = 32;
-    floatFormat.mBytesPerFrame = (32/8)*floatFormat.mChannelsPerFrame;
-    floatFormat.mBytesPerPacket = floatFormat.mBytesPerFrame * floatFormat.mFramesPerPacket;
-    
     floatOffset = 0;
     floatSize = 0;
-    
-    stat = AudioConverterNew( &inputFormat, &floatFormat, &converterFloat );
-    if (stat != noErr)
-    {
-        ALog(@"Error creating converter %i", stat);
-        return NO;
-    }
-    
-    stat = AudioConverterNew ( &floatFormat, &outputFormat, &converter );
-    if (stat != noErr)
-    {
-        ALog(@"Error creating converter %i", stat);
-        return NO;
-    }
+    callbackSize = 0;
+
+    PCMFormat pcmInput, pcmOutput;
+    BOOL inputIsPCM = ASBDToPCMFormat(&inputFormat, &pcmInput);
 
-    if (inputFormat.mChannelsPerFrame > 2 && outputFormat.mChannelsPerFrame == 2)
+    // Without a rate change, one pass does the whole conversion
+    if (inputIsPCM && inputFormat.mSampleRate == outputFormat.mSampleRate &&
+        ASBDToPCMFormat(&outputFormat, &pcmOutput))
+        pcmConverter = PCMConverterCreate(&pcmInput, &pcmOutput);
+
+    if (!pcmConverter)
     {
-        SInt32 channelMap[2] = { 0, 1 };
-        
-		stat = AudioConverterSetProperty(converter,kAudioConverterChannelMap,sizeof(channelMap),channelMap);
-		if (stat != noErr)
-		{
-			ALog(@"Error mapping channels %i", stat);
+        // Otherwise convert to float for the AudioConverter to resample, with
+        // an AudioConverter in front for input the PCM converter cannot read
+        PCMFormat pcmFloat = { inputFormat.mChannelsPerFrame, 32, 1, 0, hostIsBigEndian() };
+
+        inputFloatFormat = floatFormatWithChannels(inputFormat, inputFormat.mChannelsPerFrame);
+
+        if (!inputIsPCM || !(pcmConverter = PCMConverterCreate(&pcmInput, &pcmFloat)))
+        {
+            stat = AudioConverterNew( &inputFormat, &inputFloatFormat, &converterFloat );
+            if (stat != noErr)
+            {
+                ALog(@"Error creating converter %i", stat);
+                return NO;
+            }
+            pcmInput = pcmFloat;
+        }
+
+        // Mix to the output channels on the way. After an AudioConverter
+        // this works in place, so only if the frames do not grow.
+        pcmFloat.channels = outputFormat.mChannelsPerFrame;
+        if (!converterFloat || pcmFloat.channels <= pcmInput.channels)
+        {
+            PCMConverter *mixer = PCMConverterCreate(&pcmInput, &pcmFloat);
+            if (mixer)
+            {
+                PCMConverterRelease(pcmConverter);
+                pcmConverter = mixer;
+            }
+        }
+        if (!pcmConverter)
+        {
+            pcmFloat.channels = pcmInput.channels;
+            pcmConverter = PCMConverterCreate(&pcmInput, &pcmFloat);
+            if (!pcmConverter)
+            {
+                ALog(@"Error creating PCM converter");
+                return NO;
+            }
+        }
+
+        floatFormat = floatFormatWithChannels(inputFormat, PCMConverterOutputFrameSize(pcmConverter) / sizeof(float));
+
+        stat = AudioConverterNew ( &floatFormat, &outputFormat, &converter );
+        if (stat != noErr)
+        {
+            ALog(@"Error creating converter %i", stat);
             return NO;
-		}
+        }
+
+        if (floatFormat.mChannelsPerFrame > 2 && outputFormat.mChannelsPerFrame == 2)
+        {
+            SInt32 channelMap[2] = { 0, 1 };
+
+            stat = AudioConverterSetProperty(converter,kAudioConverterChannelMap,sizeof(channelMap),channelMap);
+            if (stat != noErr)
+            {
+                ALog(@"Error mapping channels %i", stat);
+                return NO;
+            }
+        }
+        else if (floatFormat.mChannelsPerFrame == 1)
+        {
+            SInt32 channelMap[2] = { 0, 0 };
+
+            stat = AudioConverterSetProperty(converter,kAudioConverterChannelMap,sizeof(channelMap),channelMap);
+            if (stat != noErr)
+            {
+                ALog(@"Error mapping channels %i", stat);
+                return NO;
+            }
+        }
     }
-	else if (inputFormat.mChannelsPerFrame == 1)
-	{
-		SInt32 channelMap[2] = { 0, 0 };
-		
-		stat = AudioConverterSetProperty(converter,kAudioConverterChannelMap,sizeof(channelMap),channelMap);
-		if (stat != noErr)
-		{
-			ALog(@"Error mapping channels %i", stat);
-            return NO;
-		}	
-	}
 	
 	PrintStreamDesc(&inf);
 	PrintStreamDesc(&outf);
@@ -384,7 +473,9 @@ static float db_to_scale(float db)
 {
 	DLog(@"Decoder dealloc");
 
-    [[NSUserDefaultsController sharedUserDefaultsController] removeObserver:self forKeyPath:@"values.volumeScaling"];
+    // No buffer means init failed before the observer was added
+    if (buffer)
+        [[NSUserDefaultsController sharedUserDefaultsController] removeObserver:self forKeyPath:@"values.volumeScaling"];
     
 	[self cleanUp];
 }
@@ -413,6 +504,11 @@ static float db_to_scale(float db)
 - (void)cleanUp
 {
     rgInfo = nil;
+    if (pcmConverter)
+    {
+        PCMConverterRelease(pcmConverter);
+        pcmConverter = NULL;
+    }
     if (converterFloat)
     {
         AudioConverterDispose(converterFloat);
@@ -434,6 +530,7 @@ static float db_to_scale(float db)
 	}
     floatOffset = 0;
     floatSize = 0;
+    callbackSize = 0;
 }
 
 @end
@@ -0,0 +1,57 @@
+//
+//  DecodeAheadCache.h
+//  CogAudio
+//
+//
+
+#import <Cocoa/Cocoa.h>
+
+#import "Plugin.h"
+
+// Decoder for an upcoming track, opened early with the start of the track
+// already rendered. The decoder continues from the end of the rendered audio.
+@interface DecodeAheadEntry : NSObject {
+	NSURL *url;
+	id<CogSource> source;
+	id<CogDecoder> decoder;
+	NSMutableData *data;
+
+	long targetLength;
+	BOOL cancelled;
+}
+
+- (NSURL *)url;
+- (id<CogDecoder>)decoder;
+- (NSData *)data;
+
+@end
+
+// Pre-renders the first seconds of the next playlist entries on a pool of
+// worker threads, so track changes do not wait on slow decoders.
+//
+// Configured from the user defaults:
+//   decodeAheadThreads    - worker threads, 0 disables decoding ahead
+//   decodeAheadTracks     - number of upcoming tracks to render
+//   decodeAheadSeconds    - seconds of audio rendered per track
+//   decodeAheadCacheSize  - limit for all rendered audio, in megabytes
+@interface DecodeAheadCache : NSObject {
+	NSOperationQueue *queue;
+	NSMutableArray *entries;
+
+	long cacheSize;
+}
+
+- (id)init;
+
+// Upcoming tracks in play order. Entries for other tracks are dropped.
+- (void)decodeAhead:(NSArray *)urls;
+
+- (NSInteger)tracksToDecodeAhead;
+
+// Hands over the entry for a URL, or nil if it was not rendered ahead.
+// The caller owns the decoder, and closes it when done.
+- (DecodeAheadEntry *)takeEntryForURL:(NSURL *)url;
+
+- (void)flush;
+
+@end
@@ -0,0 +1,290 @@
+//
+//  DecodeAheadCache.m
+//  CogAudio
+//
+//
+
+#import "DecodeAheadCache.h"
+#import "AudioSource.h"
+#import "AudioDecoder.h"
+#import "Node.h"
+
+#import "Logging.h"
+
+@interface DecodeAheadCache (Private)
+- (BOOL)reserve:(long)amount;
+- (void)unreserve:(long)amount;
+@end
+
+@implementation DecodeAheadEntry
+
+- (id)initWithURL:(NSURL *)u
+{
+	self = [super init];
+	if (self)
+	{
+		url = u;
+		source = nil;
+		decoder = nil;
+		data = [[NSMutableData alloc] init];
+
+		targetLength = 0;
+		cancelled = NO;
+	}
+
+	return self;
+}
+
+- (NSURL *)url
+{
+	return url;
+}
+
+- (id<CogDecoder>)decoder
+{
+	return decoder;
+}
+
+- (NSData *)data
+{
+	return data;
+}
+
+- (void)renderWithCache:(DecodeAheadCache *)cache seconds:(double)seconds
+{
+	int bytesPerFrame = 0;
+
+	@synchronized(self) {
+		if (cancelled)
+			return;
+
+		source = [AudioSource audioSourceForURL:url];
+		if (![source open:url])
+		{
+			DLog(@"Couldn't open source to decode ahead: %@", url);
+			source = nil;
+			return;
+		}
+
+		decoder = [AudioDecoder audioDecoderForSource:source];
+		if (decoder == nil || ![decoder open:source])
+		{
+			DLog(@"Couldn't open decoder to decode ahead: %@", url);
+			decoder = nil;
+			[source close];
+			source = nil;
+			return;
+		}
+
+		NSDictionary *properties = [decoder properties];
+		int bitsPerSample = [[properties objectForKey:@"bitsPerSample"] intValue];
+		int channels = [[properties objectForKey:@"channels"] intValue];
+		double sampleRate = [[properties objectForKey:@"sampleRate"] doubleValue];
+
+		bytesPerFrame = (bitsPerSample / 8) * channels;
+		targetLength = (long)(seconds * sampleRate) * bytesPerFrame;
+	}
+
+	if (bytesPerFrame <= 0)
+		return;
+
+	void *buffer = malloc(CHUNK_SIZE);
+	BOOL done = NO;
+
+	while (!done)
+	{
+		@synchronized(self) {
+			long amount = targetLength - [data length];
+			if (amount > CHUNK_SIZE)
+				amount = CHUNK_SIZE;
+			amount -= amount % bytesPerFrame;
+
+			if (cancelled || amount <= 0 || ![cache reserve:amount])
+			{
+				done = YES;
+			}
+			else
+			{
+				int framesRead = [decoder readAudio:buffer frames:(UInt32)(amount / bytesPerFrame)];
+				if (framesRead < 0)
+					framesRead = 0;
+
+				[data appendBytes:buffer length:framesRead * bytesPerFrame];
+				[cache unreserve:amount - framesRead * bytesPerFrame];
+
+				if (framesRead == 0)
+					done = YES;
+			}
+		}
+	}
+
+	free(buffer);
+
+	DLog(@"Decoded ahead %lu bytes of %@", (unsigned long)[data length], url);
+}
+
+// Stops rendering, waiting for a read in progress to complete.
+- (void)cancel
+{
+	@synchronized(self) {
+		cancelled = YES;
+	}
+}
+
+- (void)close
+{
+	@synchronized(self) {
+		cancelled = YES;
+		if (decoder)
+			[decoder close];
+		decoder = nil;
+		source = nil;
+	}
+}
+
+@end
+
+@implementation DecodeAheadCache
+
+- (id)init
+{
+	self = [super init];
+	if (self)
+	{
+		queue = [[NSOperationQueue alloc] init];
+		entries = [[NSMutableArray alloc] init];
+
+		cacheSize = 0;
+	}
+
+	return self;
+}
+
+- (NSInteger)tracksToDecodeAhead
+{
+	NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+	if ([defaults integerForKey:@"decodeAheadThreads"] <= 0)
+		return 0;
+
+	return [defaults integerForKey:@"decodeAheadTracks"];
+}
+
+- (void)decodeAhead:(NSArray *)urls
+{
+	NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+	NSInteger threads = [defaults integerForKey:@"decodeAheadThreads"];
+	double seconds = [defaults doubleForKey:@"decodeAheadSeconds"];
+
+	NSMutableArray *dropped = [NSMutableArray array];
+
+	@synchronized(self) {
+		if (threads > 0)
+			[queue setMaxConcurrentOperationCount:threads];
+		else
+			urls = [NSArray array];
+
+		for (DecodeAheadEntry *entry in entries)
+		{
+			if (![urls containsObject:[entry url]])
+				[dropped addObject:entry];
+		}
+		[entries removeObjectsInArray:dropped];
+
+		for (NSURL *url in urls)
+		{
+			BOOL found = NO;
+			for (DecodeAheadEntry *entry in entries)
+			{
+				if ([[entry url] isEqual:url])
+				{
+					found = YES;
+					break;
+				}
+			}
+			if (found)
+				continue;
+
+			DecodeAheadEntry *entry = [[DecodeAheadEntry alloc] initWithURL:url];
+			[entries addObject:entry];
+
+			// Operations run in the order of the playlist
+			[queue addOperationWithBlock:^{
+				@autoreleasepool {
+					[entry renderWithCache:self seconds:seconds];
+				}
+			}];
+		}
+	}
+
+	// Closed outside the lock, since rendering takes the entry lock first
+	for (DecodeAheadEntry *entry in dropped)
+	{
+		[entry close];
+		[self unreserve:[[entry data] length]];
+	}
+}
+
+- (DecodeAheadEntry *)takeEntryForURL:(NSURL *)url
+{
+	DecodeAheadEntry *taken = nil;
+
+	@synchronized(self) {
+		for (DecodeAheadEntry *entry in entries)
+		{
+			if ([[entry url] isEqual:url])
+			{
+				taken = entry;
+				break;
+			}
+		}
+		if (taken)
+			[entries removeObject:taken];
+	}
+
+	if (taken == nil)
+		return nil;
+
+	[taken cancel];
+	[self unreserve:[[taken data] length]];
+
+	if ([taken decoder] == nil)
+		return nil;
+
+	DLog(@"Using %lu bytes decoded ahead for %@", (unsigned long)[[taken data] length], url);
+
+	return taken;
+}
+
+- (void)flush
+{
+	[self decodeAhead:[NSArray array]];
+}
+
+- (BOOL)reserve:(long)amount
+{
+	long limit = [[NSUserDefaults standardUserDefaults] integerForKey:@"decodeAheadCacheSize"] * 1024 * 1024;
+
+	@synchronized(self) {
+		if (cacheSize + amount > limit)
+			return NO;
+		cacheSize += amount;
+	}
+
+	return YES;
+}
+
+- (void)unreserve:(long)amount
+{
+	@synchronized(self) {
+		cacheSize -= amount;
+	}
+}
+
+- (void)dealloc
+{
+	[queue cancelAllOperations];
+	for (DecodeAheadEntry *entry in entries)
+		[entry close];
+}
+
+@end
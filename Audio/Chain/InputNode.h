@@ -29,12 +29,16 @@
 	BOOL shouldSeek;
 	long seekFrame;
 
+	NSData *prerendered;
+	long prerenderedOffset;
+
     Semaphore *exitAtTheEndOfTheStream;
 }
 @property(readonly) Semaphore *exitAtTheEndOfTheStream;
 
 - (BOOL)openWithSource:(id<CogSource>)source;
 - (BOOL)openWithDecoder:(id<CogDecoder>) d;
+- (BOOL)openWithDecoder:(id<CogDecoder>) d prerendered:(NSData *)data;
 
 - (void)process;
 - (NSDictionary *) properties;
@@ -58,10 +58,19 @@
 }
 
 - (BOOL)openWithDecoder:(id<CogDecoder>) d
+{
+	return [self openWithDecoder:d prerendered:nil];
+}
+
+- (BOOL)openWithDecoder:(id<CogDecoder>) d prerendered:(NSData *)data
 {
 	DLog(@"Opening with old decoder: %@", d);
 	decoder = d;
 
+	//Audio already decoded ahead, played before reading from the decoder
+	prerendered = data;
+	prerenderedOffset = 0;
+
 	NSDictionary *properties = [decoder properties];
 	int bitsPerSample = [[properties objectForKey:@"bitsPerSample"] intValue];
 	int channels = [[properties objectForKey:@"channels"] intValue];
@@ -111,7 +120,6 @@
 
 - (void)process
 {
-	int amountInBuffer = 0;
 	void *inputBuffer = malloc(CHUNK_SIZE);
 	
 	BOOL shouldClose = YES;
@@ -128,6 +136,7 @@
 			seekError = [decoder seek:seekFrame] < 0;
             if ( !isPaused ) [output resume];
 			shouldSeek = NO;
+			prerendered = nil;
 			DLog(@"Seeked! Resetting Buffer");
 			
 			[self resetBuffer];
@@ -136,44 +145,56 @@
 			initialBufferFilled = NO;
 		}
 
-		if (amountInBuffer < CHUNK_SIZE) {
-			int framesToRead = (CHUNK_SIZE - amountInBuffer)/bytesPerFrame;
-			int framesRead = [decoder readAudio:((char *)inputBuffer) + amountInBuffer frames:framesToRead];
+		void *writePtr;
+		int amountAvailable = [self reserveWrite:&writePtr amount:CHUNK_SIZE];
+		if (amountAvailable == 0 || shouldSeek == YES)
+			continue;
+
+		// Decode straight into the buffer, unless the space left before
+		// it wraps around is too short for a whole frame
+		BOOL direct = (amountAvailable >= bytesPerFrame);
+		void *readBuffer = direct ? writePtr : inputBuffer;
+		int framesToRead = (direct ? amountAvailable : CHUNK_SIZE)/bytesPerFrame;
+		int framesRead = 0;
+		if (prerendered)
+			framesRead = [self readPrerendered:readBuffer frames:framesToRead];
+		if (framesRead == 0)
+			framesRead = [decoder readAudio:readBuffer frames:framesToRead];
+
+        if (framesRead > 0 && !seekError)
+        {
+            if (direct)
+                [self commitWrite:framesRead * bytesPerFrame];
+            else
+                [self writeData:inputBuffer amount:framesRead * bytesPerFrame];
+        }
+        else
+		{
+			if (initialBufferFilled == NO) {
+				[controller initialBufferFilled:self];
+			}
+			
+			DLog(@"End of stream? %@", [self properties]);
 
-            if (framesRead > 0 && !seekError)
+			endOfStream = YES;
+			shouldClose = [controller endOfInputReached]; //Lets us know if we should keep going or not (occassionally, for track changes within a file)
+			DLog(@"closing? is %i", shouldClose);
+
+            // wait before exiting, as we might still get seeking request
+            DLog("InputNode: Before wait")
+            [exitAtTheEndOfTheStream waitIndefinitely];
+            DLog("InputNode: After wait, should seek = %d", shouldSeek)
+            if (shouldSeek)
             {
-                amountInBuffer += (framesRead * bytesPerFrame);
-                [self writeData:inputBuffer amount:amountInBuffer];
-                amountInBuffer = 0;
+                endOfStream = NO;
+                shouldClose = NO;
+                continue;
             }
             else
-			{
-				if (initialBufferFilled == NO) {
-					[controller initialBufferFilled:self];
-				}
-				
-				DLog(@"End of stream? %@", [self properties]);
-
-				endOfStream = YES;
-				shouldClose = [controller endOfInputReached]; //Lets us know if we should keep going or not (occassionally, for track changes within a file)
-				DLog(@"closing? is %i", shouldClose);
-
-                // wait before exiting, as we might still get seeking request
-                DLog("InputNode: Before wait")
-                [exitAtTheEndOfTheStream waitIndefinitely];
-                DLog("InputNode: After wait, should seek = %d", shouldSeek)
-                if (shouldSeek)
-                {
-                    endOfStream = NO;
-                    shouldClose = NO;
-                    continue;
-                }
-                else
-                {
-                    break;
-                }
-			}
-        }
+            {
+                break;
+            }
+		}
 	}
 
 	if (shouldClose)
@@ -187,6 +208,21 @@
     DLog("Input node thread stopping");
 }
 
+- (int)readPrerendered:(void *)buf frames:(int)frames
+{
+	long available = ([prerendered length] - prerenderedOffset) / bytesPerFrame;
+	if (frames > available)
+		frames = (int)available;
+
+	memcpy(buf, ((const char *)[prerendered bytes]) + prerenderedOffset, frames * bytesPerFrame);
+	prerenderedOffset += frames * bytesPerFrame;
+
+	if (prerenderedOffset + bytesPerFrame > [prerendered length])
+		prerendered = nil;
+
+	return frames;
+}
+
 - (void)seek:(long)frame
 {
 	seekFrame = frame;
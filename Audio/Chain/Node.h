@@ -7,17 +7,15 @@
 //
 
 #import <Cocoa/Cocoa.h>
-#import "VirtualRingBuffer.h"
+#import "RingBuffer.h"
 #import "Semaphore.h"
 
 #define BUFFER_SIZE 1024 * 1024
 #define CHUNK_SIZE 16 * 1024
 
 @interface Node : NSObject {
-	VirtualRingBuffer *buffer;
+	RingBuffer *buffer;
 	Semaphore *semaphore;
-	NSLock *readLock;
-	NSLock *writeLock;
 	
 	id __weak previousNode;
 	id __weak controller;
@@ -33,6 +31,12 @@
 - (int)writeData:(void *)ptr amount:(int)a;
 - (int)readData:(void *)ptr amount:(int)a;
 
+// Waits for room in the buffer, and returns up to a bytes of contiguous space
+// to write into, or 0 when the node stops. Follow with -commitWrite: for the
+// amount actually written, which may be less.
+- (int)reserveWrite:(void **)ptr amount:(int)a;
+- (void)commitWrite:(int)a;
+
 - (void)process; //Should be overwriten by subclass
 - (void)threadEntry:(id)arg;
 
@@ -41,16 +45,13 @@
 - (void)setShouldReset:(BOOL)s;
 - (BOOL)shouldReset;
 
-- (NSLock *)readLock;
-- (NSLock *)writeLock;
-
 - (void)setPreviousNode:(id)p;
 - (id)previousNode;
 
 - (BOOL)shouldContinue;
 - (void)setShouldContinue:(BOOL)s;
 
-- (VirtualRingBuffer *)buffer;
+- (RingBuffer *)buffer;
 - (void)resetBuffer; //WARNING! DANGER WILL ROBINSON!
 
 - (Semaphore *)semaphore;
@@ -17,10 +17,14 @@
 	self = [super init];
 	if (self)
 	{
-		buffer = [[VirtualRingBuffer alloc] initWithLength:BUFFER_SIZE];
+		// The writer sleeps when the buffer fills, until a quarter is free
+		buffer = RingBufferCreate(BUFFER_SIZE, BUFFER_SIZE / 4);
+		if (!buffer)
+		{
+			ALog(@"Couldn't allocate the node buffer");
+			return nil;
+		}
 		semaphore = [[Semaphore alloc] init];
-		readLock = [[NSLock alloc] init];
-		writeLock = [[NSLock alloc] init];
 		
 		initialBufferFilled = NO;
 		
@@ -34,16 +38,16 @@
 	return self;
 }
 
-- (int)writeData:(void *)ptr amount:(int)amount
+- (void)dealloc
 {
-	void *writePtr;
-	int amountToCopy, availOutput;
-	int amountLeft = amount;
-	
-	[writeLock lock];
-	while (shouldContinue == YES && amountLeft > 0)
+	RingBufferRelease(buffer);
+}
+
+- (int)reserveWrite:(void **)ptr amount:(int)amount
+{
+	while (shouldContinue == YES)
 	{
-		availOutput = [buffer lengthAvailableToWriteReturningPointer:&writePtr];
+		int availOutput = (int)RingBufferReserveWrite(buffer, ptr);
 		if (availOutput == 0) {
 			if (initialBufferFilled == NO) {
 				initialBufferFilled = YES;
@@ -51,29 +55,55 @@
 					[controller performSelector:@selector(initialBufferFilled:) withObject:self];
 			}
 		}
-		
-		if (availOutput == 0 || shouldReset)
+
+		if (shouldReset)
 		{
-			[writeLock unlock];
 			[semaphore wait];
-			[writeLock lock];
+		}
+		else if (availOutput == 0)
+		{
+			// Woken by the reader once the buffer drains to the watermark
+			if (RingBufferPrepareWait(buffer))
+				[semaphore wait];
+			RingBufferEndWait(buffer);
 		}
 		else
 		{
-			amountToCopy = availOutput;
-			if (amountToCopy > amountLeft)
-				amountToCopy = amountLeft;
-			
-			memcpy(writePtr, &((char *)ptr)[amount - amountLeft], amountToCopy);
-			if (amountToCopy > 0)
-			{
-				[buffer didWriteLength:amountToCopy];
-			}
-			
-			amountLeft -= amountToCopy;
+			return (availOutput < amount) ? availOutput : amount;
 		}
 	}
-	[writeLock unlock];
+
+	return 0;
+}
+
+- (void)commitWrite:(int)amount
+{
+	// Written after a reset began, so hold it back until the next node has
+	// dropped the old contents
+	while (shouldReset == YES && shouldContinue == YES)
+		[semaphore wait];
+
+	if (amount > 0)
+		RingBufferCommitWrite(buffer, amount);
+}
+
+- (int)writeData:(void *)ptr amount:(int)amount
+{
+	void *writePtr;
+	int amountToCopy;
+	int amountLeft = amount;
+	
+	while (amountLeft > 0)
+	{
+		amountToCopy = [self reserveWrite:&writePtr amount:amountLeft];
+		if (amountToCopy == 0)
+			break;
+		
+		memcpy(writePtr, &((char *)ptr)[amount - amountLeft], amountToCopy);
+		[self commitWrite:amountToCopy];
+		
+		amountLeft -= amountToCopy;
+	}
 	
 	return (amount - amountLeft);
 }
@@ -92,12 +122,27 @@
 
 - (int)readData:(void *)ptr amount:(int)amount
 {
+	RingBuffer *previousBuffer = [previousNode buffer];
 	void *readPtr;
 	int amountToCopy;
+	int amountRead = 0;
 	int availInput;
+	BOOL wakeWriter = NO;
 	
-	[readLock lock];
-	availInput = [[previousNode buffer] lengthAvailableToReadReturningPointer:&readPtr];
+	if (previousBuffer == NULL)
+		return 0;
+	
+	if ([previousNode shouldReset] == YES) {
+		// Only the reading side may drop what is in the buffer
+		RingBufferDiscard(previousBuffer);
+
+		shouldReset = YES;
+		[previousNode setShouldReset: NO];
+
+		[[previousNode semaphore] signal];
+	}
+
+	availInput = (int)RingBufferReadAvailable(previousBuffer);
 	
 	if (availInput < amount && [previousNode endOfStream] == YES)
 	{
@@ -114,35 +159,26 @@
 	}
 */
 
-	if ([previousNode shouldReset] == YES) {
-		[writeLock lock];
-
-		[buffer empty];
-
-		shouldReset = YES;
-		[previousNode setShouldReset: NO];
-		[writeLock unlock];
-
-		[[previousNode semaphore] signal];
-	}
-
-	amountToCopy = availInput;
-	if (amountToCopy > amount)
+	while (amountRead < amount)
 	{
-		amountToCopy = amount;
+		amountToCopy = (int)RingBufferPeekRead(previousBuffer, &readPtr);
+		if (amountToCopy == 0)
+			break;
+		if (amountToCopy > amount - amountRead)
+			amountToCopy = amount - amountRead;
+		
+		memcpy(&((char *)ptr)[amountRead], readPtr, amountToCopy);
+		
+		if (RingBufferCommitRead(previousBuffer, amountToCopy))
+			wakeWriter = YES;
+		
+		amountRead += amountToCopy;
 	}
 	
-	memcpy(ptr, readPtr, amountToCopy);
-	
-	if (amountToCopy > 0)
-	{
-		[[previousNode buffer] didReadLength:amountToCopy];
-		
+	if (wakeWriter)
 		[[previousNode semaphore] signal];
-	}
-	[readLock unlock];
 	
-	return amountToCopy;
+	return amountRead;
 }
 
 - (void)launchThread
@@ -170,29 +206,14 @@
 	shouldContinue = s;
 }
 
-- (VirtualRingBuffer *)buffer
+- (RingBuffer *)buffer
 {
 	return buffer;
 }
 
 - (void)resetBuffer
 {
-	shouldReset = YES; //Will reset on next write.
-	if (previousNode == nil) {
-		[readLock lock];
-		[buffer empty];
-		[readLock unlock];
-	}
-}
-
-- (NSLock *)readLock
-{
-	return readLock;
-}
-
-- (NSLock *)writeLock
-{
-	return writeLock;
+	shouldReset = YES; //The next node drops the buffer on its next read.
 }
 
 - (Semaphore *)semaphore
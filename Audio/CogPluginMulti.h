@@ -30,6 +30,7 @@
 }
 
 + (NSDictionary *)metadataForURL:(NSURL *)url readers:(NSArray *)readers;
++ (Class)prefetchingReader:(NSArray *)readers;
 
 @end
 
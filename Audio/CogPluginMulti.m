@@ -167,6 +167,16 @@ NSArray * sortClassesByPriority(NSArray * theClasses)
     return nil;
 }
 
+// Only the reader tried first is worth reading ahead for
++ (Class)prefetchingReader:(NSArray *)readers
+{
+    NSArray * sortedReaders = sortClassesByPriority(readers);
+    Class reader = NSClassFromString([sortedReaders objectAtIndex:0]);
+    if ([reader respondsToSelector:@selector(prefetchMetadataForURLs:)])
+        return reader;
+    return nil;
+}
+
 @end
 
 @implementation CogPropertiesReaderMulti
@@ -54,6 +54,10 @@
 + (NSArray *)mimeTypes;
 + (float)priority;
 + (NSDictionary *)metadataForURL:(NSURL *)url;
+
+@optional
+// Reads ahead for a batch of files that metadataForURL: will be asked for
++ (void)prefetchMetadataForURLs:(NSArray *)urls;
 @end
 
 @protocol CogMetadataWriter <NSObject>
@@ -85,6 +89,7 @@
 - (id<CogSource>) audioSourceForURL:(NSURL *)url;
 - (NSArray *) urlsForContainerURL:(NSURL *)url;
 - (NSDictionary *) metadataForURL:(NSURL *)url;
+- (void) prefetchMetadataForURLs:(NSArray *)urls;
 - (NSDictionary *) propertiesForURL:(NSURL *)url;
 - (id<CogDecoder>) audioDecoderForSource:(id<CogSource>)source;
 
@@ -307,6 +307,37 @@ static PluginController *sharedPluginController = nil;
 	return [metadataReader metadataForURL:url];
 }
 
+- (void)prefetchMetadataForURLs:(NSArray *)urls
+{
+    NSMutableDictionary *urlsByReader = [NSMutableDictionary dictionary];
+
+    for (NSURL *url in urls)
+    {
+        NSArray *readers = [metadataReaders objectForKey:[[url pathExtension] lowercaseString]];
+        if (!readers)
+            continue;
+
+        Class metadataReader = [CogMetadataReaderMulti prefetchingReader:readers];
+        if (!metadataReader)
+            continue;
+
+        NSString *classString = NSStringFromClass(metadataReader);
+        NSMutableArray *readerURLs = [urlsByReader objectForKey:classString];
+        if (!readerURLs)
+        {
+            readerURLs = [NSMutableArray array];
+            [urlsByReader setObject:readerURLs forKey:classString];
+        }
+        [readerURLs addObject:url];
+    }
+
+    for (NSString *classString in urlsByReader)
+    {
+        Class metadataReader = NSClassFromString(classString);
+        [metadataReader prefetchMetadataForURLs:[urlsByReader objectForKey:classString]];
+    }
+}
+
 
 //If no properties reader is defined, use the decoder's properties.
 - (NSDictionary *)propertiesForURL:(NSURL *)url
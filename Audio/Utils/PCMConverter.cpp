@@ -0,0 +1,509 @@
+//
+//  PCMConverter.cpp
+//  CogAudio
+//
+//
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "PCMConverter.h"
+
+// Frames converted at a time, small enough for the scratch blocks to stay
+// in the L1 cache
+#define BLOCK_FRAMES 256
+#define MAX_CHANNELS 32
+
+typedef void (*UnpackFunc)(const uint8_t *input, float *output, size_t count, float scale);
+typedef void (*PackFunc)(const float *input, uint8_t *output, size_t count);
+
+enum {
+	MixCopy = 0,
+	MixDownmix,
+	MixSelect,
+	MixDuplicate
+};
+
+struct PCMConverter {
+	int inputChannels;
+	int outputChannels;
+	size_t inputSampleSize;
+	size_t outputSampleSize;
+
+	// Full scale for the input, so samples are +/-1.0 before the volume
+	float inputScale;
+
+	UnpackFunc unpack;
+	PackFunc pack;      // NULL when the output is native float
+	int mix;
+
+	std::atomic<float> volume;
+
+	float inputBlock[BLOCK_FRAMES * MAX_CHANNELS];
+	float outputBlock[BLOCK_FRAMES * 2];
+};
+
+static const float STEREO_DOWNMIX[8-2][8][2]={
+	/*3.0*/
+	{
+		{0.5858F,0.0F},{0.0F,0.5858F},{0.4142F,0.4142F}
+	},
+	/*quadrophonic*/
+	{
+		{0.4226F,0.0F},{0.0F,0.4226F},{0.366F,0.2114F},{0.2114F,0.336F}
+	},
+	/*5.0*/
+	{
+		{0.651F,0.0F},{0.0F,0.651F},{0.46F,0.46F},{0.5636F,0.3254F},
+		{0.3254F,0.5636F}
+	},
+	/*5.1*/
+	{
+		{0.529F,0.0F},{0.0F,0.529F},{0.3741F,0.3741F},{0.3741F,0.3741F},{0.4582F,0.2645F},
+		{0.2645F,0.4582F}
+	},
+	/*6.1*/
+	{
+		{0.4553F,0.0F},{0.0F,0.4553F},{0.322F,0.322F},{0.322F,0.322F},{0.3943F,0.2277F},
+		{0.2277F,0.3943F},{0.2788F,0.2788F}
+	},
+	/*7.1*/
+	{
+		{0.3886F,0.0F},{0.0F,0.3886F},{0.2748F,0.2748F},{0.2748F,0.2748F},{0.3366F,0.1943F},
+		{0.1943F,0.3366F},{0.3366F,0.1943F},{0.1943F,0.3366F}
+	}
+};
+
+static inline uint16_t swap16(uint16_t v) { return __builtin_bswap16(v); }
+static inline uint32_t swap32(uint32_t v) { return __builtin_bswap32(v); }
+static inline uint64_t swap64(uint64_t v) { return __builtin_bswap64(v); }
+
+// Loads go through memcpy, since the buffers are only byte aligned
+
+template <bool swap>
+static void unpack_s16(const uint8_t *input, float *output, size_t count, float scale)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint16_t v;
+		memcpy(&v, input + i * 2, 2);
+		if (swap) v = swap16(v);
+		output[i] = (float)(int16_t)v * scale;
+	}
+}
+
+template <bool swap>
+static void unpack_s32(const uint8_t *input, float *output, size_t count, float scale)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t v;
+		memcpy(&v, input + i * 4, 4);
+		if (swap) v = swap32(v);
+		output[i] = (float)(int32_t)v * scale;
+	}
+}
+
+template <bool swap>
+static void unpack_s24(const uint8_t *input, float *output, size_t count, float scale)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint8_t *p = input + i * 3;
+		uint32_t v;
+		if (swap)
+			v = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8);
+		else
+			v = ((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8);
+		output[i] = (float)((int32_t)v >> 8) * scale;
+	}
+}
+
+static void unpack_s8(const uint8_t *input, float *output, size_t count, float scale)
+{
+	for (size_t i = 0; i < count; ++i)
+		output[i] = (float)(int8_t)input[i] * scale;
+}
+
+static void unpack_u8(const uint8_t *input, float *output, size_t count, float scale)
+{
+	for (size_t i = 0; i < count; ++i)
+		output[i] = (float)((int)input[i] - 128) * scale;
+}
+
+template <bool swap>
+static void unpack_f32(const uint8_t *input, float *output, size_t count, float scale)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t v;
+		float f;
+		memcpy(&v, input + i * 4, 4);
+		if (swap) v = swap32(v);
+		memcpy(&f, &v, 4);
+		output[i] = f * scale;
+	}
+}
+
+template <bool swap>
+static void unpack_f64(const uint8_t *input, float *output, size_t count, float scale)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint64_t v;
+		double d;
+		memcpy(&v, input + i * 8, 8);
+		if (swap) v = swap64(v);
+		memcpy(&d, &v, 8);
+		output[i] = (float)d * scale;
+	}
+}
+
+// Rounds to nearest and clips. The comparisons are done on the scaled float,
+// since converting an out of range float to an integer is undefined.
+static inline int32_t float_to_int(float v, float full, float max)
+{
+	v *= full;
+	v = v < -full ? -full : v;
+	v = v > max ? max : v;
+	return (int32_t)(v + copysignf(0.5f, v));
+}
+
+template <bool swap>
+static void pack_s16(const float *input, uint8_t *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint16_t v = (uint16_t)float_to_int(input[i], 32768.0f, 32767.0f);
+		if (swap) v = swap16(v);
+		memcpy(output + i * 2, &v, 2);
+	}
+}
+
+template <bool swap>
+static void pack_s24(const float *input, uint8_t *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t v = (uint32_t)float_to_int(input[i], 8388608.0f, 8388607.0f);
+		uint8_t *p = output + i * 3;
+		if (swap)
+		{
+			p[0] = (uint8_t)(v >> 16); p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)v;
+		}
+		else
+		{
+			p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16);
+		}
+	}
+}
+
+template <bool swap>
+static void pack_s32(const float *input, uint8_t *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		// 2147483647 is not representable as a float, clip below it
+		uint32_t v = (uint32_t)float_to_int(input[i], 2147483648.0f, 2147483520.0f);
+		if (swap) v = swap32(v);
+		memcpy(output + i * 4, &v, 4);
+	}
+}
+
+static void pack_s8(const float *input, uint8_t *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		output[i] = (uint8_t)float_to_int(input[i], 128.0f, 127.0f);
+}
+
+template <bool swap>
+static void pack_f32(const float *input, uint8_t *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t v;
+		memcpy(&v, input + i, 4);
+		if (swap) v = swap32(v);
+		memcpy(output + i * 4, &v, 4);
+	}
+}
+
+template <bool swap>
+static void pack_f64(const float *input, uint8_t *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		double d = input[i];
+		uint64_t v;
+		memcpy(&v, &d, 8);
+		if (swap) v = swap64(v);
+		memcpy(output + i * 8, &v, 8);
+	}
+}
+
+// The channel count is a template parameter, so the compiler can unroll the
+// inner loop and keep the matrix in registers
+template <int channels>
+static void downmix_to_stereo(const float *input, float *output, size_t count, const float (*matrix)[2])
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		float left = 0, right = 0;
+		for (int j = 0; j < channels; ++j)
+		{
+			left += input[i * channels + j] * matrix[j][0];
+			right += input[i * channels + j] * matrix[j][1];
+		}
+		output[i * 2 + 0] = left;
+		output[i * 2 + 1] = right;
+	}
+}
+
+static void downmix_to_stereo(const float *input, float *output, int channels, size_t count, float volume)
+{
+	float matrix[8][2];
+
+	for (int j = 0; j < channels; ++j)
+	{
+		matrix[j][0] = STEREO_DOWNMIX[channels - 3][j][0] * volume;
+		matrix[j][1] = STEREO_DOWNMIX[channels - 3][j][1] * volume;
+	}
+
+	switch (channels)
+	{
+		case 3: downmix_to_stereo<3>(input, output, count, matrix); break;
+		case 4: downmix_to_stereo<4>(input, output, count, matrix); break;
+		case 5: downmix_to_stereo<5>(input, output, count, matrix); break;
+		case 6: downmix_to_stereo<6>(input, output, count, matrix); break;
+		case 7: downmix_to_stereo<7>(input, output, count, matrix); break;
+	}
+}
+
+static void select_stereo(const float *input, float *output, int channels, size_t count, float volume)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		output[i * 2 + 0] = input[i * channels + 0] * volume;
+		output[i * 2 + 1] = input[i * channels + 1] * volume;
+	}
+}
+
+static void duplicate_to_stereo(const float *input, float *output, size_t count, float volume)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		float sample = input[i] * volume;
+		output[i * 2 + 0] = sample;
+		output[i * 2 + 1] = sample;
+	}
+}
+
+static bool hostIsBigEndian()
+{
+#ifdef __BIG_ENDIAN__
+	return true;
+#else
+	return false;
+#endif
+}
+
+static UnpackFunc select_unpack(const PCMFormat *format, float *scale)
+{
+	bool swap = !!format->isBigEndian != hostIsBigEndian();
+
+	*scale = 1.0f;
+
+	if (format->isFloat)
+	{
+		switch (format->bitsPerSample)
+		{
+			case 32: return swap ? unpack_f32<true> : unpack_f32<false>;
+			case 64: return swap ? unpack_f64<true> : unpack_f64<false>;
+		}
+		return NULL;
+	}
+
+	switch (format->bitsPerSample)
+	{
+		case 8:
+			*scale = 1.0f / 128.0f;
+			return format->isSigned ? unpack_s8 : unpack_u8;
+	}
+
+	if (!format->isSigned)
+		return NULL;
+
+	switch (format->bitsPerSample)
+	{
+		case 16:
+			*scale = 1.0f / 32768.0f;
+			return swap ? unpack_s16<true> : unpack_s16<false>;
+
+		case 24:
+			*scale = 1.0f / 8388608.0f;
+			return swap ? unpack_s24<true> : unpack_s24<false>;
+
+		case 32:
+			*scale = 1.0f / 2147483648.0f;
+			return swap ? unpack_s32<true> : unpack_s32<false>;
+	}
+
+	return NULL;
+}
+
+static bool select_pack(const PCMFormat *format, PackFunc *pack)
+{
+	bool swap = !!format->isBigEndian != hostIsBigEndian();
+
+	*pack = NULL;
+
+	if (format->isFloat)
+	{
+		switch (format->bitsPerSample)
+		{
+			case 32:
+				if (swap)
+					*pack = pack_f32<true>;
+				return true;
+
+			case 64:
+				*pack = swap ? pack_f64<true> : pack_f64<false>;
+				return true;
+		}
+		return false;
+	}
+
+	if (!format->isSigned)
+		return false;
+
+	switch (format->bitsPerSample)
+	{
+		case 8:  *pack = pack_s8; return true;
+		case 16: *pack = swap ? pack_s16<true> : pack_s16<false>; return true;
+		case 24: *pack = swap ? pack_s24<true> : pack_s24<false>; return true;
+		case 32: *pack = swap ? pack_s32<true> : pack_s32<false>; return true;
+	}
+
+	return false;
+}
+
+PCMConverter *PCMConverterCreate(const PCMFormat *input, const PCMFormat *output)
+{
+	int mix;
+
+	if (input->channels <= 0 || input->channels > MAX_CHANNELS)
+		return NULL;
+
+	if (output->channels == input->channels)
+		mix = MixCopy;
+	else if (input->channels > 2 && output->channels == 2)
+		mix = (input->channels < 8) ? MixDownmix : MixSelect;
+	else if (input->channels == 1 && output->channels == 2)
+		mix = MixDuplicate;
+	else
+		return NULL;
+
+	float inputScale;
+	UnpackFunc unpack = select_unpack(input, &inputScale);
+	PackFunc pack;
+
+	if (!unpack || !select_pack(output, &pack))
+		return NULL;
+
+	PCMConverter *pc = new PCMConverter;
+
+	pc->inputChannels = input->channels;
+	pc->outputChannels = output->channels;
+	pc->inputSampleSize = input->bitsPerSample / 8;
+	pc->outputSampleSize = output->bitsPerSample / 8;
+	pc->inputScale = inputScale;
+	pc->unpack = unpack;
+	pc->pack = pack;
+	pc->mix = mix;
+	pc->volume.store(1.0f, std::memory_order_relaxed);
+
+	return pc;
+}
+
+void PCMConverterRelease(PCMConverter *pc)
+{
+	delete pc;
+}
+
+void PCMConverterSetVolume(PCMConverter *pc, float volume)
+{
+	pc->volume.store(volume, std::memory_order_relaxed);
+}
+
+size_t PCMConverterInputFrameSize(const PCMConverter *pc)
+{
+	return pc->inputSampleSize * pc->inputChannels;
+}
+
+size_t PCMConverterOutputFrameSize(const PCMConverter *pc)
+{
+	return pc->outputSampleSize * pc->outputChannels;
+}
+
+void PCMConverterProcess(PCMConverter *pc, const void *input, void *output, size_t frames)
+{
+	const uint8_t *in = (const uint8_t *)input;
+	uint8_t *out = (uint8_t *)output;
+	size_t inputFrameSize = PCMConverterInputFrameSize(pc);
+	size_t outputFrameSize = PCMConverterOutputFrameSize(pc);
+	float volume = pc->volume.load(std::memory_order_relaxed);
+
+	while (frames)
+	{
+		size_t blockFrames = frames < BLOCK_FRAMES ? frames : BLOCK_FRAMES;
+		size_t inputCount = blockFrames * pc->inputChannels;
+		size_t outputCount = blockFrames * pc->outputChannels;
+
+		if (pc->mix == MixCopy)
+		{
+			// The volume folds into the conversion to float, and native
+			// float output is written in the same pass
+			if (!pc->pack)
+				pc->unpack(in, (float *)out, inputCount, pc->inputScale * volume);
+			else
+			{
+				pc->unpack(in, pc->inputBlock, inputCount, pc->inputScale * volume);
+				pc->pack(pc->inputBlock, out, outputCount);
+			}
+		}
+		else
+		{
+			// The whole input block is read before any output is written,
+			// so this is safe in place
+			float *mixed = pc->pack ? pc->outputBlock : (float *)out;
+
+			pc->unpack(in, pc->inputBlock, inputCount, pc->inputScale);
+
+			switch (pc->mix)
+			{
+				case MixDownmix:
+					downmix_to_stereo(pc->inputBlock, mixed, pc->inputChannels, blockFrames, volume);
+					break;
+
+				case MixSelect:
+					select_stereo(pc->inputBlock, mixed, pc->inputChannels, blockFrames, volume);
+					break;
+
+				case MixDuplicate:
+					duplicate_to_stereo(pc->inputBlock, mixed, blockFrames, volume);
+					break;
+			}
+
+			if (pc->pack)
+				pc->pack(pc->outputBlock, out, outputCount);
+		}
+
+		in += blockFrames * inputFrameSize;
+		out += blockFrames * outputFrameSize;
+		frames -= blockFrames;
+	}
+}
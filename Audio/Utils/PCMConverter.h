@@ -0,0 +1,52 @@
+//
+//  PCMConverter.h
+//  CogAudio
+//
+//
+
+// Converts interleaved PCM from one sample format and channel count to
+// another, applying the volume on the way, in a single pass over each block
+// of frames. It does not resample.
+//
+// Plain C++ with no CoreAudio dependency. The inner loops are written so the
+// compiler vectorizes them for whatever the target has, SSE or NEON.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PCMFormat {
+	int channels;
+	int bitsPerSample;
+	int isFloat;
+	int isSigned;
+	int isBigEndian;
+} PCMFormat;
+
+typedef struct PCMConverter PCMConverter;
+
+// Integer input may be 8 (signed or unsigned), 16, 24 or 32 bits, and float
+// input 32 or 64 bits, in either byte order. Output is the same, except that
+// integer output is signed only. Channels are converted as follows:
+//  - same count in and out, copied
+//  - 3 to 7 channels to stereo, mixed down
+//  - more channels to stereo, the first two kept
+//  - mono to stereo, copied to both
+// Returns NULL for anything else.
+PCMConverter *PCMConverterCreate(const PCMFormat *input, const PCMFormat *output);
+void PCMConverterRelease(PCMConverter *pc);
+
+// May be called while another thread converts
+void PCMConverterSetVolume(PCMConverter *pc, float volume);
+
+size_t PCMConverterInputFrameSize(const PCMConverter *pc);
+size_t PCMConverterOutputFrameSize(const PCMConverter *pc);
+
+// The output may overlap the input exactly, if its frames are not larger.
+void PCMConverterProcess(PCMConverter *pc, const void *input, void *output, size_t frames);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+//
+//  RingBuffer.h
+//  CogAudio
+//
+//
+
+// Single producer, single consumer ring buffer. One thread writes and one
+// thread reads, without locks; the read and write positions are published
+// with release stores and picked up with acquire loads, and each sits on its
+// own cache line so the two threads do not contend for it.
+//
+// Space is handed out as contiguous regions, so a writer can decode straight
+// into the buffer: reserve a region, fill part of it, then commit what was
+// written. Reading works the same way.
+//
+// The buffer does not sleep or signal by itself. A writer that finds it full
+// calls RingBufferPrepareWait() before sleeping, and the reader wakes it once
+// RingBufferCommitRead() reports that the free space has reached the wake
+// length, rather than after every read.
+
+#include <stddef.h>
+
+typedef struct RingBuffer RingBuffer;
+
+// The length is rounded up to a power of two.
+RingBuffer *RingBufferCreate(size_t length, size_t wakeLength);
+void RingBufferRelease(RingBuffer *rb);
+
+size_t RingBufferLength(const RingBuffer *rb);
+
+// Writer side
+size_t RingBufferWriteAvailable(RingBuffer *rb);
+size_t RingBufferReserveWrite(RingBuffer *rb, void **ptr);
+void RingBufferCommitWrite(RingBuffer *rb, size_t length);
+
+// Returns nonzero if the writer should sleep until woken. Zero means the
+// reader freed enough space in the meantime. Call RingBufferEndWait() when
+// done either way.
+int RingBufferPrepareWait(RingBuffer *rb);
+void RingBufferEndWait(RingBuffer *rb);
+
+// Reader side
+size_t RingBufferReadAvailable(RingBuffer *rb);
+size_t RingBufferPeekRead(RingBuffer *rb, void **ptr);
+// Returns nonzero if a waiting writer should be woken.
+int RingBufferCommitRead(RingBuffer *rb, size_t length);
+// Drops everything written so far.
+void RingBufferDiscard(RingBuffer *rb);
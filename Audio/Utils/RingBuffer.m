@@ -0,0 +1,184 @@
+//
+//  RingBuffer.m
+//  CogAudio
+//
+//
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "RingBuffer.h"
+
+// Large enough for the 128 byte lines on Apple silicon
+#define CACHE_LINE_SIZE 128
+
+// The indexes count bytes since creation, and are only masked to find the
+// position in the buffer. With a power of two length they may wrap freely.
+struct RingBuffer {
+	char *buffer;
+	size_t length;
+	size_t mask;
+	size_t wakeLength;
+
+	// Writer's line
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t writeIndex;
+	size_t readIndexCache;
+
+	// Reader's line
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t readIndex;
+	size_t writeIndexCache;
+
+	_Alignas(CACHE_LINE_SIZE) atomic_int writerWaiting;
+};
+
+RingBuffer *RingBufferCreate(size_t length, size_t wakeLength)
+{
+	RingBuffer *rb;
+	size_t size = 1;
+
+	while (size < length)
+		size <<= 1;
+
+	if (posix_memalign((void **)&rb, CACHE_LINE_SIZE, sizeof(*rb)) != 0)
+		return NULL;
+
+	rb->buffer = malloc(size);
+	if (!rb->buffer)
+	{
+		free(rb);
+		return NULL;
+	}
+
+	rb->length = size;
+	rb->mask = size - 1;
+	rb->wakeLength = wakeLength < size ? wakeLength : size;
+
+	atomic_init(&rb->writeIndex, 0);
+	rb->readIndexCache = 0;
+	atomic_init(&rb->readIndex, 0);
+	rb->writeIndexCache = 0;
+	atomic_init(&rb->writerWaiting, 0);
+
+	return rb;
+}
+
+void RingBufferRelease(RingBuffer *rb)
+{
+	if (rb)
+	{
+		free(rb->buffer);
+		free(rb);
+	}
+}
+
+size_t RingBufferLength(const RingBuffer *rb)
+{
+	return rb->length;
+}
+
+size_t RingBufferWriteAvailable(RingBuffer *rb)
+{
+	size_t writeIndex = atomic_load_explicit(&rb->writeIndex, memory_order_relaxed);
+	rb->readIndexCache = atomic_load_explicit(&rb->readIndex, memory_order_acquire);
+	return rb->length - (writeIndex - rb->readIndexCache);
+}
+
+size_t RingBufferReserveWrite(RingBuffer *rb, void **ptr)
+{
+	size_t writeIndex = atomic_load_explicit(&rb->writeIndex, memory_order_relaxed);
+	size_t offset = writeIndex & rb->mask;
+	size_t contiguous = rb->length - offset;
+	size_t available = rb->length - (writeIndex - rb->readIndexCache);
+
+	// Only touch the reader's line when the cached position is too old to
+	// hand out the whole region
+	if (available < contiguous)
+	{
+		rb->readIndexCache = atomic_load_explicit(&rb->readIndex, memory_order_acquire);
+		available = rb->length - (writeIndex - rb->readIndexCache);
+	}
+
+	if (contiguous > available)
+		contiguous = available;
+
+	*ptr = rb->buffer + offset;
+	return contiguous;
+}
+
+void RingBufferCommitWrite(RingBuffer *rb, size_t length)
+{
+	size_t writeIndex = atomic_load_explicit(&rb->writeIndex, memory_order_relaxed);
+	atomic_store_explicit(&rb->writeIndex, writeIndex + length, memory_order_release);
+}
+
+int RingBufferPrepareWait(RingBuffer *rb)
+{
+	size_t writeIndex = atomic_load_explicit(&rb->writeIndex, memory_order_relaxed);
+
+	// Sequentially consistent, paired with the reader storing its index and
+	// then checking the flag: either the reader sees the flag, or this sees
+	// the space the reader freed.
+	atomic_store_explicit(&rb->writerWaiting, 1, memory_order_seq_cst);
+	rb->readIndexCache = atomic_load_explicit(&rb->readIndex, memory_order_seq_cst);
+
+	if (rb->length - (writeIndex - rb->readIndexCache) >= rb->wakeLength)
+	{
+		atomic_store_explicit(&rb->writerWaiting, 0, memory_order_relaxed);
+		return 0;
+	}
+
+	return 1;
+}
+
+void RingBufferEndWait(RingBuffer *rb)
+{
+	atomic_store_explicit(&rb->writerWaiting, 0, memory_order_relaxed);
+}
+
+size_t RingBufferReadAvailable(RingBuffer *rb)
+{
+	size_t readIndex = atomic_load_explicit(&rb->readIndex, memory_order_relaxed);
+	rb->writeIndexCache = atomic_load_explicit(&rb->writeIndex, memory_order_acquire);
+	return rb->writeIndexCache - readIndex;
+}
+
+size_t RingBufferPeekRead(RingBuffer *rb, void **ptr)
+{
+	size_t readIndex = atomic_load_explicit(&rb->readIndex, memory_order_relaxed);
+	size_t offset = readIndex & rb->mask;
+	size_t contiguous = rb->length - offset;
+	size_t available = rb->writeIndexCache - readIndex;
+
+	if (available < contiguous)
+	{
+		rb->writeIndexCache = atomic_load_explicit(&rb->writeIndex, memory_order_acquire);
+		available = rb->writeIndexCache - readIndex;
+	}
+
+	if (contiguous > available)
+		contiguous = available;
+
+	*ptr = rb->buffer + offset;
+	return contiguous;
+}
+
+int RingBufferCommitRead(RingBuffer *rb, size_t length)
+{
+	size_t readIndex = atomic_load_explicit(&rb->readIndex, memory_order_relaxed) + length;
+
+	atomic_store_explicit(&rb->readIndex, readIndex, memory_order_seq_cst);
+
+	// The flag stays set until the writer wakes, so a wakeup that is missed
+	// here is repeated on the next read
+	if (!atomic_load_explicit(&rb->writerWaiting, memory_order_seq_cst))
+		return 0;
+
+	rb->writeIndexCache = atomic_load_explicit(&rb->writeIndex, memory_order_acquire);
+	return rb->length - (rb->writeIndexCache - readIndex) >= rb->wakeLength;
+}
+
+void RingBufferDiscard(RingBuffer *rb)
+{
+	rb->writeIndexCache = atomic_load_explicit(&rb->writeIndex, memory_order_acquire);
+	atomic_store_explicit(&rb->readIndex, rb->writeIndexCache, memory_order_seq_cst);
+}
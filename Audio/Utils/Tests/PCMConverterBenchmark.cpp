@@ -0,0 +1,220 @@
+//
+//  PCMConverterBenchmark.cpp
+//  CogAudio
+//
+//
+
+// Measures PCMConverter against the separate passes ConverterNode used to
+// make over each chunk: convert to float, downmix_to_stereo(), then
+// scale_by_volume(), and for integer output a final pass to pack the
+// samples. The conversion passes stand in for the AudioConverter that did
+// that work, so only the arithmetic and memory traffic are compared.
+//
+// usage: PCMConverterBenchmark [million frames]
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "../PCMConverter.h"
+
+#define CHUNK_FRAMES 1024
+
+static const float STEREO_DOWNMIX[8-2][8][2]={
+	/*3.0*/
+	{
+		{0.5858F,0.0F},{0.0F,0.5858F},{0.4142F,0.4142F}
+	},
+	/*quadrophonic*/
+	{
+		{0.4226F,0.0F},{0.0F,0.4226F},{0.366F,0.2114F},{0.2114F,0.336F}
+	},
+	/*5.0*/
+	{
+		{0.651F,0.0F},{0.0F,0.651F},{0.46F,0.46F},{0.5636F,0.3254F},
+		{0.3254F,0.5636F}
+	},
+	/*5.1*/
+	{
+		{0.529F,0.0F},{0.0F,0.529F},{0.3741F,0.3741F},{0.3741F,0.3741F},{0.4582F,0.2645F},
+		{0.2645F,0.4582F}
+	},
+	/*6.1*/
+	{
+		{0.4553F,0.0F},{0.0F,0.4553F},{0.322F,0.322F},{0.322F,0.322F},{0.3943F,0.2277F},
+		{0.2277F,0.3943F},{0.2788F,0.2788F}
+	},
+	/*7.1*/
+	{
+		{0.3886F,0.0F},{0.0F,0.3886F},{0.2748F,0.2748F},{0.2748F,0.2748F},{0.3366F,0.1943F},
+		{0.1943F,0.3366F},{0.3366F,0.1943F},{0.1943F,0.3366F}
+	}
+};
+
+// The old passes, as ConverterNode had them
+
+static void downmix_to_stereo(float * buffer, int channels, int count)
+{
+	if (channels >= 3 && channels < 8)
+	for (int i = 0; i < count; ++i)
+	{
+		float left = 0, right = 0;
+		for (int j = 0; j < channels; ++j)
+		{
+			left += buffer[i * channels + j] * STEREO_DOWNMIX[channels - 3][j][0];
+			right += buffer[i * channels + j] * STEREO_DOWNMIX[channels - 3][j][1];
+		}
+		buffer[i * channels + 0] = left;
+		buffer[i * channels + 1] = right;
+	}
+}
+
+static void scale_by_volume(float * buffer, int count, float volume)
+{
+	if ( volume != 1.0 )
+		for (int i = 0; i < count; ++i )
+			buffer[i] *= volume;
+}
+
+static void convert_s16(const int16_t *input, float *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		output[i] = input[i] * (1.0f / 32768.0f);
+}
+
+static void convert_s24(const uint8_t *input, float *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint8_t *p = input + i * 3;
+		int32_t v = (int32_t)(((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8)) >> 8;
+		output[i] = v * (1.0f / 8388608.0f);
+	}
+}
+
+static void pack_s16(const float *input, int16_t *output, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		float v = input[i] * 32768.0f;
+		v = v < -32768.0f ? -32768.0f : v;
+		v = v > 32767.0f ? 32767.0f : v;
+		output[i] = (int16_t)lrintf(v);
+	}
+}
+
+enum {
+	S16StereoToFloat,
+	S24SurroundToFloat,
+	FloatStereoToS16,
+};
+
+struct Case {
+	const char *name;
+	int kind;
+	PCMFormat input, output;
+};
+
+static const Case cases[] = {
+	{ "16 bit stereo to float", S16StereoToFloat, { 2, 16, 0, 1, 0 }, { 2, 32, 1, 1, 0 } },
+	{ "24 bit 5.1 to float stereo", S24SurroundToFloat, { 6, 24, 0, 1, 0 }, { 2, 32, 1, 1, 0 } },
+	{ "float stereo to 16 bit", FloatStereoToS16, { 2, 32, 1, 1, 0 }, { 2, 16, 0, 1, 0 } },
+};
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ConverterNode only knew the channel count at run time
+static volatile int surroundChannels = 6;
+
+static double runSeparate(const Case &c, const uint8_t *input, uint8_t *output, float *scratch, size_t chunks)
+{
+	double start = now();
+
+	for (size_t n = 0; n < chunks; ++n)
+	{
+		switch (c.kind)
+		{
+			case S16StereoToFloat:
+				convert_s16((const int16_t *)input, (float *)output, CHUNK_FRAMES * 2);
+				scale_by_volume((float *)output, CHUNK_FRAMES * 2, 0.8f);
+				break;
+
+			case S24SurroundToFloat:
+			{
+				int channels = surroundChannels;
+				convert_s24(input, scratch, CHUNK_FRAMES * channels);
+				downmix_to_stereo(scratch, channels, CHUNK_FRAMES);
+				for (size_t i = 0; i < CHUNK_FRAMES; ++i)
+				{
+					((float *)output)[i * 2 + 0] = scratch[i * channels + 0];
+					((float *)output)[i * 2 + 1] = scratch[i * channels + 1];
+				}
+				scale_by_volume((float *)output, CHUNK_FRAMES * 2, 0.8f);
+				break;
+			}
+
+			case FloatStereoToS16:
+				memcpy(scratch, input, CHUNK_FRAMES * 2 * sizeof(float));
+				scale_by_volume(scratch, CHUNK_FRAMES * 2, 0.8f);
+				pack_s16(scratch, (int16_t *)output, CHUNK_FRAMES * 2);
+				break;
+		}
+	}
+
+	return now() - start;
+}
+
+static double runConverter(const Case &c, const uint8_t *input, uint8_t *output, size_t chunks)
+{
+	PCMConverter *pc = PCMConverterCreate(&c.input, &c.output);
+	double start;
+
+	PCMConverterSetVolume(pc, 0.8f);
+
+	start = now();
+	for (size_t n = 0; n < chunks; ++n)
+		PCMConverterProcess(pc, input, output, CHUNK_FRAMES);
+	start = now() - start;
+
+	PCMConverterRelease(pc);
+	return start;
+}
+
+int main(int argc, char **argv)
+{
+	double millions = argc > 1 ? atof(argv[1]) : 200;
+	size_t chunks = (size_t)(millions * 1e6 / CHUNK_FRAMES);
+	double frames = (double)chunks * CHUNK_FRAMES;
+	std::vector<uint8_t> input(CHUNK_FRAMES * 8 * 8), output(CHUNK_FRAMES * 8 * 8);
+	std::vector<float> scratch(CHUNK_FRAMES * 8);
+
+	for (size_t i = 0; i < input.size(); ++i)
+		input[i] = (uint8_t)(i * 7 + (i >> 5));
+	// Keep float input finite and in range
+	for (size_t i = 0; i < CHUNK_FRAMES * 2; ++i)
+	{
+		float f = sinf(i * 0.01f) * 1.1f;
+		memcpy(&input[i * 4], &f, 4);
+	}
+
+	printf("%.0f million frames, %d frames at a time\n", frames * 1e-6, CHUNK_FRAMES);
+	printf("%-28s %14s %14s\n", "", "separate", "PCMConverter");
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+	{
+		double separate = runSeparate(cases[i], &input[0], &output[0], &scratch[0], chunks);
+		double converter = runConverter(cases[i], &input[0], &output[0], chunks);
+		printf("%-28s %9.0f Mf/s %9.0f Mf/s\n", cases[i].name, frames / separate * 1e-6, frames / converter * 1e-6);
+	}
+
+	return 0;
+}
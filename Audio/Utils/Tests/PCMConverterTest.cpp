@@ -0,0 +1,518 @@
+//
+//  PCMConverterTest.cpp
+//  CogAudio
+//
+//
+
+// Tests for PCMConverter. Every supported input format is converted to
+// every output format, for each channel layout, and compared against a
+// reference written the simple way: decode each sample to double, mix it
+// down with the matrix ConverterNode used to apply, scale it, then round
+// and clip it to the output format. Further checks cover lossless copies,
+// clipping, byte order, in-place conversion, odd frame counts, the volume,
+// and the layouts PCMConverterCreate must refuse.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "../PCMConverter.h"
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); exit(1); } } while (0)
+
+// The matrix from ConverterNode before PCMConverter replaced it
+static const double STEREO_DOWNMIX[8-2][8][2]={
+	/*3.0*/
+	{
+		{0.5858F,0.0F},{0.0F,0.5858F},{0.4142F,0.4142F}
+	},
+	/*quadrophonic*/
+	{
+		{0.4226F,0.0F},{0.0F,0.4226F},{0.366F,0.2114F},{0.2114F,0.336F}
+	},
+	/*5.0*/
+	{
+		{0.651F,0.0F},{0.0F,0.651F},{0.46F,0.46F},{0.5636F,0.3254F},
+		{0.3254F,0.5636F}
+	},
+	/*5.1*/
+	{
+		{0.529F,0.0F},{0.0F,0.529F},{0.3741F,0.3741F},{0.3741F,0.3741F},{0.4582F,0.2645F},
+		{0.2645F,0.4582F}
+	},
+	/*6.1*/
+	{
+		{0.4553F,0.0F},{0.0F,0.4553F},{0.322F,0.322F},{0.322F,0.322F},{0.3943F,0.2277F},
+		{0.2277F,0.3943F},{0.2788F,0.2788F}
+	},
+	/*7.1*/
+	{
+		{0.3886F,0.0F},{0.0F,0.3886F},{0.2748F,0.2748F},{0.2748F,0.2748F},{0.3366F,0.1943F},
+		{0.1943F,0.3366F},{0.3366F,0.1943F},{0.1943F,0.3366F}
+	}
+};
+
+static PCMFormat makeFormat(int channels, int bits, int isFloat, int isSigned, int isBigEndian)
+{
+	PCMFormat format = { channels, bits, isFloat, isSigned, isBigEndian };
+	return format;
+}
+
+static const PCMFormat sampleFormats[] = {
+	{ 0, 8, 0, 0, 0 },
+	{ 0, 8, 0, 1, 0 },
+	{ 0, 16, 0, 1, 0 },
+	{ 0, 16, 0, 1, 1 },
+	{ 0, 24, 0, 1, 0 },
+	{ 0, 24, 0, 1, 1 },
+	{ 0, 32, 0, 1, 0 },
+	{ 0, 32, 0, 1, 1 },
+	{ 0, 32, 1, 1, 0 },
+	{ 0, 32, 1, 1, 1 },
+	{ 0, 64, 1, 1, 0 },
+	{ 0, 64, 1, 1, 1 },
+};
+
+static void describe(char *text, size_t size, const PCMFormat *f)
+{
+	snprintf(text, size, "%d ch %s%d%s", f->channels,
+		f->isFloat ? "f" : (f->isSigned ? "s" : "u"), f->bitsPerSample,
+		f->bitsPerSample > 8 ? (f->isBigEndian ? "be" : "le") : "");
+}
+
+static double fullScale(const PCMFormat *f)
+{
+	return ldexp(1.0, f->bitsPerSample - 1);
+}
+
+static void storeBytes(uint8_t *p, uint64_t v, int bytes, int bigEndian)
+{
+	for (int i = 0; i < bytes; ++i)
+		p[bigEndian ? bytes - 1 - i : i] = (uint8_t)(v >> (i * 8));
+}
+
+static uint64_t loadBytes(const uint8_t *p, int bytes, int bigEndian)
+{
+	uint64_t v = 0;
+	for (int i = 0; i < bytes; ++i)
+		v |= (uint64_t)p[bigEndian ? bytes - 1 - i : i] << (i * 8);
+	return v;
+}
+
+static void encode(const PCMFormat *f, uint8_t *p, double value)
+{
+	int bytes = f->bitsPerSample / 8;
+
+	if (f->isFloat)
+	{
+		if (bytes == 4)
+		{
+			float s = (float)value;
+			uint32_t v;
+			memcpy(&v, &s, 4);
+			storeBytes(p, v, 4, f->isBigEndian);
+		}
+		else
+		{
+			uint64_t v;
+			memcpy(&v, &value, 8);
+			storeBytes(p, v, 8, f->isBigEndian);
+		}
+		return;
+	}
+
+	double full = fullScale(f);
+	double scaled = floor(value * full + 0.5);
+	if (scaled < -full) scaled = -full;
+	if (scaled > full - 1) scaled = full - 1;
+	int64_t v = (int64_t)scaled;
+	if (!f->isSigned)
+		v += (int64_t)full;
+	storeBytes(p, (uint64_t)v, bytes, f->isBigEndian);
+}
+
+static double decode(const PCMFormat *f, const uint8_t *p)
+{
+	int bytes = f->bitsPerSample / 8;
+	uint64_t v = loadBytes(p, bytes, f->isBigEndian);
+
+	if (f->isFloat)
+	{
+		if (bytes == 4)
+		{
+			uint32_t v32 = (uint32_t)v;
+			float s;
+			memcpy(&s, &v32, 4);
+			return s;
+		}
+		double d;
+		memcpy(&d, &v, 8);
+		return d;
+	}
+
+	int64_t s = (int64_t)(v << (64 - f->bitsPerSample)) >> (64 - f->bitsPerSample);
+	if (!f->isSigned)
+		s = (int64_t)v - (int64_t)fullScale(f);
+	return s / fullScale(f);
+}
+
+static uint32_t nextRandom(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+// Random samples in +/-1.25, so integer output clips now and then
+static std::vector<uint8_t> makeInput(const PCMFormat *f, size_t frames, uint32_t seed)
+{
+	size_t count = frames * f->channels;
+	std::vector<uint8_t> data(count * (f->bitsPerSample / 8));
+	uint32_t random = seed;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		double value = ((double)(nextRandom(&random) % 2000001) - 1000000.0) / 800000.0;
+		if (!f->isFloat && value > 1.0) value = 1.0;
+		if (!f->isFloat && value < -1.0) value = -1.0;
+		encode(f, &data[i * (f->bitsPerSample / 8)], value);
+	}
+
+	return data;
+}
+
+static std::vector<uint8_t> reference(const PCMFormat *in, const PCMFormat *out, const std::vector<uint8_t> &input, size_t frames, double volume)
+{
+	size_t inSize = in->bitsPerSample / 8, outSize = out->bitsPerSample / 8;
+	std::vector<uint8_t> data(frames * out->channels * outSize);
+
+	for (size_t i = 0; i < frames; ++i)
+	{
+		const uint8_t *frame = &input[i * in->channels * inSize];
+		double mixed[32];
+
+		if (in->channels == out->channels)
+		{
+			for (int j = 0; j < in->channels; ++j)
+				mixed[j] = decode(in, frame + j * inSize);
+		}
+		else if (in->channels == 1)
+		{
+			mixed[0] = mixed[1] = decode(in, frame);
+		}
+		else if (in->channels < 8)
+		{
+			mixed[0] = mixed[1] = 0;
+			for (int j = 0; j < in->channels; ++j)
+			{
+				double s = decode(in, frame + j * inSize);
+				mixed[0] += s * STEREO_DOWNMIX[in->channels - 3][j][0];
+				mixed[1] += s * STEREO_DOWNMIX[in->channels - 3][j][1];
+			}
+		}
+		else
+		{
+			mixed[0] = decode(in, frame);
+			mixed[1] = decode(in, frame + inSize);
+		}
+
+		for (int j = 0; j < out->channels; ++j)
+			encode(out, &data[(i * out->channels + j) * outSize], mixed[j] * volume);
+	}
+
+	return data;
+}
+
+// The converter works in float. Output is allowed an error of a few float
+// roundings, and integer output one step more, for where the reference sits
+// next to a rounding edge.
+static void compare(const PCMFormat *in, const PCMFormat *out, const std::vector<uint8_t> &actual, const std::vector<uint8_t> &expected)
+{
+	size_t outSize = out->bitsPerSample / 8;
+	size_t count = expected.size() / outSize;
+	double tolerance = out->isFloat ? 1e-6 : 1.0 / fullScale(out) + 5e-7;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		double a = decode(out, &actual[i * outSize]);
+		double e = decode(out, &expected[i * outSize]);
+		double error = fabs(a - e);
+		double limit = out->isFloat ? tolerance * (fabs(e) > 1.0 ? fabs(e) : 1.0) : tolerance;
+		if (error > limit)
+		{
+			char inText[32], outText[32];
+			describe(inText, sizeof(inText), in);
+			describe(outText, sizeof(outText), out);
+			fprintf(stderr, "%s to %s: sample %zu is %.9g, expected %.9g\n", inText, outText, i, a, e);
+			exit(1);
+		}
+	}
+}
+
+static void testAllFormats(void)
+{
+	static const int layouts[][2] = {
+		{ 1, 1 }, { 2, 2 }, { 6, 6 }, { 1, 2 },
+		{ 3, 2 }, { 4, 2 }, { 5, 2 }, { 6, 2 }, { 7, 2 }, { 8, 2 }, { 12, 2 },
+	};
+	const size_t frames = 1000;
+	const size_t formatCount = sizeof(sampleFormats) / sizeof(sampleFormats[0]);
+	int conversions = 0;
+
+	for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); ++l)
+	{
+		for (size_t i = 0; i < formatCount; ++i)
+		{
+			for (size_t o = 0; o < formatCount; ++o)
+			{
+				PCMFormat in = sampleFormats[i], out = sampleFormats[o];
+				in.channels = layouts[l][0];
+				out.channels = layouts[l][1];
+
+				PCMConverter *pc = PCMConverterCreate(&in, &out);
+				if (!out.isFloat && !out.isSigned)
+				{
+					CHECK(pc == NULL);
+					continue;
+				}
+				CHECK(pc != NULL);
+				CHECK(PCMConverterInputFrameSize(pc) == (size_t)(in.channels * in.bitsPerSample / 8));
+				CHECK(PCMConverterOutputFrameSize(pc) == (size_t)(out.channels * out.bitsPerSample / 8));
+
+				std::vector<uint8_t> input = makeInput(&in, frames, 0x9E3779B9u + (uint32_t)(l * 131 + i));
+				std::vector<uint8_t> output(frames * PCMConverterOutputFrameSize(pc));
+
+				PCMConverterProcess(pc, &input[0], &output[0], frames);
+				compare(&in, &out, output, reference(&in, &out, input, frames, 1.0));
+
+				PCMConverterSetVolume(pc, 0.3f);
+				PCMConverterProcess(pc, &input[0], &output[0], frames);
+				compare(&in, &out, output, reference(&in, &out, input, frames, 0.3f));
+
+				PCMConverterRelease(pc);
+				++conversions;
+			}
+		}
+	}
+
+	printf("%d conversions match the reference\n", conversions);
+}
+
+// Integer copies of the same depth, and 16 and 24 bit through float,
+// must not change a single sample
+static void testLossless(void)
+{
+	static const int bits[] = { 8, 16, 24 };
+	const size_t frames = 3000;
+
+	for (size_t b = 0; b < sizeof(bits) / sizeof(bits[0]); ++b)
+	{
+		PCMFormat in = makeFormat(2, bits[b], 0, 1, 0);
+		PCMFormat swapped = makeFormat(2, bits[b], 0, 1, 1);
+		PCMFormat f32 = makeFormat(2, 32, 1, 1, 0);
+		std::vector<uint8_t> input = makeInput(&in, frames, 12345);
+		std::vector<uint8_t> floats(frames * 8), output(input.size());
+
+		PCMConverter *pc = PCMConverterCreate(&in, &in);
+		PCMConverterProcess(pc, &input[0], &output[0], frames);
+		CHECK(output == input);
+		PCMConverterRelease(pc);
+
+		pc = PCMConverterCreate(&in, &f32);
+		PCMConverterProcess(pc, &input[0], &floats[0], frames);
+		PCMConverterRelease(pc);
+		pc = PCMConverterCreate(&f32, &swapped);
+		PCMConverterProcess(pc, &floats[0], &output[0], frames);
+		PCMConverterRelease(pc);
+		pc = PCMConverterCreate(&swapped, &in);
+		PCMConverterProcess(pc, &output[0], &output[0], frames);
+		CHECK(output == input);
+		PCMConverterRelease(pc);
+	}
+}
+
+static void testClipping(void)
+{
+	PCMFormat f32 = makeFormat(1, 32, 1, 1, 0);
+	const float input[] = { 2.0f, -2.0f, 1.0f, -1.0f, 0.99999f, 1e-9f, -1e-9f, 0.5f / 32768.0f, -1.5f / 32768.0f };
+	const int16_t expected16[] = { 32767, -32768, 32767, -32768, 32767, 0, 0, 1, -2 };
+	const int32_t expected32[] = { 2147483520, -2147483647 - 1, 2147483520, -2147483647 - 1 };
+	const size_t count = sizeof(input) / sizeof(input[0]);
+	int16_t output16[count];
+	int32_t output32[count];
+	uint8_t output24[count * 3];
+
+	PCMFormat s16 = makeFormat(1, 16, 0, 1, 0);
+	PCMConverter *pc = PCMConverterCreate(&f32, &s16);
+	PCMConverterProcess(pc, input, output16, count);
+	CHECK(memcmp(output16, expected16, sizeof(expected16)) == 0);
+	PCMConverterRelease(pc);
+
+	PCMFormat s24 = makeFormat(1, 24, 0, 1, 0);
+	pc = PCMConverterCreate(&f32, &s24);
+	PCMConverterProcess(pc, input, output24, count);
+	CHECK(output24[0] == 0xFF && output24[1] == 0xFF && output24[2] == 0x7F);
+	CHECK(output24[3] == 0x00 && output24[4] == 0x00 && output24[5] == 0x80);
+	PCMConverterRelease(pc);
+
+	PCMFormat s32 = makeFormat(1, 32, 0, 1, 0);
+	pc = PCMConverterCreate(&f32, &s32);
+	PCMConverterProcess(pc, input, output32, count);
+	CHECK(memcmp(output32, expected32, sizeof(expected32)) == 0);
+	PCMConverterRelease(pc);
+}
+
+static void testByteOrder(void)
+{
+	const uint8_t be16[] = { 0x12, 0x34, 0xFF, 0xFE };
+	const uint8_t be24[] = { 0x12, 0x34, 0x56, 0x80, 0x00, 0x01 };
+	const uint8_t u8[] = { 0x00, 0x80, 0xFF };
+	float output[3];
+
+	PCMFormat f32 = makeFormat(1, 32, 1, 1, 0);
+	PCMFormat in = makeFormat(1, 16, 0, 1, 1);
+	PCMConverter *pc = PCMConverterCreate(&in, &f32);
+	PCMConverterProcess(pc, be16, output, 2);
+	CHECK(output[0] == 0x1234 / 32768.0f && output[1] == -2 / 32768.0f);
+	PCMConverterRelease(pc);
+
+	in = makeFormat(1, 24, 0, 1, 1);
+	pc = PCMConverterCreate(&in, &f32);
+	PCMConverterProcess(pc, be24, output, 2);
+	CHECK(output[0] == 0x123456 / 8388608.0f && output[1] == -0x7FFFFF / 8388608.0f);
+	PCMConverterRelease(pc);
+
+	in = makeFormat(1, 8, 0, 0, 0);
+	pc = PCMConverterCreate(&in, &f32);
+	PCMConverterProcess(pc, u8, output, 3);
+	CHECK(output[0] == -1.0f && output[1] == 0.0f && output[2] == 127 / 128.0f);
+	PCMConverterRelease(pc);
+
+	// Big endian output, from the same value
+	int16_t one = 0x1234;
+	uint8_t swapped[2];
+	in = makeFormat(1, 16, 0, 1, 0);
+	PCMFormat out = makeFormat(1, 16, 0, 1, 1);
+	pc = PCMConverterCreate(&in, &out);
+	PCMConverterProcess(pc, &one, swapped, 1);
+	CHECK(swapped[0] == 0x12 && swapped[1] == 0x34);
+	PCMConverterRelease(pc);
+}
+
+// In place, where the output frames are not larger, must give the same
+// result as converting into a separate buffer. The frame count is not a
+// multiple of the block size.
+static void testInPlace(void)
+{
+	static const int layouts[][2] = { { 2, 2 }, { 6, 2 }, { 8, 2 } };
+	static const PCMFormat formats[][2] = {
+		{ { 0, 32, 1, 1, 0 }, { 0, 32, 1, 1, 0 } },
+		{ { 0, 32, 1, 1, 0 }, { 0, 16, 0, 1, 0 } },
+		{ { 0, 24, 0, 1, 0 }, { 0, 16, 0, 1, 1 } },
+		{ { 0, 64, 1, 1, 1 }, { 0, 32, 1, 1, 0 } },
+		{ { 0, 32, 0, 1, 0 }, { 0, 32, 1, 1, 0 } },
+	};
+	const size_t frames = 1234;
+
+	for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); ++l)
+	{
+		for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+		{
+			PCMFormat in = formats[f][0], out = formats[f][1];
+			in.channels = layouts[l][0];
+			out.channels = layouts[l][1];
+
+			PCMConverter *pc = PCMConverterCreate(&in, &out);
+			CHECK(pc != NULL);
+			PCMConverterSetVolume(pc, 0.7f);
+
+			std::vector<uint8_t> buffer = makeInput(&in, frames, 777);
+			std::vector<uint8_t> separate(frames * PCMConverterOutputFrameSize(pc));
+			PCMConverterProcess(pc, &buffer[0], &separate[0], frames);
+			PCMConverterProcess(pc, &buffer[0], &buffer[0], frames);
+			CHECK(memcmp(&buffer[0], &separate[0], separate.size()) == 0);
+
+			PCMConverterRelease(pc);
+		}
+	}
+}
+
+// Against the two passes ConverterNode made before, on float input:
+// downmix_to_stereo(), then scale_by_volume()
+static void testOldDownmix(void)
+{
+	const size_t frames = 4096;
+	float maxError = 0;
+
+	for (int channels = 3; channels < 8; ++channels)
+	{
+		PCMFormat in = makeFormat(channels, 32, 1, 1, 0), out = makeFormat(2, 32, 1, 1, 0);
+		std::vector<uint8_t> input = makeInput(&in, frames, 4242 + channels);
+		std::vector<float> output(frames * 2);
+		const float *samples = (const float *)&input[0];
+		const float volume = 0.8125f;
+
+		PCMConverter *pc = PCMConverterCreate(&in, &out);
+		PCMConverterSetVolume(pc, volume);
+		PCMConverterProcess(pc, samples, &output[0], frames);
+		PCMConverterRelease(pc);
+
+		for (size_t i = 0; i < frames; ++i)
+		{
+			float left = 0, right = 0;
+			for (int j = 0; j < channels; ++j)
+			{
+				left += samples[i * channels + j] * (float)STEREO_DOWNMIX[channels - 3][j][0];
+				right += samples[i * channels + j] * (float)STEREO_DOWNMIX[channels - 3][j][1];
+			}
+			left *= volume;
+			right *= volume;
+
+			float errorLeft = fabsf(output[i * 2 + 0] - left);
+			float errorRight = fabsf(output[i * 2 + 1] - right);
+			if (errorLeft > maxError) maxError = errorLeft;
+			if (errorRight > maxError) maxError = errorRight;
+		}
+	}
+
+	printf("largest difference from the old downmix: %g\n", maxError);
+	CHECK(maxError < 1e-6f);
+}
+
+static void testRefused(void)
+{
+	static const PCMFormat refused[][2] = {
+		{ { 2, 16, 0, 1, 0 }, { 1, 16, 0, 1, 0 } },
+		{ { 4, 16, 0, 1, 0 }, { 3, 16, 0, 1, 0 } },
+		{ { 1, 16, 0, 1, 0 }, { 6, 16, 0, 1, 0 } },
+		{ { 0, 16, 0, 1, 0 }, { 0, 16, 0, 1, 0 } },
+		{ { 33, 16, 0, 1, 0 }, { 2, 16, 0, 1, 0 } },
+		{ { 2, 16, 0, 0, 0 }, { 2, 16, 0, 1, 0 } },
+		{ { 2, 12, 0, 1, 0 }, { 2, 16, 0, 1, 0 } },
+		{ { 2, 16, 1, 1, 0 }, { 2, 32, 1, 1, 0 } },
+		{ { 2, 16, 0, 1, 0 }, { 2, 8, 0, 0, 0 } },
+		{ { 2, 16, 0, 1, 0 }, { 2, 20, 0, 1, 0 } },
+	};
+
+	for (size_t i = 0; i < sizeof(refused) / sizeof(refused[0]); ++i)
+		CHECK(PCMConverterCreate(&refused[i][0], &refused[i][1]) == NULL);
+}
+
+int main(void)
+{
+	testAllFormats();
+	testLossless();
+	testClipping();
+	testByteOrder();
+	testInPlace();
+	testOldDownmix();
+	testRefused();
+
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,247 @@
+//
+//  RingBufferBenchmark.c
+//  CogAudio
+//
+//
+
+// Measures how fast a writer and a reader thread move data through
+// RingBuffer, for a range of chunk sizes. Both threads copy every chunk,
+// and the writer sleeps through the PrepareWait/CommitRead handshake when
+// the buffer is full, as Node does. For comparison, the same transfer is
+// run through a ring buffer whose indexes are guarded by a mutex, which is
+// how the buffer between nodes used to be locked.
+//
+// usage: RingBufferBenchmark [megabytes]
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../RingBuffer.h"
+
+#define BUFFER_SIZE (1024 * 1024)
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int count;
+} BenchSemaphore;
+
+static void semaphoreSignal(BenchSemaphore *s)
+{
+	pthread_mutex_lock(&s->mutex);
+	s->count++;
+	pthread_cond_signal(&s->cond);
+	pthread_mutex_unlock(&s->mutex);
+}
+
+static void semaphoreWait(BenchSemaphore *s)
+{
+	pthread_mutex_lock(&s->mutex);
+	while (s->count == 0)
+		pthread_cond_wait(&s->cond, &s->mutex);
+	s->count--;
+	pthread_mutex_unlock(&s->mutex);
+}
+
+// Mutex-guarded ring buffer, with a condition variable for the full case
+typedef struct {
+	char *buffer;
+	size_t length;
+	size_t readIndex, writeIndex;
+	pthread_mutex_t mutex;
+	pthread_cond_t notFull;
+} LockedRing;
+
+typedef struct {
+	size_t total;
+	size_t chunk;
+	int locked;
+
+	RingBuffer *rb;
+	BenchSemaphore semaphore;
+	LockedRing ring;
+	atomic_int writerDone;
+} Bench;
+
+static void *lockFreeWriter(void *arg)
+{
+	Bench *b = arg;
+	char *source = calloc(1, b->chunk);
+	size_t done = 0;
+
+	while (done < b->total)
+	{
+		void *ptr;
+		size_t n = RingBufferReserveWrite(b->rb, &ptr);
+		if (n == 0)
+		{
+			if (RingBufferPrepareWait(b->rb))
+				semaphoreWait(&b->semaphore);
+			RingBufferEndWait(b->rb);
+			continue;
+		}
+		if (n > b->chunk)
+			n = b->chunk;
+		memcpy(ptr, source, n);
+		RingBufferCommitWrite(b->rb, n);
+		done += n;
+	}
+
+	atomic_store(&b->writerDone, 1);
+	free(source);
+	return NULL;
+}
+
+static void *lockFreeReader(void *arg)
+{
+	Bench *b = arg;
+	char *dest = malloc(b->chunk);
+
+	for (;;)
+	{
+		void *ptr;
+		size_t n = RingBufferPeekRead(b->rb, &ptr);
+		if (n == 0)
+		{
+			if (atomic_load(&b->writerDone) && RingBufferReadAvailable(b->rb) == 0)
+				break;
+			continue;
+		}
+		if (n > b->chunk)
+			n = b->chunk;
+		memcpy(dest, ptr, n);
+		if (RingBufferCommitRead(b->rb, n))
+			semaphoreSignal(&b->semaphore);
+	}
+
+	free(dest);
+	return NULL;
+}
+
+static void *lockedWriter(void *arg)
+{
+	Bench *b = arg;
+	LockedRing *r = &b->ring;
+	char *source = calloc(1, b->chunk);
+	size_t done = 0;
+
+	while (done < b->total)
+	{
+		size_t offset, n;
+
+		pthread_mutex_lock(&r->mutex);
+		while (r->writeIndex - r->readIndex == r->length)
+			pthread_cond_wait(&r->notFull, &r->mutex);
+		offset = r->writeIndex % r->length;
+		n = r->length - (r->writeIndex - r->readIndex);
+		if (n > r->length - offset)
+			n = r->length - offset;
+		if (n > b->chunk)
+			n = b->chunk;
+		memcpy(r->buffer + offset, source, n);
+		r->writeIndex += n;
+		pthread_mutex_unlock(&r->mutex);
+
+		done += n;
+	}
+
+	atomic_store(&b->writerDone, 1);
+	free(source);
+	return NULL;
+}
+
+static void *lockedReader(void *arg)
+{
+	Bench *b = arg;
+	LockedRing *r = &b->ring;
+	char *dest = malloc(b->chunk);
+
+	for (;;)
+	{
+		size_t offset, n;
+		int done = atomic_load(&b->writerDone);
+
+		pthread_mutex_lock(&r->mutex);
+		offset = r->readIndex % r->length;
+		n = r->writeIndex - r->readIndex;
+		if (n > r->length - offset)
+			n = r->length - offset;
+		if (n > b->chunk)
+			n = b->chunk;
+		memcpy(dest, r->buffer + offset, n);
+		r->readIndex += n;
+		if (n)
+			pthread_cond_signal(&r->notFull);
+		pthread_mutex_unlock(&r->mutex);
+
+		if (n == 0 && done)
+			break;
+	}
+
+	free(dest);
+	return NULL;
+}
+
+static double run(size_t total, size_t chunk, int locked)
+{
+	Bench b;
+	pthread_t writer, reader;
+	struct timespec start, end;
+
+	memset(&b, 0, sizeof(b));
+	b.total = total;
+	b.chunk = chunk;
+	atomic_init(&b.writerDone, 0);
+	pthread_mutex_init(&b.semaphore.mutex, NULL);
+	pthread_cond_init(&b.semaphore.cond, NULL);
+
+	if (locked)
+	{
+		b.ring.buffer = malloc(BUFFER_SIZE);
+		b.ring.length = BUFFER_SIZE;
+		pthread_mutex_init(&b.ring.mutex, NULL);
+		pthread_cond_init(&b.ring.notFull, NULL);
+	}
+	else
+	{
+		b.rb = RingBufferCreate(BUFFER_SIZE, BUFFER_SIZE / 4);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_create(&writer, NULL, locked ? lockedWriter : lockFreeWriter, &b);
+	pthread_create(&reader, NULL, locked ? lockedReader : lockFreeReader, &b);
+	pthread_join(writer, NULL);
+	pthread_join(reader, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (locked)
+		free(b.ring.buffer);
+	else
+		RingBufferRelease(b.rb);
+
+	return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+	static const size_t chunks[] = { 64, 512, 4096, 32768 };
+	size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 2048;
+	size_t total = megabytes * 1024 * 1024;
+	size_t i;
+
+	printf("%zu MB through a %d KB buffer\n", megabytes, BUFFER_SIZE / 1024);
+	printf("chunk      lock-free      mutex\n");
+	for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+	{
+		double lockFree = run(total, chunks[i], 0);
+		double locked = run(total, chunks[i], 1);
+		printf("%6zu  %8.0f MB/s  %6.0f MB/s\n", chunks[i], megabytes / lockFree, megabytes / locked);
+	}
+
+	return 0;
+}
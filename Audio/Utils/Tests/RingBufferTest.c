@@ -0,0 +1,321 @@
+//
+//  RingBufferTest.c
+//  CogAudio
+//
+//
+
+// Tests for RingBuffer. The first part checks wraparound and discarding
+// from a single thread. The second part runs a writer and a reader thread
+// against a small buffer, with random chunk sizes, random discards, and the
+// writer sleeping through the PrepareWait/CommitRead handshake the same way
+// Node does, with a counting semaphore. A writer that sleeps for two
+// seconds while enough space is free has missed its wakeup, and fails the
+// test.
+//
+// The stream consists of 64-bit sequence numbers, so the reader can check
+// that nothing is lost, reordered or repeated. After a discard it only
+// checks that the numbers keep increasing.
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../RingBuffer.h"
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); exit(1); } } while (0)
+
+static void testSingleThread(void)
+{
+	RingBuffer *rb = RingBufferCreate(1000, 256);
+	void *ptr, *base;
+	size_t n;
+	int i;
+
+	CHECK(rb);
+	CHECK(RingBufferLength(rb) == 1024);
+	CHECK(RingBufferWriteAvailable(rb) == 1024);
+	CHECK(RingBufferReadAvailable(rb) == 0);
+
+	// Fill, then read most of it back
+	n = RingBufferReserveWrite(rb, &base);
+	CHECK(n == 1024);
+	for (i = 0; i < 1024; i++)
+		((unsigned char *)base)[i] = (unsigned char)i;
+	RingBufferCommitWrite(rb, 1024);
+	CHECK(RingBufferReserveWrite(rb, &ptr) == 0);
+	CHECK(RingBufferReadAvailable(rb) == 1024);
+
+	n = RingBufferPeekRead(rb, &ptr);
+	CHECK(n == 1024 && ptr == base);
+	CHECK(RingBufferCommitRead(rb, 1000) == 0);
+
+	// The free space is split: only the tail is contiguous
+	n = RingBufferReserveWrite(rb, &ptr);
+	CHECK(n == 1000 && ptr == base);
+	for (i = 0; i < 600; i++)
+		((unsigned char *)ptr)[i] = (unsigned char)(i + 7);
+	RingBufferCommitWrite(rb, 600);
+
+	// Reading crosses the end: first the 24 old bytes, then the new ones
+	n = RingBufferPeekRead(rb, &ptr);
+	CHECK(n == 24 && ptr == (char *)base + 1000);
+	CHECK(((unsigned char *)ptr)[0] == (unsigned char)1000);
+	RingBufferCommitRead(rb, 24);
+	n = RingBufferPeekRead(rb, &ptr);
+	CHECK(n == 600 && ptr == base);
+	CHECK(((unsigned char *)ptr)[599] == (unsigned char)(599 + 7));
+	RingBufferCommitRead(rb, 100);
+
+	// Discarding drops what is left, and the next write continues after it
+	RingBufferDiscard(rb);
+	CHECK(RingBufferReadAvailable(rb) == 0);
+	CHECK(RingBufferWriteAvailable(rb) == 1024);
+	n = RingBufferReserveWrite(rb, &ptr);
+	CHECK(n == 424 && ptr == (char *)base + 600);
+
+	// A writer about to sleep is told to go on while the wake length is free
+	CHECK(RingBufferPrepareWait(rb) == 0);
+	RingBufferEndWait(rb);
+
+	// Otherwise it sleeps, and the reader reports the wakeup only once
+	// enough space is free
+	RingBufferCommitWrite(rb, 424);
+	n = RingBufferReserveWrite(rb, &ptr);
+	CHECK(n == 600);
+	RingBufferCommitWrite(rb, 600);
+	CHECK(RingBufferPrepareWait(rb) == 1);
+	RingBufferPeekRead(rb, &ptr);
+	CHECK(RingBufferCommitRead(rb, 200) == 0);
+	CHECK(RingBufferCommitRead(rb, 56) == 1);
+	CHECK(RingBufferCommitRead(rb, 1) == 1);
+	RingBufferEndWait(rb);
+	CHECK(RingBufferCommitRead(rb, 1) == 0);
+
+	RingBufferRelease(rb);
+}
+
+// Counting semaphore standing in for Semaphore
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int count;
+} TestSemaphore;
+
+static void semaphoreInit(TestSemaphore *s)
+{
+	pthread_mutex_init(&s->mutex, NULL);
+	pthread_cond_init(&s->cond, NULL);
+	s->count = 0;
+}
+
+static void semaphoreSignal(TestSemaphore *s)
+{
+	pthread_mutex_lock(&s->mutex);
+	s->count++;
+	pthread_cond_signal(&s->cond);
+	pthread_mutex_unlock(&s->mutex);
+}
+
+// Returns zero on timeout
+static int semaphoreWait(TestSemaphore *s, int seconds)
+{
+	struct timespec deadline;
+	int result = 1;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += seconds;
+
+	pthread_mutex_lock(&s->mutex);
+	while (s->count == 0)
+	{
+		if (pthread_cond_timedwait(&s->cond, &s->mutex, &deadline) == ETIMEDOUT)
+		{
+			result = 0;
+			break;
+		}
+	}
+	if (result)
+		s->count--;
+	pthread_mutex_unlock(&s->mutex);
+
+	return result;
+}
+
+typedef struct {
+	RingBuffer *rb;
+	TestSemaphore semaphore;
+	uint64_t records;
+	unsigned int discardOneIn;
+	uint64_t *end;
+	atomic_int writerDone;
+
+	// Results
+	uint64_t sleeps;
+	uint64_t wakeRaces;
+	uint64_t wraps;
+	uint64_t discards;
+	uint64_t received;
+} StressTest;
+
+static uint32_t nextRandom(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void *writerThread(void *arg)
+{
+	StressTest *t = arg;
+	uint32_t random = 0x12345678;
+	uint64_t next = 0;
+
+	while (next < t->records)
+	{
+		void *ptr;
+		size_t n = RingBufferReserveWrite(t->rb, &ptr) / sizeof(uint64_t);
+		size_t count, i;
+
+		if (n == 0)
+		{
+			if (RingBufferPrepareWait(t->rb))
+			{
+				t->sleeps++;
+				if (!semaphoreWait(&t->semaphore, 2))
+				{
+					// Nobody woke us, so the reader must still be busy
+					CHECK(RingBufferWriteAvailable(t->rb) < RingBufferLength(t->rb) / 4);
+				}
+			}
+			else
+			{
+				t->wakeRaces++;
+			}
+			RingBufferEndWait(t->rb);
+			continue;
+		}
+
+		count = 1 + nextRandom(&random) % n;
+		if (count > t->records - next)
+			count = t->records - next;
+		for (i = 0; i < count; i++)
+			((uint64_t *)ptr)[i] = next++;
+		RingBufferCommitWrite(t->rb, count * sizeof(uint64_t));
+	}
+
+	atomic_store(&t->writerDone, 1);
+	return NULL;
+}
+
+static void *readerThread(void *arg)
+{
+	StressTest *t = arg;
+	uint32_t random = 0x87654321;
+	uint64_t expected = 0;
+	int afterDiscard = 0;
+
+	for (;;)
+	{
+		void *ptr;
+		size_t n, count, i;
+
+		if (t->discardOneIn && nextRandom(&random) % t->discardOneIn == 0)
+		{
+			// As in Node: drop everything, then wake the writer
+			RingBufferDiscard(t->rb);
+			semaphoreSignal(&t->semaphore);
+			afterDiscard = 1;
+			t->discards++;
+		}
+
+		n = RingBufferPeekRead(t->rb, &ptr) / sizeof(uint64_t);
+		if (n == 0)
+		{
+			if (atomic_load(&t->writerDone) && RingBufferReadAvailable(t->rb) == 0)
+				break;
+			continue;
+		}
+
+		count = 1 + nextRandom(&random) % n;
+		for (i = 0; i < count; i++)
+		{
+			uint64_t value = ((uint64_t *)ptr)[i];
+			if (afterDiscard)
+			{
+				CHECK(value >= expected);
+				afterDiscard = 0;
+			}
+			else
+			{
+				CHECK(value == expected);
+			}
+			expected = value + 1;
+		}
+		if ((uint64_t *)ptr + count == t->end)
+			t->wraps++;
+		t->received += count;
+
+		if (RingBufferCommitRead(t->rb, count * sizeof(uint64_t)))
+			semaphoreSignal(&t->semaphore);
+	}
+
+	if (!t->discardOneIn)
+		CHECK(expected == t->records);
+
+	return NULL;
+}
+
+static void runStressTest(uint64_t records, unsigned int discardOneIn)
+{
+	StressTest t;
+	pthread_t writer, reader;
+	void *storage;
+
+	memset(&t, 0, sizeof(t));
+	t.rb = RingBufferCreate(4096, 1024);
+	CHECK(t.rb);
+	semaphoreInit(&t.semaphore);
+	t.records = records;
+	t.discardOneIn = discardOneIn;
+	atomic_init(&t.writerDone, 0);
+
+	// An empty buffer hands out all of its storage
+	CHECK(RingBufferReserveWrite(t.rb, &storage) == RingBufferLength(t.rb));
+	t.end = (uint64_t *)((char *)storage + RingBufferLength(t.rb));
+
+	pthread_create(&writer, NULL, writerThread, &t);
+	pthread_create(&reader, NULL, readerThread, &t);
+	pthread_join(writer, NULL);
+	pthread_join(reader, NULL);
+
+	printf("%llu records, %llu received, %llu discards, %llu wraps, writer slept %llu times, %llu races with the reader\n",
+		(unsigned long long)records, (unsigned long long)t.received, (unsigned long long)t.discards,
+		(unsigned long long)t.wraps, (unsigned long long)t.sleeps, (unsigned long long)t.wakeRaces);
+
+	CHECK(t.wraps > 0);
+	CHECK(t.sleeps > 0);
+	if (!discardOneIn)
+		CHECK(t.received == records);
+	else
+		CHECK(t.discards > 0);
+
+	RingBufferRelease(t.rb);
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t records = argc > 1 ? strtoull(argv[1], NULL, 10) : 20000000;
+
+	testSingleThread();
+	runStressTest(records, 0);
+	runStressTest(records, 100000);
+
+	printf("OK\n");
+	return 0;
+}
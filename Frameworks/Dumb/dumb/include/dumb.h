@@ -619,6 +619,7 @@ void dumb_destroy_click_remover_array(int n, DUMB_CLICK_REMOVER **cr);
 #define DUMB_RQ_N_LEVELS 6
 
 extern int dumb_resampling_quality; /* This specifies the default */
+extern int dumb_resampling_block;   /* Nonzero mixes a block at a time */
 void dumb_it_set_resampling_quality(DUMB_IT_SIGRENDERER *sigrenderer,
                                     int quality); /* This overrides it */
 
@@ -43,9 +43,15 @@
  */
 
 #include <math.h>
-#include "internal/resampler.h"
+#include "resampler.h"
 #include "internal/dumb.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 /* Compile with -DHEAVYDEBUG if you want to make sure the pick-up function is
  * called when it should be. There will be a considerable performance hit,
  * since at least one condition has to be tested for every sample generated.
@@ -77,6 +83,14 @@
  */
 int dumb_resampling_quality = DUMB_RQ_CUBIC;
 
+/* A global variable for choosing how each voice is resampled. When nonzero,
+ * the source is fed to the FIR resampler and the output is mixed a block at
+ * a time, with vector code where the CPU has it. When zero, every output
+ * sample makes its own round trip through the resampler, as DUMB has always
+ * done. Both give the same output.
+ */
+int dumb_resampling_block = 1;
+
 //#define MULSC(a, b) ((int)((LONG_LONG)(a) * (b) >> 16))
 //#define MULSC(a, b) ((a) * ((b) >> 2) >> 14)
 #define MULSCV(a, b) ((int)((LONG_LONG)(a) * (b) >> 32))
@@ -131,6 +145,183 @@ void _dumb_init_cubic(void) {
     done = 1;
 }
 
+/* The largest block the block resampler feeds or mixes at once. */
+#define RESAMPLE_BLOCK 256
+
+/* Block mixers. Each adds n resampled samples into dst, scaled by a volume
+ * and by 2^24 in the same order as the per-sample code, so the results are
+ * identical. When ramp is set, the volumes are arrays with one entry per
+ * sample; otherwise they point to a single value.
+ */
+static void mix_block_1_1(sample_t *dst, const float *src, const float *vol,
+                          int ramp, long n) {
+    long i = 0;
+#if defined(__SSE2__)
+    __m128 v = _mm_set1_ps(*vol);
+    const __m128 k = _mm_set1_ps(16777216.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 s = _mm_loadu_ps(src + i);
+        __m128i *d = (__m128i *)(dst + i);
+        if (ramp)
+            v = _mm_loadu_ps(vol + i);
+        s = _mm_mul_ps(_mm_mul_ps(s, v), k);
+        _mm_storeu_si128(
+            d, _mm_cvttps_epi32(_mm_add_ps(
+                   _mm_cvtepi32_ps(_mm_loadu_si128(d)), s)));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t v = vdupq_n_f32(*vol);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t s = vld1q_f32(src + i);
+        if (ramp)
+            v = vld1q_f32(vol + i);
+        s = vmulq_n_f32(vmulq_f32(s, v), 16777216.0f);
+        vst1q_s32(dst + i,
+                  vcvtq_s32_f32(vaddq_f32(vcvtq_f32_s32(vld1q_s32(dst + i)), s)));
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] += src[i] * vol[ramp ? i : 0] * 16777216.0f;
+}
+
+static void mix_block_1_2(sample_t *dst, const float *src, const float *lvol,
+                          const float *rvol, int ramp, long n) {
+    long i = 0;
+#if defined(__SSE2__)
+    __m128 lv = _mm_set1_ps(*lvol);
+    __m128 rv = _mm_set1_ps(*rvol);
+    const __m128 k = _mm_set1_ps(16777216.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 s = _mm_loadu_ps(src + i);
+        __m128 l, r;
+        __m128i *d = (__m128i *)(dst + i * 2);
+        if (ramp) {
+            lv = _mm_loadu_ps(lvol + i);
+            rv = _mm_loadu_ps(rvol + i);
+        }
+        l = _mm_mul_ps(_mm_mul_ps(s, lv), k);
+        r = _mm_mul_ps(_mm_mul_ps(s, rv), k);
+        _mm_storeu_si128(d, _mm_cvttps_epi32(_mm_add_ps(
+                                _mm_cvtepi32_ps(_mm_loadu_si128(d)),
+                                _mm_unpacklo_ps(l, r))));
+        _mm_storeu_si128(d + 1, _mm_cvttps_epi32(_mm_add_ps(
+                                    _mm_cvtepi32_ps(_mm_loadu_si128(d + 1)),
+                                    _mm_unpackhi_ps(l, r))));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t lv = vdupq_n_f32(*lvol);
+    float32x4_t rv = vdupq_n_f32(*rvol);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t s = vld1q_f32(src + i);
+        float32x4x2_t m;
+        int32x4x2_t d = vld2q_s32(dst + i * 2);
+        if (ramp) {
+            lv = vld1q_f32(lvol + i);
+            rv = vld1q_f32(rvol + i);
+        }
+        m.val[0] = vmulq_n_f32(vmulq_f32(s, lv), 16777216.0f);
+        m.val[1] = vmulq_n_f32(vmulq_f32(s, rv), 16777216.0f);
+        d.val[0] = vcvtq_s32_f32(vaddq_f32(vcvtq_f32_s32(d.val[0]), m.val[0]));
+        d.val[1] = vcvtq_s32_f32(vaddq_f32(vcvtq_f32_s32(d.val[1]), m.val[1]));
+        vst2q_s32(dst + i * 2, d);
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i * 2] += src[i] * lvol[ramp ? i : 0] * 16777216.0f;
+        dst[i * 2 + 1] += src[i] * rvol[ramp ? i : 0] * 16777216.0f;
+    }
+}
+
+static void mix_block_2_1(sample_t *dst, const float *lsrc, const float *rsrc,
+                          const float *lvol, const float *rvol, int ramp,
+                          long n) {
+    long i = 0;
+#if defined(__SSE2__)
+    __m128 lv = _mm_set1_ps(*lvol);
+    __m128 rv = _mm_set1_ps(*rvol);
+    const __m128 k = _mm_set1_ps(16777216.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 s;
+        __m128i *d = (__m128i *)(dst + i);
+        if (ramp) {
+            lv = _mm_loadu_ps(lvol + i);
+            rv = _mm_loadu_ps(rvol + i);
+        }
+        s = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(lsrc + i), lv),
+                                  _mm_mul_ps(_mm_loadu_ps(rsrc + i), rv)),
+                       k);
+        _mm_storeu_si128(
+            d, _mm_cvttps_epi32(_mm_add_ps(
+                   _mm_cvtepi32_ps(_mm_loadu_si128(d)), s)));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t lv = vdupq_n_f32(*lvol);
+    float32x4_t rv = vdupq_n_f32(*rvol);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t s;
+        if (ramp) {
+            lv = vld1q_f32(lvol + i);
+            rv = vld1q_f32(rvol + i);
+        }
+        s = vmulq_n_f32(vaddq_f32(vmulq_f32(vld1q_f32(lsrc + i), lv),
+                                  vmulq_f32(vld1q_f32(rsrc + i), rv)),
+                        16777216.0f);
+        vst1q_s32(dst + i,
+                  vcvtq_s32_f32(vaddq_f32(vcvtq_f32_s32(vld1q_s32(dst + i)), s)));
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] += (lsrc[i] * lvol[ramp ? i : 0] + rsrc[i] * rvol[ramp ? i : 0]) *
+                  16777216.0f;
+}
+
+static void mix_block_2_2(sample_t *dst, const float *lsrc, const float *rsrc,
+                          const float *lvol, const float *rvol, int ramp,
+                          long n) {
+    long i = 0;
+#if defined(__SSE2__)
+    __m128 lv = _mm_set1_ps(*lvol);
+    __m128 rv = _mm_set1_ps(*rvol);
+    const __m128 k = _mm_set1_ps(16777216.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 l, r;
+        __m128i *d = (__m128i *)(dst + i * 2);
+        if (ramp) {
+            lv = _mm_loadu_ps(lvol + i);
+            rv = _mm_loadu_ps(rvol + i);
+        }
+        l = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(lsrc + i), lv), k);
+        r = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(rsrc + i), rv), k);
+        _mm_storeu_si128(d, _mm_cvttps_epi32(_mm_add_ps(
+                                _mm_cvtepi32_ps(_mm_loadu_si128(d)),
+                                _mm_unpacklo_ps(l, r))));
+        _mm_storeu_si128(d + 1, _mm_cvttps_epi32(_mm_add_ps(
+                                    _mm_cvtepi32_ps(_mm_loadu_si128(d + 1)),
+                                    _mm_unpackhi_ps(l, r))));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t lv = vdupq_n_f32(*lvol);
+    float32x4_t rv = vdupq_n_f32(*rvol);
+    for (; i + 4 <= n; i += 4) {
+        int32x4x2_t d = vld2q_s32(dst + i * 2);
+        float32x4_t l, r;
+        if (ramp) {
+            lv = vld1q_f32(lvol + i);
+            rv = vld1q_f32(rvol + i);
+        }
+        l = vmulq_n_f32(vmulq_f32(vld1q_f32(lsrc + i), lv), 16777216.0f);
+        r = vmulq_n_f32(vmulq_f32(vld1q_f32(rsrc + i), rv), 16777216.0f);
+        d.val[0] = vcvtq_s32_f32(vaddq_f32(vcvtq_f32_s32(d.val[0]), l));
+        d.val[1] = vcvtq_s32_f32(vaddq_f32(vcvtq_f32_s32(d.val[1]), r));
+        vst2q_s32(dst + i * 2, d);
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i * 2] += lsrc[i] * lvol[ramp ? i : 0] * 16777216.0f;
+        dst[i * 2 + 1] += rsrc[i] * rvol[ramp ? i : 0] * 16777216.0f;
+    }
+}
+
 /* Create resamplers for 24-in-32-bit source samples. */
 
 /* #define SUFFIX
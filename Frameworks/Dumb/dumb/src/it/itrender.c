@@ -26,7 +26,7 @@
 #include "internal/it.h"
 #include "internal/lpc.h"
 
-#include "internal/resampler.h"
+#include "resampler.h"
 
 // Keep this disabled, as it's actually slower than the original C/integer
 // version
@@ -0,0 +1,129 @@
+/*
+ * dumbblockbench: times rendering synthetic IT modules with DUMB mixing each
+ * voice a block at a time and one sample at a time, at every resampling
+ * quality. Also reports how many voices were playing at most, counting the
+ * ones the new note actions left in the virtual channels.
+ *
+ * usage: dumbblockbench [seconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "dumb.h"
+#include "internal/it.h"
+#include "resampler.h"
+#include "dumbmodule.h"
+
+#define CHUNK 1024
+
+static const struct {
+    unsigned int seed;
+    int n_channels;
+} modules[] = {
+    {1, 16},
+    {2, 48},
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int count_voices(DUMB_IT_SIGRENDERER *itsr) {
+    int i, count = 0;
+    for (i = 0; i < DUMB_IT_N_CHANNELS; i++)
+        if (itsr->channel[i].playing)
+            count++;
+    for (i = 0; i < DUMB_IT_N_NNA_CHANNELS; i++)
+        if (itsr->playing[i])
+            count++;
+    return count;
+}
+
+/* Returns the seconds taken, and the most voices seen between chunks */
+static double render(DUH *duh, int quality, int block, long frames,
+                     int *max_voices) {
+    DUH_SIGRENDERER *sr = duh_start_sigrenderer(duh, 0, 2, 0);
+    DUMB_IT_SIGRENDERER *itsr;
+    sample_t **samples = allocate_sample_buffer(2, CHUNK);
+    long done = 0;
+    double start;
+
+    if (!sr || !samples) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    itsr = duh_get_it_sigrenderer(sr);
+    dumb_it_set_resampling_quality(itsr, quality);
+    dumb_it_set_ramp_style(itsr, 2);
+    dumb_resampling_block = block;
+
+    *max_voices = 0;
+    start = now();
+    while (done < frames) {
+        int voices;
+        dumb_silence(samples[0], CHUNK * 2);
+        if (duh_sigrenderer_generate_samples(sr, 1.0f, 65536.0f / 44100.0f,
+                                             CHUNK, samples) < CHUNK)
+            break;
+        done += CHUNK;
+        voices = count_voices(itsr);
+        if (voices > *max_voices)
+            *max_voices = voices;
+    }
+    start = now() - start;
+
+    destroy_sample_buffer(samples);
+    duh_end_sigrenderer(sr);
+    dumb_resampling_block = 1;
+    return start;
+}
+
+int main(int argc, char **argv) {
+    int seconds = argc > 1 ? atoi(argv[1]) : 20;
+    size_t m;
+
+    if (seconds <= 0)
+        return 1;
+
+    resampler_init();
+    _dumb_init_cubic();
+    _dumb_init_sse();
+
+    printf("%d s of each module, seconds to render:\n", seconds);
+    printf("%-12s %8s %8s %10s %8s\n", "", "quality", "block", "per sample",
+           "voices");
+
+    for (m = 0; m < sizeof(modules) / sizeof(modules[0]); m++) {
+        size_t size;
+        unsigned char *data =
+            make_it_module(modules[m].seed, modules[m].n_channels, &size);
+        DUMBFILE *f = data ? dumbfile_open_memory((const char *)data, size)
+                           : NULL;
+        DUH *duh = f ? dumb_read_it(f) : NULL;
+        int quality;
+
+        if (f)
+            dumbfile_close(f);
+        if (!duh) {
+            fprintf(stderr, "couldn't make module %d\n", (int)m);
+            return 1;
+        }
+
+        for (quality = 0; quality < DUMB_RQ_N_LEVELS; quality++) {
+            int voices;
+            double block = render(duh, quality, 1, seconds * 44100L, &voices);
+            double sample = render(duh, quality, 0, seconds * 44100L, &voices);
+            printf("%2d channels  %8d %8.2f %10.2f %8d\n",
+                   modules[m].n_channels, quality, block, sample, voices);
+        }
+
+        unload_duh(duh);
+        free(data);
+    }
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * dumbblockcheck: checks that DUMB mixes the same output a block at a time as
+ * it does one sample at a time.
+ *
+ * Synthetic IT modules are rendered by two sigrenderers side by side, one with
+ * dumb_resampling_block set and one without, at every resampling quality, to
+ * stereo and to mono. Each chunk of output must match to the last bit.
+ *
+ * usage: dumbblockcheck [seconds]
+ *
+ * Returns non-zero if any render differs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dumb.h"
+#include "internal/it.h"
+#include "resampler.h"
+#include "dumbmodule.h"
+
+#define CHUNK 1024
+
+static const struct {
+    unsigned int seed;
+    int n_channels;
+} modules[] = {
+    {1, 16},
+    {2, 48},
+};
+
+static DUH_SIGRENDERER *start(DUH *duh, int n_channels, int quality) {
+    DUH_SIGRENDERER *sr = duh_start_sigrenderer(duh, 0, n_channels, 0);
+    DUMB_IT_SIGRENDERER *itsr;
+    if (!sr)
+        return NULL;
+    itsr = duh_get_it_sigrenderer(sr);
+    dumb_it_set_resampling_quality(itsr, quality);
+    dumb_it_set_ramp_style(itsr, 2);
+    return sr;
+}
+
+static long render(DUH_SIGRENDERER *sr, int block, sample_t **samples,
+                   int n_channels) {
+    dumb_resampling_block = block;
+    dumb_silence(samples[0], CHUNK * n_channels);
+    return duh_sigrenderer_generate_samples(sr, 1.0f, 65536.0f / 44100.0f,
+                                            CHUNK, samples);
+}
+
+/* Returns the sample frame where the two first differ, or -1. Sets *silent
+ * if the renders never made a sound, which would prove nothing. */
+static long compare(DUH *duh, int n_channels, int quality, long frames,
+                    int *silent) {
+    DUH_SIGRENDERER *block_sr = start(duh, n_channels, quality);
+    DUH_SIGRENDERER *sample_sr = start(duh, n_channels, quality);
+    sample_t **block_out = allocate_sample_buffer(n_channels, CHUNK);
+    sample_t **sample_out = allocate_sample_buffer(n_channels, CHUNK);
+    long done = 0, differs = -1;
+
+    *silent = 1;
+
+    if (!block_sr || !sample_sr || !block_out || !sample_out) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    while (done < frames && differs < 0) {
+        long block_count = render(block_sr, 1, block_out, n_channels);
+        long sample_count = render(sample_sr, 0, sample_out, n_channels);
+        long i;
+
+        if (block_count != sample_count) {
+            differs = done + (block_count < sample_count ? block_count
+                                                         : sample_count);
+            break;
+        }
+        for (i = 0; i < block_count * n_channels; i++) {
+            if (block_out[0][i] != sample_out[0][i]) {
+                differs = done + i / n_channels;
+                break;
+            }
+            if (block_out[0][i])
+                *silent = 0;
+        }
+        if (block_count < CHUNK)
+            break;
+        done += block_count;
+    }
+
+    destroy_sample_buffer(block_out);
+    destroy_sample_buffer(sample_out);
+    duh_end_sigrenderer(block_sr);
+    duh_end_sigrenderer(sample_sr);
+    dumb_resampling_block = 1;
+    return differs;
+}
+
+int main(int argc, char **argv) {
+    long frames = (argc > 1 ? atol(argv[1]) : 5) * 44100;
+    int failures = 0;
+    size_t m;
+
+    if (frames <= 0)
+        return 1;
+
+    resampler_init();
+    _dumb_init_cubic();
+    _dumb_init_sse();
+
+    for (m = 0; m < sizeof(modules) / sizeof(modules[0]); m++) {
+        size_t size;
+        unsigned char *data =
+            make_it_module(modules[m].seed, modules[m].n_channels, &size);
+        DUMBFILE *f;
+        DUH *duh;
+        int quality, n_channels;
+
+        if (!data) {
+            fprintf(stderr, "couldn't make module %d\n", (int)m);
+            return 1;
+        }
+        f = dumbfile_open_memory((const char *)data, size);
+        duh = f ? dumb_read_it(f) : NULL;
+        if (f)
+            dumbfile_close(f);
+        if (!duh) {
+            fprintf(stderr, "couldn't read module %d\n", (int)m);
+            return 1;
+        }
+
+        for (n_channels = 2; n_channels >= 1; n_channels--) {
+            for (quality = 0; quality < DUMB_RQ_N_LEVELS; quality++) {
+                int silent;
+                long differs =
+                    compare(duh, n_channels, quality, frames, &silent);
+                printf("%2d channels, %s, quality %d: ",
+                       modules[m].n_channels,
+                       n_channels == 2 ? "stereo" : "mono", quality);
+                if (differs >= 0) {
+                    printf("DIFFERS at frame %ld\n", differs);
+                    failures++;
+                } else if (silent) {
+                    printf("SILENT\n");
+                    failures++;
+                } else
+                    printf("same\n");
+            }
+        }
+
+        unload_duh(duh);
+        free(data);
+    }
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures != 0;
+}
@@ -0,0 +1,416 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "dumbmodule.h"
+
+#define N_INSTRUMENTS 8
+#define N_SAMPLES 8
+#define N_PATTERNS 6
+#define N_ROWS 64
+
+#define IT_HEADER_SIZE 0xC0
+#define IT_INSTRUMENT_SIZE 554
+#define IT_SAMPLE_HEADER_SIZE 0x50
+
+/* Sample header flags */
+#define SAMPLE_EXISTS 1
+#define SAMPLE_16BIT 2
+#define SAMPLE_STEREO 4
+#define SAMPLE_LOOP 16
+#define SAMPLE_SUS_LOOP 32
+#define SAMPLE_PINGPONG 64
+
+typedef struct BUFFER {
+    unsigned char *data;
+    size_t size, capacity;
+    int error;
+} BUFFER;
+
+static unsigned int module_random;
+
+static unsigned int next_random(void) {
+    module_random ^= module_random << 13;
+    module_random ^= module_random >> 17;
+    module_random ^= module_random << 5;
+    return module_random;
+}
+
+static int random_range(int low, int high) {
+    return low + (int)(next_random() % (unsigned int)(high - low + 1));
+}
+
+static void put_bytes(BUFFER *b, const void *data, size_t size) {
+    if (b->error)
+        return;
+    if (b->size + size > b->capacity) {
+        size_t capacity = b->capacity ? b->capacity * 2 : 65536;
+        unsigned char *data;
+        while (capacity < b->size + size)
+            capacity *= 2;
+        data = realloc(b->data, capacity);
+        if (!data) {
+            b->error = 1;
+            return;
+        }
+        b->data = data;
+        b->capacity = capacity;
+    }
+    if (data)
+        memcpy(b->data + b->size, data, size);
+    else
+        memset(b->data + b->size, 0, size);
+    b->size += size;
+}
+
+static void put8(BUFFER *b, int value) {
+    unsigned char c = (unsigned char)value;
+    put_bytes(b, &c, 1);
+}
+
+static void put16(BUFFER *b, int value) {
+    put8(b, value);
+    put8(b, value >> 8);
+}
+
+static void put32(BUFFER *b, long value) {
+    put16(b, (int)(value & 0xFFFF));
+    put16(b, (int)((value >> 16) & 0xFFFF));
+}
+
+static void patch32(BUFFER *b, size_t offset, long value) {
+    if (b->error)
+        return;
+    b->data[offset + 0] = (unsigned char)value;
+    b->data[offset + 1] = (unsigned char)(value >> 8);
+    b->data[offset + 2] = (unsigned char)(value >> 16);
+    b->data[offset + 3] = (unsigned char)(value >> 24);
+}
+
+static void put_name(BUFFER *b, const char *name, size_t size) {
+    char field[32];
+    memset(field, 0, sizeof(field));
+    strncpy(field, name, size - 1);
+    put_bytes(b, field, size);
+}
+
+/* The kinds of sample, by sample number */
+static const struct {
+    int flags;
+    int short_loop;
+} sample_kinds[N_SAMPLES] = {
+    {SAMPLE_EXISTS, 0},
+    {SAMPLE_EXISTS | SAMPLE_16BIT | SAMPLE_LOOP, 0},
+    {SAMPLE_EXISTS | SAMPLE_STEREO | SAMPLE_LOOP | SAMPLE_PINGPONG, 0},
+    {SAMPLE_EXISTS | SAMPLE_16BIT | SAMPLE_STEREO | SAMPLE_LOOP, 0},
+    {SAMPLE_EXISTS | SAMPLE_16BIT | SAMPLE_LOOP | SAMPLE_PINGPONG, 0},
+    {SAMPLE_EXISTS | SAMPLE_LOOP | SAMPLE_SUS_LOOP, 0},
+    {SAMPLE_EXISTS | SAMPLE_16BIT | SAMPLE_STEREO, 0},
+    /* loops every 32 samples, so a block wraps many times */
+    {SAMPLE_EXISTS | SAMPLE_LOOP, 1},
+};
+
+typedef struct SAMPLE_INFO {
+    long length, loop_start, loop_end, sus_loop_start, sus_loop_end;
+    size_t pointer_offset;
+} SAMPLE_INFO;
+
+static void put_sample_header(BUFFER *b, int n, SAMPLE_INFO *info) {
+    int flags = sample_kinds[n].flags;
+
+    if (sample_kinds[n].short_loop) {
+        info->length = 600;
+        info->loop_start = 568;
+    } else {
+        info->length = random_range(1000, 16000);
+        info->loop_start = random_range(0, info->length / 2);
+    }
+    info->loop_end = info->length;
+    info->sus_loop_start = info->loop_start / 2;
+    info->sus_loop_end = info->loop_start + (info->length - info->loop_start) / 2;
+
+    put_bytes(b, "IMPS", 4);
+    put_name(b, "sample.raw", 13);
+    put8(b, 64);                    /* global volume */
+    put8(b, flags);
+    put8(b, random_range(32, 64));  /* default volume */
+    put_name(b, "synthetic", 26);
+    put8(b, 1);                     /* signed */
+    put8(b, n & 1 ? 0x80 | random_range(0, 64) : 32);
+    put32(b, info->length);
+    put32(b, info->loop_start);
+    put32(b, info->loop_end);
+    put32(b, random_range(8363, 48000));
+    put32(b, info->sus_loop_start);
+    put32(b, info->sus_loop_end);
+    info->pointer_offset = b->size;
+    put32(b, 0);
+    /* auto vibrato on one of them */
+    put8(b, n == 4 ? 10 : 0);
+    put8(b, n == 4 ? 8 : 0);
+    put8(b, n == 4 ? 20 : 0);
+    put8(b, 0);
+}
+
+/* A sawtooth with noise on it, each channel stored whole after the other */
+static void put_sample_data(BUFFER *b, int n, const SAMPLE_INFO *info) {
+    int flags = sample_kinds[n].flags;
+    int n_channels = flags & SAMPLE_STEREO ? 2 : 1;
+    int channel;
+    long i;
+
+    patch32(b, info->pointer_offset, (long)b->size);
+
+    for (channel = 0; channel < n_channels; channel++) {
+        int period = random_range(8, 200);
+        int amplitude = random_range(8000, 30000);
+        for (i = 0; i < info->length; i++) {
+            int value = (int)((i % period) * 2 * amplitude / period) - amplitude;
+            value += random_range(-2000, 2000);
+            if (value > 32767)
+                value = 32767;
+            else if (value < -32768)
+                value = -32768;
+            if (flags & SAMPLE_16BIT)
+                put16(b, value);
+            else
+                put8(b, value >> 8);
+        }
+    }
+}
+
+static void put_envelope(BUFFER *b, int flags, int n_nodes, const int *nodes,
+                         int loop_start, int loop_end, int sus_start,
+                         int sus_end) {
+    int i;
+    put8(b, flags);
+    put8(b, n_nodes);
+    put8(b, loop_start);
+    put8(b, loop_end);
+    put8(b, sus_start);
+    put8(b, sus_end);
+    for (i = 0; i < 25; i++) {
+        put8(b, i < n_nodes ? nodes[i * 2] : 0);
+        put16(b, i < n_nodes ? nodes[i * 2 + 1] : 0);
+    }
+    put8(b, 0);
+}
+
+static void put_instrument(BUFFER *b, int n) {
+    static const int volume_nodes[] = {64, 0, 48, 10, 40, 30, 0, 120};
+    static const int pan_nodes[] = {0, 0, 32, 20, -32, 40, 0, 60};
+    static const int pitch_nodes[] = {0, 0, 8, 20, -8, 40, 0, 60};
+    int note;
+
+    put_bytes(b, "IMPI", 4);
+    put_name(b, "instrument", 13);
+    put8(b, n & 3);                     /* cut, continue, off, fade */
+    put8(b, n == 5 ? 1 : 0);            /* duplicate check on note */
+    put8(b, n == 5 ? 2 : 0);            /* which fades */
+    put16(b, 128 + 96 * n);             /* fadeout */
+    put8(b, 0);                         /* pitch-pan separation */
+    put8(b, 60);
+    put8(b, 128);                       /* global volume */
+    put8(b, n & 1 ? 32 : 0x80 | 32);    /* default pan, used or not */
+    put8(b, 0);                         /* no random volume or pan, */
+    put8(b, 0);                         /* so renders are repeatable */
+    put_bytes(b, NULL, 4);
+    put_name(b, "synthetic", 26);
+    put8(b, n == 6 ? 0x80 | 90 : 0);    /* one with the resonant filter */
+    put8(b, n == 6 ? 0x80 | 40 : 0);
+    put_bytes(b, NULL, 4);
+
+    for (note = 0; note < 120; note++) {
+        put8(b, note);
+        put8(b, n + 1);
+    }
+
+    /* volume: sustained on odd instruments, looped on one */
+    put_envelope(b, 1 | (n & 1 ? 4 : 0) | (n == 2 ? 2 : 0), 4, volume_nodes,
+                 1, 2, 1, 2);
+    put_envelope(b, n == 3 ? 1 : 0, 4, pan_nodes, 0, 0, 0, 0);
+    put_envelope(b, n == 4 ? 1 : 0, 4, pitch_nodes, 0, 0, 0, 0);
+    put_bytes(b, NULL, IT_INSTRUMENT_SIZE - 550);
+}
+
+static void put_command(unsigned char *command, unsigned char *value, int tone) {
+    switch (next_random() % 10) {
+    case 0: /* Dxy volume slide */
+        *command = 4;
+        *value = next_random() & 1 ? random_range(1, 15)
+                                   : random_range(1, 15) << 4;
+        break;
+    case 1: /* Exx pitch down */
+        *command = 5;
+        *value = random_range(1, 0x20);
+        break;
+    case 2: /* Fxx pitch up */
+        *command = 6;
+        *value = random_range(1, 0x20);
+        break;
+    case 3: /* Gxx tone portamento */
+        *command = tone ? 7 : 8;
+        *value = random_range(0x10, 0x40);
+        break;
+    case 4: /* Hxy vibrato */
+        *command = 8;
+        *value = random_range(0x11, 0xFF);
+        break;
+    case 5: /* Oxx sample offset */
+        *command = 15;
+        *value = random_range(1, 0x20);
+        break;
+    case 6: /* Pxy pan slide */
+        *command = 16;
+        *value = next_random() & 1 ? random_range(1, 15)
+                                   : random_range(1, 15) << 4;
+        break;
+    case 7: /* Xxx set pan */
+        *command = 24;
+        *value = random_range(0, 255);
+        break;
+    case 8: /* S73-S76 new note action for this note */
+        *command = 19;
+        *value = 0x70 + random_range(3, 6);
+        break;
+    default: /* Rxy tremolo */
+        *command = 18;
+        *value = random_range(0x11, 0x88);
+        break;
+    }
+}
+
+static void put_pattern(BUFFER *b, int n_channels, int first) {
+    size_t start = b->size;
+    int row, channel;
+
+    put16(b, 0); /* packed length, filled in below */
+    put16(b, N_ROWS);
+    put32(b, 0);
+
+    for (row = 0; row < N_ROWS; row++) {
+        for (channel = 0; channel < n_channels; channel++) {
+            unsigned char mask = 0, note = 0, instrument = 0, volpan = 0;
+            unsigned char command = 0, value = 0;
+            unsigned int r = next_random() % 8;
+
+            if (r < 5) {
+                mask |= 1 | 2;
+                note = random_range(36, 84);
+                instrument = random_range(1, N_INSTRUMENTS);
+            } else if (r == 5) {
+                static const unsigned char endings[] = {255, 254, 246};
+                mask |= 1;
+                note = endings[next_random() % 3];
+            }
+
+            if (next_random() % 3 == 0) {
+                mask |= 4;
+                volpan = next_random() & 1 ? random_range(0, 64)
+                                           : random_range(128, 192);
+            }
+
+            if (next_random() % 2 == 0) {
+                mask |= 8;
+                put_command(&command, &value, r < 5);
+            }
+
+            /* speed and tempo at the top of each song */
+            if (first && row == 0 && channel < 2) {
+                mask |= 8;
+                command = channel ? 20 : 1;
+                value = channel ? random_range(125, 255) : random_range(3, 6);
+            }
+
+            if (!mask)
+                continue;
+
+            put8(b, (channel + 1) | 0x80);
+            put8(b, mask);
+            if (mask & 1)
+                put8(b, note);
+            if (mask & 2)
+                put8(b, instrument);
+            if (mask & 4)
+                put8(b, volpan);
+            if (mask & 8) {
+                put8(b, command);
+                put8(b, value);
+            }
+        }
+        put8(b, 0);
+    }
+
+    if (!b->error) {
+        size_t length = b->size - start - 8;
+        b->data[start + 0] = (unsigned char)length;
+        b->data[start + 1] = (unsigned char)(length >> 8);
+    }
+}
+
+unsigned char *make_it_module(unsigned int seed, int n_channels, size_t *size) {
+    BUFFER b = {NULL, 0, 0, 0};
+    SAMPLE_INFO samples[N_SAMPLES];
+    size_t offsets;
+    int n;
+
+    if (n_channels < 2 || n_channels > 64)
+        return NULL;
+
+    module_random = seed ? seed : 0x2545F491;
+
+    put_bytes(&b, "IMPM", 4);
+    put_name(&b, "synthetic", 26);
+    put16(&b, 0x1004);
+    put16(&b, N_PATTERNS + 1);
+    put16(&b, N_INSTRUMENTS);
+    put16(&b, N_SAMPLES);
+    put16(&b, N_PATTERNS);
+    put16(&b, 0x0214);  /* made with */
+    put16(&b, 0x0214);  /* compatible with */
+    put16(&b, 1 | 4 | 8);  /* stereo, instruments, linear slides */
+    put16(&b, 0);
+    put8(&b, 128);      /* global volume */
+    put8(&b, 48);       /* mixing volume */
+    put8(&b, 6);
+    put8(&b, 125);
+    put8(&b, 128);      /* separation */
+    put8(&b, 0);
+    put16(&b, 0);
+    put32(&b, 0);
+    put32(&b, 0);
+    for (n = 0; n < 64; n++)
+        put8(&b, n < n_channels ? random_range(0, 64) : 0x80 | 32);
+    for (n = 0; n < 64; n++)
+        put8(&b, 64);
+
+    for (n = 0; n < N_PATTERNS; n++)
+        put8(&b, n);
+    put8(&b, 255);
+
+    offsets = b.size;
+    put_bytes(&b, NULL, 4 * (N_INSTRUMENTS + N_SAMPLES + N_PATTERNS));
+
+    for (n = 0; n < N_INSTRUMENTS; n++) {
+        patch32(&b, offsets + 4 * n, (long)b.size);
+        put_instrument(&b, n);
+    }
+    for (n = 0; n < N_SAMPLES; n++) {
+        patch32(&b, offsets + 4 * (N_INSTRUMENTS + n), (long)b.size);
+        put_sample_header(&b, n, &samples[n]);
+    }
+    for (n = 0; n < N_SAMPLES; n++)
+        put_sample_data(&b, n, &samples[n]);
+    for (n = 0; n < N_PATTERNS; n++) {
+        patch32(&b, offsets + 4 * (N_INSTRUMENTS + N_SAMPLES + n),
+                (long)b.size);
+        put_pattern(&b, n_channels, n == 0);
+    }
+
+    if (b.error) {
+        free(b.data);
+        return NULL;
+    }
+
+    *size = b.size;
+    return b.data;
+}
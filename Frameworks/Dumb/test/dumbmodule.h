@@ -0,0 +1,18 @@
+#ifndef DUMBMODULE_H
+#define DUMBMODULE_H
+
+#include <stddef.h>
+
+/* Writes a synthetic Impulse Tracker module into a new buffer and returns it,
+ * with its size in *size, or NULL on failure. The same seed always gives the
+ * same module.
+ *
+ * Every channel plays a note on most rows, through instruments whose new note
+ * actions keep the old notes going, so the voices pile up into the virtual
+ * channels. The samples are 8- and 16-bit, mono and stereo, one-shot, looped,
+ * ping-pong and sustain looped, and the patterns slide volume, pitch and pan,
+ * add vibrato and jump into the samples with offsets.
+ */
+unsigned char *make_it_module(unsigned int seed, int n_channels, size_t *size);
+
+#endif /* DUMBMODULE_H */
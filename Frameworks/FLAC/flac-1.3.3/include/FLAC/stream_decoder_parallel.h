@@ -0,0 +1,167 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLAC__STREAM_DECODER_PARALLEL_H
+#define FLAC__STREAM_DECODER_PARALLEL_H
+
+#include "export.h"
+#include "format.h"
+#include "stream_decoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** \file include/FLAC/stream_decoder_parallel.h
+ *
+ *  \brief
+ *  This module contains the functions which implement the frame-parallel
+ *  stream decoder.
+ *
+ *  See the detailed documentation in the
+ *  \link flac_stream_decoder_parallel frame-parallel decoder \endlink module.
+ */
+
+/** \defgroup flac_stream_decoder_parallel FLAC/stream_decoder_parallel.h: frame-parallel decoder interface
+ *  \ingroup flac_decoder
+ *
+ *  \brief
+ *  This module contains the functions which implement the frame-parallel
+ *  stream decoder.
+ *
+ * FLAC frames can be decoded independently of each other once the
+ * STREAMINFO block is known.  The frame-parallel decoder reads native FLAC
+ * frames ahead through the client's read callback, finds the frame
+ * boundaries by their sync codes and headers, and hands each frame to a
+ * pool of worker threads, each with its own FLAC__StreamDecoder.  Decoded
+ * frames are handed back to the client's write callback in stream order,
+ * on the thread calling FLAC__stream_decoder_parallel_process_single().
+ *
+ * The decoder does not read metadata.  The client first reads it with a
+ * regular FLAC__StreamDecoder, then positions its input at the start of
+ * a frame (see FLAC__stream_decoder_get_decode_position()) and passes the
+ * STREAMINFO to FLAC__stream_decoder_parallel_init().  Seeking works the
+ * same way: flush, seek with the regular decoder, position the input at
+ * the next frame and carry on.
+ *
+ * The callbacks are the ones of the stream decoder.  The read callback is
+ * called with a NULL decoder.  The write and error callbacks get the
+ * worker's decoder, which must not be used for anything but reading
+ * properties, and the FLAC__Frame passed to the write callback only has
+ * its header and footer filled in.
+ *
+ * \{
+ */
+
+struct FLAC__StreamDecoderParallel;
+/** The opaque structure definition for the frame-parallel decoder type.
+ *  See the \link flac_stream_decoder_parallel frame-parallel decoder module \endlink
+ *  for a detailed description.
+ */
+typedef struct FLAC__StreamDecoderParallel FLAC__StreamDecoderParallel;
+
+
+/** Create a new frame-parallel decoder instance.
+ *
+ * \param  threads  The number of worker threads, or \c 0 to use one per
+ *                  online processor.
+ * \retval FLAC__StreamDecoderParallel*
+ *    \c NULL if there was an error allocating memory, else the new instance.
+ */
+FLAC_API FLAC__StreamDecoderParallel *FLAC__stream_decoder_parallel_new(uint32_t threads);
+
+/** Free a decoder instance.  Stops the worker threads.
+ *
+ * \param  decoder  A pointer to an existing decoder, or \c NULL.
+ */
+FLAC_API void FLAC__stream_decoder_parallel_delete(FLAC__StreamDecoderParallel *decoder);
+
+/** Initialize the decoder and start the worker threads.  The next byte
+ *  delivered by \a read_callback must be the start of a frame.
+ *
+ * \param  decoder            An uninitialized decoder instance.
+ * \param  stream_info        The stream's STREAMINFO.
+ * \param  read_callback      See FLAC__StreamDecoderReadCallback.
+ * \param  write_callback     See FLAC__StreamDecoderWriteCallback.
+ * \param  error_callback     See FLAC__StreamDecoderErrorCallback.
+ * \param  client_data        This value will be supplied to callbacks in
+ *                            their \a client_data argument.
+ * \retval FLAC__bool
+ *    \c false if memory or threads could not be allocated, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_parallel_init(
+	FLAC__StreamDecoderParallel *decoder,
+	const FLAC__StreamMetadata_StreamInfo *stream_info,
+	FLAC__StreamDecoderReadCallback read_callback,
+	FLAC__StreamDecoderWriteCallback write_callback,
+	FLAC__StreamDecoderErrorCallback error_callback,
+	void *client_data
+);
+
+/** Get the current decoder state.  This is
+ *  \c FLAC__STREAM_DECODER_READ_FRAME while decoding, or one of
+ *  \c FLAC__STREAM_DECODER_END_OF_STREAM, \c FLAC__STREAM_DECODER_ABORTED
+ *  and \c FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR.
+ *
+ * \param  decoder  An initialized decoder instance.
+ * \retval FLAC__StreamDecoderState
+ *    The current decoder state.
+ */
+FLAC_API FLAC__StreamDecoderState FLAC__stream_decoder_parallel_get_state(const FLAC__StreamDecoderParallel *decoder);
+
+/** Deliver the next frame to the write callback, reading further frames
+ *  ahead and queueing them for the workers as needed.  Errors found in a
+ *  frame are passed to the error callback before the frame is written.
+ *
+ * \param  decoder  An initialized decoder instance.
+ * \retval FLAC__bool
+ *    \c false if the end of the stream was reached or decoding stopped
+ *    (see FLAC__stream_decoder_parallel_get_state()), else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_parallel_process_single(FLAC__StreamDecoderParallel *decoder);
+
+/** Drop all frames read ahead, waiting for the workers to finish the ones
+ *  they are decoding.  The next byte delivered by the read callback must
+ *  again be the start of a frame.
+ *
+ * \param  decoder  An initialized decoder instance.
+ * \retval FLAC__bool
+ *    \c false if the decoder is not initialized, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_parallel_flush(FLAC__StreamDecoderParallel *decoder);
+
+/* \} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
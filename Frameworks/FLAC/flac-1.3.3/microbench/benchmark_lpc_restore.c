@@ -0,0 +1,261 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2000-2009  Josh Coalson
+ * Copyright (C) 2011-2016  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Times the decoder's signal restoration kernels against the plain C ones
+ * at the usual LPC and fixed predictor orders, for 16 bit material (which
+ * the decoder restores with 32 bit sums) and 24 bit material (64 bit sums),
+ * and checks that every kernel reproduces the signal the residual was
+ * computed from.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "FLAC/ordinals.h"
+#include "share/compat.h"
+#include "private/bitmath.h"
+#include "private/cpu.h"
+#include "private/fixed.h"
+#include "private/lpc.h"
+
+#include "util.h"
+
+typedef void (*restore_func) (const FLAC__int32 residual [], uint32_t data_len, const FLAC__int32 qlp_coeff [], uint32_t order, int lp_quantization, FLAC__int32 data []) ;
+typedef void (*fixed_restore_func) (const FLAC__int32 residual [], uint32_t data_len, uint32_t order, FLAC__int32 data []) ;
+
+typedef struct
+{	const char * name ;
+	restore_func lpc, lpc_wide ;
+	fixed_restore_func fixed ;
+} kernel ;
+
+/* not a multiple of four, like the blocksize - order samples the decoder restores */
+#define BLOCK_SIZE	4093
+#define BLOCKS		64
+#define MAX_ORDER	32
+
+/* one block of history in front of each block of samples */
+static FLAC__int32 signal [BLOCKS][MAX_ORDER + BLOCK_SIZE] ;
+static FLAC__int32 residual [BLOCKS][BLOCK_SIZE] ;
+static FLAC__int32 restored [BLOCKS][MAX_ORDER + BLOCK_SIZE] ;
+static FLAC__int32 qlp_coeff [MAX_ORDER] ;
+
+static unsigned bench_order, bench_wide ;
+static int bench_shift ;
+static const kernel * bench_kernel ;
+
+static void
+make_signal (unsigned bps)
+{	FLAC__uint32 noise = 12345 ;
+	double amp = (double) (1 << (bps - 2)) ;
+	unsigned b, k ;
+
+	for (b = 0 ; b < BLOCKS ; b++)
+		for (k = 0 ; k < MAX_ORDER + BLOCK_SIZE ; k++)
+		{	double t = (double) (b * BLOCK_SIZE + k) / 44100.0 ;
+			noise = noise * 1664525 + 1013904223 ;
+			signal [b][k] = (FLAC__int32) (amp * (0.6 * sin (2 * M_PI * 440.0 * t) + 0.3 * sin (2 * M_PI * 1234.5 * t))) + (FLAC__int32) (noise >> (36 - bps)) - (1 << (bps - 5)) ;
+			} ;
+} /* make_signal */
+
+/* Random coefficients, as precise as the decoder allows for the kernel being timed */
+static void
+make_residual (unsigned bps, unsigned order, int wide)
+{	FLAC__uint32 noise = 777 ;
+	unsigned b, k, precision ;
+
+	precision = wide ? 15 : 32 - bps - FLAC__bitmath_ilog2 (order) ;
+	if (precision > 15)
+		precision = 15 ;
+	bench_shift = precision - 2 ;
+
+	for (k = 0 ; k < order ; k++)
+	{	noise = noise * 1664525 + 1013904223 ;
+		qlp_coeff [k] = (FLAC__int32) (noise >> (32 - precision)) - (1 << (precision - 1)) ;
+		} ;
+
+	for (b = 0 ; b < BLOCKS ; b++)
+	{	if (wide)
+			FLAC__lpc_compute_residual_from_qlp_coefficients_wide (signal [b] + MAX_ORDER, BLOCK_SIZE, qlp_coeff, order, bench_shift, residual [b]) ;
+		else
+			FLAC__lpc_compute_residual_from_qlp_coefficients (signal [b] + MAX_ORDER, BLOCK_SIZE, qlp_coeff, order, bench_shift, residual [b]) ;
+		memcpy (restored [b], signal [b], sizeof (signal [b][0]) * MAX_ORDER) ;
+		} ;
+} /* make_residual */
+
+static void
+make_fixed_residual (unsigned order)
+{	unsigned b ;
+
+	for (b = 0 ; b < BLOCKS ; b++)
+	{	FLAC__fixed_compute_residual (signal [b] + MAX_ORDER, BLOCK_SIZE, order, residual [b]) ;
+		memcpy (restored [b], signal [b], sizeof (signal [b][0]) * MAX_ORDER) ;
+		} ;
+} /* make_fixed_residual */
+
+static void
+bench_lpc (void)
+{	restore_func func = bench_wide ? bench_kernel->lpc_wide : bench_kernel->lpc ;
+	unsigned b ;
+
+	for (b = 0 ; b < BLOCKS ; b++)
+		func (residual [b], BLOCK_SIZE, qlp_coeff, bench_order, bench_shift, restored [b] + MAX_ORDER) ;
+} /* bench_lpc */
+
+static void
+bench_fixed (void)
+{	unsigned b ;
+
+	for (b = 0 ; b < BLOCKS ; b++)
+		bench_kernel->fixed (residual [b], BLOCK_SIZE, bench_order, restored [b] + MAX_ORDER) ;
+} /* bench_fixed */
+
+static void
+clear_restored (void)
+{	unsigned b ;
+
+	for (b = 0 ; b < BLOCKS ; b++)
+		memset (restored [b] + MAX_ORDER, 0, sizeof (restored [b][0]) * BLOCK_SIZE) ;
+} /* clear_restored */
+
+static int
+check_restored (void)
+{	unsigned b ;
+
+	for (b = 0 ; b < BLOCKS ; b++)
+		if (memcmp (restored [b], signal [b], sizeof (signal [b])) != 0)
+			return 0 ;
+	return 1 ;
+} /* check_restored */
+
+/* Returns the median time of one pass over all blocks, in nanoseconds per sample */
+static double
+time_kernel (void (*testfunc) (void))
+{	bench_stats	stats ;
+
+	memset (&stats, 0, sizeof (stats)) ;
+	stats.testfunc = testfunc ;
+	stats.run_count = 15 ;
+	stats.loop_count = 4 ;
+	benchmark_stats (&stats) ;
+	return 1e9 * stats.median_time / (BLOCKS * BLOCK_SIZE) ;
+} /* time_kernel */
+
+int
+main (void)
+{	static const unsigned lpc_orders [] = { 4, 6, 8, 10, 12, 16, 24, 32 } ;
+	kernel kernels [4] ;
+	unsigned kernel_count = 0, bps, k, o ;
+	int failed = 0 ;
+	FLAC__CPUInfo cpuinfo ;
+
+	FLAC__cpu_info (&cpuinfo) ;
+
+	kernels [kernel_count].name = "C" ;
+	kernels [kernel_count].lpc = FLAC__lpc_restore_signal ;
+	kernels [kernel_count].lpc_wide = FLAC__lpc_restore_signal_wide ;
+	kernels [kernel_count++].fixed = FLAC__fixed_restore_signal ;
+#if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN && !defined FLAC__NO_ASM
+# ifdef FLAC__SSE4_1_SUPPORTED
+	if (cpuinfo.x86.sse41)
+	{	kernels [kernel_count].name = "SSE4.1" ;
+		kernels [kernel_count].lpc = FLAC__lpc_restore_signal_intrin_sse41 ;
+		kernels [kernel_count].lpc_wide = FLAC__lpc_restore_signal_wide_intrin_sse41 ;
+		kernels [kernel_count++].fixed = FLAC__fixed_restore_signal_intrin_sse2 ;
+		} ;
+# endif
+# ifdef FLAC__AVX2_SUPPORTED
+	if (cpuinfo.x86.avx2)
+	{	kernels [kernel_count].name = "AVX2" ;
+		/* there is no AVX2 kernel for 32 bit sums, the decoder keeps the SSE4.1 one */
+		kernels [kernel_count].lpc = FLAC__lpc_restore_signal_intrin_sse41 ;
+		kernels [kernel_count].lpc_wide = FLAC__lpc_restore_signal_wide_intrin_avx2 ;
+		kernels [kernel_count++].fixed = FLAC__fixed_restore_signal_intrin_sse2 ;
+		} ;
+# endif
+#endif
+#if defined FLAC__CPU_ARM64 && FLAC__HAS_NEONINTRIN && !defined FLAC__NO_ASM
+	kernels [kernel_count].name = "NEON" ;
+	kernels [kernel_count].lpc = FLAC__lpc_restore_signal_intrin_neon ;
+	kernels [kernel_count].lpc_wide = FLAC__lpc_restore_signal_wide_intrin_neon ;
+	kernels [kernel_count++].fixed = FLAC__fixed_restore_signal_intrin_neon ;
+#endif
+	(void) cpuinfo ;
+
+	printf ("\nns per sample") ;
+	for (k = 0 ; k < kernel_count ; k++)
+		printf ("%10s", kernels [k].name) ;
+	puts ("") ;
+
+	for (bps = 16 ; bps <= 24 ; bps += 8)
+	{	make_signal (bps) ;
+		bench_wide = bps > 16 ;
+
+		for (o = 0 ; o < ARRAY_LEN (lpc_orders) ; o++)
+		{	bench_order = lpc_orders [o] ;
+			make_residual (bps, bench_order, bench_wide) ;
+			printf ("%2u bit lpc %2u", bps, bench_order) ;
+			for (k = 0 ; k < kernel_count ; k++)
+			{	bench_kernel = &kernels [k] ;
+				clear_restored () ;
+				printf ("%10.3f", time_kernel (bench_lpc)) ;
+				if (!check_restored ())
+				{	printf (" MISMATCH") ;
+					failed = 1 ;
+					} ;
+				} ;
+			puts ("") ;
+			} ;
+
+		for (bench_order = 1 ; bench_order <= FLAC__MAX_FIXED_ORDER ; bench_order++)
+		{	make_fixed_residual (bench_order) ;
+			printf ("%2u bit fixed %u", bps, bench_order) ;
+			for (k = 0 ; k < kernel_count ; k++)
+			{	bench_kernel = &kernels [k] ;
+				printf ("%10.3f", time_kernel (bench_fixed)) ;
+				if (!check_restored ())
+				{	printf (" MISMATCH") ;
+					failed = 1 ;
+					} ;
+				} ;
+			puts ("") ;
+			} ;
+		} ;
+
+	return failed ;
+} /* main */
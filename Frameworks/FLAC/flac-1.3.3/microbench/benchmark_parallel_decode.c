@@ -0,0 +1,282 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2000-2009  Josh Coalson
+ * Copyright (C) 2011-2016  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Decodes a FLAC stream with the stream decoder and with the frame-parallel
+ * decoder, checks that both produce the same samples and prints the wall
+ * clock time of each.  Without arguments it encodes a synthetic 24 bit,
+ * 192 kHz, 6 channel stream in memory first.
+ *
+ *     benchmark_parallel_decode [file.flac [threads]]
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "FLAC/stream_decoder.h"
+#include "FLAC/stream_decoder_parallel.h"
+#include "FLAC/stream_encoder.h"
+
+typedef struct {
+	FLAC__byte * data ;
+	size_t len, capacity, pos ;
+} memory_stream ;
+
+typedef struct {
+	memory_stream * input ;
+	FLAC__StreamMetadata_StreamInfo stream_info ;
+	FLAC__uint64 samples ;
+	FLAC__uint32 checksum ;
+	unsigned errors ;
+} decode_state ;
+
+static double
+now (void)
+{	struct timespec ts ;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts) ;
+	return ts.tv_sec + 1e-9 * ts.tv_nsec ;
+} /* now */
+
+static FLAC__StreamEncoderWriteStatus
+encoder_write (const FLAC__StreamEncoder * encoder, const FLAC__byte buffer [], size_t bytes, uint32_t samples, uint32_t current_frame, void * client_data)
+{	memory_stream * stream = (memory_stream *) client_data ;
+	(void) encoder ; (void) samples ; (void) current_frame ;
+
+	if (stream->pos + bytes > stream->capacity)
+	{	stream->capacity = (stream->pos + bytes) * 2 ;
+		if ((stream->data = realloc (stream->data, stream->capacity)) == NULL)
+			return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR ;
+		} ;
+	memcpy (stream->data + stream->pos, buffer, bytes) ;
+	stream->pos += bytes ;
+	if (stream->pos > stream->len)
+		stream->len = stream->pos ;
+	return FLAC__STREAM_ENCODER_WRITE_STATUS_OK ;
+} /* encoder_write */
+
+static FLAC__StreamEncoderSeekStatus
+encoder_seek (const FLAC__StreamEncoder * encoder, FLAC__uint64 offset, void * client_data)
+{	(void) encoder ;
+	((memory_stream *) client_data)->pos = (size_t) offset ;
+	return FLAC__STREAM_ENCODER_SEEK_STATUS_OK ;
+} /* encoder_seek */
+
+static FLAC__StreamEncoderTellStatus
+encoder_tell (const FLAC__StreamEncoder * encoder, FLAC__uint64 * offset, void * client_data)
+{	(void) encoder ;
+	*offset = ((memory_stream *) client_data)->pos ;
+	return FLAC__STREAM_ENCODER_TELL_STATUS_OK ;
+} /* encoder_tell */
+
+static int
+encode_test_stream (memory_stream * stream, unsigned seconds)
+{	const unsigned channels = 6, rate = 192000, bps = 24, chunk = 4096 ;
+	FLAC__StreamEncoder * encoder ;
+	FLAC__int32 * pcm ;
+	unsigned k, ch, done = 0, total = seconds * rate ;
+	FLAC__uint32 noise = 1 ;
+	int ok ;
+
+	encoder = FLAC__stream_encoder_new () ;
+	FLAC__stream_encoder_set_channels (encoder, channels) ;
+	FLAC__stream_encoder_set_bits_per_sample (encoder, bps) ;
+	FLAC__stream_encoder_set_sample_rate (encoder, rate) ;
+	FLAC__stream_encoder_set_compression_level (encoder, 8) ;
+	FLAC__stream_encoder_set_total_samples_estimate (encoder, total) ;
+	if (FLAC__stream_encoder_init_stream (encoder, encoder_write, encoder_seek, encoder_tell, NULL, stream) != FLAC__STREAM_ENCODER_INIT_STATUS_OK)
+		return 0 ;
+
+	pcm = malloc (sizeof (FLAC__int32) * chunk * channels) ;
+	ok = 1 ;
+	while (ok && done < total)
+	{	unsigned n = total - done < chunk ? total - done : chunk ;
+
+		for (k = 0 ; k < n ; k++)
+			for (ch = 0 ; ch < channels ; ch++)
+			{	double t = (double) (done + k) / rate ;
+				noise = noise * 1664525 + 1013904223 ;
+				pcm [k * channels + ch] = (FLAC__int32) (3000000.0 * sin (2 * M_PI * (220.0 * (ch + 1)) * t) + 1500000.0 * sin (2 * M_PI * 3.1 * (ch + 2) * t * t)) + (FLAC__int32) (noise >> 20) - 2048 ;
+				} ;
+		ok = FLAC__stream_encoder_process_interleaved (encoder, pcm, n) ;
+		done += n ;
+		} ;
+
+	ok = FLAC__stream_encoder_finish (encoder) && ok ;
+	FLAC__stream_encoder_delete (encoder) ;
+	free (pcm) ;
+	return ok ;
+} /* encode_test_stream */
+
+static FLAC__StreamDecoderReadStatus
+decoder_read (const FLAC__StreamDecoder * decoder, FLAC__byte buffer [], size_t * bytes, void * client_data)
+{	memory_stream * stream = ((decode_state *) client_data)->input ;
+	size_t left = stream->len - stream->pos ;
+	(void) decoder ;
+
+	if (left == 0)
+	{	*bytes = 0 ;
+		return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM ;
+		} ;
+	if (*bytes > left)
+		*bytes = left ;
+	memcpy (buffer, stream->data + stream->pos, *bytes) ;
+	stream->pos += *bytes ;
+	return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE ;
+} /* decoder_read */
+
+static FLAC__StreamDecoderTellStatus
+decoder_tell (const FLAC__StreamDecoder * decoder, FLAC__uint64 * offset, void * client_data)
+{	(void) decoder ;
+	*offset = ((decode_state *) client_data)->input->pos ;
+	return FLAC__STREAM_DECODER_TELL_STATUS_OK ;
+} /* decoder_tell */
+
+static FLAC__StreamDecoderWriteStatus
+decoder_write (const FLAC__StreamDecoder * decoder, const FLAC__Frame * frame, const FLAC__int32 * const buffer [], void * client_data)
+{	decode_state * state = (decode_state *) client_data ;
+	unsigned k, ch ;
+	(void) decoder ;
+
+	/* order dependent, so that frames delivered out of order are caught */
+	for (ch = 0 ; ch < frame->header.channels ; ch++)
+		for (k = 0 ; k < frame->header.blocksize ; k++)
+			state->checksum = state->checksum * 31 + (FLAC__uint32) buffer [ch][k] ;
+	state->samples += frame->header.blocksize ;
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE ;
+} /* decoder_write */
+
+static void
+decoder_metadata (const FLAC__StreamDecoder * decoder, const FLAC__StreamMetadata * metadata, void * client_data)
+{	(void) decoder ;
+	if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO)
+		((decode_state *) client_data)->stream_info = metadata->data.stream_info ;
+} /* decoder_metadata */
+
+static void
+decoder_error (const FLAC__StreamDecoder * decoder, FLAC__StreamDecoderErrorStatus status, void * client_data)
+{	(void) decoder ; (void) status ;
+	((decode_state *) client_data)->errors ++ ;
+} /* decoder_error */
+
+static double
+decode_serial (memory_stream * stream, decode_state * state)
+{	FLAC__StreamDecoder * decoder = FLAC__stream_decoder_new () ;
+	double start = now () ;
+
+	stream->pos = 0 ;
+	FLAC__stream_decoder_init_stream (decoder, decoder_read, NULL, NULL, NULL, NULL, decoder_write, decoder_metadata, decoder_error, state) ;
+	FLAC__stream_decoder_process_until_end_of_stream (decoder) ;
+	FLAC__stream_decoder_delete (decoder) ;
+	return now () - start ;
+} /* decode_serial */
+
+static double
+decode_parallel (memory_stream * stream, decode_state * state, unsigned threads)
+{	FLAC__StreamDecoder * decoder = FLAC__stream_decoder_new () ;
+	FLAC__StreamDecoderParallel * parallel = FLAC__stream_decoder_parallel_new (threads) ;
+	FLAC__uint64 position = 0 ;
+	double start = now () ;
+
+	/* metadata with the stream decoder, then the frames in parallel */
+	stream->pos = 0 ;
+	FLAC__stream_decoder_init_stream (decoder, decoder_read, NULL, decoder_tell, NULL, NULL, decoder_write, decoder_metadata, decoder_error, state) ;
+	FLAC__stream_decoder_process_until_end_of_metadata (decoder) ;
+	FLAC__stream_decoder_get_decode_position (decoder, &position) ;
+	FLAC__stream_decoder_delete (decoder) ;
+
+	stream->pos = (size_t) position ;
+	if (FLAC__stream_decoder_parallel_init (parallel, &state->stream_info, decoder_read, decoder_write, decoder_error, state))
+		while (FLAC__stream_decoder_parallel_process_single (parallel))
+			;
+	FLAC__stream_decoder_parallel_delete (parallel) ;
+	return now () - start ;
+} /* decode_parallel */
+
+static int
+read_file (const char * path, memory_stream * stream)
+{	FILE * file = fopen (path, "rb") ;
+
+	if (file == NULL)
+		return 0 ;
+	fseek (file, 0, SEEK_END) ;
+	stream->len = stream->capacity = (size_t) ftell (file) ;
+	fseek (file, 0, SEEK_SET) ;
+	stream->data = malloc (stream->len) ;
+	stream->len = fread (stream->data, 1, stream->len, file) ;
+	fclose (file) ;
+	return 1 ;
+} /* read_file */
+
+int
+main (int argc, char * argv [])
+{	memory_stream stream ;
+	decode_state serial, parallel ;
+	double serial_time, parallel_time, audio_seconds ;
+	unsigned threads = argc > 2 ? (unsigned) atoi (argv [2]) : 0 ;
+
+	memset (&stream, 0, sizeof (stream)) ;
+	if (argc > 1 ? !read_file (argv [1], &stream) : !encode_test_stream (&stream, 60))
+	{	puts ("could not read or encode the input") ;
+		return 1 ;
+		} ;
+
+	memset (&serial, 0, sizeof (serial)) ;
+	memset (&parallel, 0, sizeof (parallel)) ;
+	serial.input = parallel.input = &stream ;
+
+	serial_time = decode_serial (&stream, &serial) ;
+	parallel_time = decode_parallel (&stream, &parallel, threads) ;
+
+	audio_seconds = serial.stream_info.sample_rate ? (double) serial.samples / serial.stream_info.sample_rate : 0.0 ;
+	printf ("\n%u Hz, %u bit, %u channels, %.1f s of audio, %.1f MB\n", serial.stream_info.sample_rate,
+		serial.stream_info.bits_per_sample, serial.stream_info.channels, audio_seconds, stream.len / 1e6) ;
+	printf ("serial   : %8.3f s  %7.1fx realtime\n", serial_time, audio_seconds / serial_time) ;
+	printf ("parallel : %8.3f s  %7.1fx realtime\n", parallel_time, audio_seconds / parallel_time) ;
+
+	free (stream.data) ;
+
+	if (serial.samples != parallel.samples || serial.checksum != parallel.checksum || serial.errors != parallel.errors)
+	{	printf ("MISMATCH: %llu/%llu samples, checksum %08x/%08x, %u/%u errors\n",
+			(unsigned long long) serial.samples, (unsigned long long) parallel.samples,
+			serial.checksum, parallel.checksum, serial.errors, parallel.errors) ;
+		return 1 ;
+		} ;
+	puts ("output identical") ;
+	return 0 ;
+} /* main */
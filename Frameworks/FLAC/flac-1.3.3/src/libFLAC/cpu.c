@@ -41,7 +41,7 @@
 
 #if defined _MSC_VER
 #include <intrin.h> /* for __cpuid() and _xgetbv() */
-#elif defined __GNUC__ && defined HAVE_CPUID_H
+#elif defined __GNUC__ && defined HAVE_CPUID_H && (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64)
 #include <cpuid.h> /* for __get_cpuid() and __get_cpuid_max() */
 #endif
 
@@ -0,0 +1,120 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2000-2009  Josh Coalson
+ * Copyright (C) 2011-2016  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+#ifndef FLAC__NO_ASM
+#if defined FLAC__CPU_ARM64 && FLAC__HAS_NEONINTRIN
+#include "private/fixed.h"
+#include "FLAC/FLAC_assert.h"
+
+#include <arm_neon.h>
+
+/* Replaces x by its running sum, continuing from last, and sets last to
+ * the last of these sums */
+#define RUNNING_SUM(x, last) \
+	x = vaddq_s32(x, vextq_s32(zero, x, 3)); \
+	x = vaddq_s32(x, vextq_s32(zero, x, 2)); \
+	x = vaddq_s32(x, last); \
+	last = vdupq_laneq_s32(x, 3)
+
+/* See FLAC__fixed_restore_signal_intrin_sse2() */
+void FLAC__fixed_restore_signal_intrin_neon(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[])
+{
+	int i, idata_len = (int)data_len;
+	const int32x4_t zero = vdupq_n_s32(0);
+	int32x4_t x, last0, last1, last2, last3;
+
+	if(order == 0 || idata_len < 4) {
+		FLAC__fixed_restore_signal(residual, data_len, order, data);
+		return;
+	}
+
+	FLAC__ASSERT(order <= FLAC__MAX_FIXED_ORDER);
+
+	last0 = vdupq_n_s32(data[-1]);
+	switch(order) {
+		case 1:
+			for(i = 0; i + 4 <= idata_len; i += 4) {
+				x = vld1q_s32(residual+i);
+				RUNNING_SUM(x, last0);
+				vst1q_s32(data+i, x);
+			}
+			break;
+		case 2:
+			last1 = vdupq_n_s32(data[-1] - data[-2]);
+			for(i = 0; i + 4 <= idata_len; i += 4) {
+				x = vld1q_s32(residual+i);
+				RUNNING_SUM(x, last1);
+				RUNNING_SUM(x, last0);
+				vst1q_s32(data+i, x);
+			}
+			break;
+		case 3:
+			last1 = vdupq_n_s32(data[-1] - data[-2]);
+			last2 = vdupq_n_s32(data[-1] - 2*data[-2] + data[-3]);
+			for(i = 0; i + 4 <= idata_len; i += 4) {
+				x = vld1q_s32(residual+i);
+				RUNNING_SUM(x, last2);
+				RUNNING_SUM(x, last1);
+				RUNNING_SUM(x, last0);
+				vst1q_s32(data+i, x);
+			}
+			break;
+		default: /* order == 4 */
+			last1 = vdupq_n_s32(data[-1] - data[-2]);
+			last2 = vdupq_n_s32(data[-1] - 2*data[-2] + data[-3]);
+			last3 = vdupq_n_s32(data[-1] - 3*data[-2] + 3*data[-3] - data[-4]);
+			for(i = 0; i + 4 <= idata_len; i += 4) {
+				x = vld1q_s32(residual+i);
+				RUNNING_SUM(x, last3);
+				RUNNING_SUM(x, last2);
+				RUNNING_SUM(x, last1);
+				RUNNING_SUM(x, last0);
+				vst1q_s32(data+i, x);
+			}
+			break;
+	}
+
+	if(i < idata_len)
+		FLAC__fixed_restore_signal(residual+i, data_len-i, order, data+i);
+}
+
+#endif /* FLAC__CPU_ARM64 && FLAC__HAS_NEONINTRIN */
+#endif /* FLAC__NO_ASM */
+#endif /* FLAC__INTEGER_ONLY_LIBRARY */
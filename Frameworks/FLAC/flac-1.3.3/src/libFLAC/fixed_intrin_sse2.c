@@ -46,7 +46,7 @@
 #include <math.h>
 #include "private/macros.h"
 #include "share/compat.h"
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 
 #ifdef FLAC__CPU_IA32
 #define m128i_to_i64(dest, src) _mm_storel_epi64((__m128i*)&dest, src)
@@ -249,6 +249,81 @@ uint32_t FLAC__fixed_compute_best_predictor_wide_intrin_sse2(const FLAC__int32 d
 	return order;
 }
 
+/* Replaces x by its running sum, continuing from last, and sets last to
+ * the last of these sums */
+#define RUNNING_SUM(x, last) \
+	x = _mm_add_epi32(x, _mm_slli_si128(x, 4)); \
+	x = _mm_add_epi32(x, _mm_slli_si128(x, 8)); \
+	x = _mm_add_epi32(x, last); \
+	last = _mm_shuffle_epi32(x, _MM_SHUFFLE(3,3,3,3))
+
+/*
+ * The signal is the residual summed up order times over, each running sum
+ * starting from the last difference of that order in the warmup samples.
+ * Running sums are computed four samples at a time, which leaves only the
+ * carry from one group of four to the next as a dependency chain.
+ */
+FLAC__SSE_TARGET("sse2")
+void FLAC__fixed_restore_signal_intrin_sse2(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[])
+{
+	int i, idata_len = (int)data_len;
+	__m128i x, last0, last1, last2, last3;
+
+	if(order == 0 || idata_len < 4) {
+		FLAC__fixed_restore_signal(residual, data_len, order, data);
+		return;
+	}
+
+	FLAC__ASSERT(order <= FLAC__MAX_FIXED_ORDER);
+
+	last0 = _mm_set1_epi32(data[-1]);
+	switch(order) {
+		case 1:
+			for(i = 0; i + 4 <= idata_len; i += 4) {
+				x = _mm_loadu_si128((const __m128i*)(residual+i));
+				RUNNING_SUM(x, last0);
+				_mm_storeu_si128((__m128i*)(data+i), x);
+			}
+			break;
+		case 2:
+			last1 = _mm_set1_epi32(data[-1] - data[-2]);
+			for(i = 0; i + 4 <= idata_len; i += 4) {
+				x = _mm_loadu_si128((const __m128i*)(residual+i));
+				RUNNING_SUM(x, last1);
+				RUNNING_SUM(x, last0);
+				_mm_storeu_si128((__m128i*)(data+i), x);
+			}
+			break;
+		case 3:
+			last1 = _mm_set1_epi32(data[-1] - data[-2]);
+			last2 = _mm_set1_epi32(data[-1] - 2*data[-2] + data[-3]);
+			for(i = 0; i + 4 <= idata_len; i += 4) {
+				x = _mm_loadu_si128((const __m128i*)(residual+i));
+				RUNNING_SUM(x, last2);
+				RUNNING_SUM(x, last1);
+				RUNNING_SUM(x, last0);
+				_mm_storeu_si128((__m128i*)(data+i), x);
+			}
+			break;
+		default: /* order == 4 */
+			last1 = _mm_set1_epi32(data[-1] - data[-2]);
+			last2 = _mm_set1_epi32(data[-1] - 2*data[-2] + data[-3]);
+			last3 = _mm_set1_epi32(data[-1] - 3*data[-2] + 3*data[-3] - data[-4]);
+			for(i = 0; i + 4 <= idata_len; i += 4) {
+				x = _mm_loadu_si128((const __m128i*)(residual+i));
+				RUNNING_SUM(x, last3);
+				RUNNING_SUM(x, last2);
+				RUNNING_SUM(x, last1);
+				RUNNING_SUM(x, last0);
+				_mm_storeu_si128((__m128i*)(data+i), x);
+			}
+			break;
+	}
+
+	if(i < idata_len)
+		FLAC__fixed_restore_signal(residual+i, data_len-i, order, data+i);
+}
+
 #endif /* FLAC__SSE2_SUPPORTED */
 #endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
 #endif /* FLAC__NO_ASM */
@@ -46,7 +46,7 @@
 #include <math.h>
 #include "private/macros.h"
 #include "share/compat.h"
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 
 #ifdef FLAC__CPU_IA32
 #define m128i_to_i64(dest, src) _mm_storel_epi64((__m128i*)&dest, src)
@@ -55,6 +55,21 @@
 
 #endif
 
+#ifndef FLAC__CPU_ARM64
+
+#if defined(__aarch64__) || defined(__arm64__) || defined(_M_ARM64)
+#define FLAC__CPU_ARM64
+#endif
+
+#endif
+
+#if defined FLAC__CPU_ARM64 && !defined FLAC__HAS_NEONINTRIN
+/* Advanced SIMD is part of the base ARMv8-A architecture */
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define FLAC__HAS_NEONINTRIN 1
+#endif
+#endif
+
 #ifndef __has_attribute
 #define __has_attribute(x) 0
 #endif
@@ -77,22 +92,17 @@
     #define FLAC__FMA_SUPPORTED 1
   #endif
 #elif defined __clang__ && __has_attribute(__target__) /* clang */
+  /* Any clang with the target attribute has all of these; probing for
+   * __builtin_ia32_* no longer works, as newer versions replaced many of
+   * them with generic builtins */
   #define FLAC__SSE_TARGET(x) __attribute__ ((__target__ (x)))
-  #if __has_builtin(__builtin_ia32_maxps)
-    #define FLAC__SSE_SUPPORTED 1
-  #endif
-  #if __has_builtin(__builtin_ia32_pmuludq128)
-    #define FLAC__SSE2_SUPPORTED 1
-  #endif
-  #if __has_builtin(__builtin_ia32_pabsd128)
-    #define FLAC__SSSE3_SUPPORTED 1
-  #endif
-  #if __has_builtin(__builtin_ia32_pmuldq128)
-    #define FLAC__SSE4_1_SUPPORTED 1
-  #endif
-  #if __has_builtin(__builtin_ia32_pabsd256)
-    #define FLAC__AVX2_SUPPORTED 1
-  #endif
+  #define FLAC__SSE_SUPPORTED 1
+  #define FLAC__SSE2_SUPPORTED 1
+  #define FLAC__SSSE3_SUPPORTED 1
+  #define FLAC__SSE4_1_SUPPORTED 1
+  #define FLAC__AVX_SUPPORTED 1
+  #define FLAC__AVX2_SUPPORTED 1
+  #define FLAC__FMA_SUPPORTED 1
 #elif defined __GNUC__ && !defined __clang__ && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) /* GCC 4.9+ */
   #define FLAC__SSE_TARGET(x) __attribute__ ((__target__ (x)))
   #define FLAC__SSE_SUPPORTED 1
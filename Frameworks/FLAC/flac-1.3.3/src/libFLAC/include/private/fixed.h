@@ -103,5 +103,15 @@ void FLAC__fixed_compute_residual(const FLAC__int32 data[], uint32_t data_len, u
  *	OUT data[0,data_len-1]            original signal
  */
 void FLAC__fixed_restore_signal(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+#ifndef FLAC__NO_ASM
+# if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
+#  ifdef FLAC__SSE2_SUPPORTED
+void FLAC__fixed_restore_signal_intrin_sse2(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+#  endif
+# endif
+# if defined FLAC__CPU_ARM64 && FLAC__HAS_NEONINTRIN
+void FLAC__fixed_restore_signal_intrin_neon(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
+# endif
+#endif
 
 #endif
@@ -42,10 +42,11 @@
 #include "private/lpc.h"
 #ifdef FLAC__AVX2_SUPPORTED
 
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 #include "FLAC/format.h"
 
 #include <immintrin.h> /* AVX2 */
+#include <string.h> /* for memcpy() */
 
 FLAC__SSE_TARGET("avx2")
 void FLAC__lpc_compute_residual_from_qlp_coefficients_16_intrin_avx2(const FLAC__int32 *data, uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 residual[])
@@ -1116,6 +1117,57 @@ void FLAC__lpc_compute_residual_from_qlp_coefficients_wide_intrin_avx2(const FLA
 	_mm256_zeroupper();
 }
 
+/* See the SSE4.1 restore_signal kernels; this does the same with a single
+ * register of four 64 bit sums */
+
+FLAC__SSE_TARGET("avx2")
+void FLAC__lpc_restore_signal_wide_intrin_avx2(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i, j;
+	FLAC__int32 q[32 + 4];
+	FLAC__int64 q0, q1, q2, q3, q4, q5, q6, h1, h2, h3, h4;
+	__m256i col[32];
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order < 8) {
+		FLAC__lpc_restore_signal_wide(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(q, 0, sizeof(q));
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3]; q4 = q[4]; q5 = q[5]; q6 = q[6];
+	for(j = 4; j < (int)order; j++)
+		col[j] = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(q + j)));
+
+	h1 = data[-1]; h2 = data[-2]; h3 = data[-3]; h4 = data[-4];
+	for(i = 0; i + 4 <= (int)data_len; i += 4) {
+		__m256i summ = _mm256_setzero_si256();
+		FLAC__int64 p[4];
+		FLAC__int32 d0, d1, d2, d3;
+
+		for(j = 4; j < (int)order; j++)
+			summ = _mm256_add_epi64(summ, _mm256_mul_epi32(_mm256_set1_epi32(data[i-1-j]), col[j]));
+		_mm256_storeu_si256((__m256i*)p, summ);
+
+		d0 = residual[i  ] + (FLAC__int32)((p[0] + q0*h1 + q1*h2 + q2*h3 + q3*h4                  ) >> lp_quantization);
+		d1 = residual[i+1] + (FLAC__int32)((p[1] + q1*h1 + q2*h2 + q3*h3 + q4*h4 + q0*d0          ) >> lp_quantization);
+		d2 = residual[i+2] + (FLAC__int32)((p[2] + q2*h1 + q3*h2 + q4*h3 + q5*h4 + q1*d0 + q0*d1  ) >> lp_quantization);
+		d3 = residual[i+3] + (FLAC__int32)((p[3] + q3*h1 + q4*h2 + q5*h3 + q6*h4 + q2*d0 + q1*d1 + q0*d2) >> lp_quantization);
+		data[i] = d0; data[i+1] = d1; data[i+2] = d2; data[i+3] = d3;
+		h1 = d3; h2 = d2; h3 = d1; h4 = d0;
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int64 sum = 0;
+		for(j = 0; j < (int)order; j++)
+			sum += q[j] * (FLAC__int64)data[i-1-j];
+		data[i] = residual[i] + (FLAC__int32)(sum >> lp_quantization);
+	}
+	_mm256_zeroupper();
+}
+
 #endif /* FLAC__AVX2_SUPPORTED */
 #endif /* (FLAC__CPU_IA32 || FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN */
 #endif /* FLAC__NO_ASM */
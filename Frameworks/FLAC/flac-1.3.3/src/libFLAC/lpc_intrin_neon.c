@@ -0,0 +1,150 @@
+/* libFLAC - Free Lossless Audio Codec library
+ * Copyright (C) 2000-2009  Josh Coalson
+ * Copyright (C) 2011-2016  Xiph.Org Foundation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "private/cpu.h"
+
+#ifndef FLAC__INTEGER_ONLY_LIBRARY
+#ifndef FLAC__NO_ASM
+#if defined FLAC__CPU_ARM64 && FLAC__HAS_NEONINTRIN
+#include "private/lpc.h"
+#include "FLAC/FLAC_assert.h"
+#include "FLAC/format.h"
+
+#include <arm_neon.h>
+#include <string.h> /* for memcpy() */
+
+/*
+ * Same scheme as the SSE4.1 restore_signal kernels: the terms on samples
+ * from before the previous four are summed four lanes at a time, and only
+ * the terms on the four most recent samples are left to the scalar code.
+ */
+
+void FLAC__lpc_restore_signal_intrin_neon(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i, j;
+	FLAC__int32 q[32 + 4], q0, q1, q2, q3, q4, q5, q6, h1, h2, h3, h4;
+	int32x4_t col[32];
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order < 8) {
+		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(q, 0, sizeof(q));
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3]; q4 = q[4]; q5 = q[5]; q6 = q[6];
+	/* col[j] holds the coefficients d[i-1-j] is multiplied with for d[i], d[i+1], d[i+2] and d[i+3] */
+	for(j = 4; j < (int)order; j++)
+		col[j] = vld1q_s32(q + j);
+
+	h1 = data[-1]; h2 = data[-2]; h3 = data[-3]; h4 = data[-4];
+	for(i = 0; i + 4 <= (int)data_len; i += 4) {
+		int32x4_t summ = vdupq_n_s32(0);
+		FLAC__int32 d0, d1, d2, d3;
+
+		for(j = 4; j < (int)order; j++)
+			summ = vmlaq_n_s32(summ, col[j], data[i-1-j]);
+
+		d0 = residual[i  ] + ((vgetq_lane_s32(summ, 0) + q0*h1 + q1*h2 + q2*h3 + q3*h4                  ) >> lp_quantization);
+		d1 = residual[i+1] + ((vgetq_lane_s32(summ, 1) + q1*h1 + q2*h2 + q3*h3 + q4*h4 + q0*d0          ) >> lp_quantization);
+		d2 = residual[i+2] + ((vgetq_lane_s32(summ, 2) + q2*h1 + q3*h2 + q4*h3 + q5*h4 + q1*d0 + q0*d1  ) >> lp_quantization);
+		d3 = residual[i+3] + ((vgetq_lane_s32(summ, 3) + q3*h1 + q4*h2 + q5*h3 + q6*h4 + q2*d0 + q1*d1 + q0*d2) >> lp_quantization);
+		data[i] = d0; data[i+1] = d1; data[i+2] = d2; data[i+3] = d3;
+		h1 = d3; h2 = d2; h3 = d1; h4 = d0;
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int32 sum = 0;
+		for(j = 0; j < (int)order; j++)
+			sum += q[j] * data[i-1-j];
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+void FLAC__lpc_restore_signal_wide_intrin_neon(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i, j;
+	FLAC__int32 q[32 + 4];
+	FLAC__int64 q0, q1, q2, q3, q4, q5, q6, h1, h2, h3, h4;
+	int32x2_t col_lo[32], col_hi[32];
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order < 8) {
+		FLAC__lpc_restore_signal_wide(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(q, 0, sizeof(q));
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3]; q4 = q[4]; q5 = q[5]; q6 = q[6];
+	for(j = 4; j < (int)order; j++) {
+		col_lo[j] = vld1_s32(q + j);
+		col_hi[j] = vld1_s32(q + j + 2);
+	}
+
+	h1 = data[-1]; h2 = data[-2]; h3 = data[-3]; h4 = data[-4];
+	for(i = 0; i + 4 <= (int)data_len; i += 4) {
+		int64x2_t summ_lo = vdupq_n_s64(0), summ_hi = vdupq_n_s64(0);
+		FLAC__int32 d0, d1, d2, d3;
+
+		for(j = 4; j < (int)order; j++) {
+			summ_lo = vmlal_n_s32(summ_lo, col_lo[j], data[i-1-j]);
+			summ_hi = vmlal_n_s32(summ_hi, col_hi[j], data[i-1-j]);
+		}
+
+		d0 = residual[i  ] + (FLAC__int32)((vgetq_lane_s64(summ_lo, 0) + q0*h1 + q1*h2 + q2*h3 + q3*h4                  ) >> lp_quantization);
+		d1 = residual[i+1] + (FLAC__int32)((vgetq_lane_s64(summ_lo, 1) + q1*h1 + q2*h2 + q3*h3 + q4*h4 + q0*d0          ) >> lp_quantization);
+		d2 = residual[i+2] + (FLAC__int32)((vgetq_lane_s64(summ_hi, 0) + q2*h1 + q3*h2 + q4*h3 + q5*h4 + q1*d0 + q0*d1  ) >> lp_quantization);
+		d3 = residual[i+3] + (FLAC__int32)((vgetq_lane_s64(summ_hi, 1) + q3*h1 + q4*h2 + q5*h3 + q6*h4 + q2*d0 + q1*d1 + q0*d2) >> lp_quantization);
+		data[i] = d0; data[i+1] = d1; data[i+2] = d2; data[i+3] = d3;
+		h1 = d3; h2 = d2; h3 = d1; h4 = d0;
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int64 sum = 0;
+		for(j = 0; j < (int)order; j++)
+			sum += q[j] * (FLAC__int64)data[i-1-j];
+		data[i] = residual[i] + (FLAC__int32)(sum >> lp_quantization);
+	}
+}
+
+#endif /* FLAC__CPU_ARM64 && FLAC__HAS_NEONINTRIN */
+#endif /* FLAC__NO_ASM */
+#endif /* FLAC__INTEGER_ONLY_LIBRARY */
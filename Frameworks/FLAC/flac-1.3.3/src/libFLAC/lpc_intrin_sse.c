@@ -41,7 +41,7 @@
 #if (defined FLAC__CPU_IA32 || defined FLAC__CPU_X86_64) && FLAC__HAS_X86INTRIN
 #include "private/lpc.h"
 #ifdef FLAC__SSE_SUPPORTED
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 #include "FLAC/format.h"
 
 #include <xmmintrin.h> /* SSE */
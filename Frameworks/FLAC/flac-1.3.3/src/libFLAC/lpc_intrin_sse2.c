@@ -42,7 +42,7 @@
 #include "private/lpc.h"
 #ifdef FLAC__SSE2_SUPPORTED
 
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 #include "FLAC/format.h"
 
 #include <emmintrin.h> /* SSE2 */
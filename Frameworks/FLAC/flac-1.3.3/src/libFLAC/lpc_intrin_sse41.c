@@ -42,10 +42,11 @@
 #include "private/lpc.h"
 #ifdef FLAC__SSE4_1_SUPPORTED
 
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 #include "FLAC/format.h"
 
 #include <smmintrin.h> /* SSE4.1 */
+#include <string.h> /* for memcpy() */
 
 #if defined FLAC__CPU_IA32 /* unused for x64 */
 
@@ -588,451 +589,6 @@ void FLAC__lpc_compute_residual_from_qlp_coefficients_wide_intrin_sse41(const FL
 	}
 }
 
-FLAC__SSE_TARGET("sse4.1")
-void FLAC__lpc_restore_signal_wide_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
-{
-	int i;
-	const __m128i cnt = _mm_cvtsi32_si128(lp_quantization);
-
-	if (!data_len)
-		return;
-
-	FLAC__ASSERT(order > 0);
-	FLAC__ASSERT(order <= 32);
-	FLAC__ASSERT(lp_quantization <= 32); /* there's no _mm_sra_epi64() so we have to use _mm_srl_epi64() */
-
-	if(order <= 12) {
-		if(order > 8) { /* order == 9, 10, 11, 12 */
-			if(order > 10) { /* order == 11, 12 */
-				__m128i qlp[6], dat[6];
-				__m128i summ, temp;
-				qlp[0] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+0)));		// 0  q[1]  0  q[0]
-				qlp[1] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+2)));		// 0  q[3]  0  q[2]
-				qlp[2] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+4)));		// 0  q[5]  0  q[4]
-				qlp[3] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+6)));		// 0  q[7]  0  q[6]
-				qlp[4] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+8)));		// 0  q[9]  0  q[8]
-				if (order == 12)
-					qlp[5] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+10)));	// 0  q[11] 0  q[10]
-				else
-					qlp[5] = _mm_cvtepu32_epi64(_mm_cvtsi32_si128(qlp_coeff[10]));					// 0    0   0  q[10]
-
-				dat[5] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-12)), _MM_SHUFFLE(2,0,3,1));	// 0  d[i-12] 0  d[i-11]
-				dat[4] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-10)), _MM_SHUFFLE(2,0,3,1));	// 0  d[i-10] 0  d[i-9]
-				dat[3] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-8 )), _MM_SHUFFLE(2,0,3,1));	// 0  d[i-8]  0  d[i-7]
-				dat[2] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-6 )), _MM_SHUFFLE(2,0,3,1));	// 0  d[i-6]  0  d[i-5]
-				dat[1] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-4 )), _MM_SHUFFLE(2,0,3,1));	// 0  d[i-4]  0  d[i-3]
-				dat[0] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-2 )), _MM_SHUFFLE(2,0,3,1));	// 0  d[i-2]  0  d[i-1]
-
-				summ =                     _mm_mul_epi32(dat[5], qlp[5]) ;
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[4], qlp[4]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[3], qlp[3]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[2], qlp[2]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[1], qlp[1]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-				summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));	// ?_64  sum_64
-				summ = _mm_srl_epi64(summ, cnt);						// ?_64  (sum >> lp_quantization)_64  ==  ?_32  ?_32  ?_32  (sum >> lp_quantization)_32
-				temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[0]), summ);	// ?  ?  ?  d[i]
-				data[0] = _mm_cvtsi128_si32(temp);
-
-				for(i = 1; i < (int)data_len; i++) {
-					temp = _mm_slli_si128(temp, 8);
-					dat[5] = _mm_alignr_epi8(dat[5], dat[4], 8);	//  ?  d[i-11] ?  d[i-10]
-					dat[4] = _mm_alignr_epi8(dat[4], dat[3], 8);	//  ?  d[i-9]  ?  d[i-8]
-					dat[3] = _mm_alignr_epi8(dat[3], dat[2], 8);	//  ?  d[i-7]  ?  d[i-6]
-					dat[2] = _mm_alignr_epi8(dat[2], dat[1], 8);	//  ?  d[i-5]  ?  d[i-4]
-					dat[1] = _mm_alignr_epi8(dat[1], dat[0], 8);	//  ?  d[i-3]  ?  d[i-2]
-					dat[0] = _mm_alignr_epi8(dat[0],   temp, 8);	//  ?  d[i-1]  ?  d[i  ]
-
-					summ =                     _mm_mul_epi32(dat[5], qlp[5]) ;
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[4], qlp[4]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[3], qlp[3]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[2], qlp[2]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[1], qlp[1]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-					summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));	// ?_64  sum_64
-					summ = _mm_srl_epi64(summ, cnt);						// ?_64  (sum >> lp_quantization)_64  ==  ?_32  ?_32  ?_32  (sum >> lp_quantization)_32
-					temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);	// ?  ?  ?  d[i]
-					data[i] = _mm_cvtsi128_si32(temp);
-				}
-			}
-			else { /* order == 9, 10 */
-				__m128i qlp[5], dat[5];
-				__m128i summ, temp;
-				qlp[0] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+0)));
-				qlp[1] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+2)));
-				qlp[2] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+4)));
-				qlp[3] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+6)));
-				if (order == 10)
-					qlp[4] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+8)));
-				else
-					qlp[4] = _mm_cvtepu32_epi64(_mm_cvtsi32_si128(qlp_coeff[8]));
-
-				dat[4] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-10)), _MM_SHUFFLE(2,0,3,1));
-				dat[3] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-8 )), _MM_SHUFFLE(2,0,3,1));
-				dat[2] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-6 )), _MM_SHUFFLE(2,0,3,1));
-				dat[1] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-4 )), _MM_SHUFFLE(2,0,3,1));
-				dat[0] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-2 )), _MM_SHUFFLE(2,0,3,1));
-
-				summ =                     _mm_mul_epi32(dat[4], qlp[4]) ;
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[3], qlp[3]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[2], qlp[2]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[1], qlp[1]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-				summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-				summ = _mm_srl_epi64(summ, cnt);
-				temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[0]), summ);
-				data[0] = _mm_cvtsi128_si32(temp);
-
-				for(i = 1; i < (int)data_len; i++) {
-					temp = _mm_slli_si128(temp, 8);
-					dat[4] = _mm_alignr_epi8(dat[4], dat[3], 8);
-					dat[3] = _mm_alignr_epi8(dat[3], dat[2], 8);
-					dat[2] = _mm_alignr_epi8(dat[2], dat[1], 8);
-					dat[1] = _mm_alignr_epi8(dat[1], dat[0], 8);
-					dat[0] = _mm_alignr_epi8(dat[0],   temp, 8);
-
-					summ =                     _mm_mul_epi32(dat[4], qlp[4]) ;
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[3], qlp[3]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[2], qlp[2]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[1], qlp[1]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-					summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-					summ = _mm_srl_epi64(summ, cnt);
-					temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);
-					data[i] = _mm_cvtsi128_si32(temp);
-				}
-			}
-		}
-		else if(order > 4) { /* order == 5, 6, 7, 8 */
-			if(order > 6) { /* order == 7, 8 */
-				__m128i qlp[4], dat[4];
-				__m128i summ, temp;
-				qlp[0] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+0)));
-				qlp[1] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+2)));
-				qlp[2] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+4)));
-				if (order == 8)
-					qlp[3] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+6)));
-				else
-					qlp[3] = _mm_cvtepu32_epi64(_mm_cvtsi32_si128(qlp_coeff[6]));
-
-				dat[3] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-8 )), _MM_SHUFFLE(2,0,3,1));
-				dat[2] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-6 )), _MM_SHUFFLE(2,0,3,1));
-				dat[1] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-4 )), _MM_SHUFFLE(2,0,3,1));
-				dat[0] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-2 )), _MM_SHUFFLE(2,0,3,1));
-
-				summ =                     _mm_mul_epi32(dat[3], qlp[3]) ;
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[2], qlp[2]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[1], qlp[1]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-				summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-				summ = _mm_srl_epi64(summ, cnt);
-				temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[0]), summ);
-				data[0] = _mm_cvtsi128_si32(temp);
-
-				for(i = 1; i < (int)data_len; i++) {
-					temp = _mm_slli_si128(temp, 8);
-					dat[3] = _mm_alignr_epi8(dat[3], dat[2], 8);
-					dat[2] = _mm_alignr_epi8(dat[2], dat[1], 8);
-					dat[1] = _mm_alignr_epi8(dat[1], dat[0], 8);
-					dat[0] = _mm_alignr_epi8(dat[0],   temp, 8);
-
-					summ =                     _mm_mul_epi32(dat[3], qlp[3]) ;
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[2], qlp[2]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[1], qlp[1]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-					summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-					summ = _mm_srl_epi64(summ, cnt);
-					temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);
-					data[i] = _mm_cvtsi128_si32(temp);
-				}
-			}
-			else { /* order == 5, 6 */
-				__m128i qlp[3], dat[3];
-				__m128i summ, temp;
-				qlp[0] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+0)));
-				qlp[1] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+2)));
-				if (order == 6)
-					qlp[2] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+4)));
-				else
-					qlp[2] = _mm_cvtepu32_epi64(_mm_cvtsi32_si128(qlp_coeff[4]));
-
-				dat[2] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-6 )), _MM_SHUFFLE(2,0,3,1));
-				dat[1] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-4 )), _MM_SHUFFLE(2,0,3,1));
-				dat[0] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-2 )), _MM_SHUFFLE(2,0,3,1));
-
-				summ =                     _mm_mul_epi32(dat[2], qlp[2]) ;
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[1], qlp[1]));
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-				summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-				summ = _mm_srl_epi64(summ, cnt);
-				temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[0]), summ);
-				data[0] = _mm_cvtsi128_si32(temp);
-
-				for(i = 1; i < (int)data_len; i++) {
-					temp = _mm_slli_si128(temp, 8);
-					dat[2] = _mm_alignr_epi8(dat[2], dat[1], 8);
-					dat[1] = _mm_alignr_epi8(dat[1], dat[0], 8);
-					dat[0] = _mm_alignr_epi8(dat[0],   temp, 8);
-
-					summ =                     _mm_mul_epi32(dat[2], qlp[2]) ;
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[1], qlp[1]));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-					summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-					summ = _mm_srl_epi64(summ, cnt);
-					temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);
-					data[i] = _mm_cvtsi128_si32(temp);
-				}
-			}
-		}
-		else { /* order == 1, 2, 3, 4 */
-			if(order > 2) { /* order == 3, 4 */
-				__m128i qlp[2], dat[2];
-				__m128i summ, temp;
-				qlp[0] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+0)));
-				if (order == 4)
-					qlp[1] = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff+2)));
-				else
-					qlp[1] = _mm_cvtepu32_epi64(_mm_cvtsi32_si128(qlp_coeff[2]));
-
-				dat[1] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-4 )), _MM_SHUFFLE(2,0,3,1));
-				dat[0] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-2 )), _MM_SHUFFLE(2,0,3,1));
-
-				summ =                     _mm_mul_epi32(dat[1], qlp[1]) ;
-				summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-				summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-				summ = _mm_srl_epi64(summ, cnt);
-				temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[0]), summ);
-				data[0] = _mm_cvtsi128_si32(temp);
-
-				for(i = 1; i < (int)data_len; i++) {
-					temp = _mm_slli_si128(temp, 8);
-					dat[1] = _mm_alignr_epi8(dat[1], dat[0], 8);
-					dat[0] = _mm_alignr_epi8(dat[0],   temp, 8);
-
-					summ =                     _mm_mul_epi32(dat[1], qlp[1]) ;
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat[0], qlp[0]));
-
-					summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-					summ = _mm_srl_epi64(summ, cnt);
-					temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);
-					data[i] = _mm_cvtsi128_si32(temp);
-				}
-			}
-			else { /* order == 1, 2 */
-				if(order == 2) {
-					__m128i qlp0, dat0;
-					__m128i summ, temp;
-					qlp0 = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(qlp_coeff)));
-
-					dat0 = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(data-2 )), _MM_SHUFFLE(2,0,3,1));
-
-					summ = _mm_mul_epi32(dat0, qlp0);
-
-					summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-					summ = _mm_srl_epi64(summ, cnt);
-					temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[0]), summ);
-					data[0] = _mm_cvtsi128_si32(temp);
-
-					for(i = 1; i < (int)data_len; i++) {
-						dat0 = _mm_alignr_epi8(dat0, _mm_slli_si128(temp, 8), 8);
-
-						summ = _mm_mul_epi32(dat0, qlp0);
-
-						summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-						summ = _mm_srl_epi64(summ, cnt);
-						temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);
-						data[i] = _mm_cvtsi128_si32(temp);
-					}
-				}
-				else { /* order == 1 */
-					__m128i qlp0;
-					__m128i summ, temp;
-					qlp0 = _mm_cvtsi32_si128(qlp_coeff[0]);
-					temp = _mm_cvtsi32_si128(data[-1]);
-
-					summ = _mm_mul_epi32(temp, qlp0);
-					summ = _mm_srl_epi64(summ, cnt);
-					temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[0]), summ);
-					data[0] = _mm_cvtsi128_si32(temp);
-
-					for(i = 1; i < (int)data_len; i++) {
-						summ = _mm_mul_epi32(temp, qlp0);
-						summ = _mm_srl_epi64(summ, cnt);
-						temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);
-						data[i] = _mm_cvtsi128_si32(temp);
-					}
-				}
-			}
-		}
-	}
-	else { /* order > 12 */
-		__m128i qlp[16];
-
-		for(i = 0; i < (int)order/2; i++)
-			qlp[i] = _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i*)(qlp_coeff+i*2)), _MM_SHUFFLE(2,0,3,1));	// 0  q[2*i]  0  q[2*i+1]
-		if(order & 1)
-			qlp[i] = _mm_shuffle_epi32(_mm_cvtsi32_si128(qlp_coeff[i*2]), _MM_SHUFFLE(2,0,3,1));
-
-		for(i = 0; i < (int)data_len; i++) {
-			__m128i summ = _mm_setzero_si128(), dat;
-			FLAC__int32 * const datai = &data[i];
-
-			switch((order+1) / 2) {
-				case 16: /* order == 31, 32 */
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-32)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[15]));                /* Falls through. */
-				case 15:
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-30)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[14]));                /* Falls through. */
-				case 14:
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-28)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[13]));                /* Falls through. */
-				case 13:
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-26)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[12]));                /* Falls through. */
-				case 12:
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-24)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[11]));                /* Falls through. */
-				case 11:
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-22)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[10]));                /* Falls through. */
-				case 10:
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-20)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[9]));                 /* Falls through. */
-				case  9:
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-18)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[8]));                 /* Falls through. */
-				case  8:
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-16)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[7]));                 /* Falls through. */
-				case  7: /* order == 13, 14 */
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-14)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[6]));
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-12)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[5]));
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-10)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[4]));
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-8)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[3]));
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-6)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[2]));
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-4)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[1]));
-					dat = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i*)(datai-2)));
-					summ = _mm_add_epi64(summ, _mm_mul_epi32(dat, qlp[0]));
-			}
-			summ = _mm_add_epi64(summ, _mm_srli_si128(summ, 8));
-			summ = _mm_srl_epi64(summ, cnt);
-			summ = _mm_add_epi32(summ, _mm_cvtsi32_si128(residual[i]));
-			data[i] = _mm_cvtsi128_si32(summ);
-		}
-	}
-}
-
-FLAC__SSE_TARGET("sse4.1")
-void FLAC__lpc_restore_signal_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
-{
-	if(order < 8) {
-		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
-		return;
-	}
-
-	FLAC__ASSERT(order >= 8);
-	FLAC__ASSERT(order <= 32);
-
-	if(order <= 12) {
-		int i;
-		const __m128i cnt = _mm_cvtsi32_si128(lp_quantization);
-
-		if(order > 8) /* order == 9, 10, 11, 12 */
-		{
-			__m128i qlp[3], dat[3];
-			__m128i summ, temp;
-
-			qlp[0] = _mm_loadu_si128((const __m128i*)(qlp_coeff + 0));	// q[3]  q[2]  q[1]  q[0]
-			qlp[1] = _mm_loadu_si128((const __m128i*)(qlp_coeff + 4));	// q[7]  q[6]  q[5]  q[4]
-			qlp[2] = _mm_loadu_si128((const __m128i*)(qlp_coeff + 8));	// q[11] q[10] q[9]  q[8]
-			switch (order)
-			{
-			case 9:
-				qlp[2] = _mm_slli_si128(qlp[2], 12); qlp[2] = _mm_srli_si128(qlp[2], 12); break;	//   0     0     0   q[8]
-			case 10:
-				qlp[2] = _mm_slli_si128(qlp[2], 8); qlp[2] = _mm_srli_si128(qlp[2], 8); break;	//   0     0   q[9]  q[8]
-			case 11:
-				qlp[2] = _mm_slli_si128(qlp[2], 4); qlp[2] = _mm_srli_si128(qlp[2], 4); break;	//   0   q[10] q[9]  q[8]
-			}
-
-			dat[2] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(data - 12)), _MM_SHUFFLE(0, 1, 2, 3));	// d[i-12] d[i-11] d[i-10] d[i-9]
-			dat[1] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(data - 8)), _MM_SHUFFLE(0, 1, 2, 3));	// d[i-8]  d[i-7]  d[i-6]  d[i-5]
-			dat[0] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(data - 4)), _MM_SHUFFLE(0, 1, 2, 3));	// d[i-4]  d[i-3]  d[i-2]  d[i-1]
-
-			for (i = 0;;) {
-				summ = _mm_mullo_epi32(dat[2], qlp[2]);
-				summ = _mm_add_epi32(summ, _mm_mullo_epi32(dat[1], qlp[1]));
-				summ = _mm_add_epi32(summ, _mm_mullo_epi32(dat[0], qlp[0]));
-
-				summ = _mm_add_epi32(summ, _mm_shuffle_epi32(summ, _MM_SHUFFLE(1,0,3,2)));
-				summ = _mm_add_epi32(summ, _mm_shufflelo_epi16(summ, _MM_SHUFFLE(1,0,3,2)));
-
-				summ = _mm_sra_epi32(summ, cnt);
-				temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);
-				data[i] = _mm_cvtsi128_si32(temp);
-
-				if(++i >= (int)data_len) break;
-
-				temp = _mm_slli_si128(temp, 12);
-				dat[2] = _mm_alignr_epi8(dat[2], dat[1], 12);
-				dat[1] = _mm_alignr_epi8(dat[1], dat[0], 12);
-				dat[0] = _mm_alignr_epi8(dat[0], temp, 12);
-			}
-		}
-		else /* order == 8 */
-		{
-			__m128i qlp[2], dat[2];
-			__m128i summ, temp;
-
-			qlp[0] = _mm_loadu_si128((const __m128i*)(qlp_coeff + 0));
-			qlp[1] = _mm_loadu_si128((const __m128i*)(qlp_coeff + 4));
-
-			dat[1] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(data - 8)), _MM_SHUFFLE(0, 1, 2, 3));
-			dat[0] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(data - 4)), _MM_SHUFFLE(0, 1, 2, 3));
-
-			for (i = 0;;) {
-				summ = _mm_add_epi32(_mm_mullo_epi32(dat[1], qlp[1]), _mm_mullo_epi32(dat[0], qlp[0]));
-
-				summ = _mm_add_epi32(summ, _mm_shuffle_epi32(summ, _MM_SHUFFLE(1,0,3,2)));
-				summ = _mm_add_epi32(summ, _mm_shufflelo_epi16(summ, _MM_SHUFFLE(1,0,3,2)));
-
-				summ = _mm_sra_epi32(summ, cnt);
-				temp = _mm_add_epi32(_mm_cvtsi32_si128(residual[i]), summ);
-				data[i] = _mm_cvtsi128_si32(temp);
-
-				if(++i >= (int)data_len) break;
-
-				temp = _mm_slli_si128(temp, 12);
-				dat[1] = _mm_alignr_epi8(dat[1], dat[0], 12);
-				dat[0] = _mm_alignr_epi8(dat[0], temp, 12);
-			}
-		}
-	}
-	else { /* order > 12 */
-#ifdef FLAC__HAS_NASM
-		FLAC__lpc_restore_signal_asm_ia32(residual, data_len, qlp_coeff, order, lp_quantization, data);
-#else
-		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
-#endif
-	}
-}
-
 FLAC__SSE_TARGET("ssse3")
 void FLAC__lpc_restore_signal_16_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
 {
@@ -1134,6 +690,114 @@ void FLAC__lpc_restore_signal_16_intrin_sse41(const FLAC__int32 residual[], uint
 
 #endif /* defined FLAC__CPU_IA32 */
 
+/*
+ * The restore_signal kernels below restore four samples at a time.  The
+ * part of the prediction that depends on samples from before the previous
+ * four is summed in vector registers, which the CPU can do ahead of time;
+ * only the terms on the most recent samples, which form the dependency
+ * chain from one sample to the next, are added in scalar registers.  That
+ * chain is as long as in the plain C loop, so below order 8, where there is
+ * little left to sum ahead of time, the C routines are faster.
+ */
+
+FLAC__SSE_TARGET("sse4.1")
+void FLAC__lpc_restore_signal_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i, j;
+	FLAC__int32 q[32 + 4], q0, q1, q2, q3, q4, q5, q6, h1, h2, h3, h4;
+	__m128i col[32];
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order < 8) {
+		FLAC__lpc_restore_signal(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(q, 0, sizeof(q));
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3]; q4 = q[4]; q5 = q[5]; q6 = q[6];
+	/* col[j] holds the coefficients d[i-1-j] is multiplied with for d[i], d[i+1], d[i+2] and d[i+3] */
+	for(j = 4; j < (int)order; j++)
+		col[j] = _mm_loadu_si128((const __m128i*)(q + j));
+
+	h1 = data[-1]; h2 = data[-2]; h3 = data[-3]; h4 = data[-4];
+	for(i = 0; i + 4 <= (int)data_len; i += 4) {
+		__m128i summ = _mm_setzero_si128();
+		FLAC__int32 d0, d1, d2, d3;
+
+		for(j = 4; j < (int)order; j++)
+			summ = _mm_add_epi32(summ, _mm_mullo_epi32(_mm_set1_epi32(data[i-1-j]), col[j]));
+
+		d0 = residual[i  ] + ((_mm_cvtsi128_si32(summ)    + q0*h1 + q1*h2 + q2*h3 + q3*h4                  ) >> lp_quantization);
+		d1 = residual[i+1] + ((_mm_extract_epi32(summ, 1) + q1*h1 + q2*h2 + q3*h3 + q4*h4 + q0*d0          ) >> lp_quantization);
+		d2 = residual[i+2] + ((_mm_extract_epi32(summ, 2) + q2*h1 + q3*h2 + q4*h3 + q5*h4 + q1*d0 + q0*d1  ) >> lp_quantization);
+		d3 = residual[i+3] + ((_mm_extract_epi32(summ, 3) + q3*h1 + q4*h2 + q5*h3 + q6*h4 + q2*d0 + q1*d1 + q0*d2) >> lp_quantization);
+		data[i] = d0; data[i+1] = d1; data[i+2] = d2; data[i+3] = d3;
+		h1 = d3; h2 = d2; h3 = d1; h4 = d0;
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int32 sum = 0;
+		for(j = 0; j < (int)order; j++)
+			sum += q[j] * data[i-1-j];
+		data[i] = residual[i] + (sum >> lp_quantization);
+	}
+}
+
+FLAC__SSE_TARGET("sse4.1")
+void FLAC__lpc_restore_signal_wide_intrin_sse41(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[])
+{
+	int i, j;
+	FLAC__int32 q[32 + 4];
+	FLAC__int64 q0, q1, q2, q3, q4, q5, q6, h1, h2, h3, h4;
+	__m128i col_lo[32], col_hi[32];
+
+	FLAC__ASSERT(order > 0);
+	FLAC__ASSERT(order <= 32);
+
+	if(order < 8) {
+		FLAC__lpc_restore_signal_wide(residual, data_len, qlp_coeff, order, lp_quantization, data);
+		return;
+	}
+
+	memset(q, 0, sizeof(q));
+	memcpy(q, qlp_coeff, sizeof(FLAC__int32) * order);
+	q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3]; q4 = q[4]; q5 = q[5]; q6 = q[6];
+	for(j = 4; j < (int)order; j++) {
+		col_lo[j] = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(q + j)));
+		col_hi[j] = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(q + j + 2)));
+	}
+
+	h1 = data[-1]; h2 = data[-2]; h3 = data[-3]; h4 = data[-4];
+	for(i = 0; i + 4 <= (int)data_len; i += 4) {
+		__m128i summ_lo = _mm_setzero_si128(), summ_hi = _mm_setzero_si128();
+		FLAC__int64 p[4];
+		FLAC__int32 d0, d1, d2, d3;
+
+		for(j = 4; j < (int)order; j++) {
+			const __m128i d = _mm_set1_epi32(data[i-1-j]);
+			summ_lo = _mm_add_epi64(summ_lo, _mm_mul_epi32(d, col_lo[j]));
+			summ_hi = _mm_add_epi64(summ_hi, _mm_mul_epi32(d, col_hi[j]));
+		}
+		_mm_storeu_si128((__m128i*)(p + 0), summ_lo);
+		_mm_storeu_si128((__m128i*)(p + 2), summ_hi);
+
+		d0 = residual[i  ] + (FLAC__int32)((p[0] + q0*h1 + q1*h2 + q2*h3 + q3*h4                  ) >> lp_quantization);
+		d1 = residual[i+1] + (FLAC__int32)((p[1] + q1*h1 + q2*h2 + q3*h3 + q4*h4 + q0*d0          ) >> lp_quantization);
+		d2 = residual[i+2] + (FLAC__int32)((p[2] + q2*h1 + q3*h2 + q4*h3 + q5*h4 + q1*d0 + q0*d1  ) >> lp_quantization);
+		d3 = residual[i+3] + (FLAC__int32)((p[3] + q3*h1 + q4*h2 + q5*h3 + q6*h4 + q2*d0 + q1*d1 + q0*d2) >> lp_quantization);
+		data[i] = d0; data[i+1] = d1; data[i+2] = d2; data[i+3] = d3;
+		h1 = d3; h2 = d2; h3 = d1; h4 = d0;
+	}
+	for(; i < (int)data_len; i++) {
+		FLAC__int64 sum = 0;
+		for(j = 0; j < (int)order; j++)
+			sum += q[j] * (FLAC__int64)data[i-1-j];
+		data[i] = residual[i] + (FLAC__int32)(sum >> lp_quantization);
+	}
+}
+
 FLAC__SSE_TARGET("sse4.1")
 void FLAC__lpc_compute_residual_from_qlp_coefficients_intrin_sse41(const FLAC__int32 *data, uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 residual[])
 {
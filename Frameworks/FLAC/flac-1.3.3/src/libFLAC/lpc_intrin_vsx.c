@@ -40,7 +40,7 @@
 
 #include "private/cpu.h"
 #include "private/lpc.h"
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 #include "FLAC/format.h"
 
 #include <altivec.h>
@@ -134,6 +134,7 @@ typedef struct FLAC__StreamDecoderPrivate {
 	void (*local_lpc_restore_signal_64bit)(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
 	/* for use when the signal is <= 16 bits-per-sample, or <= 15 bits-per-sample on a side channel (which requires 1 extra bit): */
 	void (*local_lpc_restore_signal_16bit)(const FLAC__int32 residual[], uint32_t data_len, const FLAC__int32 qlp_coeff[], uint32_t order, int lp_quantization, FLAC__int32 data[]);
+	void (*local_fixed_restore_signal)(const FLAC__int32 residual[], uint32_t data_len, uint32_t order, FLAC__int32 data[]);
 	void *client_data;
 	FILE *file; /* only used if FLAC__stream_decoder_init_file()/FLAC__stream_decoder_init_file() called, else NULL */
 	FLAC__BitReader *input;
@@ -377,6 +378,7 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 	decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal;
 	decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide;
 	decoder->private_->local_lpc_restore_signal_16bit = FLAC__lpc_restore_signal;
+	decoder->private_->local_fixed_restore_signal = FLAC__fixed_restore_signal;
 	/* now override with asm where appropriate */
 #ifndef FLAC__NO_ASM
 	if(decoder->private_->cpuinfo.use_asm) {
@@ -394,6 +396,10 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 		}
 #endif
 #if FLAC__HAS_X86INTRIN && ! defined FLAC__INTEGER_ONLY_LIBRARY
+# if defined FLAC__SSE2_SUPPORTED
+		if (decoder->private_->cpuinfo.x86.sse2)
+			decoder->private_->local_fixed_restore_signal = FLAC__fixed_restore_signal_intrin_sse2;
+# endif
 # if defined FLAC__SSE4_1_SUPPORTED
 		if (decoder->private_->cpuinfo.x86.sse41) {
 #  if !defined FLAC__HAS_NASM  /* these are not undoubtedly faster than their MMX ASM counterparts */
@@ -403,12 +409,39 @@ static FLAC__StreamDecoderInitStatus init_stream_internal_(
 			decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide_intrin_sse41;
 		}
 # endif
+# if defined FLAC__AVX2_SUPPORTED
+		if (decoder->private_->cpuinfo.x86.avx2)
+			decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide_intrin_avx2;
+# endif
 #endif
 #elif defined FLAC__CPU_X86_64
 		FLAC__ASSERT(decoder->private_->cpuinfo.type == FLAC__CPUINFO_TYPE_X86_64);
-		/* No useful SSE optimizations yet */
+#if FLAC__HAS_X86INTRIN && ! defined FLAC__INTEGER_ONLY_LIBRARY
+# if defined FLAC__SSE2_SUPPORTED
+		decoder->private_->local_fixed_restore_signal = FLAC__fixed_restore_signal_intrin_sse2;
+# endif
+# if defined FLAC__SSE4_1_SUPPORTED
+		if (decoder->private_->cpuinfo.x86.sse41) {
+			/* there is no separate 16 bit kernel: the 32 bit one is as fast */
+			decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal_intrin_sse41;
+			decoder->private_->local_lpc_restore_signal_16bit = FLAC__lpc_restore_signal_intrin_sse41;
+			decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide_intrin_sse41;
+		}
+# endif
+# if defined FLAC__AVX2_SUPPORTED
+		if (decoder->private_->cpuinfo.x86.avx2)
+			decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide_intrin_avx2;
+# endif
+#endif
 #endif
 	}
+#if defined FLAC__CPU_ARM64 && FLAC__HAS_NEONINTRIN && ! defined FLAC__INTEGER_ONLY_LIBRARY
+	/* NEON is part of every ARMv8-A core */
+	decoder->private_->local_lpc_restore_signal = FLAC__lpc_restore_signal_intrin_neon;
+	decoder->private_->local_lpc_restore_signal_16bit = FLAC__lpc_restore_signal_intrin_neon;
+	decoder->private_->local_lpc_restore_signal_64bit = FLAC__lpc_restore_signal_wide_intrin_neon;
+	decoder->private_->local_fixed_restore_signal = FLAC__fixed_restore_signal_intrin_neon;
+#endif
 #endif
 
 	/* from here on, errors are fatal */
@@ -2620,7 +2653,7 @@ FLAC__bool read_subframe_fixed_(FLAC__StreamDecoder *decoder, uint32_t channel,
 	/* decode the subframe */
 	if(do_full_decode) {
 		memcpy(decoder->private_->output[channel], subframe->warmup, sizeof(FLAC__int32) * order);
-		FLAC__fixed_restore_signal(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, order, decoder->private_->output[channel]+order);
+		decoder->private_->local_fixed_restore_signal(decoder->private_->residual[channel], decoder->private_->frame.header.blocksize-order, order, decoder->private_->output[channel]+order);
 	}
 
 	return true;
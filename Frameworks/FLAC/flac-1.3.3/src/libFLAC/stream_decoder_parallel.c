@@ -0,0 +1,834 @@
+/* libFLAC - Free Lossless Audio Codec library
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the Xiph.org Foundation nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <stdlib.h> /* for malloc() */
+#include <string.h> /* for memset/memcpy() */
+#include <pthread.h>
+#include <unistd.h> /* for sysconf() */
+#include "share/compat.h"
+#include "FLAC/FLAC_assert.h"
+#include "FLAC/stream_decoder_parallel.h"
+#include "share/alloc.h"
+#include "private/crc.h"
+#include "private/memory.h"
+
+
+/***********************************************************************
+ *
+ * Private types and constants
+ *
+ ***********************************************************************/
+
+/* Frames queued per worker, so that a worker never waits for the reader */
+#define JOBS_PER_THREAD 4
+#define MAX_THREADS 64
+/* Bytes read from the client at a time */
+#define READ_SIZE 65536
+/* Errors remembered per frame, the rest are dropped */
+#define MAX_JOB_ERRORS 4
+/* How many frames may be lost between two frames before the scanner stops
+ * trusting the frame numbers to find where a frame ends */
+#define RESYNC_FRAMES 16
+
+typedef enum {
+	JOB_EMPTY,
+	JOB_QUEUED,
+	JOB_RUNNING,
+	JOB_DONE
+} JobState;
+
+typedef struct {
+	JobState state;
+	FLAC__byte *data;
+	size_t data_len, data_capacity;
+	/* output, filled in by the worker */
+	FLAC__bool got_frame;
+	FLAC__Frame frame;
+	FLAC__int32 *output[FLAC__MAX_CHANNELS];
+	uint32_t output_capacity;
+	const FLAC__StreamDecoder *worker_decoder;
+	FLAC__StreamDecoderErrorStatus errors[MAX_JOB_ERRORS];
+	uint32_t error_count;
+} Job;
+
+typedef struct {
+	FLAC__StreamDecoderParallel *owner;
+	FLAC__StreamDecoder *decoder;
+	pthread_t thread;
+	FLAC__bool thread_started;
+	/* what the read callback serves: the STREAMINFO preamble, then jobs */
+	const FLAC__byte *input;
+	size_t input_len, input_pos;
+	Job *job;
+} Worker;
+
+struct FLAC__StreamDecoderParallel {
+	FLAC__StreamDecoderState state;
+	FLAC__bool initialized;
+	FLAC__StreamMetadata_StreamInfo stream_info;
+	FLAC__StreamDecoderReadCallback read_callback;
+	FLAC__StreamDecoderWriteCallback write_callback;
+	FLAC__StreamDecoderErrorCallback error_callback;
+	void *client_data;
+
+	/* "fLaC" and the STREAMINFO block, fed to every worker first */
+	FLAC__byte preamble[4 + FLAC__STREAM_METADATA_HEADER_LENGTH + FLAC__STREAM_METADATA_STREAMINFO_LENGTH];
+
+	/* input read ahead; input_pos is the start of the next frame */
+	FLAC__byte *input;
+	size_t input_len, input_pos, input_capacity;
+	FLAC__bool input_eof;
+	FLAC__bool have_expected;
+	FLAC__bool expected_variable;
+	FLAC__uint64 expected_number;
+
+	/* jobs form a ring; head is delivered next, tail filled next and
+	 * dispatch handed to a worker next, all counting up */
+	Job *jobs;
+	uint32_t job_count;
+	uint32_t head, tail, dispatch;
+
+	Worker *workers;
+	uint32_t thread_count;
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cond, done_cond;
+	FLAC__bool quit;
+};
+
+typedef struct {
+	FLAC__bool variable;
+	FLAC__uint64 number;
+	uint32_t blocksize;
+} FrameHeader;
+
+
+/***********************************************************************
+ *
+ * Frame header scanning
+ *
+ ***********************************************************************/
+
+/*
+ * Parses a frame header at p, the same way read_frame_header_() does, and
+ * checks that it fits the stream: same channel count, sample rate and
+ * sample size as STREAMINFO, and a block size within its limits.
+ * Returns 1 if it does, 0 if it doesn't and -1 if more input is needed.
+ */
+static int parse_frame_header_(const FLAC__StreamMetadata_StreamInfo *info, const FLAC__byte *p, size_t len, FrameHeader *header)
+{
+	uint32_t i, x, blocksize = 0, sample_rate = 0, channels, bps = 0, code, raw_len;
+	uint32_t blocksize_hint, sample_rate_hint;
+	FLAC__uint64 number;
+
+	if(len < 4)
+		return -1;
+	if(p[0] != 0xff || (p[1] & 0xfe) != 0xf8)
+		return 0;
+
+	switch(code = p[2] >> 4) {
+		case 0:
+			return 0;
+		case 1:
+			blocksize = 192;
+			break;
+		case 2:
+		case 3:
+		case 4:
+		case 5:
+			blocksize = 576 << (code-2);
+			break;
+		case 6:
+		case 7:
+			break;
+		default:
+			blocksize = 256 << (code-8);
+			break;
+	}
+	blocksize_hint = (code == 6 || code == 7)? code : 0;
+
+	switch(code = p[2] & 0x0f) {
+		case 0:
+			sample_rate = info->sample_rate;
+			break;
+		case 1: sample_rate = 88200; break;
+		case 2: sample_rate = 176400; break;
+		case 3: sample_rate = 192000; break;
+		case 4: sample_rate = 8000; break;
+		case 5: sample_rate = 16000; break;
+		case 6: sample_rate = 22050; break;
+		case 7: sample_rate = 24000; break;
+		case 8: sample_rate = 32000; break;
+		case 9: sample_rate = 44100; break;
+		case 10: sample_rate = 48000; break;
+		case 11: sample_rate = 96000; break;
+		case 15:
+			return 0;
+		default:
+			break;
+	}
+	sample_rate_hint = (code >= 12 && code <= 14)? code : 0;
+
+	x = p[3] >> 4;
+	if(x & 8) {
+		if((x & 7) > 2)
+			return 0;
+		channels = 2;
+	}
+	else
+		channels = x + 1;
+	if(channels != info->channels)
+		return 0;
+
+	switch((p[3] & 0x0e) >> 1) {
+		case 0: bps = info->bits_per_sample; break;
+		case 1: bps = 8; break;
+		case 2: bps = 12; break;
+		case 4: bps = 16; break;
+		case 5: bps = 20; break;
+		case 6: bps = 24; break;
+		default:
+			return 0;
+	}
+	if(bps != info->bits_per_sample || (p[3] & 0x01))
+		return 0;
+
+	/* UTF-8 coded frame or sample number */
+	raw_len = 4;
+	if(len <= raw_len)
+		return -1;
+	x = p[raw_len++];
+	if(!(x & 0x80)) {
+		number = x;
+		i = 0;
+	}
+	else if((x & 0xe0) == 0xc0) { number = x & 0x1f; i = 1; }
+	else if((x & 0xf0) == 0xe0) { number = x & 0x0f; i = 2; }
+	else if((x & 0xf8) == 0xf0) { number = x & 0x07; i = 3; }
+	else if((x & 0xfc) == 0xf8) { number = x & 0x03; i = 4; }
+	else if((x & 0xfe) == 0xfc) { number = x & 0x01; i = 5; }
+	else if(x == 0xfe) { number = 0; i = 6; }
+	else
+		return 0;
+	for( ; i; i--) {
+		if(len <= raw_len)
+			return -1;
+		x = p[raw_len++];
+		if((x & 0xc0) != 0x80)
+			return 0;
+		number = (number << 6) | (x & 0x3f);
+	}
+
+	if(blocksize_hint) {
+		if(len < raw_len + (blocksize_hint == 7? 2 : 1))
+			return -1;
+		x = p[raw_len++];
+		if(blocksize_hint == 7)
+			x = (x << 8) | p[raw_len++];
+		blocksize = x + 1;
+	}
+	if(sample_rate_hint) {
+		if(len < raw_len + (sample_rate_hint == 12? 1 : 2))
+			return -1;
+		x = p[raw_len++];
+		if(sample_rate_hint != 12)
+			x = (x << 8) | p[raw_len++];
+		if(sample_rate_hint == 12)
+			sample_rate = x*1000;
+		else if(sample_rate_hint == 13)
+			sample_rate = x;
+		else
+			sample_rate = x*10;
+	}
+	if(sample_rate != info->sample_rate)
+		return 0;
+	if(blocksize > info->max_blocksize && info->max_blocksize)
+		return 0;
+
+	if(len <= raw_len)
+		return -1;
+	if(FLAC__crc8(p, raw_len) != p[raw_len])
+		return 0;
+
+	/* same concession to old variable blocksize streams as the decoder */
+	header->variable = (p[1] & 0x01) || info->min_blocksize != info->max_blocksize;
+	if(!header->variable && number > 0x7fffffff)
+		return 0;
+	header->number = number;
+	header->blocksize = blocksize;
+	return 1;
+}
+
+static FLAC__bool follows_(const FLAC__StreamDecoderParallel *decoder, const FrameHeader *header)
+{
+	if(!decoder->have_expected)
+		return true;
+	if(header->variable != decoder->expected_variable)
+		return false;
+	return header->number == decoder->expected_number;
+}
+
+/*
+ * Whether next can be the header of a frame following the one starting
+ * with header.  Up to RESYNC_FRAMES frames in between may have been lost
+ * to corrupted headers.
+ */
+static FLAC__bool is_successor_(const FLAC__StreamDecoderParallel *decoder, const FrameHeader *header, const FrameHeader *next)
+{
+	FLAC__uint64 step = header->variable? (decoder->stream_info.max_blocksize? decoder->stream_info.max_blocksize : header->blocksize) : 1;
+
+	if(next->variable != header->variable || next->number <= header->number)
+		return false;
+	if(header->variable && next->number == header->number + header->blocksize)
+		return true;
+	return next->number <= header->number + step * RESYNC_FRAMES;
+}
+
+/* Upper bound of the size of a frame, from STREAMINFO if it has one */
+static size_t max_frame_size_(const FLAC__StreamMetadata_StreamInfo *info)
+{
+	uint32_t blocksize = info->max_blocksize? info->max_blocksize : FLAC__MAX_BLOCK_SIZE;
+
+	if(info->max_framesize)
+		return info->max_framesize;
+	/* verbatim subframes, side channel bits, headers and padding */
+	return (size_t)blocksize * info->channels * (info->bits_per_sample + 1) / 8 + 64;
+}
+
+static void expect_after_(FLAC__StreamDecoderParallel *decoder, const FrameHeader *header)
+{
+	decoder->have_expected = true;
+	decoder->expected_variable = header->variable;
+	decoder->expected_number = header->number + (header->variable? header->blocksize : 1);
+}
+
+/* Reads more input, returns false at the end of the stream or on error */
+static FLAC__bool read_more_(FLAC__StreamDecoderParallel *decoder)
+{
+	size_t bytes;
+	FLAC__StreamDecoderReadStatus status;
+
+	if(decoder->input_eof)
+		return false;
+
+	if(decoder->input_pos > 0 && decoder->input_pos >= decoder->input_len / 2) {
+		memmove(decoder->input, decoder->input + decoder->input_pos, decoder->input_len - decoder->input_pos);
+		decoder->input_len -= decoder->input_pos;
+		decoder->input_pos = 0;
+	}
+	if(decoder->input_capacity - decoder->input_len < READ_SIZE) {
+		size_t capacity = decoder->input_capacity * 2 + READ_SIZE;
+		decoder->input = safe_realloc_(decoder->input, capacity);
+		if(0 == decoder->input) {
+			decoder->input_len = decoder->input_pos = decoder->input_capacity = 0;
+			decoder->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+			return false;
+		}
+		decoder->input_capacity = capacity;
+	}
+
+	bytes = READ_SIZE;
+	status = decoder->read_callback(0, decoder->input + decoder->input_len, &bytes, decoder->client_data);
+	if(status == FLAC__STREAM_DECODER_READ_STATUS_ABORT) {
+		decoder->state = FLAC__STREAM_DECODER_ABORTED;
+		return false;
+	}
+	decoder->input_len += bytes;
+	if(status == FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM || bytes == 0)
+		decoder->input_eof = true;
+	return bytes > 0 || !decoder->input_eof;
+}
+
+/*
+ * Finds the frame starting at input_pos and its length.  Skips anything
+ * that isn't a frame header first.  The frame ends at the next header
+ * that continues its numbering, at any header once it is longer than a
+ * frame can be, or at the end of the stream.  Garbage left at the end of
+ * a frame is ignored by the worker decoding it.
+ * Returns false if there are no more frames.
+ */
+static FLAC__bool next_frame_(FLAC__StreamDecoderParallel *decoder, size_t *frame_len, FLAC__bool *lost_sync)
+{
+	FrameHeader header, next;
+	size_t pos, max_frame_size = max_frame_size_(&decoder->stream_info);
+	int ret;
+
+	*lost_sync = false;
+
+	/* sync to the first frame header */
+	for(;;) {
+		if(decoder->input_len - decoder->input_pos < 2 && !read_more_(decoder) && decoder->input_len - decoder->input_pos < 2)
+			return false;
+		ret = parse_frame_header_(&decoder->stream_info, decoder->input + decoder->input_pos, decoder->input_len - decoder->input_pos, &header);
+		if(ret < 0) {
+			if(!read_more_(decoder))
+				return false;
+			continue;
+		}
+		if(ret > 0) {
+			/* a header that skips ahead means frames were lost; carry on
+			 * numbering from there */
+			if(!follows_(decoder, &header))
+				decoder->have_expected = false;
+			break;
+		}
+		decoder->input_pos++;
+		*lost_sync = true;
+	}
+
+	/* look for the next frame's header; reading more input can move the
+	 * frame, so keep the position relative to its start */
+	pos = 2;
+	for(;;) {
+		const FLAC__byte *frame = decoder->input + decoder->input_pos;
+		size_t avail = decoder->input_len - decoder->input_pos;
+		const FLAC__byte *sync = avail > pos? memchr(frame + pos, 0xff, avail - pos) : 0;
+
+		if(0 == sync) {
+			pos = avail;
+			if(!read_more_(decoder)) {
+				if(decoder->state != FLAC__STREAM_DECODER_READ_FRAME)
+					return false;
+				/* last frame */
+				*frame_len = decoder->input_len - decoder->input_pos;
+				expect_after_(decoder, &header);
+				return true;
+			}
+			continue;
+		}
+		pos = sync - frame;
+		ret = parse_frame_header_(&decoder->stream_info, sync, avail - pos, &next);
+		if(ret < 0) {
+			if(read_more_(decoder))
+				continue;
+			if(decoder->state != FLAC__STREAM_DECODER_READ_FRAME)
+				return false;
+			ret = 0;
+		}
+		if(ret > 0 && (is_successor_(decoder, &header, &next) || pos > max_frame_size)) {
+			*frame_len = pos;
+			expect_after_(decoder, &header);
+			return true;
+		}
+		pos++;
+	}
+}
+
+
+/***********************************************************************
+ *
+ * Workers
+ *
+ ***********************************************************************/
+
+static FLAC__StreamDecoderReadStatus worker_read_callback_(const FLAC__StreamDecoder *decoder, FLAC__byte buffer[], size_t *bytes, void *client_data)
+{
+	Worker *worker = (Worker *)client_data;
+	size_t left = worker->input_len - worker->input_pos;
+	(void)decoder;
+
+	if(left == 0) {
+		*bytes = 0;
+		return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+	}
+	if(*bytes > left)
+		*bytes = left;
+	memcpy(buffer, worker->input + worker->input_pos, *bytes);
+	worker->input_pos += *bytes;
+	return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+static FLAC__StreamDecoderWriteStatus worker_write_callback_(const FLAC__StreamDecoder *decoder, const FLAC__Frame *frame, const FLAC__int32 * const buffer[], void *client_data)
+{
+	Worker *worker = (Worker *)client_data;
+	Job *job = worker->job;
+	uint32_t channel, blocksize = frame->header.blocksize;
+
+	if(0 == job)
+		return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+
+	if(job->output_capacity < blocksize) {
+		for(channel = 0; channel < FLAC__MAX_CHANNELS; channel++) {
+			free(job->output[channel]);
+			job->output[channel] = 0;
+		}
+		job->output_capacity = 0;
+		for(channel = 0; channel < frame->header.channels; channel++) {
+			if(0 == (job->output[channel] = safe_malloc_mul_2op_p(blocksize, /*times*/sizeof(FLAC__int32))))
+				return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+		}
+		job->output_capacity = blocksize;
+	}
+	for(channel = 0; channel < frame->header.channels; channel++)
+		memcpy(job->output[channel], buffer[channel], sizeof(FLAC__int32) * blocksize);
+
+	memset(&job->frame, 0, sizeof(job->frame));
+	job->frame.header = frame->header;
+	job->frame.footer = frame->footer;
+	job->worker_decoder = decoder;
+	job->got_frame = true;
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void worker_error_callback_(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorStatus status, void *client_data)
+{
+	Worker *worker = (Worker *)client_data;
+	Job *job = worker->job;
+	(void)decoder;
+
+	if(0 != job && job->error_count < MAX_JOB_ERRORS)
+		job->errors[job->error_count++] = status;
+}
+
+static void *worker_thread_(void *arg)
+{
+	Worker *worker = (Worker *)arg;
+	FLAC__StreamDecoderParallel *decoder = worker->owner;
+
+	pthread_mutex_lock(&decoder->mutex);
+	for(;;) {
+		Job *job;
+
+		while(!decoder->quit && (decoder->dispatch == decoder->tail || decoder->jobs[decoder->dispatch % decoder->job_count].state != JOB_QUEUED))
+			pthread_cond_wait(&decoder->work_cond, &decoder->mutex);
+		if(decoder->quit)
+			break;
+		job = &decoder->jobs[decoder->dispatch++ % decoder->job_count];
+		job->state = JOB_RUNNING;
+		pthread_mutex_unlock(&decoder->mutex);
+
+		job->got_frame = false;
+		job->worker_decoder = worker->decoder;
+		worker->job = job;
+		worker->input = job->data;
+		worker->input_len = job->data_len;
+		worker->input_pos = 0;
+		if(FLAC__stream_decoder_flush(worker->decoder))
+			FLAC__stream_decoder_process_single(worker->decoder);
+		worker->job = 0;
+
+		pthread_mutex_lock(&decoder->mutex);
+		job->state = JOB_DONE;
+		pthread_cond_broadcast(&decoder->done_cond);
+	}
+	pthread_mutex_unlock(&decoder->mutex);
+	return 0;
+}
+
+static void pack_stream_info_(FLAC__byte *p, const FLAC__StreamMetadata_StreamInfo *info)
+{
+	uint32_t i;
+
+	memcpy(p, "fLaC", 4);
+	p += 4;
+	/* last metadata block, type STREAMINFO */
+	p[0] = 0x80 | FLAC__METADATA_TYPE_STREAMINFO;
+	p[1] = 0;
+	p[2] = 0;
+	p[3] = FLAC__STREAM_METADATA_STREAMINFO_LENGTH;
+	p += FLAC__STREAM_METADATA_HEADER_LENGTH;
+
+	p[0] = (FLAC__byte)(info->min_blocksize >> 8);
+	p[1] = (FLAC__byte)info->min_blocksize;
+	p[2] = (FLAC__byte)(info->max_blocksize >> 8);
+	p[3] = (FLAC__byte)info->max_blocksize;
+	p[4] = (FLAC__byte)(info->min_framesize >> 16);
+	p[5] = (FLAC__byte)(info->min_framesize >> 8);
+	p[6] = (FLAC__byte)info->min_framesize;
+	p[7] = (FLAC__byte)(info->max_framesize >> 16);
+	p[8] = (FLAC__byte)(info->max_framesize >> 8);
+	p[9] = (FLAC__byte)info->max_framesize;
+	/* 20 bits sample rate, 3 bits channels-1, 5 bits bps-1, 36 bits total samples */
+	p[10] = (FLAC__byte)(info->sample_rate >> 12);
+	p[11] = (FLAC__byte)(info->sample_rate >> 4);
+	p[12] = (FLAC__byte)(((info->sample_rate & 0x0f) << 4) | ((info->channels - 1) << 1) | ((info->bits_per_sample - 1) >> 4));
+	p[13] = (FLAC__byte)((((info->bits_per_sample - 1) & 0x0f) << 4) | (uint32_t)((info->total_samples >> 32) & 0x0f));
+	for(i = 0; i < 4; i++)
+		p[14 + i] = (FLAC__byte)(info->total_samples >> (24 - 8 * i));
+	memcpy(p + 18, info->md5sum, 16);
+}
+
+
+/***********************************************************************
+ *
+ * Public class methods
+ *
+ ***********************************************************************/
+
+FLAC_API FLAC__StreamDecoderParallel *FLAC__stream_decoder_parallel_new(uint32_t threads)
+{
+	FLAC__StreamDecoderParallel *decoder;
+	uint32_t i;
+
+	if(threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 0? (uint32_t)online : 1;
+	}
+	if(threads > MAX_THREADS)
+		threads = MAX_THREADS;
+
+	decoder = calloc(1, sizeof(FLAC__StreamDecoderParallel));
+	if(0 == decoder)
+		return 0;
+	decoder->state = FLAC__STREAM_DECODER_UNINITIALIZED;
+	decoder->thread_count = threads;
+	decoder->job_count = threads * JOBS_PER_THREAD;
+	decoder->jobs = safe_calloc_(decoder->job_count, sizeof(Job));
+	decoder->workers = safe_calloc_(threads, sizeof(Worker));
+	if(0 == decoder->jobs || 0 == decoder->workers) {
+		free(decoder->jobs);
+		free(decoder->workers);
+		free(decoder);
+		return 0;
+	}
+	pthread_mutex_init(&decoder->mutex, 0);
+	pthread_cond_init(&decoder->work_cond, 0);
+	pthread_cond_init(&decoder->done_cond, 0);
+	for(i = 0; i < threads; i++) {
+		decoder->workers[i].owner = decoder;
+		if(0 == (decoder->workers[i].decoder = FLAC__stream_decoder_new())) {
+			FLAC__stream_decoder_parallel_delete(decoder);
+			return 0;
+		}
+	}
+	return decoder;
+}
+
+FLAC_API void FLAC__stream_decoder_parallel_delete(FLAC__StreamDecoderParallel *decoder)
+{
+	uint32_t i, channel;
+
+	if(0 == decoder)
+		return;
+
+	if(decoder->workers) {
+		pthread_mutex_lock(&decoder->mutex);
+		decoder->quit = true;
+		pthread_cond_broadcast(&decoder->work_cond);
+		pthread_mutex_unlock(&decoder->mutex);
+		for(i = 0; i < decoder->thread_count; i++) {
+			Worker *worker = &decoder->workers[i];
+			if(worker->thread_started)
+				pthread_join(worker->thread, 0);
+			if(worker->decoder)
+				FLAC__stream_decoder_delete(worker->decoder);
+		}
+		free(decoder->workers);
+	}
+	if(decoder->jobs) {
+		for(i = 0; i < decoder->job_count; i++) {
+			free(decoder->jobs[i].data);
+			for(channel = 0; channel < FLAC__MAX_CHANNELS; channel++)
+				free(decoder->jobs[i].output[channel]);
+		}
+		free(decoder->jobs);
+	}
+	free(decoder->input);
+	pthread_mutex_destroy(&decoder->mutex);
+	pthread_cond_destroy(&decoder->work_cond);
+	pthread_cond_destroy(&decoder->done_cond);
+	free(decoder);
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_parallel_init(
+	FLAC__StreamDecoderParallel *decoder,
+	const FLAC__StreamMetadata_StreamInfo *stream_info,
+	FLAC__StreamDecoderReadCallback read_callback,
+	FLAC__StreamDecoderWriteCallback write_callback,
+	FLAC__StreamDecoderErrorCallback error_callback,
+	void *client_data
+)
+{
+	uint32_t i;
+
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != stream_info);
+
+	if(decoder->initialized || 0 == read_callback || 0 == write_callback || 0 == error_callback)
+		return false;
+
+	decoder->stream_info = *stream_info;
+	decoder->read_callback = read_callback;
+	decoder->write_callback = write_callback;
+	decoder->error_callback = error_callback;
+	decoder->client_data = client_data;
+	pack_stream_info_(decoder->preamble, stream_info);
+
+	for(i = 0; i < decoder->thread_count; i++) {
+		Worker *worker = &decoder->workers[i];
+		if(FLAC__stream_decoder_init_stream(worker->decoder, worker_read_callback_, 0, 0, 0, 0, worker_write_callback_, 0, worker_error_callback_, worker) != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+			return false;
+		worker->input = decoder->preamble;
+		worker->input_len = sizeof(decoder->preamble);
+		worker->input_pos = 0;
+		if(!FLAC__stream_decoder_process_until_end_of_metadata(worker->decoder))
+			return false;
+		if(0 != pthread_create(&worker->thread, 0, worker_thread_, worker))
+			return false;
+		worker->thread_started = true;
+	}
+
+	decoder->state = FLAC__STREAM_DECODER_READ_FRAME;
+	decoder->initialized = true;
+	return true;
+}
+
+FLAC_API FLAC__StreamDecoderState FLAC__stream_decoder_parallel_get_state(const FLAC__StreamDecoderParallel *decoder)
+{
+	FLAC__ASSERT(0 != decoder);
+	return decoder->state;
+}
+
+/* Reads frames ahead into free jobs */
+static void fill_jobs_(FLAC__StreamDecoderParallel *decoder)
+{
+	size_t frame_len;
+	FLAC__bool lost_sync, queued = false;
+
+	while(decoder->tail - decoder->head < decoder->job_count && decoder->state == FLAC__STREAM_DECODER_READ_FRAME) {
+		Job *job = &decoder->jobs[decoder->tail % decoder->job_count];
+
+		if(!next_frame_(decoder, &frame_len, &lost_sync)) {
+			if(decoder->state == FLAC__STREAM_DECODER_READ_FRAME)
+				decoder->state = FLAC__STREAM_DECODER_END_OF_STREAM;
+			break;
+		}
+		/* the job is empty, so no worker looks at it until it is queued */
+		if(job->data_capacity < frame_len) {
+			job->data = safe_realloc_(job->data, frame_len);
+			if(0 == job->data) {
+				job->data_capacity = 0;
+				decoder->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+				break;
+			}
+			job->data_capacity = frame_len;
+		}
+		memcpy(job->data, decoder->input + decoder->input_pos, frame_len);
+		job->data_len = frame_len;
+		job->error_count = 0;
+		if(lost_sync)
+			job->errors[job->error_count++] = FLAC__STREAM_DECODER_ERROR_STATUS_LOST_SYNC;
+		decoder->input_pos += frame_len;
+
+		pthread_mutex_lock(&decoder->mutex);
+		job->state = JOB_QUEUED;
+		decoder->tail++;
+		pthread_mutex_unlock(&decoder->mutex);
+		queued = true;
+	}
+	if(queued) {
+		pthread_mutex_lock(&decoder->mutex);
+		pthread_cond_broadcast(&decoder->work_cond);
+		pthread_mutex_unlock(&decoder->mutex);
+	}
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_parallel_process_single(FLAC__StreamDecoderParallel *decoder)
+{
+	Job *job;
+	uint32_t i;
+	FLAC__StreamDecoderWriteStatus status = FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+
+	FLAC__ASSERT(0 != decoder);
+
+	if(!decoder->initialized)
+		return false;
+
+	for(;;) {
+		fill_jobs_(decoder);
+		if(decoder->head == decoder->tail)
+			return false;
+
+		job = &decoder->jobs[decoder->head % decoder->job_count];
+		pthread_mutex_lock(&decoder->mutex);
+		while(job->state != JOB_DONE)
+			pthread_cond_wait(&decoder->done_cond, &decoder->mutex);
+		pthread_mutex_unlock(&decoder->mutex);
+
+		for(i = 0; i < job->error_count; i++)
+			decoder->error_callback(job->worker_decoder, job->errors[i], decoder->client_data);
+		if(job->got_frame)
+			status = decoder->write_callback(job->worker_decoder, &job->frame, (const FLAC__int32 * const *)job->output, decoder->client_data);
+
+		pthread_mutex_lock(&decoder->mutex);
+		job->state = JOB_EMPTY;
+		decoder->head++;
+		pthread_mutex_unlock(&decoder->mutex);
+
+		if(status == FLAC__STREAM_DECODER_WRITE_STATUS_ABORT) {
+			decoder->state = FLAC__STREAM_DECODER_ABORTED;
+			return false;
+		}
+		/* a frame that didn't decode at all is skipped, like the stream
+		 * decoder does after losing sync */
+		if(job->got_frame) {
+			fill_jobs_(decoder);
+			return true;
+		}
+	}
+}
+
+FLAC_API FLAC__bool FLAC__stream_decoder_parallel_flush(FLAC__StreamDecoderParallel *decoder)
+{
+	uint32_t i;
+
+	FLAC__ASSERT(0 != decoder);
+
+	if(!decoder->initialized)
+		return false;
+
+	pthread_mutex_lock(&decoder->mutex);
+	/* take back what no worker has started on, wait for the rest */
+	for(i = 0; i < decoder->job_count; i++) {
+		if(decoder->jobs[i].state == JOB_QUEUED)
+			decoder->jobs[i].state = JOB_EMPTY;
+	}
+	decoder->dispatch = decoder->tail;
+	for(i = 0; i < decoder->job_count; ) {
+		if(decoder->jobs[i].state == JOB_RUNNING)
+			pthread_cond_wait(&decoder->done_cond, &decoder->mutex);
+		else
+			i++;
+	}
+	for(i = 0; i < decoder->job_count; i++)
+		decoder->jobs[i].state = JOB_EMPTY;
+	decoder->head = decoder->tail = decoder->dispatch = 0;
+	pthread_mutex_unlock(&decoder->mutex);
+
+	decoder->input_len = decoder->input_pos = 0;
+	decoder->input_eof = false;
+	decoder->have_expected = false;
+	if(decoder->state != FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR)
+		decoder->state = FLAC__STREAM_DECODER_READ_FRAME;
+	return true;
+}
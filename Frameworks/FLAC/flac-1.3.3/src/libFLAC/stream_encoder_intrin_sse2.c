@@ -44,7 +44,7 @@
 
 #include <stdlib.h>    /* for abs() */
 #include <emmintrin.h> /* SSE2 */
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 #include "share/compat.h"
 
 FLAC__SSE_TARGET("sse2")
@@ -44,7 +44,7 @@
 
 #include <stdlib.h>    /* for abs() */
 #include <tmmintrin.h> /* SSSE3 */
-#include "FLAC/assert.h"
+#include "FLAC/FLAC_assert.h"
 
 FLAC__SSE_TARGET("ssse3")
 void FLAC__precompute_partition_info_sums_intrin_ssse3(const FLAC__int32 residual[], FLAC__uint64 abs_residual_partition_sums[],
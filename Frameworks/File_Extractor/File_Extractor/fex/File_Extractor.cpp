@@ -2,6 +2,9 @@
 
 #include "File_Extractor.h"
 
+#include <sys/stat.h>
+#include <pthread.h>
+
 /* Copyright (C) 2005-2009 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -19,6 +22,7 @@ File_Extractor::fex_t( fex_type_t t ) :
 	type_( t )
 {
 	own_file_ = NULL;
+	index_    = NULL;
 	
 	close_();
 }
@@ -41,6 +45,14 @@ blargg_err_t File_Extractor::open( const char path [] )
 	
 	RETURN_ERR( set_path( path ) );
 	
+	struct stat st;
+	if ( ::stat( path, &st ) == 0 )
+	{
+		arc_stamped_ = true;
+		arc_size_    = st.st_size;
+		arc_mtime_   = st.st_mtime;
+	}
+	
 	blargg_err_t err = open_path_v();
 	if ( err )
 		close();
@@ -111,6 +123,13 @@ blargg_err_t File_Extractor::open( File_Reader* input, const char* path )
 	return err;
 }
 
+bool File_Extractor::arc_stamp( BOOST::uint64_t* size, BOOST::uint64_t* mtime ) const
+{
+	*size  = arc_size_;
+	*mtime = arc_mtime_;
+	return arc_stamped_;
+}
+
 // Close
 
 void File_Extractor::close()
@@ -119,15 +138,24 @@ void File_Extractor::close()
 	close_();
 }
 
+static void release_index( fex_index_t* );
+
 void File_Extractor::close_()
 {
 	delete own_file_;
 	own_file_ = NULL;
 	
+	release_index( index_ );
+	index_ = NULL;
+	
 	tell_   = 0;
 	reader_ = NULL;
 	opened_ = false;
 	
+	arc_stamped_ = false;
+	arc_size_    = 0;
+	arc_mtime_   = 0;
+	
 	path_.clear();
 	clear_file();
 }
@@ -268,6 +296,211 @@ blargg_err_t File_Extractor::seek_arc_v( fex_pos_t pos )
 	return blargg_ok;
 }
 
+// Name index
+
+// Names of files in archive, sorted, and where each is. Indexes of archives
+// opened by path are shared by all extractors opened on the same file, so
+// that opening one file after another from it only scans the archive once.
+
+struct fex_index_entry_t
+{
+	const char* name;
+	fex_pos_t   pos;
+};
+
+struct fex_index_t
+{
+	fex_index_t*    next;   // in shared list, most recently used first
+	int             refs;   // shared list holds one while index is in it
+	blargg_vector<char> path;
+	BOOST::uint64_t arc_size;
+	BOOST::uint64_t arc_mtime;
+	blargg_vector<char> names;
+	blargg_vector<fex_index_entry_t> entries;
+	size_t          count;
+};
+
+int const max_shared_indexes = 16;
+
+static pthread_mutex_t shared_indexes_mutex = PTHREAD_MUTEX_INITIALIZER;
+static fex_index_t* shared_indexes;
+
+// Mutex must be held
+static void unref_index_( fex_index_t* index )
+{
+	if ( !--index->refs )
+		delete index;
+}
+
+static void release_index( fex_index_t* index )
+{
+	if ( index )
+	{
+		pthread_mutex_lock( &shared_indexes_mutex );
+		unref_index_( index );
+		pthread_mutex_unlock( &shared_indexes_mutex );
+	}
+}
+
+// Finds index of archive file and adds reference to it, or returns NULL
+static fex_index_t* find_index( const char* path, BOOST::uint64_t size, BOOST::uint64_t mtime )
+{
+	pthread_mutex_lock( &shared_indexes_mutex );
+	
+	fex_index_t* found = NULL;
+	for ( fex_index_t** link = &shared_indexes; *link; link = &(*link)->next )
+	{
+		fex_index_t* index = *link;
+		if ( index->arc_size == size && index->arc_mtime == mtime &&
+				!strcmp( index->path.begin(), path ) )
+		{
+			*link = index->next;
+			index->next = shared_indexes;
+			shared_indexes = index;
+			index->refs++;
+			found = index;
+			break;
+		}
+	}
+	
+	pthread_mutex_unlock( &shared_indexes_mutex );
+	return found;
+}
+
+// Adds index to shared list, replacing any older one of the same file and
+// dropping the least recently used past the limit
+static void share_index( fex_index_t* index )
+{
+	pthread_mutex_lock( &shared_indexes_mutex );
+	
+	index->refs++;
+	index->next = shared_indexes;
+	shared_indexes = index;
+	
+	int count = 1;
+	fex_index_t** link = &index->next;
+	while ( *link )
+	{
+		fex_index_t* old = *link;
+		if ( count >= max_shared_indexes || !strcmp( old->path.begin(), index->path.begin() ) )
+		{
+			*link = old->next;
+			unref_index_( old );
+		}
+		else
+		{
+			count++;
+			link = &old->next;
+		}
+	}
+	
+	pthread_mutex_unlock( &shared_indexes_mutex );
+}
+
+// Sorts by name, then position, so the first of duplicate names is found,
+// as scanning would
+static int compare_entries( const void* a, const void* b )
+{
+	fex_index_entry_t const* x = STATIC_CAST(fex_index_entry_t const*,a);
+	fex_index_entry_t const* y = STATIC_CAST(fex_index_entry_t const*,b);
+	
+	int diff = strcmp( x->name, y->name );
+	if ( diff )
+		return diff;
+	
+	return (x->pos > y->pos) - (x->pos < y->pos);
+}
+
+blargg_err_t File_Extractor::load_index()
+{
+	if ( arc_stamped_ )
+	{
+		index_ = find_index( arc_path(), arc_size_, arc_mtime_ );
+		if ( index_ )
+			return blargg_ok;
+	}
+	
+	fex_index_t* index = BLARGG_NEW fex_index_t;
+	CHECK_ALLOC( index );
+	index->next  = NULL;
+	index->refs  = 1;
+	index->count = 0;
+	index_ = index;
+	
+	// Names are packed one after another, in the order they're scanned
+	size_t names_size = 0;
+	RETURN_ERR( rewind() );
+	while ( !done() )
+	{
+		size_t length = strlen( name() ) + 1;
+		if ( names_size + length > index->names.size() )
+			RETURN_ERR( index->names.resize( (names_size + length) * 2 ) );
+		if ( index->count >= index->entries.size() )
+			RETURN_ERR( index->entries.resize( index->count * 2 + 16 ) );
+		
+		memcpy( index->names.begin() + names_size, name(), length );
+		names_size += length;
+		index->entries [index->count++].pos = tell_arc();
+		
+		RETURN_ERR( next() );
+	}
+	
+	char const* name = index->names.begin();
+	for ( size_t i = 0; i < index->count; i++ )
+	{
+		index->entries [i].name = name;
+		name += strlen( name ) + 1;
+	}
+	
+	if ( index->count )
+		qsort( index->entries.begin(), index->count, sizeof (fex_index_entry_t), compare_entries );
+	
+	if ( arc_stamped_ )
+	{
+		RETURN_ERR( index->path.resize( strlen( arc_path() ) + 1 ) );
+		memcpy( index->path.begin(), arc_path(), index->path.size() );
+		index->arc_size  = arc_size_;
+		index->arc_mtime = arc_mtime_;
+		share_index( index );
+	}
+	
+	return blargg_ok;
+}
+
+blargg_err_t File_Extractor::seek_name( const char name [] )
+{
+	assert( opened() );
+	
+	if ( !index_ )
+	{
+		blargg_err_t err = load_index();
+		if ( err )
+		{
+			release_index( index_ );
+			index_ = NULL;
+			return err;
+		}
+	}
+	
+	// First entry not less than name
+	fex_index_entry_t const* entries = index_->entries.begin();
+	size_t lo = 0;
+	size_t hi = index_->count;
+	while ( lo < hi )
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		if ( strcmp( entries [mid].name, name ) < 0 )
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	
+	if ( lo >= index_->count || strcmp( entries [lo].name, name ) )
+		return blargg_err_file_missing;
+	
+	return seek_arc( entries [lo].pos );
+}
+
 // Extraction
 
 blargg_err_t File_Extractor::rewind_file()
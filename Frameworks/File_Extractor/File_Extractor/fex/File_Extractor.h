@@ -8,6 +8,8 @@
 #include "Data_Reader.h"
 #include "fex.h"
 
+struct fex_index_t;
+
 struct fex_t : private Data_Reader {
 public:
 	virtual ~fex_t();
@@ -34,6 +36,7 @@ public:
 	blargg_err_t rewind();
 	fex_pos_t tell_arc() const;
 	blargg_err_t seek_arc( fex_pos_t );
+	blargg_err_t seek_name( const char name [] );
 
 // Info
 
@@ -72,6 +75,11 @@ protected:
 	// Archive file
 	File_Reader& arc() const                        { return *reader_; }
 	
+	// Gets size and modification time of archive file, which together with
+	// arc_path() identify it for caches shared between extractors. False if
+	// archive wasn't opened from a path.
+	bool arc_stamp( BOOST::uint64_t* size, BOOST::uint64_t* mtime ) const;
+	
 	// Sets current file name
     void set_name( const char name [], const blargg_wchar_t* wname = NULL );
 	
@@ -133,6 +141,14 @@ private:
 	File_Reader* own_file_;
 	bool         opened_;
 	
+	// Archive file identity, set by open( path )
+	bool            arc_stamped_;
+	BOOST::uint64_t arc_size_;
+	BOOST::uint64_t arc_mtime_;
+	
+	// Names in archive, built by first seek_name()
+	fex_index_t* index_;
+	
 	// Position in archive
 	fex_pos_t tell_;    // only used by default implementation of tell/seek
 	bool      done_;
@@ -155,6 +171,7 @@ private:
 	blargg_err_t set_path( const char* path );
 	blargg_err_t rewind_file();
 	blargg_err_t next_();
+	blargg_err_t load_index();
 	
 	// Data_Reader overrides
 	// TODO: override skip_v?
@@ -9,6 +9,7 @@ extern "C" {
 }
 
 #include <time.h>
+#include <pthread.h>
 
 /* Copyright (C) 2005-2009 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
@@ -26,16 +27,137 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 static ISzAlloc zip7_alloc      = { SzAlloc,     SzFree     };
 static ISzAlloc zip7_alloc_temp = { SzAllocTemp, SzFreeTemp };
 
+// Solid block cache
+
+// Decompressed blocks are shared by all extractors, so that opening one file
+// after another from the same solid block only decompresses it once. Blocks
+// still in use are never freed; of the rest, the least recently used are
+// dropped once the cache is over its limit, as soon as they fall out of use.
+// A block bigger than the limit is dropped when its last extractor is done.
+
+struct Zip7_Block
+{
+	Zip7_Block*     next;   // in cache, most recently used first
+	int             refs;   // cache holds one while block is in it
+	blargg_vector<char> path;
+	BOOST::uint64_t arc_size;
+	BOOST::uint64_t arc_mtime;
+	UInt32          index;
+	Byte*           buf;
+	size_t          size;
+};
+
+size_t const zip7_cache_limit = 64 * 1024 * 1024;
+
+static pthread_mutex_t zip7_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Zip7_Block* zip7_cache;
+
+// Mutex must be held
+static void zip7_unref_block_( Zip7_Block* block )
+{
+	if ( !--block->refs )
+	{
+		IAlloc_Free( &zip7_alloc, block->buf );
+		delete block;
+	}
+}
+
+// Drops unused blocks which don't fit under the limit after the more recently
+// used ones. Mutex must be held.
+static void zip7_trim_cache_()
+{
+	size_t total = 0;
+	Zip7_Block** link = &zip7_cache;
+	while ( *link )
+	{
+		Zip7_Block* block = *link;
+		if ( block->refs == 1 && total + block->size > zip7_cache_limit )
+		{
+			*link = block->next;
+			zip7_unref_block_( block );
+		}
+		else
+		{
+			total += block->size;
+			link = &block->next;
+		}
+	}
+}
+
+static void zip7_release_block( Zip7_Block* block )
+{
+	if ( block )
+	{
+		pthread_mutex_lock( &zip7_cache_mutex );
+		zip7_unref_block_( block );
+		zip7_trim_cache_();
+		pthread_mutex_unlock( &zip7_cache_mutex );
+	}
+}
+
+// Finds block and adds reference to it, or returns NULL
+static Zip7_Block* zip7_find_block( const char* path, BOOST::uint64_t size,
+		BOOST::uint64_t mtime, UInt32 index )
+{
+	pthread_mutex_lock( &zip7_cache_mutex );
+	
+	Zip7_Block* found = NULL;
+	for ( Zip7_Block** link = &zip7_cache; *link; link = &(*link)->next )
+	{
+		Zip7_Block* block = *link;
+		if ( block->index == index && block->arc_size == size &&
+				block->arc_mtime == mtime && !strcmp( block->path.begin(), path ) )
+		{
+			*link = block->next;
+			block->next = zip7_cache;
+			zip7_cache = block;
+			block->refs++;
+			found = block;
+			break;
+		}
+	}
+	
+	pthread_mutex_unlock( &zip7_cache_mutex );
+	return found;
+}
+
+static void zip7_cache_block( Zip7_Block* block )
+{
+	pthread_mutex_lock( &zip7_cache_mutex );
+	
+	block->refs++;
+	block->next = zip7_cache;
+	zip7_cache = block;
+	
+	// Blocks of an older version of the same archive will never be found again
+	Zip7_Block** link = &block->next;
+	while ( *link )
+	{
+		Zip7_Block* old = *link;
+		if ( !strcmp( old->path.begin(), block->path.begin() ) &&
+				(old->arc_size != block->arc_size || old->arc_mtime != block->arc_mtime) )
+		{
+			*link = old->next;
+			zip7_unref_block_( old );
+		}
+		else
+		{
+			link = &old->next;
+		}
+	}
+	
+	zip7_trim_cache_();
+	pthread_mutex_unlock( &zip7_cache_mutex );
+}
+
 struct Zip7_Extractor_Impl :
 	ISeekInStream
 {
 	CLookToRead look;
 	CSzArEx db;
 	
-	// SzExtract state
-	UInt32  block_index;
-	Byte*   buf;
-	size_t  buf_size;
+	// Block of current file
+	Zip7_Block* block;
 
 	File_Reader* in;
 	const char* in_err;
@@ -172,9 +294,7 @@ blargg_err_t Zip7_Extractor::open_v()
 	}
 	
 	impl->in          = &arc();
-	impl->block_index = (UInt32) -1;
-	impl->buf         = NULL;
-	impl->buf_size    = 0;
+	impl->block       = NULL;
 
 	LookToRead_CreateVTable( &impl->look, false );
 	impl->ISeekInStream::Read = zip7_read_;
@@ -200,7 +320,7 @@ void Zip7_Extractor::close_v()
 			impl->in = NULL;
 			SzArEx_Free( &impl->db, &zip7_alloc );
 		}
-		IAlloc_Free( &zip7_alloc, impl->buf );
+		zip7_release_block( impl->block );
 		free( impl );
 		impl = NULL;
 	}
@@ -276,16 +396,82 @@ blargg_err_t Zip7_Extractor::seek_arc_v( fex_pos_t pos )
 	return next_v();
 }
 
+blargg_err_t Zip7_Extractor::decode_block( unsigned folder )
+{
+	zip7_release_block( impl->block );
+	impl->block = NULL;
+	
+	BOOST::uint64_t arc_size, arc_mtime;
+	bool shared = arc_stamp( &arc_size, &arc_mtime );
+	if ( shared )
+	{
+		impl->block = zip7_find_block( arc_path(), arc_size, arc_mtime, folder );
+		if ( impl->block )
+			return blargg_ok;
+	}
+	
+	Zip7_Block* block = BLARGG_NEW Zip7_Block;
+	CHECK_ALLOC( block );
+	block->next      = NULL;
+	block->refs      = 1;
+	block->arc_size  = arc_size;
+	block->arc_mtime = arc_mtime;
+	block->index     = (UInt32) -1;
+	block->buf       = NULL;
+	block->size      = 0;
+	impl->block = block;
+	
+	impl->in_err = NULL;
+	size_t offset = 0;
+	size_t count  = 0;
+	RETURN_ERR( zip7_err( SzArEx_Extract( &impl->db, &impl->look.s, index,
+			&block->index, &block->buf, &block->size,
+			&offset, &count, &zip7_alloc, &zip7_alloc_temp ) ) );
+	
+	if ( shared )
+	{
+		RETURN_ERR( block->path.resize( strlen( arc_path() ) + 1 ) );
+		memcpy( block->path.begin(), arc_path(), block->path.size() );
+		zip7_cache_block( block );
+	}
+	
+	return blargg_ok;
+}
+
 blargg_err_t Zip7_Extractor::data_v( void const** out )
 {
+	UInt32 folder = impl->db.FileIndexToFolderIndexMap [index];
+	if ( folder == (UInt32) -1 )
+	{
+		// Empty file
+		*out = NULL;
+		return blargg_ok;
+	}
+	
+	if ( !impl->block || impl->block->index != folder )
+	{
+		blargg_err_t err = decode_block( folder );
+		if ( err )
+		{
+			zip7_release_block( impl->block );
+			impl->block = NULL;
+			return err;
+		}
+	}
+	
+	// Block is already decompressed, so this just finds and checks the file
+	UInt32 block_index = impl->block->index;
+	Byte*  buf         = impl->block->buf;
+	size_t buf_size    = impl->block->size;
+	
 	impl->in_err = NULL;
 	size_t offset = 0;
 	size_t count  = 0;
 	RETURN_ERR( zip7_err( SzArEx_Extract( &impl->db, &impl->look.s, index,
-			&impl->block_index, &impl->buf, &impl->buf_size,
+			&block_index, &buf, &buf_size,
 			&offset, &count, &zip7_alloc, &zip7_alloc_temp ) ) );
 	assert( count == (size_t) size() );
 	
-	*out = impl->buf + offset;
+	*out = buf + offset;
 	return blargg_ok;
 }
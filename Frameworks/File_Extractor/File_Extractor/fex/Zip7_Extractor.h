@@ -31,6 +31,7 @@ private:
     blargg_vector<blargg_wchar_t> name16;
 	
 	blargg_err_t zip7_err( int err );
+	blargg_err_t decode_block( unsigned folder );
 };
 
 #endif
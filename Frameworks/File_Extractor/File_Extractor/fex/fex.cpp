@@ -321,6 +321,7 @@ BLARGG_EXPORT fex_err_t   fex_rewind          ( fex_t* fe )
 BLARGG_EXPORT uint64_t    fex_tell            ( const fex_t* fe )                   { return fe->tell(); }
 BLARGG_EXPORT fex_pos_t   fex_tell_arc        ( const fex_t* fe )                   { return fe->tell_arc(); }
 BLARGG_EXPORT fex_err_t   fex_seek_arc        ( fex_t* fe, fex_pos_t pos )          { return fe->seek_arc( pos ); }
+BLARGG_EXPORT fex_err_t   fex_seek_name       ( fex_t* fe, const char name [] )     { return fe->seek_name( name ); }
 BLARGG_EXPORT const char* fex_type_extension  ( fex_type_t t )                      { return t->extension; }
 BLARGG_EXPORT const char* fex_type_name       ( fex_type_t t )                      { return t->name; }
 BLARGG_EXPORT fex_err_t   fex_data            ( fex_t* fe, const void** data_out )  { return fe->data( data_out ); }
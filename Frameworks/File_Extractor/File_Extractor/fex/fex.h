@@ -121,6 +121,12 @@ fex_pos_t fex_tell_arc( const fex_t* );
 /** Returns to file at previously-saved position */
 fex_err_t fex_seek_arc( fex_t*, fex_pos_t );
 
+/** Goes to file with given name, or returns fex_err_file_missing if there is
+none. The first call scans the archive for an index of its names, which is kept
+and shared with any other fex_t opened on the same archive file, so that later
+calls don't need to scan. */
+fex_err_t fex_seek_name( fex_t*, const char name [] );
+
 
 /**** Info ****/
 
@@ -122,3 +122,41 @@ blargg_err_t Classic_Emu::play_( int count, sample_t out [] )
 	}
 	return blargg_ok;
 }
+
+blargg_err_t Classic_Emu::fast_forward_( int count )
+{
+	// Samples already in buffer have been emulated, so they are read and
+	// discarded. Clearing the buffer would also cut off the tails of their
+	// impulses, and the output would jump at the end of the skip.
+	sample_t scratch [1024];
+	while ( count > 0 && buf->samples_avail() )
+	{
+		int n = min( count, (int) (sizeof scratch / sizeof *scratch) );
+		buf->disable_immediate_removal();
+		n = buf->read_samples( scratch, n );
+		if ( !n )
+			break;
+		count -= n;
+	}
+	
+	// For the rest, only run CPU and sound chips. Voices are muted, so nothing
+	// is added to the Blip_Buffers and their frames don't need to be ended.
+	int pairs = count / 2;
+	
+	// Use the rounded factor of the Blip_Buffers, so timing matches play_()
+	double factor = buf->channel( 0 ).center->resampled_duration( 1 );
+	double clocks = (double) pairs * (1 << BLIP_BUFFER_ACCURACY) / factor;
+	
+	int msec = buf->length();
+	while ( clocks >= 1 && !emu_track_ended() )
+	{
+		blip_time_t clocks_emulated = msec * clock_rate_ / 1000 - 100;
+		if ( clocks_emulated > clocks )
+			clocks_emulated = (blip_time_t) clocks;
+		RETURN_ERR( run_clocks( clocks_emulated, msec ) );
+		assert( clocks_emulated );
+		clocks -= clocks_emulated;
+	}
+	
+	return blargg_ok;
+}
@@ -55,6 +55,7 @@ protected:
 	virtual void mute_voices_( int );
 	virtual void set_equalizer_( equalizer_t const& );
 	virtual blargg_err_t play_( int, sample_t [] );
+	virtual blargg_err_t fast_forward_( int );
 
 private:
 	Multi_Buffer* buf;
@@ -314,7 +314,7 @@ void Gym_Emu::run_pcm( byte const pcm_in [], int pcm_count )
 	pcm_buf->set_modified();
 }
 
-void Gym_Emu::parse_frame()
+void Gym_Emu::parse_frame( bool run_dac )
 {
 	byte pcm [1024]; // all PCM writes for frame
 	int pcm_size = 0;
@@ -393,14 +393,19 @@ void Gym_Emu::parse_frame()
 	
 	// PCM
 	if ( pcm_buf && pcm_size )
-		run_pcm( pcm, pcm_size );
+	{
+		if ( run_dac )
+			run_pcm( pcm, pcm_size );
+		else
+			pcm_amp = pcm [pcm_size - 1];
+	}
 	prev_pcm_count = pcm_size;
 }
 
 inline int Gym_Emu::play_frame( blip_time_t blip_time, int sample_count, sample_t buf [] )
 {
 	if ( !track_ended() )
-		parse_frame();
+		parse_frame( true );
 	
 	apu.end_frame( blip_time );
 	
@@ -421,6 +426,20 @@ blargg_err_t Gym_Emu::play_( int count, sample_t out [] )
 	return blargg_ok;
 }
 
+blargg_err_t Gym_Emu::fast_forward_( int count )
+{
+	// Only write logged registers, without running the FM chip, DAC and resampler
+	int frame_size = (int) (sample_rate() / (tempo() * 60)) * 2;
+	for ( ; count >= frame_size && !emu_track_ended(); count -= frame_size )
+		parse_frame( false );
+	
+	stereo_buf.clear();
+	resampler.clear();
+	
+	// Less than a frame remains
+	return Music_Emu::fast_forward_( count );
+}
+
 blargg_err_t Gym_Emu::hash_( Hash_Function& out ) const
 {
 	hash_gym_file( header(), log_begin(), file_end() - log_begin(), out );
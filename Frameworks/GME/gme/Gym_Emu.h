@@ -51,6 +51,7 @@ protected:
 	virtual blargg_err_t set_sample_rate_( int sample_rate );
 	virtual blargg_err_t start_track_( int );
 	virtual blargg_err_t play_( int count, sample_t [] );
+	virtual blargg_err_t fast_forward_( int count );
 	virtual void mute_voices_( int );
 	virtual void set_tempo_( double );
 
@@ -79,7 +80,7 @@ private:
 	header_t        header_;
 	
 	byte const* log_begin() const { return file_begin() + log_offset; }
-	void parse_frame();
+	void parse_frame( bool run_dac );
 	void run_pcm( byte const in [], int count );
 	int play_frame( blip_time_t blip_time, int sample_count, sample_t buf [] );
 	static int play_frame_( void*, blip_time_t, int, sample_t [] );
@@ -180,7 +180,7 @@ blargg_err_t Music_Emu::skip_( int count )
 		int n = count - threshold/2;
 		n &= ~(2048-1); // round to multiple of 2048
 		count -= n;
-		RETURN_ERR( track_filter.skip_( n ) );
+		RETURN_ERR( fast_forward_( n ) );
 		
 		mute_voices( saved_mute );
 	}
@@ -188,6 +188,11 @@ blargg_err_t Music_Emu::skip_( int count )
 	return track_filter.skip_( count );
 }
 
+blargg_err_t Music_Emu::fast_forward_( int count )
+{
+	return track_filter.skip_( count );
+}
+
 // Playback
 
 blargg_err_t Music_Emu::start_track( int track )
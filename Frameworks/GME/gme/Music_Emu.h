@@ -126,6 +126,9 @@ protected:
 	// Cause any further generated samples to be silence, instead of calling play_()
 	void set_track_ended()                      { track_filter.set_track_ended(); }
 	
+	// True if set_track_ended() has been called for the current track
+	bool emu_track_ended() const                { return track_filter.emu_track_ended(); }
+	
 	// If more than secs of silence are encountered, track is ended
 	void set_max_initial_silence( int secs )    { tfilter.max_initial = secs; }
 	
@@ -170,6 +173,11 @@ protected:
 	
 	// Skip count samples. Count will always be even.
 	virtual blargg_err_t skip_( int count );
+	
+	// Skip count samples of a long skip as quickly as possible, by running emulation
+	// without synthesizing sound. All voices are muted while this is called. Count will
+	// always be even. Default plays and discards the samples.
+	virtual blargg_err_t fast_forward_( int count );
 
     // Save current state of file to specified writer.
     virtual blargg_err_t save_( gme_writer_t, void* ) const { return "Not supported by this format"; }
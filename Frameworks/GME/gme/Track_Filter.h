@@ -64,6 +64,9 @@ public:
 	// Sets internal "track ended" flag and stops generation of further source samples
 	void set_track_ended()                      { emu_track_ended_ = true; }
 	
+	// True if emulator has reached end of track, even if buffered samples remain
+	bool emu_track_ended() const                { return emu_track_ended_ != 0; }
+	
 	// For use by skip_() callback
 	blargg_err_t skip_( int count );
 	
@@ -562,6 +562,7 @@ blargg_err_t Vgm_Emu::load_mem_( const byte* in, int file_size )
 blargg_err_t Vgm_Emu::skip_( int count )
 {
 	core.skip_(count);
+	check_end();
 	return blargg_ok;
 }
 
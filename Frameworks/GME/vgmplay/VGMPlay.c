@@ -513,9 +513,15 @@ void SeekVGM(void *_p, bool Relative, INT32 PlayBkSamples)
 	}
 
 	p->ForceVGMExec = true;
+	p->SeekDACWrite = 0x0000;
 	InterpretFile(p, Samples);
 	p->ForceVGMExec = false;
 
+	// the DAC writes were skipped, only the current value is needed
+	if (p->SeekDACWrite & 0x100)
+		chip_reg_write(p, 0x02, 0x00, 0x00, 0x2A, p->SeekDACWrite & 0xFF);
+	p->SeekDACWrite = 0x0000;
+
 	return;
 }
 
@@ -3891,7 +3897,12 @@ static void InterpretVGM(VGM_PLAYER* p, UINT32 SampleCount)
 				TempByt = GetDACFromPCMBank(p);
 				if (p->VGMHead.lngHzYM2612)
 				{
-					chip_reg_write(p, 0x02, 0x00, 0x00, 0x2A, TempByt);
+					// Writing each DAC sample costs a chip update, so while seeking
+					// only the last one is remembered and written by SeekVGM.
+					if (p->ForceVGMExec && ! p->IsVGMInit)
+						p->SeekDACWrite = 0x100 | TempByt;
+					else
+						chip_reg_write(p, 0x02, 0x00, 0x00, 0x2A, TempByt);
 				}
 				p->VGMSmplPos += (Command & 0x0F);
 				break;
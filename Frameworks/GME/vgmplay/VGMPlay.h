@@ -233,6 +233,7 @@ typedef struct vgm_player
     bool EndPlay;
     bool FadePlay;
     bool ForceVGMExec;
+    UINT16 SeekDACWrite;	// last YM2612 DAC write while seeking, 0x100 | data
     UINT8 PlayingMode;
     UINT32 PlayingTime;
     UINT32 FadeStart;
@@ -304,4 +304,14 @@ void EMU_CALL sega_enable_dsp_dynarec(void *state, uint8 enable) {
   if(yamstate) yam_enable_dsp_dynarec(yamstate, enable);
 }
 
+void EMU_CALL sega_prepare_dynacode(void *state) {
+  void *yamstate = getyamstate(SEGASTATE);
+  if(yamstate) yam_prepare_dynacode(yamstate);
+}
+
+void EMU_CALL sega_unprepare_dynacode(void *state) {
+  void *yamstate = getyamstate(SEGASTATE);
+  if(yamstate) yam_unprepare_dynacode(yamstate);
+}
+
 /////////////////////////////////////////////////////////////////////////////
@@ -95,6 +95,13 @@ void EMU_CALL sega_enable_dry(void *state, uint8 enable);
 void EMU_CALL sega_enable_dsp(void *state, uint8 enable);
 void EMU_CALL sega_enable_dsp_dynarec(void *state, uint8 enable);
 
+//
+// Allocate or free the DSP dynarec's code buffer, where it needs one.
+// Prepare after sega_clear_state, unprepare before freeing the state.
+//
+void EMU_CALL sega_prepare_dynacode(void *state);
+void EMU_CALL sega_unprepare_dynacode(void *state);
+
 /////////////////////////////////////////////////////////////////////////////
 
 #ifdef __cplusplus
@@ -13,11 +13,18 @@
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
-#elif defined(HAVE_MPROTECT)
+#elif defined(HAVE_MPROTECT) || defined(__amd64__)
 #include <unistd.h>
 #include <sys/mman.h>
 #include <errno.h>
 #endif
+#if defined(__APPLE__) && defined(__amd64__)
+#include <stdio.h>
+#include <sys/sysctl.h>
+#endif
+#if defined(__amd64__) && !defined(_WIN32) && !defined(MAP_ANONYMOUS)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
 
 #include <stdlib.h>
 #include <math.h>
@@ -27,12 +34,12 @@
 #define __fastcall __attribute__((regparm(3)))
 #endif
 
-/* No dynarec for x86_64 yet */
-#if defined(_WIN32) || defined(__i386__)
-#define ENABLE_DYNAREC
-#endif
+/* x86_64 compiles into its own executable mapping, see yam_prepare_dynacode */
 #if defined(_WIN64) || defined(__amd64__)
-#undef ENABLE_DYNAREC
+#define ENABLE_DYNAREC
+#define DYNAREC_X64
+#elif defined(_WIN32) || defined(__i386__)
+#define ENABLE_DYNAREC
 #endif
 
 // no 'conversion from _blah_ possible loss of data' warnings
@@ -355,7 +362,11 @@ static uint64 mpro_aica_read(struct MPRO *mpro) {
   return value;
 }
 
+#ifdef DYNAREC_X64
+#define DYNACODE_MAX_SIZE (0x10000)
+#else
 #define DYNACODE_MAX_SIZE (0x6000)
+#endif
 #define DYNACODE_SLOP_SIZE (0x80)
 
 struct YAM_STATE {
@@ -445,7 +456,14 @@ struct YAM_STATE {
   //
   // Buffer for dynarec code
   //
-#ifdef ENABLE_DYNAREC
+#ifdef DYNAREC_X64
+  // Executable mapping from yam_prepare_dynacode, NULL if none.
+  // Its first word is the serial of the code in it, which is matched
+  // against dynacode_serial, so a state copied back from a checkpoint
+  // doesn't run code compiled for a later program.
+  uint8 *dynacode;
+  uint32 dynacode_serial;
+#elif defined(ENABLE_DYNAREC)
   uint8 dynacode[DYNACODE_MAX_SIZE];
 #endif
 };
@@ -2529,7 +2547,7 @@ static void __fastcall dsp_sample_interpret(struct YAM_STATE *state) {
 #define C32(N) { *((uint32*)outp) = ((uint32)(N)); outp += 4; }
 #define C32CALL(N) { *((uint32*)outp) = ((uint32)(N)) - (((uint32)(outp))+4); outp += 4; }
 
-#define STRUCTOFS(thetype,thefield) ((uint32)(&(((struct thetype*)0)->thefield)))
+#define STRUCTOFS(thetype,thefield) ((uint32)(size_t)(&(((struct thetype*)0)->thefield)))
 #define STATEOFS(thefield) STRUCTOFS(YAM_STATE,thefield)
 
 #ifdef ENABLE_DYNAREC
@@ -2557,7 +2575,7 @@ static int instruction_uses_shifted(struct MPRO *mpro) {
 // Also uses the current ringbuffer pointer and size, and ram pointer/mask/memwordxor
 // So if any of those change, the compiled dynacode must be invalidated
 //
-#ifdef ENABLE_DYNAREC
+#if defined(ENABLE_DYNAREC) && !defined(DYNAREC_X64)
 static void dynacompile(struct YAM_STATE *state) {
   // Pre-compute ringbuffer size mask
   uint32 rbmask = (1 << ((state->rbl)+13)) - 1;
@@ -2849,6 +2867,366 @@ static void dynacompile(struct YAM_STATE *state) {
 }
 #endif
 
+#ifdef DYNAREC_X64
+//
+// Call one of the conversion routines at the start of the code
+//
+static uint8 *emit_x64_call(uint8 *outp, uint8 *target) {
+  C(0xE8) C32((uint32)(target - (outp + 4))) // call <target>
+  return outp;
+}
+
+//
+// Compile x86-64 code out of the current DSP program/coef/address set
+// Same inputs as the x86 version, but follows dsp_sample_interpret step for
+// step so both give the same output. The code only refers to the state and
+// RAM through registers, so the mapping can be anywhere.
+//
+// Registers: rdi = state, esi = ACC, r8d = MDEC_CT, r9 = RAM,
+// r10d = TEMP, r11d = INPUTS, edx = SHIFTED, eax/ecx scratch
+//
+static void dynacompile(struct YAM_STATE *state) {
+  // Pre-compute ringbuffer size mask
+  uint32 rbmask = (1 << ((state->rbl)+13)) - 1;
+
+  uint8 *outp = state->dynacode;
+  uint8 *body_jump;
+  uint8 *f16_to_i24;
+  uint8 *i24_to_f16;
+  uint32 serial;
+  int i;
+  char ins_uses_acc[129];
+  char ins_uses_shifted[129];
+  //
+  // Serial number of this code
+  //
+  serial = *((uint32*)outp) + 1;
+  *((uint32*)outp) = serial;
+  state->dynacode_serial = serial;
+  outp += DYNACODE_SLOP_SIZE;
+  //
+  // Figure out which instructions need what things
+  // Skipped instructions overwrite ACC without reading it
+  //
+  memset(ins_uses_acc, 0, sizeof(ins_uses_acc));
+  memset(ins_uses_shifted, 0, sizeof(ins_uses_shifted));
+  ins_uses_acc[128] = 1;
+  ins_uses_shifted[128] = 1;
+  for(i = 0; i < 128; i++) {
+    struct MPRO *mpro = state->mpro + i;
+    if(mpro->__kisxzbon & 0x80) { continue; }
+    ins_uses_shifted[i] = instruction_uses_shifted(mpro);
+    ins_uses_acc[i] =
+      (ins_uses_shifted[i]) ||
+      ((mpro->__kisxzbon & 0x0C) == 0x04);
+  }
+
+  //
+  // Entry point, jumps over the conversion routines
+  //
+  C(0xE9) body_jump = outp; C32(0)                // jmp <body>
+  //
+  // float16_to_int24: ecx in, ecx out
+  //
+  f16_to_i24 = outp;
+  C(0x50)                                         // push rax
+  C(0x52)                                         // push rdx
+  C(0x89) C(0xCA)                                 // mov edx,ecx
+  C(0xC1) C(0xEA) C(0x0B)                         // shr edx,11
+  C(0x83) C(0xE2) C(0x0F)                         // and edx,0Fh
+  C(0x89) C(0xC8)                                 // mov eax,ecx
+  C(0x25) C32(0x00008000)                         // and eax,8000h
+  C(0xC1) C(0xE0) C(0x10)                         // shl eax,16
+  C(0xD1) C(0xF8)                                 // sar eax,1
+  C(0x83) C(0xFA) C(0x0C)                         // cmp edx,12
+  C(0x72) C(0x07)                                 // jb +7bytes
+  C(0xBA) C32(0x0000000B)                         // mov edx,11
+  C(0xEB) C(0x05)                                 // jmp +5bytes
+  C(0x35) C32(0x40000000)                         // xor eax,40000000h
+  C(0x81) C(0xE1) C32(0x000007FF)                 // and ecx,7FFh
+  C(0xC1) C(0xE1) C(0x13)                         // shl ecx,19
+  C(0x09) C(0xC8)                                 // or eax,ecx
+  C(0x8D) C(0x4A) C(0x08)                         // lea ecx,[rdx+8]
+  C(0xD3) C(0xF8)                                 // sar eax,cl
+  C(0x89) C(0xC1)                                 // mov ecx,eax
+  C(0x5A)                                         // pop rdx
+  C(0x58)                                         // pop rax
+  C(0xC3)                                         // ret
+  //
+  // int24_to_float16: ecx in, ecx out
+  //
+  i24_to_f16 = outp;
+  C(0x50)                                         // push rax
+  C(0x52)                                         // push rdx
+  C(0x31) C(0xD2)                                 // xor edx,edx
+  C(0x89) C(0xC8)                                 // mov eax,ecx
+  C(0x25) C32(0x00800000)                         // and eax,800000h
+  C(0x74) C(0x02)                                 // je +2bytes
+  C(0xF7) C(0xD1)                                 // not ecx
+  C(0x81) C(0xE1) C32(0x007FFFFF)                 // and ecx,7FFFFFh
+  C(0x81) C(0xF9) C32(0x00020000)                 // cmp ecx,20000h
+  C(0x73) C(0x09)                                 // jae +9bytes
+  C(0x81) C(0xC2) C32(6<<11)                      // add edx,6<<11
+  C(0xC1) C(0xE1) C(0x06)                         // shl ecx,6
+  C(0x81) C(0xF9) C32(0x00100000)                 // cmp ecx,100000h
+  C(0x73) C(0x09)                                 // jae +9bytes
+  C(0x81) C(0xC2) C32(3<<11)                      // add edx,3<<11
+  C(0xC1) C(0xE1) C(0x03)                         // shl ecx,3
+  C(0x81) C(0xF9) C32(0x00400000)                 // cmp ecx,400000h
+  C(0x73) C(0x08)                                 // jae +8bytes
+  C(0x81) C(0xC2) C32(1<<11)                      // add edx,1<<11
+  C(0x01) C(0xC9)                                 // add ecx,ecx
+  C(0x81) C(0xF9) C32(0x00400000)                 // cmp ecx,400000h
+  C(0x73) C(0x08)                                 // jae +8bytes
+  C(0x81) C(0xC2) C32(1<<11)                      // add edx,1<<11
+  C(0x01) C(0xC9)                                 // add ecx,ecx
+  C(0x81) C(0xF9) C32(0x00400000)                 // cmp ecx,400000h
+  C(0x73) C(0x06)                                 // jae +6bytes
+  C(0x81) C(0xC2) C32(1<<11)                      // add edx,1<<11
+  C(0xC1) C(0xE9) C(0x0B)                         // shr ecx,11
+  C(0x81) C(0xE1) C32(0x000007FF)                 // and ecx,7FFh
+  C(0x09) C(0xD1)                                 // or ecx,edx
+  C(0x85) C(0xC0)                                 // test eax,eax
+  C(0x74) C(0x06)                                 // je +6bytes
+  C(0x81) C(0xF1) C32(0x000087FF)                 // xor ecx,87FFh
+  C(0x5A)                                         // pop rdx
+  C(0x58)                                         // pop rax
+  C(0xC3)                                         // ret
+  *((uint32*)body_jump) = (uint32)(outp - (body_jump + 4));
+
+  //
+  // Prefix
+  //
+#ifdef _WIN64
+  C(0x56)                                                       // push rsi
+  C(0x57)                                                       // push rdi
+  C(0x48) C(0x89) C(0xCF)                                       // mov rdi,rcx
+#endif
+  C(0x44) C(0x8B) C(0x87) C32(STATEOFS(mdec_ct))                // mov r8d,[rdi+<OFS32:mdec_ct>]
+  C(0x8B) C(0xB7) C32(STATEOFS(xzbchoice[XZBCHOICE_ACC]))       // mov esi,[rdi+<OFS32:acc>]
+  C(0x4C) C(0x8B) C(0x8F) C32(STATEOFS(ram_ptr))                // mov r9,[rdi+<OFS32:ram_ptr>]
+  //
+  // Each instruction
+  //
+  for(i = 0; i < 128; i++) {
+    struct MPRO *mpro = state->mpro + i;
+    int need_acc = ins_uses_acc[i + 1];
+    int need_temp, need_inputs;
+    //
+    // Skipped instruction: ACC = TEMP[MDEC_CT] * FRC_REG + TEMP[MDEC_CT]
+    //
+    if(mpro->__kisxzbon & 0x80) {
+      if(need_acc) {
+        C(0x44) C(0x89) C(0xC1)                                         // mov ecx,r8d
+        C(0x83) C(0xE1) C(0x7F)                                         // and ecx,7Fh
+        C(0x48) C(0x63) C(0x8C) C(0x8F) C32(STATEOFS(temp))             // movsxd rcx,[rdi+rcx*4+<OFS32:temp>]
+        C(0x48) C(0x63) C(0x87) C32(STATEOFS(yychoice[YYCHOICE_FRC_REG])) // movsxd rax,[rdi+<OFS32:yychoice0>]
+        C(0x48) C(0x0F) C(0xAF) C(0xC1)                                 // imul rax,rcx
+        C(0x48) C(0xC1) C(0xF8) C(0x0C)                                 // sar rax,12
+        C(0x01) C(0xC8)                                                 // add eax,ecx
+        C(0x89) C(0xC6)                                                 // mov esi,eax
+      }
+      continue;
+    }
+    need_temp = need_acc && (
+      ((mpro->__kisxzbon & 0x10) == 0x00) ||
+      ((mpro->__kisxzbon & 0x0C) == 0x00));
+    need_inputs =
+      (need_acc && (mpro->__kisxzbon & 0x10)) ||
+      (mpro->m_wrAFyyYh & 2) ||
+      ((mpro->m_wrAFyyYh & 0x20) && !(mpro->__kisxzbon & 0x40));
+    //
+    // Temp and input reads
+    //
+    if(need_temp) {
+      C(0x41) C(0x8D) C(0x48) C(mpro->t_0rrrrrrr)                       // lea ecx,[r8+<BYTE:TRA>]
+      C(0x83) C(0xE1) C(0x7F)                                           // and ecx,7Fh
+      C(0x44) C(0x8B) C(0x94) C(0x8F) C32(STATEOFS(temp))               // mov r10d,[rdi+rcx*4+<OFS32:temp>]
+    }
+    if(need_inputs) {
+      C(0x44) C(0x8B) C(0x9F) C32(STATEOFS(inputs[mpro->i_00rrrrrr]))   // mov r11d,[rdi+<OFS32:INPUTS+4*IRA>]
+    }
+    //
+    // Input write (the slop area is never read)
+    //
+    if((mpro->i_0T0wwwww & 0x40) == 0) {
+      C(0x8B) C(0x87) C32(STATEOFS(mem_in_data[i&3]))                   // mov eax,[rdi+<OFS32:memindata>]
+      C(0x89) C(0x87) C32(STATEOFS(inputs[mpro->i_0T0wwwww]))           // mov [rdi+<OFS32:INPUTS+4*IWA>],eax
+    }
+    //
+    // SHIFTED from the previous accumulator, to edx
+    //
+    if(ins_uses_shifted[i]) {
+      C(0x89) C(0xF2)                                                   // mov edx,esi
+      if(mpro->m_wrAFyyYh & 1) {
+        C(0x01) C(0xD2)                                                 // add edx,edx
+      }
+      if(mpro->__kisxzbon & 0x20) {
+        C(0xB8) C32(0x007FFFFF)                                         // mov eax,7FFFFFh
+        C(0x39) C(0xC2)                                                 // cmp edx,eax
+        C(0x0F) C(0x4F) C(0xD0)                                         // cmovg edx,eax
+        C(0xB8) C32(0xFF800000)                                         // mov eax,-800000h
+        C(0x39) C(0xC2)                                                 // cmp edx,eax
+        C(0x0F) C(0x4C) C(0xD0)                                         // cmovl edx,eax
+      }
+    }
+    //
+    // Multiply and accumulate, if anyone will look at the result
+    //
+    if(need_acc) {
+      if((mpro->__kisxzbon & 0x10) == 0) {
+        C(0x49) C(0x63) C(0xC2)                                         // movsxd rax,r10d
+      } else {
+        C(0x49) C(0x63) C(0xC3)                                         // movsxd rax,r11d
+      }
+      switch(mpro->m_wrAFyyYh & 0x0C) {
+      case 0x00: // FRC_REG
+        C(0x48) C(0x63) C(0x8F) C32(STATEOFS(yychoice[YYCHOICE_FRC_REG])) // movsxd rcx,[rdi+yychoice0]
+        C(0x48) C(0x0F) C(0xAF) C(0xC1)                                 // imul rax,rcx
+        break;
+      case 0x04: // COEF
+        { sint32 coef = state->coef[mpro->c_0rrrrrrr];
+          C(0x48) C(0x69) C(0xC0) C32(coef)                             // imul rax,rax,<SINT32:COEF>
+        }
+        break;
+      case 0x08: // Y_REG_H
+        C(0x48) C(0x63) C(0x8F) C32(STATEOFS(yychoice[YYCHOICE_Y_REG_H])) // movsxd rcx,[rdi+yychoice2]
+        C(0x48) C(0x0F) C(0xAF) C(0xC1)                                 // imul rax,rcx
+        break;
+      case 0x0C: // Y_REG_L
+        C(0x48) C(0x63) C(0x8F) C32(STATEOFS(yychoice[YYCHOICE_Y_REG_L])) // movsxd rcx,[rdi+yychoice3]
+        C(0x48) C(0x0F) C(0xAF) C(0xC1)                                 // imul rax,rcx
+        break;
+      }
+      C(0x48) C(0xC1) C(0xF8) C(0x0C)                                   // sar rax,12
+      if((mpro->__kisxzbon & 0x08) == 0) {
+        if(mpro->negb == 0) {
+          if((mpro->__kisxzbon & 0x04) == 0) {
+            C(0x44) C(0x01) C(0xD0)                                     // add eax,r10d
+          } else {
+            C(0x01) C(0xF0)                                             // add eax,esi
+          }
+        } else {
+          if((mpro->__kisxzbon & 0x04) == 0) {
+            C(0x44) C(0x29) C(0xD0)                                     // sub eax,r10d
+          } else {
+            C(0x29) C(0xF0)                                             // sub eax,esi
+          }
+        }
+      }
+      C(0x89) C(0xC6)                                                   // mov esi,eax
+    }
+    //
+    // If YRL is on, latch Y register
+    //
+    if(mpro->m_wrAFyyYh & 2) {
+      C(0x44) C(0x89) C(0xD8)                                           // mov eax,r11d
+      C(0xC1) C(0xF8) C(0x0B)                                           // sar eax,11
+      C(0x89) C(0x87) C32(STATEOFS(yychoice[YYCHOICE_Y_REG_H]))         // mov [rdi+<OFS32:yychoice2>],eax
+      C(0x44) C(0x89) C(0xD8)                                           // mov eax,r11d
+      C(0xC1) C(0xF8) C(0x04)                                           // sar eax,4
+      C(0x25) C32(0x00000FFF)                                           // and eax,0FFFh
+      C(0x89) C(0x87) C32(STATEOFS(yychoice[YYCHOICE_Y_REG_L]))         // mov [rdi+<OFS32:yychoice3>],eax
+    }
+    //
+    // If TWT is on, perform the temp write of SHIFTED
+    //
+    if((mpro->t_Twwwwwww & 0x80) == 0) {
+      C(0x41) C(0x8D) C(0x48) C(mpro->t_Twwwwwww)                       // lea ecx,[r8+<BYTE:TWA>]
+      C(0x83) C(0xE1) C(0x7F)                                           // and ecx,7Fh
+      C(0x89) C(0x94) C(0x8F) C32(STATEOFS(temp))                       // mov [rdi+rcx*4+<OFS32:temp>],edx
+    }
+    //
+    // If FRCL is set, latch it
+    //
+    if(mpro->m_wrAFyyYh & 0x10) {
+      C(0x89) C(0xD0)                                                   // mov eax,edx
+      if(mpro->__kisxzbon & 0x40) { // interpolate mode
+        C(0x25) C32(0x00000FFF)                                         // and eax,0FFFh
+      } else { // non-interpolate mode
+        C(0xC1) C(0xF8) C(0x0B)                                         // sar eax,11
+      }
+      C(0x89) C(0x87) C32(STATEOFS(yychoice[YYCHOICE_FRC_REG]))         // mov [rdi+<OFS32:yychoice0>],eax
+    }
+    //
+    // Memory operations, with the byte address in eax
+    //
+    if(mpro->m_wrAFyyYh & 0xC0) {
+      uint32 madrsnx = state->madrs[mpro->m_00aaaaaa];
+      uint32 mask = (rbmask | ((sint32)(mpro->tablemask))) & 0xFFFF;
+      madrsnx += mpro->__kisxzbon & 1;
+      C(0xB8) C32(madrsnx)                                              // mov eax,<DWORD:MADRS+NXADR>
+      if(mpro->adrmask != 0) {
+        C(0x03) C(0x87) C32(STATEOFS(adrs_reg))                         // add eax,[rdi+<OFS32:adrs_reg>]
+      }
+      if(mpro->tablemask == 0) {
+        C(0x44) C(0x01) C(0xC0)                                         // add eax,r8d
+      }
+      C(0x25) C32(mask)                                                 // and eax,<DWORD:rblmask or FFFFh>
+      C(0x01) C(0xC0)                                                   // add eax,eax
+      C(0x05) C32(state->rbp)                                           // add eax,<DWORD:rbp>
+      C(0x25) C32(state->ram_mask)                                      // and eax,<DWORD:RAMMASK>
+      if(state->mem_word_address_xor != 0) {
+        C(0x35) C32(state->mem_word_address_xor)                        // xor eax,<DWORD:memwxor>
+      }
+      if(mpro->m_wrAFyyYh & 0x40) { // MRD
+        C(0x41) C(0x0F) C(0xBF) C(0x0C) C(0x01)                         // movsx ecx,word ptr [r9+rax]
+        if((mpro->__kisxzbon & 0x02) == 0) { // NOFL=0
+          outp = emit_x64_call(outp, f16_to_i24);                       // call float16_to_int24
+        } else { // NOFL=1
+          C(0xC1) C(0xE1) C(0x08)                                       // shl ecx,8
+        }
+        C(0x89) C(0x8F) C32(STATEOFS(mem_in_data[(i+2)&3]))             // mov [rdi+<OFS32:meminptr>],ecx
+      }
+      if(mpro->m_wrAFyyYh & 0x80) { // MWT
+        C(0x89) C(0xD1)                                                 // mov ecx,edx
+        if((mpro->__kisxzbon & 0x02) == 0) { // NOFL=0
+          outp = emit_x64_call(outp, i24_to_f16);                       // call int24_to_float16
+        } else { // NOFL=1
+          C(0xC1) C(0xF9) C(0x08)                                       // sar ecx,8
+        }
+        C(0x66) C(0x41) C(0x89) C(0x0C) C(0x01)                         // mov [r9+rax],cx
+      }
+    }
+    //
+    // If ADRL is set, latch address reg
+    //
+    if(mpro->m_wrAFyyYh & 0x20) {
+      if(mpro->__kisxzbon & 0x40) { // interpolate mode
+        C(0x89) C(0xD0)                                                 // mov eax,edx
+        C(0xC1) C(0xF8) C(0x0C)                                         // sar eax,12
+      } else {
+        C(0x44) C(0x89) C(0xD8)                                         // mov eax,r11d
+        C(0xC1) C(0xF8) C(0x10)                                         // sar eax,16
+      }
+      C(0x25) C32(0x00000FFF)                                           // and eax,0FFFh
+      C(0x89) C(0x87) C32(STATEOFS(adrs_reg))                           // mov [rdi+<OFS32:adrs_reg>],eax
+    }
+    //
+    // If EWT is on, perform write of EFREG
+    //
+    if((mpro->e_000Twwww & 0x10) == 0) {
+      C(0x89) C(0xD1)                                                   // mov ecx,edx
+      C(0xC1) C(0xF9) C(0x08)                                           // sar ecx,8
+      C(0x66) C(0x89) C(0x8F) C32(STATEOFS(efreg[mpro->e_000Twwww]))    // mov [rdi+<OFS32:EFREG+2*EWA>],cx
+    }
+  }
+  //
+  // Suffix
+  //
+  C(0x89) C(0xB7) C32(STATEOFS(xzbchoice[XZBCHOICE_ACC]))               // mov [rdi+<OFS32:acc>],esi
+#ifdef _WIN64
+  C(0x5F)                                                               // pop rdi
+  C(0x5E)                                                               // pop rsi
+#endif
+  C(0xC3)                                                               // ret
+  //
+  // Set valid flag
+  //
+  state->dsp_dyna_valid = 1;
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////
 
 typedef void (__fastcall *dsp_sample_t)(struct YAM_STATE *state);
@@ -2870,7 +3248,14 @@ static void render_effects(
   sint32 eflin_l[16];
   sint32 eflin_r[16];
 
-#ifdef ENABLE_DYNAREC
+#ifdef DYNAREC_X64
+  if(state->dsp_dyna_enabled && state->dynacode) {
+    if(!(state->dsp_dyna_valid) || *((uint32*)(state->dynacode)) != state->dynacode_serial) {
+      dynacompile(state);
+    }
+    samplefunc = (dsp_sample_t)(((uint8*)(state->dynacode)) + DYNACODE_SLOP_SIZE);
+  } else {
+#elif defined(ENABLE_DYNAREC)
   if(state->dsp_dyna_enabled) {
     if(!(state->dsp_dyna_valid)) {
       dynacompile(state);
@@ -3065,9 +3450,43 @@ void EMU_CALL yam_flush(void *state) {
 /////////////////////////////////////////////////////////////////////////////
 //
 // Prepare or unprepare dynacode buffer for execution
-//
+// On x86_64 this allocates the buffer, so prepare after yam_clear_state and
+// unprepare before freeing the state. Without it the DSP is interpreted.
+//
+#if defined(DYNAREC_X64) && defined(__APPLE__)
+static int macos_release(void) {
+  char buf[64];
+  size_t size = sizeof(buf);
+  int major;
+  if(sysctlbyname("kern.osrelease", buf, &size, NULL, 0) != 0) return 0;
+  if(sscanf(buf, "%d", &major) != 1) return 0;
+  return major;
+}
+#endif
+
 void EMU_CALL yam_prepare_dynacode(void *state) {
-#ifdef ENABLE_DYNAREC
+#ifdef DYNAREC_X64
+  uint8 *code;
+  if(YAMSTATE->dynacode) return;
+#ifdef _WIN32
+  code = VirtualAlloc(NULL, DYNACODE_MAX_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+  {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(__APPLE__) && defined(MAP_JIT)
+    // Hardened runtime only allows executable memory through MAP_JIT,
+    // which is Mojave and later
+    if(macos_release() >= 18) flags |= MAP_JIT;
+#endif
+    code = mmap(NULL, DYNACODE_MAX_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0);
+    if(code == MAP_FAILED) code = NULL;
+  }
+#endif
+  if(!code) return;
+  *((uint32*)code) = 0;
+  YAMSTATE->dynacode = code;
+  YAMSTATE->dsp_dyna_valid = 0;
+#elif defined(ENABLE_DYNAREC)
 #ifdef _WIN32
   DWORD i;
   VirtualProtect( &YAMSTATE->dynacode, sizeof(YAMSTATE->dynacode), PAGE_EXECUTE_READWRITE, &i );
@@ -3082,7 +3501,16 @@ void EMU_CALL yam_prepare_dynacode(void *state) {
 }
 
 void EMU_CALL yam_unprepare_dynacode(void *state) {
-#ifdef ENABLE_DYNAREC
+#ifdef DYNAREC_X64
+  if(!YAMSTATE->dynacode) return;
+#ifdef _WIN32
+  VirtualFree(YAMSTATE->dynacode, 0, MEM_RELEASE);
+#else
+  munmap(YAMSTATE->dynacode, DYNACODE_MAX_SIZE);
+#endif
+  YAMSTATE->dynacode = NULL;
+  YAMSTATE->dsp_dyna_valid = 0;
+#elif defined(ENABLE_DYNAREC)
 #ifdef _WIN32
   DWORD i;
   VirtualProtect( &YAMSTATE->dynacode, sizeof(YAMSTATE->dynacode), PAGE_READWRITE, &i );
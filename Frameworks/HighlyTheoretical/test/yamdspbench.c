@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////////////////
+//
+// yamdspbench - times the effects DSP interpreted and compiled
+//
+// Random SCSP and AICA chips, set up as in yamdspcheck, are rendered with
+// only the effect output on, once with the dynarec off and once with it on.
+// The slots still have to be played to feed the DSP, so both times include
+// them, and the difference is what the dynarec saves.
+//
+// usage: yamdspbench [seconds] [chips]
+//
+/////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../HighlyTheoretical/Core/yam.h"
+#include "yamdspsetup.h"
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double render(uint8 version, uint32 seed, uint8 *ram, sint16 *pcm, uint32 samples, int dynarec) {
+  void *state = yam_dsp_setup(version, seed, ram, dynarec);
+  double start;
+  if(!state) { printf("out of memory\n"); exit(1); }
+  start = now();
+  yam_dsp_render(state, pcm, samples);
+  start = now() - start;
+  yam_dsp_teardown(state);
+  return start;
+}
+
+int main(int argc, char **argv) {
+  uint32 samples = (argc > 1 ? atoi(argv[1]) : 10) * 44100;
+  int chips = argc > 2 ? atoi(argv[2]) : 4;
+  uint8 *ram = malloc(0x800000);
+  sint16 *pcm = malloc(samples * 4);
+  double total[2] = { 0, 0 };
+  int c;
+
+  if(!ram || !pcm || !samples) { printf("out of memory\n"); return 1; }
+
+  yam_init();
+
+  printf("%u samples per chip\n", samples);
+  for(c = 0; c < chips; c++) {
+    uint8 version = (c & 1) ? 2 : 1;
+    double interpreted = render(version, c + 1, ram, pcm, samples, 0);
+    double compiled = render(version, c + 1, ram, pcm, samples, 1);
+    printf("%s chip %d: interpreted %.3f s, compiled %.3f s\n",
+      version == 2 ? "AICA" : "SCSP", c, interpreted, compiled);
+    total[0] += interpreted;
+    total[1] += compiled;
+  }
+  printf("total: interpreted %.3f s, compiled %.3f s (%.2fx)\n",
+    total[0], total[1], total[1] > 0 ? total[0] / total[1] : 0);
+
+  free(ram);
+  free(pcm);
+  return 0;
+}
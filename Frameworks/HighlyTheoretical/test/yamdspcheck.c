@@ -0,0 +1,196 @@
+/////////////////////////////////////////////////////////////////////////////
+//
+// yamdspcheck - checks the effects DSP dynarec in yam.c against the
+// interpreter
+//
+// First, random SCSP and AICA programs are run a sample at a time on random
+// registers and RAM, once through dsp_sample_interpret and once through the
+// compiled code. TEMP, INPUTS, EFREG, ACC, the latches, the address register
+// and RAM must match after every sample.
+//
+// Then whole chips are set up through their registers with random slots,
+// a random program and random RAM, and rendered with only the effect output
+// turned on, once interpreted and once compiled. The PCM must match.
+//
+// yam.c is included directly, so the interpreter and compiler can be reached.
+//
+// usage: yamdspcheck [programs] [renders]
+//
+// Returns non-zero if anything differs.
+//
+/////////////////////////////////////////////////////////////////////////////
+
+#include "../HighlyTheoretical/Core/yam.c"
+
+#include <stdio.h>
+
+#include "yamdspsetup.h"
+
+#define RAMSIZE (0x800000)
+
+#ifndef ENABLE_DYNAREC
+#error "no dynarec on this host"
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Random programs on random state
+//
+
+static uint32 check_seed = 1234;
+
+static uint32 rnd(void) {
+  check_seed = check_seed * 1103515245 + 12345;
+  return (check_seed >> 8) & 0xFFFF;
+}
+
+static uint64 rnd64(void) {
+  uint64 v = 0; int i;
+  for(i = 0; i < 4; i++) { v = (v << 16) ^ rnd(); }
+  return v;
+}
+
+static sint32 rnd24(void) { return ((sint32)(rnd64() << 8)) >> 8; }
+
+static int compare_state(struct YAM_STATE *a, struct YAM_STATE *b, const char **what) {
+  if(memcmp(a->temp, b->temp, sizeof(a->temp))) { *what = "TEMP"; return 1; }
+  if(memcmp(a->mem_in_data, b->mem_in_data, sizeof(a->mem_in_data))) { *what = "memory latches"; return 1; }
+  if(a->adrs_reg != b->adrs_reg) { *what = "ADRS_REG"; return 1; }
+  if(memcmp(a->inputs, b->inputs, 0x40 * sizeof(a->inputs[0]))) { *what = "INPUTS"; return 1; }
+  if(memcmp(a->efreg, b->efreg, 0x10 * sizeof(a->efreg[0]))) { *what = "EFREG"; return 1; }
+  if(a->xzbchoice[XZBCHOICE_ACC] != b->xzbchoice[XZBCHOICE_ACC]) { *what = "ACC"; return 1; }
+  if(a->yychoice[YYCHOICE_FRC_REG] != b->yychoice[YYCHOICE_FRC_REG] ||
+     a->yychoice[YYCHOICE_Y_REG_H] != b->yychoice[YYCHOICE_Y_REG_H] ||
+     a->yychoice[YYCHOICE_Y_REG_L] != b->yychoice[YYCHOICE_Y_REG_L]) { *what = "FRC_REG or Y_REG"; return 1; }
+  return 0;
+}
+
+static int check_programs(int programs, uint8 *rama, uint8 *ramb) {
+  uint32 size = yam_get_state_size(2);
+  struct YAM_STATE *a = malloc(size);
+  struct YAM_STATE *b = malloc(size);
+  int t, i, s, failures = 0;
+
+  if(!a || !b) { printf("out of memory\n"); exit(1); }
+
+  for(t = 0; t < programs; t++) {
+    int aica = t & 1;
+    const char *what = NULL;
+
+    yam_clear_state(b, aica ? 2 : 1);
+    yam_prepare_dynacode(b);
+    for(i = 0; i < 128; i++) {
+      uint64 v = rnd64();
+      // some steps do nothing
+      if((rnd() & 15) == 0) v = 0;
+      if(aica) mpro_aica_write(b->mpro + i, v); else mpro_scsp_write(b->mpro + i, v);
+      b->coef[i] = (sint16)(rnd() & 0x1FFF) - 0x1000;
+      b->temp[i] = rnd24();
+    }
+    for(i = 0; i < 64; i++) b->madrs[i] = rnd();
+    for(i = 0; i < 0x32; i++) b->inputs[i] = rnd24();
+    for(i = 0; i < 4; i++) { b->mem_in_data[i] = rnd24(); b->yychoice[i] = rnd() & 0xFFF; }
+    b->xzbchoice[XZBCHOICE_ACC] = ((sint32)(rnd64() << 6)) >> 6;
+    b->adrs_reg = rnd() & 0xFFF;
+    b->mdec_ct = rnd();
+    b->rbl = rnd() & 3;
+    b->rbp = (rnd() & 0xFF) << 13;
+    b->ram_mask = aica ? 0x1FFFFF : 0x7FFFF;
+    b->mem_word_address_xor = (t & 2) ? 2 : 0;
+    b->dsp_dyna_enabled = 1;
+    b->dsp_dyna_valid = 0;
+    // the DSP can only reach RAM through ram_mask
+    for(i = 0; i <= (int)b->ram_mask; i++) ramb[i] = rnd();
+    memcpy(rama, ramb, b->ram_mask + 1);
+    memcpy(a, b, size);
+    a->ram_ptr = rama;
+    b->ram_ptr = ramb;
+
+    for(s = 0; s < 64; s++) {
+      dsp_sample_interpret(a);
+      if(!b->dsp_dyna_valid) dynacompile(b);
+      ((dsp_sample_t)(b->dynacode + DYNACODE_SLOP_SIZE))(b);
+      if(compare_state(a, b, &what) || memcmp(rama, ramb, b->ram_mask + 1)) {
+        printf("  %s program %d differs in %s after sample %d\n",
+          aica ? "AICA" : "SCSP", t, what ? what : "RAM", s);
+        failures++;
+        break;
+      }
+      a->mdec_ct = (a->mdec_ct - 1) & 0xFFFF;
+      b->mdec_ct = (b->mdec_ct - 1) & 0xFFFF;
+    }
+    yam_unprepare_dynacode(b);
+  }
+
+  free(a);
+  free(b);
+  return failures;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Whole renders
+//
+
+static int check_renders(int renders, uint8 *rama, uint8 *ramb) {
+  uint32 samples = 44100 * 2;
+  sint16 *pcma = malloc(samples * 4);
+  sint16 *pcmb = malloc(samples * 4);
+  int r, failures = 0;
+
+  if(!pcma || !pcmb) { printf("out of memory\n"); exit(1); }
+
+  for(r = 0; r < renders; r++) {
+    uint8 version = (r & 1) ? 2 : 1;
+    struct YAM_STATE *a = yam_dsp_setup(version, r + 1, rama, 0);
+    struct YAM_STATE *b = yam_dsp_setup(version, r + 1, ramb, 1);
+    uint32 i, loud = 0;
+
+    yam_dsp_render(a, pcma, samples);
+    yam_dsp_render(b, pcmb, samples);
+
+    for(i = 0; i < samples * 2; i++) {
+      if(pcma[i] != pcmb[i]) break;
+      if(pcma[i]) loud++;
+    }
+    if(i < samples * 2) {
+      printf("  %s render %d differs at sample %u\n", version == 2 ? "AICA" : "SCSP", r, i / 2);
+      failures++;
+    } else if(!loud) {
+      printf("  %s render %d is silent\n", version == 2 ? "AICA" : "SCSP", r);
+      failures++;
+    }
+
+    yam_dsp_teardown(a);
+    yam_dsp_teardown(b);
+  }
+
+  free(pcma);
+  free(pcmb);
+  return failures;
+}
+
+int main(int argc, char **argv) {
+  int programs = argc > 1 ? atoi(argv[1]) : 1000;
+  int renders = argc > 2 ? atoi(argv[2]) : 10;
+  uint8 *rama = malloc(RAMSIZE);
+  uint8 *ramb = malloc(RAMSIZE);
+  int failures;
+
+  if(!rama || !ramb) { printf("out of memory\n"); return 1; }
+
+  yam_init();
+
+  failures = check_programs(programs, rama, ramb);
+  printf("%d random programs: %d differ\n", programs, failures);
+  if(renders > 0) {
+    int f = check_renders(renders, rama, ramb);
+    printf("%d renders of 2 s: %d differ\n", renders, f);
+    failures += f;
+  }
+
+  free(rama);
+  free(ramb);
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures != 0;
+}
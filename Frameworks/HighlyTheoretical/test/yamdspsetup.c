@@ -0,0 +1,104 @@
+/////////////////////////////////////////////////////////////////////////////
+//
+// yamdspsetup - random chips for checking and timing the effects DSP
+//
+/////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+
+#include "../HighlyTheoretical/Core/yam.h"
+#include "yamdspsetup.h"
+
+static uint32 setup_seed;
+
+static uint32 rnd(void) {
+  setup_seed = setup_seed * 1103515245 + 12345;
+  return (setup_seed >> 8) & 0xFFFF;
+}
+
+static void setup_scsp(void *state) {
+  uint32 ch, a, i, play0 = 0;
+  for(ch = 0; ch < 32; ch++) {
+    for(a = 0; a < 0x18; a += 2) {
+      uint32 d = rnd();
+      // key on bit set, key on execute clear until the end
+      if(a == 0) { d = (d & ~0x1000) | 0x0800; if(!ch) { play0 = d; } }
+      yam_scsp_store_reg(state, ch * 0x20 + a, d, 0xFFFF, NULL);
+    }
+  }
+  yam_scsp_store_reg(state, 0x400, 0x000F, 0xFFFF, NULL);
+  yam_scsp_store_reg(state, 0x402, rnd(), 0xFFFF, NULL);
+  for(i = 0; i < 64; i++) { yam_scsp_store_reg(state, 0x700 + 2 * i, rnd(), 0xFFFF, NULL); }
+  for(i = 0; i < 32; i++) { yam_scsp_store_reg(state, 0x780 + 2 * i, rnd(), 0xFFFF, NULL); }
+  for(i = 0; i < 128; i++) {
+    // some steps do nothing
+    int nop = (rnd() & 15) == 0;
+    for(a = 0; a < 8; a += 2) {
+      yam_scsp_store_reg(state, 0x800 + 8 * i + a, nop ? 0 : rnd(), 0xFFFF, NULL);
+    }
+  }
+  yam_scsp_store_reg(state, 0x000, play0 | 0x1000, 0xFFFF, NULL);
+}
+
+static void setup_aica(void *state) {
+  uint32 ch, a, i, play0 = 0;
+  for(ch = 0; ch < 64; ch++) {
+    for(a = 0; a < 0x48; a += 4) {
+      uint32 d = rnd();
+      if(a == 0) { d = (d & ~0x8000) | 0x4000; if(!ch) { play0 = d; } }
+      yam_aica_store_reg(state, ch * 0x80 + a, d, 0xFFFF, NULL);
+    }
+  }
+  for(i = 0; i < 18; i++) { yam_aica_store_reg(state, 0x2000 + 4 * i, rnd(), 0xFFFF, NULL); }
+  yam_aica_store_reg(state, 0x2800, 0x000F, 0xFFFF, NULL);
+  yam_aica_store_reg(state, 0x2804, rnd(), 0xFFFF, NULL);
+  for(i = 0; i < 128; i++) { yam_aica_store_reg(state, 0x3000 + 4 * i, rnd(), 0xFFFF, NULL); }
+  for(i = 0; i < 64; i++) { yam_aica_store_reg(state, 0x3200 + 4 * i, rnd(), 0xFFFF, NULL); }
+  for(i = 0; i < 128; i++) {
+    int nop = (rnd() & 15) == 0;
+    for(a = 0; a < 16; a += 4) {
+      yam_aica_store_reg(state, 0x3400 + 16 * i + a, nop ? 0 : rnd(), 0xFFFF, NULL);
+    }
+  }
+  yam_aica_store_reg(state, 0x0000, play0 | 0x8000, 0xFFFF, NULL);
+}
+
+void *yam_dsp_setup(uint8 version, uint32 seed, uint8 *ram, int dynarec) {
+  void *state = malloc(yam_get_state_size(version));
+  uint32 i;
+
+  if(!state) { return NULL; }
+  setup_seed = seed;
+
+  for(i = 0; i < 0x800000; i++) { ram[i] = rnd(); }
+
+  yam_clear_state(state, version);
+  // as satsound.c and dcsound.c map the sound RAM
+  if(version == 2) {
+    yam_setram(state, (uint32*)ram, 0x800000, EMU_ENDIAN_XOR(3), EMU_ENDIAN_XOR(2));
+  } else {
+    yam_setram(state, (uint32*)ram, 0x80000, EMU_ENDIAN_XOR(1) ^ 1, 0);
+  }
+  yam_enable_dry(state, 0);
+  yam_enable_dsp(state, 1);
+  yam_enable_dsp_dynarec(state, dynarec);
+  if(dynarec) { yam_prepare_dynacode(state); }
+
+  if(version == 2) { setup_aica(state); } else { setup_scsp(state); }
+  return state;
+}
+
+void yam_dsp_render(void *state, sint16 *buf, uint32 samples) {
+  yam_beginbuffer(state, buf);
+  while(samples) {
+    uint32 n = samples < 441 ? samples : 441;
+    yam_advance(state, n);
+    yam_flush(state);
+    samples -= n;
+  }
+}
+
+void yam_dsp_teardown(void *state) {
+  yam_unprepare_dynacode(state);
+  free(state);
+}
@@ -0,0 +1,26 @@
+/////////////////////////////////////////////////////////////////////////////
+//
+// yamdspsetup - random chips for checking and timing the effects DSP
+//
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __YAMDSPSETUP_H__
+#define __YAMDSPSETUP_H__
+
+#include "../HighlyTheoretical/Core/emuconfig.h"
+
+//
+// Makes a new SCSP (version 1) or AICA (version 2) state over ram, which
+// must hold 8MB, and programs it through its registers as a driver would:
+// random slots all keyed on, a random effect program, coefficients and
+// addresses, and random RAM for the samples and the ring buffer. The dry
+// output is off, so everything rendered came through the DSP.
+//
+// The same version and seed always give the same chip. With dynarec set the
+// DSP is compiled, otherwise it is interpreted.
+//
+void *yam_dsp_setup(uint8 version, uint32 seed, uint8 *ram, int dynarec);
+void yam_dsp_render(void *state, sint16 *buf, uint32 samples);
+void yam_dsp_teardown(void *state);
+
+#endif
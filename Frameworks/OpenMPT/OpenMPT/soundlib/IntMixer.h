@@ -17,6 +17,21 @@
 #include "MixerInterface.h"
 #include "Paula.h"
 
+// SIMD variants of the 8-tap interpolation and volume ramping functors, see below
+#if defined(ENABLE_SSE2) || defined(__SSE2__) || defined(_M_X64)
+#define MPT_INTMIXER_SSE2
+#include <emmintrin.h>
+#if (MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && (defined(__x86_64__) || defined(__i386__))
+// Compiled through target attributes and only chosen when the CPU has AVX2, see MixFuncTable::GetFunctions()
+#define MPT_INTMIXER_AVX2
+#define MPT_INTMIXER_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define MPT_INTMIXER_NEON
+#include <arm_neon.h>
+#endif
+
 OPENMPT_NAMESPACE_BEGIN
 
 template<int channelsOut, int channelsIn, typename out, typename in, size_t mixPrecision>
@@ -390,4 +405,370 @@ struct ResonantFilter
 };
 
 
+//////////////////////////////////////////////////////////////////////////
+// SIMD variants
+//
+// These produce the exact same output as their scalar counterparts above:
+// The 16x16 bit products and their sums wrap around in 32 bits just like the
+// scalar code does, and divisions round towards zero. The tolerance to the
+// scalar mixer is therefore zero; if you change anything here, compare the
+// output of both mix function tables sample by sample.
+// Only 16-bit mix precision is supported, i.e. Convert() must turn 8-bit
+// samples into x * 256, which still fits into 16 bits.
+
+#if defined(MPT_INTMIXER_SSE2) || defined(MPT_INTMIXER_NEON)
+#define MPT_INTMIXER_SIMD
+#endif
+
+#ifdef MPT_INTMIXER_SSE2
+
+// Load 8 samples scaled to 16 bits
+static MPT_FORCEINLINE __m128i LoadSamplesSSE2(const int16 *p)
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+static MPT_FORCEINLINE __m128i LoadSamplesSSE2(const int8 *p)
+{
+	return _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+}
+
+// Reorder 4 interleaved stereo sampling points to LLLLRRRR
+static MPT_FORCEINLINE void DeinterleaveSSE2(__m128i &x)
+{
+	x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 1, 2, 0));
+	x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(3, 1, 2, 0));
+	x = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+// Load 8 stereo sampling points, split into the first and last 4 points
+static MPT_FORCEINLINE void LoadStereoSamplesSSE2(const int16 *p, __m128i &first, __m128i &last)
+{
+	first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+	last = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8));
+	DeinterleaveSSE2(first);
+	DeinterleaveSSE2(last);
+}
+
+static MPT_FORCEINLINE void LoadStereoSamplesSSE2(const int8 *p, __m128i &first, __m128i &last)
+{
+	const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+	first = _mm_unpacklo_epi8(_mm_setzero_si128(), x);
+	last = _mm_unpackhi_epi8(_mm_setzero_si128(), x);
+	DeinterleaveSSE2(first);
+	DeinterleaveSSE2(last);
+}
+
+// x / (1 << shift), rounding towards zero
+template<int shift>
+static MPT_FORCEINLINE __m128i DivPow2SSE2(const __m128i x)
+{
+	const __m128i bias = _mm_srli_epi32(_mm_srai_epi32(x, 31), 32 - shift);
+	return _mm_srai_epi32(_mm_add_epi32(x, bias), shift);
+}
+
+#endif // MPT_INTMIXER_SSE2
+
+
+#ifdef MPT_INTMIXER_SIMD
+
+template<class Traits>
+struct FIRFilterInterpolationSIMD : public FIRFilterInterpolation<Traits>
+{
+	typedef FIRFilterInterpolation<Traits> base_t;
+
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= 2, "Too many input channels");
+		static_assert(WFIR_WIDTH == 8 && sizeof(WFIR_TYPE) == sizeof(int16), "SIMD FIR filter requires 8 16-bit taps");
+		const int16 * const lut = base_t::WFIRlut + ((((posLo >> 16) + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+
+#if defined(MPT_INTMIXER_SSE2)
+		const __m128i taps = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut));
+		__m128i vol;
+		if(Traits::numChannelsIn == 1)
+		{
+			// [0+1, 2+3, 4+5, 6+7] => [vol1, vol1, vol2, vol2]
+			vol = _mm_madd_epi16(LoadSamplesSSE2(inBuffer - 3), taps);
+			vol = _mm_add_epi32(vol, _mm_shuffle_epi32(vol, _MM_SHUFFLE(2, 3, 0, 1)));
+			vol = DivPow2SSE2<1>(vol);
+			vol = _mm_add_epi32(vol, _mm_shuffle_epi32(vol, _MM_SHUFFLE(1, 0, 3, 2)));
+		} else
+		{
+			__m128i first, last;
+			LoadStereoSamplesSSE2(inBuffer - 6, first, last);
+			// [L0+1, L2+3, R0+1, R2+3] and [L4+5, L6+7, R4+5, R6+7]
+			first = _mm_madd_epi16(first, _mm_unpacklo_epi64(taps, taps));
+			last = _mm_madd_epi16(last, _mm_unpackhi_epi64(taps, taps));
+			// [vol1 L, vol2 L, vol1 R, vol2 R]
+			const __m128i lo = _mm_unpacklo_epi32(first, last), hi = _mm_unpackhi_epi32(first, last);
+			vol = _mm_add_epi32(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+			vol = DivPow2SSE2<1>(vol);
+			vol = _mm_add_epi32(vol, _mm_shuffle_epi32(vol, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
+		vol = DivPow2SSE2<WFIR_16BITSHIFT - 1>(vol);
+		outSample[0] = _mm_cvtsi128_si32(vol);
+		if(Traits::numChannelsIn == 2)
+			outSample[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(vol, _MM_SHUFFLE(2, 2, 2, 2)));
+#elif defined(MPT_INTMIXER_NEON)
+		const int16x8_t taps = vld1q_s16(lut);
+		int16x8_t smp[2];
+		if(Traits::numChannelsIn == 1)
+		{
+			smp[0] = (sizeof(typename Traits::input_t) == 1)
+				? vshll_n_s8(vld1_s8(reinterpret_cast<const int8 *>(inBuffer - 3)), 8)
+				: vld1q_s16(reinterpret_cast<const int16 *>(inBuffer - 3));
+		} else if(sizeof(typename Traits::input_t) == 1)
+		{
+			const int8x8x2_t x = vld2_s8(reinterpret_cast<const int8 *>(inBuffer - 6));
+			smp[0] = vshll_n_s8(x.val[0], 8);
+			smp[1] = vshll_n_s8(x.val[1], 8);
+		} else
+		{
+			const int16x8x2_t x = vld2q_s16(reinterpret_cast<const int16 *>(inBuffer - 6));
+			smp[0] = x.val[0];
+			smp[1] = x.val[1];
+		}
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			const int32 vol1 = vaddvq_s32(vmull_s16(vget_low_s16(smp[i]), vget_low_s16(taps)));
+			const int32 vol2 = vaddvq_s32(vmull_s16(vget_high_s16(smp[i]), vget_high_s16(taps)));
+			outSample[i] = ((vol1 / 2) + (vol2 / 2)) / (1 << (WFIR_16BITSHIFT - 1));
+		}
+#endif
+	}
+};
+
+
+template<class Traits>
+struct PolyphaseInterpolationSIMD : public PolyphaseInterpolation<Traits>
+{
+	typedef PolyphaseInterpolation<Traits> base_t;
+
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= 2, "Too many input channels");
+		static_assert(SINC_WIDTH == 8 && sizeof(SINC_TYPE) == sizeof(int16), "SIMD polyphase filter requires 8 16-bit taps");
+		const int16 * const lut = base_t::sinc + ((posLo >> (32 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+
+#if defined(MPT_INTMIXER_SSE2)
+		const __m128i taps = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut));
+		__m128i vol;
+		if(Traits::numChannelsIn == 1)
+		{
+			// [0+1, 2+3, 4+5, 6+7] => [vol, vol, vol, vol]
+			vol = _mm_madd_epi16(LoadSamplesSSE2(inBuffer - 3), taps);
+			vol = _mm_add_epi32(vol, _mm_shuffle_epi32(vol, _MM_SHUFFLE(2, 3, 0, 1)));
+			vol = _mm_add_epi32(vol, _mm_shuffle_epi32(vol, _MM_SHUFFLE(1, 0, 3, 2)));
+		} else
+		{
+			__m128i first, last;
+			LoadStereoSamplesSSE2(inBuffer - 6, first, last);
+			// [L0+1+4+5, L2+3+6+7, R0+1+4+5, R2+3+6+7] => [vol L, vol L, vol R, vol R]
+			vol = _mm_add_epi32(_mm_madd_epi16(first, _mm_unpacklo_epi64(taps, taps)), _mm_madd_epi16(last, _mm_unpackhi_epi64(taps, taps)));
+			vol = _mm_add_epi32(vol, _mm_shuffle_epi32(vol, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
+		vol = DivPow2SSE2<SINC_QUANTSHIFT>(vol);
+		outSample[0] = _mm_cvtsi128_si32(vol);
+		if(Traits::numChannelsIn == 2)
+			outSample[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(vol, _MM_SHUFFLE(2, 2, 2, 2)));
+#elif defined(MPT_INTMIXER_NEON)
+		const int16x8_t taps = vld1q_s16(lut);
+		int16x8_t smp[2];
+		if(Traits::numChannelsIn == 1)
+		{
+			smp[0] = (sizeof(typename Traits::input_t) == 1)
+				? vshll_n_s8(vld1_s8(reinterpret_cast<const int8 *>(inBuffer - 3)), 8)
+				: vld1q_s16(reinterpret_cast<const int16 *>(inBuffer - 3));
+		} else if(sizeof(typename Traits::input_t) == 1)
+		{
+			const int8x8x2_t x = vld2_s8(reinterpret_cast<const int8 *>(inBuffer - 6));
+			smp[0] = vshll_n_s8(x.val[0], 8);
+			smp[1] = vshll_n_s8(x.val[1], 8);
+		} else
+		{
+			const int16x8x2_t x = vld2q_s16(reinterpret_cast<const int16 *>(inBuffer - 6));
+			smp[0] = x.val[0];
+			smp[1] = x.val[1];
+		}
+		for(int i = 0; i < Traits::numChannelsIn; i++)
+		{
+			const int32x4_t vol = vmlal_s16(vmull_s16(vget_low_s16(smp[i]), vget_low_s16(taps)), vget_high_s16(smp[i]), vget_high_s16(taps));
+			outSample[i] = vaddvq_s32(vol) / (1 << SINC_QUANTSHIFT);
+		}
+#endif
+	}
+};
+
+
+// Volume ramping with both channels in one vector
+struct RampSIMD : public Ramp
+{
+#if defined(MPT_INTMIXER_SSE2)
+	// [left, unused, right, unused], as _mm_mul_epu32 only multiplies the even lanes
+	__m128i ramp, delta;
+
+	MPT_FORCEINLINE void Start(const ModChannel &chn)
+	{
+		ramp = _mm_set_epi32(0, chn.rampRightVol, 0, chn.rampLeftVol);
+		delta = _mm_set_epi32(0, chn.rightRamp, 0, chn.leftRamp);
+	}
+
+	MPT_FORCEINLINE void End(ModChannel &chn)
+	{
+		lRamp = _mm_cvtsi128_si32(ramp);
+		rRamp = _mm_cvtsi128_si32(_mm_shuffle_epi32(ramp, _MM_SHUFFLE(2, 2, 2, 2)));
+		Ramp::End(chn);
+	}
+
+	MPT_FORCEINLINE void Mix(const __m128i smp, mixsample_t * const MPT_RESTRICT outBuffer)
+	{
+		ramp = _mm_add_epi32(ramp, delta);
+		// The low 32 bits of the unsigned product are the same as for the signed product
+		__m128i out = _mm_mul_epu32(smp, _mm_srai_epi32(ramp, VOLUMERAMPPRECISION));
+		out = _mm_shuffle_epi32(out, _MM_SHUFFLE(2, 2, 2, 0));
+		out = _mm_add_epi32(out, _mm_loadl_epi64(reinterpret_cast<const __m128i *>(outBuffer)));
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(outBuffer), out);
+	}
+#elif defined(MPT_INTMIXER_NEON)
+	int32x2_t ramp, delta;
+
+	MPT_FORCEINLINE void Start(const ModChannel &chn)
+	{
+		const int32 r[2] = { chn.rampLeftVol, chn.rampRightVol }, d[2] = { chn.leftRamp, chn.rightRamp };
+		ramp = vld1_s32(r);
+		delta = vld1_s32(d);
+	}
+
+	MPT_FORCEINLINE void End(ModChannel &chn)
+	{
+		lRamp = vget_lane_s32(ramp, 0);
+		rRamp = vget_lane_s32(ramp, 1);
+		Ramp::End(chn);
+	}
+
+	MPT_FORCEINLINE void Mix(const int32x2_t smp, mixsample_t * const MPT_RESTRICT outBuffer)
+	{
+		ramp = vadd_s32(ramp, delta);
+		vst1_s32(outBuffer, vmla_s32(vld1_s32(outBuffer), smp, vshr_n_s32(ramp, VOLUMERAMPPRECISION)));
+	}
+#endif
+};
+
+
+template<class Traits>
+struct MixMonoRampSIMD : public RampSIMD
+{
+	MPT_FORCEINLINE void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &, typename Traits::output_t * const MPT_RESTRICT outBuffer)
+	{
+#if defined(MPT_INTMIXER_SSE2)
+		Mix(_mm_set1_epi32(outSample[0]), outBuffer);
+#elif defined(MPT_INTMIXER_NEON)
+		Mix(vdup_n_s32(outSample[0]), outBuffer);
+#endif
+	}
+};
+
+
+template<class Traits>
+struct MixStereoRampSIMD : public RampSIMD
+{
+	MPT_FORCEINLINE void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &, typename Traits::output_t * const MPT_RESTRICT outBuffer)
+	{
+#if defined(MPT_INTMIXER_SSE2)
+		Mix(_mm_set_epi32(0, outSample[1], 0, outSample[0]), outBuffer);
+#elif defined(MPT_INTMIXER_NEON)
+		Mix(vld1_s32(outSample), outBuffer);
+#endif
+	}
+};
+
+#endif // MPT_INTMIXER_SIMD
+
+
+#ifdef MPT_INTMIXER_AVX2
+
+// Stereo input only: All 8 sampling points of both channels are read and multiplied at once.
+// Mono input uses the SSE2 code, which already needs only one multiplication.
+// The functors are not force-inlined, as they cannot be inlined into functions compiled without AVX2.
+// The mixer loops using them are flattened instead, see SampleLoopAVX2 in MixFuncTable.cpp.
+
+// Load 8 stereo sampling points as [L0-3, R0-3 | L4-7, R4-7]
+static MPT_FORCEINLINE MPT_INTMIXER_AVX2_TARGET __m256i LoadStereoSamplesAVX2(const int16 *p)
+{
+	const __m256i order = _mm256_setr_epi8(
+		0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+		0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+	return _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), order);
+}
+
+static MPT_FORCEINLINE MPT_INTMIXER_AVX2_TARGET __m256i LoadStereoSamplesAVX2(const int8 *p)
+{
+	const __m256i order = _mm256_setr_epi8(
+		0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+		0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+	const __m256i x = _mm256_slli_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))), 8);
+	return _mm256_shuffle_epi8(x, order);
+}
+
+// Multiply 8 stereo sampling points with 8 taps, giving [vol1 L, vol1 R, ...] and [vol2 L, vol2 R, ...] for taps 0-3 and 4-7
+template<typename input_t>
+static MPT_FORCEINLINE MPT_INTMIXER_AVX2_TARGET void MulStereoAVX2(const input_t *p, const int16 *lut, __m128i &vol1, __m128i &vol2)
+{
+	// [t0-3, t0-3 | t4-7, t4-7]
+	const __m256i taps = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lut))), _MM_SHUFFLE(1, 1, 0, 0));
+	// [L0+1, L2+3, R0+1, R2+3 | L4+5, L6+7, R4+5, R6+7] => [L0-3, R0-3, ... | L4-7, R4-7, ...]
+	__m256i vol = _mm256_madd_epi16(LoadStereoSamplesAVX2(p), taps);
+	vol = _mm256_hadd_epi32(vol, vol);
+	vol1 = _mm256_castsi256_si128(vol);
+	vol2 = _mm256_extracti128_si256(vol, 1);
+}
+
+
+template<class Traits>
+struct FIRFilterInterpolationAVX2 : public FIRFilterInterpolationSIMD<Traits>
+{
+	typedef FIRFilterInterpolationSIMD<Traits> base_t;
+
+	MPT_INTMIXER_AVX2_TARGET void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		if(Traits::numChannelsIn == 1)
+		{
+			base_t::operator()(outSample, inBuffer, posLo);
+			return;
+		}
+		const int16 * const lut = base_t::WFIRlut + ((((posLo >> 16) + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+		__m128i vol1, vol2;
+		MulStereoAVX2(inBuffer - 6, lut, vol1, vol2);
+		const __m128i vol = DivPow2SSE2<WFIR_16BITSHIFT - 1>(_mm_add_epi32(DivPow2SSE2<1>(vol1), DivPow2SSE2<1>(vol2)));
+		outSample[0] = _mm_cvtsi128_si32(vol);
+		outSample[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(vol, _MM_SHUFFLE(1, 1, 1, 1)));
+	}
+};
+
+
+template<class Traits>
+struct PolyphaseInterpolationAVX2 : public PolyphaseInterpolationSIMD<Traits>
+{
+	typedef PolyphaseInterpolationSIMD<Traits> base_t;
+
+	MPT_INTMIXER_AVX2_TARGET void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		if(Traits::numChannelsIn == 1)
+		{
+			base_t::operator()(outSample, inBuffer, posLo);
+			return;
+		}
+		const int16 * const lut = base_t::sinc + ((posLo >> (32 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+		__m128i vol1, vol2;
+		MulStereoAVX2(inBuffer - 6, lut, vol1, vol2);
+		const __m128i vol = DivPow2SSE2<SINC_QUANTSHIFT>(_mm_add_epi32(vol1, vol2));
+		outSample[0] = _mm_cvtsi128_si32(vol);
+		outSample[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(vol, _MM_SHUFFLE(1, 1, 1, 1)));
+	}
+};
+
+#endif // MPT_INTMIXER_AVX2
+
+
 OPENMPT_NAMESPACE_END
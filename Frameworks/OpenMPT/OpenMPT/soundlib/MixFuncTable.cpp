@@ -48,31 +48,105 @@ namespace MixFuncTable
 	SampleLoop<I16S, resampling<I16S>, filter<I16S>, MixStereo ## ramp<I16S> >
 
 // Build mix function table for given resampling, filter settings: With and without ramping
-#define BuildMixFuncTableFilter(resampling, filter) \
+#define BuildMixFuncTableFilter(resampling, filter, ramp) \
 	BuildMixFuncTableRamp(resampling, filter, NoRamp), \
-	BuildMixFuncTableRamp(resampling, filter, Ramp)
+	BuildMixFuncTableRamp(resampling, filter, ramp)
 
 // Build mix function table for given resampling settings: With and without filter
-#define BuildMixFuncTable(resampling) \
-	BuildMixFuncTableFilter(resampling, NoFilter), \
-	BuildMixFuncTableFilter(resampling, ResonantFilter)
+#define BuildMixFuncTable(resampling, ramp) \
+	BuildMixFuncTableFilter(resampling, NoFilter, ramp), \
+	BuildMixFuncTableFilter(resampling, ResonantFilter, ramp)
 
 const MixFuncInterface Functions[6 * 16] =
 {
-	BuildMixFuncTable(NoInterpolation),			// No SRC
-	BuildMixFuncTable(LinearInterpolation),		// Linear SRC
-	BuildMixFuncTable(FastSincInterpolation),	// Fast Sinc (Cubic Spline) SRC
-	BuildMixFuncTable(PolyphaseInterpolation),	// Kaiser SRC
-	BuildMixFuncTable(FIRFilterInterpolation),	// FIR SRC
-	BuildMixFuncTable(AmigaBlepInterpolation),	// Amiga emulation
+	BuildMixFuncTable(NoInterpolation, Ramp),			// No SRC
+	BuildMixFuncTable(LinearInterpolation, Ramp),		// Linear SRC
+	BuildMixFuncTable(FastSincInterpolation, Ramp),		// Fast Sinc (Cubic Spline) SRC
+	BuildMixFuncTable(PolyphaseInterpolation, Ramp),	// Kaiser SRC
+	BuildMixFuncTable(FIRFilterInterpolation, Ramp),	// FIR SRC
+	BuildMixFuncTable(AmigaBlepInterpolation, Ramp),	// Amiga emulation
 };
 
+#ifdef MPT_INTMIXER_SIMD
+// Same as above, with SIMD versions of the 8-tap SRCs and volume ramping. The output is identical.
+static const MixFuncInterface FunctionsSIMD[6 * 16] =
+{
+	BuildMixFuncTable(NoInterpolation, RampSIMD),
+	BuildMixFuncTable(LinearInterpolation, RampSIMD),
+	BuildMixFuncTable(FastSincInterpolation, RampSIMD),
+	BuildMixFuncTable(PolyphaseInterpolationSIMD, RampSIMD),
+	BuildMixFuncTable(FIRFilterInterpolationSIMD, RampSIMD),
+	BuildMixFuncTable(AmigaBlepInterpolation, RampSIMD),
+};
+#endif // MPT_INTMIXER_SIMD
+
+#ifdef MPT_INTMIXER_AVX2
+// The whole sample loop is compiled for AVX2, so that the AVX2 interpolation functors can be inlined into it.
+template<class Traits, class InterpolationFunc, class FilterFunc, class MixFunc>
+static MPT_INTMIXER_AVX2_TARGET __attribute__((flatten)) void SampleLoopAVX2(ModChannel &chn, const CResampler &resampler, typename Traits::output_t * MPT_RESTRICT outBuffer, unsigned int numSamples)
+{
+	SampleLoop<Traits, InterpolationFunc, FilterFunc, MixFunc>(chn, resampler, outBuffer, numSamples);
+}
+
+#define BuildMixFuncTableRampAVX2(resampling, filter, ramp) \
+	SampleLoopAVX2<I8M, resampling<I8M>, filter<I8M>, MixMono ## ramp<I8M> >, \
+	SampleLoopAVX2<I16M, resampling<I16M>, filter<I16M>, MixMono ## ramp<I16M> >, \
+	SampleLoopAVX2<I8S, resampling<I8S>, filter<I8S>, MixStereo ## ramp<I8S> >, \
+	SampleLoopAVX2<I16S, resampling<I16S>, filter<I16S>, MixStereo ## ramp<I16S> >
+
+#define BuildMixFuncTableFilterAVX2(resampling, filter, ramp) \
+	BuildMixFuncTableRampAVX2(resampling, filter, NoRamp), \
+	BuildMixFuncTableRampAVX2(resampling, filter, ramp)
+
+#define BuildMixFuncTableAVX2(resampling, ramp) \
+	BuildMixFuncTableFilterAVX2(resampling, NoFilter, ramp), \
+	BuildMixFuncTableFilterAVX2(resampling, ResonantFilter, ramp)
+
+// Same as FunctionsSIMD, with AVX2 versions of the 8-tap SRCs for stereo samples. The output is identical.
+static const MixFuncInterface FunctionsAVX2[6 * 16] =
+{
+	BuildMixFuncTable(NoInterpolation, RampSIMD),
+	BuildMixFuncTable(LinearInterpolation, RampSIMD),
+	BuildMixFuncTable(FastSincInterpolation, RampSIMD),
+	BuildMixFuncTableAVX2(PolyphaseInterpolationAVX2, RampSIMD),
+	BuildMixFuncTableAVX2(FIRFilterInterpolationAVX2, RampSIMD),
+	BuildMixFuncTable(AmigaBlepInterpolation, RampSIMD),
+};
+
+#undef BuildMixFuncTableRampAVX2
+#undef BuildMixFuncTableFilterAVX2
+#undef BuildMixFuncTableAVX2
+#endif // MPT_INTMIXER_AVX2
+
 
 #undef BuildMixFuncTableRamp
 #undef BuildMixFuncTableFilter
 #undef BuildMixFuncTable
 
 
+const MixFuncInterface *GetFunctions()
+{
+#ifdef MPT_INTMIXER_SIMD
+#ifdef ENABLE_SSE2
+	if(!(GetProcSupport() & PROCSUPPORT_SSE2))
+	{
+		return Functions;
+	}
+#endif // ENABLE_SSE2
+#ifdef MPT_INTMIXER_AVX2
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+	if(hasAVX2)
+	{
+		return FunctionsAVX2;
+	}
+#endif // MPT_INTMIXER_AVX2
+	return FunctionsSIMD;
+#else
+	return Functions;
+#endif // MPT_INTMIXER_SIMD
+}
+
+
 ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode)
 {
 	switch(resamplingMode)
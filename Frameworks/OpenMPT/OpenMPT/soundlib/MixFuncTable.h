@@ -46,6 +46,9 @@ namespace MixFuncTable
 
 	extern const MixFuncInterface Functions[6 * 16];
 
+	// Returns the mix function table to use on this CPU (Functions or an equivalent SIMD table)
+	const MixFuncInterface *GetFunctions();
+
 	ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode);
 }
 
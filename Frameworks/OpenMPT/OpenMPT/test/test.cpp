@@ -33,6 +33,8 @@
 #include "../soundlib/tuningcollection.h"
 #include "../soundlib/tuning.h"
 #include "../soundlib/Dither.h"
+#include "../soundlib/MixFuncTable.h"
+#include "../soundlib/ModChannel.h"
 #ifdef MODPLUG_TRACKER
 #include "../mptrack/Mptrack.h"
 #include "../mptrack/Moddoc.h"
@@ -106,6 +108,7 @@ static MPT_NOINLINE void TestSettings();
 static MPT_NOINLINE void TestStringIO();
 static MPT_NOINLINE void TestMIDIEvents();
 static MPT_NOINLINE void TestSampleConversion();
+static MPT_NOINLINE void TestMixFuncTables();
 static MPT_NOINLINE void TestITCompression();
 static MPT_NOINLINE void TestTunings();
 static MPT_NOINLINE void TestPCnoteSerialization();
@@ -206,6 +209,7 @@ void DoTests()
 	DO_TEST(TestStringIO);
 	DO_TEST(TestMIDIEvents);
 	DO_TEST(TestSampleConversion);
+	DO_TEST(TestMixFuncTables);
 	DO_TEST(TestITCompression);
 	DO_TEST(TestTunings);
 
@@ -4794,6 +4798,74 @@ static MPT_NOINLINE void TestSampleConversion()
 	}
 }
 
+// The mix function table chosen for this CPU must produce the same output as the generic one
+static MPT_NOINLINE void TestMixFuncTables()
+{
+#ifdef MPT_INTMIXER
+	const MixFuncInterface *functions = MixFuncTable::GetFunctions();
+	if(functions == MixFuncTable::Functions)
+	{
+		return;
+	}
+
+	CResampler resampler;
+	mpt::default_prng & prng = *s_PRNG;
+
+	// Random sample data with enough room for the interpolation taps on both sides
+	const unsigned int numFrames = 256;
+	std::vector<int16> sampleData16((numFrames * 3 + 64) * 2);
+	std::vector<int8> sampleData8(sampleData16.size());
+	for(std::size_t i = 0; i < sampleData16.size(); i++)
+	{
+		sampleData16[i] = mpt::random<int16>(prng);
+		sampleData8[i] = mpt::random<int8>(prng);
+	}
+
+	// Upsampling, unity, and both downsampling filters of the polyphase SRC
+	const double speeds[] = { 0.3, 1.0, 1.25, 1.5, 2.75 };
+
+	for(int index = 0; index < 6 * 16; index++)
+	{
+		if((index & 0x70) == MixFuncTable::ndxAmigaBlep)
+		{
+			continue;
+		}
+		for(double speed : speeds)
+		{
+			ModChannel chn[2];
+			std::vector<mixsample_t> outBuffer[2];
+			for(int i = 0; i < 2; i++)
+			{
+				MemsetZero(chn[i].nFilter_Y);
+				chn[i].position = SamplePosition(16, 0x12345678);
+				chn[i].increment = SamplePosition::FromDouble(speed);
+				chn[i].pCurrentSample = (index & MixFuncTable::ndx16Bit) ? static_cast<const void *>(sampleData16.data()) : static_cast<const void *>(sampleData8.data());
+				chn[i].leftVol = 4096;
+				chn[i].rightVol = 1234;
+				chn[i].rampLeftVol = 1000 << VOLUMERAMPPRECISION;
+				chn[i].rampRightVol = 3000 << VOLUMERAMPPRECISION;
+				chn[i].leftRamp = 37;
+				chn[i].rightRamp = -29;
+				chn[i].nFilter_A0 = 1 << 22;
+				chn[i].nFilter_B0 = 3 << 23;
+				chn[i].nFilter_B1 = -(1 << 23);
+				chn[i].nFilter_HP = 0;
+				outBuffer[i].assign(numFrames * 2, 0);
+			}
+
+			MixFuncTable::Functions[index](chn[0], resampler, outBuffer[0].data(), numFrames);
+			functions[index](chn[1], resampler, outBuffer[1].data(), numFrames);
+
+			VERIFY_EQUAL_NONCONT(outBuffer[0] == outBuffer[1], true);
+			VERIFY_EQUAL_NONCONT(chn[0].position == chn[1].position, true);
+			VERIFY_EQUAL_NONCONT(memcmp(chn[0].nFilter_Y, chn[1].nFilter_Y, sizeof(chn[0].nFilter_Y)), 0);
+			VERIFY_EQUAL_NONCONT(chn[0].rampLeftVol, chn[1].rampLeftVol);
+			VERIFY_EQUAL_NONCONT(chn[0].rampRightVol, chn[1].rampRightVol);
+		}
+	}
+#endif // MPT_INTMIXER
+}
+
 
 } // namespace Test
 
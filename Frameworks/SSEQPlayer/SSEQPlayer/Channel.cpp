@@ -13,11 +13,22 @@
 
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <algorithm>
 #include <limits>
+#include <mutex>
+#include <vector>
 #include "Channel.h"
 #include "Player.h"
 #include "common.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SSEQ_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SSEQ_NEON
+#endif
+
 NDSSoundRegister::NDSSoundRegister() : volumeMul(0), volumeDiv(0), panning(0), waveDuty(0), repeatMode(0), format(0), enable(false),
 	source(nullptr), timer(0), psgX(0), psgLast(0), psgLastCount(0), samplePosition(0), sampleIncrease(0), loopStart(0), length(0), totalLength(0)
 {
@@ -44,10 +55,6 @@ TempSndReg::TempSndReg() : CR(0), SOURCE(nullptr), TIMER(0), REPEAT_POINT(0), LE
 {
 }
 
-bool Channel::initializedLUTs = false;
-double Channel::sinc_lut[Channel::SINC_SAMPLES + 1];
-double Channel::window_lut[Channel::SINC_SAMPLES + 1];
-
 #ifndef M_PI
 static const double M_PI = 3.14159265358979323846;
 #endif
@@ -88,20 +95,91 @@ static inline double sinc(double x)
 
 Channel::Channel() : chnId(-1), tempReg(), state(CS_NONE), trackId(-1), prio(0), manualSweep(false), flags(), pan(0), extAmpl(0), velocity(0), extPan(0),
 	key(0), ampl(0), extTune(0), orgKey(0), modType(0), modSpeed(0), modDepth(0), modRange(0), modDelay(0), modDelayCnt(0), modCounter(0),
-	sweepLen(0), sweepCnt(0), sweepPitch(0), attackLvl(0), sustainLvl(0x7F), decayRate(0), releaseRate(0xFFFF), noteLength(-1), vol(0), ply(nullptr), reg()
+	sweepLen(0), sweepCnt(0), sweepPitch(0), attackLvl(0), sustainLvl(0x7F), decayRate(0), releaseRate(0xFFFF), noteLength(-1), vol(0), ply(nullptr), reg(),
+	sincBank(), sincBankMix(0), sincBankIncrease(0)
 {
 	this->clearHistory();
-	if (!this->initializedLUTs)
+}
+
+/*
+ * Sample increases above 1 lower the cutoff. There is a bank for every
+ * quarter semitone up to 6 octaves, and a channel blends the two either
+ * side of its own cutoff.
+ */
+static const unsigned SINC_BANK_STEPS_PER_OCTAVE = 48;
+static const unsigned SINC_BANKS = SINC_BANK_STEPS_PER_OCTAVE * 6 + 1;
+
+static std::once_flag sincBankOnce[SINC_BANKS];
+static std::vector<float> sincBanks[SINC_BANKS];
+
+static inline double sincBankCutoff(unsigned bank)
+{
+	return std::exp2(-static_cast<double>(bank) / SINC_BANK_STEPS_PER_OCTAVE);
+}
+
+static void buildSincBank(std::vector<float> &bank, double cutoff)
+{
+	const int width = Channel::SINC_WIDTH, taps = width * 2, phases = Channel::SINC_PHASES;
+	std::vector<double> kernels((phases + 1) * taps);
+	for (int p = 0; p <= phases; ++p)
 	{
-		double dx = static_cast<double>(SINC_WIDTH) / SINC_SAMPLES, x = 0.0;
-		for (unsigned i = 0; i <= SINC_SAMPLES; ++i, x += dx)
+		// Tap j weighs data[j - 7], whose distance from the position is
+		// j - 7 - ratio
+		double ratio = static_cast<double>(p) / phases, sum = 0.0;
+		double *kernel = &kernels[p * taps];
+		for (int j = 0; j < taps; ++j)
 		{
-			double y = x / SINC_WIDTH;
-			this->sinc_lut[i] = std::abs(x) < SINC_WIDTH ? sinc(x) : 0.0;
-			this->window_lut[i] = (0.40897 + 0.5 * std::cos(M_PI * y) + 0.09103 * std::cos(2 * M_PI * y));
+			double x = ratio - (j - width + 1);
+			double window = 0.0;
+			if (std::abs(x) < width)
+			{
+				double y = x / width;
+				window = 0.40897 + 0.5 * std::cos(M_PI * y) + 0.09103 * std::cos(2 * M_PI * y);
+			}
+			sum += kernel[j] = sinc(x * cutoff) * window;
 		}
-		this->initializedLUTs = true;
+		for (int j = 0; j < taps; ++j)
+			kernel[j] /= sum;
 	}
+	bank.resize(phases * taps * 2);
+	for (int p = 0; p < phases; ++p)
+		for (int j = 0; j < taps; ++j)
+		{
+			bank[p * taps * 2 + j] = static_cast<float>(kernels[p * taps + j]);
+			bank[p * taps * 2 + taps + j] = static_cast<float>(kernels[(p + 1) * taps + j] - kernels[p * taps + j]);
+		}
+}
+
+const float *Channel::SincBank(unsigned bank)
+{
+	std::call_once(sincBankOnce[bank], [bank]
+	{
+		buildSincBank(sincBanks[bank], sincBankCutoff(bank));
+	});
+	return &sincBanks[bank][0];
+}
+
+void Channel::UpdateSincBanks()
+{
+	double increase = this->reg.sampleIncrease;
+	unsigned bank = 0;
+	this->sincBankMix = 0.0f;
+	if (increase > 1.0)
+	{
+		double steps = std::log2(increase) * SINC_BANK_STEPS_PER_OCTAVE;
+		if (steps >= SINC_BANKS - 1)
+			bank = SINC_BANKS - 1;
+		else
+		{
+			// Weighted by cutoff, which is what the kernels are made from
+			bank = static_cast<unsigned>(steps);
+			double above = sincBankCutoff(bank), below = sincBankCutoff(bank + 1);
+			this->sincBankMix = static_cast<float>((above - 1.0 / increase) / (above - below));
+		}
+	}
+	this->sincBank[0] = SincBank(bank);
+	this->sincBank[1] = this->sincBankMix != 0.0f ? SincBank(bank + 1) : this->sincBank[0];
+	this->sincBankIncrease = increase;
 }
 
 // Original FSS Function: Chn_UpdateVol
@@ -643,6 +721,91 @@ static const int16_t wavedutytbl[8][8] =
 	{ -0x7FFF, -0x7FFF, -0x7FFF, -0x7FFF, -0x7FFF, -0x7FFF, -0x7FFF, -0x7FFF }
 };
 
+/*
+ * Takes data pointing at the sample history entry of the current position
+ * and reads data[-7] to data[8].
+ */
+static inline float sincInterpolate(const int16_t *data, const float *const *banks, float mix, double ratio)
+{
+	double phase = ratio * Channel::SINC_PHASES;
+	int p = static_cast<int>(phase);
+	float frac = static_cast<float>(phase - p);
+	const float *kernel = banks[0] + p * Channel::SINC_WIDTH * 4, *delta = kernel + Channel::SINC_WIDTH * 2;
+	const float *kernel2 = banks[1] + p * Channel::SINC_WIDTH * 4, *delta2 = kernel2 + Channel::SINC_WIDTH * 2;
+	data -= Channel::SINC_WIDTH - 1;
+#if defined(SSEQ_SSE2)
+	__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+	__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 8));
+	__m128 d[4] =
+	{
+		_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)),
+		_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)),
+		_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)),
+		_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16))
+	};
+	__m128 f = _mm_set1_ps(frac), m = _mm_set1_ps(mix), sum = _mm_setzero_ps();
+	if (mix == 0.0f)
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 k = _mm_add_ps(_mm_loadu_ps(kernel + i), _mm_mul_ps(_mm_loadu_ps(delta + i), f));
+			sum = _mm_add_ps(sum, _mm_mul_ps(d[i / 4], k));
+		}
+	else
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 k = _mm_add_ps(_mm_loadu_ps(kernel + i), _mm_mul_ps(_mm_loadu_ps(delta + i), f));
+			__m128 k2 = _mm_add_ps(_mm_loadu_ps(kernel2 + i), _mm_mul_ps(_mm_loadu_ps(delta2 + i), f));
+			k = _mm_add_ps(k, _mm_mul_ps(_mm_sub_ps(k2, k), m));
+			sum = _mm_add_ps(sum, _mm_mul_ps(d[i / 4], k));
+		}
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+#elif defined(SSEQ_NEON)
+	int16x8_t lo = vld1q_s16(data), hi = vld1q_s16(data + 8);
+	float32x4_t d[4] =
+	{
+		vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))),
+		vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo))),
+		vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))),
+		vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi)))
+	};
+	float32x4_t sum = vdupq_n_f32(0.0f);
+	if (mix == 0.0f)
+		for (int i = 0; i < 16; i += 4)
+		{
+			float32x4_t k = vmlaq_n_f32(vld1q_f32(kernel + i), vld1q_f32(delta + i), frac);
+			sum = vmlaq_f32(sum, d[i / 4], k);
+		}
+	else
+		for (int i = 0; i < 16; i += 4)
+		{
+			float32x4_t k = vmlaq_n_f32(vld1q_f32(kernel + i), vld1q_f32(delta + i), frac);
+			float32x4_t k2 = vmlaq_n_f32(vld1q_f32(kernel2 + i), vld1q_f32(delta2 + i), frac);
+			k = vmlaq_n_f32(k, vsubq_f32(k2, k), mix);
+			sum = vmlaq_f32(sum, d[i / 4], k);
+		}
+	float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+	return vget_lane_f32(vpadd_f32(half, half), 0);
+#else
+	float sum = 0.0f;
+	for (int i = 0; i < 16; ++i)
+	{
+		float k = kernel[i] + delta[i] * frac, k2 = kernel2[i] + delta2[i] * frac;
+		sum += data[i] * (k + (k2 - k) * mix);
+	}
+	return sum;
+#endif
+}
+
+// Kept out of Interpolate so the cheaper modes don't pay for its frame
+int32_t Channel::InterpolateSinc(const int16_t *data, double ratio)
+{
+	if (!this->sincBank[0] || this->sincBankIncrease != this->reg.sampleIncrease)
+		this->UpdateSincBanks();
+	return static_cast<int32_t>(sincInterpolate(data, this->sincBank, this->sincBankMix, ratio));
+}
+
 // Linear interpolation code originally from DeSmuME
 // Legrange comes from Olli Niemitalo:
 // http://www.student.oulu.fi/~oniemita/dsp/deip.pdf
@@ -654,23 +817,7 @@ int32_t Channel::Interpolate()
 	const auto &data = &this->sampleHistory[this->sampleHistoryPtr + 16];
 
 	if (this->ply->interpolation == INTERPOLATION_SINC)
-	{
-		double kernel[SINC_WIDTH * 2], kernel_sum = 0.0;
-		int i = SINC_WIDTH, shift = static_cast<int>(std::floor(ratio * SINC_RESOLUTION));
-		int step = this->reg.sampleIncrease > 1.0 ? static_cast<int>(SINC_RESOLUTION / this->reg.sampleIncrease) : SINC_RESOLUTION;
-		int shift_adj = shift * step / SINC_RESOLUTION;
-		const int window_step = SINC_RESOLUTION;
-		for (; i >= -static_cast<int>(SINC_WIDTH - 1); --i)
-		{
-			int pos = i * step;
-			int window_pos = i * window_step;
-			kernel_sum += kernel[i + SINC_WIDTH - 1] = this->sinc_lut[::abs(shift_adj - pos)] * this->window_lut[::abs(shift - window_pos)];
-		}
-		double sum = 0.0;
-		for (i = 0; i < static_cast<int>(SINC_WIDTH * 2); ++i)
-			sum += data[i - static_cast<int>(SINC_WIDTH) + 1] * kernel[i];
-		return static_cast<int32_t>(sum / kernel_sum);
-	}
+		return this->InterpolateSinc(data, ratio);
 	else if (this->ply->interpolation > INTERPOLATION_LINEAR)
 	{
 		double c0, c1, c2, c3, c4, c5;
@@ -702,6 +849,116 @@ int32_t Channel::Interpolate()
 		return static_cast<int32_t>(data[0] + ratio * (data[1] - data[0]));
 }
 
+/*
+ * The Lagrange interpolators for the block renderer, two samples at a time,
+ * one in each lane of a double vector. Each lane does the same operations in
+ * the same order as Interpolate(), so the output is identical to it.
+ */
+#if defined(SSEQ_SSE2) || (defined(SSEQ_NEON) && defined(__aarch64__))
+#define SSEQ_DOUBLE_LANES
+#if defined(SSEQ_SSE2)
+typedef __m128d double2;
+static inline double2 d2Load(const double *p) { return _mm_loadu_pd(p); }
+static inline double2 d2Set(double x) { return _mm_set1_pd(x); }
+static inline double2 d2Add(double2 a, double2 b) { return _mm_add_pd(a, b); }
+static inline double2 d2Sub(double2 a, double2 b) { return _mm_sub_pd(a, b); }
+static inline double2 d2Mul(double2 a, double2 b) { return _mm_mul_pd(a, b); }
+static inline void d2Store(int32_t *p, double2 x) { _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_cvttpd_epi32(x)); }
+
+// Pairs up data[-2] to data[3] of two windows, the first in the low lane
+static inline void d2Windows(const int16_t *a, const int16_t *b, double2 *d)
+{
+	__m128i wa = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a)), wb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+	__m128i w = _mm_unpacklo_epi16(wa, wb), w2 = _mm_unpackhi_epi16(wa, wb);
+	__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16), hi = _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16);
+	__m128i lo2 = _mm_srai_epi32(_mm_unpacklo_epi16(w2, w2), 16);
+	d[0] = _mm_cvtepi32_pd(lo);
+	d[1] = _mm_cvtepi32_pd(_mm_unpackhi_epi64(lo, lo));
+	d[2] = _mm_cvtepi32_pd(hi);
+	d[3] = _mm_cvtepi32_pd(_mm_unpackhi_epi64(hi, hi));
+	d[4] = _mm_cvtepi32_pd(lo2);
+	d[5] = _mm_cvtepi32_pd(_mm_unpackhi_epi64(lo2, lo2));
+}
+#else
+typedef float64x2_t double2;
+static inline double2 d2Load(const double *p) { return vld1q_f64(p); }
+static inline double2 d2Set(double x) { return vdupq_n_f64(x); }
+static inline double2 d2Add(double2 a, double2 b) { return vaddq_f64(a, b); }
+static inline double2 d2Sub(double2 a, double2 b) { return vsubq_f64(a, b); }
+static inline double2 d2Mul(double2 a, double2 b) { return vmulq_f64(a, b); }
+static inline void d2Store(int32_t *p, double2 x) { vst1_s32(p, vmovn_s64(vcvtq_s64_f64(x))); }
+
+// Pairs up data[-2] to data[3] of two windows, the first in the low lane
+static inline void d2Windows(const int16_t *a, const int16_t *b, double2 *d)
+{
+	int16x8_t wa = vld1q_s16(a), wb = vld1q_s16(b);
+	int16x8_t w = vzip1q_s16(wa, wb), w2 = vzip2q_s16(wa, wb);
+	int32x4_t lo = vmovl_s16(vget_low_s16(w)), hi = vmovl_s16(vget_high_s16(w)), lo2 = vmovl_s16(vget_low_s16(w2));
+	d[0] = vcvtq_f64_s64(vmovl_s32(vget_low_s32(lo)));
+	d[1] = vcvtq_f64_s64(vmovl_s32(vget_high_s32(lo)));
+	d[2] = vcvtq_f64_s64(vmovl_s32(vget_low_s32(hi)));
+	d[3] = vcvtq_f64_s64(vmovl_s32(vget_high_s32(hi)));
+	d[4] = vcvtq_f64_s64(vmovl_s32(vget_low_s32(lo2)));
+	d[5] = vcvtq_f64_s64(vmovl_s32(vget_high_s32(lo2)));
+}
+#endif
+
+static const unsigned LAGRANGE_BATCH = 64;
+
+// Inputs of up to LAGRANGE_BATCH samples, padded to an even count
+struct LagrangeBatch
+{
+	double ratio[LAGRANGE_BATCH];
+	int16_t data[LAGRANGE_BATCH][8]; // data[-2] to data[5] of each sample
+};
+
+// (k1 * x1 + k2 * x2) + k3 * x3, where a negative constant stands in for a
+// subtraction, which rounds the same
+static inline double2 d2Sum3(double k1, double2 x1, double k2, double2 x2, double k3, double2 x3)
+{
+	return d2Add(d2Add(d2Mul(d2Set(k1), x1), d2Mul(d2Set(k2), x2)), d2Mul(d2Set(k3), x3));
+}
+
+static void lagrange6Lanes(const LagrangeBatch &batch, unsigned count, int32_t *out)
+{
+	for (unsigned i = 0; i < count; i += 2)
+	{
+		double2 ratio = d2Sub(d2Load(batch.ratio + i), d2Set(0.5)), d[6];
+		d2Windows(batch.data[i], batch.data[i + 1], d);
+		double2 even1 = d2Add(d[0], d[5]), odd1 = d2Sub(d[0], d[5]);
+		double2 even2 = d2Add(d[1], d[4]), odd2 = d2Sub(d[1], d[4]);
+		double2 even3 = d2Add(d[2], d[3]), odd3 = d2Sub(d[2], d[3]);
+		double2 c0 = d2Sum3(0.01171875, even1, -0.09765625, even2, 0.5859375, even3);
+		double2 c1 = d2Sum3(25 / 384.0, odd2, -1.171875, odd3, -0.0046875, odd1);
+		double2 c2 = d2Sum3(0.40625, even2, -17 / 48.0, even3, -5 / 96.0, even1);
+		double2 c3 = d2Sum3(1 / 48.0, odd1, -13 / 48.0, odd2, 17 / 24.0, odd3);
+		double2 c4 = d2Sum3(1 / 48.0, even1, -0.0625, even2, 1 / 24.0, even3);
+		double2 c5 = d2Sum3(1 / 24.0, odd2, -1 / 12.0, odd3, -1 / 120.0, odd1);
+		double2 sum = d2Add(d2Mul(c5, ratio), c4);
+		sum = d2Add(d2Mul(sum, ratio), c3);
+		sum = d2Add(d2Mul(sum, ratio), c2);
+		sum = d2Add(d2Mul(sum, ratio), c1);
+		d2Store(out + i, d2Add(d2Mul(sum, ratio), c0));
+	}
+}
+
+static void lagrange4Lanes(const LagrangeBatch &batch, unsigned count, int32_t *out)
+{
+	double2 half = d2Set(0.5), third = d2Set(1 / 3.0), sixth = d2Set(1 / 6.0);
+	for (unsigned i = 0; i < count; i += 2)
+	{
+		double2 ratio = d2Load(batch.ratio + i), d[6];
+		d2Windows(batch.data[i], batch.data[i + 1], d);
+		double2 c1 = d2Sub(d2Sub(d2Sub(d[3], d2Mul(third, d[1])), d2Mul(half, d[2])), d2Mul(sixth, d[4]));
+		double2 c2 = d2Sub(d2Mul(half, d2Add(d[1], d[3])), d[2]);
+		double2 c3 = d2Add(d2Mul(sixth, d2Sub(d[4], d[1])), d2Mul(half, d2Sub(d[2], d[3])));
+		double2 sum = d2Add(d2Mul(c3, ratio), c2);
+		sum = d2Add(d2Mul(sum, ratio), c1);
+		d2Store(out + i, d2Add(d2Mul(sum, ratio), d[2]));
+	}
+}
+#endif
+
 int32_t Channel::GenerateSample()
 {
 	if (this->reg.samplePosition < 0)
@@ -747,6 +1004,77 @@ int32_t Channel::GenerateSample()
 	}
 }
 
+/*
+ * Renders a block of samples, over which the sound registers must not be
+ * changed from outside. If the channel stops partway, the rest of the
+ * block is silent, and so is the sample it stopped on, as its volume was
+ * already cleared by the time it used to be mixed.
+ */
+void Channel::GenerateSamples(int32_t *buf, unsigned samples)
+{
+	unsigned i = 0;
+#ifdef SSEQ_DOUBLE_LANES
+	if (this->reg.format != 3 && (this->ply->interpolation == INTERPOLATION_4POINTLEGRANGE || this->ply->interpolation == INTERPOLATION_6POINTLEGRANGE))
+	{
+		LagrangeBatch batch;
+		int32_t out[LAGRANGE_BATCH];
+		while (i < samples && this->state > CS_NONE)
+		{
+			unsigned count = 0;
+			for (; count < LAGRANGE_BATCH && i + count < samples && this->state > CS_NONE; ++count)
+			{
+				if (this->reg.samplePosition >= 0)
+				{
+					double ratio = this->reg.samplePosition;
+					batch.ratio[count] = ratio - static_cast<int32_t>(ratio);
+					memcpy(batch.data[count], &this->sampleHistory[this->sampleHistoryPtr + 14], sizeof(batch.data[count]));
+				}
+				else
+				{
+					// All zero inputs interpolate to 0, as the sample is before the start
+					batch.ratio[count] = 0;
+					memset(batch.data[count], 0, sizeof(batch.data[count]));
+				}
+				this->IncrementSample();
+			}
+			if (count & 1)
+			{
+				batch.ratio[count] = 0;
+				memset(batch.data[count], 0, sizeof(batch.data[count]));
+			}
+			unsigned padded = (count + 1) & ~1;
+			if (this->ply->interpolation == INTERPOLATION_6POINTLEGRANGE)
+				lagrange6Lanes(batch, padded, out);
+			else
+				lagrange4Lanes(batch, padded, out);
+			std::copy(out, out + count, buf + i);
+			i += count;
+		}
+	}
+	else
+#endif
+	if (this->reg.format != 3 && this->ply->interpolation != INTERPOLATION_NONE)
+	{
+		for (; i < samples && this->state > CS_NONE; ++i)
+		{
+			buf[i] = this->reg.samplePosition < 0 ? 0 : this->Interpolate();
+			this->IncrementSample();
+		}
+	}
+	else
+	{
+		for (; i < samples && this->state > CS_NONE; ++i)
+		{
+			buf[i] = this->GenerateSample();
+			this->IncrementSample();
+		}
+	}
+	if (i && this->state == CS_NONE)
+		buf[i - 1] = 0;
+	for (; i < samples; ++i)
+		buf[i] = 0;
+}
+
 void Channel::IncrementSample()
 {
 	double samplePosition = this->reg.samplePosition + this->reg.sampleIncrease;
@@ -135,17 +135,20 @@ struct Channel
 	int16_t sampleHistory[64];
 
 	/*
-	 * Lookup tables for the Sinc interpolation, to
-	 * avoid the need to call the sin/cos functions all the time.
-	 * These are static as they will not change between channels or runs
-	 * of the program.
+	 * Sinc interpolation uses polyphase filter banks, built once per
+	 * quarter semitone of resampling ratio and shared between all
+	 * channels. Each phase holds the normalized kernel and its difference
+	 * to the next phase, so positions between phases are linearly
+	 * interpolated. The channel keeps the two banks either side of its
+	 * current sample increase and how far to blend from the first to the
+	 * second.
 	 */
-	static bool initializedLUTs;
-	static const unsigned SINC_RESOLUTION = 8192;
 	static const unsigned SINC_WIDTH = 8;
-	static const unsigned SINC_SAMPLES = SINC_RESOLUTION * SINC_WIDTH;
-	static double sinc_lut[SINC_SAMPLES + 1];
-	static double window_lut[SINC_SAMPLES + 1];
+	static const unsigned SINC_PHASES = 256;
+	static const float *SincBank(unsigned bank);
+	const float *sincBank[2];
+	float sincBankMix;
+	double sincBankIncrease;
 
 	Channel();
 
@@ -158,8 +161,11 @@ struct Channel
 	void Kill();
 	void UpdateTrack();
 	void Update();
+	void UpdateSincBanks();
+	int32_t InterpolateSinc(const int16_t *data, double ratio);
 	int32_t Interpolate();
 	int32_t GenerateSample();
+	void GenerateSamples(int32_t *buf, unsigned samples);
 	void IncrementSample();
 	void clearHistory();
 };
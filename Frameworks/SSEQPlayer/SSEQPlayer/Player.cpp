@@ -8,6 +8,7 @@
  * https://github.com/fincs/FSS
  */
 
+#include <algorithm>
 #include "Player.h"
 #include "common.h"
 
@@ -183,6 +184,13 @@ static inline int32_t muldiv7(int32_t val, uint8_t mul)
 
 void Player::GenerateSamples(std::vector<uint8_t> &buf, unsigned offset, unsigned samples)
 {
+	// Only the dearer interpolators gain from rendering a block at a time
+	if (this->interpolation > INTERPOLATION_LINEAR)
+	{
+		this->GenerateSampleBlocks(buf, offset, samples);
+		return;
+	}
+
 	unsigned long mute = this->mutes.to_ulong();
 
 	for (unsigned smpl = 0; smpl < samples; ++smpl)
@@ -230,3 +238,76 @@ void Player::GenerateSamples(std::vector<uint8_t> &buf, unsigned offset, unsigne
 	}
 }
 
+void Player::GenerateSampleBlocks(std::vector<uint8_t> &buf, unsigned offset, unsigned samples)
+{
+	static const unsigned BLOCK = 256;
+	int32_t chnBuf[BLOCK], leftBuf[BLOCK], rightBuf[BLOCK];
+	unsigned long mute = this->mutes.to_ulong();
+
+	while (samples)
+	{
+		// The sound registers only change on the clock, so channels can
+		// render everything up to and including the sample that reaches it
+		unsigned block = 0;
+		bool clock = false;
+		while (block < samples && block < BLOCK && !clock)
+		{
+			this->secondsIntoPlayback += this->secondsPerSample;
+			++block;
+			clock = this->secondsIntoPlayback > this->secondsUntilNextClock;
+		}
+
+		std::fill_n(leftBuf, block, 0);
+		std::fill_n(rightBuf, block, 0);
+
+		// I need to advance the sound channels here
+		for (int i = 0; i < 16; ++i)
+		{
+			Channel &chn = this->channels[i];
+
+			if (chn.state > CS_NONE)
+			{
+				// A channel that stops in this block clears its registers,
+				// so take them first
+				uint8_t volumeMul = chn.reg.volumeMul, panning = chn.reg.panning;
+				uint8_t datashift = chn.reg.volumeDiv;
+				if (datashift == 3)
+					datashift = 4;
+
+				chn.GenerateSamples(chnBuf, block);
+
+				if (mute & BIT(i))
+					continue;
+
+				for (unsigned smpl = 0; smpl < block; ++smpl)
+				{
+					int32_t sample = muldiv7(chnBuf[smpl], volumeMul) >> datashift;
+
+					leftBuf[smpl] += muldiv7(sample, 127 - panning);
+					rightBuf[smpl] += muldiv7(sample, panning);
+				}
+			}
+		}
+
+		for (unsigned smpl = 0; smpl < block; ++smpl)
+		{
+			int32_t leftChannel = leftBuf[smpl], rightChannel = rightBuf[smpl];
+
+			clamp(leftChannel, -0x8000, 0x7FFF);
+			clamp(rightChannel, -0x8000, 0x7FFF);
+
+			buf[offset++] = leftChannel & 0xFF;
+			buf[offset++] = (leftChannel >> 8) & 0xFF;
+			buf[offset++] = rightChannel & 0xFF;
+			buf[offset++] = (rightChannel >> 8) & 0xFF;
+		}
+
+		if (clock)
+		{
+			this->Timer();
+			this->secondsUntilNextClock += SecondsPerClockCycle;
+		}
+
+		samples -= block;
+	}
+}
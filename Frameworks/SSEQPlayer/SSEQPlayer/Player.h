@@ -49,4 +49,5 @@ struct Player
 	double secondsPerSample, secondsIntoPlayback, secondsUntilNextClock;
 	std::bitset<16> mutes;
 	void GenerateSamples(std::vector<uint8_t> &buf, unsigned offset, unsigned samples);
+	void GenerateSampleBlocks(std::vector<uint8_t> &buf, unsigned offset, unsigned samples);
 };
@@ -33,6 +33,7 @@
 #define	__SHN_READER_H__
 
 #include <stdio.h>
+#include <time.h>
 #include <pthread.h>
 #include "shorten.h"
 #include "ringbuffer.h"
@@ -48,6 +49,7 @@ typedef unsigned int uint;
 #define SEEK_HEADER_SIZE		12
 #define SEEK_TRAILER_SIZE		12
 #define SEEK_ENTRY_SIZE			80
+#define SEEK_RESOLUTION			25600
 
 #define MASKTABSIZE 33
 
@@ -112,7 +114,15 @@ class shn_reader
 		shn_seek_header		mSeekHeader;
 		shn_seek_trailer	mSeekTrailer;
 		shn_seek_entry		*mSeekTable;
-		int					mSeekTo;
+		slong				mSeekTo;
+		long				mSkipBytes;
+		char				*mFileName;
+		time_t				mFileTime;
+		bool				mCanBuildSeekTable;
+		bool				mBuildSeekTable;
+		bool				mSaveSeekTable;
+		long				mSeekTableSize;
+		ulong				mNextSeekPoint;
 		bool				mEOF;
 		bool				mGoing;
 		long				mSeekTableEntries;
@@ -133,13 +143,15 @@ class shn_reader
 	public:
 							shn_reader();
 							~shn_reader();
-		int					open(const char *fn, bool should_load_seek_table = true);
+		int					open(const char *fn, bool should_load_seek_table = true,
+									bool should_save_seek_table = false);
 		int					go();
 		void				exit();
 		bool				file_info(long *size, int *nch, float *rate, float *time,
 										int *samplebits, bool *seekable);
 		long				read(void *buf, long size);
 		float				seek(float sec);
+		long				seek_sample(long sample);
 		int					shn_get_buffer_block_size(int blocks);//derek
 		unsigned int		shn_get_song_length();//derek
 		
@@ -170,7 +182,12 @@ class shn_reader
 		/* seek.cpp */
 		void				load_seek_table(const char *fn);
 		int					load_separate_seek_table(const char *fn);
-		shn_seek_entry 		*seek_entry_search(ulong goal, ulong min, ulong max);
+		shn_seek_entry 		*seek_entry_search(ulong goal);
+		void				add_seek_entry(ulong sample, slong **buffer, slong **offset,
+											int nchan, int nmean, int bitshift);
+		void				restore_seek_entry(shn_seek_entry *entry, slong **buffer, slong **offset,
+											int nchan, int nmean, int *bitshift);
+		void				finish_seek_table();
 
 		/* array.cpp */
 		void				*pmalloc(ulong size);
@@ -201,4 +218,20 @@ inline ushort uchar_to_ushort_le(uchar *buf)
 	return (ushort)((buf[1] << 8) + buf[0]);
 }
 
+inline void ulong_to_uchar_le(uchar *buf, ulong num)
+/* converts a ulong to 4 bytes stored in little-endian format */
+{
+	buf[0] = (uchar)(num);
+	buf[1] = (uchar)(num >> 8);
+	buf[2] = (uchar)(num >> 16);
+	buf[3] = (uchar)(num >> 24);
+}
+
+inline void ushort_to_uchar_le(uchar *buf, ushort num)
+/* converts a ushort to 2 bytes stored in little-endian format */
+{
+	buf[0] = (uchar)(num);
+	buf[1] = (uchar)(num >> 8);
+}
+
 #endif /*__SHN_READER_H__*/
@@ -30,31 +30,245 @@
  */
 
 #include <string.h>
+#include <stdlib.h>
 #include "shn_reader.h"
 
 #define	SEEK_HEADER_SIGNATURE		"SEEK"
 #define	SEEK_TRAILER_SIGNATURE		"SHNAMPSK"
 #define	SEEK_SUFFIX					".skt"
+#define	SEEK_TABLE_REVISION			1
 
-shn_seek_entry *shn_reader::seek_entry_search(ulong goal, ulong min, ulong max)
+/*
+ * Seek tables built while playing files that came without one are kept
+ * here for the rest of the session, so the next open of the same file
+ * can seek right away even when they are not saved to disk.
+ */
+
+#define	SEEK_CACHE_MAX				32
+
+typedef struct _shn_cached_seek_table
+{
+	struct _shn_cached_seek_table	*next;
+	char			*filename;
+	ulong			size;
+	time_t			mtime;
+	shn_seek_entry	*table;
+	long			entries;
+} shn_cached_seek_table;
+
+static shn_cached_seek_table	*seek_cache = NULL;
+static pthread_mutex_t			seek_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void seek_table_filename(const char *fn, char *seek_fn)
+{
+	char	*slash, *ext;
+
+	strncpy(seek_fn, fn, MAX_PATH - sizeof(SEEK_SUFFIX));
+	seek_fn[MAX_PATH - sizeof(SEEK_SUFFIX)] = 0;
+	slash = strrchr(seek_fn, '/');
+	ext = strrchr((slash ? slash : seek_fn), '.');
+	if (ext)
+		*ext = 0;
+	strcat(seek_fn, SEEK_SUFFIX);
+}
+
+/* returns the last entry at or before the goal sample */
+shn_seek_entry *shn_reader::seek_entry_search(ulong goal)
+{
+	long	min = 0, max = mSeekTableEntries - 1;
+
+	if (!mSeekTable || mSeekTableEntries <= 0)
+		return NULL;
+
+	while (min < max)
+	{
+		long	med = (min + max + 1) / 2;
+
+		if (uchar_to_ulong_le(mSeekTable[med].data) <= goal)
+			min = med;
+		else
+			max = med - 1;
+	}
+
+	return &mSeekTable[min];
+}
+
+void shn_reader::add_seek_entry(ulong sample, slong **buffer, slong **offset,
+								int nchan, int nmean, int bitshift)
+{
+	shn_seek_entry	*entry;
+	ulong			buffer_offset = (ulong)(mDecodeState.getbufp - mDecodeState.getbuf);
+	int				chan, i;
+
+	if (mSeekTableEntries >= mSeekTableSize)
+	{
+		long			size = mSeekTableSize ? mSeekTableSize * 2 : 256;
+		shn_seek_entry	*table = (shn_seek_entry *) realloc(mSeekTable, sizeof(shn_seek_entry)*size);
+
+		if (!table)
+		{
+			mBuildSeekTable	= false;
+			return;
+		}
+		mSeekTable		= table;
+		mSeekTableSize	= size;
+	}
+
+	entry = &mSeekTable[mSeekTableEntries++];
+	memset(entry, 0, sizeof(shn_seek_entry));
+
+	ulong_to_uchar_le(entry->data, sample);
+	ulong_to_uchar_le(entry->data+4, mWAVEHeader.header_size + sample * mWAVEHeader.block_align);
+	ulong_to_uchar_le(entry->data+8, (ulong)ftell(mFP) - buffer_offset - mDecodeState.nbyteget);
+	ushort_to_uchar_le(entry->data+12, (ushort)mDecodeState.nbyteget);
+	ushort_to_uchar_le(entry->data+14, (ushort)buffer_offset);
+	ushort_to_uchar_le(entry->data+16, (ushort)mDecodeState.nbitget);
+	ulong_to_uchar_le(entry->data+18, mDecodeState.gbuffer);
+	ushort_to_uchar_le(entry->data+22, (ushort)bitshift);
+
+	for (chan = 0; chan < nchan; chan++)
+	{
+		for (i = 0; i < 3; i++)
+			ulong_to_uchar_le(entry->data+24+chan*12+i*4, (ulong)buffer[chan][-1-i]);
+		for (i = 0; i < MIN(nmean, 4); i++)
+			ulong_to_uchar_le(entry->data+48+chan*16+i*4, (ulong)offset[chan][i]);
+	}
+}
+
+void shn_reader::restore_seek_entry(shn_seek_entry *entry, slong **buffer, slong **offset,
+									int nchan, int nmean, int *bitshift)
 {
-	ulong	med = (min + max) / 2;
-	shn_seek_entry	*middle = &mSeekTable[med];
-	ulong	sample = uchar_to_ulong_le(middle->data);
+	int		chan, i;
+
+	for (chan = 0; chan < MIN(nchan, 2); chan++)
+	{
+		for (i = 0; i < 3; i++)
+			buffer[chan][-1-i] = uchar_to_slong_le(entry->data+24+chan*12+i*4);
+		for (i = 0; i < MIN(nmean, 4); i++)
+			offset[chan][i] = uchar_to_slong_le(entry->data+48+chan*16+i*4);
+	}
 
-	if (goal < sample)
-		return seek_entry_search(goal, min, med-1);
-	if (goal > sample + 25600)
-		return seek_entry_search(goal, med+1, max);
+	*bitshift = uchar_to_ushort_le(entry->data+22);
 
-	return middle;
+	/*
+	 * Start the bit reader at the saved buffer position rather than
+	 * reloading the whole buffer, so tables written by builds with a
+	 * different BUFSIZ work too.
+	 */
+	fseek(mFP, (long)(uchar_to_ulong_le(entry->data+8) + uchar_to_ushort_le(entry->data+14)), SEEK_SET);
+	mDecodeState.nbyteget	= (int)fread(mDecodeState.getbuf, 1, BUFSIZ, mFP);
+	mDecodeState.getbufp	= mDecodeState.getbuf;
+	mDecodeState.nbitget	= uchar_to_ushort_le(entry->data+16);
+	mDecodeState.gbuffer	= uchar_to_ulong_le(entry->data+18);
+}
+
+/* called at the end of the first complete pass through a file */
+void shn_reader::finish_seek_table()
+{
+	shn_cached_seek_table	*cached, **link;
+	int						count = 0;
+
+	mBuildSeekTable	= false;
+
+	if (!mSeekTableEntries || !mFileName)
+		return;
+
+	if ((cached = (shn_cached_seek_table *) malloc(sizeof(shn_cached_seek_table))))
+	{
+		cached->filename	= strdup(mFileName);
+		cached->size		= mWAVEHeader.actual_size;
+		cached->mtime		= mFileTime;
+		cached->entries		= mSeekTableEntries;
+		cached->table		= (shn_seek_entry *) malloc(sizeof(shn_seek_entry)*mSeekTableEntries);
+
+		if (cached->filename && cached->table)
+		{
+			memcpy(cached->table, mSeekTable, sizeof(shn_seek_entry)*mSeekTableEntries);
+
+			pthread_mutex_lock(&seek_cache_lock);
+			cached->next	= seek_cache;
+			seek_cache		= cached;
+
+			/* drop any older table for the same file, and the oldest past the limit */
+			for (link = &seek_cache; *link; )
+			{
+				if (count >= SEEK_CACHE_MAX || (count && !strcmp((*link)->filename, mFileName)))
+				{
+					shn_cached_seek_table	*old = *link;
+
+					*link	= old->next;
+					free(old->filename);
+					free(old->table);
+					free(old);
+				}
+				else
+				{
+					link	= &(*link)->next;
+					count++;
+				}
+			}
+			pthread_mutex_unlock(&seek_cache_lock);
+		}
+		else
+		{
+			free(cached->filename);
+			free(cached->table);
+			free(cached);
+		}
+	}
+
+	if (mSaveSeekTable)
+	{
+		FILE	*fp;
+		char	seek_fn[MAX_PATH];
+
+		seek_table_filename(mFileName, seek_fn);
+
+		if ((fp = fopen(seek_fn, "wb")))
+		{
+			uchar	header[SEEK_HEADER_SIZE];
+			bool	ok;
+
+			memcpy(header, SEEK_HEADER_SIGNATURE, strlen(SEEK_HEADER_SIGNATURE));
+			ulong_to_uchar_le(header+4, SEEK_TABLE_REVISION);
+			ulong_to_uchar_le(header+8, mWAVEHeader.actual_size);
+
+			ok	= fwrite(header, 1, SEEK_HEADER_SIZE, fp) == SEEK_HEADER_SIZE &&
+				  (long)fwrite(mSeekTable, sizeof(shn_seek_entry), mSeekTableEntries, fp) == mSeekTableEntries;
+			ok	= !fclose(fp) && ok;
+
+			if (!ok)
+				remove(seek_fn);
+		}
+	}
 }
 
 void shn_reader::load_seek_table(const char *fn)
 {
 	FILE	*fp;
 	int		found = 0;
-	
+	shn_cached_seek_table	*cached;
+
+	pthread_mutex_lock(&seek_cache_lock);
+	for (cached = seek_cache; cached; cached = cached->next)
+	{
+		if (!strcmp(cached->filename, fn) && cached->size == mWAVEHeader.actual_size &&
+			cached->mtime == mFileTime)
+		{
+			if ((mSeekTable = (shn_seek_entry *) malloc(sizeof(shn_seek_entry)*cached->entries)))
+			{
+				memcpy(mSeekTable, cached->table, sizeof(shn_seek_entry)*cached->entries);
+				mSeekTableEntries	= cached->entries;
+				found	= 1;
+			}
+			break;
+		}
+	}
+	pthread_mutex_unlock(&seek_cache_lock);
+
+	if (found)
+		return;
+
 	if (!(fp = fopen(fn, "r")))
 		return;
 	
@@ -94,15 +308,9 @@ void shn_reader::load_seek_table(const char *fn)
 		
 	{
 		// try load from separate seek file
-		char	*slash, *ext;
 		char	seek_fn[MAX_PATH];
 
-		strcpy(seek_fn, fn);
-		slash = strrchr(seek_fn, '/');
-		ext = strrchr((slash ? slash : seek_fn), '.');
-		if (ext)
-			*ext = 0;
-		strcat(seek_fn, SEEK_SUFFIX);
+		seek_table_filename(fn, seek_fn);
 		load_separate_seek_table(seek_fn);
 	}
 }
@@ -31,6 +31,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <sys/stat.h>
@@ -97,7 +98,16 @@ shn_reader::~shn_reader()
 void shn_reader::init()
 {
 	mSeekTable	= NULL;
+	mSeekTableEntries	= 0;
+	mSeekTableSize		= 0;
 	mSeekTo		= -1;
+	mSkipBytes	= 0;
+	mFileName	= NULL;
+	mFileTime	= 0;
+	mCanBuildSeekTable	= false;
+	mBuildSeekTable		= false;
+	mSaveSeekTable		= false;
+	mNextSeekPoint		= 0;
 	mFP			= NULL;
 	mFatalError	= false;
 	mGoing		= false;
@@ -111,8 +121,10 @@ void shn_reader::exit()
 {
 	if (mGoing)
 	{
+		pthread_mutex_lock(&mRingLock);
 		mGoing	= false;
 		pthread_cond_signal(&mRunCond);
+		pthread_mutex_unlock(&mRingLock);
 		pthread_join(mThread, NULL);
 	}
 	
@@ -136,6 +148,11 @@ void shn_reader::exit()
 		free(mSeekTable);
 		mSeekTable	= NULL;
 	}
+	if (mFileName)
+	{
+		free(mFileName);
+		mFileName	= NULL;
+	}
 	if (mFP)
 	{
 		fclose(mFP);
@@ -143,7 +160,7 @@ void shn_reader::exit()
 	}
 }
 
-int shn_reader::open(const char *fn, bool should_load_seek_table)
+int shn_reader::open(const char *fn, bool should_load_seek_table, bool should_save_seek_table)
 {
 	struct stat	sz;
 	
@@ -157,6 +174,7 @@ int shn_reader::open(const char *fn, bool should_load_seek_table)
 		return -1;
 
 	mWAVEHeader.actual_size = (ulong)sz.st_size;
+	mFileTime = sz.st_mtime;
 	
 	mFP	= fopen(fn, "r");
 	
@@ -170,9 +188,19 @@ int shn_reader::open(const char *fn, bool should_load_seek_table)
 		return -1;
 	}
 	
+	mFileName = strdup(fn);
+	mSaveSeekTable = should_save_seek_table;
+
 	if (should_load_seek_table)
 		load_seek_table(fn);
-		
+
+	/* no table, so record one on the first pass through the file */
+	if (!mSeekTable && mCanBuildSeekTable)
+	{
+		mBuildSeekTable	= true;
+		mNextSeekPoint	= 0;
+	}
+
 	return 0;
 }
 
@@ -200,9 +228,15 @@ long shn_reader::read(void *buf, long size)
 		return -2;
 	
 	pthread_mutex_lock(&mRingLock);
-	actread	= mRing.ReadData((char *) buf, size);
-	if (!actread)
-		actread	= mEOF ? -2 : -1;
+	/* anything still buffered is from before the seek */
+	if (mSeekTo != -1)
+		actread	= -1;
+	else
+	{
+		actread	= mRing.ReadData((char *) buf, size);
+		if (!actread)
+			actread	= mEOF ? -2 : -1;
+	}
 	
 	pthread_mutex_unlock(&mRingLock);
 	if (actread > 0)
@@ -213,16 +247,40 @@ long shn_reader::read(void *buf, long size)
 
 float shn_reader::seek(float seconds)
 {
-	if (!mSeekTable)
+	long	sample = seek_sample((long)(seconds * (float)mWAVEHeader.samples_per_sec));
+
+	if (sample < 0)
 		return -1.0f;
 
-	mSeekTo	= (int) seconds;
-	shn_seek_entry *seek_info = seek_entry_search(mSeekTo * (ulong)mWAVEHeader.samples_per_sec,0,
-								(ulong)(mSeekTableEntries - 1));
-	ulong			sample = uchar_to_ulong_le(seek_info->data);
 	return (float)sample/((float)mWAVEHeader.samples_per_sec);
 }
 
+/*
+ * The decoder thread restarts from the nearest seek table entry and drops
+ * the samples up to the one asked for. While the table is still being
+ * built, seeking past its end decodes forward from where playback is.
+ */
+long shn_reader::seek_sample(long sample)
+{
+	uint	frame_size = (uint)mWAVEHeader.channels * (uint)mWAVEHeader.bits_per_sample / 8;
+	long	total = frame_size ? (long)(mWAVEHeader.data_size / frame_size) : 0;
+
+	if (!mSeekTable && !mBuildSeekTable)
+		return -1;
+
+	if (sample > total)
+		sample	= total;
+	if (sample < 0)
+		sample	= 0;
+
+	pthread_mutex_lock(&mRingLock);
+	mSeekTo	= (slong)sample;
+	pthread_cond_signal(&mRunCond);
+	pthread_mutex_unlock(&mRingLock);
+
+	return sample;
+}
+
 int shn_reader::shn_get_buffer_block_size(int blocks)//derek
 {
 	int blk_size = blocks * (mWAVEHeader.bits_per_sample / 8) * mWAVEHeader.channels;
@@ -253,7 +311,7 @@ bool shn_reader::file_info(long *size, int *nch, float *rate, float *time,
 		return false;
 		
 	if (seekable)
-		*seekable	= mSeekTable ? true : false;
+		*seekable	= (mSeekTable || mBuildSeekTable) ? true : false;
 		
 	if (size)
 		*size	= mWAVEHeader.actual_size;
@@ -296,6 +354,7 @@ int shn_reader::get_wave_header()
   int   ftype = TYPE_EOF;
   const char  *magic = MAGIC;
   int   internal_ftype;
+  int   nchan = 0, maxnlpc = DEFAULT_MAXNLPC, nmean = DEFAULT_V0NMEAN;
   int   retval = 1;
 
   init_decode_state();
@@ -368,15 +427,15 @@ int shn_reader::get_wave_header()
           goto got_enough_data;
     }
 
-    UINT_GET(CHANSIZE);
+    nchan = (int)UINT_GET(CHANSIZE);
 
     /* get blocksize if version > 0 */
     if(version > 0)
     {
       int byte, nskip;
       UINT_GET((int) (log((double) DEFAULT_BLOCK_SIZE) / M_LN2));
-      UINT_GET(LPCQSIZE);
-      UINT_GET(0);
+      maxnlpc = (int)UINT_GET(LPCQSIZE);
+      nmean = (int)UINT_GET(0);
       nskip = (int)UINT_GET(NSKIPSIZE);
       for(int i = 0; i < nskip; i++)
       {
@@ -414,6 +473,9 @@ int shn_reader::get_wave_header()
 
 got_enough_data:
 
+    /* the seek table entries only hold the state these need */
+    mCanBuildSeekTable = nchan > 0 && nchan <= 2 && maxnlpc <= NWRAP && nmean <= 4;
+
     /* wind up */
     var_get_quit();
 
@@ -516,6 +578,7 @@ int shn_reader::verify_header()
 void shn_reader::write_and_wait(int block_size)
 {
 	int bytes_to_write;
+	int bytes_written = 0;
 	
 	if (mBytesInBuf < block_size)
 		return;
@@ -530,17 +593,23 @@ void shn_reader::write_and_wait(int block_size)
 		long	written;
 		
 		pthread_mutex_lock(&mRingLock);
-		written	= mRing.WriteData((char *) mBuffer, bytes_to_write);
+		written	= mRing.WriteData((char *) mBuffer + bytes_written, bytes_to_write);
 		bytes_to_write	-= written;
-		mBytesInBuf		-= written;
+		bytes_written	+= written;
 		if (!bytes_to_write)
 		{
 			pthread_mutex_unlock(&mRingLock);
 			break;
 		}
-		pthread_cond_wait(&mRunCond, &mRingLock);
+		if (mGoing && mSeekTo == -1)
+			pthread_cond_wait(&mRunCond, &mRingLock);
 		pthread_mutex_unlock(&mRingLock);		
 	}
+
+	/* keep whatever did not fit in this block at the front */
+	mBytesInBuf	-= bytes_written;
+	if (mBytesInBuf)
+		memmove(mBuffer, mBuffer + bytes_written, mBytesInBuf);
 }
 
 void shn_reader::Run()
@@ -557,11 +626,16 @@ void shn_reader::Run()
   int   internal_ftype;
   int   blk_size;
   int   cklen;
+  int   frame_size;
+  ulong samples;
   uchar tmp;
 
 restart:
 
   mBytesInBuf = 0;
+  mSkipBytes = 0;
+  mEOF = false;
+  samples = 0;
 
   init_decode_state();
 
@@ -713,6 +787,14 @@ restart:
 
     init_offset(offset, nchan, MAX(1, nmean), internal_ftype);
 
+    frame_size = sizeof_sample[ftype] * nchan;
+
+    if (mBuildSeekTable && !mSeekTableEntries)
+    {
+      add_seek_entry(0, buffer, offset, nchan, nmean, bitshift);
+      mNextSeekPoint = SEEK_RESOLUTION;
+    }
+
     /* get commands from file and execute them */
     chan = 0;
     while(1)
@@ -846,48 +928,55 @@ restart:
               if (!mGoing || mFatalError)
                 goto cleanup;
 
+              samples += blocksize;
+
+              if (mBuildSeekTable && samples >= mNextSeekPoint)
+              {
+                add_seek_entry(samples, buffer, offset, nchan, nmean, bitshift);
+                mNextSeekPoint = (samples / SEEK_RESOLUTION + 1) * SEEK_RESOLUTION;
+              }
+
               fwrite_type(buffer, ftype, nchan, blocksize);
 
+              /* drop what comes before the sample seeked to */
+              if (mSkipBytes)
+              {
+                int skip = (int)MIN(mSkipBytes, (long)mBytesInBuf);
+
+                memmove(mBuffer, mBuffer + skip, mBytesInBuf - skip);
+                mBytesInBuf -= skip;
+                mSkipBytes -= skip;
+              }
+
               write_and_wait(blk_size);
 
               if (mSeekTo != -1)
               {
-                shn_seek_entry *seek_info = seek_entry_search(mSeekTo * (ulong)mWAVEHeader.samples_per_sec,0,
-							      (ulong)(mSeekTableEntries - 1));
-				
- 				pthread_mutex_lock(&mRingLock);
-				mRing.Empty();
-				pthread_mutex_unlock(&mRingLock);
-
-                buffer[0][-1] = uchar_to_slong_le(seek_info->data+24);
-                buffer[0][-2] = uchar_to_slong_le(seek_info->data+28);
-                buffer[0][-3] = uchar_to_slong_le(seek_info->data+32);
-                offset[0][0]  = uchar_to_slong_le(seek_info->data+48);
-                offset[0][1]  = uchar_to_slong_le(seek_info->data+52);
-                offset[0][2]  = uchar_to_slong_le(seek_info->data+56);
-                offset[0][3]  = uchar_to_slong_le(seek_info->data+60);
-		if (nchan > 1)
-		{
-	                buffer[1][-1] = uchar_to_slong_le(seek_info->data+36);
-        	        buffer[1][-2] = uchar_to_slong_le(seek_info->data+40);
-                	buffer[1][-3] = uchar_to_slong_le(seek_info->data+44);
-	                offset[1][0]  = uchar_to_slong_le(seek_info->data+64);
-        	        offset[1][1]  = uchar_to_slong_le(seek_info->data+68);
-                	offset[1][2]  = uchar_to_slong_le(seek_info->data+72);
-	                offset[1][3]  = uchar_to_slong_le(seek_info->data+76);
-		}
-                bitshift = uchar_to_ushort_le(seek_info->data+22);
-                fseek(mFP,(slong)uchar_to_ulong_le(seek_info->data+8),SEEK_SET);
-                fread((uchar*) mDecodeState.getbuf, 1, BUFSIZ, mFP);
-                mDecodeState.getbufp = mDecodeState.getbuf + uchar_to_ushort_le(seek_info->data+14);
-                mDecodeState.nbitget = uchar_to_ushort_le(seek_info->data+16);
-                mDecodeState.nbyteget = uchar_to_ushort_le(seek_info->data+12);
-                mDecodeState.gbuffer = uchar_to_ulong_le(seek_info->data+18);
-				
+                shn_seek_entry *seek_info;
+                ulong goal;
+
+                pthread_mutex_lock(&mRingLock);
+                goal = (ulong)mSeekTo;
+                mRing.Empty();
+                pthread_mutex_unlock(&mRingLock);
+
+                seek_info = seek_entry_search(goal);
+
+                /* past the end of a table still being built, just carry on from here */
+                if (seek_info &&
+                    !(mBuildSeekTable && goal >= samples && uchar_to_ulong_le(seek_info->data) <= samples))
+                {
+                  restore_seek_entry(seek_info, buffer, offset, nchan, nmean, &bitshift);
+                  samples = uchar_to_ulong_le(seek_info->data);
+                }
+
                 mBytesInBuf = 0;
-				
-				
-               mSeekTo = -1;
+                mSkipBytes = goal > samples ? (long)(goal - samples) * frame_size : 0;
+
+                pthread_mutex_lock(&mRingLock);
+                if (mSeekTo == (slong)goal)
+                  mSeekTo = -1;
+                pthread_mutex_unlock(&mRingLock);
               }
 
             }
@@ -901,28 +990,29 @@ restart:
             /* empty out last of buffer */
             write_and_wait(mBytesInBuf);
 
+            if (mBuildSeekTable)
+              finish_seek_table();
+
             mEOF	= true;
 
-            while (1)
-            {
-              if (!mGoing)
-                goto finish;
-              if (mSeekTo != -1)
-              {
-                var_get_quit();
-                fwrite_type_quit();
+            pthread_mutex_lock(&mRingLock);
+            while (mGoing && mSeekTo == -1)
+              pthread_cond_wait(&mRunCond, &mRingLock);
+            pthread_mutex_unlock(&mRingLock);
 
-                if (buffer) free((void *) buffer);
-                if (offset) free((void *) offset);
-                if(maxnlpc > 0 && qlpc)
-                  free((void *) qlpc);
+            if (!mGoing)
+              goto finish;
 
-			fseek(mFP,0,SEEK_SET);
-                goto restart;
-              }
-            }
+            var_get_quit();
+            fwrite_type_quit();
 
-            goto cleanup;
+            if (buffer) free((void *) buffer);
+            if (offset) free((void *) offset);
+            if(maxnlpc > 0 && qlpc)
+              free((void *) qlpc);
+
+            fseek(mFP,0,SEEK_SET);
+            goto restart;
             break;
 
           case FN_BLOCKSIZE:
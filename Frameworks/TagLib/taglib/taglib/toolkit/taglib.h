@@ -75,14 +75,17 @@ namespace TagLib {
    * This is just used as a base class for shared classes in TagLib.
    *
    * \warning This <b>is not</b> part of the TagLib public API!
+   *
+   * The count is atomic, as shared values such as String::null are copied
+   * from several threads at once when files are read in parallel.
    */
 
   class RefCounter
   {
   public:
     RefCounter() : refCount(1) {}
-    void ref() { refCount++; }
-    bool deref() { return ! --refCount ; }
+    void ref() { __sync_add_and_fetch(&refCount, 1); }
+    bool deref() { return ! __sync_sub_and_fetch(&refCount, 1); }
     int count() { return refCount; }
   private:
     uint refCount;
@@ -18,6 +18,9 @@
 
 #include "wavpack_local.h"
 
+// Without the assembly modules, x86-64 and ARM64 use the intrinsics passes
+// in unpack_simd.c (define NO_UNPACK_SIMD to keep the generic passes)
+
 #ifdef OPT_ASM_X86
     #define DECORR_STEREO_PASS_CONT unpack_decorr_stereo_pass_cont_x86
     #define DECORR_STEREO_PASS_CONT_AVAILABLE unpack_cpu_has_feature_x86(CPU_FEATURE_MMX)
@@ -34,6 +37,12 @@
     #define DECORR_STEREO_PASS_CONT unpack_decorr_stereo_pass_cont_armv7
     #define DECORR_STEREO_PASS_CONT_AVAILABLE 1
     #define DECORR_MONO_PASS_CONT unpack_decorr_mono_pass_cont_armv7
+#elif (defined(__x86_64__) || defined(__aarch64__)) && !defined(NO_UNPACK_SIMD)
+    #define DECORR_STEREO_PASS_CONT unpack_decorr_stereo_pass_cont_simd
+    #define DECORR_STEREO_PASS_CONT_AVAILABLE 1
+    #define DECORR_MONO_PASS_CONT unpack_decorr_mono_pass_cont_simd
+    #define FIXUP_CLIP_SHIFT unpack_clip_shift_simd
+    #define FIXUP_SHIFT unpack_shift_simd
 #endif
 
 #ifdef DECORR_STEREO_PASS_CONT
@@ -41,6 +50,11 @@ extern void DECORR_STEREO_PASS_CONT (struct decorr_pass *dpp, int32_t *buffer, i
 extern void DECORR_MONO_PASS_CONT (struct decorr_pass *dpp, int32_t *buffer, int32_t sample_count, int32_t long_math);
 #endif
 
+#ifdef FIXUP_CLIP_SHIFT
+extern void FIXUP_CLIP_SHIFT (int32_t *buffer, uint32_t count, int32_t min_value, int32_t max_value, int shift);
+extern void FIXUP_SHIFT (int32_t *buffer, uint32_t count, int shift);
+#endif
+
 // This flag provides the functionality of terminating the decoding and muting
 // the output when a lossy sample appears to be corrupt. This is automatic
 // for lossless files because a corrupt sample is unambigious, but for lossy
@@ -775,6 +789,10 @@ static void fixup_samples (WavpackContext *wpc, int32_t *buffer, uint32_t sample
         if (!(flags & MONO_DATA))
             sample_count *= 2;
 
+#ifdef FIXUP_CLIP_SHIFT
+        FIXUP_CLIP_SHIFT (buffer, sample_count, min_value, max_value, shift);
+        (void) min_shifted; (void) max_shifted;
+#else
         while (sample_count--) {
             if (*buffer < min_value)
                 *buffer++ = min_shifted;
@@ -783,13 +801,18 @@ static void fixup_samples (WavpackContext *wpc, int32_t *buffer, uint32_t sample
             else
                 *buffer++ <<= shift;
         }
+#endif
     }
     else if (shift) {
         if (!(flags & MONO_DATA))
             sample_count *= 2;
 
+#ifdef FIXUP_SHIFT
+        FIXUP_SHIFT (buffer, sample_count, shift);
+#else
         while (sample_count--)
             *buffer++ <<= shift;
+#endif
     }
 }
 
@@ -0,0 +1,699 @@
+////////////////////////////////////////////////////////////////////////////
+//                           **** WAVPACK ****                            //
+//                  Hybrid Lossless Wavefile Compressor                   //
+//              Copyright (c) 1998 - 2013 Conifer Software.               //
+//                          All Rights Reserved.                          //
+//      Distributed under the BSD Software License (see license.txt)      //
+////////////////////////////////////////////////////////////////////////////
+
+// unpack_simd.c
+
+// This module provides C intrinsics versions of the "continuation" decorrelation
+// passes and the final sample fixup for unpack.c, in place of the assembly
+// language modules (which are not part of this build). SSE4.1 and AVX2 are
+// selected at runtime on x86-64, and NEON is always used on ARM64.
+//
+// The decorrelation passes are recursive, so they can't simply be spread over
+// vector lanes. However, for terms 1-8 a sample only depends on the result
+// "term" samples back, and the weight updates only depend on the signs of
+// that result and the current residual, so as many samples as the term (up
+// to the vector width) can be done at once, with the weights for each lane
+// formed from a prefix sum of the updates. For stereo the two channels go in
+// alternate lanes, which matches the layout of the buffer. This only pays
+// off for the longer terms (see below), so terms 1-3, mono terms 4-7, terms
+// 17 and 18, the negative (cross channel) terms, and the short ends are all
+// done in plain C.
+//
+// Like the assembly versions, the continuation passes are called with the
+// first samples already done by the regular passes (which leaves the history
+// in the buffer) and return the dpp->samples_X[] data normalized. The results
+// are identical to the regular passes.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wavpack_local.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define UNPACK_SSE41
+#define UNPACK_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define UNPACK_NEON
+#endif
+
+#if defined(UNPACK_SSE41) || defined(UNPACK_NEON)
+
+///////////////////////////// scalar versions ////////////////////////////////
+
+// Terms 1-8, reading the history back from the buffer, from sample "start"
+
+static void mono_term_c (int32_t *buffer, int32_t start, int32_t sample_count, int32_t term, int32_t delta, int32_t *weight)
+{
+    int32_t weight_A = *weight, i;
+
+    for (i = start; i < sample_count; i++) {
+        int32_t sam = buffer [i - term], tmp = buffer [i];
+
+        buffer [i] = apply_weight (weight_A, sam) + tmp;
+        update_weight (weight_A, delta, sam, tmp);
+    }
+
+    *weight = weight_A;
+}
+
+static void stereo_term_c (int32_t *buffer, int32_t start, int32_t sample_count, int32_t term, int32_t delta, int32_t *weight_A, int32_t *weight_B)
+{
+    int32_t wa = *weight_A, wb = *weight_B, i;
+
+    for (i = start; i < sample_count; i++) {
+        int32_t *bptr = buffer + i * 2, sam, tmp;
+
+        sam = bptr [-term * 2];
+        bptr [0] = apply_weight (wa, sam) + (tmp = bptr [0]);
+        update_weight (wa, delta, sam, tmp);
+
+        sam = bptr [-term * 2 + 1];
+        bptr [1] = apply_weight (wb, sam) + (tmp = bptr [1]);
+        update_weight (wb, delta, sam, tmp);
+    }
+
+    *weight_A = wa;
+    *weight_B = wb;
+}
+
+// Terms 17, 18 and the negative terms keep their history in the dpp, so
+// these just carry on from where the regular pass left off. The history and
+// weights are held in locals, as the compiler can't keep the dpp fields in
+// registers across the stores to the buffer.
+
+static void mono_pass_17_18_c (struct decorr_pass *dpp, int32_t *buffer, int32_t sample_count)
+{
+    int32_t delta = dpp->delta, weight_A = dpp->weight_A;
+    int32_t sam_0 = dpp->samples_A [0], sam_1 = dpp->samples_A [1];
+    int32_t *bptr, *eptr = buffer + sample_count;
+
+    if (dpp->term == 17)
+        for (bptr = buffer; bptr < eptr; bptr++) {
+            int32_t sam = 2 * sam_0 - sam_1, tmp = bptr [0];
+
+            sam_1 = sam_0;
+            bptr [0] = sam_0 = apply_weight (weight_A, sam) + tmp;
+            update_weight (weight_A, delta, sam, tmp);
+        }
+    else
+        for (bptr = buffer; bptr < eptr; bptr++) {
+            int32_t sam = (3 * sam_0 - sam_1) >> 1, tmp = bptr [0];
+
+            sam_1 = sam_0;
+            bptr [0] = sam_0 = apply_weight (weight_A, sam) + tmp;
+            update_weight (weight_A, delta, sam, tmp);
+        }
+
+    dpp->weight_A = weight_A;
+    dpp->samples_A [0] = sam_0;
+    dpp->samples_A [1] = sam_1;
+}
+
+static void stereo_pass_other_c (struct decorr_pass *dpp, int32_t *buffer, int32_t sample_count)
+{
+    int32_t delta = dpp->delta, weight_A = dpp->weight_A, weight_B = dpp->weight_B;
+    int32_t sam_A0 = dpp->samples_A [0], sam_A1 = dpp->samples_A [1];
+    int32_t sam_B0 = dpp->samples_B [0], sam_B1 = dpp->samples_B [1];
+    int32_t *bptr, *eptr = buffer + (sample_count * 2);
+
+    switch (dpp->term) {
+        case 17:
+            for (bptr = buffer; bptr < eptr; bptr += 2) {
+                int32_t sam, tmp;
+
+                sam = 2 * sam_A0 - sam_A1;
+                sam_A1 = sam_A0;
+                bptr [0] = sam_A0 = apply_weight (weight_A, sam) + (tmp = bptr [0]);
+                update_weight (weight_A, delta, sam, tmp);
+
+                sam = 2 * sam_B0 - sam_B1;
+                sam_B1 = sam_B0;
+                bptr [1] = sam_B0 = apply_weight (weight_B, sam) + (tmp = bptr [1]);
+                update_weight (weight_B, delta, sam, tmp);
+            }
+
+            break;
+
+        case 18:
+            for (bptr = buffer; bptr < eptr; bptr += 2) {
+                int32_t sam, tmp;
+
+                sam = sam_A0 + ((sam_A0 - sam_A1) >> 1);
+                sam_A1 = sam_A0;
+                bptr [0] = sam_A0 = apply_weight (weight_A, sam) + (tmp = bptr [0]);
+                update_weight (weight_A, delta, sam, tmp);
+
+                sam = sam_B0 + ((sam_B0 - sam_B1) >> 1);
+                sam_B1 = sam_B0;
+                bptr [1] = sam_B0 = apply_weight (weight_B, sam) + (tmp = bptr [1]);
+                update_weight (weight_B, delta, sam, tmp);
+            }
+
+            break;
+
+        case -1:
+            for (bptr = buffer; bptr < eptr; bptr += 2) {
+                int32_t sam;
+
+                sam = bptr [0] + apply_weight (weight_A, sam_A0);
+                update_weight_clip (weight_A, delta, sam_A0, bptr [0]);
+                bptr [0] = sam;
+                sam_A0 = bptr [1] + apply_weight (weight_B, sam);
+                update_weight_clip (weight_B, delta, sam, bptr [1]);
+                bptr [1] = sam_A0;
+            }
+
+            break;
+
+        case -2:
+            for (bptr = buffer; bptr < eptr; bptr += 2) {
+                int32_t sam;
+
+                sam = bptr [1] + apply_weight (weight_B, sam_B0);
+                update_weight_clip (weight_B, delta, sam_B0, bptr [1]);
+                bptr [1] = sam;
+                sam_B0 = bptr [0] + apply_weight (weight_A, sam);
+                update_weight_clip (weight_A, delta, sam, bptr [0]);
+                bptr [0] = sam_B0;
+            }
+
+            break;
+
+        case -3:
+            for (bptr = buffer; bptr < eptr; bptr += 2) {
+                int32_t sam_A, sam_B;
+
+                sam_A = bptr [0] + apply_weight (weight_A, sam_A0);
+                update_weight_clip (weight_A, delta, sam_A0, bptr [0]);
+                sam_B = bptr [1] + apply_weight (weight_B, sam_B0);
+                update_weight_clip (weight_B, delta, sam_B0, bptr [1]);
+                bptr [0] = sam_B0 = sam_A;
+                bptr [1] = sam_A0 = sam_B;
+            }
+
+            break;
+    }
+
+    dpp->weight_A = weight_A;
+    dpp->weight_B = weight_B;
+    dpp->samples_A [0] = sam_A0;
+    dpp->samples_A [1] = sam_A1;
+    dpp->samples_B [0] = sam_B0;
+    dpp->samples_B [1] = sam_B1;
+}
+
+//////////////////////////////// SSE4.1 / AVX2 //////////////////////////////
+
+#ifdef UNPACK_SSE41
+
+static int cpu_has_sse41 (void)
+{
+    return __builtin_cpu_supports ("sse4.1");
+}
+
+static int cpu_has_avx2 (void)
+{
+    return __builtin_cpu_supports ("avx2");
+}
+
+// The long version is the same arithmetic as apply_weight_f(), which gives
+// the same result as apply_weight_i() whenever that one is used
+
+#define SSE_WEIGHT_FUNCS(suffix, vec, mullo, srai, add, and, andnot, set1)            \
+static inline vec apply_weight_ ## suffix (vec weight, vec sam, int long_math)        \
+{                                                                                     \
+    if (!long_math)                                                                   \
+        return srai (add (mullo (weight, sam), set1 (512)), 10);                      \
+    else {                                                                            \
+        vec mask = set1 (0xffff);                                                     \
+        vec lo = srai (mullo (and (sam, mask), weight), 9);                           \
+        vec hi = mullo (srai (andnot (mask, sam), 9), weight);                        \
+        return srai (add (add (lo, hi), set1 (1)), 1);                                \
+    }                                                                                 \
+}
+
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+TARGET_SSE41 SSE_WEIGHT_FUNCS(sse41, __m128i, _mm_mullo_epi32, _mm_srai_epi32, _mm_add_epi32,
+    _mm_and_si128, _mm_andnot_si128, _mm_set1_epi32)
+
+TARGET_AVX2 SSE_WEIGHT_FUNCS(avx2, __m256i, _mm256_mullo_epi32, _mm256_srai_epi32, _mm256_add_epi32,
+    _mm256_and_si256, _mm256_andnot_si256, _mm256_set1_epi32)
+
+// Weight changes for each lane, as update_weight() would make them:
+// +delta or -delta by the signs of the source and the residual, or 0 if
+// either is zero
+
+TARGET_SSE41 static inline __m128i weight_updates_sse41 (__m128i sam, __m128i tmp, __m128i delta)
+{
+    __m128i zero = _mm_setzero_si128 ();
+    __m128i s = _mm_srai_epi32 (_mm_xor_si128 (sam, tmp), 31);
+    __m128i d = _mm_sub_epi32 (_mm_xor_si128 (delta, s), s);
+    __m128i none = _mm_or_si128 (_mm_cmpeq_epi32 (sam, zero), _mm_cmpeq_epi32 (tmp, zero));
+
+    return _mm_andnot_si128 (none, d);
+}
+
+TARGET_AVX2 static inline __m256i weight_updates_avx2 (__m256i sam, __m256i tmp, __m256i delta)
+{
+    __m256i zero = _mm256_setzero_si256 ();
+    __m256i s = _mm256_srai_epi32 (_mm256_xor_si256 (sam, tmp), 31);
+    __m256i d = _mm256_sub_epi32 (_mm256_xor_si256 (delta, s), s);
+    __m256i none = _mm256_or_si256 (_mm256_cmpeq_epi32 (sam, zero), _mm256_cmpeq_epi32 (tmp, zero));
+
+    return _mm256_andnot_si256 (none, d);
+}
+
+// The kernels keep the last results in registers and take the samples
+// "term" back from them, rather than loading them from the buffer, as a load
+// straddling the previous stores can't be forwarded from them and would
+// stall every iteration. Even so, each iteration has to wait for the one
+// "term" back, so they are only used where that is at least two vectors
+// back (or one AVX2 vector for mono) and more than one can be in flight.
+// The shorter terms are faster in plain C, which can overlap the "term"
+// separate chains. They return the count done.
+
+// Four mono samples at a time, for term 8
+
+TARGET_SSE41 static int32_t mono_term_sse41 (int32_t *buffer, int32_t sample_count, int32_t delta, int32_t *weight, int long_math)
+{
+    __m128i weight_A = _mm_set1_epi32 (*weight), delta_v = _mm_set1_epi32 (delta);
+    __m128i h1 = _mm_loadu_si128 ((__m128i *) (buffer - 4));
+    __m128i h2 = _mm_loadu_si128 ((__m128i *) (buffer - 8));
+    int32_t i;
+
+    for (i = 0; i + 4 <= sample_count; i += 4) {
+        __m128i tmp = _mm_loadu_si128 ((__m128i *) (buffer + i));
+        __m128i d = weight_updates_sse41 (h2, tmp, delta_v);
+        __m128i sum = _mm_add_epi32 (d, _mm_slli_si128 (d, 4)), w, out;
+
+        sum = _mm_add_epi32 (sum, _mm_slli_si128 (sum, 8));
+        w = _mm_add_epi32 (weight_A, _mm_sub_epi32 (sum, d));
+
+        out = _mm_add_epi32 (tmp, apply_weight_sse41 (w, h2, long_math));
+        _mm_storeu_si128 ((__m128i *) (buffer + i), out);
+        weight_A = _mm_add_epi32 (weight_A, _mm_shuffle_epi32 (sum, 0xff));
+        h2 = h1;
+        h1 = out;
+    }
+
+    *weight = _mm_cvtsi128_si32 (weight_A);
+    return i;
+}
+
+// The two stereo samples starting "term" back, from the last eight results
+// (h1 the newest, h4 the oldest)
+
+TARGET_SSE41 static inline __m128i stereo_window_sse41 (__m128i h2, __m128i h3, __m128i h4, int32_t term)
+{
+    switch (term) {
+        case 4: return h2;
+        case 5: return _mm_alignr_epi8 (h2, h3, 8);
+        case 6: return h3;
+        case 7: return _mm_alignr_epi8 (h3, h4, 8);
+        default: return h4;
+    }
+}
+
+// Two stereo samples at a time, for terms 4-8. Odd terms do the first
+// sample in C so the history lines up with the stores.
+
+TARGET_SSE41 static int32_t stereo_term_sse41 (int32_t *buffer, int32_t sample_count, int32_t term, int32_t delta, int32_t *weight_A, int32_t *weight_B, int long_math)
+{
+    int32_t i = term & 1;
+    __m128i h1, h2, h3, h4, weights, delta_v = _mm_set1_epi32 (delta);
+
+    stereo_term_c (buffer, 0, i, term, delta, weight_A, weight_B);
+    weights = _mm_set_epi32 (*weight_B, *weight_A, *weight_B, *weight_A);
+    h1 = _mm_loadu_si128 ((__m128i *) (buffer + (i - 2) * 2));
+    h2 = _mm_loadu_si128 ((__m128i *) (buffer + (i - 4) * 2));
+    h3 = term > 4 ? _mm_loadu_si128 ((__m128i *) (buffer + (i - 6) * 2)) : h2;
+    h4 = term > 6 ? _mm_loadu_si128 ((__m128i *) (buffer + (i - 8) * 2)) : h3;
+
+    for (; i + 2 <= sample_count; i += 2) {
+        __m128i sam = stereo_window_sse41 (h2, h3, h4, term);
+        __m128i tmp = _mm_loadu_si128 ((__m128i *) (buffer + i * 2));
+        __m128i d = weight_updates_sse41 (sam, tmp, delta_v);
+        __m128i w = _mm_add_epi32 (weights, _mm_slli_si128 (d, 8));
+
+        h4 = h3; h3 = h2; h2 = h1;
+        h1 = _mm_add_epi32 (tmp, apply_weight_sse41 (w, sam, long_math));
+        _mm_storeu_si128 ((__m128i *) (buffer + i * 2), h1);
+        weights = _mm_add_epi32 (weights, _mm_add_epi32 (d, _mm_shuffle_epi32 (d, 0x4e)));
+    }
+
+    *weight_A = _mm_cvtsi128_si32 (weights);
+    *weight_B = _mm_extract_epi32 (weights, 1);
+    return i;
+}
+
+// Shifts the eight lanes up by one sample (one lane for mono, two for
+// stereo), filling with zeros
+
+TARGET_AVX2 static inline __m256i shift_up_1_avx2 (__m256i v)
+{
+    return _mm256_alignr_epi8 (v, _mm256_permute2x128_si256 (v, v, 0x08), 12);
+}
+
+TARGET_AVX2 static inline __m256i shift_up_2_avx2 (__m256i v)
+{
+    return _mm256_alignr_epi8 (v, _mm256_permute2x128_si256 (v, v, 0x08), 8);
+}
+
+TARGET_AVX2 static inline __m256i shift_up_4_avx2 (__m256i v)
+{
+    return _mm256_permute2x128_si256 (v, v, 0x08);
+}
+
+// Eight mono samples at a time, for term 8
+
+TARGET_AVX2 static int32_t mono_term_avx2 (int32_t *buffer, int32_t sample_count, int32_t delta, int32_t *weight, int long_math)
+{
+    __m256i weight_A = _mm256_set1_epi32 (*weight), delta_v = _mm256_set1_epi32 (delta);
+    __m256i h1 = _mm256_loadu_si256 ((__m256i *) (buffer - 8)), last = _mm256_set1_epi32 (7);
+    int32_t i;
+
+    for (i = 0; i + 8 <= sample_count; i += 8) {
+        __m256i tmp = _mm256_loadu_si256 ((__m256i *) (buffer + i));
+        __m256i d = weight_updates_avx2 (h1, tmp, delta_v);
+        __m256i sum = _mm256_add_epi32 (d, shift_up_1_avx2 (d)), w;
+
+        sum = _mm256_add_epi32 (sum, shift_up_2_avx2 (sum));
+        sum = _mm256_add_epi32 (sum, shift_up_4_avx2 (sum));
+        w = _mm256_add_epi32 (weight_A, _mm256_sub_epi32 (sum, d));
+
+        h1 = _mm256_add_epi32 (tmp, apply_weight_avx2 (w, h1, long_math));
+        _mm256_storeu_si256 ((__m256i *) (buffer + i), h1);
+        weight_A = _mm256_add_epi32 (weight_A, _mm256_permutevar8x32_epi32 (sum, last));
+    }
+
+    *weight = _mm256_cvtsi256_si32 (weight_A);
+    return i;
+}
+
+// Four stereo samples at a time, for term 8
+
+TARGET_AVX2 static int32_t stereo_term_avx2 (int32_t *buffer, int32_t sample_count, int32_t delta, int32_t *weight_A, int32_t *weight_B, int long_math)
+{
+    __m256i weights = _mm256_set_epi32 (*weight_B, *weight_A, *weight_B, *weight_A, *weight_B, *weight_A, *weight_B, *weight_A);
+    __m256i delta_v = _mm256_set1_epi32 (delta), last = _mm256_set_epi32 (7, 6, 7, 6, 7, 6, 7, 6);
+    __m256i h1 = _mm256_loadu_si256 ((__m256i *) (buffer - 8));
+    __m256i h2 = _mm256_loadu_si256 ((__m256i *) (buffer - 16));
+    int32_t i;
+
+    for (i = 0; i + 4 <= sample_count; i += 4) {
+        __m256i tmp = _mm256_loadu_si256 ((__m256i *) (buffer + i * 2));
+        __m256i d = weight_updates_avx2 (h2, tmp, delta_v);
+        __m256i sum = _mm256_add_epi32 (d, shift_up_2_avx2 (d)), w, out;
+
+        sum = _mm256_add_epi32 (sum, shift_up_4_avx2 (sum));
+        w = _mm256_add_epi32 (weights, _mm256_sub_epi32 (sum, d));
+
+        out = _mm256_add_epi32 (tmp, apply_weight_avx2 (w, h2, long_math));
+        _mm256_storeu_si256 ((__m256i *) (buffer + i * 2), out);
+        weights = _mm256_add_epi32 (weights, _mm256_permutevar8x32_epi32 (sum, last));
+        h2 = h1;
+        h1 = out;
+    }
+
+    *weight_A = _mm256_cvtsi256_si32 (weights);
+    *weight_B = _mm256_extract_epi32 (weights, 1);
+    return i;
+}
+
+TARGET_SSE41 static void clip_shift_sse41 (int32_t *buffer, uint32_t count, int32_t min_value, int32_t max_value, int shift)
+{
+    __m128i min_v = _mm_set1_epi32 (min_value), max_v = _mm_set1_epi32 (max_value);
+    __m128i shift_v = _mm_cvtsi32_si128 (shift);
+
+    for (; count >= 4; count -= 4, buffer += 4) {
+        __m128i v = _mm_loadu_si128 ((__m128i *) buffer);
+        v = _mm_min_epi32 (_mm_max_epi32 (v, min_v), max_v);
+        _mm_storeu_si128 ((__m128i *) buffer, _mm_sll_epi32 (v, shift_v));
+    }
+
+    for (; count; count--, buffer++)
+        *buffer = (*buffer < min_value ? min_value : *buffer > max_value ? max_value : *buffer) << shift;
+}
+
+TARGET_AVX2 static void clip_shift_avx2 (int32_t *buffer, uint32_t count, int32_t min_value, int32_t max_value, int shift)
+{
+    __m256i min_v = _mm256_set1_epi32 (min_value), max_v = _mm256_set1_epi32 (max_value);
+    __m128i shift_v = _mm_cvtsi32_si128 (shift);
+
+    for (; count >= 8; count -= 8, buffer += 8) {
+        __m256i v = _mm256_loadu_si256 ((__m256i *) buffer);
+        v = _mm256_min_epi32 (_mm256_max_epi32 (v, min_v), max_v);
+        _mm256_storeu_si256 ((__m256i *) buffer, _mm256_sll_epi32 (v, shift_v));
+    }
+
+    clip_shift_sse41 (buffer, count, min_value, max_value, shift);
+}
+
+static void shift_sse2 (int32_t *buffer, uint32_t count, int shift)
+{
+    __m128i shift_v = _mm_cvtsi32_si128 (shift);
+
+    for (; count >= 4; count -= 4, buffer += 4)
+        _mm_storeu_si128 ((__m128i *) buffer, _mm_sll_epi32 (_mm_loadu_si128 ((__m128i *) buffer), shift_v));
+
+    for (; count; count--)
+        *buffer++ <<= shift;
+}
+
+TARGET_AVX2 static void shift_avx2 (int32_t *buffer, uint32_t count, int shift)
+{
+    __m128i shift_v = _mm_cvtsi32_si128 (shift);
+
+    for (; count >= 8; count -= 8, buffer += 8)
+        _mm256_storeu_si256 ((__m256i *) buffer, _mm256_sll_epi32 (_mm256_loadu_si256 ((__m256i *) buffer), shift_v));
+
+    shift_sse2 (buffer, count, shift);
+}
+
+#endif
+
+//////////////////////////////////// NEON ///////////////////////////////////
+
+#ifdef UNPACK_NEON
+
+static inline int32x4_t apply_weight_neon (int32x4_t weight, int32x4_t sam, int long_math)
+{
+    if (!long_math)
+        return vshrq_n_s32 (vaddq_s32 (vmulq_s32 (weight, sam), vdupq_n_s32 (512)), 10);
+    else {
+        int32x4_t mask = vdupq_n_s32 (0xffff);
+        int32x4_t lo = vshrq_n_s32 (vmulq_s32 (vandq_s32 (sam, mask), weight), 9);
+        int32x4_t hi = vmulq_s32 (vshrq_n_s32 (vbicq_s32 (sam, mask), 9), weight);
+        return vshrq_n_s32 (vaddq_s32 (vaddq_s32 (lo, hi), vdupq_n_s32 (1)), 1);
+    }
+}
+
+static inline int32x4_t weight_updates_neon (int32x4_t sam, int32x4_t tmp, int32x4_t delta)
+{
+    int32x4_t s = vshrq_n_s32 (veorq_s32 (sam, tmp), 31);
+    int32x4_t d = vsubq_s32 (veorq_s32 (delta, s), s);
+    uint32x4_t none = vorrq_u32 (vceqzq_s32 (sam), vceqzq_s32 (tmp));
+
+    return vbicq_s32 (d, vreinterpretq_s32_u32 (none));
+}
+
+// Same as the SSE4.1 versions
+
+static int32_t mono_term_neon (int32_t *buffer, int32_t sample_count, int32_t delta, int32_t *weight, int long_math)
+{
+    int32x4_t weight_A = vdupq_n_s32 (*weight), delta_v = vdupq_n_s32 (delta), zero = vdupq_n_s32 (0);
+    int32x4_t h1 = vld1q_s32 (buffer - 4), h2 = vld1q_s32 (buffer - 8);
+    int32_t i;
+
+    for (i = 0; i + 4 <= sample_count; i += 4) {
+        int32x4_t tmp = vld1q_s32 (buffer + i);
+        int32x4_t d = weight_updates_neon (h2, tmp, delta_v);
+        int32x4_t sum = vaddq_s32 (d, vextq_s32 (zero, d, 3)), out;
+
+        sum = vaddq_s32 (sum, vextq_s32 (zero, sum, 2));
+        out = vaddq_s32 (tmp, apply_weight_neon (vaddq_s32 (weight_A, vsubq_s32 (sum, d)), h2, long_math));
+        vst1q_s32 (buffer + i, out);
+        weight_A = vaddq_s32 (weight_A, vdupq_laneq_s32 (sum, 3));
+        h2 = h1;
+        h1 = out;
+    }
+
+    *weight = vgetq_lane_s32 (weight_A, 0);
+    return i;
+}
+
+static inline int32x4_t stereo_window_neon (int32x4_t h2, int32x4_t h3, int32x4_t h4, int32_t term)
+{
+    switch (term) {
+        case 4: return h2;
+        case 5: return vextq_s32 (h3, h2, 2);
+        case 6: return h3;
+        case 7: return vextq_s32 (h4, h3, 2);
+        default: return h4;
+    }
+}
+
+static int32_t stereo_term_neon (int32_t *buffer, int32_t sample_count, int32_t term, int32_t delta, int32_t *weight_A, int32_t *weight_B, int long_math)
+{
+    int32_t i = term & 1, init [4];
+    int32x4_t delta_v = vdupq_n_s32 (delta), zero = vdupq_n_s32 (0);
+    int32x4_t h1, h2, h3, h4, weights;
+
+    stereo_term_c (buffer, 0, i, term, delta, weight_A, weight_B);
+    init [0] = init [2] = *weight_A;
+    init [1] = init [3] = *weight_B;
+    weights = vld1q_s32 (init);
+    h1 = vld1q_s32 (buffer + (i - 2) * 2);
+    h2 = vld1q_s32 (buffer + (i - 4) * 2);
+    h3 = term > 4 ? vld1q_s32 (buffer + (i - 6) * 2) : h2;
+    h4 = term > 6 ? vld1q_s32 (buffer + (i - 8) * 2) : h3;
+
+    for (; i + 2 <= sample_count; i += 2) {
+        int32x4_t sam = stereo_window_neon (h2, h3, h4, term);
+        int32x4_t tmp = vld1q_s32 (buffer + i * 2);
+        int32x4_t d = weight_updates_neon (sam, tmp, delta_v);
+        int32x4_t w = vaddq_s32 (weights, vextq_s32 (zero, d, 2));
+
+        h4 = h3; h3 = h2; h2 = h1;
+        h1 = vaddq_s32 (tmp, apply_weight_neon (w, sam, long_math));
+        vst1q_s32 (buffer + i * 2, h1);
+        weights = vaddq_s32 (weights, vaddq_s32 (d, vextq_s32 (d, d, 2)));
+    }
+
+    *weight_A = vgetq_lane_s32 (weights, 0);
+    *weight_B = vgetq_lane_s32 (weights, 1);
+    return i;
+}
+
+static void clip_shift_neon (int32_t *buffer, uint32_t count, int32_t min_value, int32_t max_value, int shift)
+{
+    int32x4_t min_v = vdupq_n_s32 (min_value), max_v = vdupq_n_s32 (max_value), shift_v = vdupq_n_s32 (shift);
+
+    for (; count >= 4; count -= 4, buffer += 4)
+        vst1q_s32 (buffer, vshlq_s32 (vminq_s32 (vmaxq_s32 (vld1q_s32 (buffer), min_v), max_v), shift_v));
+
+    for (; count; count--, buffer++)
+        *buffer = (*buffer < min_value ? min_value : *buffer > max_value ? max_value : *buffer) << shift;
+}
+
+static void shift_neon (int32_t *buffer, uint32_t count, int shift)
+{
+    int32x4_t shift_v = vdupq_n_s32 (shift);
+
+    for (; count >= 4; count -= 4, buffer += 4)
+        vst1q_s32 (buffer, vshlq_s32 (vld1q_s32 (buffer), shift_v));
+
+    for (; count; count--)
+        *buffer++ <<= shift;
+}
+
+#endif
+
+///////////////////////////// executable code ////////////////////////////////
+
+// Continue the mono decorrelation pass for the given dpp from the point
+// where the first samples were done by decorr_mono_pass() in unpack.c (the
+// term, or 2 for terms 17 and 18). The buffer points past those samples.
+
+void unpack_decorr_mono_pass_cont_simd (struct decorr_pass *dpp, int32_t *buffer, int32_t sample_count, int32_t long_math)
+{
+    int32_t term = dpp->term, weight_A = dpp->weight_A, done = 0, k;
+
+    if (term > MAX_TERM) {
+        mono_pass_17_18_c (dpp, buffer, sample_count);
+        return;
+    }
+
+#ifdef UNPACK_SSE41
+    if (term == 8 && cpu_has_avx2 ())
+        done = mono_term_avx2 (buffer, sample_count, dpp->delta, &weight_A, long_math);
+    else if (term == 8 && cpu_has_sse41 ())
+        done = mono_term_sse41 (buffer, sample_count, dpp->delta, &weight_A, long_math);
+#else
+    if (term == 8)
+        done = mono_term_neon (buffer, sample_count, dpp->delta, &weight_A, long_math);
+#endif
+
+    mono_term_c (buffer, done, sample_count, term, dpp->delta, &weight_A);
+
+    dpp->weight_A = weight_A;
+
+    for (k = 0; k < term; k++)
+        dpp->samples_A [k] = buffer [sample_count - term + k];
+}
+
+// Continue the stereo decorrelation pass for the given dpp from the point
+// where the first samples were done by decorr_stereo_pass() in unpack.c (the
+// term, or 2 for terms 17 and 18 and the negative terms). The buffer points
+// past those samples.
+
+void unpack_decorr_stereo_pass_cont_simd (struct decorr_pass *dpp, int32_t *buffer, int32_t sample_count, int32_t long_math)
+{
+    int32_t term = dpp->term, weight_A = dpp->weight_A, weight_B = dpp->weight_B, done = 0, k;
+
+    if (term < 0 || term > MAX_TERM) {
+        stereo_pass_other_c (dpp, buffer, sample_count);
+        return;
+    }
+
+#ifdef UNPACK_SSE41
+    if (term == 8 && cpu_has_avx2 ())
+        done = stereo_term_avx2 (buffer, sample_count, dpp->delta, &weight_A, &weight_B, long_math);
+    else if (term >= 4 && cpu_has_sse41 ())
+        done = stereo_term_sse41 (buffer, sample_count, term, dpp->delta, &weight_A, &weight_B, long_math);
+#else
+    if (term >= 4)
+        done = stereo_term_neon (buffer, sample_count, term, dpp->delta, &weight_A, &weight_B, long_math);
+#endif
+
+    stereo_term_c (buffer, done, sample_count, term, dpp->delta, &weight_A, &weight_B);
+
+    dpp->weight_A = weight_A;
+    dpp->weight_B = weight_B;
+
+    for (k = 0; k < term; k++) {
+        dpp->samples_A [k] = buffer [(sample_count - term + k) * 2];
+        dpp->samples_B [k] = buffer [(sample_count - term + k) * 2 + 1];
+    }
+}
+
+// Clip the lossy samples to the given range and apply the final shift,
+// as in fixup_samples()
+
+void unpack_clip_shift_simd (int32_t *buffer, uint32_t count, int32_t min_value, int32_t max_value, int shift)
+{
+#ifdef UNPACK_SSE41
+    if (cpu_has_avx2 ())
+        clip_shift_avx2 (buffer, count, min_value, max_value, shift);
+    else if (cpu_has_sse41 ())
+        clip_shift_sse41 (buffer, count, min_value, max_value, shift);
+    else
+        for (; count; count--, buffer++)
+            *buffer = (*buffer < min_value ? min_value : *buffer > max_value ? max_value : *buffer) << shift;
+#else
+    clip_shift_neon (buffer, count, min_value, max_value, shift);
+#endif
+}
+
+void unpack_shift_simd (int32_t *buffer, uint32_t count, int shift)
+{
+#ifdef UNPACK_SSE41
+    if (cpu_has_avx2 ())
+        shift_avx2 (buffer, count, shift);
+    else
+        shift_sse2 (buffer, count, shift);
+#else
+    shift_neon (buffer, count, shift);
+#endif
+}
+
+#endif
@@ -0,0 +1,326 @@
+////////////////////////////////////////////////////////////////////////////
+//                           **** WAVPACK ****                            //
+//                  Hybrid Lossless Wavefile Compressor                   //
+//              Copyright (c) 1998 - 2013 Conifer Software.               //
+//                          All Rights Reserved.                          //
+//      Distributed under the BSD Software License (see license.txt)      //
+////////////////////////////////////////////////////////////////////////////
+
+// wvdecodebench.c
+
+// Times decoding of synthetic 16 and 24-bit, mono and stereo files in each
+// mode (fast, normal, high, very high, extra and hybrid lossy). The files
+// are encoded in memory with the library itself, so no test material is
+// needed. Lossless output must match the source exactly, and every block
+// must pass its CRC, which for hybrid lossy files covers the encoder's own
+// reconstruction of the samples.
+//
+// The Makefile builds this twice, against unpack.c with and without the
+// passes in unpack_simd.c, so the two can be compared.
+//
+// usage: wvdecodebench [seconds of audio]
+//
+// Returns non-zero if any file fails to decode exactly.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "../Files/wavpack.h"
+
+#define SAMPLE_RATE 44100
+
+struct mode {
+    const char *name;
+    int flags, xmode;
+    float bitrate;
+};
+
+static const struct mode modes [] = {
+    { "fast", CONFIG_FAST_FLAG, 0, 0.0 },
+    { "normal", 0, 0, 0.0 },
+    { "high", CONFIG_HIGH_FLAG, 0, 0.0 },
+    { "very high", CONFIG_HIGH_FLAG | CONFIG_VERY_HIGH_FLAG, 0, 0.0 },
+    { "extra", CONFIG_HIGH_FLAG | CONFIG_EXTRA_MODE, 4, 0.0 },
+    { "hybrid lossy", CONFIG_HYBRID_FLAG, 0, 4.0 },
+};
+
+struct format {
+    const char *name;
+    int bits, num_chans;
+};
+
+static const struct format formats [] = {
+    { "16-bit mono", 16, 1 },
+    { "16-bit stereo", 16, 2 },
+    { "24-bit mono", 24, 1 },
+    { "24-bit stereo", 24, 2 },
+};
+
+// The encoded file, and the read position while decoding
+
+typedef struct {
+    unsigned char *data;
+    int64_t size, alloc, pos;
+} memory_file;
+
+static int write_block (void *id, void *data, int32_t bcount)
+{
+    memory_file *file = id;
+
+    if (file->size + bcount > file->alloc) {
+        file->alloc = (file->size + bcount) * 2;
+        file->data = realloc (file->data, file->alloc);
+
+        if (!file->data)
+            return 0;
+    }
+
+    memcpy (file->data + file->size, data, bcount);
+    file->size += bcount;
+    return 1;
+}
+
+static int32_t read_bytes (void *id, void *data, int32_t bcount)
+{
+    memory_file *file = id;
+
+    if (bcount > file->size - file->pos)
+        bcount = (int32_t) (file->size - file->pos);
+
+    memcpy (data, file->data + file->pos, bcount);
+    file->pos += bcount;
+    return bcount;
+}
+
+static int64_t get_pos (void *id)
+{
+    return ((memory_file *) id)->pos;
+}
+
+static int set_pos_abs (void *id, int64_t pos)
+{
+    memory_file *file = id;
+
+    file->pos = pos < 0 ? 0 : pos > file->size ? file->size : pos;
+    return 0;
+}
+
+static int set_pos_rel (void *id, int64_t delta, int mode)
+{
+    memory_file *file = id;
+
+    if (mode == SEEK_CUR)
+        delta += file->pos;
+    else if (mode == SEEK_END)
+        delta += file->size;
+
+    return set_pos_abs (id, delta);
+}
+
+static int push_back_byte (void *id, int c)
+{
+    memory_file *file = id;
+
+    if (!file->pos)
+        return EOF;
+
+    file->pos--;
+    return c;
+}
+
+static int64_t get_length (void *id)
+{
+    return ((memory_file *) id)->size;
+}
+
+static int can_seek (void *id)
+{
+    return 1;
+}
+
+static WavpackStreamReader64 memory_reader = {
+    read_bytes, NULL, get_pos, set_pos_abs, set_pos_rel, push_back_byte, get_length, can_seek, NULL, NULL
+};
+
+static uint32_t random_state = 0x2545F491;
+
+static uint32_t next_random (void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+// A few slowly changing tones with some noise, and a different mix in each
+// channel so joint stereo and the cross channel terms have work to do
+
+static void make_signal (int32_t *samples, int32_t sample_count, int num_chans, int bits)
+{
+    double scale = (1 << (bits - 1)) - 1;
+    int32_t i;
+    int chan;
+
+    for (i = 0; i < sample_count; ++i) {
+        double t = (double) i / SAMPLE_RATE, envelope = 0.5 + 0.4 * sin (t * 0.7);
+
+        for (chan = 0; chan < num_chans; ++chan) {
+            double value = 0.35 * sin (2 * M_PI * (220.0 + chan * 0.5) * t) +
+                0.2 * sin (2 * M_PI * 331.0 * t + chan) +
+                0.1 * sin (2 * M_PI * 1759.0 * t) * envelope +
+                0.02 * ((double) (next_random () & 0xffff) / 32768.0 - 1.0);
+
+            samples [i * num_chans + chan] = (int32_t) floor (value * envelope * scale + 0.5);
+        }
+    }
+}
+
+static int encode (memory_file *file, const struct mode *mode, const struct format *format, int32_t *samples, int32_t sample_count)
+{
+    WavpackContext *wpc = WavpackOpenFileOutput (write_block, file, NULL);
+    WavpackConfig config;
+    int result;
+
+    memset (&config, 0, sizeof (config));
+    config.bits_per_sample = format->bits;
+    config.bytes_per_sample = format->bits / 8;
+    config.num_channels = format->num_chans;
+    config.channel_mask = format->num_chans == 1 ? 0x4 : 0x3;
+    config.sample_rate = SAMPLE_RATE;
+    config.flags = mode->flags;
+    config.xmode = mode->xmode;
+    config.bitrate = mode->bitrate;
+
+    result = wpc && WavpackSetConfiguration64 (wpc, &config, sample_count, NULL) &&
+        WavpackPackInit (wpc) && WavpackPackSamples (wpc, samples, sample_count) &&
+        WavpackFlushSamples (wpc);
+
+    if (wpc)
+        WavpackCloseFile (wpc);
+
+    return result;
+}
+
+static double now (void)
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Decodes the whole file and returns the time taken, or a negative value if
+// the file can't be opened, or the output or any block CRC is wrong
+
+static double decode (memory_file *file, const struct mode *mode, const int32_t *samples, int32_t sample_count, int num_chans)
+{
+    int32_t buffer [4096 * 2], done = 0, count;
+    char error [80];
+    WavpackContext *wpc;
+    double start = now ();
+    int errors;
+
+    file->pos = 0;
+    wpc = WavpackOpenFileInputEx64 (&memory_reader, file, NULL, error, 0, 0);
+
+    if (!wpc) {
+        printf ("\n  can't open: %s", error);
+        return -1.0;
+    }
+
+    while ((count = WavpackUnpackSamples (wpc, buffer, 4096)) != 0) {
+        if (!(mode->flags & CONFIG_HYBRID_FLAG) &&
+            (done + count > sample_count || memcmp (buffer, samples + done * num_chans, count * num_chans * sizeof (int32_t)))) {
+                printf ("\n  output differs from the source after %d samples", done);
+                WavpackCloseFile (wpc);
+                return -1.0;
+        }
+
+        done += count;
+    }
+
+    errors = WavpackGetNumErrors (wpc);
+    WavpackCloseFile (wpc);
+
+    if (errors || done != sample_count) {
+        printf ("\n  %d CRC errors, %d of %d samples", errors, done, sample_count);
+        return -1.0;
+    }
+
+    return now () - start;
+}
+
+int main (int argc, char **argv)
+{
+    double seconds = argc > 1 ? atof (argv [1]) : 30.0;
+    int32_t sample_count = (int32_t) (seconds * SAMPLE_RATE);
+    int32_t *samples = malloc (sample_count * 2 * sizeof (int32_t));
+    int failed = 0;
+    size_t m, f;
+
+    if (!samples || sample_count <= 0)
+        return 1;
+
+#ifdef NO_UNPACK_SIMD
+    printf ("generic passes, %.0f seconds of audio\n", seconds);
+#else
+    printf ("unpack_simd.c passes, %.0f seconds of audio\n", seconds);
+#endif
+    printf ("%-14s", "");
+    for (f = 0; f < sizeof (formats) / sizeof (formats [0]); ++f)
+        printf (" %14s", formats [f].name);
+    printf ("   (x real time)\n");
+
+    for (m = 0; m < sizeof (modes) / sizeof (modes [0]); ++m) {
+        printf ("%-14s", modes [m].name);
+
+        for (f = 0; f < sizeof (formats) / sizeof (formats [0]); ++f) {
+            memory_file file;
+            double best = 0.0;
+            int pass;
+
+            memset (&file, 0, sizeof (file));
+            make_signal (samples, sample_count, formats [f].num_chans, formats [f].bits);
+
+            if (!encode (&file, &modes [m], &formats [f], samples, sample_count)) {
+                printf ("\n  can't encode %s", formats [f].name);
+                failed = 1;
+                free (file.data);
+                continue;
+            }
+
+            // best of three, after a first pass to warm up
+
+            for (pass = 0; pass < 4; ++pass) {
+                double elapsed = decode (&file, &modes [m], samples, sample_count, formats [f].num_chans);
+
+                if (elapsed < 0.0) {
+                    failed = 1;
+                    break;
+                }
+
+                if (pass && (!best || elapsed < best))
+                    best = elapsed;
+            }
+
+            free (file.data);
+
+            if (pass < 4)
+                printf ("\n%-14s", "");
+            else
+                printf (" %14.0f", seconds / best);
+
+            fflush (stdout);
+        }
+
+        printf ("\n");
+    }
+
+    free (samples);
+
+    printf (failed ? "FAILED\n" : "OK\n");
+
+    return failed;
+}
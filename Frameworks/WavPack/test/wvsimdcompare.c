@@ -0,0 +1,402 @@
+////////////////////////////////////////////////////////////////////////////
+//                           **** WAVPACK ****                            //
+//                  Hybrid Lossless Wavefile Compressor                   //
+//              Copyright (c) 1998 - 2013 Conifer Software.               //
+//                          All Rights Reserved.                          //
+//      Distributed under the BSD Software License (see license.txt)      //
+////////////////////////////////////////////////////////////////////////////
+
+// wvsimdcompare.c
+
+// Checks the continuation passes and sample fixups in unpack_simd.c against
+// the regular passes in unpack.c, bit for bit, for every term, both math
+// widths, odd block lengths and each dispatch level. Both sources are
+// included directly, so the static passes can be reached and the dispatch
+// forced. Levels the CPU lacks are skipped.
+//
+// The residuals are made by running each pass backwards over a synthetic
+// signal, as the encoder would, so that the decoded samples stay in the
+// range the math width is chosen for.
+//
+// usage: wvsimdcompare
+//
+// Returns non-zero if any level differs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static int allow_sse41 = 1, allow_avx2 = 1;
+static int test_cpu_supports (const char *feature);
+
+#define __builtin_cpu_supports(feature) test_cpu_supports (feature)
+#include "../Files/unpack.c"
+#include "../Files/unpack_simd.c"
+#undef __builtin_cpu_supports
+
+static int test_cpu_supports (const char *feature)
+{
+#if defined(__x86_64__)
+    if (!strcmp (feature, "avx2"))
+        return allow_avx2 && __builtin_cpu_supports ("avx2");
+
+    if (!strcmp (feature, "sse4.1"))
+        return allow_sse41 && __builtin_cpu_supports ("sse4.1");
+#endif
+    return 0;
+}
+
+struct level {
+    const char *name;
+    int sse41, avx2;
+};
+
+static const struct level levels [] = {
+#if defined(__x86_64__)
+    { "generic", 0, 0 },
+    { "SSE4.1", 1, 0 },
+    { "AVX2", 1, 1 },
+#else
+    { "NEON", 0, 0 },
+#endif
+};
+
+static int select_level (const struct level *lp)
+{
+#if defined(__x86_64__)
+    if ((lp->sse41 && !__builtin_cpu_supports ("sse4.1")) || (lp->avx2 && !__builtin_cpu_supports ("avx2")))
+        return FALSE;
+#endif
+    allow_sse41 = lp->sse41;
+    allow_avx2 = lp->avx2;
+    return TRUE;
+}
+
+static const int mono_terms [] = { 1, 2, 3, 4, 5, 6, 7, 8, 17, 18 };
+static const int stereo_terms [] = { 1, 2, 3, 4, 5, 6, 7, 8, 17, 18, -1, -2, -3 };
+static const int deltas [] = { 1, 2, 3, 7 };
+static const int lengths [] = { 16, 17, 23, 31, 64, 101, 255, 1001, 4097 };
+
+#define MAX_SAMPLES 4097
+
+static uint32_t random_state = 0x2545F491;
+
+static uint32_t next_random (void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static int32_t random_range (int32_t low, int32_t high)
+{
+    return low + (int32_t) (next_random () % (uint32_t) (high - low + 1));
+}
+
+// Tones and noise at the full scale of the given width, with some
+// stretches of clipping and silence to drive the weights about
+
+static void make_signal (int32_t *signal, int32_t sample_count, int num_chans, int bits)
+{
+    int32_t max_value = (1 << (bits - 1)) - 1, i;
+    double phase = random_range (0, 1000) * 0.01;
+
+    for (i = 0; i < sample_count * num_chans; ++i) {
+        double value = 0.6 * sin (phase + i * 0.013) + 0.3 * sin (i * 0.7 + (i % num_chans));
+        int32_t noise = random_range (-max_value / 16, max_value / 16), sam;
+
+        switch ((i / 512) % 4) {
+            case 2:
+                value *= 2.0;
+                break;
+
+            case 3:
+                value = 0.0;
+                noise >>= 6;
+                break;
+        }
+
+        sam = (int32_t) floor (value * max_value + 0.5) + noise;
+        signal [i] = sam < -max_value - 1 ? -max_value - 1 : sam > max_value ? max_value : sam;
+    }
+}
+
+// The sample "n" frames back on the given channel, from the history in
+// the dpp before the start of the block
+
+static int32_t history (const struct decorr_pass *dpp, const int32_t *signal, int32_t i, int chan, int num_chans)
+{
+    const int32_t *samples = chan ? dpp->samples_B : dpp->samples_A;
+
+    if (i >= 0)
+        return signal [i * num_chans + chan];
+
+    if (dpp->term > MAX_TERM)
+        return samples [-i - 1];
+
+    return samples [i + dpp->term];
+}
+
+// The encoder's side of decorr_mono_pass() and decorr_stereo_pass(): makes
+// the residuals that the pass turns back into the signal
+
+static void make_residuals (struct decorr_pass dpp, const int32_t *signal, int32_t *residuals, int32_t sample_count, int num_chans)
+{
+    int32_t i;
+    int chan;
+
+    for (i = 0; i < sample_count; ++i)
+        if (dpp.term > 0) {
+            for (chan = 0; chan < num_chans; ++chan) {
+                int32_t *weight = chan ? &dpp.weight_B : &dpp.weight_A;
+                int32_t sam, res;
+
+                if (dpp.term == 17)
+                    sam = 2 * history (&dpp, signal, i - 1, chan, num_chans) - history (&dpp, signal, i - 2, chan, num_chans);
+                else if (dpp.term == 18)
+                    sam = (3 * history (&dpp, signal, i - 1, chan, num_chans) - history (&dpp, signal, i - 2, chan, num_chans)) >> 1;
+                else
+                    sam = history (&dpp, signal, i - dpp.term, chan, num_chans);
+
+                res = signal [i * num_chans + chan] - apply_weight (*weight, sam);
+                residuals [i * num_chans + chan] = res;
+                update_weight (*weight, dpp.delta, sam, res);
+            }
+        }
+        else {
+            // negative terms keep the other channel's last sample in the dpp
+
+            int32_t left = signal [i * 2], right = signal [i * 2 + 1];
+            int32_t prev_left = i ? signal [i * 2 - 2] : dpp.samples_B [0];
+            int32_t prev_right = i ? signal [i * 2 - 1] : dpp.samples_A [0];
+            int32_t sam_A, sam_B, res;
+
+            switch (dpp.term) {
+                case -1:
+                    sam_A = prev_right;
+                    sam_B = left;
+                    break;
+
+                case -2:
+                    sam_A = right;
+                    sam_B = prev_left;
+                    break;
+
+                default:
+                    sam_A = prev_right;
+                    sam_B = prev_left;
+                    break;
+            }
+
+            res = left - apply_weight (dpp.weight_A, sam_A);
+            residuals [i * 2] = res;
+            update_weight_clip (dpp.weight_A, dpp.delta, sam_A, res);
+
+            res = right - apply_weight (dpp.weight_B, sam_B);
+            residuals [i * 2 + 1] = res;
+            update_weight_clip (dpp.weight_B, dpp.delta, sam_B, res);
+        }
+}
+
+static void random_pass (struct decorr_pass *dpp, int term, int delta, int bits)
+{
+    int32_t max_value = (1 << (bits - 1)) - 1;
+    int k;
+
+    memset (dpp, 0, sizeof (*dpp));
+    dpp->term = term;
+    dpp->delta = delta;
+    dpp->weight_A = random_range (-1024, 1024);
+    dpp->weight_B = random_range (-1024, 1024);
+
+    for (k = 0; k < MAX_TERM; ++k) {
+        dpp->samples_A [k] = random_range (-max_value - 1, max_value);
+        dpp->samples_B [k] = random_range (-max_value - 1, max_value);
+    }
+}
+
+// unpack_samples() puts the samples of terms 1-8 back in order after the
+// regular stereo pass
+
+static void normalize_samples (struct decorr_pass *dpp, int32_t sample_count)
+{
+    int32_t temp_A [MAX_TERM], temp_B [MAX_TERM];
+    int k, m = sample_count & (MAX_TERM - 1);
+
+    if (!m || dpp->term < 1 || dpp->term > MAX_TERM)
+        return;
+
+    memcpy (temp_A, dpp->samples_A, sizeof (dpp->samples_A));
+    memcpy (temp_B, dpp->samples_B, sizeof (dpp->samples_B));
+
+    for (k = 0; k < MAX_TERM; k++) {
+        dpp->samples_A [k] = temp_A [m];
+        dpp->samples_B [k] = temp_B [m];
+        m = (m + 1) & (MAX_TERM - 1);
+    }
+}
+
+static int compare_passes (const struct decorr_pass *dpp, const struct decorr_pass *ref, const int32_t *buffer, const int32_t *reference, int32_t sample_count, int num_chans)
+{
+    int count = (dpp->term > 0 && dpp->term <= MAX_TERM) ? dpp->term : 2, k;
+    int32_t i;
+
+    for (i = 0; i < sample_count * num_chans; ++i)
+        if (buffer [i] != reference [i]) {
+            printf ("  sample %d: %d vs. %d\n", i, buffer [i], reference [i]);
+            return FALSE;
+        }
+
+    if (dpp->weight_A != ref->weight_A || (num_chans == 2 && dpp->weight_B != ref->weight_B)) {
+        printf ("  weights %d %d vs. %d %d\n", dpp->weight_A, dpp->weight_B, ref->weight_A, ref->weight_B);
+        return FALSE;
+    }
+
+    for (k = 0; k < count; ++k)
+        if (dpp->samples_A [k] != ref->samples_A [k] || (num_chans == 2 && dpp->samples_B [k] != ref->samples_B [k])) {
+            printf ("  history %d: %d %d vs. %d %d\n", k, dpp->samples_A [k], dpp->samples_B [k], ref->samples_A [k], ref->samples_B [k]);
+            return FALSE;
+        }
+
+    return TRUE;
+}
+
+static int32_t signal [MAX_SAMPLES * 2], residuals [MAX_SAMPLES * 2];
+static int32_t buffer [MAX_SAMPLES * 2], reference [MAX_SAMPLES * 2];
+
+// Runs one pass the way unpack_samples() does, with and without the
+// continuation, and returns FALSE if they differ
+
+static int check_pass (int num_chans, int term, int delta, int long_math, int32_t sample_count)
+{
+    struct decorr_pass dpp, ref;
+    int pre_samples = (term < 0 || term > MAX_TERM) ? 2 : term;
+    int bits = long_math ? 24 : 16;
+
+    random_pass (&dpp, term, delta, bits);
+    make_signal (signal, sample_count, num_chans, bits);
+    make_residuals (dpp, signal, residuals, sample_count, num_chans);
+    ref = dpp;
+
+    memcpy (reference, residuals, sample_count * num_chans * sizeof (int32_t));
+    memcpy (buffer, residuals, sample_count * num_chans * sizeof (int32_t));
+
+    if (num_chans == 1) {
+        decorr_mono_pass (&ref, reference, sample_count);
+        decorr_mono_pass (&dpp, buffer, pre_samples);
+        unpack_decorr_mono_pass_cont_simd (&dpp, buffer + pre_samples, sample_count - pre_samples, long_math);
+    }
+    else {
+        decorr_stereo_pass (&ref, reference, sample_count);
+        normalize_samples (&ref, sample_count);
+        decorr_stereo_pass (&dpp, buffer, pre_samples);
+        unpack_decorr_stereo_pass_cont_simd (&dpp, buffer + pre_samples * 2, sample_count - pre_samples, long_math);
+    }
+
+    if (memcmp (reference, signal, sample_count * num_chans * sizeof (int32_t))) {
+        printf ("  residuals for term %d don't decode back to the signal\n", term);
+        return FALSE;
+    }
+
+    return compare_passes (&dpp, &ref, buffer, reference, sample_count, num_chans);
+}
+
+// The generic loops from fixup_samples()
+
+static void clip_shift_reference (int32_t *buffer, uint32_t count, int32_t min_value, int32_t max_value, int shift)
+{
+    int32_t min_shifted = min_value << shift, max_shifted = max_value << shift;
+
+    while (count--) {
+        if (*buffer < min_value)
+            *buffer++ = min_shifted;
+        else if (*buffer > max_value)
+            *buffer++ = max_shifted;
+        else
+            *buffer++ <<= shift;
+    }
+}
+
+static int check_fixups (void)
+{
+    static const int bytes [] = { 1, 2, 3 };
+    int b, shift, length;
+
+    for (b = 0; b < 3; ++b)
+        for (shift = 0; shift < 8; ++shift)
+            for (length = 0; length < 9; ++length) {
+                int32_t full = (1 << (bytes [b] * 8 - 1)), count = lengths [length], i;
+                int32_t min_value = -full >> shift, max_value = (full - 1) >> shift;
+
+                for (i = 0; i < count; ++i)
+                    reference [i] = buffer [i] = random_range (min_value * 2, max_value * 2);
+
+                clip_shift_reference (reference, count, min_value, max_value, shift);
+                unpack_clip_shift_simd (buffer, count, min_value, max_value, shift);
+
+                if (memcmp (buffer, reference, count * sizeof (int32_t))) {
+                    printf ("  clip and shift differs: %d bytes, shift %d, %d samples\n", bytes [b], shift, count);
+                    return FALSE;
+                }
+
+                for (i = 0; i < count; ++i)
+                    reference [i] = buffer [i] = random_range (min_value, max_value);
+
+                for (i = 0; i < count; ++i)
+                    reference [i] <<= shift;
+
+                unpack_shift_simd (buffer, count, shift);
+
+                if (memcmp (buffer, reference, count * sizeof (int32_t))) {
+                    printf ("  shift differs: %d bytes, shift %d, %d samples\n", bytes [b], shift, count);
+                    return FALSE;
+                }
+            }
+
+    return TRUE;
+}
+
+int main (void)
+{
+    int failed = FALSE, l;
+
+    for (l = 0; l < (int) (sizeof (levels) / sizeof (levels [0])); ++l) {
+        int long_math, checks = 0, level_failed = FALSE;
+        size_t t, d, n;
+
+        if (!select_level (&levels [l])) {
+            printf ("%-8s skipped\n", levels [l].name);
+            continue;
+        }
+
+        for (long_math = 0; long_math < 2; ++long_math)
+            for (d = 0; d < sizeof (deltas) / sizeof (deltas [0]); ++d)
+                for (n = 0; n < sizeof (lengths) / sizeof (lengths [0]); ++n) {
+                    for (t = 0; t < sizeof (mono_terms) / sizeof (mono_terms [0]); ++t, ++checks)
+                        if (!check_pass (1, mono_terms [t], deltas [d], long_math, lengths [n])) {
+                            printf ("  %s mono term %d, delta %d, %s math, %d samples\n", levels [l].name,
+                                mono_terms [t], deltas [d], long_math ? "long" : "short", lengths [n]);
+                            level_failed = TRUE;
+                        }
+
+                    for (t = 0; t < sizeof (stereo_terms) / sizeof (stereo_terms [0]); ++t, ++checks)
+                        if (!check_pass (2, stereo_terms [t], deltas [d], long_math, lengths [n])) {
+                            printf ("  %s stereo term %d, delta %d, %s math, %d samples\n", levels [l].name,
+                                stereo_terms [t], deltas [d], long_math ? "long" : "short", lengths [n]);
+                            level_failed = TRUE;
+                        }
+                }
+
+        if (!check_fixups ())
+            level_failed = TRUE;
+
+        printf ("%-8s %d passes and the fixups %s\n", levels [l].name, checks, level_failed ? "DIFFER" : "match");
+        failed |= level_failed;
+    }
+
+    printf (failed ? "FAILED\n" : "OK\n");
+
+    return failed;
+}
@@ -281,6 +281,7 @@ void gensdr(usf_state_t *);
 void genlink_subblock(usf_state_t *);
 void gendelayslot(usf_state_t *);
 void gencheck_interupt_reg(usf_state_t *);
+void gendirect_jump_out(usf_state_t *);
 void gentest(usf_state_t *);
 void gentest_out(usf_state_t *);
 void gentest_idle(usf_state_t *);
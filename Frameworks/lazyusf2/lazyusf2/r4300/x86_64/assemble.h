@@ -442,6 +442,20 @@ static inline void je_near_rj(usf_state_t * state, unsigned int saut)
    put32(state, saut);
 }
 
+static inline void jne_near_rj(usf_state_t * state, unsigned int saut)
+{
+   put8(state, 0x0F);
+   put8(state, 0x85);
+   put32(state, saut);
+}
+
+static inline void jae_near_rj(usf_state_t * state, unsigned int saut)
+{
+   put8(state, 0x0F);
+   put8(state, 0x83);
+   put32(state, saut);
+}
+
 static inline void mov_reg32_imm32(usf_state_t * state, int reg32, unsigned int imm32)
 {
    put8(state, 0xB8+reg32);
@@ -337,6 +337,79 @@ void gencheck_interupt_reg(usf_state_t * state) // addr is in EAX
    jump_end_rel8(state);
 }
 
+/* Jumps straight into the code of another page when it is already compiled
+   and still valid, instead of going through jump_to_func(). It falls through
+   when the page must be looked up or recompiled, when the emulator has been
+   asked to stop, or when a jump must be skipped, leaving the address in EBX
+   for the call that follows. */
+void gendirect_jump_out(usf_state_t * state) // addr is in EBX
+{
+   unsigned int diff = (unsigned int) offsetof(precomp_instr, local_addr);
+   unsigned int diff_need = (unsigned int) (offsetof(precomp_instr, reg_cache_infos) + offsetof(reg_cache_struct, need_map));
+   unsigned int diff_wrap = (unsigned int) (offsetof(precomp_instr, reg_cache_infos) + offsetof(reg_cache_struct, jump_wrapper));
+   unsigned int slow[5], end;
+   int i;
+
+   cmp_m32rel_imm32(state, (unsigned int *)&state->stop, 0);
+   jne_near_rj(state, 0);
+   slow[0] = state->code_length;
+   cmp_m32rel_imm32(state, &state->skip_jump, 0);
+   jne_near_rj(state, 0);
+   slow[1] = state->code_length;
+
+   /* only the unmapped segments, which need no TLB lookup */
+   mov_reg32_reg32(state, EAX, EBX);
+   sub_eax_imm32(state, 0x80000000);
+   cmp_eax_imm32(state, 0x40000000);
+   jae_near_rj(state, 0);
+   slow[2] = state->code_length;
+
+   /* both the page and its cached/uncached mirror must be valid */
+   mov_reg32_reg32(state, EAX, EBX);
+   shr_reg32_imm8(state, EAX, 12);
+   mov_reg64_imm64(state, RSI, (unsigned long long) state->invalid_code);
+   cmp_preg64preg64_imm8(state, RAX, RSI, 0);
+   jne_near_rj(state, 0);
+   slow[3] = state->code_length;
+   xor_reg64_imm32(state, RAX, 0x20000);
+   cmp_preg64preg64_imm8(state, RAX, RSI, 0);
+   jne_near_rj(state, 0);
+   slow[4] = state->code_length;
+   xor_reg64_imm32(state, RAX, 0x20000);
+
+   mov_reg64_imm64(state, RSI, (unsigned long long) state->blocks);
+   mov_reg64_preg64x8preg64(state, RSI, RAX, RSI);
+   mov_m64rel_xreg64(state, (unsigned long long *)(&state->actual), RSI);
+
+   mov_reg32_reg32(state, EAX, EBX);
+   and_eax_imm32(state, 0xFFF);
+   shr_reg32_imm8(state, EAX, 2);
+   mul_m32rel(state, (unsigned int *)(&state->precomp_instr_size));
+   mov_reg64_preg64pimm32(state, RCX, RSI, (unsigned int) offsetof(precomp_block, block));
+   add_reg64_reg64(state, RCX, RAX);
+   mov_m64rel_xreg64(state, (unsigned long long *)(&state->PC), RCX);
+
+   mov_reg32_preg64pimm32(state, EAX, RCX, diff_need);
+   cmp_reg32_imm32(state, EAX, 1);
+   jne_rj(state, 9);
+
+   add_reg64_imm32(state, RCX, diff_wrap); // 7
+   jmp_reg64(state, RCX); // 2
+
+   mov_reg32_preg64pimm32(state, EAX, RCX, diff);
+   mov_reg64_preg64pimm32(state, RCX, RSI, (unsigned int) offsetof(precomp_block, code));
+   add_reg64_reg64(state, RAX, RCX);
+   jmp_reg64(state, RAX);
+
+   end = state->code_length;
+   for (i = 0; i < 5; i++)
+     {
+    state->code_length = slow[i] - 4;
+    put32(state, end - slow[i]);
+     }
+   state->code_length = end;
+}
+
 void gennop(usf_state_t * state)
 {
     (void)state;
@@ -390,6 +463,8 @@ void genj_out(usf_state_t * state)
    
    mov_m32rel_imm32(state, (void*)(&state->last_addr), naddr);
    gencheck_interupt_out(state, naddr);
+   mov_reg32_imm32(state, EBX, naddr);
+   gendirect_jump_out(state);
    mov_m32rel_imm32(state, &state->jump_to_address, naddr);
    mov_reg64_imm64(state, RAX, (unsigned long long) (state->dst+1));
    mov_m64rel_xreg64(state, (unsigned long long *)(&state->PC), RAX);
@@ -489,6 +564,8 @@ void genjal_out(usf_state_t * state)
 
    mov_m32rel_imm32(state, (void*)(&state->last_addr), naddr);
    gencheck_interupt_out(state, naddr);
+   mov_reg32_imm32(state, EBX, naddr);
+   gendirect_jump_out(state);
    mov_m32rel_imm32(state, &state->jump_to_address, naddr);
    mov_reg64_imm64(state, RAX, (unsigned long long) (state->dst+1));
    mov_m64rel_xreg64(state, (unsigned long long *)(&state->PC), RAX);
@@ -572,6 +649,8 @@ void gentest_out(usf_state_t * state)
 
    mov_m32rel_imm32(state, (void*)(&state->last_addr), state->dst->addr + (state->dst-1)->f.i.immediate*4);
    gencheck_interupt_out(state, state->dst->addr + (state->dst-1)->f.i.immediate*4);
+   mov_reg32_imm32(state, EBX, state->dst->addr + (state->dst-1)->f.i.immediate*4);
+   gendirect_jump_out(state);
    mov_m32rel_imm32(state, &state->jump_to_address, state->dst->addr + (state->dst-1)->f.i.immediate*4);
    mov_reg64_imm64(state, RAX, (unsigned long long) (state->dst+1));
    mov_m64rel_xreg64(state, (unsigned long long *)(&state->PC), RAX);
@@ -1008,6 +1087,8 @@ void gentestl_out(usf_state_t * state)
    gendelayslot(state);
    mov_m32rel_imm32(state, (void*)(&state->last_addr), state->dst->addr + (state->dst-1)->f.i.immediate*4);
    gencheck_interupt_out(state, state->dst->addr + (state->dst-1)->f.i.immediate*4);
+   mov_reg32_imm32(state, EBX, state->dst->addr + (state->dst-1)->f.i.immediate*4);
+   gendirect_jump_out(state);
    mov_m32rel_imm32(state, &state->jump_to_address, state->dst->addr + (state->dst-1)->f.i.immediate*4);
 
    mov_reg64_imm64(state, RAX, (unsigned long long) (state->dst+1));
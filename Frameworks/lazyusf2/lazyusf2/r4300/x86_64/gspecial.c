@@ -222,6 +222,7 @@ void genjr(usf_state_t * state)
 
    jump_start_rel32(state);
    
+   gendirect_jump_out(state);
    mov_m32rel_xreg32(state, &state->jump_to_address, EBX);
    mov_reg64_imm64(state, RAX, (unsigned long long) (state->dst+1));
    mov_m64rel_xreg64(state, (unsigned long long *)(&state->PC), RAX);
@@ -297,6 +298,7 @@ void genjalr(usf_state_t * state)
 
    jump_start_rel32(state);
    
+   gendirect_jump_out(state);
    mov_m32rel_xreg32(state, &state->jump_to_address, EBX);
    mov_reg64_imm64(state, RAX, (unsigned long long) (state->dst+1));
    mov_m64rel_xreg64(state, (unsigned long long *)(&state->PC), RAX);
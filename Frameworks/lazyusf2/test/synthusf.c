@@ -0,0 +1,197 @@
+/*
+ * synthusf: writes a small USF file which needs no game data, for
+ * usfcompare to run on.
+ *
+ * The save state holds a 4MB RDRAM image with a MIPS program that
+ * synthesizes audio and streams it through AI DMA. The sample loop
+ * lives in another page than the main loop, so the recompiler has to
+ * link jumps across pages, and it uses 64-bit shifts and adds,
+ * multiplies, loads and stores, and conditional branches.
+ *
+ * usage: synthusf out.usf
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define RDRAM_SIZE  0x400000
+#define STATE_SIZE  (8 + 0x2754 + RDRAM_SIZE)
+#define MAIN_BASE   0x80000400
+#define GEN_BASE    0x80001400
+
+enum { zero, at, v0, v1, a0, a1, a2, a3, t0, t1, t2, t3, t4, t5, t6, t7,
+       s0, s1, s2, s3, s4, s5, s6, s7, t8, t9, k0, k1, gp, sp, fp, ra };
+
+#define R(rs, rt, rd, sa, funct) ((uint32_t)((rs) << 21 | (rt) << 16 | (rd) << 11 | (sa) << 6 | (funct)))
+#define I(op, rs, rt, imm)       ((uint32_t)((op) << 26 | (rs) << 21 | (rt) << 16 | ((imm) & 0xFFFF)))
+#define J(op, target)            ((uint32_t)((op) << 26 | (((target) >> 2) & 0x3FFFFFF)))
+/* Branch offset from the instruction at index from to the one at index to */
+#define B(from, to)              ((to) - (from) - 1)
+
+#define NOP        0
+#define LUI(rt, i) I(0x0F, zero, rt, i)
+#define ORI(rt, rs, i) I(0x0D, rs, rt, i)
+
+static const uint32_t main_code[] =
+{
+    /*  0 */ LUI(s0, 0xA450),                 /* AI registers */
+    /*  1 */ ORI(t0, zero, 1),
+    /*  2 */ I(0x2B, s0, t0, 8),              /* sw t0, AI_CONTROL */
+    /*  3 */ LUI(s1, 0x8010),                 /* two 4KB sample buffers at 0x80100000 */
+    /*  4 */ ORI(s2, zero, 0),
+    /*  5 */ LUI(s3, 0x1234),
+    /*  6 */ ORI(s3, s3, 0x5678),
+    /*  7 */ ORI(s4, zero, 0),
+    /*  8 */ ORI(s5, zero, 0),
+    /* outer: */
+    /*  9 */ R(s1, s2, a0, 0, 0x21),          /* addu a0, s1, s2 */
+    /* 10 */ ORI(a1, zero, 1024),
+    /* 11 */ J(3, GEN_BASE),                  /* jal gen */
+    /* 12 */ NOP,
+    /* wait: */
+    /* 13 */ I(0x23, s0, t0, 0x0C),           /* lw t0, AI_STATUS */
+    /* 14 */ I(0x01, t0, 0, B(14, 13)),       /* bltz t0, wait */
+    /* 15 */ NOP,
+    /* 16 */ R(s1, s2, t1, 0, 0x21),
+    /* 17 */ LUI(t2, 0x1FFF),
+    /* 18 */ ORI(t2, t2, 0xFFFF),
+    /* 19 */ R(t1, t2, t1, 0, 0x24),          /* and t1, t1, t2 */
+    /* 20 */ I(0x2B, s0, t1, 0),              /* sw t1, AI_DRAM_ADDR */
+    /* 21 */ ORI(t1, zero, 4096),
+    /* 22 */ I(0x2B, s0, t1, 4),              /* sw t1, AI_LEN */
+    /* 23 */ I(0x0E, s2, s2, 0x1000),         /* xori s2, s2, 0x1000 */
+    /* 24 */ J(2, MAIN_BASE + 9 * 4),         /* j outer */
+    /* 25 */ NOP,
+};
+
+static const uint32_t gen_code[] =
+{
+    /* loop: */
+    /*  0 */ I(0x09, s4, s4, 0x1234),         /* addiu s4, s4, 0x1234 */
+    /*  1 */ I(0x0C, s4, t0, 0xFFFF),         /* andi t0, s4, 0xFFFF */
+    /*  2 */ R(zero, t0, t1, 16, 0x00),       /* sll t1, t0, 16 */
+    /*  3 */ R(zero, t1, t1, 16, 0x03),       /* sra t1, t1, 16 */
+    /*  4 */ R(zero, t1, t2, 31, 0x03),       /* sra t2, t1, 31 */
+    /*  5 */ R(t1, t2, t1, 0, 0x26),          /* xor t1, t1, t2 */
+    /*  6 */ LUI(t3, 0x41C6),
+    /*  7 */ ORI(t3, t3, 0x4E6D),
+    /*  8 */ R(s3, t3, zero, 0, 0x19),        /* multu s3, t3 */
+    /*  9 */ R(zero, zero, s3, 0, 0x12),      /* mflo s3 */
+    /* 10 */ I(0x09, s3, s3, 12345),
+    /* 11 */ R(zero, s3, t4, 20, 0x03),       /* sra t4, s3, 20 */
+    /* 12 */ R(t1, t4, t5, 0, 0x21),          /* addu t5, t1, t4 */
+    /* 13 */ R(zero, s3, t8, 0, 0x3C),        /* dsll32 t8, s3, 0 */
+    /* 14 */ R(zero, t8, t8, 4, 0x3F),        /* dsra32 t8, t8, 4 */
+    /* 15 */ R(t8, s5, s5, 0, 0x2D),          /* daddu s5, t8, s5 */
+    /* 16 */ R(zero, s5, t9, 16, 0x03),       /* sra t9, s5, 16 */
+    /* 17 */ R(t5, t9, t5, 0, 0x26),          /* xor t5, t5, t9 */
+    /* 18 */ I(0x0C, t5, t5, 0x7FFF),         /* andi t5, t5, 0x7FFF */
+    /* 19 */ I(0x29, a0, t5, 0),              /* sh t5, 0(a0) */
+    /* 20 */ R(t4, zero, t6, 0, 0x2A),        /* slt t6, t4, zero */
+    /* 21 */ I(0x04, t6, zero, B(21, 24)),    /* beq t6, zero, pos */
+    /* 22 */ R(zero, t5, t7, 0, 0x23),        /* subu t7, zero, t5 */
+    /* 23 */ I(0x09, t7, t7, 100),            /* addiu t7, t7, 100 */
+    /* 24 */ I(0x29, a0, t7, 2),              /* pos: sh t7, 2(a0) */
+    /* 25 */ I(0x21, a0, v0, 2),              /* lh v0, 2(a0) */
+    /* 26 */ R(v0, t7, v1, 0, 0x21),          /* addu v1, v0, t7 */
+    /* 27 */ I(0x09, a0, a0, 4),
+    /* 28 */ I(0x09, a1, a1, -1),
+    /* 29 */ I(0x07, a1, zero, B(29, 0)),     /* bgtz a1, loop */
+    /* 30 */ NOP,
+    /* 31 */ R(ra, zero, zero, 0, 0x08),      /* jr ra */
+    /* 32 */ NOP,
+};
+
+static void put32(uint8_t * p, uint32_t v)
+{
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_code(uint8_t * rdram, uint32_t address, const uint32_t * code, size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; ++i)
+        put32(rdram + (address & 0x1FFFFFFF) + i * 4, code[i]);
+}
+
+int main(int argc, char ** argv)
+{
+    static uint8_t state[STATE_SIZE];
+    uint8_t * p = state, * rdram;
+    uint8_t header[16];
+    FILE * f;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s out.usf\n", argv[0]);
+        return 2;
+    }
+
+    /* Project64 save state, see savestates_load_pj64() */
+    p[0] = 0xC8; p[1] = 0xA6; p[2] = 0xD8; p[3] = 0x23;
+    put32(p + 4, RDRAM_SIZE);
+    p += 8;
+    p[0x3E] = 'E';                           /* ROM header: NTSC */
+    p += 0x40;
+    put32(p, 5000); p += 4;                  /* vi_timer */
+    put32(p, MAIN_BASE); p += 4;             /* PC */
+    p += 32 * 8 + 32 * 8;                    /* GPR, FPR */
+    put32(p + 9 * 4, 0);                     /* Count */
+    put32(p + 11 * 4, 0xFFFFFFF0);           /* Compare */
+    put32(p + 12 * 4, 0x34000000);           /* Status, interrupts disabled */
+    put32(p + 15 * 4, 0xB22);                /* PRId */
+    put32(p + 16 * 4, 0x0006E463);           /* Config */
+    p += 32 * 4;
+    put32(p, 0x511); p += 4 + 30 * 4 + 4;    /* FCR0, FCR31 */
+    p += 8 + 8;                              /* hi, lo */
+    p += 10 * 4;                             /* RDRAM registers */
+    put32(p + 4 * 4, 1); p += 10 * 4;        /* SP registers, halted */
+    p += 10 * 4;                             /* DPC registers */
+    put32(p + 4, 0x02020102); p += 4 * 4;    /* MI registers */
+    put32(p + 6 * 4, 0x20D); p += 14 * 4;    /* VI registers, V_SYNC */
+    put32(p + 2 * 4, 1);                     /* AI_CONTROL */
+    put32(p + 4 * 4, 1520);                  /* AI_DACRATE, 32 kHz */
+    put32(p + 5 * 4, 15);                    /* AI_BITRATE */
+    p += 6 * 4;
+    p += 13 * 4 + 8 * 4 + 4 * 4;             /* PI, RI, SI registers */
+    p += 32 * 5 * 4;                         /* TLB */
+    p += 64;                                 /* PIF RAM */
+    rdram = p;
+    put_code(rdram, MAIN_BASE, main_code, sizeof(main_code) / sizeof(main_code[0]));
+    put_code(rdram, GEN_BASE, gen_code, sizeof(gen_code) / sizeof(gen_code[0]));
+
+    f = fopen(argv[1], "wb");
+    if (!f)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    /* PSF header, version 0x21, with an empty ROM section followed by the save state section */
+    memcpy(header, "PSF\x21", 4);
+    put32(header + 4, 4 + 4 + 4 + 4 + 4 + STATE_SIZE + 4);
+    put32(header + 8, 0);
+    put32(header + 12, 0);
+    fwrite(header, 1, 16, f);
+
+    memcpy(header, "SR64", 4);
+    put32(header + 4, 0);
+    memcpy(header + 8, "SR64", 4);
+    put32(header + 12, STATE_SIZE);
+    fwrite(header, 1, 16, f);
+    put32(header, 0);
+    fwrite(header, 1, 4, f);
+    fwrite(state, 1, STATE_SIZE, f);
+    fwrite(header, 1, 4, f);
+
+    fputs("[TAG]_enablecompare=1\n", f);
+
+    fclose(f);
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+/*
+ * usfcompare: renders USF files with the pure interpreter and with the
+ * recompiler, and compares the PCM output sample by sample.
+ *
+ * The interpreter is selected through trimming mode, which forces
+ * CORE_PURE_INTERPRETER in main_start(). Everything else, including
+ * the _enablecompare and _enablefifofull tags, is set up the same way
+ * as HCDecoder does it.
+ *
+ * usage: usfcompare [-s seconds] [-l] file.usf [file.miniusf ...]
+ *   -s  length to render from each file, default 60 seconds
+ *   -l  use the LLE RSP for audio instead of HLE
+ *
+ * Returns non-zero if any file fails to load or differs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "usf/usf.h"
+#include "psflib.h"
+
+#define BLOCK_SIZE 4096
+
+struct usf_loader_state
+{
+    uint32_t enablecompare;
+    uint32_t enablefifofull;
+
+    void * emu_state;
+};
+
+static void * stdio_fopen(const char * path)
+{
+    return fopen(path, "rb");
+}
+
+static size_t stdio_fread(void * p, size_t size, size_t count, void * f)
+{
+    return fread(p, size, count, (FILE *) f);
+}
+
+static int stdio_fseek(void * f, int64_t offset, int whence)
+{
+    return fseek((FILE *) f, (long) offset, whence);
+}
+
+static int stdio_fclose(void * f)
+{
+    return fclose((FILE *) f);
+}
+
+static long stdio_ftell(void * f)
+{
+    return ftell((FILE *) f);
+}
+
+static const psf_file_callbacks stdio_callbacks =
+{
+    "\\/:",
+    stdio_fopen,
+    stdio_fread,
+    stdio_fseek,
+    stdio_fclose,
+    stdio_ftell
+};
+
+static int usf_loader(void * context, const uint8_t * exe, size_t exe_size,
+                      const uint8_t * reserved, size_t reserved_size)
+{
+    struct usf_loader_state * uUsf = (struct usf_loader_state *) context;
+    if (exe && exe_size > 0) return -1;
+
+    return usf_upload_section(uUsf->emu_state, reserved, reserved_size);
+}
+
+static int usf_info(void * context, const char * name, const char * value)
+{
+    struct usf_loader_state * uUsf = (struct usf_loader_state *) context;
+
+    if (!strcasecmp(name, "_enablecompare") && *value)
+        uUsf->enablecompare = 1;
+    else if (!strcasecmp(name, "_enablefifofull") && *value)
+        uUsf->enablefifofull = 1;
+
+    return 0;
+}
+
+static void * open_usf(const char * path, int interpreter, int hle)
+{
+    struct usf_loader_state state;
+    memset(&state, 0, sizeof(state));
+
+    state.emu_state = malloc(usf_get_state_size());
+    if (!state.emu_state)
+        return NULL;
+
+    usf_clear(state.emu_state);
+    usf_set_hle_audio(state.emu_state, hle);
+    usf_set_trimming_mode(state.emu_state, interpreter);
+
+    if (psf_load(path, &stdio_callbacks, 0x21, usf_loader, &state, usf_info, &state, 1) <= 0)
+    {
+        free(state.emu_state);
+        return NULL;
+    }
+
+    usf_set_compare(state.emu_state, state.enablecompare);
+    usf_set_fifo_full(state.emu_state, state.enablefifofull);
+
+    return state.emu_state;
+}
+
+static void close_usf(void * emu_state)
+{
+    usf_shutdown(emu_state);
+    free(emu_state);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Returns 0 if both cores produce the same samples, 1 if they differ, -1 on error */
+static int compare_file(const char * path, double seconds, int hle)
+{
+    static int16_t interp_buffer[BLOCK_SIZE * 2], dynarec_buffer[BLOCK_SIZE * 2];
+    void * interp, * dynarec;
+    int32_t interp_rate = 0, dynarec_rate = 0;
+    double interp_time = 0, dynarec_time = 0, t;
+    size_t done = 0, total;
+    const char * err;
+    int result = 0;
+
+    interp = open_usf(path, 1, hle);
+    dynarec = open_usf(path, 0, hle);
+    if (!interp || !dynarec)
+    {
+        fprintf(stderr, "%s: failed to load\n", path);
+        if (interp) free(interp);
+        if (dynarec) free(dynarec);
+        return -1;
+    }
+
+    /* The first render call starts the emulator, and reports the sample rate */
+    total = 0;
+    for (;;)
+    {
+        size_t i, count;
+
+        t = now();
+        err = usf_render(interp, interp_buffer, BLOCK_SIZE, &interp_rate);
+        interp_time += now() - t;
+        if (err)
+        {
+            fprintf(stderr, "%s: interpreter: %s\n", path, err);
+            result = -1;
+            break;
+        }
+
+        t = now();
+        err = usf_render(dynarec, dynarec_buffer, BLOCK_SIZE, &dynarec_rate);
+        dynarec_time += now() - t;
+        if (err)
+        {
+            fprintf(stderr, "%s: recompiler: %s\n", path, err);
+            result = -1;
+            break;
+        }
+
+        if (interp_rate != dynarec_rate)
+        {
+            fprintf(stderr, "%s: sample rate differs after %zu samples: %d vs. %d\n", path, done, interp_rate, dynarec_rate);
+            result = 1;
+            break;
+        }
+
+        if (!total)
+            total = (size_t)(seconds * interp_rate);
+
+        count = total - done < BLOCK_SIZE ? total - done : BLOCK_SIZE;
+        for (i = 0; i < count * 2; ++i)
+        {
+            if (interp_buffer[i] != dynarec_buffer[i])
+                break;
+        }
+        if (i < count * 2)
+        {
+            fprintf(stderr, "%s: differs at sample %zu (%s): %d vs. %d\n", path, done + i / 2,
+                    (i & 1) ? "right" : "left", interp_buffer[i], dynarec_buffer[i]);
+            result = 1;
+            break;
+        }
+
+        done += count;
+        if (done >= total)
+            break;
+    }
+
+    if (result == 0)
+        printf("%s: %zu samples at %d Hz match, interpreter %.2fs, recompiler %.2fs (%.1fx)\n", path, done, interp_rate,
+               interp_time, dynarec_time, dynarec_time > 0 ? interp_time / dynarec_time : 0);
+
+    close_usf(interp);
+    close_usf(dynarec);
+
+    return result;
+}
+
+int main(int argc, char ** argv)
+{
+    double seconds = 60;
+    int hle = 1;
+    int failed = 0;
+    int i;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; ++i)
+    {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-l"))
+            hle = 0;
+        else
+            break;
+    }
+
+    if (i >= argc)
+    {
+        fprintf(stderr, "usage: %s [-s seconds] [-l] file.usf [file.miniusf ...]\n", argv[0]);
+        return 2;
+    }
+
+    for (; i < argc; ++i)
+    {
+        if (compare_file(argv[i], seconds, hle) != 0)
+            failed = 1;
+    }
+
+    return failed;
+}
@@ -455,3 +455,13 @@
 /* #undef uintptr_t */
 
 #define OPT_GENERIC
+
+/* The SIMD decoders are picked at runtime from the CPU flags, OPT_GENERIC stays as fallback. */
+#if defined(__x86_64__)
+#define OPT_MULTI
+#define OPT_X86_64
+#define OPT_AVX
+#elif defined(__aarch64__)
+#define OPT_MULTI
+#define OPT_NEON
+#endif
@@ -0,0 +1,94 @@
+/*
+	dct64_avx.c: DCT64 for the AVX decoder, AVX intrinsics
+
+	copyright 2006-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Stands in for upstream's dct64_avx_float.S, for real == double.
+	The same butterflies as in dct64_x86_64.c, four at a time for the first three
+	stages; still bit-identical to dct64(). The AVX code is compiled through target
+	attributes, this decoder is only chosen when the CPU and OS have AVX.
+*/
+
+#include "mpg123lib_intern.h"
+
+#ifdef OPT_AVX
+#include <immintrin.h>
+#include "dct64.h"
+
+#define TARGET_AVX __attribute__((target("avx")))
+
+#define SWAP(x) _mm_shuffle_pd((x), (x), 1)
+#define REVERSE(x) _mm256_permute_pd(_mm256_permute2f128_pd((x), (x), 1), 5)
+
+static inline TARGET_AVX void butterflies(real *out, const real *in, const real *costab, const int n, const int blocks)
+{
+	const int h = n/2;
+	int blk, i;
+
+	for(blk=0; blk<blocks; ++blk, in+=n, out+=n)
+	{
+		for(i=0; i<h; i+=4)
+		{
+			__m256d a = _mm256_loadu_pd(in+i);
+			__m256d b = REVERSE(_mm256_loadu_pd(in+n-4-i));
+			_mm256_storeu_pd(out+i, _mm256_add_pd(a, b));
+		}
+		for(i=0; i<h; i+=4)
+		{
+			__m256d a = REVERSE(_mm256_loadu_pd(in+h-4-i));
+			__m256d b = _mm256_loadu_pd(in+h+i);
+			__m256d c = REVERSE(_mm256_loadu_pd(costab+h-4-i));
+			_mm256_storeu_pd(out+h+i, _mm256_mul_pd((blk & 1) ? _mm256_sub_pd(b, a) : _mm256_sub_pd(a, b), c));
+		}
+	}
+}
+
+/* Blocks of four: x0+x3, x1+x2, (x1-x2)*cos[1], (x0-x3)*cos[0], turned around for the odd blocks. */
+static inline TARGET_AVX void butterflies4(real *out, const real *in, const real *costab)
+{
+	const __m128d c = SWAP(_mm_loadu_pd(costab));
+	int blk;
+
+	for(blk=0; blk<8; ++blk, in+=4, out+=4)
+	{
+		__m128d lo = _mm_loadu_pd(in);
+		__m128d hi = _mm_loadu_pd(in+2);
+		_mm_storeu_pd(out, _mm_add_pd(lo, SWAP(hi)));
+		lo = SWAP(lo);
+		_mm_storeu_pd(out+2, _mm_mul_pd((blk & 1) ? _mm_sub_pd(hi, lo) : _mm_sub_pd(lo, hi), c));
+	}
+}
+
+/* Last stage, pairs: x0+x1 and (x0-x1)*cos, turned around for the odd pairs. */
+static inline TARGET_AVX void butterflies2(real *out, const real *in, const real *costab)
+{
+	const __m128d c = _mm_set1_pd(costab[0]);
+	int i;
+
+	for(i=0; i<32; i+=4)
+	{
+		__m128d x = _mm_loadu_pd(in+i);
+		__m128d y = _mm_loadu_pd(in+i+2);
+		__m128d sum = _mm_add_pd(_mm_unpacklo_pd(x, y), _mm_unpackhi_pd(x, y));
+		/* x0 - x1, y1 - y0 */
+		__m128d dif = _mm_mul_pd(_mm_sub_pd(_mm_shuffle_pd(x, y, 2), _mm_shuffle_pd(x, y, 1)), c);
+		_mm_storeu_pd(out+i,   _mm_unpacklo_pd(sum, dif));
+		_mm_storeu_pd(out+i+2, _mm_unpackhi_pd(sum, dif));
+	}
+}
+
+TARGET_AVX void dct64_real_avx(real *out0, real *out1, real *samples)
+{
+	real bufs[64];
+
+	butterflies(bufs,    samples, pnts[0], 32, 1);
+	butterflies(bufs+32, bufs,    pnts[1], 16, 2);
+	butterflies(bufs,    bufs+32, pnts[2],  8, 4);
+	butterflies4(bufs+32, bufs,   pnts[3]);
+	butterflies2(bufs,   bufs+32, pnts[4]);
+
+	dct64_output(out0, out1, bufs);
+}
+
+#endif
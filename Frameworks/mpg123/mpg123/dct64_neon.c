@@ -0,0 +1,73 @@
+/*
+	dct64_neon.c: DCT64 for the NEON decoder, AArch64 NEON intrinsics
+
+	copyright 2006-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Stands in for upstream's dct64_neon_float.S, for real == double (which needs AArch64).
+	The same butterflies as in dct64_x86_64.c, two at a time; bit-identical to dct64().
+*/
+
+#include "mpg123lib_intern.h"
+
+#ifdef OPT_NEON
+#include <arm_neon.h>
+#include "dct64.h"
+
+#define SWAP(x) vextq_f64((x), (x), 1)
+
+static inline void butterflies(real *out, const real *in, const real *costab, const int n, const int blocks)
+{
+	const int h = n/2;
+	int blk, i;
+
+	for(blk=0; blk<blocks; ++blk, in+=n, out+=n)
+	{
+		for(i=0; i<h; i+=2)
+		{
+			float64x2_t a = vld1q_f64(in+i);
+			float64x2_t b = SWAP(vld1q_f64(in+n-2-i));
+			vst1q_f64(out+i, vaddq_f64(a, b));
+		}
+		for(i=0; i<h; i+=2)
+		{
+			float64x2_t a = SWAP(vld1q_f64(in+h-2-i));
+			float64x2_t b = vld1q_f64(in+h+i);
+			float64x2_t c = SWAP(vld1q_f64(costab+h-2-i));
+			vst1q_f64(out+h+i, vmulq_f64((blk & 1) ? vsubq_f64(b, a) : vsubq_f64(a, b), c));
+		}
+	}
+}
+
+/* Last stage, pairs: x0+x1 and (x0-x1)*cos, turned around for the odd pairs. Two pairs per step. */
+static inline void butterflies2(real *out, const real *in, const real *costab)
+{
+	const float64x2_t c = vdupq_n_f64(costab[0]);
+	int i;
+
+	for(i=0; i<32; i+=4)
+	{
+		float64x2_t x = vld1q_f64(in+i);
+		float64x2_t y = vld1q_f64(in+i+2);
+		float64x2_t sum = vaddq_f64(vzip1q_f64(x, y), vzip2q_f64(x, y));
+		/* x0 - x1, y1 - y0 */
+		float64x2_t dif = vmulq_f64(vsubq_f64(vcopyq_laneq_f64(x, 1, y, 1), vcopyq_laneq_f64(SWAP(x), 1, y, 0)), c);
+		vst1q_f64(out+i,   vzip1q_f64(sum, dif));
+		vst1q_f64(out+i+2, vzip2q_f64(sum, dif));
+	}
+}
+
+void dct64_real_neon(real *out0, real *out1, real *samples)
+{
+	real bufs[64];
+
+	butterflies(bufs,    samples, pnts[0], 32, 1);
+	butterflies(bufs+32, bufs,    pnts[1], 16, 2);
+	butterflies(bufs,    bufs+32, pnts[2],  8, 4);
+	butterflies(bufs+32, bufs,    pnts[3],  4, 8);
+	butterflies2(bufs,   bufs+32, pnts[4]);
+
+	dct64_output(out0, out1, bufs);
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+	dct64_x86_64.c: DCT64 for the x86-64 decoders, SSE2 intrinsics
+
+	copyright 2006-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Stands in for upstream's dct64_x86_64_float.S, for real == double.
+	Each butterfly stage works on blocks of n values: the lower half gets
+	x[i] + x[n-1-i], the upper half (x[h-1-k] - x[h+k]) * cos[h-1-k], with the
+	difference turned around in every second block. These are the very
+	operations of dct64(), just two at a time, so the output is bit-identical.
+*/
+
+#include "mpg123lib_intern.h"
+
+#ifdef OPT_X86_64
+#include <emmintrin.h>
+#include "dct64.h"
+
+#define SWAP(x) _mm_shuffle_pd((x), (x), 1)
+
+static inline void butterflies(real *out, const real *in, const real *costab, const int n, const int blocks)
+{
+	const int h = n/2;
+	int blk, i;
+
+	for(blk=0; blk<blocks; ++blk, in+=n, out+=n)
+	{
+		for(i=0; i<h; i+=2)
+		{
+			__m128d a = _mm_loadu_pd(in+i);
+			__m128d b = SWAP(_mm_loadu_pd(in+n-2-i));
+			_mm_storeu_pd(out+i, _mm_add_pd(a, b));
+		}
+		for(i=0; i<h; i+=2)
+		{
+			__m128d a = SWAP(_mm_loadu_pd(in+h-2-i));
+			__m128d b = _mm_loadu_pd(in+h+i);
+			__m128d c = SWAP(_mm_loadu_pd(costab+h-2-i));
+			_mm_storeu_pd(out+h+i, _mm_mul_pd((blk & 1) ? _mm_sub_pd(b, a) : _mm_sub_pd(a, b), c));
+		}
+	}
+}
+
+/* Last stage, pairs: x0+x1 and (x0-x1)*cos, turned around for the odd pairs. Two pairs per step. */
+static inline void butterflies2(real *out, const real *in, const real *costab)
+{
+	const __m128d c = _mm_set1_pd(costab[0]);
+	int i;
+
+	for(i=0; i<32; i+=4)
+	{
+		__m128d x = _mm_loadu_pd(in+i);
+		__m128d y = _mm_loadu_pd(in+i+2);
+		__m128d sum = _mm_add_pd(_mm_unpacklo_pd(x, y), _mm_unpackhi_pd(x, y));
+		/* x0 - x1, y1 - y0 */
+		__m128d dif = _mm_mul_pd(_mm_sub_pd(_mm_shuffle_pd(x, y, 2), _mm_shuffle_pd(x, y, 1)), c);
+		_mm_storeu_pd(out+i,   _mm_unpacklo_pd(sum, dif));
+		_mm_storeu_pd(out+i+2, _mm_unpackhi_pd(sum, dif));
+	}
+}
+
+void dct64_real_x86_64(real *out0, real *out1, real *samples)
+{
+	real bufs[64];
+
+	butterflies(bufs,    samples, pnts[0], 32, 1);
+	butterflies(bufs+32, bufs,    pnts[1], 16, 2);
+	butterflies(bufs,    bufs+32, pnts[2],  8, 4);
+	butterflies(bufs+32, bufs,    pnts[3],  4, 8);
+	butterflies2(bufs,   bufs+32, pnts[4]);
+
+	dct64_output(out0, out1, bufs);
+}
+
+#endif
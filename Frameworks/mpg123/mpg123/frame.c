@@ -341,7 +341,7 @@ int frame_buffers(mpg123_handle *fr)
 		}
 #endif
 #endif
-#if defined(OPT_ALTIVEC) || defined(OPT_ARM) 
+#if defined(OPT_ALTIVEC) || defined(OPT_ARM) || defined(OPT_X86_64) || defined(OPT_AVX) || defined(OPT_NEON)
 		/* sizeof(real) >= 4 ... yes, it could be 8, for example.
 		   We got it intialized to at least (512+32)*sizeof(real).*/
 		decwin_size += 512*sizeof(real);
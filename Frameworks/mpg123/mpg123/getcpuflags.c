@@ -0,0 +1,46 @@
+/*
+	getcpuflags: get cpuflags for ia32 and x86-64
+
+	copyright ?-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+	initially written by KIMURA Takuhiro (for 3DNow!)
+	extended for general use by Thomas Orgis
+
+	C version of upstream's getcpuflags.S / getcpuflags_x86_64.S, filling struct cpuflags
+	for the decoder choice in optimize.c.
+*/
+
+#include "mpg123lib_intern.h"
+
+#if ((defined OPT_X86) || (defined OPT_X86_64)) && (defined OPT_MULTI)
+#include <cpuid.h>
+#include "getcpuflags.h"
+
+/* OSXSAVE: the OS saves the extended registers and xgetbv may be used */
+#define FLAG_OSXSAVE 0x08000000
+
+unsigned int getcpuflags(struct cpuflags* cf)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	cf->id = cf->std = cf->std2 = cf->ext = cf->xcr0_lo = 0;
+
+	if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+
+	cf->id   = eax;
+	cf->std  = ecx;
+	cf->std2 = edx;
+
+	if(__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx))
+	cf->ext = edx;
+
+	if(cf->std & FLAG_OSXSAVE)
+	{
+		unsigned int lo, hi;
+		__asm__ volatile("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+		cf->xcr0_lo = lo;
+	}
+
+	return cf->id;
+}
+#endif
@@ -490,7 +490,7 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 	fr->cpu_opts.type = nodec;
 #ifdef OPT_MULTI
 #ifndef NO_LAYER3
-#if (defined OPT_3DNOW_VINTAGE || defined OPT_3DNOWEXT_VINTAGE || defined OPT_SSE || defined OPT_X86_64 || defined OPT_AVX)
+#if (defined OPT_3DNOW_VINTAGE || defined OPT_3DNOWEXT_VINTAGE || defined OPT_SSE)
 	fr->cpu_opts.the_dct36 = dct36;
 #endif
 #endif
@@ -708,11 +708,6 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 	{
 		chosen = "x86-64 (AVX)";
 		fr->cpu_opts.type = avx;
-#ifdef OPT_MULTI
-#		ifndef NO_LAYER3
-		fr->cpu_opts.the_dct36 = dct36_avx;
-#		endif
-#endif
 #		ifndef NO_16BIT
 		fr->synths.plain[r_1to1][f_16] = synth_1to1_avx;
 		fr->synths.stereo[r_1to1][f_16] = synth_1to1_stereo_avx;
@@ -734,11 +729,6 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 	{
 		chosen = "x86-64 (SSE)";
 		fr->cpu_opts.type = x86_64;
-#ifdef OPT_MULTI
-#		ifndef NO_LAYER3
-		fr->cpu_opts.the_dct36 = dct36_x86_64;
-#		endif
-#endif
 #		ifndef NO_16BIT
 		fr->synths.plain[r_1to1][f_16] = synth_1to1_x86_64;
 		fr->synths.stereo[r_1to1][f_16] = synth_1to1_stereo_x86_64;
@@ -323,18 +323,14 @@ extern const int costab_mmxsse[];
 #endif
 
 #ifdef OPT_X86_64
-#define OPT_MMXORSSE
 #ifndef OPT_MULTI
 #	define defopt x86_64
-#	define opt_dct36(fr) dct36_x86_64
 #endif
 #endif
 
 #ifdef OPT_AVX
-#define OPT_MMXORSSE
 #ifndef OPT_MULTI
 #	define defopt avx
-#	define opt_dct36(fr) dct36_avx
 #endif
 #endif
 
@@ -345,7 +341,6 @@ extern const int costab_mmxsse[];
 #endif
 
 #ifdef OPT_NEON
-#define OPT_MMXORSSE
 #ifndef OPT_MULTI
 #	define defopt neon
 #endif
@@ -364,7 +359,7 @@ void check_decoders(void);
 
 #	define defopt nodec
 
-#	if (defined OPT_3DNOW_VINTAGE || defined OPT_3DNOWEXT_VINTAGE || defined OPT_SSE || defined OPT_X86_64 || defined OPT_AVX)
+#	if (defined OPT_3DNOW_VINTAGE || defined OPT_3DNOWEXT_VINTAGE || defined OPT_SSE)
 #		define opt_dct36(fr) ((fr)->cpu_opts.the_dct36)
 #	endif
 
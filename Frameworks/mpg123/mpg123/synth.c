@@ -259,10 +259,9 @@ int synth_1to1_3dnowext(real *bandPtr, int channel, mpg123_handle *fr, int final
 #endif
 
 #ifdef OPT_X86_64
-#ifdef ACCURATE_ROUNDING
-/* Assembler routines. */
-int synth_1to1_x86_64_accurate_asm(real *window, real *b0, short *samples, int bo1);
-int synth_1to1_s_x86_64_accurate_asm(real *window, real *b0l, real *b0r, short *samples, int bo1);
+/* Synth filters in synth_x86_64.c. */
+int synth_1to1_x86_64_asm(real *window, real *b0, short *samples, int bo1);
+int synth_1to1_s_x86_64_asm(real *window, real *b0l, real *b0r, short *samples, int bo1);
 void dct64_real_x86_64(real *out0, real *out1, real *samples);
 /* Hull for C mpg123 API */
 int synth_1to1_x86_64(real *bandPtr,int channel, mpg123_handle *fr, int final)
@@ -300,7 +299,7 @@ int synth_1to1_x86_64(real *bandPtr,int channel, mpg123_handle *fr, int final)
 		dct64_real_x86_64(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
 	}
 
-	clip = synth_1to1_x86_64_accurate_asm(fr->decwin, b0, samples, bo1);
+	clip = synth_1to1_x86_64_asm(fr->decwin, b0, samples, bo1);
 
 	if(final) fr->buffer.fill += 128;
 
@@ -343,110 +342,20 @@ int synth_1to1_stereo_x86_64(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr
 		dct64_real_x86_64(bufr[0]+fr->bo,bufr[1]+fr->bo+1,bandPtr_r);
 	}
 
-	clip = synth_1to1_s_x86_64_accurate_asm(fr->decwin, b0l, b0r, samples, bo1);
-
-	fr->buffer.fill += 128;
-
-	return clip;
-}
-#else
-/* This is defined in assembler. */
-int synth_1to1_x86_64_asm(short *window, short *b0, short *samples, int bo1);
-int synth_1to1_s_x86_64_asm(short *window, short *b0l, short *b0r, short *samples, int bo1);
-void dct64_x86_64(short *out0, short *out1, real *samples);
-/* This is just a hull to use the mpg123 handle. */
-int synth_1to1_x86_64(real *bandPtr,int channel, mpg123_handle *fr, int final)
-{
-	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);	
-	short *b0, **buf;
-	int clip; 
-	int bo1;
-
-	if(fr->have_eq_settings) do_equalizer(bandPtr,channel,fr->equalizer);
-
-	if(!channel)
-	{
-		fr->bo--;
-		fr->bo &= 0xf;
-		buf = fr->short_buffs[0];
-	}
-	else
-	{
-		samples++;
-		buf = fr->short_buffs[1];
-	}
-
-	if(fr->bo & 0x1) 
-	{
-		b0 = buf[0];
-		bo1 = fr->bo;
-		dct64_x86_64(buf[1]+((fr->bo+1)&0xf),buf[0]+fr->bo,bandPtr);
-	}
-	else
-	{
-		b0 = buf[1];
-		bo1 = fr->bo+1;
-		dct64_x86_64(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
-	}
-
-	clip = synth_1to1_x86_64_asm((short *)fr->decwins, b0, samples, bo1);
-
-	if(final) fr->buffer.fill += 128;
-
-	return clip;
-}
-
-int synth_1to1_stereo_x86_64(real *bandPtr_l,real *bandPtr_r, mpg123_handle *fr)
-{
-	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);
-	short *b0l, *b0r, **bufl, **bufr;
-	int clip; 
-	int bo1;
-
-	if(fr->have_eq_settings)
-	{
-		do_equalizer(bandPtr_l,0,fr->equalizer);
-		do_equalizer(bandPtr_r,1,fr->equalizer);
-	}
-
-	fr->bo--;
-	fr->bo &= 0xf;
-	bufl = fr->short_buffs[0];
-	bufr = fr->short_buffs[1];
-
-	if(fr->bo & 0x1) 
-	{
-		b0l = bufl[0];
-		b0r = bufr[0];
-		bo1 = fr->bo;
-		dct64_x86_64(bufl[1]+((fr->bo+1)&0xf),bufl[0]+fr->bo,bandPtr_l);
-		dct64_x86_64(bufr[1]+((fr->bo+1)&0xf),bufr[0]+fr->bo,bandPtr_r);
-	}
-	else
-	{
-		b0l = bufl[1];
-		b0r = bufr[1];
-		bo1 = fr->bo+1;
-		dct64_x86_64(bufl[0]+fr->bo,bufl[1]+fr->bo+1,bandPtr_l);
-		dct64_x86_64(bufr[0]+fr->bo,bufr[1]+fr->bo+1,bandPtr_r);
-	}
-
-	clip = synth_1to1_s_x86_64_asm((short *)fr->decwins, b0l, b0r, samples, bo1);
+	clip = synth_1to1_s_x86_64_asm(fr->decwin, b0l, b0r, samples, bo1);
 
 	fr->buffer.fill += 128;
 
 	return clip;
 }
 #endif
-#endif
 
 #ifdef OPT_AVX
-#ifdef ACCURATE_ROUNDING
-/* Assembler routines. */
+/* Synth filters in synth_avx.c and synth_x86_64.c. */
 #ifndef OPT_X86_64
-int synth_1to1_x86_64_accurate_asm(real *window, real *b0, short *samples, int bo1);
+int synth_1to1_x86_64_asm(real *window, real *b0, short *samples, int bo1);
 #endif
-int synth_1to1_s_avx_accurate_asm(real *window, real *b0l, real *b0r, short *samples, int bo1);
+int synth_1to1_s_avx_asm(real *window, real *b0l, real *b0r, short *samples, int bo1);
 void dct64_real_avx(real *out0, real *out1, real *samples);
 /* Hull for C mpg123 API */
 int synth_1to1_avx(real *bandPtr,int channel, mpg123_handle *fr, int final)
@@ -484,7 +393,7 @@ int synth_1to1_avx(real *bandPtr,int channel, mpg123_handle *fr, int final)
 		dct64_real_avx(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
 	}
 
-	clip = synth_1to1_x86_64_accurate_asm(fr->decwin, b0, samples, bo1);
+	clip = synth_1to1_x86_64_asm(fr->decwin, b0, samples, bo1);
 
 	if(final) fr->buffer.fill += 128;
 
@@ -527,103 +436,12 @@ int synth_1to1_stereo_avx(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
 		dct64_real_avx(bufr[0]+fr->bo,bufr[1]+fr->bo+1,bandPtr_r);
 	}
 
-	clip = synth_1to1_s_avx_accurate_asm(fr->decwin, b0l, b0r, samples, bo1);
+	clip = synth_1to1_s_avx_asm(fr->decwin, b0l, b0r, samples, bo1);
 
 	fr->buffer.fill += 128;
 
 	return clip;
 }
-#else
-/* This is defined in assembler. */
-#ifndef OPT_X86_64
-int synth_1to1_x86_64_asm(short *window, short *b0, short *samples, int bo1);
-#endif
-int synth_1to1_s_avx_asm(short *window, short *b0l, short *b0r, short *samples, int bo1);
-void dct64_avx(short *out0, short *out1, real *samples);
-/* This is just a hull to use the mpg123 handle. */
-int synth_1to1_avx(real *bandPtr,int channel, mpg123_handle *fr, int final)
-{
-	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);	
-	short *b0, **buf;
-	int clip; 
-	int bo1;
-
-	if(fr->have_eq_settings) do_equalizer(bandPtr,channel,fr->equalizer);
-
-	if(!channel)
-	{
-		fr->bo--;
-		fr->bo &= 0xf;
-		buf = fr->short_buffs[0];
-	}
-	else
-	{
-		samples++;
-		buf = fr->short_buffs[1];
-	}
-
-	if(fr->bo & 0x1) 
-	{
-		b0 = buf[0];
-		bo1 = fr->bo;
-		dct64_avx(buf[1]+((fr->bo+1)&0xf),buf[0]+fr->bo,bandPtr);
-	}
-	else
-	{
-		b0 = buf[1];
-		bo1 = fr->bo+1;
-		dct64_avx(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
-	}
-
-	clip = synth_1to1_x86_64_asm((short *)fr->decwins, b0, samples, bo1);
-
-	if(final) fr->buffer.fill += 128;
-
-	return clip;
-}
-
-int synth_1to1_stereo_avx(real *bandPtr_l,real *bandPtr_r, mpg123_handle *fr)
-{
-	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);
-	short *b0l, *b0r, **bufl, **bufr;
-	int clip; 
-	int bo1;
-
-	if(fr->have_eq_settings)
-	{
-		do_equalizer(bandPtr_l,0,fr->equalizer);
-		do_equalizer(bandPtr_r,1,fr->equalizer);
-	}
-
-	fr->bo--;
-	fr->bo &= 0xf;
-	bufl = fr->short_buffs[0];
-	bufr = fr->short_buffs[1];
-
-	if(fr->bo & 0x1) 
-	{
-		b0l = bufl[0];
-		b0r = bufr[0];
-		bo1 = fr->bo;
-		dct64_avx(bufl[1]+((fr->bo+1)&0xf),bufl[0]+fr->bo,bandPtr_l);
-		dct64_avx(bufr[1]+((fr->bo+1)&0xf),bufr[0]+fr->bo,bandPtr_r);
-	}
-	else
-	{
-		b0l = bufl[1];
-		b0r = bufr[1];
-		bo1 = fr->bo+1;
-		dct64_avx(bufl[0]+fr->bo,bufl[1]+fr->bo+1,bandPtr_l);
-		dct64_avx(bufr[0]+fr->bo,bufr[1]+fr->bo+1,bandPtr_r);
-	}
-
-	clip = synth_1to1_s_avx_asm((short *)fr->decwins, b0l, b0r, samples, bo1);
-
-	fr->buffer.fill += 128;
-
-	return clip;
-}
-#endif
 #endif
 
 #ifdef OPT_ARM
@@ -721,10 +539,9 @@ int synth_1to1_arm(real *bandPtr,int channel, mpg123_handle *fr, int final)
 #endif
 
 #ifdef OPT_NEON
-#ifdef ACCURATE_ROUNDING
-/* This is defined in assembler. */
-int synth_1to1_neon_accurate_asm(real *window, real *b0, short *samples, int bo1);
-int synth_1to1_s_neon_accurate_asm(real *window, real *b0l, real *b0r, short *samples, int bo1);
+/* Synth filters in synth_neon.c. */
+int synth_1to1_neon_asm(real *window, real *b0, short *samples, int bo1);
+int synth_1to1_s_neon_asm(real *window, real *b0l, real *b0r, short *samples, int bo1);
 void dct64_real_neon(real *out0, real *out1, real *samples);
 /* Hull for C mpg123 API */
 int synth_1to1_neon(real *bandPtr,int channel, mpg123_handle *fr, int final)
@@ -762,7 +579,7 @@ int synth_1to1_neon(real *bandPtr,int channel, mpg123_handle *fr, int final)
 		dct64_real_neon(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
 	}
 
-	clip = synth_1to1_neon_accurate_asm(fr->decwin, b0, samples, bo1);
+	clip = synth_1to1_neon_asm(fr->decwin, b0, samples, bo1);
 
 	if(final) fr->buffer.fill += 128;
 
@@ -805,102 +622,13 @@ int synth_1to1_stereo_neon(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
 		dct64_real_neon(bufr[0]+fr->bo,bufr[1]+fr->bo+1,bandPtr_r);
 	}
 
-	clip = synth_1to1_s_neon_accurate_asm(fr->decwin, b0l, b0r, samples, bo1);
-
-	fr->buffer.fill += 128;
-
-	return clip;
-}
-#else
-/* This is defined in assembler. */
-int synth_1to1_neon_asm(short *window, short *b0, short *samples, int bo1);
-int synth_1to1_s_neon_asm(short *window, short *b0l, short *b0r, short *samples, int bo1);
-void dct64_neon(short *out0, short *out1, real *samples);
-/* Hull for C mpg123 API */
-int synth_1to1_neon(real *bandPtr,int channel, mpg123_handle *fr, int final)
-{
-	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);	
-	short *b0, **buf;
-	int clip; 
-	int bo1;
-
-	if(fr->have_eq_settings) do_equalizer(bandPtr,channel,fr->equalizer);
-
-	if(!channel)
-	{
-		fr->bo--;
-		fr->bo &= 0xf;
-		buf = fr->short_buffs[0];
-	}
-	else
-	{
-		samples++;
-		buf = fr->short_buffs[1];
-	}
-
-	if(fr->bo & 0x1) 
-	{
-		b0 = buf[0];
-		bo1 = fr->bo;
-		dct64_neon(buf[1]+((fr->bo+1)&0xf),buf[0]+fr->bo,bandPtr);
-	}
-	else
-	{
-		b0 = buf[1];
-		bo1 = fr->bo+1;
-		dct64_neon(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
-	}
-
-	clip = synth_1to1_neon_asm((short *)fr->decwins, b0, samples, bo1);
-
-	if(final) fr->buffer.fill += 128;
-
-	return clip;
-}
-
-int synth_1to1_stereo_neon(real *bandPtr_l,real *bandPtr_r, mpg123_handle *fr)
-{
-	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);
-	short *b0l, *b0r, **bufl, **bufr;
-	int clip; 
-	int bo1;
-
-	if(fr->have_eq_settings)
-	{
-		do_equalizer(bandPtr_l,0,fr->equalizer);
-		do_equalizer(bandPtr_r,1,fr->equalizer);
-	}
-
-	fr->bo--;
-	fr->bo &= 0xf;
-	bufl = fr->short_buffs[0];
-	bufr = fr->short_buffs[1];
-
-	if(fr->bo & 0x1) 
-	{
-		b0l = bufl[0];
-		b0r = bufr[0];
-		bo1 = fr->bo;
-		dct64_neon(bufl[1]+((fr->bo+1)&0xf),bufl[0]+fr->bo,bandPtr_l);
-		dct64_neon(bufr[1]+((fr->bo+1)&0xf),bufr[0]+fr->bo,bandPtr_r);
-	}
-	else
-	{
-		b0l = bufl[1];
-		b0r = bufr[1];
-		bo1 = fr->bo+1;
-		dct64_neon(bufl[0]+fr->bo,bufl[1]+fr->bo+1,bandPtr_l);
-		dct64_neon(bufr[0]+fr->bo,bufr[1]+fr->bo+1,bandPtr_r);
-	}
-
-	clip = synth_1to1_s_neon_asm((short *)fr->decwins, b0l, b0r, samples, bo1);
+	clip = synth_1to1_s_neon_asm(fr->decwin, b0l, b0r, samples, bo1);
 
 	fr->buffer.fill += 128;
 
 	return clip;
 }
 #endif
-#endif
 
 #ifndef NO_DOWNSAMPLE
 
@@ -0,0 +1,142 @@
+/*
+	synth_avx.c: stereo synth filters for the AVX decoder, AVX intrinsics
+
+	copyright 2006-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Stands in for upstream's synth_stereo_avx_*.S, for real == double. As there, the
+	mono synths of the AVX decoder are the ones of synth_x86_64.c.
+	The window layout and sample order are described there; here four samples of each
+	channel are done at a time.
+*/
+
+#include "mpg123lib_intern.h"
+#include "sample.h"
+
+#ifdef OPT_AVX
+#include <immintrin.h>
+
+#define TARGET_AVX __attribute__((target("avx")))
+
+/* Four lanes of the sums of one output sample for left and right, with the odd taps negated by sign. */
+static inline TARGET_AVX void synth_taps_s(const real *w, const real *bl, const real *br, const __m256d sign, __m256d *l, __m256d *r)
+{
+	__m256d w0 = _mm256_xor_pd(_mm256_loadu_pd(w),    sign);
+	__m256d w1 = _mm256_xor_pd(_mm256_loadu_pd(w+4),  sign);
+	__m256d w2 = _mm256_xor_pd(_mm256_loadu_pd(w+8),  sign);
+	__m256d w3 = _mm256_xor_pd(_mm256_loadu_pd(w+12), sign);
+	__m256d l0 = _mm256_add_pd(_mm256_mul_pd(w0, _mm256_loadu_pd(bl)),   _mm256_mul_pd(w2, _mm256_loadu_pd(bl+8)));
+	__m256d l1 = _mm256_add_pd(_mm256_mul_pd(w1, _mm256_loadu_pd(bl+4)), _mm256_mul_pd(w3, _mm256_loadu_pd(bl+12)));
+	__m256d r0 = _mm256_add_pd(_mm256_mul_pd(w0, _mm256_loadu_pd(br)),   _mm256_mul_pd(w2, _mm256_loadu_pd(br+8)));
+	__m256d r1 = _mm256_add_pd(_mm256_mul_pd(w1, _mm256_loadu_pd(br+4)), _mm256_mul_pd(w3, _mm256_loadu_pd(br+12)));
+	*l = _mm256_add_pd(l0, l1);
+	*r = _mm256_add_pd(r0, r1);
+}
+
+/* Finish the sums of four samples: { sum(a), sum(b), sum(c), sum(d) }. */
+static inline TARGET_AVX __m256d hsum4(__m256d a, __m256d b, __m256d c, __m256d d)
+{
+	__m256d ab = _mm256_hadd_pd(a, b);
+	__m256d cd = _mm256_hadd_pd(c, d);
+	return _mm256_add_pd(_mm256_permute2f128_pd(ab, cd, 0x20), _mm256_permute2f128_pd(ab, cd, 0x31));
+}
+
+#define SYNTH_WINDOW(window, bo1, n) ((n) < 17 ? (window)+16-(bo1)+32*(n) : (window)+528-(bo1)+32*((n)-16))
+#define SYNTH_B0(b0, n)              ((n) < 17 ? (b0)+16*(n) : (b0)+256-16*((n)-16))
+#define SYNTH_SIGN(n)                ((n) < 17 ? alternate : plain)
+
+/* Four samples each for left and right, as l0 r0 l1 r1 in *lo and l2 r2 l3 r3 in *hi. */
+static inline TARGET_AVX void synth_quad_s(real *window, real *b0l, real *b0r, int bo1, int n, __m256d *lo, __m256d *hi)
+{
+	const __m256d alternate = _mm256_set_pd(-0.0, 0.0, -0.0, 0.0);
+	const __m256d plain = _mm256_setzero_pd();
+	__m256d l[4], r[4], ls, rs, x, y;
+	int i;
+
+	for(i=0; i<4; ++i)
+	synth_taps_s(SYNTH_WINDOW(window, bo1, n+i), SYNTH_B0(b0l, n+i), SYNTH_B0(b0r, n+i), SYNTH_SIGN(n+i), &l[i], &r[i]);
+
+	ls = hsum4(l[0], l[1], l[2], l[3]);
+	rs = hsum4(r[0], r[1], r[2], r[3]);
+	x = _mm256_unpacklo_pd(ls, rs); /* l0 r0 l2 r2 */
+	y = _mm256_unpackhi_pd(ls, rs); /* l1 r1 l3 r3 */
+	*lo = _mm256_permute2f128_pd(x, y, 0x20);
+	*hi = _mm256_permute2f128_pd(x, y, 0x31);
+}
+
+/* Clip x to [min,max], counting the values that were outside, then make integers like REAL_TO_SHORT and REAL_TO_S32. */
+static inline TARGET_AVX __m128i to_int(__m256d x, const __m256d min, const __m256d max, __m256d *clip)
+{
+	const __m256d one = _mm256_set1_pd(1.0);
+	__m256d out = _mm256_or_pd(_mm256_cmp_pd(x, max, _CMP_GT_OQ), _mm256_cmp_pd(x, min, _CMP_LT_OQ));
+	*clip = _mm256_add_pd(*clip, _mm256_and_pd(out, one));
+	x = _mm256_min_pd(_mm256_max_pd(x, min), max);
+#ifdef ACCURATE_ROUNDING
+	/* x + 0.5 or x - 0.5, as in sample.h */
+	x = _mm256_add_pd(x, _mm256_or_pd(_mm256_and_pd(x, _mm256_set1_pd(-0.0)), _mm256_set1_pd(0.5)));
+#endif
+	return _mm256_cvttpd_epi32(x);
+}
+
+static inline TARGET_AVX int clip_count(__m256d clip)
+{
+	__m128d c = _mm_add_pd(_mm256_castpd256_pd128(clip), _mm256_extractf128_pd(clip, 1));
+	return (int)_mm_cvtsd_f64(_mm_add_pd(c, _mm_unpackhi_pd(c, c)));
+}
+
+#ifndef NO_16BIT
+TARGET_AVX int synth_1to1_s_avx_asm(real *window, real *b0l, real *b0r, short *samples, int bo1)
+{
+	const __m256d min = _mm256_set1_pd(REAL_MINUS_32768);
+	const __m256d max = _mm256_set1_pd(REAL_PLUS_32767);
+	__m256d clip = _mm256_setzero_pd();
+	int n;
+
+	for(n=0; n<32; n+=4, samples+=8)
+	{
+		__m256d lo, hi;
+		synth_quad_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		_mm_storeu_si128((__m128i*)samples, _mm_packs_epi32(to_int(lo, min, max, &clip), to_int(hi, min, max, &clip)));
+	}
+	return clip_count(clip);
+}
+#endif
+
+#ifndef NO_REAL
+TARGET_AVX int synth_1to1_real_s_avx_asm(real *window, real *b0l, real *b0r, real *samples, int bo1)
+{
+	const __m256d scale = _mm256_set1_pd((real)1./SHORT_SCALE);
+	int n;
+
+	for(n=0; n<32; n+=4, samples+=8)
+	{
+		__m256d lo, hi;
+		synth_quad_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		_mm256_storeu_pd(samples,   _mm256_mul_pd(lo, scale));
+		_mm256_storeu_pd(samples+4, _mm256_mul_pd(hi, scale));
+	}
+	return 0;
+}
+#endif
+
+#ifndef NO_32BIT
+TARGET_AVX int synth_1to1_s32_s_avx_asm(real *window, real *b0l, real *b0r, int32_t *samples, int bo1)
+{
+	const __m256d scale = _mm256_set1_pd(S32_RESCALE);
+	const __m256d min = _mm256_set1_pd(REAL_MINUS_S32);
+	const __m256d max = _mm256_set1_pd(REAL_PLUS_S32);
+	__m256d clip = _mm256_setzero_pd();
+	int n;
+
+	for(n=0; n<32; n+=4, samples+=8)
+	{
+		__m256d lo, hi;
+		synth_quad_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		_mm_storeu_si128((__m128i*)samples,     to_int(_mm256_mul_pd(lo, scale), min, max, &clip));
+		_mm_storeu_si128((__m128i*)(samples+4), to_int(_mm256_mul_pd(hi, scale), min, max, &clip));
+	}
+	return clip_count(clip);
+}
+#endif
+
+#endif
@@ -0,0 +1,208 @@
+/*
+	synth_neon.c: synth filters for the NEON decoder, AArch64 NEON intrinsics
+
+	copyright 2006-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Stands in for upstream's synth_neon_*.S and synth_stereo_neon_*.S, for real == double.
+	The window layout and sample order are described in synth_x86_64.c, this is the same
+	code with two lanes per vector.
+*/
+
+#include "mpg123lib_intern.h"
+#include "sample.h"
+
+#ifdef OPT_NEON
+#include <arm_neon.h>
+
+/* Two lanes of the sum for one output sample, with the odd taps negated by sign. */
+static inline float64x2_t synth_taps(const real *w, const real *b, const uint64x2_t sign)
+{
+	float64x2_t s0 = vdupq_n_f64(0.0), s1 = vdupq_n_f64(0.0);
+	int i;
+
+	for(i=0; i<16; i+=4)
+	{
+		float64x2_t w0 = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(vld1q_f64(w+i)),   sign));
+		float64x2_t w1 = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(vld1q_f64(w+i+2)), sign));
+		s0 = vaddq_f64(s0, vmulq_f64(w0, vld1q_f64(b+i)));
+		s1 = vaddq_f64(s1, vmulq_f64(w1, vld1q_f64(b+i+2)));
+	}
+	return vaddq_f64(s0, s1);
+}
+
+/* The same for two channels sharing the window. */
+static inline void synth_taps_s(const real *w, const real *bl, const real *br, const uint64x2_t sign, float64x2_t *l, float64x2_t *r)
+{
+	float64x2_t l0 = vdupq_n_f64(0.0), l1 = vdupq_n_f64(0.0);
+	float64x2_t r0 = vdupq_n_f64(0.0), r1 = vdupq_n_f64(0.0);
+	int i;
+
+	for(i=0; i<16; i+=4)
+	{
+		float64x2_t w0 = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(vld1q_f64(w+i)),   sign));
+		float64x2_t w1 = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(vld1q_f64(w+i+2)), sign));
+		l0 = vaddq_f64(l0, vmulq_f64(w0, vld1q_f64(bl+i)));
+		l1 = vaddq_f64(l1, vmulq_f64(w1, vld1q_f64(bl+i+2)));
+		r0 = vaddq_f64(r0, vmulq_f64(w0, vld1q_f64(br+i)));
+		r1 = vaddq_f64(r1, vmulq_f64(w1, vld1q_f64(br+i+2)));
+	}
+	*l = vaddq_f64(l0, l1);
+	*r = vaddq_f64(r0, r1);
+}
+
+#define SYNTH_WINDOW(window, bo1, n) ((n) < 17 ? (window)+16-(bo1)+32*(n) : (window)+528-(bo1)+32*((n)-16))
+#define SYNTH_B0(b0, n)              ((n) < 17 ? (b0)+16*(n) : (b0)+256-16*((n)-16))
+#define SYNTH_SIGN(n)                ((n) < 17 ? alternate : plain)
+
+static const uint64_t sign_alternate[2] = { 0, 0x8000000000000000ULL };
+
+/* All 32 sums of one channel. */
+static void synth_sums(real *window, real *b0, int bo1, real *sums)
+{
+	const uint64x2_t alternate = vld1q_u64(sign_alternate);
+	const uint64x2_t plain = vdupq_n_u64(0);
+	int n;
+
+	for(n=0; n<32; n+=2)
+	{
+		float64x2_t s0 = synth_taps(SYNTH_WINDOW(window, bo1, n),   SYNTH_B0(b0, n),   SYNTH_SIGN(n));
+		float64x2_t s1 = synth_taps(SYNTH_WINDOW(window, bo1, n+1), SYNTH_B0(b0, n+1), SYNTH_SIGN(n+1));
+		vst1q_f64(sums+n, vpaddq_f64(s0, s1));
+	}
+}
+
+/* Two samples each for left and right, as l0 r0 l1 r1 in *lo and *hi. */
+static inline void synth_pair_s(real *window, real *b0l, real *b0r, int bo1, int n, float64x2_t *lo, float64x2_t *hi)
+{
+	const uint64x2_t alternate = vld1q_u64(sign_alternate);
+	const uint64x2_t plain = vdupq_n_u64(0);
+	float64x2_t l0, r0, l1, r1, l, r;
+
+	synth_taps_s(SYNTH_WINDOW(window, bo1, n), SYNTH_B0(b0l, n), SYNTH_B0(b0r, n), SYNTH_SIGN(n), &l0, &r0);
+	synth_taps_s(SYNTH_WINDOW(window, bo1, n+1), SYNTH_B0(b0l, n+1), SYNTH_B0(b0r, n+1), SYNTH_SIGN(n+1), &l1, &r1);
+	l = vpaddq_f64(l0, l1);
+	r = vpaddq_f64(r0, r1);
+	*lo = vzip1q_f64(l, r);
+	*hi = vzip2q_f64(l, r);
+}
+
+/* Clip x to [min,max], counting the values that were outside, then make integers like REAL_TO_SHORT and REAL_TO_S32. */
+static inline int32x2_t to_int(float64x2_t x, const float64x2_t min, const float64x2_t max, uint64x2_t *clip)
+{
+	uint64x2_t out = vorrq_u64(vcgtq_f64(x, max), vcltq_f64(x, min));
+	*clip = vsubq_u64(*clip, out);
+	x = vminq_f64(vmaxq_f64(x, min), max);
+#ifdef ACCURATE_ROUNDING
+	/* x + 0.5 or x - 0.5, as in sample.h */
+	x = vaddq_f64(x, vbslq_f64(vdupq_n_u64(0x8000000000000000ULL), x, vdupq_n_f64(0.5)));
+#endif
+	return vmovn_s64(vcvtq_s64_f64(x));
+}
+
+static inline int clip_count(uint64x2_t clip)
+{
+	return (int)vaddvq_u64(clip);
+}
+
+#ifndef NO_16BIT
+int synth_1to1_neon_asm(real *window, real *b0, short *samples, int bo1)
+{
+	real sums[32];
+	int clip = 0;
+	int n;
+
+	synth_sums(window, b0, bo1, sums);
+	for(n=0; n<32; ++n, samples+=2)
+	{
+		WRITE_SHORT_SAMPLE(samples, sums[n], clip);
+	}
+	return clip;
+}
+
+int synth_1to1_s_neon_asm(real *window, real *b0l, real *b0r, short *samples, int bo1)
+{
+	const float64x2_t min = vdupq_n_f64(REAL_MINUS_32768);
+	const float64x2_t max = vdupq_n_f64(REAL_PLUS_32767);
+	uint64x2_t clip = vdupq_n_u64(0);
+	int n;
+
+	for(n=0; n<32; n+=2, samples+=4)
+	{
+		float64x2_t lo, hi;
+		int32x4_t out;
+		synth_pair_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		out = vcombine_s32(to_int(lo, min, max, &clip), to_int(hi, min, max, &clip));
+		vst1_s16(samples, vmovn_s32(out));
+	}
+	return clip_count(clip);
+}
+#endif
+
+#ifndef NO_REAL
+int synth_1to1_real_neon_asm(real *window, real *b0, real *samples, int bo1)
+{
+	real sums[32];
+	int clip = 0;
+	int n;
+
+	synth_sums(window, b0, bo1, sums);
+	for(n=0; n<32; ++n, samples+=2)
+	{
+		WRITE_REAL_SAMPLE(samples, sums[n], clip);
+	}
+	return clip;
+}
+
+int synth_1to1_real_s_neon_asm(real *window, real *b0l, real *b0r, real *samples, int bo1)
+{
+	const float64x2_t scale = vdupq_n_f64((real)1./SHORT_SCALE);
+	int n;
+
+	for(n=0; n<32; n+=2, samples+=4)
+	{
+		float64x2_t lo, hi;
+		synth_pair_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		vst1q_f64(samples,   vmulq_f64(lo, scale));
+		vst1q_f64(samples+2, vmulq_f64(hi, scale));
+	}
+	return 0;
+}
+#endif
+
+#ifndef NO_32BIT
+int synth_1to1_s32_neon_asm(real *window, real *b0, int32_t *samples, int bo1)
+{
+	real sums[32];
+	int clip = 0;
+	int n;
+
+	synth_sums(window, b0, bo1, sums);
+	for(n=0; n<32; ++n, samples+=2)
+	{
+		WRITE_S32_SAMPLE(samples, sums[n], clip);
+	}
+	return clip;
+}
+
+int synth_1to1_s32_s_neon_asm(real *window, real *b0l, real *b0r, int32_t *samples, int bo1)
+{
+	const float64x2_t scale = vdupq_n_f64(S32_RESCALE);
+	const float64x2_t min = vdupq_n_f64(REAL_MINUS_S32);
+	const float64x2_t max = vdupq_n_f64(REAL_PLUS_S32);
+	uint64x2_t clip = vdupq_n_u64(0);
+	int n;
+
+	for(n=0; n<32; n+=2, samples+=4)
+	{
+		float64x2_t lo, hi;
+		synth_pair_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		vst1q_s32(samples, vcombine_s32(
+			to_int(vmulq_f64(lo, scale), min, max, &clip),
+			to_int(vmulq_f64(hi, scale), min, max, &clip) ));
+	}
+	return clip_count(clip);
+}
+#endif
+
+#endif
@@ -92,7 +92,7 @@ int synth_1to1_real_x86_64(real *bandPtr,int channel, mpg123_handle *fr, int fin
 
 	synth_1to1_real_x86_64_asm(fr->decwin, b0, samples, bo1);
 
-	if(final) fr->buffer.fill += 256;
+	if(final) fr->buffer.fill += 64*sizeof(real);
 
 	return 0;
 }
@@ -134,7 +134,7 @@ int synth_1to1_real_stereo_x86_64(real *bandPtr_l, real *bandPtr_r, mpg123_handl
 
 	synth_1to1_real_s_x86_64_asm(fr->decwin, b0l, b0r, samples, bo1);
 
-	fr->buffer.fill += 256;
+	fr->buffer.fill += 64*sizeof(real);
 
 	return 0;
 }
@@ -184,7 +184,7 @@ int synth_1to1_real_avx(real *bandPtr,int channel, mpg123_handle *fr, int final)
 
 	synth_1to1_real_x86_64_asm(fr->decwin, b0, samples, bo1);
 
-	if(final) fr->buffer.fill += 256;
+	if(final) fr->buffer.fill += 64*sizeof(real);
 
 	return 0;
 }
@@ -226,7 +226,7 @@ int synth_1to1_real_stereo_avx(real *bandPtr_l, real *bandPtr_r, mpg123_handle *
 
 	synth_1to1_real_s_avx_asm(fr->decwin, b0l, b0r, samples, bo1);
 
-	fr->buffer.fill += 256;
+	fr->buffer.fill += 64*sizeof(real);
 
 	return 0;
 }
@@ -274,7 +274,7 @@ int synth_1to1_real_sse(real *bandPtr,int channel, mpg123_handle *fr, int final)
 
 	synth_1to1_real_sse_asm(fr->decwin, b0, samples, bo1);
 
-	if(final) fr->buffer.fill += 256;
+	if(final) fr->buffer.fill += 64*sizeof(real);
 
 	return 0;
 }
@@ -316,7 +316,7 @@ int synth_1to1_real_stereo_sse(real *bandPtr_l, real *bandPtr_r, mpg123_handle *
 
 	synth_1to1_real_s_sse_asm(fr->decwin, b0l, b0r, samples, bo1);
 
-	fr->buffer.fill += 256;
+	fr->buffer.fill += 64*sizeof(real);
 
 	return 0;
 }
@@ -364,7 +364,7 @@ int synth_1to1_real_neon(real *bandPtr,int channel, mpg123_handle *fr, int final
 
 	synth_1to1_real_neon_asm(fr->decwin, b0, samples, bo1);
 
-	if(final) fr->buffer.fill += 256;
+	if(final) fr->buffer.fill += 64*sizeof(real);
 
 	return 0;
 }
@@ -405,7 +405,7 @@ int synth_1to1_real_stereo_neon(real *bandPtr_l, real *bandPtr_r, mpg123_handle
 
 	synth_1to1_real_s_neon_asm(fr->decwin, b0l, b0r, samples, bo1);
 
-	fr->buffer.fill += 256;
+	fr->buffer.fill += 64*sizeof(real);
 
 	return 0;
 }
@@ -0,0 +1,225 @@
+/*
+	synth_x86_64.c: synth filters for the x86-64 decoders, SSE2 intrinsics
+
+	copyright 2006-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Stands in for upstream's synth_x86_64_*.S and synth_stereo_x86_64_*.S, for real == double,
+	and keeps their names so the hulls in synth.c, synth_real.c and synth_s32.c can call them.
+
+	They use the extended decode window that make_decode_tables() sets up for the
+	x86-64, AVX and NEON decoders: decwin[512..543] has the even entries cleared and
+	decwin[544+i] = -decwin[511-i]. With that, output sample 16 is just one more
+	alternating-sign sum like samples 0 to 15, and samples 17 to 31 are plain sums going
+	forward through the table, so every sample is a 16 tap dot product.
+
+	The sums are added in a different order than in the generic synth, so there can be
+	rounding differences in the last bit of the double sum. The conversion to 16 or 32 bit
+	integer does the same clipping and rounding as the generic synth (sample.h).
+*/
+
+#include "mpg123lib_intern.h"
+#include "sample.h"
+
+#ifdef OPT_X86_64
+#include <emmintrin.h>
+
+/* Two lanes of the sum for one output sample, with the odd taps negated by sign. */
+static inline __m128d synth_taps(const real *w, const real *b, const __m128d sign)
+{
+	__m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+	int i;
+
+	for(i=0; i<16; i+=4)
+	{
+		s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_xor_pd(_mm_loadu_pd(w+i),   sign), _mm_loadu_pd(b+i)));
+		s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_xor_pd(_mm_loadu_pd(w+i+2), sign), _mm_loadu_pd(b+i+2)));
+	}
+	return _mm_add_pd(s0, s1);
+}
+
+/* The same for two channels sharing the window. */
+static inline void synth_taps_s(const real *w, const real *bl, const real *br, const __m128d sign, __m128d *l, __m128d *r)
+{
+	__m128d l0 = _mm_setzero_pd(), l1 = _mm_setzero_pd();
+	__m128d r0 = _mm_setzero_pd(), r1 = _mm_setzero_pd();
+	int i;
+
+	for(i=0; i<16; i+=4)
+	{
+		__m128d w0 = _mm_xor_pd(_mm_loadu_pd(w+i),   sign);
+		__m128d w1 = _mm_xor_pd(_mm_loadu_pd(w+i+2), sign);
+		l0 = _mm_add_pd(l0, _mm_mul_pd(w0, _mm_loadu_pd(bl+i)));
+		l1 = _mm_add_pd(l1, _mm_mul_pd(w1, _mm_loadu_pd(bl+i+2)));
+		r0 = _mm_add_pd(r0, _mm_mul_pd(w0, _mm_loadu_pd(br+i)));
+		r1 = _mm_add_pd(r1, _mm_mul_pd(w1, _mm_loadu_pd(br+i+2)));
+	}
+	*l = _mm_add_pd(l0, l1);
+	*r = _mm_add_pd(r0, r1);
+}
+
+/* Finish the sums of two samples: { a0+a1, b0+b1 }. */
+static inline __m128d hsum2(__m128d a, __m128d b)
+{
+	return _mm_add_pd(_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b));
+}
+
+/*
+	Window and b0 of output sample n (0 to 31).
+	The first 17 go forward with alternating signs, the others go forward through
+	the mirrored part of the window and backwards through b0.
+*/
+#define SYNTH_WINDOW(window, bo1, n) ((n) < 17 ? (window)+16-(bo1)+32*(n) : (window)+528-(bo1)+32*((n)-16))
+#define SYNTH_B0(b0, n)              ((n) < 17 ? (b0)+16*(n) : (b0)+256-16*((n)-16))
+#define SYNTH_SIGN(n)                ((n) < 17 ? alternate : plain)
+
+/* All 32 sums of one channel. */
+static void synth_sums(real *window, real *b0, int bo1, real *sums)
+{
+	const __m128d alternate = _mm_set_pd(-0.0, 0.0);
+	const __m128d plain = _mm_setzero_pd();
+	int n;
+
+	for(n=0; n<32; n+=2)
+	{
+		__m128d s0 = synth_taps(SYNTH_WINDOW(window, bo1, n),   SYNTH_B0(b0, n),   SYNTH_SIGN(n));
+		__m128d s1 = synth_taps(SYNTH_WINDOW(window, bo1, n+1), SYNTH_B0(b0, n+1), SYNTH_SIGN(n+1));
+		_mm_storeu_pd(sums+n, hsum2(s0, s1));
+	}
+}
+
+/* Two samples each for left and right, as l0 r0 l1 r1 in *lo and *hi. */
+static inline void synth_pair_s(real *window, real *b0l, real *b0r, int bo1, int n, __m128d *lo, __m128d *hi)
+{
+	const __m128d alternate = _mm_set_pd(-0.0, 0.0);
+	const __m128d plain = _mm_setzero_pd();
+	__m128d l0, r0, l1, r1, l, r;
+
+	synth_taps_s(SYNTH_WINDOW(window, bo1, n), SYNTH_B0(b0l, n), SYNTH_B0(b0r, n), SYNTH_SIGN(n), &l0, &r0);
+	synth_taps_s(SYNTH_WINDOW(window, bo1, n+1), SYNTH_B0(b0l, n+1), SYNTH_B0(b0r, n+1), SYNTH_SIGN(n+1), &l1, &r1);
+	l = hsum2(l0, l1);
+	r = hsum2(r0, r1);
+	*lo = _mm_unpacklo_pd(l, r);
+	*hi = _mm_unpackhi_pd(l, r);
+}
+
+/* Clip x to [min,max], counting the values that were outside, then make an integer like REAL_TO_SHORT and REAL_TO_S32. */
+static inline __m128i to_int(__m128d x, const __m128d min, const __m128d max, __m128d *clip)
+{
+	const __m128d one = _mm_set1_pd(1.0);
+	__m128d out = _mm_or_pd(_mm_cmpgt_pd(x, max), _mm_cmplt_pd(x, min));
+	*clip = _mm_add_pd(*clip, _mm_and_pd(out, one));
+	x = _mm_min_pd(_mm_max_pd(x, min), max);
+#ifdef ACCURATE_ROUNDING
+	/* x + 0.5 or x - 0.5, as in sample.h */
+	x = _mm_add_pd(x, _mm_or_pd(_mm_and_pd(x, _mm_set1_pd(-0.0)), _mm_set1_pd(0.5)));
+#endif
+	return _mm_cvttpd_epi32(x);
+}
+
+static inline int clip_count(__m128d clip)
+{
+	return (int)_mm_cvtsd_f64(hsum2(clip, clip));
+}
+
+#ifndef NO_16BIT
+int synth_1to1_x86_64_asm(real *window, real *b0, short *samples, int bo1)
+{
+	real sums[32];
+	int clip = 0;
+	int n;
+
+	synth_sums(window, b0, bo1, sums);
+	for(n=0; n<32; ++n, samples+=2)
+	{
+		WRITE_SHORT_SAMPLE(samples, sums[n], clip);
+	}
+	return clip;
+}
+
+int synth_1to1_s_x86_64_asm(real *window, real *b0l, real *b0r, short *samples, int bo1)
+{
+	const __m128d min = _mm_set1_pd(REAL_MINUS_32768);
+	const __m128d max = _mm_set1_pd(REAL_PLUS_32767);
+	__m128d clip = _mm_setzero_pd();
+	int n;
+
+	for(n=0; n<32; n+=2, samples+=4)
+	{
+		__m128d lo, hi;
+		__m128i out;
+		synth_pair_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		out = _mm_unpacklo_epi64(to_int(lo, min, max, &clip), to_int(hi, min, max, &clip));
+		_mm_storel_epi64((__m128i*)samples, _mm_packs_epi32(out, out));
+	}
+	return clip_count(clip);
+}
+#endif
+
+#ifndef NO_REAL
+int synth_1to1_real_x86_64_asm(real *window, real *b0, real *samples, int bo1)
+{
+	real sums[32];
+	int clip = 0;
+	int n;
+
+	synth_sums(window, b0, bo1, sums);
+	for(n=0; n<32; ++n, samples+=2)
+	{
+		WRITE_REAL_SAMPLE(samples, sums[n], clip);
+	}
+	return clip;
+}
+
+int synth_1to1_real_s_x86_64_asm(real *window, real *b0l, real *b0r, real *samples, int bo1)
+{
+	const __m128d scale = _mm_set1_pd((real)1./SHORT_SCALE);
+	int n;
+
+	for(n=0; n<32; n+=2, samples+=4)
+	{
+		__m128d lo, hi;
+		synth_pair_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		_mm_storeu_pd(samples,   _mm_mul_pd(lo, scale));
+		_mm_storeu_pd(samples+2, _mm_mul_pd(hi, scale));
+	}
+	return 0;
+}
+#endif
+
+#ifndef NO_32BIT
+int synth_1to1_s32_x86_64_asm(real *window, real *b0, int32_t *samples, int bo1)
+{
+	real sums[32];
+	int clip = 0;
+	int n;
+
+	synth_sums(window, b0, bo1, sums);
+	for(n=0; n<32; ++n, samples+=2)
+	{
+		WRITE_S32_SAMPLE(samples, sums[n], clip);
+	}
+	return clip;
+}
+
+int synth_1to1_s32_s_x86_64_asm(real *window, real *b0l, real *b0r, int32_t *samples, int bo1)
+{
+	const __m128d scale = _mm_set1_pd(S32_RESCALE);
+	const __m128d min = _mm_set1_pd(REAL_MINUS_S32);
+	const __m128d max = _mm_set1_pd(REAL_PLUS_S32);
+	__m128d clip = _mm_setzero_pd();
+	int n;
+
+	for(n=0; n<32; n+=2, samples+=4)
+	{
+		__m128d lo, hi;
+		synth_pair_s(window, b0l, b0r, bo1, n, &lo, &hi);
+		_mm_storeu_si128((__m128i*)samples, _mm_unpacklo_epi64(
+			to_int(_mm_mul_pd(lo, scale), min, max, &clip),
+			to_int(_mm_mul_pd(hi, scale), min, max, &clip) ));
+	}
+	return clip_count(clip);
+}
+#endif
+
+#endif
@@ -227,15 +227,6 @@ void make_decode_tables(mpg123_handle *fr)
 		{
 			fr->decwin[512+32+i] = -fr->decwin[511-i];
 		}
-#ifdef OPT_NEON
-		if(fr->cpu_opts.type == neon)
-		{
-			for(i=0; i<512; i+=2)
-			{
-				fr->decwin[i] = -fr->decwin[i];
-			}
-		}
-#endif
 	}
 #endif
 	debug("decode tables done");
@@ -0,0 +1,117 @@
+/*
+ * mpegbench: times decoding with each decoder mpg123 offers on this CPU.
+ *
+ * A synthetic stereo Layer II stream (and a Layer I one) is decoded from
+ * memory to 16 bit, 32 bit and double samples by every decoder in
+ * mpg123_supported_decoders(), and the best of several runs is reported.
+ * The samples are decoded into one small buffer and thrown away, so only
+ * the decoding is timed.
+ *
+ * usage: mpegbench [seconds] [runs]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "mpg123.h"
+#include "mpegstream.h"
+
+static const struct
+{
+	int encoding;
+	const char *name;
+} encodings[] =
+{
+	{ MPG123_ENC_SIGNED_16, "s16" },
+	{ MPG123_ENC_SIGNED_32, "s32" },
+	{ MPG123_ENC_FLOAT_64, "f64" },
+};
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Returns the time to decode the whole stream, or a negative number. */
+static double time_decode(const char *decoder, int encoding,
+                          const unsigned char *data, size_t size)
+{
+	static unsigned char buf[65536];
+	mpg123_handle *mh = mpg123_new(decoder, NULL);
+	double t;
+	int err;
+
+	if(!mh)
+		return -1;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0);
+	mpg123_format_none(mh);
+	mpg123_format(mh, 44100, MPG123_MONO | MPG123_STEREO, encoding);
+	if(mpg123_open_feed(mh) != MPG123_OK
+	|| mpg123_feed(mh, data, size) != MPG123_OK)
+	{
+		mpg123_delete(mh);
+		return -1;
+	}
+
+	t = now();
+	do
+	{
+		size_t done;
+		err = mpg123_read(mh, buf, sizeof(buf), &done);
+	} while(err == MPG123_OK || err == MPG123_NEW_FORMAT);
+	t = now() - t;
+
+	mpg123_delete(mh);
+	return err == MPG123_NEED_MORE || err == MPG123_DONE ? t : -1;
+}
+
+int main(int argc, char **argv)
+{
+	double seconds = argc > 1 ? atof(argv[1]) : 600;
+	int runs = argc > 2 ? atoi(argv[2]) : 5;
+	const char **decoders;
+	int layer, e, d, r;
+
+	if(seconds <= 0 || runs <= 0 || mpg123_init() != MPG123_OK)
+		return 1;
+	decoders = mpg123_supported_decoders();
+
+	for(layer = 2; layer >= 1; --layer)
+	{
+		size_t size;
+		unsigned char *data = make_mpeg_stream(layer, 2, seconds, 1, &size);
+		if(!data)
+		{
+			fprintf(stderr, "couldn't make stream\n");
+			return 1;
+		}
+		printf("%g s of stereo Layer %s, best of %d:\n", seconds, layer == 1 ? "I" : "II", runs);
+		for(e = 0; e < (int)(sizeof(encodings) / sizeof(encodings[0])); ++e)
+		{
+			printf("  %s:", encodings[e].name);
+			for(d = 0; decoders[d]; ++d)
+			{
+				double best = 1e30;
+				for(r = 0; r < runs; ++r)
+				{
+					double t = time_decode(decoders[d], encodings[e].encoding, data, size);
+					if(t < 0)
+					{
+						fprintf(stderr, "%s failed to decode\n", decoders[d]);
+						return 1;
+					}
+					if(t < best)
+						best = t;
+				}
+				printf(" %s %.3f s%s", decoders[d], best, decoders[d + 1] ? "," : "\n");
+			}
+		}
+		free(data);
+	}
+
+	mpg123_exit();
+	return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * mpegcheck: checks the SIMD decoders in mpg123 against the generic one.
+ *
+ * First dct64 is run on random input through the generic code and through
+ * every SIMD version built for this host, and must match to the last bit.
+ *
+ * Then synthetic Layer I and Layer II streams, mono and stereo, are decoded
+ * by each decoder mpg123_supported_decoders() offers to 16 bit, 32 bit and
+ * double samples and compared with the generic decode. Integer samples must
+ * match exactly. The SIMD synth filters add up their 16 taps in a different
+ * order, so double samples may be a few ulps off, but no more than
+ * FLOAT_TOLERANCE.
+ *
+ * usage: mpegcheck [seconds]
+ *
+ * Returns non-zero if anything differs.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpg123.h"
+#include "mpegdecode.h"
+#include "mpegstream.h"
+
+#define FLOAT_TOLERANCE 1e-12
+
+/* From the library; real is double in this build. */
+void INT123_prepare_decode_tables(void);
+void INT123_dct64(double *out0, double *out1, double *samples);
+#if defined(__x86_64__)
+void INT123_dct64_real_x86_64(double *out0, double *out1, double *samples);
+void INT123_dct64_real_avx(double *out0, double *out1, double *samples);
+#elif defined(__aarch64__)
+void INT123_dct64_real_neon(double *out0, double *out1, double *samples);
+#endif
+
+static const struct
+{
+	const char *name;
+	void (*dct64)(double *, double *, double *);
+} dct64s[] =
+{
+#if defined(__x86_64__)
+	{ "x86-64", INT123_dct64_real_x86_64 },
+	{ "AVX", INT123_dct64_real_avx },
+#elif defined(__aarch64__)
+	{ "NEON", INT123_dct64_real_neon },
+#endif
+	{ NULL, NULL }
+};
+
+static const struct
+{
+	int encoding;
+	const char *name;
+} encodings[] =
+{
+	{ MPG123_ENC_SIGNED_16, "s16" },
+	{ MPG123_ENC_SIGNED_32, "s32" },
+	{ MPG123_ENC_FLOAT_64, "f64" },
+};
+
+static int check_dct64(void)
+{
+	const char **decoders = mpg123_supported_decoders();
+	int failures = 0, d, t, i;
+
+	INT123_prepare_decode_tables();
+	srand(1);
+	for(d = 0; dct64s[d].name; ++d)
+	{
+		int bad = 0, supported = 0;
+		for(i = 0; decoders[i]; ++i)
+			if(!strcasecmp(decoders[i], dct64s[d].name))
+				supported = 1;
+		if(!supported)
+		{
+			printf("dct64 %s: not supported by this CPU\n", dct64s[d].name);
+			continue;
+		}
+		for(t = 0; t < 100000; ++t)
+		{
+			double in[32], work[32], a0[512], a1[512], b0[512], b1[512];
+			for(i = 0; i < 32; ++i)
+				in[i] = (rand() / (double)RAND_MAX - 0.5) * (t % 7 + 1) * 1000;
+			memset(a0, 0, sizeof(a0));
+			memset(a1, 0, sizeof(a1));
+			memset(b0, 0, sizeof(b0));
+			memset(b1, 0, sizeof(b1));
+			memcpy(work, in, sizeof(in));
+			INT123_dct64(a0, a1, work);
+			memcpy(work, in, sizeof(in));
+			dct64s[d].dct64(b0, b1, work);
+			if(memcmp(a0, b0, sizeof(a0)) || memcmp(a1, b1, sizeof(a1)))
+				++bad;
+		}
+		printf("dct64 %s: %d of 100000 differ\n", dct64s[d].name, bad);
+		if(bad)
+			++failures;
+	}
+	return failures;
+}
+
+static double sample_at(const unsigned char *p, int encoding, size_t i)
+{
+	switch(encoding)
+	{
+		case MPG123_ENC_SIGNED_16: return ((const int16_t *)p)[i];
+		case MPG123_ENC_SIGNED_32: return ((const int32_t *)p)[i];
+		default: return ((const double *)p)[i];
+	}
+}
+
+/* Compares one decode with the generic one and prints the result. */
+static int compare(const char *decoder, int e, const unsigned char *data,
+                   size_t size, const unsigned char *ref, size_t ref_size)
+{
+	int encoding = encodings[e].encoding;
+	size_t out_size, n, i, differ = 0;
+	unsigned char *out = decode_stream(decoder, encoding, data, size, &out_size);
+	double max_diff = 0, tolerance = encoding == MPG123_ENC_FLOAT_64 ? FLOAT_TOLERANCE : 0;
+
+	printf("  %-8s %s: ", decoder, encodings[e].name);
+	if(!out)
+	{
+		printf("FAILED to decode\n");
+		return 1;
+	}
+	if(out_size != ref_size)
+	{
+		printf("LENGTH %zu, generic %zu\n", out_size, ref_size);
+		free(out);
+		return 1;
+	}
+	n = out_size / mpg123_encsize(encoding);
+	for(i = 0; i < n; ++i)
+	{
+		double a = sample_at(ref, encoding, i), b = sample_at(out, encoding, i);
+		if(a != b)
+		{
+			++differ;
+			if(fabs(a - b) > max_diff)
+				max_diff = fabs(a - b);
+		}
+	}
+	free(out);
+	if(max_diff > tolerance)
+	{
+		printf("%zu of %zu samples DIFFER, by up to %g\n", differ, n, max_diff);
+		return 1;
+	}
+	if(differ)
+		printf("%zu of %zu samples off by up to %g\n", differ, n, max_diff);
+	else
+		printf("same\n");
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	double seconds = argc > 1 ? atof(argv[1]) : 20;
+	const char **decoders;
+	int failures, layer, channels, e, d;
+
+	if(seconds <= 0 || mpg123_init() != MPG123_OK)
+		return 1;
+	decoders = mpg123_supported_decoders();
+
+	failures = check_dct64();
+
+	for(layer = 1; layer <= 2; ++layer)
+	for(channels = 1; channels <= 2; ++channels)
+	{
+		size_t size;
+		unsigned char *data = make_mpeg_stream(layer, channels, seconds, layer * 2 + channels, &size);
+		if(!data)
+		{
+			fprintf(stderr, "couldn't make stream\n");
+			return 1;
+		}
+		printf("Layer %s, %s:\n", layer == 1 ? "I" : "II", channels == 2 ? "stereo" : "mono");
+		for(e = 0; e < (int)(sizeof(encodings) / sizeof(encodings[0])); ++e)
+		{
+			size_t ref_size;
+			unsigned char *ref = decode_stream("generic", encodings[e].encoding, data, size, &ref_size);
+			if(!ref || !ref_size)
+			{
+				printf("  generic  %s: FAILED to decode\n", encodings[e].name);
+				++failures;
+				free(ref);
+				continue;
+			}
+			for(d = 0; decoders[d]; ++d)
+			{
+				if(!strcmp(decoders[d], "generic"))
+					continue;
+				failures += compare(decoders[d], e, data, size, ref, ref_size);
+			}
+			free(ref);
+		}
+		free(data);
+	}
+
+	mpg123_exit();
+	printf(failures ? "FAILED\n" : "OK\n");
+	return failures != 0;
+}
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpg123.h"
+#include "mpegdecode.h"
+
+unsigned char *decode_stream(const char *decoder, int encoding,
+                             const unsigned char *data, size_t data_size,
+                             size_t *size)
+{
+	unsigned char *out = NULL;
+	size_t total = 0, room = 0;
+	mpg123_handle *mh;
+	int err;
+
+	mh = mpg123_new(decoder, &err);
+	if(!mh)
+	{
+		fprintf(stderr, "%s: %s\n", decoder, mpg123_plain_strerror(err));
+		return NULL;
+	}
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0);
+	mpg123_format_none(mh);
+	mpg123_format(mh, 44100, MPG123_MONO | MPG123_STEREO, encoding);
+	if(mpg123_open_feed(mh) != MPG123_OK
+	|| mpg123_feed(mh, data, data_size) != MPG123_OK)
+		goto fail;
+
+	for(;;)
+	{
+		size_t done;
+		if(room - total < 65536)
+		{
+			unsigned char *grown;
+			room = room ? room * 2 : 1 << 20;
+			grown = realloc(out, room);
+			if(!grown)
+				goto fail;
+			out = grown;
+		}
+		err = mpg123_read(mh, out + total, room - total, &done);
+		total += done;
+		if(err == MPG123_NEED_MORE || err == MPG123_DONE)
+			break;
+		if(err != MPG123_OK && err != MPG123_NEW_FORMAT)
+		{
+			fprintf(stderr, "%s: %s\n", decoder, mpg123_strerror(mh));
+			goto fail;
+		}
+	}
+
+	mpg123_delete(mh);
+	*size = total;
+	return out;
+
+fail:
+	mpg123_delete(mh);
+	free(out);
+	return NULL;
+}
@@ -0,0 +1,13 @@
+#ifndef MPEGDECODE_H
+#define MPEGDECODE_H
+
+#include <stddef.h>
+
+/* Decodes a whole stream from memory with the named mpg123 decoder into a
+ * new buffer of samples in the given MPG123_ENC_* encoding, and returns it,
+ * with its size in bytes in *size, or NULL on failure. */
+unsigned char *decode_stream(const char *decoder, int encoding,
+                             const unsigned char *data, size_t data_size,
+                             size_t *size);
+
+#endif /* MPEGDECODE_H */
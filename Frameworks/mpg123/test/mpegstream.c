@@ -0,0 +1,93 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpegstream.h"
+
+static unsigned int rnd_state;
+
+static unsigned int rnd(void)
+{
+	rnd_state = rnd_state * 1103515245 + 12345;
+	return (rnd_state >> 8) & 0xffff;
+}
+
+/* A random number from lo to hi inclusive. */
+static int rnd_range(int lo, int hi)
+{
+	return lo + (int)(rnd() % (unsigned int)(hi - lo + 1));
+}
+
+struct bits
+{
+	unsigned char *p;
+	unsigned int n;
+};
+
+static void put_bits(struct bits *b, unsigned int val, int n)
+{
+	while(n--)
+	{
+		if(val >> n & 1)
+			b->p[b->n >> 3] |= 0x80 >> (b->n & 7);
+		++b->n;
+	}
+}
+
+unsigned char *make_mpeg_stream(int layer, int channels, double seconds,
+                                unsigned int seed, size_t *size)
+{
+	/* 384 kbit/s Layer II and 448 kbit/s Layer I, no CRC, no padding */
+	const size_t frame_size = layer == 2 ? 144 * 384000 / 44100
+	                                     : (12 * 448000 / 44100) * 4;
+	const long frames = (long)(seconds * 44100 / (layer == 2 ? 1152 : 384));
+	const unsigned char mode = channels == 2 ? 0x00 : 0xc0;
+	unsigned char *data;
+	long f;
+	int level = 12;
+
+	if(frames <= 0 || (layer != 1 && layer != 2))
+		return NULL;
+	data = calloc(frames, frame_size);
+	if(!data)
+		return NULL;
+	rnd_state = seed;
+
+	for(f = 0; f < frames; ++f)
+	{
+		unsigned char *p = data + f * frame_size;
+		if(layer == 2)
+		{
+			size_t i;
+			p[0] = 0xff; p[1] = 0xfd; p[2] = 0xe0; p[3] = mode;
+			for(i = 4; i < frame_size; ++i)
+				p[i] = (unsigned char)rnd();
+		}
+		else
+		{
+			/* The lowest 20 subbands carry 4 bit samples, the rest nothing. */
+			const int sblimit = 20;
+			struct bits b = { p, 0 };
+			int sb, ch, s;
+			if(f % 50 == 0)
+				level = rnd_range(8, 28);
+			p[0] = 0xff; p[1] = 0xff; p[2] = 0xe0; p[3] = mode;
+			b.n = 32;
+			for(sb = 0; sb < 32; ++sb)
+				for(ch = 0; ch < channels; ++ch)
+					put_bits(&b, sb < sblimit ? 4 : 0, 4);
+			for(sb = 0; sb < sblimit; ++sb)
+				for(ch = 0; ch < channels; ++ch)
+				{
+					int scale = level + sb + rnd_range(0, 3);
+					put_bits(&b, scale < 62 ? scale : 62, 6);
+				}
+			for(s = 0; s < 12; ++s)
+				for(sb = 0; sb < sblimit; ++sb)
+					for(ch = 0; ch < channels; ++ch)
+						put_bits(&b, rnd_range(0, 30), 5);
+		}
+	}
+
+	*size = frames * frame_size;
+	return data;
+}
@@ -0,0 +1,18 @@
+#ifndef MPEGSTREAM_H
+#define MPEGSTREAM_H
+
+#include <stddef.h>
+
+/* Writes a synthetic MPEG-1 stream at 44.1 kHz into a new buffer and returns
+ * it, with its size in *size, or NULL on failure. The same seed always gives
+ * the same stream.
+ *
+ * layer 1 gives Layer I frames of band-limited noise at programme-like
+ * levels, changing every 50 frames. layer 2 gives Layer II frames whose
+ * payload is random, which decodes to full scale noise that clips heavily.
+ * Both paths end in the same dct64 and synth filters that Layer III uses.
+ */
+unsigned char *make_mpeg_stream(int layer, int channels, double seconds,
+                                unsigned int seed, size_t *size);
+
+#endif /* MPEGSTREAM_H */
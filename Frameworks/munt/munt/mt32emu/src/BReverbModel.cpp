@@ -18,6 +18,7 @@
 #include <cstring>
 #include "mt32emu.h"
 #include "BReverbModel.h"
+#include "FloatVector.h"
 
 // Analysing of state of reverb RAM address lines gives exact sizes of the buffers of filters used. This also indicates that
 // the reverb model implemented in the real devices consists of three series allpass filters preceded by a non-feedback comb (or a delay with a LPF)
@@ -34,6 +35,9 @@ static const Bit32u PROCESS_DELAY = 1;
 static const Bit32u MODE_3_ADDITIONAL_DELAY = 1;
 static const Bit32u MODE_3_FEEDBACK_DELAY = 1;
 
+// The filters process the input in runs of up to this many samples, each filter completing a run before the next one starts.
+static const Bit32u MAX_RUN_LENGTH = 256;
+
 // Default reverb settings for "new" reverb model implemented in CM-32L / LAPC-I.
 // Found by tracing reverb RAM data lines (thanks go to Lord_Nightmare & balrog).
 const BReverbSettings &BReverbModel::getCM32L_LAPCSettings(const ReverbMode mode) {
@@ -209,6 +213,18 @@ Sample RingBuffer::next() {
 	return buffer[index];
 }
 
+Bit32u RingBuffer::advance(Bit32u &length) {
+	Bit32u start = index + 1;
+	if (start >= size) {
+		start = 0;
+	}
+	if (length > size - start) {
+		length = size - start;
+	}
+	index = start + length - 1;
+	return start;
+}
+
 bool RingBuffer::isEmpty() const {
 	if (buffer == NULL) return true;
 
@@ -231,25 +247,48 @@ void RingBuffer::mute() {
 
 AllpassFilter::AllpassFilter(const Bit32u useSize) : RingBuffer(useSize) {}
 
-Sample AllpassFilter::process(const Sample in) {
+void AllpassFilter::process(const Sample *in, Sample *out, Bit32u numSamples) {
 	// This model corresponds to the allpass filter implementation of the real CM-32L device
 	// found from sample analysis
 
-	const Sample bufferOut = next();
+	// Within a segment, each sample only depends on the input and the buffer contents at the same position
+	while (numSamples > 0) {
+		Bit32u length = numSamples;
+		Sample *buf = buffer + advance(length);
+		Bit32u i = 0;
+
+#if MT32EMU_USE_FLOAT_VECTORS
+		const FloatVector half = setFloatVector(0.5f);
+		for (; i + FLOAT_VECTOR_SIZE <= length; i += FLOAT_VECTOR_SIZE) {
+			const FloatVector bufferOut = loadFloatVector(buf + i);
+			const FloatVector stored = subFloatVectors(loadFloatVector(in + i), mulFloatVectors(half, bufferOut));
+			storeFloatVector(buf + i, stored);
+			storeFloatVector(out + i, addFloatVectors(bufferOut, mulFloatVectors(half, stored)));
+		}
+#endif
+
+		for (; i < length; i++) {
+			const Sample bufferOut = buf[i];
 
 #if MT32EMU_USE_FLOAT_SAMPLES
-	// store input - feedback / 2
-	buffer[index] = in - 0.5f * bufferOut;
+			// store input - feedback / 2
+			buf[i] = in[i] - 0.5f * bufferOut;
 
-	// return buffer output + feedforward / 2
-	return bufferOut + 0.5f * buffer[index];
+			// return buffer output + feedforward / 2
+			out[i] = bufferOut + 0.5f * buf[i];
 #else
-	// store input - feedback / 2
-	buffer[index] = in - (bufferOut >> 1);
+			// store input - feedback / 2
+			buf[i] = in[i] - (bufferOut >> 1);
 
-	// return buffer output + feedforward / 2
-	return bufferOut + (buffer[index] >> 1);
+			// return buffer output + feedforward / 2
+			out[i] = bufferOut + (buf[i] >> 1);
 #endif
+		}
+
+		in += length;
+		out += length;
+		numSamples -= length;
+	}
 }
 
 CombFilter::CombFilter(const Bit32u useSize, const Bit32u useFilterFactor) : RingBuffer(useSize), filterFactor(useFilterFactor) {}
@@ -267,6 +306,58 @@ void CombFilter::process(const Sample in) {
 	buffer[index] = weirdMul(last, filterFactor, 0xC0) - filterIn;
 }
 
+void CombFilter::process(const Sample *in, Bit32u numSamples, const Bit32u outLPosition, Sample *outLeft, const Bit32u outRPosition, Sample *outRight) {
+	Sample filterIn[MAX_RUN_LENGTH];
+
+	while (numSamples > 0) {
+		// the previously stored value
+		Sample last = buffer[index];
+
+		Bit32u length = numSamples > MAX_RUN_LENGTH ? MAX_RUN_LENGTH : numSamples;
+		const Bit32u start = advance(length);
+		Sample *buf = buffer + start;
+		Bit32u i = 0;
+
+		// prepare input + feedback, the feedback samples are all stored before this segment
+#if MT32EMU_USE_FLOAT_VECTORS
+		const FloatVector feedback = setFloatVector((float)(Bit8u)feedbackFactor);
+		const FloatVector scale = setFloatVector(1.0f / 256.0f);
+		for (; i + FLOAT_VECTOR_SIZE <= length; i += FLOAT_VECTOR_SIZE) {
+			const FloatVector feedbackIn = mulFloatVectors(mulFloatVectors(loadFloatVector(buf + i), feedback), scale);
+			storeFloatVector(filterIn + i, addFloatVectors(loadFloatVector(in + i), feedbackIn));
+		}
+#endif
+		for (; i < length; i++) {
+			filterIn[i] = in[i] + weirdMul(buf[i], feedbackFactor, 0xF0);
+		}
+
+		Bit32u outLIndex = (size + start - outLPosition % size) % size;
+		Bit32u outRIndex = (size + start - outRPosition % size) % size;
+
+		for (i = 0; i < length; i++) {
+			if (outLeft != NULL) {
+				*(outLeft++) = buffer[outLIndex];
+				if (++outLIndex >= size) {
+					outLIndex = 0;
+				}
+			}
+			if (outRight != NULL) {
+				*(outRight++) = buffer[outRIndex];
+				if (++outRIndex >= size) {
+					outRIndex = 0;
+				}
+			}
+
+			// store input + feedback processed by a low-pass filter
+			last = weirdMul(last, filterFactor, 0xC0) - filterIn[i];
+			buf[i] = last;
+		}
+
+		in += length;
+		numSamples -= length;
+	}
+}
+
 Sample CombFilter::getOutputAt(const Bit32u outIndex) const {
 	return buffer[(size + index - outIndex) % size];
 }
@@ -292,6 +383,32 @@ void DelayWithLowPassFilter::process(const Sample in) {
 	buffer[index] = weirdMul(lpfOut, amp, 0xFF);
 }
 
+void DelayWithLowPassFilter::process(const Sample *in, Sample *out, Bit32u numSamples) {
+	while (numSamples > 0) {
+		// the previously stored value
+		Sample last = buffer[index];
+
+		Bit32u length = numSamples;
+		Sample *buf = buffer + advance(length);
+
+		for (Bit32u i = 0; i < length; i++) {
+			// If the output position is equal to the delay size, get it now in order not to loose it
+			out[i] = buf[i];
+
+			// low-pass filter process
+			Sample lpfOut = weirdMul(last, filterFactor, 0xFF) + in[i];
+
+			// store lpfOut multiplied by LPF amp factor
+			last = weirdMul(lpfOut, amp, 0xFF);
+			buf[i] = last;
+		}
+
+		in += length;
+		out += length;
+		numSamples -= length;
+	}
+}
+
 TapDelayCombFilter::TapDelayCombFilter(const Bit32u useSize, const Bit32u useFilterFactor) : CombFilter(useSize, useFilterFactor) {}
 
 void TapDelayCombFilter::process(const Sample in) {
@@ -430,98 +547,140 @@ bool BReverbModel::isMT32Compatible(const ReverbMode mode) const {
 	return &currentSettings == &getMT32Settings(mode);
 }
 
-void BReverbModel::process(const Sample *inLeft, const Sample *inRight, Sample *outLeft, Sample *outRight, unsigned long numSamples) {
-	if (combs == NULL) {
-		Synth::muteSampleBuffer(outLeft, numSamples);
-		Synth::muteSampleBuffer(outRight, numSamples);
-		return;
+// Mixes the dry input channels and applies the dry amp
+static void mixDryInput(const Sample *inLeft, const Sample *inRight, Sample *dry, Bit32u numSamples, const bool tapDelayMode, const Bit32u dryAmp) {
+	Bit32u i = 0;
+
+#if MT32EMU_USE_FLOAT_VECTORS
+	const FloatVector inputFactor = setFloatVector(tapDelayMode ? 0.5f : 0.25f);
+	const FloatVector amp = setFloatVector((float)(Bit8u)dryAmp);
+	const FloatVector scale = setFloatVector(1.0f / 256.0f);
+	for (; i + FLOAT_VECTOR_SIZE <= numSamples; i += FLOAT_VECTOR_SIZE) {
+		const FloatVector mixed = addFloatVectors(mulFloatVectors(loadFloatVector(inLeft + i), inputFactor), mulFloatVectors(loadFloatVector(inRight + i), inputFactor));
+		storeFloatVector(dry + i, mulFloatVectors(mulFloatVectors(mixed, amp), scale));
 	}
+#endif
 
-	Sample dry;
-
-	while ((numSamples--) > 0) {
+	for (; i < numSamples; i++) {
+		Sample mixed;
 		if (tapDelayMode) {
 #if MT32EMU_USE_FLOAT_SAMPLES
-			dry = (*(inLeft++) * 0.5f) + (*(inRight++) * 0.5f);
+			mixed = (inLeft[i] * 0.5f) + (inRight[i] * 0.5f);
 #else
-			dry = (*(inLeft++) >> 1) + (*(inRight++) >> 1);
+			mixed = (inLeft[i] >> 1) + (inRight[i] >> 1);
 #endif
 		} else {
 #if MT32EMU_USE_FLOAT_SAMPLES
-			dry = (*(inLeft++) * 0.25f) + (*(inRight++) * 0.25f);
+			mixed = (inLeft[i] * 0.25f) + (inRight[i] * 0.25f);
 #elif MT32EMU_BOSS_REVERB_PRECISE_MODE
-			dry = (*(inLeft++) >> 1) / 2 + (*(inRight++) >> 1) / 2;
+			mixed = (inLeft[i] >> 1) / 2 + (inRight[i] >> 1) / 2;
 #else
-			dry = (*(inLeft++) >> 2) + (*(inRight++) >> 2);
+			mixed = (inLeft[i] >> 2) + (inRight[i] >> 2);
 #endif
 		}
 
 		// Looks like dryAmp doesn't change in MT-32 but it does in CM-32L / LAPC-I
-		dry = weirdMul(dry, dryAmp, 0xFF);
+		dry[i] = weirdMul(mixed, dryAmp, 0xFF);
+	}
+}
+
+// Sums the outputs of the three parallel combs and applies the wet level
+static void mixCombOutputs(const Sample *out1, const Sample *out2, const Sample *out3, Sample *wet, Bit32u numSamples, const Bit32u wetLevel) {
+	Bit32u i = 0;
+
+#if MT32EMU_USE_FLOAT_VECTORS
+	const FloatVector oneAndHalf = setFloatVector(1.5f);
+	const FloatVector level = setFloatVector((float)(Bit8u)wetLevel);
+	const FloatVector scale = setFloatVector(1.0f / 256.0f);
+	for (; i + FLOAT_VECTOR_SIZE <= numSamples; i += FLOAT_VECTOR_SIZE) {
+		const FloatVector sum = addFloatVectors(mulFloatVectors(oneAndHalf, addFloatVectors(loadFloatVector(out1 + i), loadFloatVector(out2 + i))), loadFloatVector(out3 + i));
+		storeFloatVector(wet + i, mulFloatVectors(mulFloatVectors(sum, level), scale));
+	}
+#endif
+
+	for (; i < numSamples; i++) {
+#if MT32EMU_USE_FLOAT_SAMPLES
+		Sample outSample = 1.5f * (out1[i] + out2[i]) + out3[i];
+#elif MT32EMU_BOSS_REVERB_PRECISE_MODE
+		/* NOTE:
+		 *   Thanks to Mok for discovering, the adder in BOSS reverb chip is found to perform addition with saturation to avoid integer overflow.
+		 *   Analysing of the algorithm suggests that the overflow is most probable when the combs output is added below.
+		 *   So, despite this isn't actually accurate, we only add the check here for performance reasons.
+		 */
+		Sample outSample = Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx((SampleEx)out1[i] + SampleEx(out1[i] >> 1)) + (SampleEx)out2[i]) + SampleEx(out2[i] >> 1)) + (SampleEx)out3[i]);
+#else
+		Sample outSample = Synth::clipSampleEx((SampleEx)out1[i] + SampleEx(out1[i] >> 1) + (SampleEx)out2[i] + SampleEx(out2[i] >> 1) + (SampleEx)out3[i]);
+#endif
+		wet[i] = weirdMul(outSample, wetLevel, 0xFF);
+	}
+}
+
+void BReverbModel::process(const Sample *inLeft, const Sample *inRight, Sample *outLeft, Sample *outRight, unsigned long numSamples) {
+	if (combs == NULL) {
+		Synth::muteSampleBuffer(outLeft, numSamples);
+		Synth::muteSampleBuffer(outRight, numSamples);
+		return;
+	}
+
+	Sample dry[MAX_RUN_LENGTH];
+	Sample link[MAX_RUN_LENGTH];
+	Sample outL1[MAX_RUN_LENGTH], outL2[MAX_RUN_LENGTH], outL3[MAX_RUN_LENGTH];
+	Sample outR1[MAX_RUN_LENGTH], outR2[MAX_RUN_LENGTH], outR3[MAX_RUN_LENGTH];
+
+	while (numSamples > 0) {
+		const Bit32u length = numSamples > MAX_RUN_LENGTH ? MAX_RUN_LENGTH : Bit32u(numSamples);
+
+		mixDryInput(inLeft, inRight, dry, length, tapDelayMode, dryAmp);
 
 		if (tapDelayMode) {
+			// The feedback is taken from the right output position, which may be within the same run, so process sample by sample
 			TapDelayCombFilter *comb = static_cast<TapDelayCombFilter *> (*combs);
-			comb->process(dry);
-			if (outLeft != NULL) {
-				*(outLeft++) = weirdMul(comb->getLeftOutput(), wetLevel, 0xFF);
-			}
-			if (outRight != NULL) {
-				*(outRight++) = weirdMul(comb->getRightOutput(), wetLevel, 0xFF);
+			for (Bit32u i = 0; i < length; i++) {
+				comb->process(dry[i]);
+				if (outLeft != NULL) {
+					outLeft[i] = weirdMul(comb->getLeftOutput(), wetLevel, 0xFF);
+				}
+				if (outRight != NULL) {
+					outRight[i] = weirdMul(comb->getRightOutput(), wetLevel, 0xFF);
+				}
 			}
 		} else {
-			// If the output position is equal to the comb size, get it now in order not to loose it
-			Sample link = combs[0]->getOutputAt(currentSettings.combSizes[0] - 1);
-
-			// Entrance LPF. Note, comb.process() differs a bit here.
-			combs[0]->process(dry);
+			// Entrance LPF. Note, it differs a bit from the comb filters.
+			static_cast<DelayWithLowPassFilter *> (combs[0])->process(dry, link, length);
 
 #if !MT32EMU_USE_FLOAT_SAMPLES
 			// This introduces reverb noise which actually makes output from the real Boss chip nondeterministic
-			link = link - 1;
+			for (Bit32u i = 0; i < length; i++) {
+				link[i] = link[i] - 1;
+			}
 #endif
-			link = allpasses[0]->process(link);
-			link = allpasses[1]->process(link);
-			link = allpasses[2]->process(link);
+			allpasses[0]->process(link, link, length);
+			allpasses[1]->process(link, link, length);
+			allpasses[2]->process(link, link, length);
 
-			// If the output position is equal to the comb size, get it now in order not to loose it
-			Sample outL1 = combs[1]->getOutputAt(currentSettings.outLPositions[0] - 1);
-
-			combs[1]->process(link);
-			combs[2]->process(link);
-			combs[3]->process(link);
+			// The first left output position is equal to the comb size, so it must be taken before the sample is overwritten.
+			// For the other positions, it makes no difference whether the outputs are taken before or after storing a sample.
+			combs[1]->process(link, length, currentSettings.outLPositions[0], outLeft != NULL ? outL1 : NULL, currentSettings.outRPositions[0], outRight != NULL ? outR1 : NULL);
+			combs[2]->process(link, length, currentSettings.outLPositions[1], outLeft != NULL ? outL2 : NULL, currentSettings.outRPositions[1], outRight != NULL ? outR2 : NULL);
+			combs[3]->process(link, length, currentSettings.outLPositions[2], outLeft != NULL ? outL3 : NULL, currentSettings.outRPositions[2], outRight != NULL ? outR3 : NULL);
 
 			if (outLeft != NULL) {
-				Sample outL2 = combs[2]->getOutputAt(currentSettings.outLPositions[1]);
-				Sample outL3 = combs[3]->getOutputAt(currentSettings.outLPositions[2]);
-#if MT32EMU_USE_FLOAT_SAMPLES
-				Sample outSample = 1.5f * (outL1 + outL2) + outL3;
-#elif MT32EMU_BOSS_REVERB_PRECISE_MODE
-				/* NOTE:
-				 *   Thanks to Mok for discovering, the adder in BOSS reverb chip is found to perform addition with saturation to avoid integer overflow.
-				 *   Analysing of the algorithm suggests that the overflow is most probable when the combs output is added below.
-				 *   So, despite this isn't actually accurate, we only add the check here for performance reasons.
-				 */
-				Sample outSample = Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx((SampleEx)outL1 + SampleEx(outL1 >> 1)) + (SampleEx)outL2) + SampleEx(outL2 >> 1)) + (SampleEx)outL3);
-#else
-				Sample outSample = Synth::clipSampleEx((SampleEx)outL1 + SampleEx(outL1 >> 1) + (SampleEx)outL2 + SampleEx(outL2 >> 1) + (SampleEx)outL3);
-#endif
-				*(outLeft++) = weirdMul(outSample, wetLevel, 0xFF);
+				mixCombOutputs(outL1, outL2, outL3, outLeft, length, wetLevel);
 			}
 			if (outRight != NULL) {
-				Sample outR1 = combs[1]->getOutputAt(currentSettings.outRPositions[0]);
-				Sample outR2 = combs[2]->getOutputAt(currentSettings.outRPositions[1]);
-				Sample outR3 = combs[3]->getOutputAt(currentSettings.outRPositions[2]);
-#if MT32EMU_USE_FLOAT_SAMPLES
-				Sample outSample = 1.5f * (outR1 + outR2) + outR3;
-#elif MT32EMU_BOSS_REVERB_PRECISE_MODE
-				// See the note above for the left channel output.
-				Sample outSample = Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx(Synth::clipSampleEx((SampleEx)outR1 + SampleEx(outR1 >> 1)) + (SampleEx)outR2) + SampleEx(outR2 >> 1)) + (SampleEx)outR3);
-#else
-				Sample outSample = Synth::clipSampleEx((SampleEx)outR1 + SampleEx(outR1 >> 1) + (SampleEx)outR2 + SampleEx(outR2 >> 1) + (SampleEx)outR3);
-#endif
-				*(outRight++) = weirdMul(outSample, wetLevel, 0xFF);
+				mixCombOutputs(outR1, outR2, outR3, outRight, length, wetLevel);
 			}
 		}
+
+		inLeft += length;
+		inRight += length;
+		if (outLeft != NULL) {
+			outLeft += length;
+		}
+		if (outRight != NULL) {
+			outRight += length;
+		}
+		numSamples -= length;
 	}
 }
 
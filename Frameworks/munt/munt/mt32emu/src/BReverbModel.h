@@ -44,6 +44,9 @@ public:
 	RingBuffer(const Bit32u size);
 	virtual ~RingBuffer();
 	Sample next();
+	// Moves the index over up to length samples, stopping where the buffer wraps around.
+	// Returns the index of the first sample, length is updated to the number of samples moved over.
+	Bit32u advance(Bit32u &length);
 	bool isEmpty() const;
 	void mute();
 };
@@ -51,7 +54,8 @@ public:
 class AllpassFilter : public RingBuffer {
 public:
 	AllpassFilter(const Bit32u size);
-	Sample process(const Sample in);
+	// in and out may point to the same buffer
+	void process(const Sample *in, Sample *out, Bit32u numSamples);
 };
 
 class CombFilter : public RingBuffer {
@@ -62,6 +66,9 @@ protected:
 public:
 	CombFilter(const Bit32u size, const Bit32u useFilterFactor);
 	virtual void process(const Sample in);
+	// Processes a run of samples. Before each sample is stored, the samples stored outLPosition and outRPosition samples ago
+	// are written to outLeft and outRight, unless those are NULL.
+	void process(const Sample *in, Bit32u numSamples, const Bit32u outLPosition, Sample *outLeft, const Bit32u outRPosition, Sample *outRight);
 	Sample getOutputAt(const Bit32u outIndex) const;
 	void setFeedbackFactor(const Bit32u useFeedbackFactor);
 };
@@ -72,6 +79,8 @@ class DelayWithLowPassFilter : public CombFilter {
 public:
 	DelayWithLowPassFilter(const Bit32u useSize, const Bit32u useFilterFactor, const Bit32u useAmp);
 	void process(const Sample in);
+	// Writes the delayed samples to out before they are overwritten
+	void process(const Sample *in, Sample *out, Bit32u numSamples);
 	void setFeedbackFactor(const Bit32u) {}
 };
 
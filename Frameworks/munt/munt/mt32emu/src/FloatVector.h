@@ -0,0 +1,168 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011, 2012, 2013, 2014 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_FLOAT_VECTOR_H
+#define MT32EMU_FLOAT_VECTOR_H
+
+// Minimal wrappers over the SSE and NEON instructions used to process float sample buffers four samples at a time.
+// Each wrapper is exact. Code using them to replace scalar code keeps the same float operations in the same order, so the output
+// does not change, unless it says otherwise (like the vector partial renderer, which approximates the transcendental functions).
+// MT32EMU_USE_FLOAT_VECTORS is 0 if neither instruction set is available or the integer renderer is in use.
+
+#if MT32EMU_USE_FLOAT_SAMPLES && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MT32EMU_USE_FLOAT_VECTORS 1
+#include <emmintrin.h>
+#elif MT32EMU_USE_FLOAT_SAMPLES && defined(__ARM_NEON) && defined(__aarch64__)
+#define MT32EMU_USE_FLOAT_VECTORS 1
+#include <arm_neon.h>
+#else
+#define MT32EMU_USE_FLOAT_VECTORS 0
+#endif
+
+#if MT32EMU_USE_FLOAT_VECTORS
+
+namespace MT32Emu {
+
+static const unsigned int FLOAT_VECTOR_SIZE = 4;
+
+#if defined(__aarch64__)
+
+typedef float32x4_t FloatVector;
+typedef uint32x4_t FloatVectorMask;
+
+static inline FloatVector loadFloatVector(const float *src) {
+	return vld1q_f32(src);
+}
+
+static inline void storeFloatVector(float *dst, const FloatVector v) {
+	vst1q_f32(dst, v);
+}
+
+static inline FloatVector setFloatVector(const float value) {
+	return vdupq_n_f32(value);
+}
+
+static inline FloatVector addFloatVectors(const FloatVector a, const FloatVector b) {
+	return vaddq_f32(a, b);
+}
+
+static inline FloatVector subFloatVectors(const FloatVector a, const FloatVector b) {
+	return vsubq_f32(a, b);
+}
+
+static inline FloatVector mulFloatVectors(const FloatVector a, const FloatVector b) {
+	return vmulq_f32(a, b);
+}
+
+static inline FloatVector divFloatVectors(const FloatVector a, const FloatVector b) {
+	return vdivq_f32(a, b);
+}
+
+static inline FloatVector minFloatVectors(const FloatVector a, const FloatVector b) {
+	return vminq_f32(a, b);
+}
+
+static inline FloatVector maxFloatVectors(const FloatVector a, const FloatVector b) {
+	return vmaxq_f32(a, b);
+}
+
+static inline FloatVector floorFloatVector(const FloatVector v) {
+	return vrndmq_f32(v);
+}
+
+// Multiplies v by 2 to the power of n, which must be a whole number that keeps the result normal
+static inline FloatVector ldexpFloatVector(const FloatVector v, const FloatVector n) {
+	return vreinterpretq_f32_s32(vaddq_s32(vreinterpretq_s32_f32(v), vshlq_n_s32(vcvtq_s32_f32(n), 23)));
+}
+
+static inline FloatVectorMask lessFloatVectors(const FloatVector a, const FloatVector b) {
+	return vcltq_f32(a, b);
+}
+
+// Takes a where the mask is set and b elsewhere
+static inline FloatVector selectFloatVectors(const FloatVectorMask mask, const FloatVector a, const FloatVector b) {
+	return vbslq_f32(mask, a, b);
+}
+
+#else
+
+typedef __m128 FloatVector;
+typedef __m128 FloatVectorMask;
+
+static inline FloatVector loadFloatVector(const float *src) {
+	return _mm_loadu_ps(src);
+}
+
+static inline void storeFloatVector(float *dst, const FloatVector v) {
+	_mm_storeu_ps(dst, v);
+}
+
+static inline FloatVector setFloatVector(const float value) {
+	return _mm_set1_ps(value);
+}
+
+static inline FloatVector addFloatVectors(const FloatVector a, const FloatVector b) {
+	return _mm_add_ps(a, b);
+}
+
+static inline FloatVector subFloatVectors(const FloatVector a, const FloatVector b) {
+	return _mm_sub_ps(a, b);
+}
+
+static inline FloatVector mulFloatVectors(const FloatVector a, const FloatVector b) {
+	return _mm_mul_ps(a, b);
+}
+
+static inline FloatVector divFloatVectors(const FloatVector a, const FloatVector b) {
+	return _mm_div_ps(a, b);
+}
+
+static inline FloatVector minFloatVectors(const FloatVector a, const FloatVector b) {
+	return _mm_min_ps(a, b);
+}
+
+static inline FloatVector maxFloatVectors(const FloatVector a, const FloatVector b) {
+	return _mm_max_ps(a, b);
+}
+
+// SSE2 has no rounding to minus infinity, so truncate and step down where that went up. v must fit into 32-bit integers.
+static inline FloatVector floorFloatVector(const FloatVector v) {
+	const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+	return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, v), _mm_set1_ps(1.0f)));
+}
+
+// Multiplies v by 2 to the power of n, which must be a whole number that keeps the result normal
+static inline FloatVector ldexpFloatVector(const FloatVector v, const FloatVector n) {
+	return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(v), _mm_slli_epi32(_mm_cvttps_epi32(n), 23)));
+}
+
+static inline FloatVectorMask lessFloatVectors(const FloatVector a, const FloatVector b) {
+	return _mm_cmplt_ps(a, b);
+}
+
+// Takes a where the mask is set and b elsewhere
+static inline FloatVector selectFloatVectors(const FloatVectorMask mask, const FloatVector a, const FloatVector b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+#endif
+
+}
+
+#endif // #if MT32EMU_USE_FLOAT_VECTORS
+
+#endif
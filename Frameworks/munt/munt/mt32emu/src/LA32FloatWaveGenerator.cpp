@@ -324,9 +324,9 @@ static inline float produceDistortedSample(float sample) {
 	return sample;
 }
 
-float LA32PartialPair::nextOutSample() {
+static inline float produceOutSample(const float masterSample, const float slaveSample, const bool ringModulated, const bool mixed) {
 	if (!ringModulated) {
-		return masterOutputSample + slaveOutputSample;
+		return masterSample + slaveSample;
 	}
 	/*
 	 * SEMI-CONFIRMED: Ring modulation model derived from sample analysis of specially constructed patches which exploit distortion.
@@ -336,17 +336,27 @@ float LA32PartialPair::nextOutSample() {
 	 * it is reasonable to assume the ring modulation is performed also in the linear space by sample multiplication.
 	 * Most probably the overflow is caused by limited precision of the multiplication circuit as the very similar distortion occurs with panning.
 	 */
-	float ringModulatedSample = produceDistortedSample(masterOutputSample) * produceDistortedSample(slaveOutputSample);
-	return mixed ? masterOutputSample + ringModulatedSample : ringModulatedSample;
+	float ringModulatedSample = produceDistortedSample(masterSample) * produceDistortedSample(slaveSample);
+	return mixed ? masterSample + ringModulatedSample : ringModulatedSample;
+}
+
+float LA32PartialPair::nextOutSample() {
+	return produceOutSample(masterOutputSample, slaveOutputSample, ringModulated, mixed);
 }
 
 void LA32PartialPair::deactivate(const PairType useMaster) {
 	if (useMaster == MASTER) {
 		master.deactivate();
 		masterOutputSample = 0.0f;
+#if MT32EMU_USE_FLOAT_VECTORS
+		master.truncateRun(runLength);
+#endif
 	} else {
 		slave.deactivate();
 		slaveOutputSample = 0.0f;
+#if MT32EMU_USE_FLOAT_VECTORS
+		slave.truncateRun(runLength);
+#endif
 	}
 }
 
@@ -354,4 +364,215 @@ bool LA32PartialPair::isActive(const PairType useMaster) const {
 	return useMaster == MASTER ? master.isActive() : slave.isActive();
 }
 
+#if MT32EMU_USE_FLOAT_VECTORS
+
+// The vector renderer computes the synth waveforms four samples at a time with the approximations below,
+// which are within a few float ulps of the library functions the scalar code uses.
+
+// EXP2F() for x in [-125, 127], x is clamped to that range
+static inline FloatVector exp2FloatVector(FloatVector x) {
+	x = maxFloatVectors(minFloatVectors(x, setFloatVector(127.0f)), setFloatVector(-125.0f));
+	const FloatVector n = floorFloatVector(addFloatVectors(x, setFloatVector(0.5f)));
+	const FloatVector f = mulFloatVectors(subFloatVectors(x, n), setFloatVector(FLOAT_LN_2));
+
+	// e^f by Taylor series up to f^7, |f| <= ln(2) / 2
+	FloatVector y = setFloatVector(1.0f / 5040.0f);
+	y = addFloatVectors(mulFloatVectors(y, f), setFloatVector(1.0f / 720.0f));
+	y = addFloatVectors(mulFloatVectors(y, f), setFloatVector(1.0f / 120.0f));
+	y = addFloatVectors(mulFloatVectors(y, f), setFloatVector(1.0f / 24.0f));
+	y = addFloatVectors(mulFloatVectors(y, f), setFloatVector(1.0f / 6.0f));
+	y = addFloatVectors(mulFloatVectors(y, f), setFloatVector(0.5f));
+	y = addFloatVectors(mulFloatVectors(y, f), setFloatVector(1.0f));
+	y = addFloatVectors(mulFloatVectors(y, f), setFloatVector(1.0f));
+	return ldexpFloatVector(y, n);
+}
+
+// cos(FLOAT_PI * x)
+static inline FloatVector cosPiFloatVector(const FloatVector x) {
+	// Fold x into [-1, 1], then into a = |x| in [0, 1] and b in [0, 0.5] with cos(PI * a) = +-cos(PI * b)
+	const FloatVector r = subFloatVectors(x, mulFloatVectors(setFloatVector(2.0f), floorFloatVector(addFloatVectors(mulFloatVectors(x, setFloatVector(0.5f)), setFloatVector(0.5f)))));
+	const FloatVector a = maxFloatVectors(r, subFloatVectors(setFloatVector(0.0f), r));
+	const FloatVector b = minFloatVectors(a, subFloatVectors(setFloatVector(1.0f), a));
+	const FloatVector t = mulFloatVectors(b, setFloatVector(FLOAT_PI));
+	const FloatVector t2 = mulFloatVectors(t, t);
+
+	// Taylor series up to t^12, |t| <= PI / 2
+	FloatVector y = setFloatVector(1.0f / 479001600.0f);
+	y = addFloatVectors(mulFloatVectors(y, t2), setFloatVector(-1.0f / 3628800.0f));
+	y = addFloatVectors(mulFloatVectors(y, t2), setFloatVector(1.0f / 40320.0f));
+	y = addFloatVectors(mulFloatVectors(y, t2), setFloatVector(-1.0f / 720.0f));
+	y = addFloatVectors(mulFloatVectors(y, t2), setFloatVector(1.0f / 24.0f));
+	y = addFloatVectors(mulFloatVectors(y, t2), setFloatVector(-0.5f));
+	y = addFloatVectors(mulFloatVectors(y, t2), setFloatVector(1.0f));
+	return selectFloatVectors(lessFloatVectors(setFloatVector(0.5f), a), subFloatVectors(setFloatVector(0.0f), y), y);
+}
+
+// sin(FLOAT_PI * x)
+static inline FloatVector sinPiFloatVector(const FloatVector x) {
+	return cosPiFloatVector(subFloatVectors(x, setFloatVector(0.5f)));
+}
+
+void LA32WaveGenerator::startRun(LA32WaveRun *useRun) {
+	run = useRun;
+	runLength = 0;
+}
+
+void LA32WaveGenerator::recordNextSample(const Bit32u ampVal, const Bit16u pitch, const Bit32u cutoffRampVal) {
+	if (!active) {
+		return;
+	}
+	if (isPCMWave()) {
+		run->sample[runLength++] = generateNextSample(ampVal, pitch, cutoffRampVal);
+		return;
+	}
+	this->pitch = pitch;
+	run->ampExp[runLength] = ampVal / -1024.0f / 4096.0f;
+	run->freqExp[runLength] = pitch / 4096.0f - 16.0f;
+	run->cutoffVal[runLength] = cutoffRampVal / 262144.0f;
+	runLength++;
+}
+
+void LA32WaveGenerator::truncateRun(const unsigned int length) {
+	if (runLength > length) {
+		runLength = length;
+	}
+}
+
+const float *LA32WaveGenerator::generateRun(const unsigned int length) {
+	if (runLength > 0 && !isPCMWave()) {
+		generateSynthRun();
+	}
+	for (unsigned int i = runLength; i < length; i++) {
+		run->sample[i] = 0.0f;
+	}
+	return run->sample;
+}
+
+// The same computation as the synth waveform branch of generateNextSample(), with every branch taken and the results selected
+void LA32WaveGenerator::generateSynthRun() {
+	// Pad to whole vectors with harmless values, the samples past runLength are overwritten by generateRun()
+	const unsigned int vectorRunLength = (runLength + FLOAT_VECTOR_SIZE - 1) & ~(FLOAT_VECTOR_SIZE - 1);
+	for (unsigned int i = runLength; i < vectorRunLength; i++) {
+		run->ampExp[i] = 0.0f;
+		run->cutoffVal[i] = 0.0f;
+		run->wavePos[i] = 0.0f;
+		run->waveLen[i] = 1.0f;
+	}
+
+	// Each wave position depends on the previous one, so these are done in turn, exactly as generateNextSample() does.
+	// The pitch rarely changes from one sample to the next, so the frequency is only worked out again when it does.
+	float freq = 0.0f;
+	for (unsigned int i = 0; i < runLength; i++) {
+		if (i == 0 || run->freqExp[i] != run->freqExp[i - 1]) {
+			freq = EXP2F(run->freqExp[i]) * SAMPLE_RATE;
+		}
+		wavePos *= lastFreq / freq;
+		lastFreq = freq;
+		float waveLen = SAMPLE_RATE / freq;
+		run->wavePos[i] = wavePos;
+		run->waveLen[i] = waveLen;
+		wavePos++;
+		if (wavePos > waveLen) {
+			wavePos -= waveLen;
+		}
+	}
+
+	// Constant over the run
+	const float resAmp = EXP2F(1.0f - (32 - resonance) / 4.0f);
+	const float pulseLenFactor = pulseWidth > 128 ? EXP2F((64 - pulseWidth) / 64.0f) : 0.5f;
+	const float resAmpDecayFactor = Tables::getInstance().resAmpDecayFactor[resonance >> 2];
+
+	const FloatVector zero = setFloatVector(0.0f);
+	const FloatVector half = setFloatVector(0.5f);
+	const FloatVector one = setFloatVector(1.0f);
+	const FloatVector middleCutoff = setFloatVector(MIDDLE_CUTOFF_VALUE);
+
+	for (unsigned int i = 0; i < vectorRunLength; i += FLOAT_VECTOR_SIZE) {
+		const FloatVector wavePos = loadFloatVector(run->wavePos + i);
+		const FloatVector waveLen = loadFloatVector(run->waveLen + i);
+		const FloatVector cutoffVal = minFloatVectors(loadFloatVector(run->cutoffVal + i), setFloatVector(MAX_CUTOFF_VALUE));
+		const FloatVectorMask belowMiddleCutoff = lessFloatVectors(cutoffVal, middleCutoff);
+
+		// Above the middle cutoff, the exponent is negative and the cosines get shorter
+		const FloatVector cosineLenFactor = exp2FloatVector(divFloatVectors(subFloatVectors(maxFloatVectors(cutoffVal, middleCutoff), middleCutoff), setFloatVector(-16.0f)));
+		const FloatVector cosineLen = mulFloatVectors(mulFloatVectors(half, waveLen), cosineLenFactor);
+		const FloatVector halfCosineLen = mulFloatVectors(half, cosineLen);
+
+		FloatVector relWavePos = addFloatVectors(wavePos, halfCosineLen);
+		relWavePos = selectFloatVectors(lessFloatVectors(waveLen, relWavePos), subFloatVectors(relWavePos, waveLen), relWavePos);
+
+		const FloatVector hLen = maxFloatVectors(subFloatVectors(mulFloatVectors(setFloatVector(pulseLenFactor), waveLen), cosineLen), zero);
+		const FloatVector cosineAndHighLen = addFloatVectors(cosineLen, hLen);
+
+		// Square wave with cosine slopes, -cos(PI * x) is taken as cos(PI * (x + 1))
+		const FloatVectorMask inFirstCosine = lessFloatVectors(relWavePos, cosineLen);
+		const FloatVector cosinePos = selectFloatVectors(inFirstCosine, addFloatVectors(divFloatVectors(relWavePos, cosineLen), one), divFloatVectors(subFloatVectors(relWavePos, cosineAndHighLen), cosineLen));
+		const FloatVector cosine = cosPiFloatVector(cosinePos);
+		FloatVector sample = selectFloatVectors(lessFloatVectors(relWavePos, addFloatVectors(cosineLen, cosineAndHighLen)), cosine, setFloatVector(-1.0f));
+		sample = selectFloatVectors(lessFloatVectors(relWavePos, cosineAndHighLen), one, sample);
+		sample = selectFloatVectors(inFirstCosine, cosine, sample);
+
+		// Resonance sine, for the middle cutoff and above
+		const FloatVector resAmpCorrection = sinPiFloatVector(divFloatVectors(subFloatVectors(cutoffVal, middleCutoff), setFloatVector(32.0f)));
+		const FloatVector correctedResAmp = selectFloatVectors(lessFloatVectors(cutoffVal, setFloatVector(RESONANCE_DECAY_THRESHOLD_CUTOFF_VALUE)), mulFloatVectors(setFloatVector(resAmp), resAmpCorrection), setFloatVector(resAmp));
+
+		const FloatVectorMask positiveSegment = lessFloatVectors(wavePos, cosineAndHighLen);
+		const FloatVector resWavePos = selectFloatVectors(positiveSegment, wavePos, subFloatVectors(wavePos, cosineAndHighLen));
+		const FloatVector resSine = sinPiFloatVector(divFloatVectors(resWavePos, cosineLen));
+		const FloatVector resSample = selectFloatVectors(positiveSegment, resSine, subFloatVectors(zero, resSine));
+		const FloatVector decayFactor = selectFloatVectors(positiveSegment, setFloatVector(resAmpDecayFactor), setFloatVector(resAmpDecayFactor + 0.25f));
+		const FloatVector resAmpFadeExp = mulFloatVectors(mulFloatVectors(setFloatVector(-0.125f), decayFactor), divFloatVectors(resWavePos, cosineLen));
+
+		// Below the middle cutoff, the square wave is attenuated instead. Only one of the two exponentials is needed.
+		const FloatVector attenuationExp = mulFloatVectors(setFloatVector(-0.125f), subFloatVectors(middleCutoff, cutoffVal));
+		const FloatVector exponential = exp2FloatVector(selectFloatVectors(belowMiddleCutoff, attenuationExp, resAmpFadeExp));
+
+		// Windows at the beginning and the ending of the resonance sine segment
+		FloatVector windowPos = selectFloatVectors(lessFloatVectors(wavePos, addFloatVectors(hLen, halfCosineLen)), wavePos, subFloatVectors(wavePos, cosineAndHighLen));
+		windowPos = selectFloatVectors(lessFloatVectors(wavePos, subFloatVectors(waveLen, halfCosineLen)), windowPos, subFloatVectors(wavePos, waveLen));
+		const FloatVector syncSine = sinPiFloatVector(divFloatVectors(windowPos, cosineLen));
+		FloatVector window = selectFloatVectors(lessFloatVectors(windowPos, zero), mulFloatVectors(syncSine, syncSine), syncSine);
+		window = selectFloatVectors(lessFloatVectors(windowPos, halfCosineLen), window, one);
+
+		const FloatVector resonantSample = addFloatVectors(sample, mulFloatVectors(mulFloatVectors(resSample, correctedResAmp), mulFloatVectors(exponential, window)));
+		sample = selectFloatVectors(belowMiddleCutoff, mulFloatVectors(sample, exponential), resonantSample);
+
+		if (sawtoothWaveform) {
+			sample = mulFloatVectors(sample, cosPiFloatVector(divFloatVectors(mulFloatVectors(setFloatVector(2.0f), wavePos), waveLen)));
+		}
+
+		// Multiply sample with current TVA value
+		sample = mulFloatVectors(sample, exp2FloatVector(loadFloatVector(run->ampExp + i)));
+		storeFloatVector(run->sample + i, sample);
+	}
+}
+
+void LA32PartialPair::startRun(LA32WaveRun *masterRun, LA32WaveRun *slaveRun) {
+	master.startRun(masterRun);
+	slave.startRun(slaveRun);
+	runLength = 0;
+}
+
+void LA32PartialPair::recordNextSample(const PairType useMaster, const Bit32u amp, const Bit16u pitch, const Bit32u cutoff) {
+	if (useMaster == MASTER) {
+		master.recordNextSample(amp, pitch, cutoff);
+	} else {
+		slave.recordNextSample(amp, pitch, cutoff);
+	}
+}
+
+void LA32PartialPair::recordNextOutSample() {
+	runLength++;
+}
+
+void LA32PartialPair::generateRun(float *buf) {
+	const float *masterSamples = master.generateRun(runLength);
+	const float *slaveSamples = slave.generateRun(runLength);
+	for (unsigned int i = 0; i < runLength; i++) {
+		buf[i] = produceOutSample(masterSamples[i], slaveSamples[i], ringModulated, mixed);
+	}
+}
+
+#endif // #if MT32EMU_USE_FLOAT_VECTORS
+
 }
@@ -20,6 +20,25 @@
 
 namespace MT32Emu {
 
+#if MT32EMU_USE_FLOAT_VECTORS
+// Values recorded by the vector renderer for a run of one wave generator, one entry per sample
+struct LA32WaveRun {
+	static const unsigned int LENGTH = 256;
+
+	// Exponents passed to EXP2F() for the amp and the frequency, and the cutoff, as worked out by generateNextSample()
+	float ampExp[LENGTH];
+	float freqExp[LENGTH];
+	float cutoffVal[LENGTH];
+
+	// Position within the wave and wave length of each synth sample, in samples
+	float wavePos[LENGTH];
+	float waveLen[LENGTH];
+
+	// Generated samples
+	float sample[LENGTH];
+};
+#endif
+
 /**
  * LA32WaveGenerator is aimed to represent the exact model of LA32 wave generator.
  * The output square wave is created by adding high / low linear segments in-between
@@ -76,6 +95,13 @@ class LA32WaveGenerator {
 	float lastFreq;
 	float pcmPosition;
 
+#if MT32EMU_USE_FLOAT_VECTORS
+	LA32WaveRun *run;
+	unsigned int runLength;
+
+	void generateSynthRun();
+#endif
+
 	float getPCMSample(unsigned int position);
 
 public:
@@ -96,6 +122,19 @@ public:
 
 	// Return true if the WG engine generates PCM wave samples
 	bool isPCMWave() const;
+
+#if MT32EMU_USE_FLOAT_VECTORS
+	// Used by the vector renderer in place of generateNextSample(). Parameters are updated the same way, but synth samples are only
+	// recorded into the run, to be computed all at once by generateRun(). PCM samples are generated straight away.
+	void startRun(LA32WaveRun *run);
+	void recordNextSample(const Bit32u amp, const Bit16u pitch, const Bit32u cutoff);
+
+	// Drop the recorded samples from position length onwards
+	void truncateRun(const unsigned int length);
+
+	// Compute the recorded samples and return the run, silent past the recorded samples up to length
+	const float *generateRun(const unsigned int length);
+#endif
 };
 
 // LA32PartialPair contains a structure of two partials being mixed / ring modulated
@@ -107,6 +146,11 @@ class LA32PartialPair {
 	float masterOutputSample;
 	float slaveOutputSample;
 
+#if MT32EMU_USE_FLOAT_VECTORS
+	// Number of samples recorded in the current run of the vector renderer
+	unsigned int runLength;
+#endif
+
 public:
 	enum PairType {
 		MASTER,
@@ -135,6 +179,15 @@ public:
 
 	// Return active state of the WG engine
 	bool isActive(const PairType master) const;
+
+#if MT32EMU_USE_FLOAT_VECTORS
+	// Counterparts of generateNextSample() and nextOutSample() for the vector renderer. The samples are recorded
+	// for a run of up to LA32WaveRun::LENGTH samples, then generateRun() computes them and mixes / ring modulates the run into buf.
+	void startRun(LA32WaveRun *masterRun, LA32WaveRun *slaveRun);
+	void recordNextSample(const PairType master, const Bit32u amp, const Bit16u pitch, const Bit32u cutoff);
+	void recordNextOutSample();
+	void generateRun(float *buf);
+#endif
 };
 
 } // namespace MT32Emu
@@ -22,12 +22,35 @@
 #include "mt32emu.h"
 #include "mmath.h"
 #include "internals.h"
+#include "FloatVector.h"
 
 namespace MT32Emu {
 
 static const Bit8u PAN_NUMERATOR_MASTER[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7};
 static const Bit8u PAN_NUMERATOR_SLAVE[]  = {0, 1, 2, 3, 4, 5, 6, 7, 7, 7, 7, 7, 7, 7, 7};
 
+#if MT32EMU_USE_FLOAT_SAMPLES
+static void mixPannedSamples(const Sample *partialBuf, Sample *leftBuf, Sample *rightBuf, unsigned long length, const float leftPan, const float rightPan) {
+	unsigned long i = 0;
+
+#if MT32EMU_USE_FLOAT_VECTORS
+	const FloatVector leftPanVector = setFloatVector(leftPan);
+	const FloatVector rightPanVector = setFloatVector(rightPan);
+	const FloatVector divisor = setFloatVector(14.0f);
+	for (; i + FLOAT_VECTOR_SIZE <= length; i += FLOAT_VECTOR_SIZE) {
+		const FloatVector sample = loadFloatVector(partialBuf + i);
+		storeFloatVector(leftBuf + i, addFloatVectors(loadFloatVector(leftBuf + i), divFloatVectors(mulFloatVectors(sample, leftPanVector), divisor)));
+		storeFloatVector(rightBuf + i, addFloatVectors(loadFloatVector(rightBuf + i), divFloatVectors(mulFloatVectors(sample, rightPanVector), divisor)));
+	}
+#endif
+
+	for (; i < length; i++) {
+		leftBuf[i] += (partialBuf[i] * leftPan) / 14.0f;
+		rightBuf[i] += (partialBuf[i] * rightPan) / 14.0f;
+	}
+}
+#endif
+
 static const Bit32s PAN_FACTORS[] = {0, 18, 37, 55, 73, 91, 110, 128, 146, 165, 183, 201, 219, 238, 256};
 
 Partial::Partial(Synth *useSynth, int useDebugPartialNum) :
@@ -276,6 +299,20 @@ bool Partial::produceOutput(Sample *leftBuf, Sample *rightBuf, unsigned long len
 	}
 	alreadyOutputed = true;
 
+#if MT32EMU_USE_FLOAT_SAMPLES
+	// The samples are panned and mixed into the output buffers once the run is complete.
+	// Runs never exceed MAX_SAMPLES_PER_RUN samples.
+	Sample partialBuf[MAX_SAMPLES_PER_RUN];
+#endif
+
+#if MT32EMU_USE_FLOAT_VECTORS
+	if (synth->partialRenderer == PartialRenderer_VECTOR) {
+		mixPannedSamples(partialBuf, leftBuf, rightBuf, generateRuns(partialBuf, length), (float)leftPanValue, (float)rightPanValue);
+		sampleNum = 0;
+		return true;
+	}
+#endif
+
 	for (sampleNum = 0; sampleNum < length; sampleNum++) {
 		if (!tva->isPlaying() || !la32Pair.isActive(LA32PartialPair::MASTER)) {
 			deactivate();
@@ -299,10 +336,7 @@ bool Partial::produceOutput(Sample *leftBuf, Sample *rightBuf, unsigned long len
 
 		// FIXME: Sample analysis suggests that the use of panVal is linear, but there are some quirks that still need to be resolved.
 #if MT32EMU_USE_FLOAT_SAMPLES
-		Sample leftOut = (sample * (float)leftPanValue) / 14.0f;
-		Sample rightOut = (sample * (float)rightPanValue) / 14.0f;
-		*(leftBuf++) += leftOut;
-		*(rightBuf++) += rightOut;
+		partialBuf[sampleNum] = sample;
 #else
 		// FIXME: Dividing by 7 (or by 14 in a Mok-friendly way) looks of course pointless. Need clarification.
 		// FIXME2: LA32 may produce distorted sound in case if the absolute value of maximal amplitude of the input exceeds 8191
@@ -319,10 +353,55 @@ bool Partial::produceOutput(Sample *leftBuf, Sample *rightBuf, unsigned long len
 		rightBuf++;
 #endif
 	}
+#if MT32EMU_USE_FLOAT_SAMPLES
+	mixPannedSamples(partialBuf, leftBuf, rightBuf, sampleNum, (float)leftPanValue, (float)rightPanValue);
+#endif
 	sampleNum = 0;
 	return true;
 }
 
+#if MT32EMU_USE_FLOAT_VECTORS
+// Same as the sample loop in produceOutput(), but the LA32 pair only records the samples and generates them a run at a time.
+// The envelopes, pitch and PCM waves still advance sample by sample in the same order, so partials end on the same sample.
+// Returns the number of samples generated.
+unsigned long Partial::generateRuns(Sample *partialBuf, unsigned long length) {
+	LA32WaveRun masterRun, slaveRun;
+	unsigned long runStart = 0;
+	bool playing = true;
+	sampleNum = 0;
+	while (playing && sampleNum < length) {
+		unsigned long runEnd = runStart + LA32WaveRun::LENGTH;
+		if (runEnd > length) {
+			runEnd = length;
+		}
+		la32Pair.startRun(&masterRun, &slaveRun);
+		for (; sampleNum < runEnd; sampleNum++) {
+			if (!tva->isPlaying() || !la32Pair.isActive(LA32PartialPair::MASTER)) {
+				deactivate();
+				playing = false;
+				break;
+			}
+			la32Pair.recordNextSample(LA32PartialPair::MASTER, getAmpValue(), tvp->nextPitch(), getCutoffValue());
+			if (hasRingModulatingSlave()) {
+				la32Pair.recordNextSample(LA32PartialPair::SLAVE, pair->getAmpValue(), pair->tvp->nextPitch(), pair->getCutoffValue());
+				if (!pair->tva->isPlaying() || !la32Pair.isActive(LA32PartialPair::SLAVE)) {
+					pair->deactivate();
+					if (mixType == 2) {
+						deactivate();
+						playing = false;
+						break;
+					}
+				}
+			}
+			la32Pair.recordNextOutSample();
+		}
+		la32Pair.generateRun(partialBuf + runStart);
+		runStart = sampleNum;
+	}
+	return sampleNum;
+}
+#endif
+
 bool Partial::shouldReverb() {
 	if (!isActive()) {
 		return false;
@@ -70,6 +70,10 @@ private:
 	Bit32u getAmpValue();
 	Bit32u getCutoffValue();
 
+#if MT32EMU_USE_FLOAT_VECTORS
+	unsigned long generateRuns(Sample *partialBuf, unsigned long length);
+#endif
+
 public:
 	bool alreadyOutputed;
 
@@ -88,6 +88,7 @@ Synth::Synth(ReportHandler *useReportHandler) : mt32ram(*new MemParams()), mt32d
 	analog = NULL;
 	setDACInputMode(DACInputMode_NICE);
 	setMIDIDelayMode(MIDIDelayMode_DELAY_SHORT_MESSAGES_ONLY);
+	setPartialRenderer(PartialRenderer_SCALAR);
 	setOutputGain(1.0f);
 	setReverbOutputGain(1.0f);
 	setReversedStereoEnabled(false);
@@ -210,6 +211,18 @@ MIDIDelayMode Synth::getMIDIDelayMode() const {
 	return midiDelayMode;
 }
 
+void Synth::setPartialRenderer(PartialRenderer renderer) {
+#if !MT32EMU_USE_FLOAT_VECTORS
+	// Without float vectors, there's only the scalar renderer
+	renderer = PartialRenderer_SCALAR;
+#endif
+	partialRenderer = renderer;
+}
+
+PartialRenderer Synth::getPartialRenderer() const {
+	return partialRenderer;
+}
+
 void Synth::setOutputGain(float newOutputGain) {
 	if (newOutputGain < 0.0f) newOutputGain = -newOutputGain;
 	outputGain = newOutputGain;
@@ -73,6 +73,7 @@
 #include "Tables.h"
 #include "Poly.h"
 #include "LA32Ramp.h"
+#include "FloatVector.h"
 #include "LA32WaveGenerator.h"
 #include "TVA.h"
 #include "TVP.h"
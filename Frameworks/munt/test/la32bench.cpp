@@ -0,0 +1,61 @@
+/*
+ * la32bench: times the scalar and vector partial renderers on the same
+ * random partial pairs, in calls of MAX_SAMPLES_PER_RUN samples.
+ *
+ * usage: la32bench [pairs] [synth | all]
+ *
+ * With synth, both partials of every pair are synth waves; by default some
+ * are PCM, which the vector renderer still generates a sample at a time.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "la32setup.h"
+
+static const unsigned long LENGTH = 10 * MT32Emu::SAMPLE_RATE;
+
+static double render(int pairs, bool synthOnly, bool vector, float *buf, unsigned long &samples) {
+	clock_t start = clock();
+	samples = 0;
+	for (int p = 0; p < pairs; p++) {
+		LA32PairSetup setup;
+		makeLA32PairSetup(setup, p + 1, LENGTH, synthOnly);
+		// Long notes, the cost of a pair that ends early says little
+		setup.stop[0] = setup.stop[1] = LENGTH;
+		samples += renderLA32Pair(setup, buf, LENGTH, MT32Emu::MAX_SAMPLES_PER_RUN, vector);
+	}
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv) {
+	int pairs = argc > 1 ? atoi(argv[1]) : 40;
+	bool synthOnly = argc > 2 && strcmp(argv[2], "synth") == 0;
+	float *buf = new float[LENGTH];
+	unsigned long samples;
+
+#if !MT32EMU_USE_FLOAT_VECTORS
+	printf("no vector renderer on this host\n");
+	return 1;
+#endif
+
+	MT32Emu::Tables::getInstance();
+
+	// Twice each way, alternating, as the first pass warms up
+	double scalar = 0.0, vector = 0.0;
+	for (int pass = 0; pass < 2; pass++) {
+		scalar = render(pairs, synthOnly, false, buf, samples);
+		vector = render(pairs, synthOnly, true, buf, samples);
+	}
+
+	double seconds = double(samples) / MT32Emu::SAMPLE_RATE;
+	printf("%d %s pairs, %.0f s of partial output\n", pairs, synthOnly ? "synth" : "synth and PCM", seconds);
+	printf("scalar: %.3f s, %.0fx realtime\n", scalar, seconds / scalar);
+	printf("vector: %.3f s, %.0fx realtime\n", vector, seconds / vector);
+	printf("vector / scalar: %.2f\n", vector / scalar);
+
+	delete[] buf;
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * la32check: checks the vector partial renderer against the scalar one.
+ *
+ * Random LA32 partial pairs from la32setup are rendered both ways, in calls of
+ * random lengths so runs start and end everywhere. The vector renderer
+ * approximates exp2 and cos, so the output isn't bit-exact: each render must
+ * end at the same sample, stay within MAX_ERROR of full scale at every sample
+ * and, unless it is nearly silent, keep the difference at least MIN_SNR dB
+ * below the signal.
+ *
+ * usage: la32check [pairs]
+ *
+ * Returns non-zero if any render differs by more than that.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "la32setup.h"
+
+static const unsigned long LENGTH = 3 * MT32Emu::SAMPLE_RATE;
+static const double MAX_ERROR = 5e-5;
+static const double MIN_SNR = 100.0;
+// Quieter renders than this only have to stay within MAX_ERROR
+static const double MIN_SNR_RMS = 1e-6;
+
+int main(int argc, char **argv) {
+	int pairs = argc > 1 ? atoi(argv[1]) : 300;
+	float *scalarBuf = new float[LENGTH];
+	float *vectorBuf = new float[LENGTH];
+	double worstError = 0.0, worstSNR = 1000.0;
+	int failures = 0;
+
+#if !MT32EMU_USE_FLOAT_VECTORS
+	printf("no vector renderer on this host\n");
+	return 1;
+#endif
+
+	MT32Emu::Tables::getInstance();
+
+	for (int p = 0; p < pairs; p++) {
+		LA32PairSetup setup;
+		makeLA32PairSetup(setup, p + 1, LENGTH, (p & 3) != 0);
+		// Calls of 1 to 4096 samples, as the synth makes them
+		unsigned long maxCall = 1 + (setup.seed * 2654435761u >> 8) % MT32Emu::MAX_SAMPLES_PER_RUN;
+
+		unsigned long scalarLength = renderLA32Pair(setup, scalarBuf, LENGTH, maxCall, false);
+		unsigned long vectorLength = renderLA32Pair(setup, vectorBuf, LENGTH, maxCall, true);
+		if (scalarLength != vectorLength) {
+			printf("  pair %d ends at sample %lu, not %lu\n", p, vectorLength, scalarLength);
+			failures++;
+			continue;
+		}
+
+		double signal = 0.0, noise = 0.0, maxError = 0.0;
+		unsigned long worstSample = 0;
+		for (unsigned long i = 0; i < scalarLength; i++) {
+			double error = fabs((double)vectorBuf[i] - scalarBuf[i]);
+			signal += (double)scalarBuf[i] * scalarBuf[i];
+			noise += error * error;
+			if (error > maxError) {
+				maxError = error;
+				worstSample = i;
+			}
+		}
+		if (signal == 0.0) {
+			// Partials can legitimately end at once, but most mustn't
+			if (scalarLength > 1000) {
+				printf("  pair %d is silent\n", p);
+				failures++;
+			}
+			continue;
+		}
+		double snr = noise > 0.0 ? 10.0 * log10(signal / noise) : 1000.0;
+		if (maxError > worstError) {
+			worstError = maxError;
+		}
+		if (sqrt(signal / scalarLength) < MIN_SNR_RMS) {
+			snr = 1000.0;
+		} else if (snr < worstSNR) {
+			worstSNR = snr;
+		}
+		if (maxError > MAX_ERROR || snr < MIN_SNR) {
+			printf("  pair %d differs by %g at sample %lu, SNR %.1f dB\n", p, maxError, worstSample, snr);
+			failures++;
+		}
+	}
+
+	printf("%d random pairs of %lu samples: %d differ\n", pairs, LENGTH, failures);
+	printf("worst error %g, worst SNR %.1f dB\n", worstError, worstSNR);
+
+	delete[] scalarBuf;
+	delete[] vectorBuf;
+	printf(failures ? "FAILED\n" : "OK\n");
+	return failures != 0;
+}
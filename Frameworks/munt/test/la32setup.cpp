@@ -0,0 +1,189 @@
+#include <cstdlib>
+
+#include "la32setup.h"
+
+using namespace MT32Emu;
+
+static const Bit32u PCM_ROM_SIZE = 1 << 16;
+
+static const Bit16s *pcmROM() {
+	static Bit16s rom[PCM_ROM_SIZE];
+	static bool made = false;
+	if (!made) {
+		unsigned int seed = 1;
+		for (Bit32u i = 0; i < PCM_ROM_SIZE; i++) {
+			seed = seed * 1103515245 + 12345;
+			// Mostly loud logarithmic samples, as in the real ROM
+			rom[i] = Bit16s(((seed >> 16) & 0x8000) | (0x6000 + ((seed >> 8) & 0x1FFF)));
+		}
+		made = true;
+	}
+	return rom;
+}
+
+static unsigned int rnd(unsigned int &seed) {
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8) & 0xFFFF;
+}
+
+void makeLA32PairSetup(LA32PairSetup &setup, unsigned int seed, unsigned long length, bool synthOnly) {
+	unsigned int s = seed;
+	setup.ringModulated = (rnd(s) & 1) != 0;
+	setup.mixed = (rnd(s) & 1) != 0;
+	for (int i = 0; i < 2; i++) {
+		setup.pcm[i] = !synthOnly && (rnd(s) % 3) == 0;
+		setup.sawtooth[i] = (rnd(s) & 1) != 0;
+		setup.pulseWidth[i] = Bit8u(rnd(s));
+		setup.resonance[i] = Bit8u(1 + rnd(s) % 31);
+		setup.pcmLength[i] = 1000 + rnd(s) % 20000;
+		setup.pcmStart[i] = rnd(s) % (PCM_ROM_SIZE - setup.pcmLength[i]);
+		setup.pcmLooped[i] = (rnd(s) & 1) != 0;
+		// Most partials play on past the end
+		setup.stop[i] = (rnd(s) & 3) == 0 ? rnd(s) * (unsigned long)length / 0x10000 : length;
+	}
+	setup.seed = rnd(s);
+}
+
+// Amp, pitch and cutoff for one partial, as Partial gets them from its TVA, TVP and TVF
+class Envelopes {
+	unsigned int seed;
+	LA32Ramp ampRamp, cutoffRamp;
+	Bit32u baseCutoff;
+	Bit16u basePitch;
+	Bit16u pitch;
+	unsigned long sample;
+
+	void startRamp(LA32Ramp &ramp) {
+		ramp.startRamp(Bit8u(rnd(seed)), Bit8u(rnd(seed)));
+	}
+
+public:
+	explicit Envelopes(unsigned int useSeed) : seed(useSeed), sample(0) {
+		baseCutoff = rnd(seed) % 200;
+		// 30 Hz to 8 kHz
+		basePitch = Bit16u(36000 + rnd(seed) % 32000);
+		pitch = basePitch;
+		startRamp(ampRamp);
+		startRamp(cutoffRamp);
+	}
+
+	Bit32u nextAmp() {
+		Bit32u amp = 67117056 - ampRamp.nextValue();
+		if (ampRamp.checkInterrupt()) {
+			startRamp(ampRamp);
+		}
+		return amp;
+	}
+
+	Bit16u nextPitch() {
+		// The TVP updates the pitch on a timer, stepping a vibrato here
+		if ((sample++ & 15) == 0) {
+			pitch = Bit16u(basePitch + (rnd(seed) & 255) - 128);
+		}
+		return pitch;
+	}
+
+	Bit32u nextCutoff() {
+		Bit32u cutoff = (baseCutoff << 18) + cutoffRamp.nextValue();
+		if (cutoffRamp.checkInterrupt()) {
+			startRamp(cutoffRamp);
+		}
+		return cutoff;
+	}
+};
+
+static void initPair(LA32PartialPair &pair, const LA32PairSetup &setup) {
+	const LA32PartialPair::PairType types[] = {LA32PartialPair::MASTER, LA32PartialPair::SLAVE};
+	pair.init(setup.ringModulated, setup.mixed);
+	for (int i = 0; i < 2; i++) {
+		if (setup.pcm[i]) {
+			pair.initPCM(types[i], pcmROM() + setup.pcmStart[i], setup.pcmLength[i], setup.pcmLooped[i]);
+		} else {
+			pair.initSynth(types[i], setup.sawtooth[i], setup.pulseWidth[i], setup.resonance[i]);
+		}
+	}
+	if (!setup.ringModulated) {
+		pair.deactivate(LA32PartialPair::SLAVE);
+	}
+}
+
+unsigned long renderLA32Pair(const LA32PairSetup &setup, float *buf, unsigned long length, unsigned long maxCall, bool vector) {
+	LA32PartialPair pair;
+	Envelopes master(setup.seed), slave(setup.seed + 1);
+	bool slavePlaying = setup.ringModulated;
+	unsigned long sampleNum = 0;
+
+	initPair(pair, setup);
+
+#if MT32EMU_USE_FLOAT_VECTORS
+	LA32WaveRun masterRun, slaveRun;
+#else
+	vector = false;
+#endif
+
+	// Each call is one Partial::produceOutput(), split into runs by the vector renderer
+	bool playing = true;
+	while (playing && sampleNum < length) {
+		unsigned long callEnd = sampleNum + maxCall < length ? sampleNum + maxCall : length;
+		while (playing && sampleNum < callEnd) {
+			unsigned long runStart = sampleNum;
+			unsigned long runEnd = callEnd;
+#if MT32EMU_USE_FLOAT_VECTORS
+			if (vector) {
+				if (runEnd > runStart + LA32WaveRun::LENGTH) {
+					runEnd = runStart + LA32WaveRun::LENGTH;
+				}
+				pair.startRun(&masterRun, &slaveRun);
+			}
+#endif
+			for (; sampleNum < runEnd; sampleNum++) {
+				if (sampleNum >= setup.stop[0] || !pair.isActive(LA32PartialPair::MASTER)) {
+					pair.deactivate(LA32PartialPair::MASTER);
+					playing = false;
+					break;
+				}
+				Bit32u amp = master.nextAmp();
+				Bit16u pitch = master.nextPitch();
+				Bit32u cutoff = master.nextCutoff();
+#if MT32EMU_USE_FLOAT_VECTORS
+				if (vector) {
+					pair.recordNextSample(LA32PartialPair::MASTER, amp, pitch, cutoff);
+				} else
+#endif
+				pair.generateNextSample(LA32PartialPair::MASTER, amp, pitch, cutoff);
+				if (slavePlaying) {
+					amp = slave.nextAmp();
+					pitch = slave.nextPitch();
+					cutoff = slave.nextCutoff();
+#if MT32EMU_USE_FLOAT_VECTORS
+					if (vector) {
+						pair.recordNextSample(LA32PartialPair::SLAVE, amp, pitch, cutoff);
+					} else
+#endif
+					pair.generateNextSample(LA32PartialPair::SLAVE, amp, pitch, cutoff);
+					if (sampleNum >= setup.stop[1] || !pair.isActive(LA32PartialPair::SLAVE)) {
+						pair.deactivate(LA32PartialPair::SLAVE);
+						slavePlaying = false;
+						if (!setup.mixed) {
+							pair.deactivate(LA32PartialPair::MASTER);
+							playing = false;
+							break;
+						}
+					}
+				}
+#if MT32EMU_USE_FLOAT_VECTORS
+				if (vector) {
+					pair.recordNextOutSample();
+				} else
+#endif
+				buf[sampleNum] = pair.nextOutSample();
+			}
+#if MT32EMU_USE_FLOAT_VECTORS
+			if (vector) {
+				pair.generateRun(buf + runStart);
+			}
+#endif
+		}
+	}
+	return sampleNum;
+}
@@ -0,0 +1,40 @@
+/*
+ * Random LA32 partial pairs and envelopes shared by la32check and la32bench.
+ *
+ * There are no ROMs here, so a pair is driven the way Partial::produceOutput()
+ * drives it, with LA32Ramp envelopes for amp and cutoff, a stepped pitch
+ * vibrato, a random table standing in for the PCM ROM and TVAs that end at
+ * random samples.
+ */
+
+#ifndef LA32SETUP_H
+#define LA32SETUP_H
+
+#include <cmath>
+
+#include "mt32emu.h"
+#include "mmath.h"
+#include "internals.h"
+
+struct LA32PairSetup {
+	bool ringModulated;
+	bool mixed; // mixType 1, otherwise the master ends with the slave (mixType 2)
+	bool pcm[2];
+	bool sawtooth[2];
+	MT32Emu::Bit8u pulseWidth[2];
+	MT32Emu::Bit8u resonance[2];
+	MT32Emu::Bit32u pcmStart[2], pcmLength[2];
+	bool pcmLooped[2];
+	// Sample at which the TVA of each partial stops playing
+	unsigned long stop[2];
+	unsigned int seed;
+};
+
+// The same seed always gives the same setup. With synthOnly, both partials are synth waves.
+void makeLA32PairSetup(LA32PairSetup &setup, unsigned int seed, unsigned long length, bool synthOnly);
+
+// Renders the pair into buf the way Partial::produceOutput() does, a sample at a time or with the
+// vector renderer, in calls of up to maxCall samples. Returns the number of samples before the pair ended.
+unsigned long renderLA32Pair(const LA32PairSetup &setup, float *buf, unsigned long length, unsigned long maxCall, bool vector);
+
+#endif
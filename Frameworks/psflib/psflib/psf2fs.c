@@ -11,8 +11,9 @@
 #define MYMAXPATH (1024)
 
 struct SOURCE_FILE {
-  uint8_t * reserved_data;
+  const uint8_t * reserved_data;
   int reserved_size;
+  const void * cache_handle;
   struct SOURCE_FILE *next;
 };
 
@@ -46,7 +47,8 @@ struct PSF2FS {
 static void source_cleanup_free(struct SOURCE_FILE *source) {
   while(source) {
     struct SOURCE_FILE *next = source->next;
-    if(source->reserved_data) free( source->reserved_data );
+    if(source->cache_handle) psf_cache_release( source->cache_handle );
+    else if(source->reserved_data) free( (void *) source->reserved_data );
     free( source );
     source = next;
   }
@@ -305,11 +307,18 @@ static int addarchive(
   // create a source entry for this psf2
   this_source = ( struct SOURCE_FILE * ) malloc( sizeof( struct SOURCE_FILE ) );
   if(!this_source) goto outofmemory;
-  this_source->reserved_data = ( uint8_t * ) malloc( reserved_size );
-  if(!this_source->reserved_data) goto outofmemory;
-  memcpy(this_source->reserved_data, reserved_data, reserved_size);
-  this_source->reserved_size = reserved_size;
   this_source->next = NULL;
+  // libraries shared between tracks stay in the psflib cache, so refer to them there
+  this_source->cache_handle = psf_cache_retain(reserved_data);
+  if(this_source->cache_handle) {
+    this_source->reserved_data = reserved_data;
+  } else {
+    uint8_t *copy = ( uint8_t * ) malloc( reserved_size );
+    this_source->reserved_data = copy;
+    if(!copy) goto outofmemory;
+    memcpy(copy, reserved_data, reserved_size);
+  }
+  this_source->reserved_size = reserved_size;
   this_dir = makearchivedir(fs, 0, this_source);
   if(fs->adderror) goto error;
 
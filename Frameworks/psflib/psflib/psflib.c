@@ -5,6 +5,12 @@
 
 #include <zlib.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
 #ifdef _MSC_VER
 #define snprintf sprintf_s
 #define strcasecmp _stricmp
@@ -49,6 +55,244 @@ const char * strrpbrk( const char * s, const char * accept)
 
 enum { max_recursion_depth = 10 };
 
+/* Cache of decompressed library files, shared by every psf_load call in the process.
+ * Entries are keyed by path and by the header fields, which include the CRC of the
+ * compressed program, and are evicted least recently used first. Entries still
+ * referenced by a load or a psf_cache_retain caller are freed on their last release. */
+
+typedef struct psf_cache_entry psf_cache_entry;
+
+struct psf_cache_entry
+{
+    char            * path;
+    uint32_t          exe_crc32;
+    uint32_t          exe_compressed_size;
+    uint32_t          reserved_size;
+    long              file_size;
+
+    uint8_t         * exe;
+    size_t            exe_size;
+    uint8_t         * reserved;
+
+    int               refcount;
+    int               evicted;
+
+    psf_cache_entry * next, * prev;
+};
+
+static psf_cache_entry * cache_head = NULL, * cache_tail = NULL;
+static size_t cache_used = 0;
+static size_t cache_limit = 64 * 1024 * 1024;
+
+#ifdef _WIN32
+static INIT_ONCE cache_once = INIT_ONCE_STATIC_INIT;
+static CRITICAL_SECTION cache_section;
+
+static BOOL CALLBACK cache_init( PINIT_ONCE once, PVOID param, PVOID * context )
+{
+    InitializeCriticalSection( &cache_section );
+    return TRUE;
+}
+
+static void cache_lock()
+{
+    InitOnceExecuteOnce( &cache_once, cache_init, NULL, NULL );
+    EnterCriticalSection( &cache_section );
+}
+
+static void cache_unlock()
+{
+    LeaveCriticalSection( &cache_section );
+}
+#else
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void cache_lock()
+{
+    pthread_mutex_lock( &cache_mutex );
+}
+
+static void cache_unlock()
+{
+    pthread_mutex_unlock( &cache_mutex );
+}
+#endif
+
+static size_t cache_entry_size( const psf_cache_entry * entry )
+{
+    return entry->exe_size + entry->reserved_size;
+}
+
+static void cache_entry_free( psf_cache_entry * entry )
+{
+    free( entry->path );
+    if ( entry->exe ) free( entry->exe );
+    if ( entry->reserved ) free( entry->reserved );
+    free( entry );
+}
+
+static void cache_unlink( psf_cache_entry * entry )
+{
+    if ( entry->prev ) entry->prev->next = entry->next;
+    else cache_head = entry->next;
+    if ( entry->next ) entry->next->prev = entry->prev;
+    else cache_tail = entry->prev;
+    entry->next = entry->prev = NULL;
+}
+
+static void cache_link_head( psf_cache_entry * entry )
+{
+    entry->prev = NULL;
+    entry->next = cache_head;
+    if ( cache_head ) cache_head->prev = entry;
+    else cache_tail = entry;
+    cache_head = entry;
+}
+
+/* Must be called with the cache locked */
+static void cache_evict( psf_cache_entry * entry )
+{
+    cache_unlink( entry );
+    cache_used -= cache_entry_size( entry );
+    entry->evicted = 1;
+    if ( !entry->refcount ) cache_entry_free( entry );
+}
+
+/* Must be called with the cache locked */
+static void cache_trim( size_t limit )
+{
+    while ( cache_tail && cache_used > limit )
+        cache_evict( cache_tail );
+}
+
+/* Returns a referenced entry, or NULL if the file is not cached */
+static psf_cache_entry * cache_find( const char * path, uint32_t exe_crc32, uint32_t exe_compressed_size, uint32_t reserved_size, long file_size )
+{
+    psf_cache_entry * entry;
+
+    cache_lock();
+
+    for ( entry = cache_head; entry; entry = entry->next )
+    {
+        if ( entry->exe_crc32 == exe_crc32 && entry->exe_compressed_size == exe_compressed_size &&
+             entry->reserved_size == reserved_size && entry->file_size == file_size && !strcmp( entry->path, path ) )
+        {
+            cache_unlink( entry );
+            cache_link_head( entry );
+            ++entry->refcount;
+            break;
+        }
+    }
+
+    cache_unlock();
+
+    return entry;
+}
+
+/* Takes ownership of the buffers on success, and returns a referenced entry */
+static psf_cache_entry * cache_insert( const char * path, uint32_t exe_crc32, uint32_t exe_compressed_size, uint32_t reserved_size, long file_size,
+                                       uint8_t * exe, size_t exe_size, uint8_t * reserved )
+{
+    psf_cache_entry * entry;
+    psf_cache_entry * existing;
+
+    entry = (psf_cache_entry *) calloc( 1, sizeof(psf_cache_entry) );
+    if ( !entry ) return NULL;
+
+    entry->path = strdup( path );
+    if ( !entry->path )
+    {
+        free( entry );
+        return NULL;
+    }
+
+    entry->exe_crc32 = exe_crc32;
+    entry->exe_compressed_size = exe_compressed_size;
+    entry->reserved_size = reserved_size;
+    entry->file_size = file_size;
+    entry->exe_size = exe_size;
+    entry->refcount = 1;
+
+    cache_lock();
+
+    if ( cache_entry_size( entry ) > cache_limit )
+    {
+        cache_unlock();
+        free( entry->path );
+        free( entry );
+        return NULL;
+    }
+
+    /* Another thread may have loaded the same file meanwhile */
+    for ( existing = cache_head; existing; existing = existing->next )
+    {
+        if ( existing->exe_crc32 == exe_crc32 && existing->exe_compressed_size == exe_compressed_size &&
+             existing->reserved_size == reserved_size && existing->file_size == file_size && !strcmp( existing->path, path ) )
+        {
+            cache_evict( existing );
+            break;
+        }
+    }
+
+    entry->exe = exe;
+    entry->reserved = reserved;
+
+    cache_link_head( entry );
+    cache_used += cache_entry_size( entry );
+    cache_trim( cache_limit );
+
+    cache_unlock();
+
+    return entry;
+}
+
+static void cache_release( psf_cache_entry * entry )
+{
+    cache_lock();
+
+    if ( !--entry->refcount && entry->evicted )
+        cache_entry_free( entry );
+
+    cache_unlock();
+}
+
+void psf_cache_set_size( size_t size )
+{
+    cache_lock();
+
+    cache_limit = size;
+    cache_trim( cache_limit );
+
+    cache_unlock();
+}
+
+const void * psf_cache_retain( const uint8_t * data )
+{
+    psf_cache_entry * entry;
+
+    if ( !data ) return NULL;
+
+    cache_lock();
+
+    for ( entry = cache_head; entry; entry = entry->next )
+    {
+        if ( data == entry->exe || data == entry->reserved )
+        {
+            ++entry->refcount;
+            break;
+        }
+    }
+
+    cache_unlock();
+
+    return entry;
+}
+
+void psf_cache_release( const void * handle )
+{
+    if ( handle ) cache_release( (psf_cache_entry *) handle );
+}
+
 typedef struct psf_load_state
 {
     int                        depth;
@@ -373,6 +617,8 @@ static int psf_load_internal( psf_load_state * state, const char * file_name )
     uint8_t * reserved_buffer = NULL;
     char * tag_buffer = NULL;
 
+    psf_cache_entry * cache_entry = NULL;
+
     uint32_t exe_compressed_size, exe_crc32, reserved_size;
     uLong exe_decompressed_size, try_exe_decompressed_size;
 
@@ -396,9 +642,11 @@ static int psf_load_internal( psf_load_state * state, const char * file_name )
 
     file = state->file_callbacks->fopen( full_path );
 
-    free( full_path );
-
-    if ( !file ) return -1;
+    if ( !file )
+    {
+        free( full_path );
+        return -1;
+    }
 
     if ( state->file_callbacks->fread( header_buffer, 1, 16, file ) < 16 ) goto error_close_file;
 
@@ -448,6 +696,25 @@ static int psf_load_internal( psf_load_state * state, const char * file_name )
         if ( psf_load_internal( state, tag->value ) < 0 ) goto error_free_tags;
     }
 
+    /* Libraries are usually shared by a whole set, so only those are cached */
+    if ( state->depth > 1 )
+        cache_entry = cache_find( full_path, exe_crc32, exe_compressed_size, reserved_size, file_size );
+
+    if ( cache_entry )
+    {
+        state->file_callbacks->fclose( file );
+        file = NULL;
+
+        n = state->load_target( state->load_context, cache_entry->exe, cache_entry->exe_size, cache_entry->reserved, cache_entry->reserved_size );
+
+        cache_release( cache_entry );
+        cache_entry = NULL;
+
+        if ( n ) goto error_free_tags;
+
+        goto load_numbered_libs;
+    }
+
     reserved_buffer = (uint8_t *) malloc( reserved_size );
     if ( !reserved_buffer ) goto error_free_tags;
     exe_compressed_buffer = (uint8_t *) malloc( exe_compressed_size );
@@ -496,14 +763,38 @@ static int psf_load_internal( psf_load_state * state, const char * file_name )
     free( exe_compressed_buffer );
     exe_compressed_buffer = NULL;
 
-    if ( state->load_target( state->load_context, exe_decompressed_buffer, exe_decompressed_size, reserved_buffer, reserved_size ) ) goto error_free_tags;
+    if ( state->depth > 1 )
+    {
+        cache_entry = cache_insert( full_path, exe_crc32, exe_compressed_size, reserved_size, file_size,
+                                    exe_decompressed_buffer, exe_decompressed_size, reserved_buffer );
+        if ( cache_entry )
+        {
+            exe_decompressed_buffer = NULL;
+            reserved_buffer = NULL;
+        }
+    }
+
+    if ( cache_entry )
+    {
+        n = state->load_target( state->load_context, cache_entry->exe, cache_entry->exe_size, cache_entry->reserved, cache_entry->reserved_size );
+
+        cache_release( cache_entry );
+        cache_entry = NULL;
 
-    free( reserved_buffer );
-    reserved_buffer = NULL;
+        if ( n ) goto error_free_tags;
+    }
+    else
+    {
+        if ( state->load_target( state->load_context, exe_decompressed_buffer, exe_decompressed_size, reserved_buffer, reserved_size ) ) goto error_free_tags;
+
+        free( reserved_buffer );
+        reserved_buffer = NULL;
 
-    free( exe_decompressed_buffer );
-    exe_decompressed_buffer = NULL;
+        free( exe_decompressed_buffer );
+        exe_decompressed_buffer = NULL;
+    }
 
+load_numbered_libs:
     n = 2;
     snprintf( state->lib_name_temp, 31, "_lib%u", n );
     state->lib_name_temp[ 31 ] = '\0';
@@ -522,6 +813,8 @@ done:
 
     free_tags( tags );
 
+    free( full_path );
+
     --state->depth;
 
     return header_buffer[ 3 ];
@@ -535,5 +828,6 @@ error_free_buffers:
     if ( tag_buffer ) free( tag_buffer );
 error_close_file:
     if ( file ) state->file_callbacks->fclose( file );
+    free( full_path );
     return -1;
 }
@@ -64,6 +64,24 @@ typedef int (* psf_info_callback)(void * context, const char * name, const char
 int psf_load( const char * uri, const psf_file_callbacks * file_callbacks, uint8_t allowed_version,
               psf_load_callback load_target, void * load_context, psf_info_callback info_target, void * info_context, int info_want_nested_tags );
 
+/* Library files loaded through _lib tags are kept decompressed in a cache shared by all
+ * psf_load calls, keyed by path and the CRC from the file header, so tracks sharing a
+ * library only read and inflate it once.
+ *
+ * Sets the limit for all cached data, in bytes. The default is 64MB, zero disables the
+ * cache.
+ */
+void psf_cache_set_size( size_t size );
+
+/* May be called from a load_target callback with an exe or reserved pointer it was passed,
+ * to keep the data valid after the callback returns, instead of copying it.
+ *
+ * Returns NULL if the data is not cached, otherwise a handle to pass to psf_cache_release.
+ */
+const void * psf_cache_retain( const uint8_t * data );
+
+void psf_cache_release( const void * handle );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,265 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vgmcorpus.h"
+
+/* ********************************************** */
+
+typedef struct {
+    STREAMFILE sf;
+
+    char name[PATH_LIMIT];
+    const uint8_t *data;
+    size_t size;
+    int *touched;
+} MEMORY_STREAMFILE;
+
+static void memory_touch(MEMORY_STREAMFILE *streamfile) {
+    if (streamfile->touched)
+        *streamfile->touched = 1;
+}
+
+static size_t memory_read(MEMORY_STREAMFILE *streamfile, uint8_t *dst, off_t offset, size_t length) {
+    memory_touch(streamfile);
+    if (offset < 0 || offset >= streamfile->size)
+        return 0;
+    if (length > streamfile->size - offset)
+        length = streamfile->size - offset;
+    memcpy(dst, streamfile->data + offset, length);
+    return length;
+}
+static const uint8_t* memory_borrow(MEMORY_STREAMFILE *streamfile, off_t offset, size_t length) {
+    memory_touch(streamfile);
+    if (offset < 0 || offset + length > streamfile->size)
+        return NULL;
+    return streamfile->data + offset;
+}
+static size_t memory_get_size(MEMORY_STREAMFILE *streamfile) {
+    memory_touch(streamfile);
+    return streamfile->size;
+}
+static off_t memory_get_offset(MEMORY_STREAMFILE *streamfile) {
+    memory_touch(streamfile);
+    return 0;
+}
+static void memory_get_name(MEMORY_STREAMFILE *streamfile, char *buffer, size_t length) {
+    strncpy(buffer, streamfile->name, length);
+    buffer[length - 1] = '\0';
+}
+static STREAMFILE* memory_open(MEMORY_STREAMFILE *streamfile, const char * const filename, size_t buffersize) {
+    memory_touch(streamfile);
+    if (!filename || strcmp(filename, streamfile->name) != 0)
+        return NULL;
+    return open_memory_streamfile(streamfile->name, streamfile->data, streamfile->size, streamfile->touched);
+}
+static void memory_close(MEMORY_STREAMFILE *streamfile) {
+    free(streamfile);
+}
+
+STREAMFILE* open_memory_streamfile(const char *name, const uint8_t *data, size_t size, int *touched) {
+    MEMORY_STREAMFILE *this_sf = calloc(1, sizeof(MEMORY_STREAMFILE));
+    if (!this_sf) return NULL;
+
+    this_sf->sf.read = (void*)memory_read;
+    this_sf->sf.get_size = (void*)memory_get_size;
+    this_sf->sf.get_offset = (void*)memory_get_offset;
+    this_sf->sf.get_name = (void*)memory_get_name;
+    this_sf->sf.open = (void*)memory_open;
+    this_sf->sf.close = (void*)memory_close;
+    this_sf->sf.borrow = (void*)memory_borrow;
+
+    snprintf(this_sf->name, sizeof(this_sf->name), "%s", name);
+    this_sf->data = data;
+    this_sf->size = size;
+    this_sf->touched = touched;
+
+    return &this_sf->sf;
+}
+
+/* ********************************************** */
+
+static uint32_t corpus_random = 0x2545F491;
+
+static uint8_t next_byte(void) {
+    corpus_random ^= corpus_random << 13;
+    corpus_random ^= corpus_random >> 17;
+    corpus_random ^= corpus_random << 5;
+    return (uint8_t)corpus_random;
+}
+
+static void fill_noise(uint8_t *p, size_t size) {
+    size_t i;
+    for (i = 0; i < size; i++) {
+        p[i] = next_byte();
+    }
+}
+
+/* RIFF WAVE with PCM data */
+static size_t make_wav(uint8_t *p, int channels, int bits, int sample_rate, size_t data_size) {
+    memcpy(p + 0x00, "RIFF", 4);
+    put_u32le(p + 0x04, 0x24 + data_size);
+    memcpy(p + 0x08, "WAVEfmt ", 8);
+    put_u32le(p + 0x10, 0x10);
+    put_u16le(p + 0x14, 1);
+    put_u16le(p + 0x16, channels);
+    put_u32le(p + 0x18, sample_rate);
+    put_u32le(p + 0x1c, sample_rate * channels * bits / 8);
+    put_u16le(p + 0x20, channels * bits / 8);
+    put_u16le(p + 0x22, bits);
+    memcpy(p + 0x24, "data", 4);
+    put_u32le(p + 0x28, data_size);
+    fill_noise(p + 0x2c, data_size);
+    return 0x2c + data_size;
+}
+
+/* AIFF with PCM data, rate as an 80-bit float */
+static size_t make_aiff(uint8_t *p, int channels, int sample_rate, size_t data_size) {
+    int exponent = 0;
+    uint32_t mantissa = sample_rate;
+
+    while (!(mantissa & 0x80000000)) {
+        mantissa <<= 1;
+        exponent++;
+    }
+
+    memcpy(p + 0x00, "FORM", 4);
+    put_u32be(p + 0x04, 0x2e + data_size);
+    memcpy(p + 0x08, "AIFFCOMM", 8);
+    put_u32be(p + 0x10, 0x12);
+    put_u16be(p + 0x14, channels);
+    put_u32be(p + 0x16, data_size / channels / 2);
+    put_u16be(p + 0x1a, 16);
+    put_u16be(p + 0x1c, 0x3fff + 31 - exponent);
+    put_u32be(p + 0x1e, mantissa);
+    put_u32be(p + 0x22, 0);
+    memcpy(p + 0x26, "SSND", 4);
+    put_u32be(p + 0x2a, data_size + 0x08);
+    put_u32be(p + 0x2e, 0);
+    put_u32be(p + 0x32, 0);
+    fill_noise(p + 0x36, data_size);
+    return 0x36 + data_size;
+}
+
+/* Sony VAGp, mono PS-ADPCM */
+static size_t make_vag(uint8_t *p, int sample_rate, size_t data_size) {
+    size_t i;
+
+    memset(p, 0, 0x30);
+    memcpy(p + 0x00, "VAGp", 4);
+    put_u32be(p + 0x04, 0x20);
+    put_u32be(p + 0x0c, data_size);
+    put_u32be(p + 0x10, sample_rate);
+    memcpy(p + 0x20, "corpus", 6);
+
+    /* frames with a valid header byte and no flags */
+    for (i = 0; i < data_size; i += 0x10) {
+        fill_noise(p + 0x30 + i, 0x10);
+        p[0x30 + i + 0x00] &= 0x4F;
+        p[0x30 + i + 0x01] = 0;
+    }
+    return 0x30 + data_size;
+}
+
+/* Nintendo DSP standard header, mono */
+static size_t make_dsp(uint8_t *p, int sample_rate, size_t data_size) {
+    int i;
+
+    memset(p, 0, 0x60);
+    put_u32be(p + 0x00, data_size / 8 * 14);
+    put_u32be(p + 0x04, data_size * 2);
+    put_u32be(p + 0x08, sample_rate);
+    put_u32be(p + 0x14, data_size * 2 - 1);
+    put_u32be(p + 0x18, 2);
+    for (i = 0; i < 16; i++) {
+        put_u16be(p + 0x1c + i * 2, (uint16_t)(i * 0x123 - 0x800));
+    }
+
+    fill_noise(p + 0x60, data_size);
+    for (i = 0; i < data_size; i += 8) {
+        p[0x60 + i] &= 0x7F;
+    }
+    put_u16be(p + 0x3e, p[0x60]);
+    return 0x60 + data_size;
+}
+
+/* CRI ADX v3, stereo */
+static size_t make_adx(uint8_t *p, int sample_rate, size_t data_size) {
+    memset(p, 0, 0x24);
+    put_u16be(p + 0x00, 0x8000);
+    put_u16be(p + 0x02, 0x20);
+    p[0x04] = 0x03;
+    p[0x05] = 0x12;
+    p[0x06] = 4;
+    p[0x07] = 2;
+    put_u32be(p + 0x08, sample_rate);
+    put_u32be(p + 0x0c, data_size / 0x12 * 32 / 2);
+    put_u16be(p + 0x10, 500);
+    put_u16be(p + 0x12, 0x0300);
+    memcpy(p + 0x1e, "(c)CRI", 6);
+    fill_noise(p + 0x24, data_size);
+    return 0x24 + data_size;
+}
+
+typedef enum { WAV16, WAV8, AIFF, VAG, DSP, ADX, NOISE } corpus_kind_t;
+
+static const struct {
+    const char *name;
+    corpus_kind_t kind;
+} corpus_list[] = {
+    { "stereo.wav",     WAV16 },
+    { "mono.wav",       WAV8 },
+    { "music.aiff",     AIFF },
+    { "voice.vag",      VAG },
+    { "effect.dsp",     DSP },
+    { "bgm.adx",        ADX },
+    { "Upper.WAV",      WAV16 },
+    { "noise.wav",      NOISE },    /* right extension, no header */
+    { "noise.adx",      NOISE },
+    { "noise.bin",      NOISE },    /* common but headerless */
+    { "noise.dat",      NOISE },
+    { "noise.ogg",      NOISE },
+    { "notes.txt",      NOISE },    /* not a format at all */
+    { "noextension",    NOISE },
+};
+
+int make_corpus(corpus_file_t **files) {
+    int i, count = sizeof(corpus_list) / sizeof(corpus_list[0]);
+    const size_t data_size = 0x8000;
+
+    *files = calloc(count, sizeof(corpus_file_t));
+    if (!*files) return 0;
+
+    for (i = 0; i < count; i++) {
+        corpus_file_t *file = &(*files)[i];
+
+        strcpy(file->name, corpus_list[i].name);
+        file->data = malloc(data_size + 0x100);
+        if (!file->data) {
+            free_corpus(*files, count);
+            return 0;
+        }
+
+        switch (corpus_list[i].kind) {
+            case WAV16: file->size = make_wav(file->data, 2, 16, 44100, data_size); break;
+            case WAV8:  file->size = make_wav(file->data, 1, 8, 22050, data_size); break;
+            case AIFF:  file->size = make_aiff(file->data, 2, 32000, data_size); break;
+            case VAG:   file->size = make_vag(file->data, 22050, data_size); break;
+            case DSP:   file->size = make_dsp(file->data, 32000, data_size); break;
+            case ADX:   file->size = make_adx(file->data, 48000, data_size); break;
+            default:
+                fill_noise(file->data, data_size);
+                file->size = data_size;
+                break;
+        }
+    }
+
+    return count;
+}
+
+void free_corpus(corpus_file_t *files, int count) {
+    int i;
+    for (i = 0; i < count; i++) {
+        free(files[i].data);
+    }
+    free(files);
+}
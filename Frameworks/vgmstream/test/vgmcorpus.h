@@ -0,0 +1,24 @@
+#ifndef _VGMCORPUS_H
+#define _VGMCORPUS_H
+
+#include "../vgmstream/src/vgmstream.h"
+
+/* One synthetic file: a name and the bytes behind it */
+typedef struct {
+    char name[32];
+    uint8_t *data;
+    size_t size;
+} corpus_file_t;
+
+/* Builds small files in a range of common formats, plus files no meta accepts,
+ * named with their usual extensions. Returns the count, or 0 on failure. */
+int make_corpus(corpus_file_t **files);
+void free_corpus(corpus_file_t *files, int count);
+
+/* Opens a STREAMFILE over the given bytes, which must outlive it. Opening the same
+ * name again gives a new STREAMFILE over the same bytes, any other name fails.
+ * If touched is set, reads, sizes, offsets and opens set it to 1 (names don't, as
+ * check_extensions needs them). */
+STREAMFILE* open_memory_streamfile(const char *name, const uint8_t *data, size_t size, int *touched);
+
+#endif
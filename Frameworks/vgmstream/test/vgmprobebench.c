@@ -0,0 +1,69 @@
+/*
+ * vgmprobebench: times probing each file of the synthetic corpus, as a folder import
+ * does, walking every meta and with the probe index in vgmstream.c. Also times
+ * building the index.
+ *
+ * vgmstream.c is included directly, so the index can be turned off.
+ *
+ * usage: vgmprobebench [probes per file]
+ */
+
+#include <time.h>
+#include "../vgmstream/src/vgmstream.c"
+#include "vgmcorpus.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Returns microseconds per probe */
+static double probe(const corpus_file_t *file, int use_index, int count) {
+    int ready = probe_index.ready, i;
+    double start;
+
+    if (!use_index)
+        probe_index.ready = 0;
+
+    start = now();
+    for (i = 0; i < count; i++) {
+        STREAMFILE *sf = open_memory_streamfile(file->name, file->data, file->size, NULL);
+        VGMSTREAM *vgmstream = init_vgmstream_from_STREAMFILE(sf);
+
+        close_vgmstream(vgmstream);
+        close_streamfile(sf);
+    }
+    start = now() - start;
+
+    probe_index.ready = ready;
+    return start * 1e6 / count;
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    corpus_file_t *files = NULL;
+    double start, walked_total = 0, indexed_total = 0;
+    int files_count, i;
+
+    files_count = make_corpus(&files);
+    if (!files_count || count <= 0) return 1;
+
+    start = now();
+    pthread_once(&probe_index_once, build_probe_index);
+    printf("index built in %.2f ms\n", (now() - start) * 1e3);
+
+    printf("%-14s %12s %12s   (us per probe)\n", "", "every meta", "indexed");
+    for (i = 0; i < files_count; i++) {
+        double walked = probe(&files[i], 0, count);
+        double indexed = probe(&files[i], 1, count);
+
+        printf("%-14s %12.1f %12.1f\n", files[i].name, walked, indexed);
+        walked_total += walked;
+        indexed_total += indexed;
+    }
+    printf("%-14s %12.1f %12.1f\n", "mean", walked_total / files_count, indexed_total / files_count);
+
+    free_corpus(files, files_count);
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * vgmprobecheck: checks the probe index in vgmstream.c.
+ *
+ * For every extension in formats.c (and a few that aren't), each meta the index
+ * skips is called on a spying STREAMFILE named with that extension, with the default
+ * and a set subsong. It must fail without reading, sizing, or opening anything, or
+ * skipping it could have changed the result. Then each file of the synthetic corpus
+ * is opened with and without the index, which must give the same stream.
+ *
+ * vgmstream.c is included directly, so the index can be reached and turned off.
+ *
+ * usage: vgmprobecheck
+ *
+ * Returns non-zero if any check fails.
+ */
+
+#include "../vgmstream/src/vgmstream.c"
+#include "vgmcorpus.h"
+
+static const char * const extra_exts[] = { "", "bin", "dat", "txt", "WAV", "Adx", "DSP" };
+
+static int count_bits(const uint32_t *words) {
+    int i, count = 0;
+    for (i = 0; i < INIT_VGMSTREAM_FUNCTIONS_COUNT; i++) {
+        if (words[i / 32] & (1u << (i % 32)))
+            count++;
+    }
+    return count;
+}
+
+/* Calls every meta the index skips for the extension, returns the number that misbehaved */
+static int check_skipped(const char *ext, const uint8_t *data, size_t size, long *calls) {
+    uint32_t candidates[PROBE_WORDS];
+    char name[64];
+    STREAMFILE *sf;
+    int i, stream_index, failures = 0;
+
+    snprintf(name, sizeof(name), ext[0] ? "probe.%s" : "probe", ext);
+
+    sf = open_memory_streamfile(name, data, size, NULL);
+    if (!sf) return 1;
+    get_probe_candidates(sf, candidates);
+    close_streamfile(sf);
+
+    for (i = 0; i < INIT_VGMSTREAM_FUNCTIONS_COUNT; i++) {
+        if (candidates[i / 32] & (1u << (i % 32)))
+            continue;
+
+        for (stream_index = 0; stream_index < 2; stream_index++) {
+            VGMSTREAM *vgmstream;
+            int touched = 0;
+
+            sf = open_memory_streamfile(name, data, size, &touched);
+            if (!sf) return failures + 1;
+            sf->stream_index = stream_index;
+
+            vgmstream = (init_vgmstream_functions[i])(sf);
+            (*calls)++;
+
+            if (vgmstream || touched) {
+                printf("  meta %d is skipped for \"%s\" but %s (subsong %d)\n",
+                        i, name, vgmstream ? "opened it" : "looked at it", stream_index);
+                failures++;
+            }
+
+            close_vgmstream(vgmstream);
+            close_streamfile(sf);
+        }
+    }
+
+    return failures;
+}
+
+static VGMSTREAM* open_corpus_file(const corpus_file_t *file, int use_index) {
+    STREAMFILE *sf = open_memory_streamfile(file->name, file->data, file->size, NULL);
+    VGMSTREAM *vgmstream;
+    int ready = probe_index.ready;
+
+    if (!sf) return NULL;
+
+    if (!use_index)
+        probe_index.ready = 0;
+    vgmstream = init_vgmstream_from_STREAMFILE(sf);
+    probe_index.ready = ready;
+
+    close_streamfile(sf);
+    return vgmstream;
+}
+
+int main(void) {
+    corpus_file_t *files = NULL;
+    const char ** exts;
+    size_t exts_count, i;
+    int files_count, failures = 0, ext_failures = 0;
+    long calls = 0;
+
+    files_count = make_corpus(&files);
+    if (!files_count) return 1;
+
+    pthread_once(&probe_index_once, build_probe_index);
+    if (!probe_index.ready) {
+        printf("probe index not built\nFAILED\n");
+        return 1;
+    }
+    printf("%d of %d metas gated by extension, %d entries\n",
+            (int)INIT_VGMSTREAM_FUNCTIONS_COUNT - count_bits(probe_index.always),
+            (int)INIT_VGMSTREAM_FUNCTIONS_COUNT, probe_index.entries_count);
+
+    /* skipped metas, with a real header behind the name in case one gets that far */
+    exts = vgmstream_get_formats(&exts_count);
+    for (i = 0; i < exts_count + sizeof(extra_exts) / sizeof(extra_exts[0]); i++) {
+        const char *ext = i < exts_count ? exts[i] : extra_exts[i - exts_count];
+
+        ext_failures += check_skipped(ext, files[0].data, files[0].size, &calls);
+    }
+    printf("%d extensions, %ld calls to skipped metas: %d looked at the file or opened it\n",
+            (int)(exts_count + sizeof(extra_exts) / sizeof(extra_exts[0])), calls, ext_failures);
+    failures += ext_failures;
+
+    /* same result with and without the index */
+    for (i = 0; i < files_count; i++) {
+        VGMSTREAM *indexed = open_corpus_file(&files[i], 1);
+        VGMSTREAM *walked = open_corpus_file(&files[i], 0);
+        int same;
+
+        if (indexed && walked) {
+            same = indexed->meta_type == walked->meta_type &&
+                    indexed->channels == walked->channels &&
+                    indexed->sample_rate == walked->sample_rate &&
+                    indexed->num_samples == walked->num_samples;
+        }
+        else {
+            same = !indexed && !walked;
+        }
+
+        printf("%-14s %-10s %s\n", files[i].name, walked ? "opens" : "no stream", same ? "same with the index" : "DIFFERS with the index");
+        if (!same)
+            failures++;
+
+        close_vgmstream(indexed);
+        close_vgmstream(walked);
+    }
+
+    free_corpus(files, files_count);
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures != 0;
+}
@@ -3,7 +3,8 @@
 
 
 void decode_ngc_dsp(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
-    uint8_t frame[0x08] = {0};
+    uint8_t frame_buf[0x08] = {0};
+    const uint8_t *frame;
     off_t frame_offset;
     int i, frames_in, sample_count = 0;
     size_t bytes_per_frame, samples_per_frame;
@@ -20,7 +21,11 @@ void decode_ngc_dsp(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 
     /* parse frame header */
     frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = borrow_streamfile(frame_offset, bytes_per_frame, stream->streamfile);
+    if (!frame) {
+        read_streamfile(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+        frame = frame_buf;
+    }
     scale = 1 << ((frame[0] >> 0) & 0xf);
     coef_index  = (frame[0] >> 4) & 0xf;
 
@@ -56,7 +56,8 @@ static const int ps_adpcm_coefs_i[5][2] = {
 
 /* standard PS-ADPCM (float math version) */
 void decode_psx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int is_badflags, int config) {
-    uint8_t frame[0x10] = {0};
+    uint8_t frame_buf[0x10] = {0};
+    const uint8_t *frame;
     off_t frame_offset;
     int i, frames_in, sample_count = 0;
     size_t bytes_per_frame, samples_per_frame;
@@ -74,7 +75,11 @@ void decode_psx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing,
 
     /* parse frame header */
     frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = borrow_streamfile(frame_offset, bytes_per_frame, stream->streamfile);
+    if (!frame) {
+        read_streamfile(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+        frame = frame_buf;
+    }
     coef_index   = (frame[0] >> 4) & 0xf;
     shift_factor = (frame[0] >> 0) & 0xf;
     flag = frame[1]; /* only lower nibble needed */
@@ -125,7 +130,8 @@ void decode_psx(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing,
  *
  * Uses int/float math depending on config (PC/other code may be int, PS3 float). */
 void decode_psx_configurable(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int frame_size, int config) {
-    uint8_t frame[0x50] = {0};
+    uint8_t frame_buf[0x50] = {0};
+    const uint8_t *frame;
     off_t frame_offset;
     int i, frames_in, sample_count = 0;
     size_t bytes_per_frame, samples_per_frame;
@@ -144,7 +150,11 @@ void decode_psx_configurable(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int cha
 
     /* parse frame header */
     frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = borrow_streamfile(frame_offset, bytes_per_frame, stream->streamfile);
+    if (!frame) {
+        read_streamfile(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+        frame = frame_buf;
+    }
     coef_index   = (frame[0] >> 4) & 0xf;
     shift_factor = (frame[0] >> 0) & 0xf;
 
@@ -185,7 +195,8 @@ void decode_psx_configurable(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int cha
 
 /* PS-ADPCM from Pivotal games, exactly like psx_cfg but with float math (reverse engineered from the exe) */
 void decode_psx_pivotal(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int frame_size) {
-    uint8_t frame[0x50] = {0};
+    uint8_t frame_buf[0x50] = {0};
+    const uint8_t *frame;
     off_t frame_offset;
     int i, frames_in, sample_count = 0;
     size_t bytes_per_frame, samples_per_frame;
@@ -202,7 +213,11 @@ void decode_psx_pivotal(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
 
     /* parse frame header */
     frame_offset = stream->offset + bytes_per_frame * frames_in;
-    read_streamfile(frame, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+    frame = borrow_streamfile(frame_offset, bytes_per_frame, stream->streamfile);
+    if (!frame) {
+        read_streamfile(frame_buf, frame_offset, bytes_per_frame, stream->streamfile); /* ignore EOF errors */
+        frame = frame_buf;
+    }
     coef_index   = (frame[0] >> 4) & 0xf;
     shift_factor = (frame[0] >> 0) & 0xf;
 
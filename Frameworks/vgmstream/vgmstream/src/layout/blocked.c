@@ -85,6 +85,7 @@ void render_vgmstream_blocked(sample_t * buffer, int32_t sample_count, VGMSTREAM
             vgmstream->samples_into_block = 0;
         }
 
+        vgmstream_update_seek_table(vgmstream);
     }
 }
 
@@ -36,5 +36,7 @@ void render_vgmstream_flat(sample_t * buffer, int32_t sample_count, VGMSTREAM *
         samples_written += samples_to_do;
         vgmstream->current_sample += samples_to_do;
         vgmstream->samples_into_block += samples_to_do;
+
+        vgmstream_update_seek_table(vgmstream);
     }
 }
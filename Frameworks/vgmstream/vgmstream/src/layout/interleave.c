@@ -141,6 +141,8 @@ void render_vgmstream_interleave(sample_t * buffer, int32_t sample_count, VGMSTR
 
             vgmstream->samples_into_block = 0;
         }
+
+        vgmstream_update_seek_table(vgmstream);
     }
     return;
 fail:
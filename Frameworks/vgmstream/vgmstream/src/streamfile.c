@@ -1,6 +1,17 @@
 #ifndef _MSC_VER
 #include <unistd.h>
 #endif
+#if !defined(_WIN32) && !defined(WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/param.h>
+#include <sys/mount.h>
+/* only where fstatfs can tell local volumes apart */
+#ifdef MNT_LOCAL
+#define VGM_USE_MMAP
+#endif
+#endif
 #include "streamfile.h"
 #include "util.h"
 #include "vgmstream.h"
@@ -238,6 +249,146 @@ STREAMFILE* open_stdio_streamfile_by_file(FILE *file, const char *filename) {
 
 /* **************************************************** */
 
+#ifdef VGM_USE_MMAP
+/* a STREAMFILE that reads from the file mapped in memory, for metas that jump around big banks */
+typedef struct {
+    STREAMFILE sf;
+
+    uint8_t * data;         /* mapped file */
+    size_t filesize;        /* mapped size */
+    int fd;                 /* kept open to check the file hasn't shrunk */
+    off_t offset;           /* last read offset (info) */
+    char name[PATH_LIMIT];
+} MMAP_STREAMFILE;
+
+/* Reading a mapped page that's gone from the file raises SIGBUS, so the mapping is only used
+ * while the file still covers the range. Truncating a file while it plays is rare, so this
+ * narrows the window to between the check and the copy (or the use of a borrowed range). */
+static int mmap_is_mapped(MMAP_STREAMFILE *streamfile, off_t offset, size_t length) {
+    struct stat st;
+
+    if (fstat(streamfile->fd, &st) != 0)
+        return 0;
+    return st.st_size >= offset && (uint64_t)(st.st_size - offset) >= length;
+}
+static size_t mmap_read(MMAP_STREAMFILE *streamfile, uint8_t *dst, off_t offset, size_t length) {
+    ssize_t length_read;
+
+    if (!dst || length <= 0 || offset < 0 || offset >= streamfile->filesize)
+        return 0;
+
+    if (length > streamfile->filesize - offset)
+        length = streamfile->filesize - offset;
+
+    if (mmap_is_mapped(streamfile, offset, length)) {
+        memcpy(dst, streamfile->data + offset, length);
+    }
+    else {
+        /* file got shorter: read what's left of it */
+        length_read = pread(streamfile->fd, dst, length, offset);
+        length = length_read > 0 ? (size_t)length_read : 0;
+    }
+    streamfile->offset = offset + length;
+    return length;
+}
+static const uint8_t* mmap_borrow(MMAP_STREAMFILE *streamfile, off_t offset, size_t length) {
+    if (offset < 0 || offset > streamfile->filesize || length > streamfile->filesize - offset)
+        return NULL;
+    if (!mmap_is_mapped(streamfile, offset, length))
+        return NULL;
+    return streamfile->data + offset;
+}
+static size_t mmap_get_size(MMAP_STREAMFILE *streamfile) {
+    return streamfile->filesize;
+}
+static off_t mmap_get_offset(MMAP_STREAMFILE *streamfile) {
+    return streamfile->offset;
+}
+static void mmap_get_name(MMAP_STREAMFILE *streamfile, char *buffer, size_t length) {
+    strncpy(buffer, streamfile->name, length);
+    buffer[length-1]='\0';
+}
+static void mmap_close(MMAP_STREAMFILE *streamfile) {
+    munmap(streamfile->data, streamfile->filesize);
+    close(streamfile->fd);
+    free(streamfile);
+}
+static STREAMFILE* mmap_open(MMAP_STREAMFILE *streamfile, const char * const filename, size_t buffersize) {
+    STREAMFILE *new_sf;
+
+    if (!filename)
+        return NULL;
+
+    /* empty, virtual or remote files aren't mapped */
+    new_sf = open_mmap_streamfile(filename);
+    if (!new_sf)
+        new_sf = open_stdio_streamfile_buffer(filename, buffersize);
+    return new_sf;
+}
+
+STREAMFILE* open_mmap_streamfile(const char *filename) {
+    MMAP_STREAMFILE *streamfile = NULL;
+    struct stat st;
+    struct statfs stfs;
+    void *data;
+    int fd;
+
+    if (!filename)
+        return NULL;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || (uint64_t)st.st_size > (size_t)-1) {
+        close(fd);
+        return NULL;
+    }
+
+    /* network volumes can change under us without the size showing it */
+    if (fstatfs(fd, &stfs) != 0 || !(stfs.f_flags & MNT_LOCAL)) {
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    streamfile = calloc(1,sizeof(MMAP_STREAMFILE));
+    if (!streamfile) {
+        munmap(data, (size_t)st.st_size);
+        close(fd);
+        return NULL;
+    }
+
+    streamfile->sf.read = (void*)mmap_read;
+    streamfile->sf.get_size = (void*)mmap_get_size;
+    streamfile->sf.get_offset = (void*)mmap_get_offset;
+    streamfile->sf.get_name = (void*)mmap_get_name;
+    streamfile->sf.open = (void*)mmap_open;
+    streamfile->sf.close = (void*)mmap_close;
+    streamfile->sf.borrow = (void*)mmap_borrow;
+
+    streamfile->data = data;
+    streamfile->filesize = (size_t)st.st_size;
+    streamfile->fd = fd;
+
+    strncpy(streamfile->name, filename, sizeof(streamfile->name));
+    streamfile->name[sizeof(streamfile->name)-1] = '\0';
+
+    return &streamfile->sf;
+}
+#else
+STREAMFILE* open_mmap_streamfile(const char *filename) {
+    return NULL;
+}
+#endif
+
+/* **************************************************** */
+
 typedef struct {
     STREAMFILE sf;
 
@@ -395,6 +546,9 @@ typedef struct {
 static size_t wrap_read(WRAP_STREAMFILE *streamfile, uint8_t *dst, off_t offset, size_t length) {
     return streamfile->inner_sf->read(streamfile->inner_sf, dst, offset, length); /* default */
 }
+static const uint8_t* wrap_borrow(WRAP_STREAMFILE *streamfile, off_t offset, size_t length) {
+    return borrow_streamfile(offset, length, streamfile->inner_sf); /* default */
+}
 static size_t wrap_get_size(WRAP_STREAMFILE *streamfile) {
     return streamfile->inner_sf->get_size(streamfile->inner_sf); /* default */
 }
@@ -427,6 +581,7 @@ STREAMFILE* open_wrap_streamfile(STREAMFILE *streamfile) {
     this_sf->sf.get_name = (void*)wrap_get_name;
     this_sf->sf.open = (void*)wrap_open;
     this_sf->sf.close = (void*)wrap_close;
+    this_sf->sf.borrow = (void*)wrap_borrow;
     this_sf->sf.stream_index = streamfile->stream_index;
 
     this_sf->inner_sf = streamfile;
@@ -455,6 +610,11 @@ static size_t clamp_read(CLAMP_STREAMFILE *streamfile, uint8_t *dst, off_t offse
     size_t clamp_length = length > (streamfile->size - offset) ? (streamfile->size - offset) : length;
     return streamfile->inner_sf->read(streamfile->inner_sf, dst, inner_offset, clamp_length);
 }
+static const uint8_t* clamp_borrow(CLAMP_STREAMFILE *streamfile, off_t offset, size_t length) {
+    if (offset < 0 || offset > streamfile->size || length > streamfile->size - offset)
+        return NULL;
+    return borrow_streamfile(streamfile->start + offset, length, streamfile->inner_sf);
+}
 static size_t clamp_get_size(CLAMP_STREAMFILE *streamfile) {
     return streamfile->size;
 }
@@ -499,6 +659,7 @@ STREAMFILE* open_clamp_streamfile(STREAMFILE *streamfile, off_t start, size_t si
     this_sf->sf.get_name = (void*)clamp_get_name;
     this_sf->sf.open = (void*)clamp_open;
     this_sf->sf.close = (void*)clamp_close;
+    this_sf->sf.borrow = (void*)clamp_borrow;
     this_sf->sf.stream_index = streamfile->stream_index;
 
     this_sf->inner_sf = streamfile;
@@ -624,6 +785,9 @@ typedef struct {
 static size_t fakename_read(FAKENAME_STREAMFILE *streamfile, uint8_t *dst, off_t offset, size_t length) {
     return streamfile->inner_sf->read(streamfile->inner_sf, dst, offset, length); /* default */
 }
+static const uint8_t* fakename_borrow(FAKENAME_STREAMFILE *streamfile, off_t offset, size_t length) {
+    return borrow_streamfile(offset, length, streamfile->inner_sf); /* default */
+}
 static size_t fakename_get_size(FAKENAME_STREAMFILE *streamfile) {
     return streamfile->inner_sf->get_size(streamfile->inner_sf); /* default */
 }
@@ -668,6 +832,7 @@ STREAMFILE* open_fakename_streamfile(STREAMFILE *streamfile, const char *fakenam
     this_sf->sf.get_name = (void*)fakename_get_name;
     this_sf->sf.open = (void*)fakename_open;
     this_sf->sf.close = (void*)fakename_close;
+    this_sf->sf.borrow = (void*)fakename_borrow;
     this_sf->sf.stream_index = streamfile->stream_index;
 
     this_sf->inner_sf = streamfile;
@@ -700,6 +865,108 @@ STREAMFILE* open_fakename_streamfile_f(STREAMFILE *streamfile, const char *faken
 
 /* **************************************************** */
 
+typedef struct {
+    STREAMFILE sf;
+
+    char *exts;         /* lists passed to check_extensions, comma separated */
+    size_t exts_len;
+    size_t exts_size;
+    int touched;        /* looked at in some other way */
+    int failed;         /* out of memory */
+} PROBE_STREAMFILE;
+
+static size_t probe_read(PROBE_STREAMFILE *streamfile, uint8_t *dst, off_t offset, size_t length) {
+    streamfile->touched = 1;
+    return 0;
+}
+static const uint8_t* probe_borrow(PROBE_STREAMFILE *streamfile, off_t offset, size_t length) {
+    streamfile->touched = 1;
+    return NULL;
+}
+static size_t probe_get_size(PROBE_STREAMFILE *streamfile) {
+    streamfile->touched = 1;
+    return 0;
+}
+static size_t probe_get_offset(PROBE_STREAMFILE *streamfile) {
+    streamfile->touched = 1;
+    return 0;
+}
+static void probe_get_name(PROBE_STREAMFILE *streamfile, char *buffer, size_t length) {
+    /* check_extensions doesn't get here */
+    streamfile->touched = 1;
+    if (length)
+        buffer[0] = '\0';
+}
+static STREAMFILE* probe_open(PROBE_STREAMFILE *streamfile, const char * const filename, size_t buffersize) {
+    streamfile->touched = 1;
+    return NULL;
+}
+static void probe_close(PROBE_STREAMFILE *streamfile) {
+    free(streamfile->exts);
+    free(streamfile);
+}
+
+static int probe_is_streamfile(STREAMFILE *sf) {
+    return sf->get_name == (void*)probe_get_name;
+}
+
+static void probe_add_exts(PROBE_STREAMFILE *streamfile, const char *cmp_exts) {
+    size_t len = strlen(cmp_exts);
+
+    if (streamfile->exts_len + len + 2 > streamfile->exts_size) {
+        size_t new_size = (streamfile->exts_len + len + 2) * 2;
+        char *new_exts = realloc(streamfile->exts, new_size);
+        if (!new_exts) {
+            streamfile->failed = 1;
+            return;
+        }
+        streamfile->exts = new_exts;
+        streamfile->exts_size = new_size;
+    }
+
+    if (streamfile->exts_len)
+        streamfile->exts[streamfile->exts_len++] = ',';
+    memcpy(streamfile->exts + streamfile->exts_len, cmp_exts, len + 1);
+    streamfile->exts_len += len;
+}
+
+STREAMFILE* open_probe_streamfile(void) {
+    PROBE_STREAMFILE *this_sf = NULL;
+
+    this_sf = calloc(1,sizeof(PROBE_STREAMFILE));
+    if (!this_sf) return NULL;
+
+    /* set callbacks and internals */
+    this_sf->sf.read = (void*)probe_read;
+    this_sf->sf.get_size = (void*)probe_get_size;
+    this_sf->sf.get_offset = (void*)probe_get_offset;
+    this_sf->sf.get_name = (void*)probe_get_name;
+    this_sf->sf.open = (void*)probe_open;
+    this_sf->sf.close = (void*)probe_close;
+    this_sf->sf.borrow = (void*)probe_borrow;
+
+    return &this_sf->sf;
+}
+
+void reset_probe_streamfile(STREAMFILE *streamfile, int stream_index) {
+    PROBE_STREAMFILE *this_sf = (PROBE_STREAMFILE*)streamfile;
+
+    this_sf->sf.stream_index = stream_index;
+    this_sf->exts_len = 0;
+    this_sf->touched = 0;
+    this_sf->failed = 0;
+}
+
+const char* get_probe_streamfile_exts(STREAMFILE *streamfile) {
+    PROBE_STREAMFILE *this_sf = (PROBE_STREAMFILE*)streamfile;
+
+    if (this_sf->touched || this_sf->failed)
+        return NULL;
+    return this_sf->exts_len ? this_sf->exts : "";
+}
+
+/* **************************************************** */
+
 typedef struct {
     STREAMFILE sf;
 
@@ -1137,6 +1404,12 @@ int check_extensions(STREAMFILE *sf, const char * cmp_exts) {
     const char * ststr_res = NULL;
     size_t ext_len, cmp_len;
 
+    /* record what was asked for and fail, see open_probe_streamfile */
+    if (probe_is_streamfile(sf)) {
+        probe_add_exts((PROBE_STREAMFILE*)sf, cmp_exts);
+        return 0;
+    }
+
     sf->get_name(sf,filename,sizeof(filename));
     ext = filename_extension(filename);
     ext_len = strlen(ext);
@@ -1280,8 +1553,11 @@ void get_streamfile_path(STREAMFILE *streamFile, char * buffer, size_t size) {
     }
 }
 void get_streamfile_ext(STREAMFILE *streamFile, char * filename, size_t size) {
+    const char *ext;
+
     streamFile->get_name(streamFile,filename,size);
-    strcpy(filename, filename_extension(filename));
+    ext = filename_extension(filename);
+    memmove(filename, ext, strlen(ext) + 1); /* may overlap */
 }
 
 /* debug util, mainly for custom IO testing */
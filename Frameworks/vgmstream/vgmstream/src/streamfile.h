@@ -73,6 +73,10 @@ typedef struct _STREAMFILE {
     struct _STREAMFILE * (*open)(struct _STREAMFILE *, const char * const filename, size_t buffersize);
     void (*close)(struct _STREAMFILE *);
 
+    /* Optional, returns a pointer to the data if the whole range is in memory, or NULL.
+     * The pointer stays valid until the streamfile is closed. */
+    const uint8_t* (*borrow)(struct _STREAMFILE *, off_t offset, size_t length);
+
 
     /* Substream selection for files with subsongs. Manually used in metas if supported.
      * Not ideal here, but it's the simplest way to pass to all init_vgmstream_x functions. */
@@ -91,6 +95,13 @@ STREAMFILE* open_stdio_streamfile(const char *filename);
 /* Opens a standard STREAMFILE from a pre-opened FILE. */
 STREAMFILE* open_stdio_streamfile_by_file(FILE *file, const char *filename);
 
+/* Opens a STREAMFILE that maps the whole file into memory, so reads are a memcpy and
+ * borrow_streamfile works for any range. Only files on local volumes are mapped. Reads check
+ * the file hasn't shrunk first, reading what's left with IO if it has, and borrows of a range
+ * that's gone return NULL. Re-opens use mappings too, falling back to stdio for files that
+ * can't be mapped. Returns NULL if the file can't be mapped. */
+STREAMFILE* open_mmap_streamfile(const char *filename);
+
 /* Opens a STREAMFILE that does buffered IO.
  * Can be used when the underlying IO may be slow (like when using custom IO).
  * Buffer size is optional. */
@@ -125,6 +136,15 @@ STREAMFILE* open_io_streamfile_ex_f(STREAMFILE *streamfile, void *data, size_t d
 STREAMFILE* open_fakename_streamfile(STREAMFILE *streamfile, const char * fakename, const char * fakeext);
 STREAMFILE* open_fakename_streamfile_f(STREAMFILE *streamfile, const char * fakename, const char * fakeext);
 
+/* Opens a STREAMFILE with no file behind it, to find which extensions a meta accepts.
+ * check_extensions records the lists asked for and fails, anything else marks it as touched
+ * (reads and sizes return 0, opens NULL). */
+STREAMFILE* open_probe_streamfile(void);
+void reset_probe_streamfile(STREAMFILE *streamfile, int stream_index);
+/* Lists passed to check_extensions since the reset joined with commas ("" if none),
+ * or NULL if the streamfile was touched. */
+const char* get_probe_streamfile_exts(STREAMFILE *streamfile);
+
 /* Opens streamfile formed from multiple streamfiles, their data joined during reads.
  * Can be used when data is segmented in multiple separate files.
  * The first streamfile is used to get names, stream index and so on. */
@@ -160,6 +180,14 @@ static inline size_t read_streamfile(uint8_t *dst, off_t offset, size_t length,
     return streamfile->read(streamfile, dst, offset,length);
 }
 
+/* Returns a pointer to length bytes of the file's data at offset without copying, or NULL
+ * if the streamfile doesn't keep the data in memory. Callers should read_streamfile instead then. */
+static inline const uint8_t* borrow_streamfile(off_t offset, size_t length, STREAMFILE *streamfile) {
+    if (!streamfile->borrow)
+        return NULL;
+    return streamfile->borrow(streamfile, offset, length);
+}
+
 /* return file size */
 static inline size_t get_streamfile_size(STREAMFILE * streamfile) {
     return streamfile->get_size(streamfile);
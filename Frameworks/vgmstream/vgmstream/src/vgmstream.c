@@ -4,7 +4,9 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include <math.h>
+#include <pthread.h>
 #include "vgmstream.h"
 #include "meta/meta.h"
 #include "layout/layout.h"
@@ -12,6 +14,8 @@
 #include "mixing.h"
 
 static void try_dual_file_stereo(VGMSTREAM * opened_vgmstream, STREAMFILE *streamFile, VGMSTREAM* (*init_vgmstream_function)(STREAMFILE*));
+static seek_table_t * init_seek_table(VGMSTREAM * vgmstream);
+static void free_seek_table(seek_table_t * table);
 
 
 /* list of metadata parser functions that will recognize files, used on init */
@@ -517,19 +521,219 @@ VGMSTREAM * (*init_vgmstream_functions[])(STREAMFILE *streamFile) = {
 #endif
 };
 
+#define INIT_VGMSTREAM_FUNCTIONS_COUNT (sizeof(init_vgmstream_functions)/sizeof(init_vgmstream_functions[0]))
+#define PROBE_WORDS ((INIT_VGMSTREAM_FUNCTIONS_COUNT + 31) / 32)
+
+
+/* Probe index: most metas reject a file by extension before looking at anything else, so
+ * whether they could accept it is known from the extension alone. Which ones do is found
+ * once, calling each with a probe STREAMFILE that records the extensions checked. Metas
+ * that touch the file before failing are always tried. Probing then calls only the metas
+ * that could accept the file, in the usual order and ending in the usual fallbacks. */
+typedef struct {
+    const char *ext;    /* lowercase */
+    int fcn;
+} probe_entry_t;
+
+static struct {
+    int building;
+    int ready;
+    uint32_t always[PROBE_WORDS];   /* metas not gated by extension */
+    probe_entry_t *entries;         /* sorted by ext, then fcn */
+    int entries_count;
+    char *exts;
+} probe_index;
+
+static pthread_once_t probe_index_once = PTHREAD_ONCE_INIT;
+
+static int probe_entry_compare(const void *a, const void *b) {
+    const probe_entry_t *entry_a = a;
+    const probe_entry_t *entry_b = b;
+    int diff = strcmp(entry_a->ext, entry_b->ext);
+    if (diff)
+        return diff;
+    return entry_a->fcn - entry_b->fcn;
+}
+
+/* Extensions a meta checks before failing without touching the file, or NULL */
+static const char* probe_meta(STREAMFILE *probe_sf, int fcn, int stream_index) {
+    VGMSTREAM *vgmstream;
+    const char *exts;
+
+    reset_probe_streamfile(probe_sf, stream_index);
+    vgmstream = (init_vgmstream_functions[fcn])(probe_sf);
+    if (vgmstream) {
+        close_vgmstream(vgmstream);
+        return NULL;
+    }
+
+    exts = get_probe_streamfile_exts(probe_sf);
+    if (!exts || exts[0] == '\0')
+        return NULL;
+    return exts;
+}
+
+static void build_probe_index(void) {
+    STREAMFILE *probe_sf = NULL;
+    char *gated[INIT_VGMSTREAM_FUNCTIONS_COUNT] = {0};
+    size_t exts_size = 0;
+    int i, count = 0;
+    char *ext;
+
+    probe_index.building = 1;
+
+    probe_sf = open_probe_streamfile();
+    if (!probe_sf) goto fail;
+
+    for (i = 0; i < INIT_VGMSTREAM_FUNCTIONS_COUNT; i++) {
+        const char *exts;
+
+        /* gated if the default and a set subsong both check the same extensions */
+        exts = probe_meta(probe_sf, i, 0);
+        if (exts) {
+            gated[i] = strdup(exts);
+            if (!gated[i]) goto fail;
+
+            exts = probe_meta(probe_sf, i, 1);
+            if (!exts || strcmp(exts, gated[i]) != 0) {
+                free(gated[i]);
+                gated[i] = NULL;
+            }
+        }
+
+        if (!gated[i]) {
+            probe_index.always[i / 32] |= 1u << (i % 32);
+            continue;
+        }
+
+        exts_size += strlen(gated[i]) + 1;
+        count++;
+        for (ext = gated[i]; *ext; ext++) {
+            if (*ext == ',')
+                count++;
+        }
+    }
+
+    close_streamfile(probe_sf);
+    probe_sf = NULL;
+
+    /* split each list into lowercase extensions, one entry per meta and extension */
+    probe_index.exts = malloc(exts_size ? exts_size : 1);
+    probe_index.entries = malloc(count ? count * sizeof(probe_entry_t) : sizeof(probe_entry_t));
+    if (!probe_index.exts || !probe_index.entries) goto fail;
+
+    ext = probe_index.exts;
+    for (i = 0; i < INIT_VGMSTREAM_FUNCTIONS_COUNT; i++) {
+        const char *src;
+
+        if (!gated[i])
+            continue;
+
+        probe_index.entries[probe_index.entries_count].ext = ext;
+        probe_index.entries[probe_index.entries_count].fcn = i;
+        probe_index.entries_count++;
+
+        for (src = gated[i]; *src; src++) {
+            if (*src == ',') {
+                *ext++ = '\0';
+                probe_index.entries[probe_index.entries_count].ext = ext;
+                probe_index.entries[probe_index.entries_count].fcn = i;
+                probe_index.entries_count++;
+            }
+            else {
+                *ext++ = tolower((unsigned char)*src);
+            }
+        }
+        *ext++ = '\0';
+    }
+
+    qsort(probe_index.entries, probe_index.entries_count, sizeof(probe_entry_t), probe_entry_compare);
+
+    for (i = 0; i < INIT_VGMSTREAM_FUNCTIONS_COUNT; i++) {
+        free(gated[i]);
+    }
+
+    probe_index.ready = 1;
+    probe_index.building = 0;
+    return;
+
+fail:
+    close_streamfile(probe_sf);
+    for (i = 0; i < INIT_VGMSTREAM_FUNCTIONS_COUNT; i++) {
+        free(gated[i]);
+    }
+    free(probe_index.exts);
+    free(probe_index.entries);
+    probe_index.exts = NULL;
+    probe_index.entries = NULL;
+    probe_index.entries_count = 0;
+    probe_index.building = 0;
+}
+
+/* Marks the metas that could accept the file, or all of them if there is no index */
+static void get_probe_candidates(STREAMFILE *streamFile, uint32_t *candidates) {
+    char filename[PATH_LIMIT];
+    char ext[PATH_LIMIT];
+    const char *src;
+    int i, lo, hi;
+
+    /* metas may probe subfiles while the index is being built */
+    if (!probe_index.building)
+        pthread_once(&probe_index_once, build_probe_index);
+
+    if (!probe_index.ready) {
+        memset(candidates, 0xFF, PROBE_WORDS * sizeof(uint32_t));
+        return;
+    }
+
+    memcpy(candidates, probe_index.always, PROBE_WORDS * sizeof(uint32_t));
+
+    streamFile->get_name(streamFile,filename,sizeof(filename));
+    src = filename_extension(filename);
+    for (i = 0; src[i] && i < sizeof(ext) - 1; i++) {
+        ext[i] = tolower((unsigned char)src[i]);
+    }
+    ext[i] = '\0';
+
+    /* first entry for the extension */
+    lo = 0;
+    hi = probe_index.entries_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strcmp(probe_index.entries[mid].ext, ext) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (i = lo; i < probe_index.entries_count && strcmp(probe_index.entries[i].ext, ext) == 0; i++) {
+        int fcn = probe_index.entries[i].fcn;
+        candidates[fcn / 32] |= 1u << (fcn % 32);
+    }
+}
+
 
 /* internal version with all parameters */
 static VGMSTREAM * init_vgmstream_internal(STREAMFILE *streamFile) {
     int i, fcns_size;
+    uint32_t candidates[PROBE_WORDS];
     
     if (!streamFile)
         return NULL;
 
+    get_probe_candidates(streamFile, candidates);
+
     fcns_size = (sizeof(init_vgmstream_functions)/sizeof(init_vgmstream_functions[0]));
     /* try a series of formats, see which works */
     for (i = 0; i < fcns_size; i++) {
+        VGMSTREAM * vgmstream;
+
+        /* skip metas that check for some other extension first */
+        if (!(candidates[i / 32] & (1u << (i % 32))))
+            continue;
+
         /* call init function and see if valid VGMSTREAM was returned */
-        VGMSTREAM * vgmstream = (init_vgmstream_functions[i])(streamFile);
+        vgmstream = (init_vgmstream_functions[i])(streamFile);
         if (!vgmstream)
             continue;
 
@@ -616,6 +820,9 @@ static VGMSTREAM * init_vgmstream_internal(STREAMFILE *streamFile) {
         }
 
 
+        /* seek points, if the decoder state can be saved (done before setup so resets keep it) */
+        vgmstream->seek_table = init_seek_table(vgmstream);
+
         setup_vgmstream(vgmstream); /* final setup */
 
         return vgmstream;
@@ -627,6 +834,12 @@ static VGMSTREAM * init_vgmstream_internal(STREAMFILE *streamFile) {
 
 void setup_vgmstream(VGMSTREAM * vgmstream) {
 
+    /* saved points may depend on old loop config (hit_loop), start over */
+    if (vgmstream->seek_table) {
+        vgmstream->seek_table->count = 0;
+        vgmstream->seek_table->next_sample = vgmstream->seek_table->interval;
+    }
+
     /* save start things so we can restart when seeking */
     memcpy(vgmstream->start_ch, vgmstream->ch, sizeof(VGMSTREAMCHANNEL)*vgmstream->channels);
     memcpy(vgmstream->start_vgmstream, vgmstream, sizeof(VGMSTREAM));
@@ -771,6 +984,191 @@ void reset_vgmstream(VGMSTREAM * vgmstream) {
      * (vgmstream->ch[N].streamfiles' internal state, though shouldn't matter) */
 }
 
+/* Seek tables work like loop_ch: save the VGMSTREAM's decoder state at some points and restore later.
+ * Codecs with codec_data and layouts with layout_data keep state elsewhere, so they can't be used. */
+static seek_table_t * init_seek_table(VGMSTREAM * vgmstream) {
+    seek_table_t * table;
+
+    if (vgmstream->codec_data || vgmstream->layout_data)
+        return NULL;
+    if (vgmstream->layout_type == layout_segmented || vgmstream->layout_type == layout_layered)
+        return NULL;
+
+    table = calloc(1, sizeof(seek_table_t));
+    if (!table) return NULL;
+
+    /* at most ~1s of decoding after a seek, for short-ish files */
+    table->interval = vgmstream->num_samples / VGMSTREAM_SEEK_TABLE_MAX_POINTS + 1;
+    if (table->interval < vgmstream->sample_rate)
+        table->interval = vgmstream->sample_rate;
+    table->next_sample = table->interval;
+
+    return table;
+}
+
+static void free_seek_table(seek_table_t * table) {
+    int i;
+
+    if (!table)
+        return;
+
+    if (table->points) {
+        for (i = 0; i < VGMSTREAM_SEEK_TABLE_MAX_POINTS; i++) {
+            free(table->points[i].ch);
+        }
+    }
+    free(table->points);
+    free(table);
+}
+
+void vgmstream_update_seek_table(VGMSTREAM * vgmstream) {
+    seek_table_t * table = vgmstream->seek_table;
+    seek_point_t * point;
+    int samples_per_frame;
+
+    /* points are only added past the furthest one (so after looping back nothing is saved) */
+    if (!table || vgmstream->current_sample < table->next_sample || table->count >= VGMSTREAM_SEEK_TABLE_MAX_POINTS)
+        return;
+
+    /* decoders expect to start at a frame boundary */
+    samples_per_frame = get_vgmstream_samples_per_frame(vgmstream);
+    if (samples_per_frame > 1 && vgmstream->samples_into_block % samples_per_frame != 0)
+        return;
+
+    if (!table->points) {
+        table->points = calloc(VGMSTREAM_SEEK_TABLE_MAX_POINTS, sizeof(seek_point_t));
+        if (!table->points) return;
+    }
+
+    point = &table->points[table->count];
+    if (!point->ch) {
+        point->ch = malloc(sizeof(VGMSTREAMCHANNEL)*vgmstream->channels);
+        if (!point->ch) return;
+    }
+
+    /* save! */
+    memcpy(point->ch, vgmstream->ch, sizeof(VGMSTREAMCHANNEL)*vgmstream->channels);
+    point->sample = vgmstream->current_sample;
+    point->samples_into_block = vgmstream->samples_into_block;
+    point->block_offset = vgmstream->current_block_offset;
+    point->block_size = vgmstream->current_block_size;
+    point->block_samples = vgmstream->current_block_samples;
+    point->next_block_offset = vgmstream->next_block_offset;
+    point->ws_output_size = vgmstream->ws_output_size;
+    point->hit_loop = vgmstream->hit_loop;
+    point->loop_sample = vgmstream->loop_sample;
+    point->loop_samples_into_block = vgmstream->loop_samples_into_block;
+    point->loop_block_offset = vgmstream->loop_block_offset;
+    point->loop_block_size = vgmstream->loop_block_size;
+    point->loop_block_samples = vgmstream->loop_block_samples;
+    point->loop_next_block_offset = vgmstream->loop_next_block_offset;
+
+    table->count++;
+    table->next_sample = vgmstream->current_sample + table->interval;
+}
+
+/* closest saved point at or before sample, or NULL */
+static seek_point_t * find_seek_point(seek_table_t * table, int32_t sample) {
+    int lo, hi;
+
+    if (!table || table->count == 0 || table->points[0].sample > sample)
+        return NULL;
+
+    lo = 0;
+    hi = table->count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (table->points[mid].sample <= sample)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return &table->points[lo];
+}
+
+static void render_layout(sample_t * buffer, int32_t sample_count, VGMSTREAM * vgmstream);
+
+void seek_vgmstream(VGMSTREAM * vgmstream, int32_t seek_sample) {
+    sample_t buffer[0x1000];
+    int32_t seek_pos = seek_sample;
+    int loop_count = 0, disable_loop = 0;
+    int max_samples;
+    seek_point_t * point;
+
+    if (!vgmstream)
+        return;
+    if (seek_pos < 0)
+        seek_pos = 0;
+
+    /* find position in the stream and loops done to get there */
+    if (vgmstream->loop_flag && seek_pos >= vgmstream->loop_end_sample
+            && vgmstream->loop_end_sample > vgmstream->loop_start_sample) {
+        int32_t loop_length = vgmstream->loop_end_sample - vgmstream->loop_start_sample;
+
+        loop_count = (seek_pos - vgmstream->loop_start_sample) / loop_length;
+        if (vgmstream->loop_target && loop_count >= vgmstream->loop_target) {
+            /* past target stream continues normally up to the end (see vgmstream_do_loop) */
+            loop_count = vgmstream->loop_target;
+            seek_pos -= loop_length * loop_count;
+            disable_loop = 1;
+        }
+        else {
+            seek_pos = vgmstream->loop_start_sample + (seek_pos - vgmstream->loop_start_sample) % loop_length;
+        }
+    }
+    if (seek_pos > vgmstream->num_samples)
+        seek_pos = vgmstream->num_samples;
+
+    /* restart from the closest point, unless current position is closer */
+    point = find_seek_point(vgmstream->seek_table, seek_pos);
+    if (vgmstream->loop_count != loop_count || vgmstream->current_sample > seek_pos
+            || (point && vgmstream->current_sample < point->sample)
+            || (disable_loop && vgmstream->loop_flag)) {
+        reset_vgmstream(vgmstream);
+
+        if (point) {
+            /* restore! */
+            memcpy(vgmstream->ch, point->ch, sizeof(VGMSTREAMCHANNEL)*vgmstream->channels);
+            vgmstream->current_sample = point->sample;
+            vgmstream->samples_into_block = point->samples_into_block;
+            vgmstream->current_block_offset = point->block_offset;
+            vgmstream->current_block_size = point->block_size;
+            vgmstream->current_block_samples = point->block_samples;
+            vgmstream->next_block_offset = point->next_block_offset;
+            vgmstream->ws_output_size = point->ws_output_size;
+            vgmstream->hit_loop = point->hit_loop;
+            vgmstream->loop_sample = point->loop_sample;
+            vgmstream->loop_samples_into_block = point->loop_samples_into_block;
+            vgmstream->loop_block_offset = point->loop_block_offset;
+            vgmstream->loop_block_size = point->loop_block_size;
+            vgmstream->loop_block_samples = point->loop_block_samples;
+            vgmstream->loop_next_block_offset = point->loop_next_block_offset;
+        }
+
+        if (disable_loop)
+            vgmstream->loop_flag = 0;
+    }
+
+    /* decode and discard the rest (no need to mix) */
+    max_samples = (sizeof(buffer) / sizeof(sample_t)) / vgmstream->channels;
+    while (vgmstream->current_sample < seek_pos) {
+        int32_t current_sample = vgmstream->current_sample;
+        int32_t samples_to_do = seek_pos - current_sample;
+        if (samples_to_do > max_samples)
+            samples_to_do = max_samples;
+
+        render_layout(buffer, samples_to_do, vgmstream);
+
+        if (vgmstream->current_sample == current_sample) {
+            VGM_LOG("VGMSTREAM: seek stuck at sample %i\n", current_sample); /* layout errors don't move */
+            break;
+        }
+    }
+
+    vgmstream->loop_count = loop_count;
+}
+
 /* Allocate memory and setup a VGMSTREAM */
 VGMSTREAM * allocate_vgmstream(int channel_count, int loop_flag) {
     VGMSTREAM * vgmstream;
@@ -989,6 +1387,8 @@ void close_vgmstream(VGMSTREAM * vgmstream) {
         }
     }
 
+    free_seek_table(vgmstream->seek_table);
+
     mixing_close(vgmstream);
     free(vgmstream->ch);
     free(vgmstream->start_ch);
@@ -1082,6 +1482,12 @@ void vgmstream_set_loop_target(VGMSTREAM* vgmstream, int loop_target) {
 
 /* Decode data into sample buffer */
 void render_vgmstream(sample_t * buffer, int32_t sample_count, VGMSTREAM * vgmstream) {
+    render_layout(buffer, sample_count, vgmstream);
+
+    mix_vgmstream(buffer, sample_count, vgmstream);
+}
+
+static void render_layout(sample_t * buffer, int32_t sample_count, VGMSTREAM * vgmstream) {
     switch (vgmstream->layout_type) {
         case layout_interleave:
             render_vgmstream_interleave(buffer,sample_count,vgmstream);
@@ -1140,8 +1546,6 @@ void render_vgmstream(sample_t * buffer, int32_t sample_count, VGMSTREAM * vgmst
         default:
             break;
     }
-
-    mix_vgmstream(buffer, sample_count, vgmstream);
 }
 
 /* Get the number of samples of a single frame (smallest self-contained sample group, 1/N channels) */
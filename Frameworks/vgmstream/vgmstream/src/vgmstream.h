@@ -13,6 +13,7 @@ enum { VGMSTREAM_MIN_SAMPLE_RATE = 300 }; /* 300 is Wwise min */
 enum { VGMSTREAM_MAX_SAMPLE_RATE = 192000 }; /* found in some FSB5 */
 enum { VGMSTREAM_MAX_SUBSONGS = 65535 };
 enum { VGMSTREAM_MAX_NUM_SAMPLES = 1000000000 }; /* no ~5h vgm hopefully */
+enum { VGMSTREAM_SEEK_TABLE_MAX_POINTS = 256 }; /* bounds seek table memory (points * channels * sizeof(VGMSTREAMCHANNEL)) */
 
 #include "streamfile.h"
 
@@ -836,6 +837,33 @@ typedef struct {
 
 } VGMSTREAMCHANNEL;
 
+/* decoder state saved at some sample, enough to resume decoding from there (see vgmstream_do_loop) */
+typedef struct {
+    int32_t sample;                 /* saved from current_sample */
+    int32_t samples_into_block;     /* saved from samples_into_block */
+    off_t block_offset;             /* saved from current_block_offset */
+    size_t block_size;              /* saved from current_block_size */
+    int32_t block_samples;          /* saved from current_block_samples */
+    off_t next_block_offset;        /* saved from next_block_offset */
+    int32_t ws_output_size;         /* saved from ws_output_size */
+    int hit_loop;                   /* saved from hit_loop */
+    int32_t loop_sample;            /* saved from loop_sample (resets clear loop state, and loop start isn't hit again) */
+    int32_t loop_samples_into_block;/* saved from loop_samples_into_block */
+    off_t loop_block_offset;        /* saved from loop_block_offset */
+    size_t loop_block_size;         /* saved from loop_block_size */
+    int32_t loop_block_samples;     /* saved from loop_block_samples */
+    off_t loop_next_block_offset;   /* saved from loop_next_block_offset */
+    VGMSTREAMCHANNEL * ch;          /* shallow copy of channels */
+} seek_point_t;
+
+/* sparse table of seek points, filled during decode for codecs/layouts that keep all their state in VGMSTREAM */
+typedef struct {
+    int32_t interval;               /* min samples between points */
+    int32_t next_sample;            /* next current_sample where a point may be saved */
+    int count;                      /* saved points (sorted by sample) */
+    seek_point_t * points;          /* alloc'ed on first save (VGMSTREAM_SEEK_TABLE_MAX_POINTS) */
+} seek_table_t;
+
 /* main vgmstream info */
 typedef struct {
     /* basic config */
@@ -912,6 +940,7 @@ typedef struct {
     VGMSTREAMCHANNEL * start_ch;    /* shallow copy of channels as they were at the beginning of the stream (for resets) */
     VGMSTREAMCHANNEL * loop_ch;     /* shallow copy of channels as they were at the loop point (for loops) */
     void* start_vgmstream;          /* shallow copy of the VGMSTREAM as it was at the beginning of the stream (for resets) */
+    seek_table_t * seek_table;      /* decoder state checkpoints (for seeks), NULL if not supported */
 
     void * mixing_data;             /* state for mixing effects */
 
@@ -1322,6 +1351,10 @@ VGMSTREAM * init_vgmstream_from_STREAMFILE(STREAMFILE *streamFile);
 /* reset a VGMSTREAM to start of stream */
 void reset_vgmstream(VGMSTREAM * vgmstream);
 
+/* Seek to sample position in the render_vgmstream timeline (may be past loop end, applying loops).
+ * Restores the closest seek point saved during decode, if possible, and decodes the rest. */
+void seek_vgmstream(VGMSTREAM * vgmstream, int32_t seek_sample);
+
 /* close an open vgmstream */
 void close_vgmstream(VGMSTREAM * vgmstream);
 
@@ -1383,6 +1416,9 @@ int vgmstream_samples_to_do(int samples_this_block, int samples_per_frame, VGMST
 /* Detect loop start and save values, or detect loop end and restore (loop back). Returns 1 if loop was done. */
 int vgmstream_do_loop(VGMSTREAM * vgmstream);
 
+/* Save a seek point if due (called by layouts once current_sample/offsets are updated). */
+void vgmstream_update_seek_table(VGMSTREAM * vgmstream);
+
 /* Open the stream for reading at offset (taking into account layouts, channels and so on).
  * Returns 0 on failure */
 int vgmstream_open_stream(VGMSTREAM * vgmstream, STREAMFILE *streamFile, off_t start_offset);
@@ -703,7 +703,7 @@ static FORCEINLINE void Fetch8BitData(SPUInterpolationMode INTERPOLATE_MODE, NDS
 		s32 sample;
 		Fetch8BitDataInternal(chan, &sample);
 		TestForLoop(state, 0, SPU, chan);
-		resampler_write_sample(chan->resampler, sample);
+		resampler_write_sample_float(chan->resampler, (float)sample);
 	}
 
 	chan->sampinc = saved_inc;
@@ -732,7 +732,7 @@ static FORCEINLINE void Fetch16BitData(SPUInterpolationMode INTERPOLATE_MODE, ND
 		s32 sample;
 		Fetch16BitDataInternal(chan, &sample);
 		TestForLoop(state, 1, SPU, chan);
-		resampler_write_sample(chan->resampler, sample);
+		resampler_write_sample_float(chan->resampler, (float)sample);
 	}
 
 	chan->sampinc = saved_inc;
@@ -761,7 +761,7 @@ static FORCEINLINE void FetchADPCMData(SPUInterpolationMode INTERPOLATE_MODE, ND
 		s32 sample;
 		FetchADPCMDataInternal(chan, &sample);
 		TestForLoop2(state, SPU, chan);
-		resampler_write_sample(chan->resampler, sample);
+		resampler_write_sample_float(chan->resampler, (float)sample);
 	}
 
 	chan->sampinc = saved_inc;
@@ -787,7 +787,7 @@ static FORCEINLINE void FetchPSGData(SPUInterpolationMode INTERPOLATE_MODE, chan
 		s32 sample;
 		FetchPSGDataInternal(chan, &sample);
 		chan->sampcnt += 1.0;
-		resampler_write_sample(chan->resampler, sample);
+		resampler_write_sample_float(chan->resampler, (float)sample);
 	}
 
     /* No need to check if resampler is empty since we always fill it completely, 
@@ -931,6 +931,67 @@ extern "C" void SPU_EmulateSamples(NDS_state *state, int numsamples)
 	state->SNDCore->UpdateAudio(state,state->SPU_core->outbuf,numsamples);
 }
 
+struct SPU_snapshot
+{
+	u32 bufpos;
+	u32 buflength;
+	channel_struct channels[16];
+};
+
+extern "C" void * SPU_SaveState(NDS_state *state)
+{
+	SPU_struct *SPU = state->SPU_core;
+	SPU_snapshot *snapshot = new SPU_snapshot;
+
+	snapshot->bufpos = SPU->bufpos;
+	snapshot->buflength = SPU->buflength;
+
+	for (int i = 0; i < 16; i++)
+	{
+		channel_struct &chan = SPU->channels[i];
+		memcpy((void *)&snapshot->channels[i], (const void *)&chan, sizeof(channel_struct));
+		// the snapshot owns a copy of the resampler, freed with the snapshot
+		snapshot->channels[i].resampler = chan.resampler ? resampler_dup(chan.resampler) : 0;
+	}
+
+	return snapshot;
+}
+
+extern "C" void SPU_LoadState(NDS_state *state, const void *p)
+{
+	const SPU_snapshot *snapshot = (const SPU_snapshot *)p;
+	SPU_struct *SPU = state->SPU_core;
+
+	SPU->bufpos = snapshot->bufpos;
+	SPU->buflength = snapshot->buflength;
+
+	for (int i = 0; i < 16; i++)
+	{
+		channel_struct &chan = SPU->channels[i];
+		void *resampler = chan.resampler;
+		memcpy((void *)&chan, (const void *)&snapshot->channels[i], sizeof(channel_struct));
+		chan.resampler = resampler;
+
+		if (snapshot->channels[i].resampler)
+		{
+			chan.init_resampler();
+			resampler_dup_inplace(chan.resampler, snapshot->channels[i].resampler);
+		}
+		else if (chan.resampler)
+			resampler_clear(chan.resampler);
+	}
+}
+
+extern "C" void SPU_FreeState(void *p)
+{
+	delete (SPU_snapshot *)p;
+}
+
+extern "C" unsigned long SPU_GetStateSize(void)
+{
+	return sizeof(SPU_snapshot);
+}
+
 extern "C" void SPU_Emulate_user(NDS_state *state, BOOL mix)
 {
 	if(!state->SPU_user)
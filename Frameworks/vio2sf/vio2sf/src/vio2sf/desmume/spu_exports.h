@@ -17,6 +17,10 @@ int SPU_Init(NDS_state *, int, int);
 void SPU_DeInit(NDS_state *);
 void SPU_Pause(NDS_state *state, int pause);
 void SPU_SetVolume(NDS_state *state, int volume);
+void * SPU_SaveState(NDS_state *state);
+void SPU_LoadState(NDS_state *state, const void *snapshot);
+void SPU_FreeState(void *snapshot);
+unsigned long SPU_GetStateSize(void);
 
 typedef struct SoundInterface_struct
 {
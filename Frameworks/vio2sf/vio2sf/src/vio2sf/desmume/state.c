@@ -284,6 +284,153 @@ void state_deinit(struct NDS_state *state)
     state->array_rom_coverage = NULL;
 }
 
+#define SNAPSHOT_PAGE_SIZE 4096
+
+typedef struct state_snapshot
+{
+    unsigned long size;
+    NDS_state state;
+    NDSSystem nds;
+    armcpu_t arm7;
+    armcpu_t arm9;
+    armcp15_t arm9_cp15;
+    MMU_struct mmu;
+    void * spu;
+    s16 * sample_buffer;
+    u32 page_count;
+    u32 * page_index;
+    u8 * pages;
+} state_snapshot;
+
+static u32 snapshot_page_length(u32 page)
+{
+    u32 offset = page * SNAPSHOT_PAGE_SIZE;
+    u32 length = (u32)sizeof(ARM9_struct) - offset;
+    return length < SNAPSHOT_PAGE_SIZE ? length : SNAPSHOT_PAGE_SIZE;
+}
+
+static int snapshot_page_empty(const u8 * page, u32 length)
+{
+    u32 i;
+    for (i = 0; i < length; ++i)
+        if (page[i]) return 0;
+    return 1;
+}
+
+void * state_snapshot_create(struct NDS_state *state)
+{
+    const u8 * mem = (const u8 *) state->ARM9Mem;
+    u32 page_total = (u32)((sizeof(ARM9_struct) + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE);
+    u32 i;
+    state_snapshot * snapshot = (state_snapshot *) calloc(1, sizeof(state_snapshot));
+    if (!snapshot)
+        return NULL;
+
+    snapshot->page_index = (u32 *) malloc(page_total * sizeof(u32));
+    if (!snapshot->page_index)
+    {
+        state_snapshot_free(snapshot);
+        return NULL;
+    }
+
+    /* most of the ARM9 memory is never touched, so only keep pages with data */
+    for (i = 0; i < page_total; ++i)
+        if (!snapshot_page_empty(mem + i * SNAPSHOT_PAGE_SIZE, snapshot_page_length(i)))
+            snapshot->page_index[snapshot->page_count++] = i;
+
+    if (snapshot->page_count)
+    {
+        snapshot->pages = (u8 *) malloc(snapshot->page_count * SNAPSHOT_PAGE_SIZE);
+        if (!snapshot->pages)
+        {
+            state_snapshot_free(snapshot);
+            return NULL;
+        }
+        for (i = 0; i < snapshot->page_count; ++i)
+        {
+            u32 page = snapshot->page_index[i];
+            memcpy(snapshot->pages + i * SNAPSHOT_PAGE_SIZE, mem + page * SNAPSHOT_PAGE_SIZE, snapshot_page_length(page));
+        }
+    }
+
+    if (state->sample_pointer)
+    {
+        snapshot->sample_buffer = (s16 *) malloc(state->sample_pointer * 2 * sizeof(s16));
+        if (!snapshot->sample_buffer)
+        {
+            state_snapshot_free(snapshot);
+            return NULL;
+        }
+        memcpy(snapshot->sample_buffer, state->sample_buffer, state->sample_pointer * 2 * sizeof(s16));
+    }
+
+    snapshot->spu = SPU_SaveState(state);
+
+    snapshot->state = *state;
+    snapshot->nds = *state->nds;
+    snapshot->arm7 = *state->NDS_ARM7;
+    snapshot->arm9 = *state->NDS_ARM9;
+    snapshot->arm9_cp15 = *(armcp15_t *)state->NDS_ARM9->coproc[15];
+    snapshot->mmu = *state->MMU;
+
+    snapshot->size = sizeof(state_snapshot) + page_total * sizeof(u32)
+        + snapshot->page_count * SNAPSHOT_PAGE_SIZE
+        + state->sample_pointer * 2 * sizeof(s16)
+        + SPU_GetStateSize();
+
+    return snapshot;
+}
+
+unsigned long state_snapshot_size(const void * p)
+{
+    return p ? ((const state_snapshot *) p)->size : 0;
+}
+
+void state_snapshot_restore(struct NDS_state *state, const void * p)
+{
+    const state_snapshot * snapshot = (const state_snapshot *) p;
+    u8 * mem = (u8 *) state->ARM9Mem;
+    u32 page_total = (u32)((sizeof(ARM9_struct) + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE);
+    u32 i, stored = 0;
+
+    /* all of the heap pointers are unchanged, since snapshots are only
+       restored to the state they were taken from */
+    *state = snapshot->state;
+    *state->nds = snapshot->nds;
+    *state->NDS_ARM7 = snapshot->arm7;
+    *state->NDS_ARM9 = snapshot->arm9;
+    *(armcp15_t *)state->NDS_ARM9->coproc[15] = snapshot->arm9_cp15;
+    *state->MMU = snapshot->mmu;
+
+    for (i = 0; i < page_total; ++i)
+    {
+        if (stored < snapshot->page_count && snapshot->page_index[stored] == i)
+        {
+            memcpy(mem + i * SNAPSHOT_PAGE_SIZE, snapshot->pages + stored * SNAPSHOT_PAGE_SIZE, snapshot_page_length(i));
+            ++stored;
+        }
+        else
+            memset(mem + i * SNAPSHOT_PAGE_SIZE, 0, snapshot_page_length(i));
+    }
+
+    if (state->sample_pointer)
+        memcpy(state->sample_buffer, snapshot->sample_buffer, state->sample_pointer * 2 * sizeof(s16));
+
+    SPU_LoadState(state, snapshot->spu);
+}
+
+void state_snapshot_free(void * p)
+{
+    state_snapshot * snapshot = (state_snapshot *) p;
+    if (!snapshot)
+        return;
+    if (snapshot->spu) SPU_FreeState(snapshot->spu);
+    if (snapshot->sample_buffer) free(snapshot->sample_buffer);
+    if (snapshot->pages) free(snapshot->pages);
+    if (snapshot->page_index) free(snapshot->page_index);
+    free(snapshot);
+}
+
 void state_setrom(struct NDS_state *state, u8 * rom, u32 rom_size, unsigned int enable_coverage_checking)
 {
     assert(!(rom_size & (rom_size - 1)));
@@ -91,6 +91,17 @@ void state_loadstate(NDS_state *state, const u8 * ss, u32 ss_size);
     
 void state_render(NDS_state *state, s16 * buffer, unsigned int sample_count);
 
+/* Snapshots capture the emulator state for restoring to the same
+   NDS_state later, such as for seeking backwards. They are only valid
+   for the state they were taken from. */
+void * state_snapshot_create(NDS_state *state);
+
+unsigned long state_snapshot_size(const void * snapshot);
+
+void state_snapshot_restore(NDS_state *state, const void * snapshot);
+
+void state_snapshot_free(void * snapshot);
+
 #ifdef __cplusplus
 };
 #endif
@@ -72,6 +72,7 @@ typedef enum {
 
 - (PlaylistEntry *)getNextEntry:(PlaylistEntry *)pe;
 - (PlaylistEntry *)getPrevEntry:(PlaylistEntry *)pe;
+- (NSArray *)peekEntriesAfter:(PlaylistEntry *)pe count:(NSInteger)count;
 
 /* Methods for undoing various actions */
 - (NSUndoManager *)undoManager;
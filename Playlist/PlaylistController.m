@@ -656,6 +656,79 @@
 	}
 }
 
+// The entry getNextEntry would give after the queue is empty, but without extending the shuffle list
+- (PlaylistEntry *)peekEntryAfter:(PlaylistEntry *)pe
+{
+	if ([self shuffle] != ShuffleOff)
+	{
+		int i = pe.shuffleIndex + 1;
+		
+		if (i < 0 || i >= [shuffleList count])
+			return nil;
+		
+		return [shuffleList objectAtIndex:i];
+	}
+	else
+	{
+		int i;
+		if (pe.index < 0) //Was a current entry, now removed.
+		{
+			i = -pe.index - 1;
+		}
+		else
+		{
+			i = pe.index + 1;
+		}
+		
+		if ([self repeat] == RepeatAlbum)
+		{
+			PlaylistEntry *next = [self entryAtIndex:i];
+			
+			if ((i > [[self arrangedObjects] count]-1) || ([[next album] caseInsensitiveCompare:[pe album]]) || ([next album] == nil))
+			{
+				NSArray *filtered = [self filterPlaylistOnAlbum:[pe album]];
+				if ([pe album] == nil)
+					i--;
+				else
+					i = [(PlaylistEntry *)[filtered objectAtIndex:0] index];
+			}
+		}
+		
+		return [self entryAtIndex:i];
+	}
+}
+
+// What getNextEntry would return for the next count calls, leaving the queue and shuffle state alone
+- (NSArray *)peekEntriesAfter:(PlaylistEntry *)pe count:(NSInteger)count
+{
+	NSMutableArray *entries = [NSMutableArray array];
+	
+	if ([self repeat] == RepeatOne)
+		return entries;
+	
+	for (PlaylistEntry *queued in queueList)
+	{
+		if ([entries count] >= count)
+			return entries;
+		
+		[entries addObject:queued];
+		pe = queued;
+	}
+	
+	while (pe && [entries count] < count)
+	{
+		pe = [self peekEntryAfter:pe];
+		
+		// Repeating lists come around again
+		if (!pe || [entries containsObject:pe])
+			break;
+		
+		[entries addObject:pe];
+	}
+	
+	return entries;
+}
+
 - (NSArray *)filterPlaylistOnAlbum:(NSString *)album
 {
 	NSPredicate *predicate;
@@ -556,21 +556,39 @@ static inline void dispatch_sync_reentrant(dispatch_queue_t queue, dispatch_bloc
         
         NSBlockOperation *op = [[NSBlockOperation alloc] init];
         [op addExecutionBlock:^{
-            for (PlaylistEntry *pe in weakA)
-            {
-                NSMutableDictionary *entryInfo = [NSMutableDictionary dictionaryWithCapacity:20];
-            
-                NSDictionary *entryProperties = [AudioPropertiesReader propertiesForURL:pe.URL];
-                if (entryProperties == nil)
-                    continue;
+            // Readers that can read tags ahead are given a chunk of files at
+            // a time, which they read on several threads. The chunk bounds
+            // how much is held before the entries below take it.
+            const NSUInteger chunkSize = 256;
+            NSUInteger count = [weakA count];
             
-                [entryInfo addEntriesFromDictionary:entryProperties];
-                [entryInfo addEntriesFromDictionary:[AudioMetadataReader metadataForURL:pe.URL]];
-
-                [weakLock lock];
-                [weakArray addObject:pe];
-                [weakArray addObject:entryInfo];
-                [weakLock unlock];
+            for (NSUInteger start = 0; start < count; start += chunkSize)
+            {
+                NSArray *chunk = [weakA subarrayWithRange:NSMakeRange(start, MIN(chunkSize, count - start))];
+                NSMutableArray *chunkURLs = [NSMutableArray arrayWithCapacity:[chunk count]];
+                for (PlaylistEntry *pe in chunk)
+                {
+                    if (pe.URL)
+                        [chunkURLs addObject:pe.URL];
+                }
+                [AudioMetadataReader prefetchMetadataForURLs:chunkURLs];
+
+                for (PlaylistEntry *pe in chunk)
+                {
+                    NSMutableDictionary *entryInfo = [NSMutableDictionary dictionaryWithCapacity:20];
+                
+                    NSDictionary *entryProperties = [AudioPropertiesReader propertiesForURL:pe.URL];
+                    if (entryProperties == nil)
+                        continue;
+                
+                    [entryInfo addEntriesFromDictionary:entryProperties];
+                    [entryInfo addEntriesFromDictionary:[AudioMetadataReader metadataForURL:pe.URL]];
+
+                    [weakLock lock];
+                    [weakArray addObject:pe];
+                    [weakArray addObject:entryInfo];
+                    [weakLock unlock];
+                }
             }
         }];
         
@@ -95,14 +95,13 @@ static BOOL g_parse_unpack_path(NSString * src, NSString ** archive, NSString **
         return NO;
     }
     
-    while ( !fex_done( fex ) ) {
-        if ( [file isEqualToString:[NSString stringWithUTF8String:fex_name( fex )]] )
-            break;
-        fex_next( fex );
-    }
-    
-    if ( fex_done( fex ) )
+    // Goes straight to the file once the archive has been indexed, and
+    // reuses any solid block decompressed for an earlier open
+    error = fex_seek_name( fex, [file UTF8String] );
+    if ( error ) {
+        ALog(@"Error finding file in archive: %s", error);
         return NO;
+    }
     
     error = fex_data( fex, &data );
     if ( error ) {
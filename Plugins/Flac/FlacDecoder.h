@@ -8,16 +8,20 @@
 
 #import <Cocoa/Cocoa.h>
 #import "FLAC/all.h"
+#import "FLAC/stream_decoder_parallel.h"
 
 #define SAMPLES_PER_WRITE 512
-#define FLAC__MAX_SUPPORTED_CHANNELS 2
-#define SAMPLE_blockBuffer_SIZE ((FLAC__MAX_BLOCK_SIZE + SAMPLES_PER_WRITE) * FLAC__MAX_SUPPORTED_CHANNELS * (24/8))
+#define FLAC__MAX_SUPPORTED_CHANNELS FLAC__MAX_CHANNELS
+#define SAMPLE_blockBuffer_SIZE ((FLAC__MAX_BLOCK_SIZE + SAMPLES_PER_WRITE) * FLAC__MAX_SUPPORTED_CHANNELS * (32/8))
 
 #import "Plugin.h"
 
 @interface FlacDecoder : NSObject <CogDecoder>
 {
 	FLAC__StreamDecoder *decoder;
+	// Decodes the frames of hi-res and multichannel files, while the serial
+	// decoder above reads the metadata and does the seeking.
+	FLAC__StreamDecoderParallel *parallelDecoder;
 	void *blockBuffer;
 	int blockBufferFrames;
 	
@@ -31,6 +35,7 @@
 	long totalFrames;
     
     BOOL hasStreamInfo;
+	FLAC__StreamMetadata_StreamInfo streamInfo;
 }
 
 - (void)setSource:(id<CogSource>)s;
@@ -139,6 +139,9 @@ FLAC__StreamDecoderWriteStatus WriteCallback(const FLAC__StreamDecoder *decoder,
                     *alias32++ = OSSwapHostToBigInt32(sampleblockBuffer[channel][sample]);
                 }
             }
+
+            break;
+
 		default:
 			ALog(@"Error, unsupported sample size.");
 	}
@@ -162,6 +165,7 @@ void MetadataCallback(const FLAC__StreamDecoder *decoder, const FLAC__StreamMeta
         flacDecoder->bitsPerSample = metadata->data.stream_info.bits_per_sample;
 	
         flacDecoder->totalFrames = metadata->data.stream_info.total_samples;
+        flacDecoder->streamInfo = metadata->data.stream_info;
 	
         [flacDecoder willChangeValueForKey:@"properties"];
         [flacDecoder didChangeValueForKey:@"properties"];
@@ -202,16 +206,72 @@ void ErrorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
 
 	blockBuffer = malloc(SAMPLE_blockBuffer_SIZE);
 
+	// A single core can't always keep up with these, let alone while the
+	// rest of the chain converts them. Opt in with flac.parallelDecode for
+	// now: its speedup on several cores hasn't been measured yet, and on one
+	// core it only adds overhead, so it's never used there.
+	if ([[NSUserDefaults standardUserDefaults] boolForKey:@"flac.parallelDecode"] &&
+		[[NSProcessInfo processInfo] activeProcessorCount] > 1 &&
+		hasStreamInfo && [source seekable] && (channels > 2 || bitsPerSample > 16 || frequency > 48000))
+	{
+		[self startParallelDecoder];
+	}
+
 	return YES;
 }
 
+// Hands decoding over to the parallel decoder, starting at the frame the
+// serial decoder is at.  Returns NO and leaves the serial decoder in charge
+// if that can't be done.
+- (BOOL)startParallelDecoder
+{
+	FLAC__uint64 position;
+
+	if (!FLAC__stream_decoder_get_decode_position(decoder, &position))
+		return NO;
+
+	parallelDecoder = FLAC__stream_decoder_parallel_new(0);
+	if (parallelDecoder == NULL)
+		return NO;
+
+	if ([source seek:position whence:SEEK_SET])
+	{
+		[self setEndOfStream:NO];
+		if (FLAC__stream_decoder_parallel_init(parallelDecoder,
+											   &streamInfo,
+											   ReadCallback,
+											   WriteCallback,
+											   ErrorCallback,
+											   (__bridge void *)(self)))
+		{
+			return YES;
+		}
+	}
+
+	FLAC__stream_decoder_parallel_delete(parallelDecoder);
+	parallelDecoder = NULL;
+
+	// The serial decoder read ahead; it continues from where it stopped
+	[source seek:position whence:SEEK_SET];
+	FLAC__stream_decoder_flush(decoder);
+
+	return NO;
+}
+
 - (int)readAudio:(void *)buffer frames:(UInt32)frames
 {
 	int framesRead = 0;
 	int bytesPerFrame = (bitsPerSample/8) * channels;
 	while (framesRead < frames)
 	{	
-		if (blockBufferFrames == 0)
+		if (blockBufferFrames == 0 && parallelDecoder)
+		{
+			if (!FLAC__stream_decoder_parallel_process_single(parallelDecoder))
+			{
+				break;
+			}
+		}
+		else if (blockBufferFrames == 0)
 		{
 			if (FLAC__stream_decoder_get_state (decoder) == FLAC__STREAM_DECODER_END_OF_STREAM)
 			{
@@ -244,6 +304,10 @@ void ErrorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
 
 - (void)close
 {
+	if (parallelDecoder)
+	{
+		FLAC__stream_decoder_parallel_delete(parallelDecoder);
+	}
 	if (decoder)
 	{
 		FLAC__stream_decoder_finish(decoder);
@@ -255,6 +319,7 @@ void ErrorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
 	}
 
 	decoder = NULL;
+	parallelDecoder = NULL;
 	blockBuffer = NULL;
 }
 
@@ -265,6 +330,31 @@ void ErrorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
 
 - (long)seek:(long)sample
 {
+	if (parallelDecoder)
+	{
+		// The serial decoder finds the frame and decodes the part of it
+		// after sample, the parallel decoder carries on after that frame
+		FLAC__uint64 position;
+
+		FLAC__stream_decoder_parallel_flush(parallelDecoder);
+		[self setEndOfStream:NO];
+
+		if (!FLAC__stream_decoder_seek_absolute(decoder, sample))
+		{
+			FLAC__stream_decoder_parallel_delete(parallelDecoder);
+			parallelDecoder = NULL;
+			return -1;
+		}
+
+		if (!FLAC__stream_decoder_get_decode_position(decoder, &position) || ![source seek:position whence:SEEK_SET])
+		{
+			FLAC__stream_decoder_parallel_delete(parallelDecoder);
+			parallelDecoder = NULL;
+		}
+
+		return sample;
+	}
+
 	if (!FLAC__stream_decoder_seek_absolute(decoder, sample))
         return -1;
 	
@@ -9,6 +9,14 @@
 #import <Cocoa/Cocoa.h>
 #import "Plugin.h"
 #include "circular_buffer.h"
+#include <vector>
+
+struct hc_checkpoint
+{
+    long frame;
+    void * state;
+    size_t size;
+};
 
 @interface HCDecoder : NSObject<CogDecoder,CogMetadataReader> {
     id<CogSource> currentSource;
@@ -39,6 +47,12 @@
     long framesLength;
     
     BOOL usfRemoveSilence;
+    long framesSkipped;
+
+    std::vector<hc_checkpoint> checkpoints;
+    size_t checkpointMemory;
+    long checkpointInterval;
+    long nextCheckpoint;
 }
 
 @end
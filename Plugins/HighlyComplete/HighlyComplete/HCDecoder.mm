@@ -37,6 +37,8 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+
 #include <dlfcn.h>
 
 #import "PlaylistController.h"
@@ -169,6 +171,11 @@ static psf_file_callbacks source_callbacks =
 };
 
 
+// Emulator state checkpoints taken during playback, so that seeking back
+// restores the nearest one instead of restarting from the beginning.
+static const long checkpoint_interval_seconds = 10;
+static const size_t checkpoint_memory_limit = 64 * 1024 * 1024;
+
 @implementation HCDecoder
 
 + (void)initialize
@@ -191,6 +198,7 @@ static psf_file_callbacks source_callbacks =
         type = 0;
         emulatorCore = NULL;
         emulatorExtra = NULL;
+        checkpointMemory = 0;
     }
     return self;
 }
@@ -1005,7 +1013,8 @@ static int usf_info(void * context, const char * name, const char * value)
         sega_enable_dry( emulatorCore, 1 );
         sega_enable_dsp( emulatorCore, 1 );
         
-        sega_enable_dsp_dynarec( emulatorCore, 0 );
+        sega_enable_dsp_dynarec( emulatorCore, 1 );
+        sega_prepare_dynacode( emulatorCore );
         
         uint32_t start  = *(uint32_t*) state.data;
         size_t length = state.data_size;
@@ -1239,17 +1248,188 @@ static int usf_info(void * context, const char * name, const char * value)
     else return NO;
     
     framesRead = 0;
+    framesSkipped = 0;
+    
+    checkpointInterval = sampleRate * checkpoint_interval_seconds;
+    nextCheckpoint = 0;
     
     silence_test_buffer.resize( sampleRate * silence_seconds * 2 );
+    
+    [self saveCheckpoint];
 
     if (![self fillBuffer])
         return NO;
     
+    [self removeLeadingSilence];
+    
+    return YES;
+}
+
+- (void)removeLeadingSilence
+{
+    unsigned long buffered = silence_test_buffer.data_available();
     silence_test_buffer.remove_leading_silence();
+    framesSkipped += ( buffered - silence_test_buffer.data_available() ) / 2;
+}
+
+- (BOOL)checkpointsSupported
+{
+    // USF state holds the recompiler's code blocks and pointers into them,
+    // and NCSF is driven by a C++ player object, so neither can be copied.
+    return type == 1 || type == 2 || type == 0x11 || type == 0x12 || type == 0x22 || type == 0x24 || type == 0x41;
+}
+
+- (long)emulatorPosition
+{
+    return framesRead + framesSkipped + silence_test_buffer.data_available() / 2;
+}
+
+- (void)saveCheckpoint
+{
+    if ( ![self checkpointsSupported] )
+        return;
+    
+    long frame = [self emulatorPosition];
+    if ( frame < nextCheckpoint )
+        return;
+    
+    nextCheckpoint = frame + checkpointInterval;
+    
+    hc_checkpoint checkpoint = { frame, NULL, 0 };
+    
+    if ( type == 1 || type == 2 || type == 0x11 || type == 0x12 || type == 0x41 )
+    {
+        if ( type == 1 || type == 2 )
+            checkpoint.size = psx_get_state_size( type );
+        else if ( type == 0x11 || type == 0x12 )
+            checkpoint.size = sega_get_state_size( type - 0x10 );
+        else
+            checkpoint.size = qsound_get_state_size();
+        
+        checkpoint.state = malloc( checkpoint.size );
+        if ( checkpoint.state )
+            memcpy( checkpoint.state, emulatorCore, checkpoint.size );
+    }
+    else if ( type == 0x22 )
+    {
+        struct mCore * core = ( struct mCore * ) emulatorCore;
+        struct gsf_running_state * rstate = ( struct gsf_running_state * ) emulatorExtra;
+        
+        size_t core_size = core->stateSize( core );
+        checkpoint.size = core_size + sizeof( rstate->buffered ) + sizeof( rstate->samples );
+        
+        uint8_t * ptr = ( uint8_t * ) malloc( checkpoint.size );
+        if ( ptr && core->saveState( core, ptr ) )
+        {
+            memcpy( ptr + core_size, &rstate->buffered, sizeof( rstate->buffered ) );
+            memcpy( ptr + core_size + sizeof( rstate->buffered ), rstate->samples, sizeof( rstate->samples ) );
+            checkpoint.state = ptr;
+        }
+        else
+            free( ptr );
+    }
+    else if ( type == 0x24 )
+    {
+        NDS_state * state = ( NDS_state * ) emulatorCore;
+        checkpoint.state = state_snapshot_create( state );
+        checkpoint.size = state_snapshot_size( checkpoint.state );
+    }
+    
+    if ( !checkpoint.state )
+        return;
+    
+    checkpoints.push_back( checkpoint );
+    checkpointMemory += checkpoint.size;
+    
+    // Over budget, so keep every other checkpoint and space them further apart
+    while ( checkpointMemory > checkpoint_memory_limit && checkpoints.size() > 2 )
+    {
+        std::vector<hc_checkpoint> kept;
+        for ( size_t i = 0; i < checkpoints.size(); ++i )
+        {
+            if ( i & 1 )
+                [self freeCheckpoint:checkpoints[ i ]];
+            else
+                kept.push_back( checkpoints[ i ] );
+        }
+        checkpoints.swap( kept );
+        checkpointInterval *= 2;
+        nextCheckpoint = checkpoints.back().frame + checkpointInterval;
+    }
+}
+
+- (BOOL)restoreCheckpoint:(const hc_checkpoint &)checkpoint
+{
+    if ( type == 1 || type == 2 || type == 0x11 || type == 0x12 || type == 0x41 )
+    {
+        memcpy( emulatorCore, checkpoint.state, checkpoint.size );
+    }
+    else if ( type == 0x22 )
+    {
+        struct mCore * core = ( struct mCore * ) emulatorCore;
+        struct gsf_running_state * rstate = ( struct gsf_running_state * ) emulatorExtra;
+        
+        const uint8_t * ptr = ( const uint8_t * ) checkpoint.state;
+        size_t core_size = checkpoint.size - sizeof( rstate->buffered ) - sizeof( rstate->samples );
+        
+        if ( !core->loadState( core, ptr ) )
+            return NO;
+        
+        // The resampler output is not part of the saved state
+        blip_clear( core->getAudioChannel( core, 0 ) );
+        blip_clear( core->getAudioChannel( core, 1 ) );
+        
+        memcpy( &rstate->buffered, ptr + core_size, sizeof( rstate->buffered ) );
+        memcpy( rstate->samples, ptr + core_size + sizeof( rstate->buffered ), sizeof( rstate->samples ) );
+    }
+    else if ( type == 0x24 )
+    {
+        NDS_state * state = ( NDS_state * ) emulatorCore;
+        state_snapshot_restore( state, checkpoint.state );
+    }
+    else return NO;
+    
+    silence_test_buffer.reset();
+    framesRead = checkpoint.frame - framesSkipped;
+    nextCheckpoint = checkpoint.frame + checkpointInterval;
     
     return YES;
 }
 
+- (void)freeCheckpoint:(const hc_checkpoint &)checkpoint
+{
+    if ( type == 0x24 )
+        state_snapshot_free( checkpoint.state );
+    else
+        free( checkpoint.state );
+    checkpointMemory -= checkpoint.size;
+}
+
+- (void)freeCheckpoints
+{
+    for ( size_t i = 0; i < checkpoints.size(); ++i )
+        [self freeCheckpoint:checkpoints[ i ]];
+    checkpoints.clear();
+    checkpointMemory = 0;
+}
+
+- (BOOL)seekToCheckpoint:(long)frame
+{
+    long target = frame + framesSkipped;
+    
+    std::vector<hc_checkpoint>::const_iterator it = std::upper_bound( checkpoints.begin(), checkpoints.end(), target,
+        []( long value, const hc_checkpoint & checkpoint ) { return value < checkpoint.frame; } );
+    if ( it == checkpoints.begin() )
+        return NO;
+    --it;
+    
+    // Going forward, only worth it if the checkpoint is past what is already decoded
+    if ( frame >= framesRead && it->frame <= [self emulatorPosition] )
+        return NO;
+    
+    return [self restoreCheckpoint:*it];
+}
+
 - (BOOL)open:(id<CogSource>)source
 {
 	if (![source seekable]) {
@@ -1332,6 +1512,7 @@ static int usf_info(void * context, const char * name, const char * value)
         if ( !samples_read ) break;
         silence_test_buffer.samples_written( samples_read * 2 );
         free_space -= samples_read;
+        [self saveCheckpoint];
     }
     return !silence_test_buffer.test_silence();
 }
@@ -1439,7 +1620,7 @@ static int usf_info(void * context, const char * name, const char * value)
     
     if ( usfRemoveSilence )
     {
-        silence_test_buffer.remove_leading_silence();
+        [self removeLeadingSilence];
         usfRemoveSilence = NO;
     }
     
@@ -1476,6 +1657,8 @@ static int usf_info(void * context, const char * name, const char * value)
 
 - (void)closeDecoder
 {
+    [self freeCheckpoints];
+
     if ( emulatorCore ) {
         if ( type == 0x21 ) {
             usf_shutdown( emulatorCore );
@@ -1490,6 +1673,9 @@ static int usf_info(void * context, const char * name, const char * value)
         } else if ( type == 0x25 ) {
             Player * player = ( Player * ) emulatorCore;
             delete player;
+        } else if ( type == 0x11 || type == 0x12 ) {
+            sega_unprepare_dynacode( emulatorCore );
+            free( emulatorCore );
         } else {
             free( emulatorCore );
         }
@@ -1539,13 +1725,16 @@ static int usf_info(void * context, const char * name, const char * value)
 
 - (long)seek:(long)frame
 {
-    if (frame < framesRead || emulatorCore == NULL) {
+    if (emulatorCore != NULL && [self seekToCheckpoint:frame]) {
+        // Restored, the rest is run forward from the checkpoint
+    }
+    else if (frame < framesRead || emulatorCore == NULL) {
         [self closeDecoder];
         if (![self initializeDecoder])
             return -1;
         if (usfRemoveSilence)
         {
-            silence_test_buffer.remove_leading_silence();
+            [self removeLeadingSilence];
             usfRemoveSilence = NO;
         }
     }
@@ -1564,6 +1753,27 @@ static int usf_info(void * context, const char * name, const char * value)
         framesRead += buffered_samples;
     }
     
+    while ( framesRead < frame )
+    {
+        long target = frame;
+        long checkpoint_frame = nextCheckpoint - framesSkipped;
+        if ( [self checkpointsSupported] && checkpoint_frame > framesRead && checkpoint_frame < target )
+            target = checkpoint_frame;
+        
+        long last_read = framesRead;
+        if ( ![self skipTo:target] )
+            return -1;
+        if ( framesRead == last_read )
+            break;
+        
+        [self saveCheckpoint];
+    }
+    
+	return framesRead;
+}
+
+- (BOOL)skipTo:(long)frame
+{
     if ( type == 1 || type == 2 )
     {
         do
@@ -1591,7 +1801,7 @@ static int usf_info(void * context, const char * name, const char * value)
             ssize_t howmany = frame - framesRead;
             if (howmany > 1024) howmany = 1024;
             if ( usf_render_resampled(emulatorCore, NULL, howmany, sampleRate) != 0 )
-                return -1;
+                return NO;
             framesRead += howmany;
         } while (framesRead < frame);
     }
@@ -1676,7 +1886,7 @@ static int usf_info(void * context, const char * name, const char * value)
         while ( framesRead < frame );
     }
     
-	return framesRead;
+	return YES;
 }
 
 - (NSDictionary *)properties
@@ -60,7 +60,7 @@ public:
     }
     void reset()
     {
-        readptr = writeptr = used = 0;
+        readptr = writeptr = used = silence_count = 0;
         memset( last_written, 0, sizeof(last_written) );
         memset( last_read, 0, sizeof(last_read) );
     }
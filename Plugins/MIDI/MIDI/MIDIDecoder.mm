@@ -178,6 +178,9 @@ static OSType getOSType(const char * in_)
         
         msplayer->set_extp(1);
         
+        msplayer->set_chips((unsigned int)[[NSUserDefaults standardUserDefaults] integerForKey:@"midi.opl3.chips"],
+                            [[NSUserDefaults standardUserDefaults] boolForKey:@"midi.opl3.threaded"]);
+        
         msplayer->setSampleRate( 44100 );
     }
     else if ([[plugin substringToIndex:5] isEqualToString:@"OPL3W"])
@@ -191,6 +194,9 @@ static OSType getOSType(const char * in_)
         
         msplayer->set_extp(1);
         
+        msplayer->set_chips((unsigned int)[[NSUserDefaults standardUserDefaults] integerForKey:@"midi.opl3.chips"],
+                            [[NSUserDefaults standardUserDefaults] boolForKey:@"midi.opl3.threaded"]);
+        
         msplayer->setSampleRate( 44100 );
     }
     else
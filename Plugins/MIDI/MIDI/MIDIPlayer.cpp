@@ -1,7 +1,126 @@
 #include <assert.h>
 
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+
 #include "MIDIPlayer.h"
 
+enum
+{
+	chase_interval = 4096
+};
+
+enum chase_type
+{
+	chase_note_on,
+	chase_note_off,
+	chase_sysex,	// only the last of each kind is needed, and resets end what came before
+	chase_fixed,	// order dependent, like RPN/NRPN and mode messages: always replayed
+	chase_keyed		// only the last value for the key is needed
+};
+
+static chase_type chase_classify(uint32_t ev, uint32_t & key)
+{
+	if (ev & 0x80000000) return chase_sysex;
+
+	uint32_t status = ev & 0xF0;
+	uint32_t port = (ev >> 24) & 0x7F;
+	uint32_t ch = ev & 0x0F;
+	uint32_t data1 = (ev >> 8) & 0x7F;
+
+	key = (port << 13) | (ch << 9);
+
+	switch (status)
+	{
+	case 0x80:
+	case 0x90:
+		key = ev & 0x7F00FF0F;
+		return (status == 0x90 && (ev & 0xFF0000)) ? chase_note_on : chase_note_off;
+
+	case 0xA0:
+		key += 131 + data1;
+		return chase_keyed;
+
+	case 0xB0:
+		if (data1 == 6 || data1 == 38 || (data1 >= 96 && data1 <= 101) || data1 >= 120)
+			return chase_fixed;
+		key += data1;
+		return chase_keyed;
+
+	case 0xC0:
+		key += 128;
+		return chase_keyed;
+
+	case 0xD0:
+		key += 129;
+		return chase_keyed;
+
+	case 0xE0:
+		key += 130;
+		return chase_keyed;
+	}
+
+	// system real time messages, the channel bits hold the rest of the status
+	key += 259;
+	return chase_keyed;
+}
+
+static uint32_t chase_port(system_exclusive_table & sysex_map, uint32_t ev)
+{
+	if (!(ev & 0x80000000)) return (ev >> 24) & 0x7F;
+
+	const uint8_t * data;
+	size_t size, port;
+	sysex_map.get_entry(ev & 0xFFFFFF, data, size, port);
+	return (uint32_t) port;
+}
+
+// A later sysex with the same key replaces this one: the same write to the
+// same address, or else the same message. Sets reset for the messages which
+// reset the whole device.
+static std::string sysex_chase_key(system_exclusive_table & sysex_map, uint32_t ev, bool & reset)
+{
+	const uint8_t * data;
+	size_t size, port;
+	sysex_map.get_entry(ev & 0xFFFFFF, data, size, port);
+
+	size_t key_size = size;
+	reset = false;
+
+	if (size >= 10 && data[1] == 0x41 && data[4] == 0x12)
+	{
+		// Roland DT1, GS reset and SC-88 mode set, MT-32 reset
+		reset = (data[3] == 0x42 && (data[5] == 0x40 || data[5] == 0x00) && data[6] == 0x00 && data[7] == 0x7F) ||
+			(data[3] == 0x16 && data[5] == 0x7F);
+		key_size = 8;
+	}
+	else if (size >= 9 && data[1] == 0x43 && (data[2] & 0xF0) == 0x10)
+	{
+		// Yamaha parameter change, XG system on
+		reset = data[3] == 0x4C && data[4] == 0x00 && data[5] == 0x00 && data[6] == 0x7E;
+		key_size = 7;
+	}
+	else if (size >= 6 && data[1] == 0x7E && data[3] == 0x09)
+	{
+		// GM system on / off, GM2 system on
+		reset = true;
+	}
+	else if (size >= 7 && data[1] == 0x7F)
+	{
+		// universal real time, like master volume
+		key_size = 5;
+	}
+
+	// the port first, so a reset can drop everything on its port
+	std::string key(1, (char) port);
+	key.append((const char *) &size, sizeof(size));
+	key.append((const char *) data, key_size);
+	return key;
+}
+
 MIDIPlayer::MIDIPlayer()
 {
 	uSamplesRemaining = 0;
@@ -110,6 +229,8 @@ bool MIDIPlayer::Load(const midi_container & midi_file, unsigned subsong, unsign
 			}
 		}
 
+		BuildChaseIndex();
+
 		if (uSampleRate != 1000)
 		{
 			unsigned long rate = uSampleRate;
@@ -123,6 +244,129 @@ bool MIDIPlayer::Load(const midi_container & midi_file, unsigned subsong, unsign
 	return false;
 }
 
+void MIDIPlayer::BuildChaseIndex()
+{
+	std::map<uint32_t, unsigned long> last_keyed;
+	std::map<std::string, unsigned long> last_sysex;
+	std::map<uint32_t, std::deque<unsigned long> > notes_playing;
+	std::set<unsigned long> in_effect;
+
+	mChaseLink.assign(mStream.size(), ~0UL);
+	mChaseCheckpoints.clear();
+
+	for (unsigned long i = 0; i < mStream.size(); i++)
+	{
+		if (i && !(i % chase_interval))
+		{
+			chase_checkpoint checkpoint;
+			checkpoint.position = i;
+			checkpoint.events.assign(in_effect.begin(), in_effect.end());
+			mChaseCheckpoints.push_back(checkpoint);
+		}
+
+		uint32_t ev = mStream[i].m_event;
+		uint32_t key = 0;
+
+		switch (chase_classify(ev, key))
+		{
+		case chase_note_on:
+			notes_playing[key].push_back(i);
+			in_effect.insert(i);
+			break;
+
+		case chase_note_off:
+			{
+				std::deque<unsigned long> & playing = notes_playing[key];
+				if (playing.size())
+				{
+					unsigned long on = playing.front();
+					playing.pop_front();
+					mChaseLink[on] = i;
+					mChaseLink[i] = on;
+					in_effect.erase(on);
+				}
+			}
+			break;
+
+		case chase_sysex:
+			{
+				bool reset;
+				std::string sysex_key = sysex_chase_key(mSysexMap, ev, reset);
+				if (reset)
+				{
+					// everything before on the port ends here, but the notes
+					uint32_t port = (uint8_t) sysex_key[0];
+					for (std::set<unsigned long>::iterator it = in_effect.begin(); it != in_effect.end(); )
+					{
+						uint32_t other = mStream[*it].m_event;
+						if ((other & 0x800000F0) != 0x90 && chase_port(mSysexMap, other) == port)
+						{
+							mChaseLink[*it] = i;
+							in_effect.erase(it++);
+						}
+						else ++it;
+					}
+					last_sysex.erase(last_sysex.lower_bound(sysex_key.substr(0, 1)), last_sysex.lower_bound(std::string(1, (char) (port + 1))));
+				}
+				else
+				{
+					std::map<std::string, unsigned long>::iterator it = last_sysex.find(sysex_key);
+					if (it != last_sysex.end())
+					{
+						mChaseLink[it->second] = i;
+						in_effect.erase(it->second);
+					}
+				}
+				last_sysex[sysex_key] = i;
+				// keep controllers from either side of it in order
+				last_keyed.clear();
+				in_effect.insert(i);
+			}
+			break;
+
+		case chase_fixed:
+			if (((ev >> 8) & 0x7F) == 121)
+			{
+				// reset all controllers, keep whatever came before
+				last_keyed.erase(last_keyed.lower_bound(key), last_keyed.lower_bound(key + 512));
+			}
+			in_effect.insert(i);
+			break;
+
+		case chase_keyed:
+			if ((key & 511) == 128)
+			{
+				// program changes latch the bank select
+				last_keyed.erase(key - 128);
+				last_keyed.erase(key - 128 + 32);
+			}
+			{
+				std::map<uint32_t, unsigned long>::iterator it = last_keyed.find(key);
+				if (it != last_keyed.end())
+				{
+					mChaseLink[it->second] = i;
+					in_effect.erase(it->second);
+				}
+			}
+			last_keyed[key] = i;
+			in_effect.insert(i);
+			break;
+		}
+	}
+}
+
+unsigned long MIDIPlayer::FindStreamPosition(unsigned long time, unsigned long start) const
+{
+	unsigned long lo = start, hi = mStream.size();
+	while (lo < hi)
+	{
+		unsigned long mid = lo + (hi - lo) / 2;
+		if (mStream[mid].m_timestamp < time) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
 unsigned long MIDIPlayer::Play(float * out, unsigned long count)
 {
 	assert(mStream.size());
@@ -147,9 +391,7 @@ unsigned long MIDIPlayer::Play(float * out, unsigned long count)
 		if (todo > count - done) todo = count - done;
 
 		unsigned long time_target = todo + uTimeCurrent;
-		unsigned long stream_end = uStreamPosition;
-
-		while (stream_end < mStream.size() && mStream[stream_end].m_timestamp < time_target) stream_end++;
+		unsigned long stream_end = FindStreamPosition(time_target, uStreamPosition);
 
 		if (stream_end > uStreamPosition)
 		{
@@ -238,72 +480,77 @@ void MIDIPlayer::Seek(unsigned long sample)
 		}
 	}
 
+	unsigned long stream_target = FindStreamPosition(sample, 0);
+	unsigned long stream_start = uStreamPosition;
+
+	const std::vector<unsigned long> * chase = NULL;
+
 	if (uTimeCurrent > sample)
 	{
 		// hokkai, let's kill any hanging notes
-		uStreamPosition = 0;
-
 		shutdown();
+
+		// and pick up from the nearest checkpoint
+		stream_start = 0;
+		for (unsigned long i = mChaseCheckpoints.size(); i--; )
+		{
+			if (mChaseCheckpoints[i].position <= stream_target)
+			{
+				stream_start = mChaseCheckpoints[i].position;
+				chase = &mChaseCheckpoints[i].events;
+				break;
+			}
+		}
 	}
 
 	if (!startup()) return;
 
 	uTimeCurrent = sample;
+	uStreamPosition = stream_target;
 
-	std::vector<midi_stream_event> filler;
-
-	unsigned long stream_start = uStreamPosition;
-
-	for (; uStreamPosition < mStream.size() && mStream[uStreamPosition].m_timestamp < uTimeCurrent; uStreamPosition++);
+	if (uStreamPosition < mStream.size())
+		uSamplesRemaining = mStream[uStreamPosition].m_timestamp - uTimeCurrent;
+	else
+		uSamplesRemaining = uTimeEnd - uTimeCurrent;
 
-	uSamplesRemaining = mStream[uStreamPosition].m_timestamp - uTimeCurrent;
+	// Everything still in effect at the target, in stream order: notes
+	// still playing, and the last of each controller, program, etc.
+	std::vector<unsigned long> filler;
 
-	if (uStreamPosition > stream_start)
+	if (chase)
 	{
-		filler.resize( uStreamPosition - stream_start );
-		filler.assign( &mStream[stream_start], &mStream[uStreamPosition] );
-
-		unsigned long i, j;
-		midi_stream_event * me = &filler[0];
-
-		for (i = 0, stream_start = uStreamPosition - stream_start; i < stream_start; i++)
+		for (unsigned long i = 0; i < chase->size(); i++)
 		{
-			midi_stream_event & e = me[i];
-			if ((e.m_event & 0x800000F0) == 0x90 && (e.m_event & 0xFF0000)) // note on
-			{
-				if ((e.m_event & 0x0F) == 9) // hax
-				{
-					e.m_event = 0;
-					continue;
-				}
-				uint32_t m = (e.m_event & 0x7F00FF0F) | 0x80; // note off
-				uint32_t m2 = e.m_event & 0x7F00FFFF; // also note off
-				for (j = i + 1; j < stream_start; j++)
-				{
-					midi_stream_event & e2 = me[j];
-					if ((e2.m_event & 0xFF00FFFF) == m || e2.m_event == m2)
-					{
-						// kill 'em
-						e.m_event = 0;
-						e2.m_event = 0;
-						break;
-					}
-				}
-			}
+			unsigned long j = (*chase)[i];
+			if (mChaseLink[j] >= stream_target)
+				filler.push_back(j);
 		}
-        
-        float temp[32];
-        bool needs_time = send_event_needs_time();
+	}
 
-		for (i = 0; i < stream_start; i++)
+	for (unsigned long i = stream_start; i < stream_target; i++)
+	{
+		if (mChaseLink[i] < stream_target)
 		{
-			if (me[i].m_event)
-            {
-				send_event(me[i].m_event);
-                if (needs_time)
-                    render(temp, 16);
-            }
+			// ended before the target, unless it's the note off for a note
+			// already playing before the seek
+			uint32_t type = mStream[i].m_event & 0x800000F0;
+			if (chase || mChaseLink[i] >= stream_start || (type != 0x80 && type != 0x90))
+				continue;
 		}
+		filler.push_back(i);
+	}
+
+	float temp[32];
+	bool needs_time = send_event_needs_time();
+
+	for (unsigned long i = 0; i < filler.size(); i++)
+	{
+		uint32_t ev = mStream[filler[i]].m_event;
+		if ((ev & 0x800000F0) == 0x90 && (ev & 0xFF0000) && (ev & 0x0F) == 9) // hax
+			continue;
+		send_event(ev);
+		if (needs_time)
+			render(temp, 16);
 	}
 }
 
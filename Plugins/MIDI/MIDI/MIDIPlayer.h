@@ -51,6 +51,24 @@ private:
 	unsigned long      uStreamLoopStart;
 	unsigned long      uTimeLoopStart;
     unsigned long      uStreamEnd;
+
+	// Seek index. For each event, the index of the event which ends its
+	// effect: the note off for a note on, the note on for a note off, the
+	// next event setting the same controller, program, etc., or the next
+	// sysex of the same kind or device reset. ~0 if none.
+	std::vector<unsigned long> mChaseLink;
+
+	// Events still in effect at evenly spaced stream positions, so a seek
+	// only replays from the nearest checkpoint.
+	struct chase_checkpoint
+	{
+		unsigned long position;
+		std::vector<unsigned long> events;
+	};
+	std::vector<chase_checkpoint> mChaseCheckpoints;
+
+	void BuildChaseIndex();
+	unsigned long FindStreamPosition(unsigned long time, unsigned long start) const;
 };
 
 #endif
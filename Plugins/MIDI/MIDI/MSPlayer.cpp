@@ -3,9 +3,16 @@
 
 #include "MSPlayer.h"
 
+enum { render_block = 256 };
+
 MSPlayer::MSPlayer()
 {
-    synth = 0;
+    chips = 1;
+    threaded = false;
+    worker_generation = 0;
+    worker_todo = 0;
+    workers_busy = 0;
+    workers_quit = false;
 }
 
 MSPlayer::~MSPlayer()
@@ -31,26 +38,80 @@ void MSPlayer::set_extp(unsigned int extp)
     this->extp = extp;
 }
 
+void MSPlayer::set_chips(unsigned int chips, bool threaded)
+{
+    shutdown();
+    this->chips = chips ? chips : 1;
+    this->threaded = threaded;
+}
+
 void MSPlayer::send_event(uint32_t b)
 {
 	if (!(b & 0x80000000))
 	{
-        synth->midi_write(b);
+        unsigned int channel = ((b >> 24) & 0x7F) * 16 + (b & 0x0F);
+        synths[channel % synths.size()]->midi_write(b);
 	}
 }
 
+void MSPlayer::worker_run(unsigned int index)
+{
+    unsigned long generation = 0;
+    for (;;)
+    {
+        unsigned long todo;
+        {
+            std::unique_lock<std::mutex> lock(worker_lock);
+            worker_start.wait(lock, [&]{ return workers_quit || worker_generation != generation; });
+            if (workers_quit) return;
+            generation = worker_generation;
+            todo = worker_todo;
+        }
+        
+        synths[index]->midi_generate(&buffers[index * render_block * 2], (unsigned int)todo);
+        
+        {
+            std::lock_guard<std::mutex> lock(worker_lock);
+            if (!--workers_busy) worker_done.notify_one();
+        }
+    }
+}
+
 void MSPlayer::render(float * out, unsigned long count)
 {
     float const scaler = 1.0f / 8192.0f;
-    short buffer[512];
+    unsigned int synth_count = (unsigned int)synths.size();
     while (count)
     {
-        unsigned long todo = count > 256 ? 256 : count;
-        synth->midi_generate(buffer, (unsigned int)todo);
-        for (unsigned long i = 0; i < todo; ++i)
+        unsigned long todo = count > render_block ? render_block : count;
+        
+        // The chips run in lockstep, one block at a time
+        if (workers.size())
+        {
+            std::lock_guard<std::mutex> lock(worker_lock);
+            worker_todo = todo;
+            workers_busy = (unsigned int)workers.size();
+            ++worker_generation;
+            worker_start.notify_all();
+        }
+        
+        unsigned int serial_count = workers.size() ? 1 : synth_count;
+        for (unsigned int j = 0; j < serial_count; ++j)
+            synths[j]->midi_generate(&buffers[j * render_block * 2], (unsigned int)todo);
+        
+        if (workers.size())
         {
-            *out++ = buffer[i * 2 + 0] * scaler;
-            *out++ = buffer[i * 2 + 1] * scaler;
+            std::unique_lock<std::mutex> lock(worker_lock);
+            worker_done.wait(lock, [&]{ return workers_busy == 0; });
+        }
+        
+        // Mixed in chip order, so threading doesn't change the output
+        for (unsigned long i = 0; i < todo * 2; ++i)
+        {
+            float sample = 0;
+            for (unsigned int j = 0; j < synth_count; ++j)
+                sample += buffers[j * render_block * 2 + i] * scaler;
+            *out++ = sample;
         }
         count -= todo;
     }
@@ -58,30 +119,67 @@ void MSPlayer::render(float * out, unsigned long count)
 
 void MSPlayer::shutdown()
 {
-    delete synth;
-    synth = 0;
+    if (workers.size())
+    {
+        {
+            std::lock_guard<std::mutex> lock(worker_lock);
+            workers_quit = true;
+            worker_start.notify_all();
+        }
+        for (unsigned int i = 0; i < workers.size(); ++i)
+            workers[i].join();
+        workers.clear();
+        workers_quit = false;
+    }
+    
+    for (unsigned int i = 0; i < synths.size(); ++i)
+        delete synths[i];
+    synths.clear();
 }
 
 bool MSPlayer::startup()
 {
-    if (synth) return true;
+    if (synths.size()) return true;
     
-    switch (synth_id)
+    for (unsigned int i = 0; i < chips; ++i)
     {
-        default:
-        case 0:
-            synth = getsynth_doom();
-            break;
-            
-        case 1:
-            synth = getsynth_opl3w();
-            break;
+        midisynth * synth;
+        
+        switch (synth_id)
+        {
+            default:
+            case 0:
+                synth = getsynth_doom();
+                break;
+                
+            case 1:
+                synth = getsynth_opl3w();
+                break;
+        }
+        
+        if (!synth)
+        {
+            shutdown();
+            return false;
+        }
+        
+        synths.push_back(synth);
+        
+        if (!synth->midi_init((unsigned int)uSampleRate, bank_id, extp))
+        {
+            shutdown();
+            return false;
+        }
     }
     
-    if (!synth) return false;
+    buffers.resize(chips * render_block * 2);
     
-    if (!synth->midi_init((unsigned int)uSampleRate, bank_id, extp))
-        return false;
+    if (threaded && chips > 1)
+    {
+        worker_generation = 0;
+        for (unsigned int i = 1; i < chips; ++i)
+            workers.push_back(std::thread(&MSPlayer::worker_run, this, i));
+    }
     
 	return true;
 }
@@ -5,6 +5,11 @@
 
 #include "interface.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 class midisynth;
 
 class MSPlayer : public MIDIPlayer
@@ -20,6 +25,10 @@ public:
     void set_bank(unsigned int bank);
     void set_extp(unsigned int extp);
     
+    // Channels are spread over this many synth instances, each with its own
+    // chip, optionally rendered on one thread per extra chip
+    void set_chips(unsigned int chips, bool threaded);
+    
     typedef void (*enum_callback)(unsigned int synth, unsigned int bank, const char * name);
     
     void enum_synthesizers(enum_callback callback);
@@ -35,7 +44,21 @@ private:
     unsigned int synth_id;
     unsigned int bank_id;
     unsigned int extp;
-    midisynth * synth;
+    unsigned int chips;
+    bool threaded;
+    std::vector<midisynth *> synths;
+    std::vector<short> buffers;
+    
+    std::vector<std::thread> workers;
+    std::mutex worker_lock;
+    std::condition_variable worker_start;
+    std::condition_variable worker_done;
+    unsigned long worker_generation;
+    unsigned long worker_todo;
+    unsigned int workers_busy;
+    bool workers_quit;
+    
+    void worker_run(unsigned int index);
 };
 
 #endif
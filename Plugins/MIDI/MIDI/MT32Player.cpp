@@ -110,6 +110,7 @@ bool MT32Player::startup()
 		_synth = 0;
 		return false;
 	}
+	_synth->setPartialRenderer( MT32Emu::PartialRenderer_VECTOR );
 	reset();
 	return true;
 }
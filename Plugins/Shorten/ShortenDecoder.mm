@@ -24,7 +24,10 @@
 		return NO;
 	}
 	
-	decoder->open([[url path] UTF8String], true);
+	// Files without a seek table get one built while they play, which can
+	// optionally be saved next to the file for next time
+	decoder->open([[url path] UTF8String], true,
+				  [[NSUserDefaults standardUserDefaults] boolForKey:@"shorten.saveSeekTables"]);
 	
 	bufferSize = decoder->shn_get_buffer_block_size(NUM_DEFAULT_BUFFER_BLOCKS);
 	
@@ -60,11 +63,7 @@
 
 - (long)seek:(long)sample
 {
-	unsigned int sec = sample/frequency;
-		
-	decoder->seek(sec);
-	
-	return sample;
+	return decoder->seek_sample(sample);
 }
 
 - (void)close
@@ -7,23 +7,25 @@
 //
 
 #import "TagLibMetadataReader.h"
-#import <taglib/fileref.h>
-#import <taglib/tag.h>
-#import <taglib/mpeg/mpegfile.h>
-#import <taglib/mp4/mp4file.h>
-#import <taglib/mpeg/id3v2/id3v2tag.h>
-#import <taglib/mpeg/id3v2/frames/attachedpictureframe.h>
+#import "TagLibScanner.h"
+#import <taglib/toolkit/tstring.h>
+
+static TagLibScanner *scanner = NULL;
+
+// Results of the last prefetch, taken as each file is asked for
+static NSMutableDictionary *prefetched = nil;
+
+// Directory path to the cover file name found in it, or NSNull, along with
+// the directory's modification date when it was listed
+static NSCache *coverFileNames = nil;
 
 @implementation TagLibMetadataReader
 
-+ (NSDictionary *)metadataForURL:(NSURL *)url
++ (void)initialize
 {
-	if (![url isFileURL]) {
-		return [NSDictionary dictionary];
-	}
-	
-	NSMutableDictionary *dict = [[NSMutableDictionary alloc] init];
-	
+	if (self != [TagLibMetadataReader class])
+		return;
+
 	if ( !*TagLib::ascii_encoding ) {
 		NSStringEncoding enc = [NSString defaultCStringEncoding];
 		CFStringEncoding cfenc = CFStringConvertNSStringEncodingToEncoding(enc);
@@ -57,115 +59,160 @@
 			strcpy(TagLib::ascii_encoding, [ref UTF8String]);
 	
 	}
+
+	// Tags decoded with a different codepage are not the same tags, so
+	// each gets its own cache
+	NSString *cacheFolder = [[NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0] stringByAppendingPathComponent:@"Cog"];
+	[[NSFileManager defaultManager] createDirectoryAtPath:cacheFolder withIntermediateDirectories:YES attributes:nil error:nil];
+	NSString *cacheName = [NSString stringWithFormat:@"TagLib-%s.cache", TagLib::ascii_encoding];
+
+	scanner = new TagLibScanner([[cacheFolder stringByAppendingPathComponent:cacheName] fileSystemRepresentation]);
+	prefetched = [[NSMutableDictionary alloc] init];
+	coverFileNames = [[NSCache alloc] init];
+	[coverFileNames setCountLimit:256];
+
+	[[NSNotificationCenter defaultCenter] addObserverForName:NSApplicationWillTerminateNotification object:nil queue:nil usingBlock:^(NSNotification *note) {
+		scanner->flush();
+	}];
+}
+
++ (NSDictionary *)metadataForURL:(NSURL *)url
+{
+	if (![url isFileURL]) {
+		return [NSDictionary dictionary];
+	}
 	
-	
-	TagLib::FileRef f((const char *)[[url path] UTF8String], false);
-	if (!f.isNull())
-	{
-		const TagLib::Tag *tag = f.tag();
-		
-		if (tag)
-		{
-			TagLib::String artist, title, album, genre, comment;
-			int year, track;
-            float rgAlbumGain, rgAlbumPeak, rgTrackGain, rgTrackPeak;
-			
-			artist = tag->artist();
-			title = tag->title();;
-			album = tag->album();
-			genre = tag->genre();
-			comment = tag->comment();
-			
-			year = tag->year();
-			[dict setObject:[NSNumber numberWithInt:year] forKey:@"year"];
-			
-			track = tag->track();
-			[dict setObject:[NSNumber numberWithInt:track] forKey:@"track"];
-
-            rgAlbumGain = tag->rgAlbumGain();
-            rgAlbumPeak = tag->rgAlbumPeak();
-            rgTrackGain = tag->rgTrackGain();
-            rgTrackPeak = tag->rgTrackPeak();
-            [dict setObject:[NSNumber numberWithFloat:rgAlbumGain] forKey:@"replayGainAlbumGain"];
-            [dict setObject:[NSNumber numberWithFloat:rgAlbumPeak] forKey:@"replayGainAlbumPeak"];
-            [dict setObject:[NSNumber numberWithFloat:rgTrackGain] forKey:@"replayGainTrackGain"];
-            [dict setObject:[NSNumber numberWithFloat:rgTrackPeak] forKey:@"replayGainTrackPeak"];
-			
-			if (!artist.isNull())
-				[dict setObject:[NSString stringWithUTF8String:artist.toCString(true)] forKey:@"artist"];
+	NSString *path = [url path];
+	NSDictionary *dict;
 
-			if (!album.isNull())
-				[dict setObject:[NSString stringWithUTF8String:album.toCString(true)] forKey:@"album"];
-			
-			if (!title.isNull())
-				[dict setObject:[NSString stringWithUTF8String:title.toCString(true)] forKey:@"title"];
-			
-			if (!genre.isNull())
-				[dict setObject:[NSString stringWithUTF8String:genre.toCString(true)] forKey:@"genre"];
-		}
-		
-		// Try to load the image.
-		NSData * image = nil;
-        
-		// Try to load the image.
-		// WARNING: HACK
-		TagLib::MPEG::File *mf = dynamic_cast<TagLib::MPEG::File *>(f.file());
-		if (mf) {
-			TagLib::ID3v2::Tag *tag = mf->ID3v2Tag();
-			if (tag) {
-				TagLib::ID3v2::FrameList pictures = mf->ID3v2Tag()->frameListMap()["APIC"];
-				if (!pictures.isEmpty()) {
-					TagLib::ID3v2::AttachedPictureFrame *pic = static_cast<TagLib::ID3v2::AttachedPictureFrame *>(pictures.front());
-
-					image = [NSData dataWithBytes:pic->picture().data() length:pic->picture().size()];
-                }
-            }
-		}
+	@synchronized(prefetched) {
+		dict = [prefetched objectForKey:path];
+		if (dict)
+			[prefetched removeObjectForKey:path];
+	}
 
+	if (dict)
+		return dict;
 
-        // D-D-D-DOUBLE HACK!
-        TagLib::MP4::File *m4f = dynamic_cast<TagLib::MP4::File *>(f.file());
-        if (m4f) {
-            TagLib::MP4::Tag *tag = m4f->tag();
-            if (tag) {
-                TagLib::MP4::ItemListMap itemsListMap = tag->itemListMap();
-                if (itemsListMap.contains("covr")) {
-                    TagLib::MP4::Item coverItem = itemsListMap["covr"];
-                    TagLib::MP4::CoverArtList coverArtList = coverItem.toCoverArtList();
-                    if (!coverArtList.isEmpty()) {
-                        TagLib::MP4::CoverArt coverArt = coverArtList.front();
-                        image = [NSData dataWithBytes:coverArt.data().data() length:coverArt.data().size()];
-                    }
-                }
-            }
-        }
-
-        if (nil == image) {
-			// Try to load image from external file
-
-			NSString *path = [[url path] stringByDeletingLastPathComponent];
-
-				// Gather list of candidate image files
-				
-			NSArray *fileNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:path error:nil];
-			NSArray *imageFileNames = [fileNames pathsMatchingExtensions:[NSImage imageFileTypes]];
-
-            for (NSString *fileName in imageFileNames) {
-				if ([TagLibMetadataReader isCoverFile:fileName]) {
-					image = [NSData dataWithContentsOfFile:[path stringByAppendingPathComponent:fileName]];
-					break;
-				}
-			}
-		}
-		
-		if (nil != image) {
-			[dict setObject:image forKey:@"albumArt"];
+	TagLibScanner::Tags tags;
+	scanner->scan(std::string([path UTF8String]), tags, TagLibScanner::ScanCoverArt);
+
+	return [TagLibMetadataReader metadataForPath:path tags:tags];
+}
+
++ (void)prefetchMetadataForURLs:(NSArray *)urls
+{
+	NSMutableArray *keys = [NSMutableArray arrayWithCapacity:[urls count]];
+	std::vector<std::string> paths;
+
+	for (NSURL *url in urls) {
+		if ([url isFileURL]) {
+			[keys addObject:[url path]];
+			paths.push_back([[url path] UTF8String]);
 		}
 	}
 
+	if (paths.empty())
+		return;
+
+	// The playlist keeps the art of every entry, so it is read here too
+	std::vector<TagLibScanner::Tags> results;
+	scanner->scan(paths, results, TagLibScanner::ScanCoverArt);
+	scanner->flush();
+
+	NSMutableDictionary *batch = [NSMutableDictionary dictionaryWithCapacity:[keys count]];
+	for (size_t i = 0; i < results.size(); ++i) {
+		NSString *path = [keys objectAtIndex:i];
+		[batch setObject:[TagLibMetadataReader metadataForPath:path tags:results[i]] forKey:path];
+	}
+
+	@synchronized(prefetched) {
+		[prefetched removeAllObjects];
+		[prefetched addEntriesFromDictionary:batch];
+	}
+}
+
++ (NSDictionary *)metadataForPath:(NSString *)path tags:(const TagLibScanner::Tags &)tags
+{
+	NSMutableDictionary *dict = [[NSMutableDictionary alloc] init];
+
+	if (!(tags.flags & TagLibScanner::Valid))
+		return dict;
+
+	if (tags.flags & TagLibScanner::HasTag)
+	{
+		[dict setObject:[NSNumber numberWithInt:tags.year] forKey:@"year"];
+		[dict setObject:[NSNumber numberWithInt:tags.track] forKey:@"track"];
+
+		[dict setObject:[NSNumber numberWithFloat:tags.rgAlbumGain] forKey:@"replayGainAlbumGain"];
+		[dict setObject:[NSNumber numberWithFloat:tags.rgAlbumPeak] forKey:@"replayGainAlbumPeak"];
+		[dict setObject:[NSNumber numberWithFloat:tags.rgTrackGain] forKey:@"replayGainTrackGain"];
+		[dict setObject:[NSNumber numberWithFloat:tags.rgTrackPeak] forKey:@"replayGainTrackPeak"];
+
+		if (tags.flags & TagLibScanner::HasArtist)
+			[dict setObject:[NSString stringWithUTF8String:tags.artist.c_str()] forKey:@"artist"];
+
+		if (tags.flags & TagLibScanner::HasAlbum)
+			[dict setObject:[NSString stringWithUTF8String:tags.album.c_str()] forKey:@"album"];
+
+		if (tags.flags & TagLibScanner::HasTitle)
+			[dict setObject:[NSString stringWithUTF8String:tags.title.c_str()] forKey:@"title"];
+
+		if (tags.flags & TagLibScanner::HasGenre)
+			[dict setObject:[NSString stringWithUTF8String:tags.genre.c_str()] forKey:@"genre"];
+	}
+
+	NSData *image = nil;
+
+	if (!tags.coverArt.empty()) {
+		image = [NSData dataWithBytes:tags.coverArt.data() length:tags.coverArt.size()];
+	}
+	else {
+		// Try to load image from external file
+		NSString *folder = [path stringByDeletingLastPathComponent];
+		NSString *fileName = [TagLibMetadataReader coverFileInFolder:folder];
+		if (fileName)
+			image = [NSData dataWithContentsOfFile:[folder stringByAppendingPathComponent:fileName]];
+	}
+
+	if (nil != image) {
+		[dict setObject:image forKey:@"albumArt"];
+	}
+
 	return dict;
 }
 
+// Listing the folder for every track of an album is most of the cost of
+// adding files without embedded art, so the answer is kept until the
+// folder changes
++ (NSString *)coverFileInFolder:(NSString *)path
+{
+	NSDate *modified = [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil] fileModificationDate];
+	NSArray *cached = [coverFileNames objectForKey:path];
+
+	if (cached && modified && [[cached objectAtIndex:0] isEqualToDate:modified]) {
+		id fileName = [cached objectAtIndex:1];
+		return fileName == [NSNull null] ? nil : fileName;
+	}
+
+	// Gather list of candidate image files
+	NSArray *fileNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:path error:nil];
+	NSArray *imageFileNames = [fileNames pathsMatchingExtensions:[NSImage imageFileTypes]];
+	NSString *coverFileName = nil;
+
+	for (NSString *fileName in imageFileNames) {
+		if ([TagLibMetadataReader isCoverFile:fileName]) {
+			coverFileName = fileName;
+			break;
+		}
+	}
+
+	if (modified)
+		[coverFileNames setObject:[NSArray arrayWithObjects:modified, coverFileName ? coverFileName : [NSNull null], nil] forKey:path];
+
+	return coverFileName;
+}
+
 + (BOOL)isCoverFile:(NSString *)fileName
 {
     for (NSString *coverFileName in [TagLibMetadataReader coverNames]) {
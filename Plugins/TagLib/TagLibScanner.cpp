@@ -0,0 +1,452 @@
+//
+//  TagLibScanner.cpp
+//  TagLib
+//
+//
+
+#include "TagLibScanner.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <thread>
+
+#include <taglib/fileref.h>
+#include <taglib/tag.h>
+#include <taglib/mpeg/mpegfile.h>
+#include <taglib/mp4/mp4file.h>
+#include <taglib/mpeg/id3v1/id3v1genres.h>
+#include <taglib/mpeg/id3v2/id3v2tag.h>
+#include <taglib/mpeg/id3v2/id3v2framefactory.h>
+#include <taglib/mpeg/id3v2/frames/attachedpictureframe.h>
+
+// Past this, more threads only queue up on the disk
+static const unsigned maxThreads = 8;
+
+static const char cacheMagic[4] = { 'C', 'T', 'L', 'C' };
+static const uint32_t cacheVersion = 1;
+
+TagLibScanner::Tags::Tags()
+	: flags(0), year(0), track(0),
+	  rgAlbumGain(0), rgAlbumPeak(0), rgTrackGain(0), rgTrackPeak(0)
+{
+}
+
+static bool statFile(const std::string &path, uint64_t &size, int64_t &mtime)
+{
+	struct stat st;
+
+	if (stat(path.c_str(), &st) != 0)
+		return false;
+
+	size = st.st_size;
+#ifdef __APPLE__
+	mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+	mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+	return true;
+}
+
+// TagLib creates these on first use without any locking
+static void warmUpTagLib()
+{
+	static std::once_flag once;
+	std::call_once(once, [] {
+		TagLib::ID3v2::FrameFactory::instance();
+		TagLib::ID3v1::genreList();
+		TagLib::ID3v1::genreMap();
+	});
+}
+
+static void copyString(const TagLib::String &in, std::string &out, unsigned flag, unsigned &flags)
+{
+	if (!in.isNull())
+	{
+		out = in.to8Bit(true);
+		flags |= flag;
+	}
+}
+
+static void readTags(const std::string &path, unsigned scanFlags, TagLibScanner::Tags &t)
+{
+	TagLib::FileRef f(path.c_str(), false);
+	if (f.isNull())
+		return;
+
+	t.flags |= TagLibScanner::Valid;
+
+	const TagLib::Tag *tag = f.tag();
+	if (tag)
+	{
+		t.flags |= TagLibScanner::HasTag;
+
+		copyString(tag->artist(), t.artist, TagLibScanner::HasArtist, t.flags);
+		copyString(tag->album(), t.album, TagLibScanner::HasAlbum, t.flags);
+		copyString(tag->title(), t.title, TagLibScanner::HasTitle, t.flags);
+		copyString(tag->genre(), t.genre, TagLibScanner::HasGenre, t.flags);
+
+		t.year = tag->year();
+		t.track = tag->track();
+
+		t.rgAlbumGain = tag->rgAlbumGain();
+		t.rgAlbumPeak = tag->rgAlbumPeak();
+		t.rgTrackGain = tag->rgTrackGain();
+		t.rgTrackPeak = tag->rgTrackPeak();
+	}
+
+	// The frames and items are parsed with the tag anyway, so finding out
+	// whether there is a picture is free. Copying it out is not.
+	TagLib::MPEG::File *mf = dynamic_cast<TagLib::MPEG::File *>(f.file());
+	if (mf)
+	{
+		TagLib::ID3v2::Tag *id3v2 = mf->ID3v2Tag();
+		if (id3v2)
+		{
+			const TagLib::ID3v2::FrameListMap &frames = id3v2->frameListMap();
+			TagLib::ID3v2::FrameListMap::ConstIterator it = frames.find("APIC");
+			if (it != frames.end() && !it->second.isEmpty())
+			{
+				t.flags |= TagLibScanner::HasCoverArt;
+				if (scanFlags & TagLibScanner::ScanCoverArt)
+				{
+					TagLib::ID3v2::AttachedPictureFrame *pic = static_cast<TagLib::ID3v2::AttachedPictureFrame *>(it->second.front());
+					TagLib::ByteVector picture = pic->picture();
+					t.coverArt.assign(picture.data(), picture.size());
+				}
+			}
+		}
+	}
+
+	TagLib::MP4::File *m4f = dynamic_cast<TagLib::MP4::File *>(f.file());
+	if (m4f)
+	{
+		TagLib::MP4::Tag *mp4 = m4f->tag();
+		if (mp4)
+		{
+			TagLib::MP4::ItemListMap &items = mp4->itemListMap();
+			TagLib::MP4::ItemListMap::Iterator it = items.find("covr");
+			if (it != items.end())
+			{
+				TagLib::MP4::CoverArtList coverArtList = it->second.toCoverArtList();
+				if (!coverArtList.isEmpty())
+				{
+					t.flags |= TagLibScanner::HasCoverArt;
+					if (scanFlags & TagLibScanner::ScanCoverArt)
+					{
+						TagLib::ByteVector picture = coverArtList.front().data();
+						t.coverArt.assign(picture.data(), picture.size());
+					}
+				}
+			}
+		}
+	}
+}
+
+static void readAllTags(const std::vector<std::string> &paths, const std::vector<size_t> &work, std::vector<TagLibScanner::Tags> &results, unsigned scanFlags)
+{
+	unsigned threadCount = std::thread::hardware_concurrency();
+	if (threadCount > maxThreads)
+		threadCount = maxThreads;
+	if (threadCount > work.size())
+		threadCount = (unsigned)work.size();
+	if (threadCount < 1)
+		threadCount = 1;
+
+	warmUpTagLib();
+
+	std::atomic<size_t> next(0);
+	auto worker = [&] {
+		size_t i;
+		while ((i = next.fetch_add(1, std::memory_order_relaxed)) < work.size())
+			readTags(paths[work[i]], scanFlags, results[work[i]]);
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned i = 1; i < threadCount; ++i)
+		threads.emplace_back(worker);
+	worker();
+	for (std::thread &thread : threads)
+		thread.join();
+}
+
+// Cache file: the magic and version, then one record after another. A path
+// scanned again is appended again, and the last copy wins when loading.
+//
+// Record: u32 path length, path, u64 size, i64 mtime, u32 flags,
+// i32 year, i32 track, 4 x f32 ReplayGain, then u32 length and bytes for
+// each of artist, album, title and genre. Native byte order, as the file
+// never leaves the machine.
+
+static void putBytes(std::string &out, const void *data, size_t size)
+{
+	out.append((const char *)data, size);
+}
+
+template <typename T>
+static void put(std::string &out, T value)
+{
+	putBytes(out, &value, sizeof(value));
+}
+
+static void putString(std::string &out, const std::string &value)
+{
+	put<uint32_t>(out, (uint32_t)value.size());
+	out.append(value);
+}
+
+template <typename T>
+static bool get(const char *&in, const char *end, T &value)
+{
+	if ((size_t)(end - in) < sizeof(value))
+		return false;
+	memcpy(&value, in, sizeof(value));
+	in += sizeof(value);
+	return true;
+}
+
+static bool getString(const char *&in, const char *end, std::string &value)
+{
+	uint32_t size;
+	if (!get(in, end, size) || (size_t)(end - in) < size)
+		return false;
+	value.assign(in, size);
+	in += size;
+	return true;
+}
+
+static void putRecord(std::string &out, const std::string &path, uint64_t size, int64_t mtime, const TagLibScanner::Tags &t)
+{
+	putString(out, path);
+	put(out, size);
+	put(out, mtime);
+	put<uint32_t>(out, t.flags);
+	put<int32_t>(out, t.year);
+	put<int32_t>(out, t.track);
+	put(out, t.rgAlbumGain);
+	put(out, t.rgAlbumPeak);
+	put(out, t.rgTrackGain);
+	put(out, t.rgTrackPeak);
+	putString(out, t.artist);
+	putString(out, t.album);
+	putString(out, t.title);
+	putString(out, t.genre);
+}
+
+static bool getRecord(const char *&in, const char *end, std::string &path, uint64_t &size, int64_t &mtime, TagLibScanner::Tags &t)
+{
+	uint32_t flags;
+	int32_t year, track;
+
+	if (!getString(in, end, path) ||
+	    !get(in, end, size) || !get(in, end, mtime) ||
+	    !get(in, end, flags) || !get(in, end, year) || !get(in, end, track) ||
+	    !get(in, end, t.rgAlbumGain) || !get(in, end, t.rgAlbumPeak) ||
+	    !get(in, end, t.rgTrackGain) || !get(in, end, t.rgTrackPeak) ||
+	    !getString(in, end, t.artist) || !getString(in, end, t.album) ||
+	    !getString(in, end, t.title) || !getString(in, end, t.genre))
+		return false;
+
+	t.flags = flags;
+	t.year = year;
+	t.track = track;
+	return true;
+}
+
+TagLibScanner::TagLibScanner(const char *path)
+	: recordsInFile(0), rewrite(false)
+{
+	if (path)
+	{
+		cachePath = path;
+		load();
+	}
+}
+
+TagLibScanner::~TagLibScanner()
+{
+	flush();
+}
+
+void TagLibScanner::load()
+{
+	FILE *f = fopen(cachePath.c_str(), "rb");
+	if (!f)
+		return;
+
+	std::string data;
+	char buffer[65536];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		data.append(buffer, count);
+	fclose(f);
+
+	const char *in = data.data();
+	const char *end = in + data.size();
+	uint32_t version;
+
+	if ((size_t)(end - in) < sizeof(cacheMagic) || memcmp(in, cacheMagic, sizeof(cacheMagic)) != 0)
+	{
+		rewrite = true;
+		return;
+	}
+	in += sizeof(cacheMagic);
+	if (!get(in, end, version) || version != cacheVersion)
+	{
+		rewrite = true;
+		return;
+	}
+
+	std::string recordPath;
+	Record record;
+	while (in < end)
+	{
+		if (!getRecord(in, end, recordPath, record.size, record.mtime, record.tags))
+		{
+			// Cut short while being written. Appending after it would
+			// misalign everything that follows.
+			rewrite = true;
+			break;
+		}
+		records[recordPath] = record;
+		++recordsInFile;
+	}
+}
+
+bool TagLibScanner::save(bool compact)
+{
+	std::string out;
+
+	if (compact)
+	{
+		std::string tempPath = cachePath + ".tmp";
+		FILE *f = fopen(tempPath.c_str(), "wb");
+		if (!f)
+			return false;
+
+		putBytes(out, cacheMagic, sizeof(cacheMagic));
+		put(out, cacheVersion);
+		for (const auto &it : records)
+			putRecord(out, it.first, it.second.size, it.second.mtime, it.second.tags);
+
+		bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+		ok = (fclose(f) == 0) && ok;
+		if (!ok || rename(tempPath.c_str(), cachePath.c_str()) != 0)
+		{
+			remove(tempPath.c_str());
+			return false;
+		}
+
+		recordsInFile = records.size();
+		return true;
+	}
+
+	FILE *f = fopen(cachePath.c_str(), "ab");
+	if (!f)
+		return false;
+
+	fseek(f, 0, SEEK_END);
+	if (ftell(f) == 0)
+	{
+		putBytes(out, cacheMagic, sizeof(cacheMagic));
+		put(out, cacheVersion);
+	}
+	for (const std::string &path : unsaved)
+	{
+		auto it = records.find(path);
+		if (it != records.end())
+			putRecord(out, path, it->second.size, it->second.mtime, it->second.tags);
+	}
+
+	bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+	ok = (fclose(f) == 0) && ok;
+
+	recordsInFile += unsaved.size();
+	return ok;
+}
+
+void TagLibScanner::flush()
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (cachePath.empty() || unsaved.empty())
+		return;
+
+	// Rewrite the file once stale copies make up most of it
+	bool compact = rewrite || recordsInFile + unsaved.size() > records.size() * 2 + 1024;
+
+	if (save(compact))
+		rewrite = false;
+	else
+		rewrite = true;
+
+	unsaved.clear();
+}
+
+void TagLibScanner::scan(const std::vector<std::string> &paths, std::vector<Tags> &results, unsigned scanFlags)
+{
+	std::vector<uint64_t> sizes(paths.size());
+	std::vector<int64_t> mtimes(paths.size());
+	std::vector<char> found(paths.size());
+	std::vector<size_t> work;
+
+	results.assign(paths.size(), Tags());
+
+	for (size_t i = 0; i < paths.size(); ++i)
+		found[i] = statFile(paths[i], sizes[i], mtimes[i]);
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			if (found[i])
+			{
+				auto it = records.find(paths[i]);
+				if (it != records.end() && it->second.size == sizes[i] && it->second.mtime == mtimes[i] &&
+				    (!(scanFlags & ScanCoverArt) || !(it->second.tags.flags & HasCoverArt)))
+				{
+					results[i] = it->second.tags;
+					continue;
+				}
+			}
+			work.push_back(i);
+		}
+	}
+
+	if (work.empty())
+		return;
+
+	readAllTags(paths, work, results, scanFlags);
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	for (size_t i : work)
+	{
+		if (!found[i])
+			continue;
+
+		// Keep the cover art out of the copy rather than clearing it after
+		std::string coverArt;
+		coverArt.swap(results[i].coverArt);
+
+		Record &record = records[paths[i]];
+		record.size = sizes[i];
+		record.mtime = mtimes[i];
+		record.tags = results[i];
+
+		results[i].coverArt.swap(coverArt);
+		unsaved.push_back(paths[i]);
+	}
+}
+
+void TagLibScanner::scan(const std::string &path, Tags &result, unsigned scanFlags)
+{
+	std::vector<std::string> paths(1, path);
+	std::vector<Tags> results;
+
+	scan(paths, results, scanFlags);
+	result = results[0];
+}
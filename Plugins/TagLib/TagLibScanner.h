@@ -0,0 +1,79 @@
+//
+//  TagLibScanner.h
+//  TagLib
+//
+//
+
+// Reads the basic tags of a batch of files on a small pool of threads. The
+// results are kept in a cache file, keyed by path, size and modification
+// time, so files that have not changed are not parsed again.
+//
+// Cover art is only read when asked for, and is never written to the cache.
+// The cache only records whether a file has any.
+
+#ifndef TagLibScanner_h
+#define TagLibScanner_h
+
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TagLibScanner {
+public:
+	enum {
+		ScanCoverArt = 1
+	};
+
+	enum {
+		Valid = 1,			// TagLib could open the file
+		HasTag = 2,
+		HasCoverArt = 4,	// an embedded picture, read or not
+		HasArtist = 8,
+		HasAlbum = 16,
+		HasTitle = 32,
+		HasGenre = 64
+	};
+
+	struct Tags {
+		unsigned flags;
+		int year, track;
+		float rgAlbumGain, rgAlbumPeak, rgTrackGain, rgTrackPeak;
+		std::string artist, album, title, genre;	// UTF-8
+		std::string coverArt;	// only with ScanCoverArt
+
+		Tags();
+	};
+
+	// A NULL path keeps the cache in memory only
+	explicit TagLibScanner(const char *cachePath);
+	~TagLibScanner();
+
+	// Fills one result per path, in order
+	void scan(const std::vector<std::string> &paths, std::vector<Tags> &results, unsigned scanFlags);
+	void scan(const std::string &path, Tags &result, unsigned scanFlags);
+
+	// Writes out what was scanned since the last call
+	void flush();
+
+private:
+	struct Record {
+		uint64_t size;
+		int64_t mtime;
+		Tags tags;
+	};
+
+	std::string cachePath;
+	std::mutex lock;
+	std::unordered_map<std::string, Record> records;
+	std::vector<std::string> unsaved;
+	size_t recordsInFile;
+	bool rewrite;
+
+	void load();
+	bool save(bool compact);
+};
+
+#endif
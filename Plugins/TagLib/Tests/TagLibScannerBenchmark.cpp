@@ -0,0 +1,429 @@
+//
+//  TagLibScannerBenchmark.cpp
+//  TagLib
+//
+//
+
+// Builds a synthetic corpus of tagged files and reads it the way
+// TagLibMetadataReader did, one FileRef after another with the cover art
+// copied out, then through TagLibScanner: with an empty cache, with and
+// without cover art, with the cache loaded back from disk, and after some of
+// the files have been retagged.
+//
+// Every scanner result is checked field for field against the sequential
+// read, so this doubles as the scanner's test.
+//
+// The corpus is MP3 files (a few silent frames behind an ID3v2 tag, some
+// with a picture), FLAC files (STREAMINFO and a Xiph comment) and files
+// TagLib can't open.
+//
+// usage: TagLibScannerBenchmark [files]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include <taglib/fileref.h>
+#include <taglib/tag.h>
+#include <taglib/flac/flacfile.h>
+#include <taglib/mpeg/mpegfile.h>
+#include <taglib/mpeg/id3v2/id3v2tag.h>
+#include <taglib/mpeg/id3v2/frames/attachedpictureframe.h>
+#include <taglib/ogg/xiphcomment.h>
+
+#include "../TagLibScanner.h"
+
+typedef TagLibScanner::Tags Tags;
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t corpusRandom = 0x2545F491;
+
+static uint32_t nextRandom()
+{
+	corpusRandom ^= corpusRandom << 13;
+	corpusRandom ^= corpusRandom >> 17;
+	corpusRandom ^= corpusRandom << 5;
+	return corpusRandom;
+}
+
+static bool writeFile(const std::string &path, const std::string &data)
+{
+	FILE *f = fopen(path.c_str(), "wb");
+	if (!f)
+		return false;
+	bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+	return (fclose(f) == 0) && ok;
+}
+
+// MPEG-1 layer III, 128 kbps, 44.1 kHz, all zero side info and data
+static std::string silentMP3(int frames)
+{
+	std::string frame(417, '\0');
+	frame[0] = (char)0xFF;
+	frame[1] = (char)0xFB;
+	frame[2] = (char)0x90;
+	frame[3] = (char)0x44;
+
+	std::string data;
+	for (int i = 0; i < frames; ++i)
+		data += frame;
+	return data;
+}
+
+// fLaC, a last STREAMINFO block for 44.1 kHz 16-bit stereo, one frame's
+// worth of junk after it
+static std::string emptyFLAC()
+{
+	static const unsigned char streamInfo[34] = {
+		0x10, 0x00, 0x10, 0x00,			// block size 4096
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00,	// frame sizes unknown
+		0x0A, 0xC4, 0x42, 0xF0,			// 44100 Hz, 2 channels, 16 bits
+		0x00, 0x00, 0x10, 0x00,			// 4096 samples
+	};
+
+	std::string data("fLaC");
+	data += (char)0x80;
+	data += (char)0x00;
+	data += (char)0x00;
+	data += (char)sizeof(streamInfo);
+	data.append((const char *)streamInfo, sizeof(streamInfo));
+	data.append(256, '\0');
+	return data;
+}
+
+static TagLib::String randomWords(const char *prefix, int words)
+{
+	static const char *const dictionary[] = {
+		"blue", "night", "river", "echo", "glass", "summer", "Øresund",
+		"signal", "dust", "crystal", "north", "ghost", "über", "harbour"
+	};
+
+	std::string s(prefix);
+	for (int i = 0; i < words; ++i)
+	{
+		s += ' ';
+		s += dictionary[nextRandom() % (sizeof(dictionary) / sizeof(dictionary[0]))];
+	}
+	return TagLib::String(s, TagLib::String::UTF8);
+}
+
+static void fillTag(TagLib::Tag *tag, int index)
+{
+	tag->setArtist(randomWords("Artist", 2));
+	tag->setAlbum(randomWords("Album", 3));
+	tag->setTitle(randomWords("Title", 1 + nextRandom() % 4));
+	if (nextRandom() % 2)
+		tag->setGenre("Electronic");
+	tag->setYear(1960 + nextRandom() % 60);
+	tag->setTrack(1 + index % 20);
+	if (nextRandom() % 3)
+	{
+		tag->setRGAlbumGain(-12.0f + (nextRandom() % 1000) / 100.0f);
+		tag->setRGAlbumPeak((nextRandom() % 1000) / 1000.0f);
+		tag->setRGTrackGain(-12.0f + (nextRandom() % 1000) / 100.0f);
+		tag->setRGTrackPeak((nextRandom() % 1000) / 1000.0f);
+	}
+}
+
+static bool makeMP3(const std::string &path, int index, bool picture)
+{
+	if (!writeFile(path, silentMP3(8)))
+		return false;
+
+	TagLib::MPEG::File f(path.c_str(), false);
+	if (!f.isValid())
+		return false;
+
+	TagLib::ID3v2::Tag *tag = f.ID3v2Tag(true);
+	fillTag(tag, index);
+
+	if (picture)
+	{
+		TagLib::ByteVector data(60000, 0);
+		for (unsigned i = 0; i < data.size(); ++i)
+			data[i] = (char)nextRandom();
+
+		TagLib::ID3v2::AttachedPictureFrame *frame = new TagLib::ID3v2::AttachedPictureFrame;
+		frame->setMimeType("image/jpeg");
+		frame->setType(TagLib::ID3v2::AttachedPictureFrame::FrontCover);
+		frame->setPicture(data);
+		tag->addFrame(frame);
+	}
+
+	return f.save(TagLib::MPEG::File::ID3v2);
+}
+
+static bool makeFLAC(const std::string &path, int index)
+{
+	if (!writeFile(path, emptyFLAC()))
+		return false;
+
+	TagLib::FLAC::File f(path.c_str(), false);
+	if (!f.isValid())
+		return false;
+
+	fillTag(f.xiphComment(true), index);
+	return f.save();
+}
+
+static bool makeJunk(const std::string &path)
+{
+	std::string data(4096, '\0');
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = (char)nextRandom();
+	return writeFile(path, data);
+}
+
+static bool makeCorpus(const std::string &dir, int count, std::vector<std::string> &paths)
+{
+	char name[64];
+
+	for (int i = 0; i < count; ++i)
+	{
+		bool ok;
+		switch (i % 10)
+		{
+			case 0:
+				snprintf(name, sizeof(name), "/%05d.mp3", i);
+				ok = makeMP3(dir + name, i, true);
+				break;
+			case 5:
+			case 6:
+				snprintf(name, sizeof(name), "/%05d.flac", i);
+				ok = makeFLAC(dir + name, i);
+				break;
+			case 9:
+				snprintf(name, sizeof(name), i % 20 == 9 ? "/%05d.mp3" : "/%05d.txt", i);
+				ok = makeJunk(dir + name);
+				break;
+			default:
+				snprintf(name, sizeof(name), "/%05d.mp3", i);
+				ok = makeMP3(dir + name, i, false);
+				break;
+		}
+		if (!ok)
+		{
+			fprintf(stderr, "couldn't make %s%s\n", dir.c_str(), name);
+			return false;
+		}
+		paths.push_back(dir + name);
+	}
+	// and one that has gone away
+	paths.push_back(dir + "/missing.mp3");
+	return true;
+}
+
+// What TagLibMetadataReader did for each file, without the Cocoa parts
+static void readSequential(const std::string &path, Tags &t)
+{
+	TagLib::FileRef f(path.c_str(), false);
+	if (f.isNull())
+		return;
+
+	t.flags |= TagLibScanner::Valid;
+
+	const TagLib::Tag *tag = f.tag();
+	if (tag)
+	{
+		t.flags |= TagLibScanner::HasTag;
+
+		TagLib::String artist = tag->artist(), album = tag->album(), title = tag->title(), genre = tag->genre();
+		if (!artist.isNull()) { t.artist = artist.to8Bit(true); t.flags |= TagLibScanner::HasArtist; }
+		if (!album.isNull()) { t.album = album.to8Bit(true); t.flags |= TagLibScanner::HasAlbum; }
+		if (!title.isNull()) { t.title = title.to8Bit(true); t.flags |= TagLibScanner::HasTitle; }
+		if (!genre.isNull()) { t.genre = genre.to8Bit(true); t.flags |= TagLibScanner::HasGenre; }
+
+		t.year = tag->year();
+		t.track = tag->track();
+		t.rgAlbumGain = tag->rgAlbumGain();
+		t.rgAlbumPeak = tag->rgAlbumPeak();
+		t.rgTrackGain = tag->rgTrackGain();
+		t.rgTrackPeak = tag->rgTrackPeak();
+	}
+
+	TagLib::MPEG::File *mf = dynamic_cast<TagLib::MPEG::File *>(f.file());
+	if (mf)
+	{
+		TagLib::ID3v2::Tag *tag = mf->ID3v2Tag();
+		if (tag)
+		{
+			TagLib::ID3v2::FrameList pictures = mf->ID3v2Tag()->frameListMap()["APIC"];
+			if (!pictures.isEmpty())
+			{
+				TagLib::ID3v2::AttachedPictureFrame *pic = static_cast<TagLib::ID3v2::AttachedPictureFrame *>(pictures.front());
+				t.flags |= TagLibScanner::HasCoverArt;
+				t.coverArt.assign(pic->picture().data(), pic->picture().size());
+			}
+		}
+	}
+}
+
+static bool sameTags(const Tags &a, const Tags &b, bool withCoverArt)
+{
+	return a.flags == b.flags && a.year == b.year && a.track == b.track &&
+		a.rgAlbumGain == b.rgAlbumGain && a.rgAlbumPeak == b.rgAlbumPeak &&
+		a.rgTrackGain == b.rgTrackGain && a.rgTrackPeak == b.rgTrackPeak &&
+		a.artist == b.artist && a.album == b.album && a.title == b.title && a.genre == b.genre &&
+		(!withCoverArt || a.coverArt == b.coverArt);
+}
+
+static int compare(const char *what, const std::vector<std::string> &paths, const std::vector<Tags> &expected, const std::vector<Tags> &results, bool withCoverArt)
+{
+	int failures = 0;
+
+	for (size_t i = 0; i < paths.size(); ++i)
+	{
+		if (i >= results.size() || !sameTags(expected[i], results[i], withCoverArt))
+		{
+			if (failures < 10)
+				printf("  %s: %s differs\n", what, paths[i].c_str());
+			++failures;
+		}
+		else if (!withCoverArt && !results[i].coverArt.empty())
+		{
+			if (failures < 10)
+				printf("  %s: %s has cover art it wasn't asked for\n", what, paths[i].c_str());
+			++failures;
+		}
+	}
+	return failures;
+}
+
+static void report(const char *what, double seconds, size_t files)
+{
+	printf("%-34s %8.3f s %10.0f files/s\n", what, seconds, files / seconds);
+}
+
+int main(int argc, char **argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 2000;
+	if (count <= 0)
+		return 1;
+
+	char dirTemplate[] = "/tmp/TagLibScannerBenchmark.XXXXXX";
+	if (!mkdtemp(dirTemplate))
+	{
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string dir(dirTemplate);
+	std::string cachePath = dir + "/cache";
+
+	std::vector<std::string> paths;
+	double start = now();
+	if (!makeCorpus(dir, count, paths))
+		return 1;
+	printf("%d files made in %.2f s\n\n", count, now() - start);
+
+	int failures = 0;
+	std::vector<Tags> expected(paths.size()), results;
+
+	// Sequential, as before
+	start = now();
+	for (size_t i = 0; i < paths.size(); ++i)
+		readSequential(paths[i], expected[i]);
+	report("sequential FileRef, cover art", now() - start, paths.size());
+
+	int valid = 0, tagged = 0, coverArt = 0;
+	for (const Tags &t : expected)
+	{
+		valid += !!(t.flags & TagLibScanner::Valid);
+		tagged += !!(t.flags & TagLibScanner::HasTitle);
+		coverArt += !!(t.flags & TagLibScanner::HasCoverArt);
+	}
+	printf("(%d open, %d with a title, %d with cover art)\n", valid, tagged, coverArt);
+
+	// Empty cache, so every file is parsed
+	{
+		TagLibScanner scanner(NULL);
+		start = now();
+		scanner.scan(paths, results, TagLibScanner::ScanCoverArt);
+		report("scanner, empty cache, cover art", now() - start, paths.size());
+		failures += compare("empty cache, cover art", paths, expected, results, true);
+	}
+	{
+		TagLibScanner scanner(cachePath.c_str());
+		start = now();
+		scanner.scan(paths, results, 0);
+		scanner.flush();
+		report("scanner, empty cache", now() - start, paths.size());
+		failures += compare("empty cache", paths, expected, results, false);
+
+		start = now();
+		scanner.scan(paths, results, 0);
+		report("scanner, cached in memory", now() - start, paths.size());
+		failures += compare("cached in memory", paths, expected, results, false);
+	}
+
+	// A new scanner, as on the next launch
+	{
+		start = now();
+		TagLibScanner scanner(cachePath.c_str());
+		scanner.scan(paths, results, 0);
+		report("scanner, cache file loaded", now() - start, paths.size());
+		failures += compare("cache file loaded", paths, expected, results, false);
+
+		start = now();
+		scanner.scan(paths, results, TagLibScanner::ScanCoverArt);
+		report("scanner, cached, cover art", now() - start, paths.size());
+		failures += compare("cached, cover art", paths, expected, results, true);
+	}
+
+	// Retag one MP3 in eight; the scanner must see the change
+	int retagged = 0;
+	for (size_t i = 0; i < paths.size(); i += 8)
+	{
+		if (!(expected[i].flags & TagLibScanner::Valid) || paths[i].compare(paths[i].size() - 4, 4, ".mp3") != 0)
+			continue;
+
+		TagLib::MPEG::File f(paths[i].c_str(), false);
+		f.ID3v2Tag(true)->setTitle(TagLib::String("Retagged ") + TagLib::String::number((int)i));
+		f.save(TagLib::MPEG::File::ID3v2);
+
+		// The padding usually takes the new title, so the size stays the
+		// same. Move the modification time on in case the clock is coarse.
+		struct timespec times[2] = { { 0, UTIME_NOW }, { time(NULL) + 10, 0 } };
+		utimensat(AT_FDCWD, paths[i].c_str(), times, 0);
+
+		expected[i] = Tags();
+		readSequential(paths[i], expected[i]);
+		++retagged;
+	}
+	{
+		TagLibScanner scanner(cachePath.c_str());
+		start = now();
+		scanner.scan(paths, results, 0);
+		scanner.flush();
+		char what[64];
+		snprintf(what, sizeof(what), "scanner, %d retagged", retagged);
+		report(what, now() - start, paths.size());
+		failures += compare("retagged", paths, expected, results, false);
+	}
+	{
+		TagLibScanner scanner(cachePath.c_str());
+		scanner.scan(paths, results, 0);
+		failures += compare("retagged, cache file loaded", paths, expected, results, false);
+	}
+
+	for (const std::string &path : paths)
+		unlink(path.c_str());
+	unlink(cachePath.c_str());
+	rmdir(dir.c_str());
+
+	printf(failures ? "\n%d results differ\nFAILED\n" : "\nOK\n", failures);
+	return failures != 0;
+}
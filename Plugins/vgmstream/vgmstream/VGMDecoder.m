@@ -271,27 +271,10 @@
 
 - (long)seek:(long)frame
 {
-    // Constrain the seek offset to within the loop, if any
-    if(stream->loop_flag && (stream->loop_end_sample - stream->loop_start_sample) && frame >= stream->loop_end_sample) {
-        frame -= stream->loop_start_sample;
-        frame %= (stream->loop_end_sample - stream->loop_start_sample);
-        frame += stream->loop_start_sample;
-    }
-    
-    if (frame < framesRead) {
-        reset_vgmstream( stream );
-        framesRead = 0;
-    }
+    // vgmstream applies loops itself, and restores the closest saved decoder state if it can
+    seek_vgmstream( stream, (int32_t)frame );
     
-    while (framesRead < frame) {
-        sample buffer[1024];
-        long max_sample_count = 1024 / channels;
-        long samples_to_skip = frame - framesRead;
-        if ( samples_to_skip > max_sample_count )
-            samples_to_skip = max_sample_count;
-        render_vgmstream( buffer, (int)samples_to_skip, stream );
-        framesRead += samples_to_skip;
-    }
+    framesRead = frame;
     
     return framesRead;
 }
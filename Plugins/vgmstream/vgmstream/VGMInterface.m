@@ -89,6 +89,15 @@ STREAMFILE *cogsf_create_from_path(const char *path) {
 
 STREAMFILE *cogsf_create_from_url(NSURL * url) {
     id<CogSource> source;
+
+    // Local files are mapped into memory, so banks can be parsed without seeking
+    // and decoders can use frames in place
+    if ([url isFileURL]) {
+        STREAMFILE *sf = open_mmap_streamfile([[url path] fileSystemRepresentation]);
+        if (sf)
+            return sf;
+    }
+
     id audioSourceClass = NSClassFromString(@"AudioSource");
     source = [audioSourceClass audioSourceForURL:url];
     
@@ -113,7 +122,7 @@ VGMSTREAM *init_vgmstream_from_cogfile(const char *path, int subsong) {
     if (sf) {
         sf->stream_index = subsong;
         vgm = init_vgmstream_from_STREAMFILE(sf);
-        cogsf_close((COGSTREAMFILE *)sf);
+        close_streamfile(sf);
     }
     
     return vgm;
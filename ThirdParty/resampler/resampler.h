@@ -1,9 +1,14 @@
 #ifndef _RESAMPLER_H_
 #define _RESAMPLER_H_
 
-#define RESAMPLER_DECORATE modplay
+// Shared by every framework that resamples with this code. Each one sets its
+// own RESAMPLER_DECORATE in its build settings, if any, to keep the symbols
+// apart.
 
+// Ugglay
 #ifdef RESAMPLER_DECORATE
+#undef PASTE
+#undef EVALUATE
 #define PASTE(a,b) a ## b
 #define EVALUATE(a,b) PASTE(a,b)
 #define resampler_init EVALUATE(RESAMPLER_DECORATE,_resampler_init)
@@ -16,6 +21,8 @@
 #define resampler_get_padding_size EVALUATE(RESAMPLER_DECORATE,_resampler_get_padding_size)
 #define resampler_write_sample EVALUATE(RESAMPLER_DECORATE,_resampler_write_sample)
 #define resampler_write_sample_fixed EVALUATE(RESAMPLER_DECORATE,_resampler_write_sample_fixed)
+#define resampler_write_sample_float EVALUATE(RESAMPLER_DECORATE,_resampler_write_sample_float)
+#define resampler_write_samples EVALUATE(RESAMPLER_DECORATE,_resampler_write_samples)
 #define resampler_set_rate EVALUATE(RESAMPLER_DECORATE,_resampler_set_rate)
 #define resampler_ready EVALUATE(RESAMPLER_DECORATE,_resampler_ready)
 #define resampler_clear EVALUATE(RESAMPLER_DECORATE,_resampler_clear)
@@ -23,6 +30,11 @@
 #define resampler_get_sample EVALUATE(RESAMPLER_DECORATE,_resampler_get_sample)
 #define resampler_get_sample_float EVALUATE(RESAMPLER_DECORATE,_resampler_get_sample_float)
 #define resampler_remove_sample EVALUATE(RESAMPLER_DECORATE,_resampler_remove_sample)
+#define resampler_read_samples EVALUATE(RESAMPLER_DECORATE,_resampler_read_samples)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
 #endif
 
 void resampler_init(void);
@@ -48,8 +60,14 @@ void resampler_set_quality(void *, int quality);
 
 int resampler_get_free_count(void *);
 int resampler_get_padding_size();
+// write_sample scales 16 bit input by 256, write_sample_fixed normalizes to
+// +/-1.0, and the float versions store the samples as they are.
 void resampler_write_sample(void *, short sample);
 void resampler_write_sample_fixed(void *, int sample, unsigned char depth);
+void resampler_write_sample_float(void *, float sample);
+// Writes up to count samples, as many as there is room for. Returns the
+// number written.
+int resampler_write_samples(void *, const float * samples, int count);
 void resampler_set_rate( void *, double new_factor );
 int resampler_ready(void *);
 void resampler_clear(void *);
@@ -57,5 +75,12 @@ int resampler_get_sample_count(void *);
 int resampler_get_sample(void *);
 float resampler_get_sample_float(void *);
 void resampler_remove_sample(void *, int decay);
+// Same as get_sample_float and remove_sample for up to count samples.
+// Returns the number read, which is short when the input runs out.
+int resampler_read_samples(void *, float * samples, int count, int decay);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,150 @@
+/*
+ * resamplerbench: times each quality mode of the resampler with each of
+ * its code paths, upsampling 44.1 kHz to 48 kHz and downsampling 96 kHz to
+ * 44.1 kHz. Samples move through resampler_write_samples() and
+ * resampler_read_samples(), as the players use it.
+ *
+ * usage: resamplerbench [seconds of input]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../resampler.c"
+
+struct path
+{
+    const char * name;
+    int sse, avx2, neon;
+};
+
+static const struct path paths[] =
+{
+    { "scalar", 0, 0, 0 },
+#ifdef RESAMPLER_SSE
+    { "SSE", 1, 0, 0 },
+#endif
+#ifdef RESAMPLER_AVX2
+    { "AVX2", 1, 1, 0 },
+#endif
+#ifdef RESAMPLER_NEON
+    { "NEON", 0, 0, 1 },
+#endif
+};
+
+static const char * const quality_names[] = { "zoh", "blep", "linear", "blam", "cubic", "sinc" };
+
+struct conversion
+{
+    const char * name;
+    double in_rate, out_rate;
+};
+
+static const struct conversion conversions[] =
+{
+    { "44.1k > 48k", 44100.0, 48000.0 },
+    { "96k > 44.1k", 96000.0, 44100.0 },
+};
+
+static int select_path(const struct path * p)
+{
+#ifdef RESAMPLER_SSE
+    if (p->sse && !query_cpu_feature_sse()) return 0;
+    resampler_has_sse = p->sse;
+#endif
+#ifdef RESAMPLER_AVX2
+    if (p->avx2 && !query_cpu_feature_avx2()) return 0;
+    resampler_has_avx2 = p->avx2;
+#endif
+#ifdef RESAMPLER_NEON
+    resampler_has_neon = p->neon;
+#endif
+    return 1;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Returns output samples per second */
+static double run(int quality, const struct conversion * c, const float * in, int in_count)
+{
+    float out[512];
+    void * r = resampler_create();
+    int in_done = 0;
+    long total = 0;
+    double start;
+
+    resampler_set_quality(r, quality);
+    resampler_set_rate(r, c->in_rate / c->out_rate);
+
+    start = now();
+    for (;;)
+    {
+        int count;
+
+        if (in_done < in_count)
+            in_done += resampler_write_samples(r, in + in_done, in_count - in_done);
+
+        count = resampler_read_samples(r, out, 512, 1);
+        total += count;
+
+        if (!count && in_done == in_count)
+            break;
+    }
+
+    resampler_delete(r);
+
+    return total / (now() - start);
+}
+
+int main(int argc, char ** argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 60;
+    size_t i, j, k;
+
+    resampler_init();
+
+    printf("%-7s %-12s", "", "");
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i)
+        printf(" %12s", paths[i].name);
+    printf("   (million output samples per second)\n");
+
+    for (i = 0; i < sizeof(conversions) / sizeof(conversions[0]); ++i)
+    {
+        const struct conversion * c = &conversions[i];
+        int in_count = (int)(seconds * c->in_rate);
+        float * in = malloc(in_count * sizeof(float));
+        int quality;
+
+        if (!in)
+            return 1;
+
+        for (k = 0; k < (size_t)in_count; ++k)
+            in[k] = 0.5f * (float)sin(k * (2 * M_PI * 440.0 / c->in_rate)) + 0.25f * (float)sin(k * (2 * M_PI * 7000.0 / c->in_rate));
+
+        for (quality = RESAMPLER_QUALITY_MIN; quality <= RESAMPLER_QUALITY_MAX; ++quality)
+        {
+            printf("%-7s %-12s", quality_names[quality], c->name);
+            for (j = 0; j < sizeof(paths) / sizeof(paths[0]); ++j)
+            {
+                if (!select_path(&paths[j]))
+                {
+                    printf(" %12s", "-");
+                    continue;
+                }
+                printf(" %12.1f", run(quality, c, in, in_count) * 1e-6);
+                fflush(stdout);
+            }
+            printf("\n");
+        }
+
+        free(in);
+    }
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * resamplercompare: runs every quality mode of the resampler at a range of
+ * rates through each of its code paths, and checks that the SSE, AVX2 and
+ * NEON loops give the same output as the scalar ones, bit for bit.
+ *
+ * The resampler source is included directly, so the paths can be switched
+ * through its CPU feature flags. Paths the CPU lacks are skipped.
+ *
+ * usage: resamplercompare [input samples]
+ *
+ * Returns non-zero if any path differs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../resampler.c"
+
+struct path
+{
+    const char * name;
+    int sse, avx2, neon;
+};
+
+static const struct path paths[] =
+{
+    { "scalar", 0, 0, 0 },
+#ifdef RESAMPLER_SSE
+    { "SSE", 1, 0, 0 },
+#endif
+#ifdef RESAMPLER_AVX2
+    { "AVX2", 1, 1, 0 },
+#endif
+#ifdef RESAMPLER_NEON
+    { "NEON", 0, 0, 1 },
+#endif
+};
+
+static const char * const quality_names[] = { "zoh", "blep", "linear", "blam", "cubic", "sinc" };
+
+/* Input rate over output rate */
+static const double rates[] = { 0.25, 0.5, 44100.0 / 48000.0, 1.0, 48000.0 / 44100.0, 1.5, 2.0, 96000.0 / 44100.0, 3.3 };
+
+static int select_path(const struct path * p)
+{
+#ifdef RESAMPLER_SSE
+    if (p->sse && !query_cpu_feature_sse()) return 0;
+    resampler_has_sse = p->sse;
+#endif
+#ifdef RESAMPLER_AVX2
+    if (p->avx2 && !query_cpu_feature_avx2()) return 0;
+    resampler_has_avx2 = p->avx2;
+#endif
+#ifdef RESAMPLER_NEON
+    resampler_has_neon = p->neon;
+#endif
+    return 1;
+}
+
+static unsigned int next_random(unsigned int * state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/* Tones and noise, with runs of silence and of repeated samples, which the
+   blep and blam modes skip over */
+static void make_input(float * in, int count)
+{
+    unsigned int random = 0x2545F491;
+    int i;
+
+    for (i = 0; i < count; ++i)
+    {
+        float sample;
+        switch ((i / 4096) % 4)
+        {
+        case 0:
+            sample = 0.5f * (float)sin(i * 0.01) + 0.3f * (float)sin(i * 1.3);
+            break;
+
+        case 1:
+            sample = (float)(int)(next_random(&random) % 65536 - 32768) / 32768.0f;
+            break;
+
+        case 2:
+            sample = ((i / 37) & 1) ? 0.75f : -0.25f;
+            break;
+
+        default:
+            sample = 0.0f;
+            break;
+        }
+        in[i] = sample;
+    }
+}
+
+/* Writes and reads in uneven blocks, so the ring buffers wrap at different
+   places on each call */
+static int render(int quality, double rate, const float * in, int in_count, float * out, int out_max)
+{
+    void * r = resampler_create();
+    int in_done = 0, out_done = 0;
+
+    resampler_set_quality(r, quality);
+    resampler_set_rate(r, rate);
+
+    while (out_done < out_max)
+    {
+        int count;
+
+        if (in_done < in_count)
+        {
+            count = in_count - in_done < 23 ? in_count - in_done : 23;
+            in_done += resampler_write_samples(r, in + in_done, count);
+        }
+
+        count = out_max - out_done < 41 ? out_max - out_done : 41;
+        count = resampler_read_samples(r, out + out_done, count, 1);
+        out_done += count;
+
+        if (!count && in_done == in_count)
+            break;
+    }
+
+    resampler_delete(r);
+
+    return out_done;
+}
+
+int main(int argc, char ** argv)
+{
+    int in_count = argc > 1 ? atoi(argv[1]) : 200000;
+    int out_max = (int)(in_count / rates[0]) + 1;
+    float * in = malloc(in_count * sizeof(float));
+    float * reference = malloc(out_max * sizeof(float));
+    float * out = malloc(out_max * sizeof(float));
+    int failed = 0;
+    int quality;
+    size_t i, j;
+
+    if (!in || !reference || !out)
+        return 1;
+
+    resampler_init();
+    make_input(in, in_count);
+
+    for (quality = RESAMPLER_QUALITY_MIN; quality <= RESAMPLER_QUALITY_MAX; ++quality)
+    {
+        for (i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i)
+        {
+            int reference_count;
+
+            select_path(&paths[0]);
+            reference_count = render(quality, rates[i], in, in_count, reference, out_max);
+
+            printf("%-6s %.4f: %d samples, scalar", quality_names[quality], rates[i], reference_count);
+
+            for (j = 1; j < sizeof(paths) / sizeof(paths[0]); ++j)
+            {
+                int count, k;
+
+                if (!select_path(&paths[j]))
+                    continue;
+
+                count = render(quality, rates[i], in, in_count, out, out_max);
+
+                for (k = 0; k < count && k < reference_count; ++k)
+                {
+                    if (memcmp(&out[k], &reference[k], sizeof(float)))
+                        break;
+                }
+
+                if (count != reference_count || k < count)
+                {
+                    printf("\n  %s differs", paths[j].name);
+                    if (k < count && k < reference_count)
+                        printf(" at sample %d: %.9g vs. %.9g", k, out[k], reference[k]);
+                    else
+                        printf(": %d samples", count);
+                    failed = 1;
+                }
+                else
+                {
+                    printf(", %s", paths[j].name);
+                }
+            }
+
+            printf("\n");
+        }
+    }
+
+    free(in);
+    free(reference);
+    free(out);
+
+    printf(failed ? "FAILED\n" : "OK\n");
+
+    return failed;
+}